@@ -100,7 +100,6 @@
 
               # (static linking: 3rd party libraries)
               "-Wl,-Bstatic",
-              "-lxdo",
               "-ltesseract",
               "-larchive",
               "-lbz2",
@@ -144,8 +143,6 @@
               "-Wl,-Bdynamic",
 
               # (dynamic linking: indirect OS dependencies)
-              "-lXinerama", # indirect dependency, used by xdo
-              "-lxkbcommon", # indirect dependency, used by xdo
               "-lXfixes", # indirect dependency, used by fltk
               "-lXft", # indirect dependency, used by fltk
               "-lgomp", # indirect dependency, used by leptonica and tesseract
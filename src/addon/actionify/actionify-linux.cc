@@ -5,11 +5,11 @@
 #include <X11/extensions/XInput2.h>
 #include <X11/Xatom.h>
 #include <X11/XKBlib.h>
-extern "C" {
-  #include <xdo.h>
-}
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
 #include <cmath>
 #include <vector>
+#include <array>
 #include <thread>
 #include <execution>
 #include <atomic>
@@ -21,11 +21,24 @@ extern "C" {
 #include <iostream>
 #include <algorithm>
 #include <set>
+#include <list>
+#include <unordered_map>
+#include <ctime>
+#include <poll.h>
+#include <pthread.h>
 #include <dlfcn.h>
 #include <filesystem>
 #include <functional>
+#include <random>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
 #include <leptonica/allheaders.h>
 #include <tesseract/baseapi.h>
+#include <tesseract/resultiterator.h>
+#include <zstd.h>
+#include <lz4.h>
 #include <FreeImage.h>
 #include <miniaudio.h>
 #include <sherpa-onnx/c-api/cxx-api.h>
@@ -89,19 +102,47 @@ struct RawWindowEvent {
   std::string type;
 };
 
-// Event structure to hold raw event data
+// Input event types, states and mouse inputs, numbered as in input recordings
+enum class InputEventType : int32_t {
+  Mouse = 0,
+  Keyboard = 1,
+};
+
+enum class InputEventState : int32_t {
+  Down = 0,
+  Up = 1,
+  Neutral = 2,
+};
+
+enum class MouseInputCode : int32_t {
+  Unknown = -1,
+  Move = 0,
+  Left = 1,
+  Right = 2,
+  Middle = 3,
+  Wheel = 4,
+  ExtraButton1 = 5,
+  ExtraButton2 = 6,
+};
+
+// Event structure to hold raw event data, without any allocation
 struct RawInputEvent {
-  std::string type; // "mouse" or "keyboard"
-  std::string input;
-  std::string state;
+  InputEventType type;
+  int input; // MouseInputCode for mouse events, key code for keyboard events
+  InputEventState state;
   int x;
   int y;
-  int keyCode;
   uint64_t timestamp;
   bool isSuppressed;
   bool isInjected;
 };
 
+// XTEST devices, through which injected input events go
+struct XTestDeviceIds {
+  std::optional<int> keyboard;
+  std::optional<int> mouse;
+};
+
 // Structure to hold color information
 struct Color {
   int red;
@@ -110,6 +151,27 @@ struct Color {
   int alpha;
 };
 
+// Path followed by a smooth cursor motion
+enum class CursorMotionCurve {
+  Linear,
+  Arc, // quadratic Bézier curve
+  Wave,
+  Human, // cubic Bézier curve with random control points and minimum-jerk speed
+};
+
+// Structure to hold a smooth cursor motion (see BuildCursorMotionProgram)
+struct CursorMotion {
+  Position from;
+  Position to;
+  double durationMs;
+  CursorMotionCurve curve = CursorMotionCurve::Linear;
+  double curviness = 0.1618;
+  double frequency = 1; // wave count, 0 to fit the motion length
+  bool isMirrored = false;
+  double jitter = 0; // maximum random offset in pixels of intermediate positions
+  unsigned int steps = 0; // intermediate positions, 0 for one per monitor refresh
+};
+
 // Structure to hold a matched region
 struct MatchRegion {
   Position position;
@@ -122,6 +184,37 @@ struct SoundInfo {
   unsigned int duration;
 };
 
+// Words, lines and blocks recognized in an image, as flat arrays: boxes are
+// (x, y, width, height) quadruplets, words refer to their line and lines to
+// their block by index
+struct OcrResult {
+  std::string text;
+  std::vector<std::string> wordTexts;
+  std::vector<int32_t> wordBoxes;
+  std::vector<float> wordConfidences;
+  std::vector<int32_t> wordLines;
+  std::vector<std::string> lineTexts;
+  std::vector<int32_t> lineBoxes;
+  std::vector<float> lineConfidences;
+  std::vector<int32_t> lineBlocks;
+  std::vector<int32_t> blockBoxes;
+  std::vector<float> blockConfidences;
+};
+
+// Structure to hold a single monitor capture request and its result
+struct MonitorCapture {
+  int id;
+  int x;
+  int y;
+  int width;
+  int height;
+  float scale;
+  int format; // Leptonica IFF_* file format
+  std::string filepath; // Encoded in memory when empty
+  std::vector<uint8_t> data;
+  bool isCaptured;
+};
+
 
 // =============================================================================
 // ============================== UTILITY CLASSES ==============================
@@ -409,1660 +502,6283 @@ class AudioManager {
     size_t m_nextSoundId = 0;
 };
 
-template <typename T>
-class PromiseWorker : public Napi::AsyncWorker {
+// Grabs frames of a screen (or window) area as packed BGRA pixels on its own
+// X connection, reusing the same XImage for every frame
+class ScreenFrameSource {
   public:
-
-    PromiseWorker(
-      Napi::Env env,
-      Napi::Promise::Deferred deferred,
-      std::function<T()> executeCallback,
-      std::function<Napi::Value(Napi::Env, const T&)> resolveConverter
-    ) : Napi::AsyncWorker(env), deferred(deferred), executeCallback(executeCallback), resolveConverter(resolveConverter) { }
-
-    ~PromiseWorker() override { }
-
-    void Execute() override {
-      try {
-        promiseResolveResult = executeCallback();
-      } catch (const std::exception& e) {
-        SetError(e.what());
-      } catch (...) {
-        SetError("Unknown error occurred");
+    ScreenFrameSource(unsigned long window, int x, int y, int width, int height) {
+      m_display = XOpenDisplay(nullptr);
+      if (!m_display) {
+        throw std::runtime_error("Failed to open X display.");
       }
-    }
+      m_window = window != 0 ? static_cast<Window>(window) : DefaultRootWindow(m_display);
 
-    void OnOK() override {
-      deferred.Resolve(resolveConverter(Env(), promiseResolveResult));
+      XWindowAttributes attributes;
+      if (!XGetWindowAttributes(m_display, m_window, &attributes)) {
+        XCloseDisplay(m_display);
+        throw std::runtime_error("Failed to get window attributes.");
+      }
+      m_x = std::clamp(x, 0, attributes.width - 1);
+      m_y = std::clamp(y, 0, attributes.height - 1);
+      m_width = std::clamp(width, 1, attributes.width - m_x);
+      m_height = std::clamp(height, 1, attributes.height - m_y);
     }
 
-    void OnError(const Napi::Error& error) override {
-      deferred.Reject(error.Value());
+    ~ScreenFrameSource() {
+      if (m_image) {
+        XDestroyImage(m_image);
+      }
+      XCloseDisplay(m_display);
     }
 
-  private:
-    Napi::Promise::Deferred deferred;
-    std::function<T()> executeCallback;
-    std::function<Napi::Value(Napi::Env, const T&)> resolveConverter;
-    T promiseResolveResult;
-};
+    ScreenFrameSource(const ScreenFrameSource&) = delete;
+    ScreenFrameSource& operator=(const ScreenFrameSource&) = delete;
 
+  public:
+    // Origin of the grabbed area, clamped to the window
+    int x() const {
+      return m_x;
+    }
 
-// =============================================================================
-// ============================== GLOBAL VARIABLES =============================
-// =============================================================================
-
-// X11 input display
-Display* globalInputDisplay = nullptr;
-// X11 window display
-Display* globalWindowDisplay = nullptr;
-// X11 clipboard display
-Display* globalClipboardDisplay = nullptr;
-// X11 tray icon display
-Display* globalTrayIconDisplay = nullptr;
-// XDO instance
-xdo_t* globalXdo = nullptr;
+    int y() const {
+      return m_y;
+    }
 
-// Input events variables
-std::mutex inputEventHookMutex;
-std::atomic<bool> inputEventRunning(false);
-std::condition_variable inputEventHookCondition;
-Napi::ThreadSafeFunction inputEventThreadSafeJsFunction;
-std::thread inputEventThread;
+    int width() const {
+      return m_width;
+    }
 
-// Window events variables
-std::mutex windowEventHookMutex;
-std::atomic<bool> windowEventRunning(false);
-std::condition_variable windowEventHookCondition;
-Napi::ThreadSafeFunction windowEventThreadSafeJsFunction;
-std::thread windowEventThread;
+    int height() const {
+      return m_height;
+    }
 
-// Clipboard events variables
-std::mutex clipboardEventHookMutex;
-std::atomic<bool> clipboardEventRunning(false);
-std::condition_variable clipboardEventHookCondition;
-std::thread clipboardEventThread;
-Window clipboardWindow = None;
-std::string clipboardTextContent;
-Time clipboardOwnershipTakenAt;
+    size_t stride() const {
+      return static_cast<size_t>(m_width) * 4;
+    }
 
-// Tray icon events variables
-std::mutex trayIconEventHookMutex;
-std::atomic<bool> trayIconEventRunning(false);
-std::condition_variable trayIconEventHookCondition;
-std::thread trayIconEventThread;
-Window trayIconWindow = None;
-GC trayIconGraphicsContext = None;
-XImage* trayIconImage = nullptr;
-std::vector<unsigned long> trayIconPixels;
-const unsigned int TRAY_ICON_SIZE = 32;
+    // Prepare the calling thread to grab frames
+    void attachToCurrentThread() { }
 
-// Cache Atom values to reduce XInternAtom calls
-std::unordered_map<std::string, Atom> atomCacheMap = {};
+    // Grab the current frame into `destination` (stride() * height() bytes)
+    bool grab(uint8_t* destination) {
+      if (!m_image) {
+        m_image = XGetImage(m_display, m_window, m_x, m_y, m_width, m_height, AllPlanes, ZPixmap);
+        if (!m_image) return false;
+      }
+      else if (!XGetSubImage(m_display, m_window, m_x, m_y, m_width, m_height, AllPlanes, ZPixmap, m_image, 0, 0)) {
+        return false;
+      }
 
-// Maps to store mouse and keyboard suppressed keys
-std::map<int, std::set<int>> suppressedMouseKeys;
-std::map<int, std::set<int>> suppressedKeyboardKeys;
-std::mutex suppressedKeysMutex;
+      // 32-bit TrueColor LSB-first images are already laid out as BGRX
+      const bool isPackedBgrx =
+        m_image->bits_per_pixel == 32
+        && m_image->byte_order == LSBFirst
+        && m_image->red_mask == 0xff0000
+        && m_image->green_mask == 0xff00
+        && m_image->blue_mask == 0xff;
+
+      for (int imageY = 0; imageY < m_height; imageY++) {
+        uint8_t* line = destination + imageY * stride();
+        if (isPackedBgrx) {
+          const uint8_t* row = reinterpret_cast<const uint8_t*>(m_image->data + imageY * m_image->bytes_per_line);
+          for (int imageX = 0; imageX < m_width; imageX++) {
+            line[imageX * 4 + 0] = row[imageX * 4 + 0];
+            line[imageX * 4 + 1] = row[imageX * 4 + 1];
+            line[imageX * 4 + 2] = row[imageX * 4 + 2];
+            line[imageX * 4 + 3] = 255;
+          }
+        }
+        else {
+          for (int imageX = 0; imageX < m_width; imageX++) {
+            unsigned long pixel = XGetPixel(m_image, imageX, imageY);
+            line[imageX * 4 + 0] = pixel & m_image->blue_mask;
+            line[imageX * 4 + 1] = (pixel & m_image->green_mask) >> 8;
+            line[imageX * 4 + 2] = (pixel & m_image->red_mask) >> 16;
+            line[imageX * 4 + 3] = 255;
+          }
+        }
+      }
+      return true;
+    }
 
-// Audio manager
-AudioManager* audioManager = nullptr;
+  private:
+    Display* m_display = nullptr;
+    Window m_window = 0;
+    XImage* m_image = nullptr;
+    int m_x = 0;
+    int m_y = 0;
+    int m_width = 0;
+    int m_height = 0;
+};
 
-// FLTK thread variables
-std::mutex fltkEventHookMutex;
-std::atomic<bool> fltkEventRunning(false);
-std::condition_variable fltkEventHookCondition;
-std::thread fltkEventThread;
-Fl_Window* globalFltkWindow = nullptr;
-std::function<void()> globalFltkCallback;
-std::atomic<bool> isFltkTrayIconContextMenuOpen(false);
-std::map<int, std::function<void()>> trayIconMenuItemsCallbacks;
-std::map<int, Napi::ThreadSafeFunction> trayIconMenuItemsJsCallbacks;
-std::map<int, std::string> trayIconMenuItemsLabels;
-std::vector<unsigned int> trayIconMenuItemsPositionsToItemsIds;
+// Screen recording container (all integers little-endian):
+//   header  "ACTFRM01" | width | height | stride | codec | keyframe interval | fps
+//   frames  (timestamp in us | flags | payload size | payload)*
+//   index   (frame offset | timestamp in us | flags)*
+//   trailer frame count | index offset | "ACTIDX01"
+// Frames hold packed BGRA pixels. Keyframes are stored as-is, other frames as
+// the XOR of the frame with the previous one (mostly zeros, thus compressing
+// very well), then compressed with LZ4 or Zstandard.
+const char SCREEN_RECORDING_MAGIC[] = "ACTFRM01";
+const char SCREEN_RECORDING_INDEX_MAGIC[] = "ACTIDX01";
+const uint8_t SCREEN_RECORDING_KEYFRAME_FLAG = 1 << 0;
+const uint8_t SCREEN_RECORDING_STORED_FLAG = 1 << 1; // uncompressed payload
+
+enum class FrameCodec : uint32_t {
+  Lz4 = 1,
+  Zstd = 2,
+};
 
+struct ScreenRecordingHeader {
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;
+  FrameCodec codec;
+  uint32_t keyframeInterval;
+  double fps;
+};
 
-// =============================================================================
-// ============================= UTILITY FUNCTIONS =============================
-// =============================================================================
+struct ScreenRecordingIndexEntry {
+  uint64_t offset;
+  uint64_t timestampUs;
+  uint8_t flags;
+};
 
-Display* GetInputDisplay() {
-  if (globalInputDisplay != nullptr) {
-    return globalInputDisplay;
-  }
+struct ScreenRecordingStats {
+  uint64_t frameCount;
+  uint64_t droppedFrameCount;
+  uint64_t durationMs;
+};
 
-  globalInputDisplay = XOpenDisplay(nullptr);
-  if (!globalInputDisplay) {
-    globalInputDisplay = nullptr;
-    throw std::runtime_error("Failed to open X display.");
-  }
-  return globalInputDisplay;
+template <typename T>
+void WriteBinary(std::ostream& stream, const T& value) {
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
 }
 
-void CloseInputDisplay() {
-  if (globalInputDisplay != nullptr) {
-    XCloseDisplay(globalInputDisplay);
+template <typename T>
+T ReadBinary(std::istream& stream) {
+  T value{};
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+  if (!stream) {
+    throw std::runtime_error("Unexpected end of screen recording file.");
+  }
+  return value;
+}
+
+// XOR two equally sized frames into `destination`
+void XorFrames(const uint8_t* frame, const uint8_t* otherFrame, uint8_t* destination, size_t size) {
+  size_t wordCount = size / sizeof(uint64_t);
+  for (size_t i = 0; i < wordCount; i++) {
+    uint64_t word, otherWord;
+    std::memcpy(&word, frame + i * sizeof(uint64_t), sizeof(uint64_t));
+    std::memcpy(&otherWord, otherFrame + i * sizeof(uint64_t), sizeof(uint64_t));
+    word ^= otherWord;
+    std::memcpy(destination + i * sizeof(uint64_t), &word, sizeof(uint64_t));
+  }
+  for (size_t i = wordCount * sizeof(uint64_t); i < size; i++) {
+    destination[i] = frame[i] ^ otherFrame[i];
+  }
+}
+
+// Compress a frame into `destination`. Returns false when the codec failed,
+// in which case the caller should store the frame uncompressed.
+bool CompressFrame(
+  FrameCodec codec,
+  int compressionLevel,
+  const uint8_t* source,
+  size_t size,
+  std::vector<uint8_t>& destination,
+  ZSTD_CCtx* zstdContext
+) {
+  if (codec == FrameCodec::Zstd) {
+    destination.resize(ZSTD_compressBound(size));
+    size_t compressedSize = zstdContext
+      ? ZSTD_compressCCtx(zstdContext, destination.data(), destination.size(), source, size, compressionLevel)
+      : ZSTD_compress(destination.data(), destination.size(), source, size, compressionLevel);
+    if (ZSTD_isError(compressedSize)) {
+      return false;
+    }
+    destination.resize(compressedSize);
+    return true;
+  }
+  destination.resize(LZ4_compressBound(static_cast<int>(size)));
+  int compressedSize = LZ4_compress_default(
+    reinterpret_cast<const char*>(source),
+    reinterpret_cast<char*>(destination.data()),
+    static_cast<int>(size),
+    static_cast<int>(destination.size())
+  );
+  if (compressedSize <= 0) {
+    return false;
   }
-  globalInputDisplay = nullptr;
+  destination.resize(compressedSize);
+  return true;
 }
 
-Display* GetWindowDisplay() {
-  if (globalWindowDisplay != nullptr) {
-    return globalWindowDisplay;
+void DecompressFrame(FrameCodec codec, const std::vector<uint8_t>& source, uint8_t* destination, size_t size) {
+  if (codec == FrameCodec::Zstd) {
+    size_t decompressedSize = ZSTD_decompress(destination, size, source.data(), source.size());
+    if (ZSTD_isError(decompressedSize) || decompressedSize != size) {
+      throw std::runtime_error("Corrupted screen recording frame.");
+    }
+    return;
   }
-
-  globalWindowDisplay = XOpenDisplay(nullptr);
-  if (!globalWindowDisplay) {
-    globalWindowDisplay = nullptr;
-    throw std::runtime_error("Failed to open X display.");
+  int decompressedSize = LZ4_decompress_safe(
+    reinterpret_cast<const char*>(source.data()),
+    reinterpret_cast<char*>(destination),
+    static_cast<int>(source.size()),
+    static_cast<int>(size)
+  );
+  if (decompressedSize < 0 || static_cast<size_t>(decompressedSize) != size) {
+    throw std::runtime_error("Corrupted screen recording frame.");
   }
-  return globalWindowDisplay;
 }
 
-void CloseWindowDisplay() {
-  if (globalWindowDisplay != nullptr) {
-    XCloseDisplay(globalWindowDisplay);
-  }
-  globalWindowDisplay = nullptr;
-}
+// Appends encoded frames to a screen recording file and writes its index on finish
+class ScreenRecordingWriter {
+  public:
+    ScreenRecordingWriter(const std::filesystem::path& filepath, const ScreenRecordingHeader& header)
+      : m_stream(filepath, std::ios::binary | std::ios::trunc) {
+      if (!m_stream) {
+        throw std::runtime_error("Failed to open screen recording file.");
+      }
+      m_stream.write(SCREEN_RECORDING_MAGIC, 8);
+      WriteBinary(m_stream, header.width);
+      WriteBinary(m_stream, header.height);
+      WriteBinary(m_stream, header.stride);
+      WriteBinary(m_stream, static_cast<uint32_t>(header.codec));
+      WriteBinary(m_stream, header.keyframeInterval);
+      WriteBinary(m_stream, header.fps);
+    }
 
-Atom GetAtom(const std::string& name, Display* display = nullptr) {
-  if (atomCacheMap.find(name) != atomCacheMap.end()) return atomCacheMap[name];
-  Display* xDisplay = (display == nullptr) ? GetWindowDisplay() : display;
-  Atom atom = XInternAtom(xDisplay, name.c_str(), False);
-  atomCacheMap[name] = atom;
-  return atom;
-}
+    ~ScreenRecordingWriter() {
+      try {
+        finish();
+      } catch (...) {
+        // Nobody is left to report the failure to
+      }
+    }
 
-Display* GetClipboardDisplay() {
-  if (globalClipboardDisplay != nullptr) {
-    return globalClipboardDisplay;
-  }
+    ScreenRecordingWriter(const ScreenRecordingWriter&) = delete;
+    ScreenRecordingWriter& operator=(const ScreenRecordingWriter&) = delete;
 
-  globalClipboardDisplay = XOpenDisplay(nullptr);
-  if (!globalClipboardDisplay) {
-    globalClipboardDisplay = nullptr;
-    throw std::runtime_error("Failed to open X display.");
-  }
-  return globalClipboardDisplay;
-}
+  public:
+    void append(uint64_t timestampUs, uint8_t flags, const uint8_t* payload, uint32_t size) {
+      m_index.push_back({ static_cast<uint64_t>(m_stream.tellp()), timestampUs, flags });
+      WriteBinary(m_stream, timestampUs);
+      WriteBinary(m_stream, flags);
+      WriteBinary(m_stream, size);
+      m_stream.write(reinterpret_cast<const char*>(payload), size);
+    }
+
+    void finish() {
+      if (m_isFinished) return;
+      m_isFinished = true;
+      uint64_t indexOffset = static_cast<uint64_t>(m_stream.tellp());
+      for (const ScreenRecordingIndexEntry& entry : m_index) {
+        WriteBinary(m_stream, entry.offset);
+        WriteBinary(m_stream, entry.timestampUs);
+        WriteBinary(m_stream, entry.flags);
+      }
+      WriteBinary(m_stream, static_cast<uint64_t>(m_index.size()));
+      WriteBinary(m_stream, indexOffset);
+      m_stream.write(SCREEN_RECORDING_INDEX_MAGIC, 8);
+      m_stream.flush();
+      // The stream state is sticky: this also catches failed appends
+      bool hasFailed = !m_stream;
+      m_stream.close();
+      if (hasFailed || !m_stream) {
+        throw std::runtime_error("Failed to write screen recording file.");
+      }
+    }
 
-void CloseClipboardDisplay() {
-  if (globalClipboardDisplay != nullptr) {
-    XCloseDisplay(globalClipboardDisplay);
-  }
-  globalClipboardDisplay = nullptr;
-}
+    size_t frameCount() const {
+      return m_index.size();
+    }
 
-Display* GetTrayIconDisplay() {
-  if (globalTrayIconDisplay != nullptr) {
-    return globalTrayIconDisplay;
-  }
+  private:
+    std::ofstream m_stream;
+    std::vector<ScreenRecordingIndexEntry> m_index;
+    bool m_isFinished = false;
+};
 
-  globalTrayIconDisplay = XOpenDisplay(nullptr);
-  if (!globalTrayIconDisplay) {
-    globalTrayIconDisplay = nullptr;
-    throw std::runtime_error("Failed to open X display.");
-  }
-  return globalTrayIconDisplay;
-}
+struct ScreenRecordingFrame {
+  ScreenRecordingHeader header;
+  uint64_t frameCount;
+  uint64_t timestampUs;
+  std::vector<uint8_t> pixels;
+};
 
-void CloseTrayIconDisplay() {
-  if (globalTrayIconDisplay != nullptr) {
-    XCloseDisplay(globalTrayIconDisplay);
+// Decode a single frame of a screen recording, starting from its closest
+// preceding keyframe thanks to the recording index
+ScreenRecordingFrame ReadScreenRecordingFrame(const std::filesystem::path& filepath, uint64_t frameIndex) {
+  std::ifstream stream(filepath, std::ios::binary);
+  if (!stream) {
+    throw std::runtime_error("Failed to open screen recording file.");
+  }
+
+  char magic[8];
+  stream.read(magic, 8);
+  if (!stream || std::memcmp(magic, SCREEN_RECORDING_MAGIC, 8) != 0) {
+    throw std::runtime_error("Invalid screen recording file.");
+  }
+
+  ScreenRecordingFrame result{};
+  result.header.width = ReadBinary<uint32_t>(stream);
+  result.header.height = ReadBinary<uint32_t>(stream);
+  result.header.stride = ReadBinary<uint32_t>(stream);
+  result.header.codec = static_cast<FrameCodec>(ReadBinary<uint32_t>(stream));
+  result.header.keyframeInterval = ReadBinary<uint32_t>(stream);
+  result.header.fps = ReadBinary<double>(stream);
+
+  // Trailer: frame count | index offset | magic
+  stream.seekg(-24, std::ios::end);
+  result.frameCount = ReadBinary<uint64_t>(stream);
+  uint64_t indexOffset = ReadBinary<uint64_t>(stream);
+  stream.read(magic, 8);
+  if (!stream || std::memcmp(magic, SCREEN_RECORDING_INDEX_MAGIC, 8) != 0) {
+    throw std::runtime_error("Screen recording file has no index (recording not stopped properly).");
+  }
+  if (frameIndex >= result.frameCount) {
+    throw std::runtime_error("Frame index out of range: " + std::to_string(frameIndex));
+  }
+
+  // Only read the index up to the requested frame
+  std::vector<ScreenRecordingIndexEntry> index(frameIndex + 1);
+  stream.seekg(indexOffset);
+  for (ScreenRecordingIndexEntry& entry : index) {
+    entry.offset = ReadBinary<uint64_t>(stream);
+    entry.timestampUs = ReadBinary<uint64_t>(stream);
+    entry.flags = ReadBinary<uint8_t>(stream);
+  }
+  uint64_t keyframeIndex = frameIndex;
+  while (keyframeIndex > 0 && !(index[keyframeIndex].flags & SCREEN_RECORDING_KEYFRAME_FLAG)) {
+    keyframeIndex--;
+  }
+
+  size_t frameSize = static_cast<size_t>(result.header.stride) * result.header.height;
+  result.pixels.resize(frameSize);
+  std::vector<uint8_t> payload;
+  std::vector<uint8_t> delta(frameSize);
+  for (uint64_t i = keyframeIndex; i <= frameIndex; i++) {
+    stream.seekg(index[i].offset);
+    uint64_t timestampUs = ReadBinary<uint64_t>(stream);
+    uint8_t flags = ReadBinary<uint8_t>(stream);
+    uint32_t size = ReadBinary<uint32_t>(stream);
+    payload.resize(size);
+    stream.read(reinterpret_cast<char*>(payload.data()), size);
+    if (!stream) {
+      throw std::runtime_error("Unexpected end of screen recording file.");
+    }
+
+    uint8_t* destination = (flags & SCREEN_RECORDING_KEYFRAME_FLAG) ? result.pixels.data() : delta.data();
+    if (flags & SCREEN_RECORDING_STORED_FLAG) {
+      if (size != frameSize) {
+        throw std::runtime_error("Corrupted screen recording frame.");
+      }
+      std::memcpy(destination, payload.data(), frameSize);
+    }
+    else {
+      DecompressFrame(result.header.codec, payload, destination, frameSize);
+    }
+    if (!(flags & SCREEN_RECORDING_KEYFRAME_FLAG)) {
+      XorFrames(result.pixels.data(), delta.data(), result.pixels.data(), frameSize);
+    }
+    result.timestampUs = timestampUs;
   }
-  globalTrayIconDisplay = nullptr;
+
+  return result;
 }
 
-xdo_t* GetXdo() {
-  if (globalXdo != nullptr) {
-    return globalXdo;
-  }
+// Records a screen area at a fixed rate. A capture thread grabs frames on
+// absolute deadlines and hands them to encoder threads (delta + compression),
+// which append them in order to the recording file. Frames are dropped rather
+// than delaying the capture when encoders fall behind.
+class ScreenRecorder {
+  public:
+    ScreenRecorder(
+      std::unique_ptr<ScreenFrameSource> source,
+      const std::filesystem::path& filepath,
+      double fps,
+      FrameCodec codec,
+      int compressionLevel,
+      uint32_t keyframeInterval
+    ) : m_source(std::move(source)),
+        m_fps(fps),
+        m_codec(codec),
+        m_compressionLevel(compressionLevel),
+        m_keyframeInterval(std::max(1u, keyframeInterval)),
+        m_frameSize(m_source->stride() * m_source->height()),
+        m_writer(filepath, {
+          static_cast<uint32_t>(m_source->width()),
+          static_cast<uint32_t>(m_source->height()),
+          static_cast<uint32_t>(m_source->stride()),
+          codec,
+          m_keyframeInterval,
+          fps
+        }) {
+      unsigned int encoderCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+      m_maxPendingFrames = encoderCount * 2;
+      m_isRunning = true;
+      for (unsigned int i = 0; i < encoderCount; i++) {
+        m_encoderThreads.emplace_back(&ScreenRecorder::encodeLoop, this);
+      }
+      m_captureThread = std::thread(&ScreenRecorder::captureLoop, this);
+    }
 
-  globalXdo = xdo_new(NULL);
-  if (!globalXdo) {
-    globalXdo = nullptr;
-    throw std::runtime_error("Failed to create XDO instance.");
-  }
-  return globalXdo;
-}
+    ~ScreenRecorder() {
+      try {
+        stop();
+      } catch (...) {
+        // Nobody is left to report the failure to
+      }
+    }
 
-void CloseXdo() {
-  if (globalXdo != nullptr) {
-    xdo_free(globalXdo);
-  }
-  globalXdo = nullptr;
-}
+    ScreenRecorder(const ScreenRecorder&) = delete;
+    ScreenRecorder& operator=(const ScreenRecorder&) = delete;
 
-AudioManager* GetAudioManager() {
-  if (audioManager == nullptr) {
-    audioManager = new AudioManager();
-  }
-  return audioManager;
-}
-
-void CloseAudioManager() {
-  if (audioManager != nullptr) {
-    delete audioManager;
-    audioManager = nullptr;
-  }
-}
+  public:
+    ScreenRecordingStats stop() {
+      std::lock_guard<std::mutex> stopLock(m_stopMutex);
+      if (m_isRunning.exchange(false)) {
+        m_captureThread.join();
+        {
+          std::lock_guard<std::mutex> lock(m_jobsMutex);
+          m_isCaptureDone = true;
+        }
+        m_jobsCondition.notify_all();
+        for (auto& thread : m_encoderThreads) {
+          thread.join();
+        }
+        m_writer.finish();
+      }
+      return { m_writer.frameCount(), m_droppedFrameCount.load(), m_durationMs };
+    }
 
-// X11 Global error handler.
-// Some errors are thrown by X11 asynchronously and often kills the process
-// To avoid that, we use this handler to catch the errors and avoid process termination
-int X11GlobalErrorHandler(Display* anyDisplay, XErrorEvent* error_event) {
-  char error_text[256];
-  XGetErrorText(anyDisplay, error_event->error_code, error_text, sizeof(error_text));
+  private:
+    struct FrameJob {
+      uint64_t sequence;
+      uint64_t timestampUs;
+      bool isKeyframe;
+      std::shared_ptr<std::vector<uint8_t>> frame;
+      std::shared_ptr<std::vector<uint8_t>> previousFrame;
+    };
+
+    struct EncodedFrame {
+      uint64_t timestampUs;
+      uint8_t flags;
+      std::vector<uint8_t> payload;
+    };
+
+    // Reuse a pooled frame buffer no longer referenced by any job
+    std::shared_ptr<std::vector<uint8_t>> acquireFrameBuffer() {
+      for (const auto& buffer : m_framePool) {
+        if (buffer.use_count() == 1) {
+          return buffer;
+        }
+      }
+      if (m_framePool.size() < m_maxPendingFrames + 2) {
+        m_framePool.push_back(std::make_shared<std::vector<uint8_t>>(m_frameSize));
+        return m_framePool.back();
+      }
+      return nullptr;
+    }
 
-  char opcode_str[32];
-  snprintf(opcode_str, sizeof(opcode_str), "%d", error_event->request_code);
-  char request_name[256] = {0};
-  XGetErrorDatabaseText(
-    anyDisplay,
-    "XRequest",
-    opcode_str,
-    "",
-    request_name,
-    sizeof(request_name)
-  );
-  if (request_name[0] == '\0') {
-    std::strncpy(request_name, "Unknown", sizeof(request_name));
-  }
+    void captureLoop() {
+      m_source->attachToCurrentThread();
+      const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_fps));
+      const auto startTime = std::chrono::steady_clock::now();
+      auto deadline = startTime;
+      std::shared_ptr<std::vector<uint8_t>> previousFrame;
+      uint64_t sequence = 0;
+      uint32_t framesSinceKeyframe = 0;
 
-  std::cerr << "X11 Error:" << std::endl
-    << "  Error: " << error_text << std::endl
-    << "  Major opcode of failed request: " << static_cast<int>(error_event->request_code)
-                                            << " (" << request_name << ")"
-                                            << std::endl
-    << "  Serial number of failed request: " << error_event->serial << std::endl
-    << "  Current serial number in output stream: " << NextRequest(anyDisplay) - 1 << std::endl
-    << "This X11 error has been intercepted by Actionify and will not kill the process." << std::endl
-  ;
+      while (m_isRunning.load()) {
+        std::this_thread::sleep_until(deadline);
+        if (!m_isRunning.load()) break;
 
-  // Returning 0 prevents Xlib from calling exit().
-  // This avoids process termination.
-  return 0;
-}
+        uint64_t timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+        bool hasRoom;
+        {
+          std::lock_guard<std::mutex> lock(m_jobsMutex);
+          hasRoom = m_jobs.size() < m_maxPendingFrames;
+        }
+        std::shared_ptr<std::vector<uint8_t>> frame = hasRoom ? acquireFrameBuffer() : nullptr;
 
-// Function to get the absolute mouse position if the event is a mouse move event
-std::optional<Position> GetMouseEventPosition(const XIRawEvent& xiRawEvent) {
-  constexpr int MouseXAxis = 0;
-  constexpr int MouseYAxis = 1;
+        if (frame && m_source->grab(frame->data())) {
+          bool isKeyframe = !previousFrame || framesSinceKeyframe >= m_keyframeInterval;
+          {
+            std::lock_guard<std::mutex> lock(m_jobsMutex);
+            m_jobs.push({ sequence++, timestampUs, isKeyframe, frame, isKeyframe ? nullptr : previousFrame });
+          }
+          m_jobsCondition.notify_one();
+          previousFrame = frame;
+          framesSinceKeyframe = isKeyframe ? 1 : framesSinceKeyframe + 1;
+        }
+        else {
+          m_droppedFrameCount++;
+        }
 
-  int valueIndex = 0;
-  Position result = {0, 0};
-  bool foundXAxis = false;
-  bool foundYAxis = false;
-  for (int axis = 0; axis < xiRawEvent.valuators.mask_len * 8; ++axis) {
-    if (XIMaskIsSet(xiRawEvent.valuators.mask, axis)) {
-      double delta = xiRawEvent.raw_values[valueIndex++];
-      if (axis == MouseXAxis) {
-        result.x = delta;
-        foundXAxis = true;
-      }
-      else if (axis == MouseYAxis) {
-        result.y = delta;
-        foundYAxis = true;
+        // Skip missed deadlines instead of bursting to catch up
+        deadline += period;
+        const auto now = std::chrono::steady_clock::now();
+        while (deadline + period <= now) {
+          deadline += period;
+          m_droppedFrameCount++;
+        }
       }
+
+      m_durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
     }
-  }
 
-  if (foundXAxis || foundYAxis) {
-    return result;
-  }
+    void encodeLoop() {
+      ZSTD_CCtx* zstdContext = m_codec == FrameCodec::Zstd ? ZSTD_createCCtx() : nullptr;
+      std::vector<uint8_t> delta;
 
-  return std::nullopt;
-}
+      while (true) {
+        FrameJob job;
+        {
+          std::unique_lock<std::mutex> lock(m_jobsMutex);
+          m_jobsCondition.wait(lock, [this] { return !m_jobs.empty() || m_isCaptureDone; });
+          if (m_jobs.empty()) break;
+          job = std::move(m_jobs.front());
+          m_jobs.pop();
+        }
 
-// Function to get the scroll amount if the event is a mouse wheel event
-std::optional<Position> GetMouseWheelEventScrollAmount(const XIRawEvent& xiRawEvent) {
-  constexpr int WheelXAxis = 2;
-  constexpr int WheelYAxis = 3;
+        const uint8_t* source = job.frame->data();
+        if (!job.isKeyframe) {
+          delta.resize(m_frameSize);
+          XorFrames(job.frame->data(), job.previousFrame->data(), delta.data(), m_frameSize);
+          source = delta.data();
+        }
 
-  int valueIndex = 0;
-  Position result = {0, 0};
-  bool foundXAxis = false;
-  bool foundYAxis = false;
-  for (int axis = 0; axis < xiRawEvent.valuators.mask_len * 8; ++axis) {
-    if (XIMaskIsSet(xiRawEvent.valuators.mask, axis)) {
-      double delta = xiRawEvent.raw_values[valueIndex++];
-      if (axis == WheelXAxis) {
-        result.x = delta;
-        foundXAxis = true;
+        EncodedFrame encodedFrame{ job.timestampUs, static_cast<uint8_t>(job.isKeyframe ? SCREEN_RECORDING_KEYFRAME_FLAG : 0), {} };
+        if (!CompressFrame(m_codec, m_compressionLevel, source, m_frameSize, encodedFrame.payload, zstdContext)) {
+          encodedFrame.payload.assign(source, source + m_frameSize);
+          encodedFrame.flags |= SCREEN_RECORDING_STORED_FLAG;
+        }
+
+        // Give the frame buffers back to the pool
+        job.frame.reset();
+        job.previousFrame.reset();
+
+        writeInOrder(job.sequence, std::move(encodedFrame));
       }
-      else if (axis == WheelYAxis) {
-        result.y = delta;
-        foundYAxis = true;
+
+      if (zstdContext) {
+        ZSTD_freeCCtx(zstdContext);
       }
     }
-  }
 
-  if (foundXAxis || foundYAxis) {
-    return result;
-  }
+    void writeInOrder(uint64_t sequence, EncodedFrame encodedFrame) {
+      std::lock_guard<std::mutex> lock(m_writeMutex);
+      m_encodedFrames.emplace(sequence, std::move(encodedFrame));
+      for (
+        auto it = m_encodedFrames.find(m_nextWriteSequence);
+        it != m_encodedFrames.end();
+        it = m_encodedFrames.find(m_nextWriteSequence)
+      ) {
+        const EncodedFrame& nextFrame = it->second;
+        m_writer.append(nextFrame.timestampUs, nextFrame.flags, nextFrame.payload.data(), static_cast<uint32_t>(nextFrame.payload.size()));
+        m_encodedFrames.erase(it);
+        m_nextWriteSequence++;
+      }
+    }
 
-  return std::nullopt;
-}
+  private:
+    std::unique_ptr<ScreenFrameSource> m_source;
+    double m_fps;
+    FrameCodec m_codec;
+    int m_compressionLevel;
+    uint32_t m_keyframeInterval;
+    size_t m_frameSize;
+    size_t m_maxPendingFrames = 0;
+    ScreenRecordingWriter m_writer;
+
+    std::atomic<bool> m_isRunning{false};
+    std::mutex m_stopMutex;
+    std::thread m_captureThread;
+    std::vector<std::thread> m_encoderThreads;
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> m_framePool;
+
+    std::mutex m_jobsMutex;
+    std::condition_variable m_jobsCondition;
+    std::queue<FrameJob> m_jobs;
+    bool m_isCaptureDone = false;
+
+    std::mutex m_writeMutex;
+    std::map<uint64_t, EncodedFrame> m_encodedFrames;
+    uint64_t m_nextWriteSequence = 0;
+
+    std::atomic<uint64_t> m_droppedFrameCount{0};
+    uint64_t m_durationMs = 0;
+};
 
-std::optional<int> GetXTestMouseDeviceId() {
-  Display* inputDisplay = GetInputDisplay();
+// Keeps the last seconds of a screen area in memory, ready to be dumped to a
+// screen recording file on demand. Frames are LZ4-compressed (keyframes or
+// XOR deltas) by the capture thread itself and stored in a fixed-size arena
+// used as a ring buffer: memory never grows past the budget, the oldest frames
+// are evicted as new ones come in.
+class FlightRecorder {
+  public:
+    FlightRecorder(
+      std::unique_ptr<ScreenFrameSource> source,
+      double fps,
+      uint64_t durationMs,
+      size_t memoryLimit,
+      uint32_t keyframeInterval
+    ) : m_source(std::move(source)),
+        m_fps(fps),
+        m_durationUs(durationMs * 1000),
+        m_keyframeInterval(std::max(1u, keyframeInterval)),
+        m_frameSize(m_source->stride() * m_source->height()),
+        m_arena(memoryLimit),
+        m_slots(static_cast<size_t>(std::ceil(fps * durationMs / 1000.0)) + 1),
+        m_frame(m_frameSize),
+        m_previousFrame(m_frameSize),
+        m_delta(m_frameSize),
+        m_compressedFrame(LZ4_compressBound(static_cast<int>(m_frameSize))) {
+      m_isRunning = true;
+      m_captureThread = std::thread(&FlightRecorder::captureLoop, this);
+    }
+
+    ~FlightRecorder() {
+      stop();
+    }
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
 
-  int ndevices = 0;
-  XIDeviceInfo* devices = XIQueryDevice(inputDisplay, XIAllDevices, &ndevices);
+  public:
+    void stop() {
+      std::lock_guard<std::mutex> stopLock(m_stopMutex);
+      if (m_isRunning.exchange(false)) {
+        m_captureThread.join();
+      }
+    }
 
-  if (!devices) {
-    return std::nullopt;
-  }
+    // Write the buffered frames to a screen recording file, starting at the
+    // oldest buffered keyframe
+    ScreenRecordingStats dump(const std::filesystem::path& filepath) {
+      // Copy the frames out of the arena so the capture thread is only
+      // blocked for a memcpy, not for disk writes
+      std::vector<FrameSlot> slots;
+      std::vector<uint8_t> payloads;
+      {
+        std::lock_guard<std::mutex> lock(m_ringMutex);
+        size_t first = 0;
+        while (first < m_slotCount && !(slotAt(first).flags & SCREEN_RECORDING_KEYFRAME_FLAG)) {
+          first++;
+        }
+        size_t payloadsSize = 0;
+        for (size_t i = first; i < m_slotCount; i++) {
+          payloadsSize += slotAt(i).size;
+        }
+        payloads.resize(payloadsSize);
+        size_t payloadsOffset = 0;
+        for (size_t i = first; i < m_slotCount; i++) {
+          FrameSlot slot = slotAt(i);
+          std::memcpy(payloads.data() + payloadsOffset, m_arena.data() + slot.offset, slot.size);
+          slot.offset = payloadsOffset;
+          payloadsOffset += slot.size;
+          slots.push_back(slot);
+        }
+      }
 
-  for (int i = 0; i < ndevices; ++i) {
-    const char* name = devices[i].name;
+      ScreenRecordingWriter writer(filepath, {
+        static_cast<uint32_t>(m_source->width()),
+        static_cast<uint32_t>(m_source->height()),
+        static_cast<uint32_t>(m_source->stride()),
+        FrameCodec::Lz4,
+        m_keyframeInterval,
+        m_fps
+      });
+      uint64_t firstTimestampUs = slots.empty() ? 0 : slots.front().timestampUs;
+      for (const FrameSlot& slot : slots) {
+        writer.append(slot.timestampUs - firstTimestampUs, slot.flags, payloads.data() + slot.offset, slot.size);
+      }
+      writer.finish();
 
-    if (name && std::string(name).find("XTEST pointer") != std::string::npos) {
-      XIFreeDeviceInfo(devices);
-      return devices[i].deviceid;
+      uint64_t durationMs = slots.empty() ? 0 : (slots.back().timestampUs - firstTimestampUs) / 1000;
+      return { slots.size(), m_droppedFrameCount.load(), durationMs };
     }
-  }
 
-  XIFreeDeviceInfo(devices);
-  return std::nullopt;
-}
+  private:
+    struct FrameSlot {
+      size_t offset;
+      uint32_t size;
+      uint64_t timestampUs;
+      uint8_t flags;
+    };
 
-std::optional<int> GetXTestKeyboardDeviceId() {
-  Display* inputDisplay = GetInputDisplay();
+    // i-th buffered frame, from the oldest one
+    FrameSlot& slotAt(size_t i) {
+      return m_slots[(m_firstSlot + i) % m_slots.size()];
+    }
 
-  int ndevices = 0;
-  XIDeviceInfo* devices = XIQueryDevice(inputDisplay, XIAllDevices, &ndevices);
+    void evictOldestFrame() {
+      m_firstSlot = (m_firstSlot + 1) % m_slots.size();
+      m_slotCount--;
+    }
 
-  if (!devices) {
-    return std::nullopt;
-  }
+    // Store a compressed frame, evicting the oldest frames to make room.
+    // Frames are laid out back to back in the arena, wrapping to its start
+    // when the end is reached, so the frames to evict are always the oldest.
+    bool storeFrame(const uint8_t* payload, uint32_t size, uint64_t timestampUs, uint8_t flags) {
+      if (size > m_arena.size()) {
+        return false;
+      }
+      std::lock_guard<std::mutex> lock(m_ringMutex);
 
-  for (int i = 0; i < ndevices; ++i) {
-    const char* name = devices[i].name;
+      size_t offset = m_writeOffset;
+      if (offset + size > m_arena.size()) {
+        // Frames left past the write offset belong to the previous lap
+        while (m_slotCount > 0 && slotAt(0).offset >= m_writeOffset) {
+          evictOldestFrame();
+        }
+        offset = 0;
+      }
+      while (m_slotCount > 0 && slotAt(0).offset >= offset && slotAt(0).offset < offset + size) {
+        evictOldestFrame();
+      }
+      while (m_slotCount > 0 && (m_slotCount == m_slots.size() || timestampUs - slotAt(0).timestampUs > m_durationUs)) {
+        evictOldestFrame();
+      }
 
-    if (name && std::string(name).find("XTEST keyboard") != std::string::npos) {
-      XIFreeDeviceInfo(devices);
-      return devices[i].deviceid;
+      std::memcpy(m_arena.data() + offset, payload, size);
+      m_slotCount++;
+      slotAt(m_slotCount - 1) = { offset, size, timestampUs, flags };
+      m_writeOffset = offset + size;
+      return true;
     }
-  }
-
-  XIFreeDeviceInfo(devices);
-  return std::nullopt;
-}
 
-// Return this dynamic library's absolute directory path (/path/to/build/Release/actionify.node)
-std::filesystem::path GetModuleAbsoluteDirectoryPath() {
-  Dl_info dlInfo;
+    void captureLoop() {
+      m_source->attachToCurrentThread();
+      const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_fps));
+      const auto startTime = std::chrono::steady_clock::now();
+      auto deadline = startTime;
+      bool hasPreviousFrame = false;
+      uint32_t framesSinceKeyframe = 0;
+
+      while (m_isRunning.load()) {
+        std::this_thread::sleep_until(deadline);
+        if (!m_isRunning.load()) break;
+
+        uint64_t timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+        bool isStored = false;
+        if (m_source->grab(m_frame.data())) {
+          bool isKeyframe = !hasPreviousFrame || framesSinceKeyframe >= m_keyframeInterval;
+          const uint8_t* source = m_frame.data();
+          if (!isKeyframe) {
+            XorFrames(m_frame.data(), m_previousFrame.data(), m_delta.data(), m_frameSize);
+            source = m_delta.data();
+          }
+          int compressedSize = LZ4_compress_default(
+            reinterpret_cast<const char*>(source),
+            reinterpret_cast<char*>(m_compressedFrame.data()),
+            static_cast<int>(m_frameSize),
+            static_cast<int>(m_compressedFrame.size())
+          );
+          uint8_t flags = isKeyframe ? SCREEN_RECORDING_KEYFRAME_FLAG : 0;
+          isStored = compressedSize > 0 && storeFrame(m_compressedFrame.data(), static_cast<uint32_t>(compressedSize), timestampUs, flags);
+          if (isStored) {
+            std::swap(m_frame, m_previousFrame);
+            hasPreviousFrame = true;
+            framesSinceKeyframe = isKeyframe ? 1 : framesSinceKeyframe + 1;
+          }
+          else {
+            // The next frame has no stored frame to be a delta of
+            hasPreviousFrame = false;
+          }
+        }
+        if (!isStored) {
+          m_droppedFrameCount++;
+        }
 
-  dladdr(reinterpret_cast<void*>(GetModuleAbsoluteDirectoryPath), &dlInfo);
+        // Skip missed deadlines instead of bursting to catch up
+        deadline += period;
+        const auto now = std::chrono::steady_clock::now();
+        while (deadline + period <= now) {
+          deadline += period;
+          m_droppedFrameCount++;
+        }
+      }
+    }
 
-  return std::filesystem::path(dlInfo.dli_fname).parent_path().string();
-}
+  private:
+    std::unique_ptr<ScreenFrameSource> m_source;
+    double m_fps;
+    uint64_t m_durationUs;
+    uint32_t m_keyframeInterval;
+    size_t m_frameSize;
+
+    std::atomic<bool> m_isRunning{false};
+    std::mutex m_stopMutex;
+    std::thread m_captureThread;
+
+    // Ring buffer, guarded by m_ringMutex
+    std::mutex m_ringMutex;
+    std::vector<uint8_t> m_arena;
+    std::vector<FrameSlot> m_slots;
+    size_t m_firstSlot = 0;
+    size_t m_slotCount = 0;
+    size_t m_writeOffset = 0;
+
+    std::atomic<uint64_t> m_droppedFrameCount{0};
+
+    // Capture thread buffers, allocated once
+    std::vector<uint8_t> m_frame;
+    std::vector<uint8_t> m_previousFrame;
+    std::vector<uint8_t> m_delta;
+    std::vector<uint8_t> m_compressedFrame;
+};
 
-std::filesystem::path GetUserDataAbsoluteDirectoryPath() {
-  std::filesystem::path userDataAbsoluteDirectoryPath = (GetModuleAbsoluteDirectoryPath() / "../../data").lexically_normal();
-  std::filesystem::create_directories(userDataAbsoluteDirectoryPath);
-  return userDataAbsoluteDirectoryPath;
-}
+// Shared memory layout of a screen frame feed (see ScreenFrameFeedReader):
+//   header   16 x int32: sequence | slot | width | height | stride | slot count | slots offset | slot size | state
+//   metadata slot count x (int32 sequence | int32 reserved | float64 timestamp in ms)
+//   slots    slot count x packed BGRA pixels, 64-byte aligned
+// A slot sequence is 0 while its pixels are being written, so readers can
+// detect a frame overwritten while they were reading it (seqlock).
+const size_t SCREEN_FRAME_FEED_HEADER_SIZE = 64;
+const size_t SCREEN_FRAME_FEED_SLOT_METADATA_SIZE = 16;
+enum ScreenFrameFeedHeaderField {
+  FEED_SEQUENCE = 0,
+  FEED_SLOT = 1,
+  FEED_WIDTH = 2,
+  FEED_HEIGHT = 3,
+  FEED_STRIDE = 4,
+  FEED_SLOT_COUNT = 5,
+  FEED_SLOTS_OFFSET = 6,
+  FEED_SLOT_SIZE = 7,
+  FEED_STATE = 8,
+};
 
-std::filesystem::path GetUserDataTtsAbsoluteDirectoryPath() {
-  std::filesystem::path userDataTtsAbsoluteDirectoryPath = (GetUserDataAbsoluteDirectoryPath() / "tts").lexically_normal();
-  std::filesystem::create_directories(userDataTtsAbsoluteDirectoryPath);
-  return userDataTtsAbsoluteDirectoryPath;
-}
+// Captures a screen area at a fixed rate straight into a ring of slots living
+// in memory shared with JS (a SharedArrayBuffer), publishing each frame with
+// atomic stores. No copy nor JS call is needed for readers to see new frames.
+class ScreenFrameFeed {
+  public:
+    static size_t requiredMemorySize(const ScreenFrameSource& source, uint32_t slotCount) {
+      return slotsOffset(slotCount) + slotCount * slotSize(source);
+    }
 
-std::filesystem::path GetUserDataTmpAbsoluteDirectoryPath() {
-  std::filesystem::path userDataTmpAbsoluteDirectoryPath = (GetUserDataAbsoluteDirectoryPath() / "tmp").lexically_normal();
-  std::filesystem::create_directories(userDataTmpAbsoluteDirectoryPath);
-  return userDataTmpAbsoluteDirectoryPath;
-}
+    // `memory` must be zero-initialized and at least requiredMemorySize() bytes
+    ScreenFrameFeed(
+      std::unique_ptr<ScreenFrameSource> source,
+      uint8_t* memory,
+      double fps,
+      uint32_t slotCount,
+      std::function<void()> onFrame
+    ) : m_source(std::move(source)),
+        m_memory(memory),
+        m_fps(fps),
+        m_slotCount(std::max(1u, slotCount)),
+        m_onFrame(std::move(onFrame)) {
+      header(FEED_WIDTH).store(m_source->width());
+      header(FEED_HEIGHT).store(m_source->height());
+      header(FEED_STRIDE).store(static_cast<int32_t>(m_source->stride()));
+      header(FEED_SLOT_COUNT).store(static_cast<int32_t>(m_slotCount));
+      header(FEED_SLOTS_OFFSET).store(static_cast<int32_t>(slotsOffset(m_slotCount)));
+      header(FEED_SLOT_SIZE).store(static_cast<int32_t>(slotSize(*m_source)));
+      header(FEED_STATE).store(1);
 
-std::optional<std::filesystem::path> FindFile(
-  const std::filesystem::path& directoryPath,
-  const std::function<bool(const std::filesystem::directory_entry&)>& predicate
-) {
-  for (const auto& entry : std::filesystem::directory_iterator(directoryPath)) {
-    if (predicate(entry)) {
-      return entry.path();
+      m_isRunning = true;
+      m_captureThread = std::thread(&ScreenFrameFeed::captureLoop, this);
     }
-  }
-  return std::nullopt;
-}
 
-template<typename T>
-T ExpectOrThrow(std::optional<T> value, std::string_view errorMessage) {
-  if (!value) {
-    throw std::runtime_error(std::string(errorMessage));
-  }
+    ~ScreenFrameFeed() {
+      stop();
+    }
 
-  return std::move(*value);
-}
+    ScreenFrameFeed(const ScreenFrameFeed&) = delete;
+    ScreenFrameFeed& operator=(const ScreenFrameFeed&) = delete;
 
-std::string ToLower(const std::string& text) {
-  std::string result = text;
-  std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::tolower(c); });
-  return result;
-}
+  public:
+    void stop() {
+      std::lock_guard<std::mutex> stopLock(m_stopMutex);
+      if (m_isRunning.exchange(false)) {
+        m_captureThread.join();
+        header(FEED_STATE).store(0);
+      }
+    }
 
-uint64_t Now() {
-  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-}
+    uint64_t droppedFrameCount() const {
+      return m_droppedFrameCount.load();
+    }
 
-PIX* loadIcoToPix(const std::string& path) {
-  // Initialize FreeImage (safe to call multiple times in modern builds)
-  static bool initialized = false;
-  if (!initialized) {
-    FreeImage_Initialise();
-    initialized = true;
-  }
+  private:
+    static size_t slotSize(const ScreenFrameSource& source) {
+      return (source.stride() * source.height() + 63) & ~static_cast<size_t>(63);
+    }
 
-  FREE_IMAGE_FORMAT fif = FreeImage_GetFileType(path.c_str(), 0);
-  if (fif == FIF_UNKNOWN) {
-    fif = FreeImage_GetFIFFromFilename(path.c_str());
-  }
+    static size_t slotsOffset(uint32_t slotCount) {
+      return (SCREEN_FRAME_FEED_HEADER_SIZE + slotCount * SCREEN_FRAME_FEED_SLOT_METADATA_SIZE + 63) & ~static_cast<size_t>(63);
+    }
 
-  if (fif != FIF_ICO) {
-    return nullptr;
-  }
+    // Shared int32 fields are accessed atomically, like Atomics does in JS
+    std::atomic<int32_t>& header(ScreenFrameFeedHeaderField field) {
+      return *reinterpret_cast<std::atomic<int32_t>*>(m_memory + field * sizeof(int32_t));
+    }
 
-  FIMULTIBITMAP* ico = FreeImage_OpenMultiBitmap(FIF_ICO, path.c_str(), FALSE, TRUE, TRUE, 0);
+    std::atomic<int32_t>& slotSequence(uint32_t slot) {
+      return *reinterpret_cast<std::atomic<int32_t>*>(m_memory + SCREEN_FRAME_FEED_HEADER_SIZE + slot * SCREEN_FRAME_FEED_SLOT_METADATA_SIZE);
+    }
 
-  if (!ico) return nullptr;
+    void captureLoop() {
+      m_source->attachToCurrentThread();
+      const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_fps));
+      const auto startTime = std::chrono::steady_clock::now();
+      const size_t frameSlotSize = slotSize(*m_source);
+      const size_t frameSlotsOffset = slotsOffset(m_slotCount);
+      auto deadline = startTime;
+      int32_t sequence = 0;
 
-  int count = FreeImage_GetPageCount(ico);
-  if (count <= 0) {
-    FreeImage_CloseMultiBitmap(ico, 0);
-    return nullptr;
-  }
+      while (m_isRunning.load()) {
+        std::this_thread::sleep_until(deadline);
+        if (!m_isRunning.load()) break;
 
-  FIBITMAP* best = nullptr;
-  int best_w = 0, best_h = 0;
+        // Write to the oldest slot, readers of the newest one are never disturbed
+        uint32_t slot = static_cast<uint32_t>(sequence) % m_slotCount;
+        slotSequence(slot).store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
 
-  // pick largest icon frame
-  for (int i = 0; i < count; i++) {
-    FIBITMAP* frame = FreeImage_LockPage(ico, i);
-    if (!frame) continue;
+        double timestampMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        if (m_source->grab(m_memory + frameSlotsOffset + slot * frameSlotSize)) {
+          sequence = sequence == INT32_MAX ? 1 : sequence + 1;
+          std::memcpy(m_memory + SCREEN_FRAME_FEED_HEADER_SIZE + slot * SCREEN_FRAME_FEED_SLOT_METADATA_SIZE + 8, &timestampMs, sizeof(double));
+          slotSequence(slot).store(sequence, std::memory_order_release);
+          header(FEED_SLOT).store(static_cast<int32_t>(slot), std::memory_order_relaxed);
+          header(FEED_SEQUENCE).store(sequence, std::memory_order_release);
+          m_onFrame();
+        }
+        else {
+          m_droppedFrameCount++;
+        }
 
-    int w = FreeImage_GetWidth(frame);
-    int h = FreeImage_GetHeight(frame);
+        // Skip missed deadlines instead of bursting to catch up
+        deadline += period;
+        const auto now = std::chrono::steady_clock::now();
+        while (deadline + period <= now) {
+          deadline += period;
+          m_droppedFrameCount++;
+        }
+      }
+    }
 
-    if (w * h > best_w * best_h) {
-      best_w = w;
-      best_h = h;
+  private:
+    std::unique_ptr<ScreenFrameSource> m_source;
+    uint8_t* m_memory;
+    double m_fps;
+    uint32_t m_slotCount;
+    std::function<void()> m_onFrame;
+
+    std::atomic<bool> m_isRunning{false};
+    std::mutex m_stopMutex;
+    std::thread m_captureThread;
+    std::atomic<uint64_t> m_droppedFrameCount{0};
+};
 
-      if (best) FreeImage_UnlockPage(ico, best, FALSE);
-      best = FreeImage_Clone(frame);
+// Bounded LRU cache of OCR results, keyed by image content hash and OCR
+// settings. Hit and miss counters help sizing it.
+class OcrResultCache {
+  public:
+    struct Stats {
+      uint64_t hits;
+      uint64_t misses;
+      size_t size;
+      size_t capacity;
+    };
+
+    explicit OcrResultCache(size_t capacity) : m_capacity(capacity) {}
+
+    OcrResultCache(const OcrResultCache&) = delete;
+    OcrResultCache& operator=(const OcrResultCache&) = delete;
+
+    std::optional<OcrResult> get(const std::string& key) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto entry = m_index.find(key);
+      if (entry == m_index.end()) {
+        m_misses++;
+        return std::nullopt;
+      }
+      m_hits++;
+      // Most recently used first
+      m_entries.splice(m_entries.begin(), m_entries, entry->second);
+      return entry->second->second;
     }
 
-    FreeImage_UnlockPage(ico, frame, FALSE);
-  }
+    void put(const std::string& key, const OcrResult& result) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_capacity == 0) {
+        return;
+      }
+      auto entry = m_index.find(key);
+      if (entry != m_index.end()) {
+        entry->second->second = result;
+        m_entries.splice(m_entries.begin(), m_entries, entry->second);
+        return;
+      }
+      m_entries.emplace_front(key, result);
+      m_index[key] = m_entries.begin();
+      evict();
+    }
 
-  FreeImage_CloseMultiBitmap(ico, 0);
+    void resize(size_t capacity) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_capacity = capacity;
+      evict();
+    }
 
-  if (!best) return nullptr;
+    // Drop all entries and reset the counters
+    void clear() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_entries.clear();
+      m_index.clear();
+      m_hits = 0;
+      m_misses = 0;
+    }
 
-  // Convert to 32-bit RGBA
-  FIBITMAP* rgba = FreeImage_ConvertTo32Bits(best);
-  FreeImage_Unload(best);
+    Stats stats() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return { m_hits, m_misses, m_entries.size(), m_capacity };
+    }
 
-  if (!rgba) return nullptr;
+  private:
+    // Drop least recently used entries beyond capacity. Requires the lock.
+    void evict() {
+      while (m_entries.size() > m_capacity) {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+      }
+    }
 
-  int width  = FreeImage_GetWidth(rgba);
-  int height = FreeImage_GetHeight(rgba);
+    std::mutex m_mutex;
+    std::list<std::pair<std::string, OcrResult>> m_entries;
+    std::unordered_map<std::string, std::list<std::pair<std::string, OcrResult>>::iterator> m_index;
+    size_t m_capacity;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+};
 
-  unsigned char* src = FreeImage_GetBits(rgba);
-  int src_pitch = FreeImage_GetPitch(rgba);
+// Input sequence program: flat int32 records of
+//   opcode | first argument | second argument | delay in us since the previous event
+// Buttons are 1 (left), 2 (middle), 3 (right), 4 and 5 (extra buttons 1 and 2).
+// Scroll amounts are positive downwards.
+const size_t INPUT_SEQUENCE_RECORD_SIZE = 4;
+
+enum class InputSequenceOpcode : int32_t {
+  Move = 0, // x | y
+  ButtonDown = 1, // button
+  ButtonUp = 2, // button
+  Scroll = 3, // amount
+  KeyDown = 4, // key symbol
+  KeyUp = 5, // key symbol
+};
 
-  // Leptonica expects packed RGBA or RGB; we will build RGBA PIX
-  PIX* pix = pixCreate(width, height, 32);
-  if (!pix) {
-    FreeImage_Unload(rgba);
-    return nullptr;
-  }
+// Sleep until an absolute steady clock deadline (steady_clock is CLOCK_MONOTONIC).
+// With a spin window, the thread only sleeps until the window opens, then
+// busy-waits for the deadline: it trades CPU time for the timer slack and
+// wake-up latency of the scheduler.
+void SleepUntil(std::chrono::steady_clock::time_point deadline, std::chrono::microseconds spinWindow = std::chrono::microseconds(0)) {
+  const auto sinceEpoch = (deadline - spinWindow).time_since_epoch();
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+  timespec target{
+    static_cast<time_t>(seconds.count()),
+    static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch - seconds).count())
+  };
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR) { }
+  while (std::chrono::steady_clock::now() < deadline) { }
+}
 
-  for (int y = 0; y < height; y++) {
-    unsigned char* src_row = src + y * src_pitch;
+// Spin window of precise sleeps, above the default timer slack (50 us)
+const std::chrono::microseconds PRECISE_SLEEP_SPIN_WINDOW(200);
 
-    for (int x = 0; x < width; x++) {
-      unsigned char b = src_row[4 * x + 0];
-      unsigned char g = src_row[4 * x + 1];
-      unsigned char r = src_row[4 * x + 2];
-      // unsigned char a = src_row[4 * x + 3];
+// Margin before a deadline below which interruptible waits stop waiting on a
+// condition variable and sleep on the monotonic clock instead
+const std::chrono::microseconds TIMER_SLEEP_MARGIN(2000);
 
-      pixSetRGBPixel(pix, x, y, r, g, b);
-    }
-  }
+// Number of characters typed between two flushes when text is typed without
+// delay, so that the server starts processing a long text early
+const size_t TEXT_FLUSH_CHUNK_SIZE = 64;
 
-  FreeImage_Unload(rgba);
-  return pix;
+// Delay left to clients to translate the key events typed with remapped key
+// codes, before those key codes are remapped again
+const std::chrono::milliseconds TEXT_KEYMAP_SETTLE_DELAY(20);
+
+// Unicode notation of a code point (U+00E9)
+std::string FormatCodePoint(char32_t character) {
+  std::ostringstream stream;
+  stream << "U+" << std::uppercase << std::hex << std::setw(4) << std::setfill('0') << static_cast<uint32_t>(character);
+  return stream.str();
 }
 
-void globalFltkCallbackWrapper(void* data) {
-  globalFltkCallback();
+// Key symbol typing a character, NoSymbol for control characters without key
+KeySym CharacterToKeySym(char32_t character) {
+  if (character == U'\n' || character == U'\r') {
+    return XK_Return;
+  }
+  if (character == U'\t') {
+    return XK_Tab;
+  }
+  if (character < 0x20 || (character >= 0x7F && character < 0xA0) || character > 0x10FFFF) {
+    return NoSymbol;
+  }
+  // Latin-1 key symbols are their code points, the others are offset
+  if (character <= 0xFF) {
+    return static_cast<KeySym>(character);
+  }
+  return static_cast<KeySym>(0x01000000 | character);
 }
 
+// Key typing a key symbol with the current keyboard layout
+struct TypedKey {
+  KeyCode keyCode = 0;
+  bool isShifted = false;
+};
 
-// =============================================================================
-// ============================= RESOURCE CLEANUP ==============================
-// =============================================================================
+// Keyboard layout read once per typed text, so that characters are mapped
+// without a round trip each
+struct TextKeyboardLayout {
+  // Keys of the printable ASCII characters, by code point
+  std::array<TypedKey, 128> ascii{};
+  std::unordered_map<KeySym, TypedKey> keys;
+  // Key codes without any key symbol, remapped to type the characters the
+  // layout lacks
+  std::vector<KeyCode> spareKeyCodes;
+  KeyCode shiftKeyCode = 0;
+
+  static TextKeyboardLayout read(Display* display) {
+    TextKeyboardLayout layout;
+    int minKeyCode = 0;
+    int maxKeyCode = 0;
+    XDisplayKeycodes(display, &minKeyCode, &maxKeyCode);
+    int keySymsPerKeyCode = 0;
+    KeySym* mapping = XGetKeyboardMapping(display, minKeyCode, maxKeyCode - minKeyCode + 1, &keySymsPerKeyCode);
+    if (!mapping) {
+      throw std::runtime_error("Failed to read the keyboard mapping.");
+    }
+    XkbStateRec state{};
+    XkbGetState(display, XkbUseCoreKbd, &state);
+    const bool isCapsLocked = (state.locked_mods & LockMask) != 0;
+
+    for (int keyCode = minKeyCode; keyCode <= maxKeyCode; keyCode++) {
+      const KeySym* keySyms = &mapping[(keyCode - minKeyCode) * keySymsPerKeyCode];
+      if (std::all_of(keySyms, keySyms + keySymsPerKeyCode, [](KeySym keySym) { return keySym == NoSymbol; })) {
+        layout.spareKeyCodes.push_back(static_cast<KeyCode>(keyCode));
+        continue;
+      }
+      // The core mapping only describes the first two groups (two columns
+      // each), keys without symbols in the second group type the first one
+      if (state.group > 1) {
+        continue;
+      }
+      int column = state.group * 2;
+      if (column >= keySymsPerKeyCode || (keySyms[column] == NoSymbol && (column + 1 >= keySymsPerKeyCode || keySyms[column + 1] == NoSymbol))) {
+        column = 0;
+      }
+      KeySym levels[2] = { keySyms[column], column + 1 < keySymsPerKeyCode ? keySyms[column + 1] : NoSymbol };
+      // Letters listed alone type their upper case with Shift, and Caps Lock
+      // swaps both levels
+      KeySym lower = NoSymbol;
+      KeySym upper = NoSymbol;
+      XConvertCase(levels[0], &lower, &upper);
+      const bool isAlphabetic = lower != upper && (levels[1] == NoSymbol || levels[1] == upper);
+      if (isAlphabetic) {
+        levels[0] = lower;
+        levels[1] = upper;
+      }
+      for (int level = 0; level < 2; level++) {
+        if (levels[level] == NoSymbol) {
+          continue;
+        }
+        TypedKey key{ static_cast<KeyCode>(keyCode), (level == 1) != (isAlphabetic && isCapsLocked) };
+        // The lowest key code wins, like XKeysymToKeycode
+        if (layout.keys.emplace(levels[level], key).second && levels[level] < layout.ascii.size()) {
+          layout.ascii[levels[level]] = key;
+        }
+      }
+    }
+    XFree(mapping);
 
-void CleanInputEventListener() {
-  if (inputEventRunning.load()) {
-    inputEventRunning = false;
-    {
-      std::unique_lock<std::mutex> lock(inputEventHookMutex);
-      Display* inputDisplay = GetInputDisplay();
-      Window rootWindow = DefaultRootWindow(inputDisplay);
+    auto shiftKey = layout.keys.find(XK_Shift_L);
+    if (shiftKey != layout.keys.end() && !shiftKey->second.isShifted) {
+      layout.shiftKeyCode = shiftKey->second.keyCode;
+    }
+    return layout;
+  }
 
-      XClientMessageEvent dummyEvent;
-      dummyEvent.type = ClientMessage;
-      dummyEvent.serial = CurrentTime;
-      dummyEvent.send_event = True;
-      dummyEvent.display = inputDisplay;
-      dummyEvent.window = rootWindow;
-      dummyEvent.format = 32;
+  // Key typing the key symbol, or a key code of 0 if the layout lacks it
+  TypedKey find(KeySym keySym) const {
+    if (keySym < ascii.size()) {
+      return ascii[keySym];
+    }
+    auto key = keys.find(keySym);
+    return key != keys.end() ? key->second : TypedKey{};
+  }
+};
 
-      XSendEvent(inputDisplay, rootWindow, False, PropertyChangeMask, reinterpret_cast<XEvent*>(&dummyEvent));
+// Runs input sequence programs one after another on a dedicated thread and
+// its own X connection, so that sequences never interleave. Events are sent
+// on absolute deadlines (delays never drift) and flushed once per deadline.
+class InputSequencer {
+  public:
+    // Called on the sequencer thread once a program ran, with the error that
+    // interrupted it if any
+    using Callback = std::function<void(std::exception_ptr)>;
 
-      XSync(inputDisplay, False);
-    }
+    InputSequencer() { }
 
-    if (inputEventThread.joinable()) {
-      inputEventThread.join();
+    ~InputSequencer() {
+      stop();
     }
 
-    inputEventThreadSafeJsFunction.Abort();
-  }
-}
+    InputSequencer(const InputSequencer&) = delete;
+    InputSequencer& operator=(const InputSequencer&) = delete;
 
-void CleanWindowEventListener() {
-  if (windowEventRunning.load()) {
-    windowEventRunning = false;
-    {
-      std::unique_lock<std::mutex> lock(windowEventHookMutex);
-      Display* windowDisplay = GetWindowDisplay();
-      Window rootWindow = DefaultRootWindow(windowDisplay);
+  public:
+    void submit(std::vector<int32_t> program, Callback onDone) {
+      push({ std::move(program), std::move(onDone) });
+    }
 
-      XClientMessageEvent dummyEvent;
-      dummyEvent.type = ClientMessage;
-      dummyEvent.serial = CurrentTime;
-      dummyEvent.send_event = True;
-      dummyEvent.display = windowDisplay;
-      dummyEvent.window = rootWindow;
-      dummyEvent.format = 32;
+    // Type a text, waiting the interval before each character
+    void submitText(std::u32string text, std::chrono::microseconds interval, Callback onDone) {
+      push({ {}, std::move(onDone), std::move(text), interval });
+    }
 
-      XSendEvent(windowDisplay, rootWindow, False, PropertyChangeMask, reinterpret_cast<XEvent*>(&dummyEvent));
+    // Interrupt the running program and cancel the queued ones
+    void stop() {
+      std::thread thread;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isRunning = false;
+        thread = std::move(m_thread);
+      }
+      m_condition.notify_all();
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
 
-      XSync(windowDisplay, False);
+  private:
+    struct Job {
+      std::vector<int32_t> program;
+      Callback onDone;
+      std::u32string text;
+      std::chrono::microseconds interval{0};
+    };
+
+    void push(Job job) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_thread.joinable()) {
+        m_isRunning = true;
+        m_thread = std::thread(&InputSequencer::run, this);
+      }
+      m_jobs.push(std::move(job));
+      m_condition.notify_all();
     }
 
-    if (windowEventThread.joinable()) {
-      windowEventThread.join();
+    void run() {
+      Display* display = XOpenDisplay(nullptr);
+      while (true) {
+        Job job;
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          m_condition.wait(lock, [this] { return !m_jobs.empty() || !m_isRunning; });
+          if (!m_isRunning) break;
+          job = std::move(m_jobs.front());
+          m_jobs.pop();
+        }
+        std::exception_ptr error;
+        try {
+          if (!display) {
+            throw std::runtime_error("Failed to open X display.");
+          }
+          if (!job.text.empty()) {
+            type(display, job.text, job.interval);
+          }
+          else {
+            execute(display, job.program);
+          }
+        }
+        catch (...) {
+          error = std::current_exception();
+        }
+        job.onDone(error);
+      }
+
+      std::queue<Job> cancelledJobs;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(cancelledJobs, m_jobs);
+      }
+      for (; !cancelledJobs.empty(); cancelledJobs.pop()) {
+        cancelledJobs.front().onDone(std::make_exception_ptr(std::runtime_error("Input sequence was cancelled.")));
+      }
+      if (display) {
+        XCloseDisplay(display);
+      }
     }
 
-    windowEventThreadSafeJsFunction.Abort();
-  }
-}
+    // Interruptible coarse wait, then a precise sleep for the last milliseconds.
+    // Returns false when the sequencer was stopped meanwhile.
+    bool waitUntil(std::chrono::steady_clock::time_point deadline) {
+      const auto coarseDeadline = deadline - std::chrono::milliseconds(2);
+      if (std::chrono::steady_clock::now() < coarseDeadline) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_condition.wait_until(lock, coarseDeadline, [this] { return !m_isRunning.load(); })) {
+          return false;
+        }
+      }
+      SleepUntil(deadline);
+      return m_isRunning.load();
+    }
+
+    void execute(Display* display, const std::vector<int32_t>& program) {
+      const size_t eventCount = program.size() / INPUT_SEQUENCE_RECORD_SIZE;
+
+      // Resolve key codes up front, so that an unknown key never leaves a
+      // sequence half sent
+      std::vector<KeyCode> keyCodes(eventCount, 0);
+      for (size_t i = 0; i < eventCount; i++) {
+        const int32_t* record = &program[i * INPUT_SEQUENCE_RECORD_SIZE];
+        auto opcode = static_cast<InputSequenceOpcode>(record[0]);
+        if (opcode == InputSequenceOpcode::KeyDown || opcode == InputSequenceOpcode::KeyUp) {
+          keyCodes[i] = XKeysymToKeycode(display, static_cast<KeySym>(record[1]));
+          if (keyCodes[i] == 0) {
+            throw std::runtime_error("Invalid key symbol.");
+          }
+        }
+      }
 
-void CleanClipboardEventListener() {
-  if (clipboardEventRunning.load()) {
-    clipboardEventRunning = false;
-    Display* clipboardDisplay = GetClipboardDisplay();
-    Window rootWindow = DefaultRootWindow(clipboardDisplay);
-    {
-      std::unique_lock<std::mutex> lock(clipboardEventHookMutex);
+      // X11 button numbers of sequence buttons
+      static const unsigned int buttons[] = { 0, 1, 2, 3, 8, 9 };
+      auto deadline = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < eventCount; i++) {
+        const int32_t* record = &program[i * INPUT_SEQUENCE_RECORD_SIZE];
+        if (record[3] > 0) {
+          // Send the events due at the previous deadline before sleeping
+          XFlush(display);
+          deadline += std::chrono::microseconds(record[3]);
+          if (!waitUntil(deadline)) {
+            throw std::runtime_error("Input sequence was cancelled.");
+          }
+        }
+        else if (!m_isRunning.load()) {
+          throw std::runtime_error("Input sequence was cancelled.");
+        }
 
-      XClientMessageEvent dummyEvent;
-      dummyEvent.type = ClientMessage;
-      dummyEvent.serial = CurrentTime;
-      dummyEvent.send_event = True;
-      dummyEvent.display = clipboardDisplay;
-      dummyEvent.window = rootWindow;
-      dummyEvent.format = 32;
+        switch (static_cast<InputSequenceOpcode>(record[0])) {
+          case InputSequenceOpcode::Move:
+            XTestFakeMotionEvent(display, 0, record[1], record[2], CurrentTime);
+            break;
+          case InputSequenceOpcode::ButtonDown:
+            XTestFakeButtonEvent(display, buttons[record[1]], True, CurrentTime);
+            break;
+          case InputSequenceOpcode::ButtonUp:
+            XTestFakeButtonEvent(display, buttons[record[1]], False, CurrentTime);
+            break;
+          case InputSequenceOpcode::Scroll: {
+            unsigned int wheelButton = record[1] > 0 ? 5 : 4;
+            for (int32_t scroll = 0; scroll < std::abs(record[1]); scroll++) {
+              XTestFakeButtonEvent(display, wheelButton, True, CurrentTime);
+              XTestFakeButtonEvent(display, wheelButton, False, CurrentTime);
+            }
+            break;
+          }
+          case InputSequenceOpcode::KeyDown:
+            XTestFakeKeyEvent(display, keyCodes[i], True, CurrentTime);
+            break;
+          case InputSequenceOpcode::KeyUp:
+            XTestFakeKeyEvent(display, keyCodes[i], False, CurrentTime);
+            break;
+        }
+      }
+      XFlush(display);
+    }
+
+    // Type a text with the keys of the current layout. Characters the layout
+    // lacks are typed with spare key codes, remapped in batches: clients are
+    // left TEXT_KEYMAP_SETTLE_DELAY to translate the typed keys before their
+    // key codes are remapped again, and restored.
+    void type(Display* display, const std::u32string& text, std::chrono::microseconds interval) {
+      const TextKeyboardLayout layout = TextKeyboardLayout::read(display);
+
+      // Resolve every character up front, so that an untypable character
+      // never leaves a text half typed. Characters the layout lacks keep their
+      // key symbol, to map on a spare key code.
+      struct Stroke {
+        TypedKey key;
+        KeySym remappedKeySym = NoSymbol;
+      };
+      std::vector<Stroke> strokes;
+      strokes.reserve(text.size());
+      for (size_t i = 0; i < text.size(); i++) {
+        // Type line breaks once
+        if (text[i] == U'\r' && i + 1 < text.size() && text[i + 1] == U'\n') {
+          continue;
+        }
+        KeySym keySym = CharacterToKeySym(text[i]);
+        if (keySym == NoSymbol) {
+          throw std::runtime_error("Cannot type the control character " + FormatCodePoint(text[i]) + ".");
+        }
+        TypedKey key = layout.find(keySym);
+        if (key.keyCode != 0 && (!key.isShifted || layout.shiftKeyCode != 0)) {
+          strokes.push_back({ key, NoSymbol });
+        }
+        else if (!layout.spareKeyCodes.empty()) {
+          strokes.push_back({ {}, keySym });
+        }
+        else {
+          throw std::runtime_error("No spare key code to type the character " + FormatCodePoint(text[i]) + ".");
+        }
+      }
 
-      XSendEvent(clipboardDisplay, rootWindow, False, PropertyChangeMask, reinterpret_cast<XEvent*>(&dummyEvent));
+      // Key codes of the remapped key symbols of the current batch
+      std::unordered_map<KeySym, KeyCode> remappedKeyCodes;
+      // Every spare key code remapped so far, batches being of any size
+      std::set<KeyCode> usedSpareKeyCodes;
+      bool isShiftPressed = false;
+      auto release = [&]() {
+        if (isShiftPressed) {
+          XTestFakeKeyEvent(display, layout.shiftKeyCode, False, CurrentTime);
+          isShiftPressed = false;
+        }
+        XSync(display, False);
+        if (usedSpareKeyCodes.empty()) {
+          return;
+        }
+        std::this_thread::sleep_for(TEXT_KEYMAP_SETTLE_DELAY);
+        KeySym noSymbols[2] = { NoSymbol, NoSymbol };
+        for (KeyCode spareKeyCode : usedSpareKeyCodes) {
+          XChangeKeyboardMapping(display, spareKeyCode, 2, noSymbols, 1);
+        }
+        XSync(display, False);
+        usedSpareKeyCodes.clear();
+        remappedKeyCodes.clear();
+      };
 
-      XSync(clipboardDisplay, False);
-    }
+      try {
+        auto deadline = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < strokes.size(); i++) {
+          const Stroke& stroke = strokes[i];
+          KeyCode keyCode = stroke.key.keyCode;
+          if (stroke.remappedKeySym != NoSymbol) {
+            auto remappedKeyCode = remappedKeyCodes.find(stroke.remappedKeySym);
+            if (remappedKeyCode == remappedKeyCodes.end()) {
+              // Map the next missing key symbols on the spare key codes, once
+              // the previous ones were typed
+              if (!remappedKeyCodes.empty()) {
+                XSync(display, False);
+                if (!waitUntil(std::chrono::steady_clock::now() + TEXT_KEYMAP_SETTLE_DELAY)) {
+                  throw std::runtime_error("Input sequence was cancelled.");
+                }
+                remappedKeyCodes.clear();
+              }
+              for (size_t j = i; j < strokes.size() && remappedKeyCodes.size() < layout.spareKeyCodes.size(); j++) {
+                KeySym keySym = strokes[j].remappedKeySym;
+                if (keySym == NoSymbol || remappedKeyCodes.count(keySym)) {
+                  continue;
+                }
+                KeyCode spareKeyCode = layout.spareKeyCodes[remappedKeyCodes.size()];
+                // Same key symbol on both levels, whatever the modifiers
+                KeySym keySyms[2] = { keySym, keySym };
+                XChangeKeyboardMapping(display, spareKeyCode, 2, keySyms, 1);
+                remappedKeyCodes.emplace(keySym, spareKeyCode);
+                usedSpareKeyCodes.insert(spareKeyCode);
+              }
+              XSync(display, False);
+              deadline = std::max(deadline, std::chrono::steady_clock::now());
+              remappedKeyCode = remappedKeyCodes.find(stroke.remappedKeySym);
+            }
+            keyCode = remappedKeyCode->second;
+          }
 
-    if (clipboardEventThread.joinable()) {
-      clipboardEventThread.join();
-    }
+          if (interval.count() > 0) {
+            // Send the previous character before sleeping
+            XFlush(display);
+            deadline += interval;
+            if (!waitUntil(deadline)) {
+              throw std::runtime_error("Input sequence was cancelled.");
+            }
+          }
+          else if (i % TEXT_FLUSH_CHUNK_SIZE == 0) {
+            XFlush(display);
+            if (!m_isRunning.load()) {
+              throw std::runtime_error("Input sequence was cancelled.");
+            }
+          }
 
-    {
-      std::unique_lock<std::mutex> lock(clipboardEventHookMutex);
-      // Reset clipboard window
-      if (clipboardWindow != None) {
-        // Unset our clipboard ownership
-        if (XGetSelectionOwner(clipboardDisplay, GetAtom("CLIPBOARD", clipboardDisplay)) == clipboardWindow) {
-          XSetSelectionOwner(clipboardDisplay, GetAtom("CLIPBOARD", clipboardDisplay), None, CurrentTime);
+          // Remapped key codes type the same key symbol with or without Shift
+          if (stroke.remappedKeySym == NoSymbol && stroke.key.isShifted != isShiftPressed) {
+            XTestFakeKeyEvent(display, layout.shiftKeyCode, stroke.key.isShifted, CurrentTime);
+            isShiftPressed = stroke.key.isShifted;
+          }
+          XTestFakeKeyEvent(display, keyCode, True, CurrentTime);
+          XTestFakeKeyEvent(display, keyCode, False, CurrentTime);
         }
-        // Destroy our clipboard window
-        XDestroyWindow(clipboardDisplay, clipboardWindow);
-        XSync(clipboardDisplay, False);
-        // Reset our clipboard window variable
-        clipboardWindow = None;
       }
-      // Reset clipboard text
-      clipboardTextContent.clear();
-      // Reset clipboard timestamp
-      clipboardOwnershipTakenAt = 0;
+      catch (...) {
+        release();
+        throw;
+      }
+      release();
     }
-  }
-}
 
-void CloseTrayIconContextMenu() {
-  if (isFltkTrayIconContextMenuOpen.load()) {
-    // Close tray icon context menu with [Escape] key.
-    KeyCode keyCode = XKeysymToKeycode(fl_display, XK_Escape);
-    if (keyCode > 0) {
-      XTestFakeKeyEvent(fl_display, keyCode, True, CurrentTime);
-      XTestFakeKeyEvent(fl_display, keyCode, False, CurrentTime);
-      XSync(fl_display, False);
-      // wait for FLTK to process the event
-      Fl::wait(0);
-      // Note: FLTK has a bug and will hang if [Escape] is pressed
-      //       physically or programatically when another window
-      //       achieves to take focus when FLTK's context menu
-      //       should have it FLTK and considers so. In such (rare)
-      //       cases, nothing can be done except force killing the process.
-    }
-  }
-}
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::queue<Job> m_jobs;
+    std::atomic<bool> m_isRunning{false};
+    std::thread m_thread;
+};
 
-void CleanFltkEventListener() {
-  if (fltkEventRunning.load()) {
+// Fires asynchronous sleeps on a dedicated thread. Timers are kept in a
+// min-heap of absolute deadlines: the thread waits on its condition variable
+// (on the monotonic clock) until the earliest timer is due, or until the spin
+// window of precise timers opens, then spins their last microseconds.
+class TimerService {
+  public:
+    // Called on the timer thread when the timer is due, or with true when the
+    // service was stopped before
+    using Callback = std::function<void(bool isCancelled)>;
 
-    {
-      std::unique_lock<std::mutex> lock(fltkEventHookMutex);
-      // Ensure tray icon context menu is closed. Otherwise, the fltkEventThread
-      // will hang until the user closes it manually.
-      CloseTrayIconContextMenu();
+    TimerService() { }
+
+    ~TimerService() {
+      stop();
     }
 
-    fltkEventRunning = false;
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
 
-    if (fltkEventThread.joinable()) {
-      fltkEventThread.join();
+  public:
+    void schedule(std::chrono::steady_clock::time_point deadline, bool isPrecise, Callback onDue) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_thread.joinable()) {
+        m_isRunning = true;
+        m_thread = std::thread(&TimerService::run, this);
+      }
+      m_timers.push_back({ deadline, isPrecise, m_nextSequence++, std::move(onDue) });
+      std::push_heap(m_timers.begin(), m_timers.end(), IsLater());
+      m_condition.notify_all();
     }
 
-    {
-      std::unique_lock<std::mutex> lock(fltkEventHookMutex);
-      globalFltkWindow = nullptr;
-      globalFltkCallback = [](){};
+    // Cancel the pending timers
+    void stop() {
+      std::thread thread;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isRunning = false;
+        thread = std::move(m_thread);
+      }
+      m_condition.notify_all();
+      if (thread.joinable()) {
+        thread.join();
+      }
     }
 
-  }
+  private:
+    struct Timer {
+      std::chrono::steady_clock::time_point deadline;
+      bool isPrecise;
+      // Keeps timers sharing a deadline in scheduling order
+      uint64_t sequence;
+      Callback onDue;
+    };
+
+    struct IsLater {
+      bool operator()(const Timer& a, const Timer& b) const {
+        return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
+      }
+    };
+
+    void run() {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (m_isRunning) {
+        if (m_timers.empty()) {
+          m_condition.wait(lock);
+          continue;
+        }
+        // Leave the earliest timer in the heap while waiting, and look again on
+        // wake-up since an earlier timer may have been scheduled meanwhile
+        const Timer& next = m_timers.front();
+        const auto spinWindow = next.isPrecise ? PRECISE_SLEEP_SPIN_WINDOW : std::chrono::microseconds(0);
+        if (std::chrono::steady_clock::now() < next.deadline - spinWindow) {
+          m_condition.wait_until(lock, next.deadline - spinWindow);
+          continue;
+        }
+        std::pop_heap(m_timers.begin(), m_timers.end(), IsLater());
+        Timer timer = std::move(m_timers.back());
+        m_timers.pop_back();
+        lock.unlock();
+        SleepUntil(timer.deadline, spinWindow);
+        timer.onDue(false);
+        lock.lock();
+      }
+
+      std::vector<Timer> cancelledTimers;
+      std::swap(cancelledTimers, m_timers);
+      lock.unlock();
+      for (Timer& timer : cancelledTimers) {
+        timer.onDue(true);
+      }
+    }
+
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<Timer> m_timers;
+    uint64_t m_nextSequence = 0;
+    bool m_isRunning = false;
+    std::thread m_thread;
+};
+
+// Numeric fields of an input event, as delivered in batches and rings.
+// Mouse inputs are numbered as in input recordings (0 move, 1 left, 2 right,
+// 3 middle, 4 wheel, 5 extraButton1, 6 extraButton2), keyboard inputs are key
+// codes. Flags are 1 for suppressed and 2 for injected events.
+struct EncodedInputEvent {
+  int32_t type; // 0 mouse, 1 keyboard
+  int32_t input;
+  int32_t state; // 0 down, 1 up, 2 neutral
+  int32_t flags;
+};
+
+EncodedInputEvent EncodeInputEvent(const RawInputEvent& event) {
+  EncodedInputEvent encoded;
+  encoded.type = static_cast<int32_t>(event.type);
+  encoded.input = event.input;
+  encoded.state = static_cast<int32_t>(event.state);
+  encoded.flags = (event.isSuppressed ? 1 : 0) | (event.isInjected ? 2 : 0);
+  return encoded;
 }
 
-void CleanTrayIconEventListener() {
-  if (trayIconEventRunning.load()) {
-    trayIconEventRunning = false;
-    Display* trayIconDisplay = GetTrayIconDisplay();
-    Window rootWindow = DefaultRootWindow(trayIconDisplay);
-    {
-      std::unique_lock<std::mutex> lock(trayIconEventHookMutex);
+// Input events JavaScript subscribed to (see setInputEventFilter). Empty key
+// and mouse input sets accept every key and button.
+struct InputEventFilter {
+  bool isKeyboardEnabled = true;
+  bool isMouseEnabled = true;
+  bool isMotionEnabled = true;
+  bool isInjectedEnabled = true;
+  bool isPhysicalEnabled = true;
+  std::set<int32_t> keys;
+  std::set<int32_t> mouseInputs;
 
-      XClientMessageEvent dummyEvent;
-      dummyEvent.type = ClientMessage;
-      dummyEvent.serial = CurrentTime;
-      dummyEvent.send_event = True;
-      dummyEvent.display = trayIconDisplay;
-      dummyEvent.window = rootWindow;
-      dummyEvent.format = 32;
+  bool accepts(const EncodedInputEvent& event) const {
+    if (!((event.flags & 2) ? isInjectedEnabled : isPhysicalEnabled)) {
+      return false;
+    }
+    if (event.type == 1) {
+      return isKeyboardEnabled && (keys.empty() || keys.count(event.input) > 0);
+    }
+    if (event.input == 0) {
+      return isMotionEnabled;
+    }
+    return isMouseEnabled && (mouseInputs.empty() || mouseInputs.count(event.input) > 0);
+  }
+};
 
-      XSendEvent(trayIconDisplay, rootWindow, False, NoEventMask, reinterpret_cast<XEvent*>(&dummyEvent));
+// Input events batched for JavaScript, as flat records of
+//   type | input | state | x | y | timestamp | flags
+// (see EncodedInputEvent)
+const size_t INPUT_EVENT_RECORD_SIZE = 7;
 
-      XSync(trayIconDisplay, False);
+class InputEventBatch {
+  public:
+    InputEventBatch() { }
+
+  public:
+    bool empty() const {
+      return m_records.empty();
     }
 
-    if (trayIconEventThread.joinable()) {
-      trayIconEventThread.join();
+    size_t size() const {
+      return m_records.size() / INPUT_EVENT_RECORD_SIZE;
     }
 
-    {
-      std::unique_lock<std::mutex> lock(trayIconEventHookMutex);
-      // Reset tray icon window
-      if (trayIconWindow != None) {
-        XDestroyWindow(trayIconDisplay, trayIconWindow);
-        // Reset our tray icon window variable
-        trayIconWindow = None;
-      }
-      // Reset tray icon graphics context
-      if (trayIconGraphicsContext != None) {
-        // Free our tray icon graphics context
-        XFreeGC(trayIconDisplay, trayIconGraphicsContext);
-        // Reset our tray icon graphics context variable
-        trayIconGraphicsContext = None;
+    // When the first event of the batch was added
+    std::chrono::steady_clock::time_point startedAt() const {
+      return m_startedAt;
+    }
+
+    // Add an event. With motion coalescing, a motion following another one
+    // replaces it, so that only the latest position between two other events
+    // is kept.
+    void add(const RawInputEvent& event, bool isMotionCoalesced) {
+      EncodedInputEvent encoded = EncodeInputEvent(event);
+      if (m_records.empty()) {
+        m_startedAt = std::chrono::steady_clock::now();
       }
-      if (trayIconImage != nullptr) {
-        // Free our tray icon image
-        XDestroyImage(trayIconImage);
-        // Reset our tray icon image variable
-        trayIconImage = nullptr;
+      else if (isMotionCoalesced && encoded.type == 0 && encoded.input == 0) {
+        double* last = &m_records[m_records.size() - INPUT_EVENT_RECORD_SIZE];
+        if (last[0] == 0 && last[1] == 0 && last[6] == encoded.flags) {
+          last[3] = event.x;
+          last[4] = event.y;
+          last[5] = static_cast<double>(event.timestamp);
+          return;
+        }
       }
+      m_records.insert(m_records.end(), {
+        static_cast<double>(encoded.type),
+        static_cast<double>(encoded.input),
+        static_cast<double>(encoded.state),
+        static_cast<double>(event.x),
+        static_cast<double>(event.y),
+        static_cast<double>(event.timestamp),
+        static_cast<double>(encoded.flags)
+      });
     }
-  }
-}
 
-void CleanAll() {
-  XSetErrorHandler(nullptr);
-  CleanInputEventListener();
-  CleanWindowEventListener();
-  CleanClipboardEventListener();
-  CleanTrayIconEventListener();
-  CleanFltkEventListener();
-  CloseXdo();
-  CloseInputDisplay();
-  CloseWindowDisplay();
-  CloseClipboardDisplay();
-  CloseTrayIconDisplay();
-  CloseAudioManager();
-}
+    std::vector<double> take() {
+      std::vector<double> records;
+      std::swap(records, m_records);
+      return records;
+    }
 
-Napi::Value CleanupResources(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-  CleanAll();
-  return env.Undefined();
-}
+  private:
+    std::vector<double> m_records;
+    std::chrono::steady_clock::time_point m_startedAt;
+};
 
+// Shared memory layout of an input event ring (see InputEventRingReader):
+//   header  16 x int32: write index | read index | capacity | record size | records offset | dropped events | state | waiting
+//   records capacity x (float64 timestamp | int32 type | int32 input | int32 state | int32 x | int32 y | int32 flags)
+// Indexes count events since the ring started, wrapping around at 2^32: the
+// record of index i lives in slot i % capacity, capacity being a power of 2.
+const size_t INPUT_EVENT_RING_HEADER_SIZE = 64;
+const size_t INPUT_EVENT_RING_RECORD_SIZE = 32;
+enum InputEventRingHeaderField {
+  RING_WRITE_INDEX = 0,
+  RING_READ_INDEX = 1,
+  RING_CAPACITY = 2,
+  RING_RECORD_SIZE = 3,
+  RING_RECORDS_OFFSET = 4,
+  RING_DROPPED = 5,
+  RING_STATE = 6,
+  RING_WAITING = 7,
+};
 
-// =============================================================================
-// ============================== MOUSE FUNCTIONS ==============================
-// =============================================================================
+// Single-producer/single-consumer ring of input events living in memory
+// shared with JS (a SharedArrayBuffer). The input listener thread is the only
+// producer and never blocks: events are dropped while the ring is full. The
+// consumer is only notified when it asked for it, by setting the waiting
+// field, so that a busy consumer costs no wake-up at all.
+class InputEventRing {
+  public:
+    static size_t requiredMemorySize(uint32_t capacity) {
+      return INPUT_EVENT_RING_HEADER_SIZE + capacity * INPUT_EVENT_RING_RECORD_SIZE;
+    }
 
-// Function to get the current mouse cursor position
-Position GetCursorPos() {
-  Display* inputDisplay = GetInputDisplay();
+    // `memory` must be zero-initialized and at least requiredMemorySize() bytes,
+    // `capacity` a power of 2
+    InputEventRing(uint8_t* memory, uint32_t capacity, std::function<void()> onWaiting)
+      : m_memory(memory),
+        m_capacity(capacity),
+        m_onWaiting(std::move(onWaiting)) {
+      header(RING_CAPACITY).store(static_cast<int32_t>(m_capacity));
+      header(RING_RECORD_SIZE).store(static_cast<int32_t>(INPUT_EVENT_RING_RECORD_SIZE));
+      header(RING_RECORDS_OFFSET).store(static_cast<int32_t>(INPUT_EVENT_RING_HEADER_SIZE));
+      header(RING_WAITING).store(1);
+      header(RING_STATE).store(1);
+    }
 
-  Window root = DefaultRootWindow(inputDisplay);
-  Window ret_root, ret_child;
-  int root_x, root_y;
-  int x, y;
-  unsigned int mask;
+    InputEventRing(const InputEventRing&) = delete;
+    InputEventRing& operator=(const InputEventRing&) = delete;
 
-  if (!XQueryPointer(inputDisplay, root, &ret_root, &ret_child, &root_x, &root_y, &x, &y, &mask)) {
-    throw std::runtime_error("Failed to query pointer position.");
-  }
+  public:
+    // Producer side: only called from the input listener thread
+    void push(const RawInputEvent& event) {
+      uint32_t writeIndex = static_cast<uint32_t>(header(RING_WRITE_INDEX).load(std::memory_order_relaxed));
+      uint32_t readIndex = static_cast<uint32_t>(header(RING_READ_INDEX).load(std::memory_order_acquire));
+      if (writeIndex - readIndex >= m_capacity) {
+        header(RING_DROPPED).fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
 
-  Position cursorPosition;
-  cursorPosition.x = root_x;
-  cursorPosition.y = root_y;
-  return cursorPosition;
-}
+      EncodedInputEvent encoded = EncodeInputEvent(event);
+      double timestamp = static_cast<double>(event.timestamp);
+      int32_t fields[6] = { encoded.type, encoded.input, encoded.state, event.x, event.y, encoded.flags };
+      uint8_t* record = m_memory + INPUT_EVENT_RING_HEADER_SIZE + (writeIndex & (m_capacity - 1)) * INPUT_EVENT_RING_RECORD_SIZE;
+      std::memcpy(record, &timestamp, sizeof(double));
+      std::memcpy(record + sizeof(double), fields, sizeof(fields));
+
+      // Publish the record, then wake the consumer up if it waits for it
+      header(RING_WRITE_INDEX).store(static_cast<int32_t>(writeIndex + 1));
+      if (header(RING_WAITING).exchange(0) != 0) {
+        m_onWaiting();
+      }
+    }
 
-// Function to get the current mouse cursor horizontal position
-Napi::Value GetCursorPosX(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+    // Wake the consumer up a last time, to let it see the ring stopped
+    void stop() {
+      header(RING_STATE).store(0);
+      m_onWaiting();
+    }
 
-  try {
-    Position cursorPosition = GetCursorPos();
-    return Napi::Number::New(env, cursorPosition.x);
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+  private:
+    // Shared int32 fields are accessed atomically, like Atomics does in JS
+    std::atomic<int32_t>& header(InputEventRingHeaderField field) {
+      return *reinterpret_cast<std::atomic<int32_t>*>(m_memory + field * sizeof(int32_t));
+    }
 
-// Function to get the current mouse cursor vertical position
-Napi::Value GetCursorPosY(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+  private:
+    uint8_t* m_memory;
+    uint32_t m_capacity;
+    std::function<void()> m_onWaiting;
+};
 
-  try {
-    Position cursorPosition = GetCursorPos();
-    return Napi::Number::New(env, cursorPosition.y);
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+// Input recording container (all integers little-endian):
+//   header  "ACTINP01" | block size
+//   blocks  (first timestamp in ms | event count | payload size | payload)*
+//   index   (block offset | first timestamp in ms | event count)*
+//   trailer block count | index offset | "ACTIDX01"
+// Payloads are Zstandard-compressed arrays of InputRecord. Timestamps are
+// relative to the previous event of the block and mouse positions to the
+// previous mouse event of the block, so that blocks decode on their own and
+// mostly hold small numbers. Blocks are appended as they fill up: a recording
+// that was not stopped properly has no index, but its blocks remain readable.
+const char INPUT_RECORDING_MAGIC[] = "ACTINP01";
+const char INPUT_RECORDING_INDEX_MAGIC[] = "ACTIDX01";
+const size_t INPUT_RECORDING_BLOCK_HEADER_SIZE = 16;
+const size_t INPUT_RECORDING_INDEX_ENTRY_SIZE = 20;
+const size_t INPUT_RECORDING_TRAILER_SIZE = 24;
+const uint32_t INPUT_RECORDING_MAX_BLOCK_SIZE = 1 << 20;
+
+struct InputRecord {
+  uint32_t timestampDelta;
+  int32_t input;
+  int32_t xDelta;
+  int32_t yDelta;
+  uint8_t type;
+  uint8_t state;
+  uint8_t flags; // as in EncodedInputEvent
+  uint8_t reserved;
+};
+static_assert(sizeof(InputRecord) == 20, "Input records are stored as-is");
 
-// Function to get the current mouse cursor position
-Napi::Object GetCursorPosWrapper(const Napi::Env& env) {
-  // Create a JavaScript object to return the cursor position
-  Napi::Object mousePositionJS = Napi::Object::New(env);
+struct InputRecordingIndexEntry {
+  uint64_t offset;
+  uint64_t timestamp;
+  uint32_t eventCount;
+};
 
-  // Define getter for 'x' coordinate
-  mousePositionJS.DefineProperty(
-    Napi::PropertyDescriptor::Accessor<GetCursorPosX>(Napi::String::New(env, "x"))
-  );
+struct InputRecordingStats {
+  uint64_t eventCount;
+  uint64_t droppedEventCount;
+  uint64_t blockCount;
+  uint64_t durationMs;
+};
 
-  // Define getter for 'y' coordinate
-  mousePositionJS.DefineProperty(
-    Napi::PropertyDescriptor::Accessor<GetCursorPosY>(Napi::String::New(env, "y"))
-  );
+// Input events a recorder keeps. A negative state matches every state.
+struct InputRecorderAction {
+  int32_t type;
+  int32_t input;
+  int32_t state;
+};
 
-  return mousePositionJS;
-}
+// Appends compressed blocks to an input recording file and writes its index on finish
+class InputRecordingWriter {
+  public:
+    InputRecordingWriter(const std::filesystem::path& filepath, uint32_t blockSize)
+      : m_stream(filepath, std::ios::binary | std::ios::trunc) {
+      if (!m_stream) {
+        throw std::runtime_error("Failed to open input recording file.");
+      }
+      m_stream.write(INPUT_RECORDING_MAGIC, 8);
+      WriteBinary(m_stream, blockSize);
+      m_stream.flush();
+    }
 
-// Function to set the mouse cursor position
-void SetCursorPos(int x, int y) {
-  Display* inputDisplay = GetInputDisplay();
+    ~InputRecordingWriter() {
+      try {
+        finish();
+      } catch (...) {
+        // Nobody is left to report the failure to
+      }
+    }
 
-  // Move the pointer to absolute (x, y) coordinates
-  XTestFakeMotionEvent(inputDisplay, 0, x, y, CurrentTime);
+    InputRecordingWriter(const InputRecordingWriter&) = delete;
+    InputRecordingWriter& operator=(const InputRecordingWriter&) = delete;
 
-  // Flush to ensure the command is sent immediately
-  XFlush(inputDisplay);
-}
+  public:
+    void append(uint64_t timestamp, uint32_t eventCount, const uint8_t* payload, uint32_t size) {
+      m_index.push_back({ static_cast<uint64_t>(m_stream.tellp()), timestamp, eventCount });
+      WriteBinary(m_stream, timestamp);
+      WriteBinary(m_stream, eventCount);
+      WriteBinary(m_stream, size);
+      m_stream.write(reinterpret_cast<const char*>(payload), size);
+      // Keep the file readable up to the last block should the process die
+      m_stream.flush();
+    }
+
+    void finish() {
+      if (m_isFinished) return;
+      m_isFinished = true;
+      uint64_t indexOffset = static_cast<uint64_t>(m_stream.tellp());
+      for (const InputRecordingIndexEntry& entry : m_index) {
+        WriteBinary(m_stream, entry.offset);
+        WriteBinary(m_stream, entry.timestamp);
+        WriteBinary(m_stream, entry.eventCount);
+      }
+      WriteBinary(m_stream, static_cast<uint64_t>(m_index.size()));
+      WriteBinary(m_stream, indexOffset);
+      m_stream.write(INPUT_RECORDING_INDEX_MAGIC, 8);
+      m_stream.flush();
+      // The stream state is sticky: this also catches failed appends
+      bool hasFailed = !m_stream;
+      m_stream.close();
+      if (hasFailed || !m_stream) {
+        throw std::runtime_error("Failed to write input recording file.");
+      }
+    }
 
-// Function to set the mouse cursor position
-Napi::Value SetCursorPosWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+    size_t blockCount() const {
+      return m_index.size();
+    }
 
-  // Validate arguments
-  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
-    Napi::TypeError::New(env, "Expected two number arguments").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+  private:
+    std::ofstream m_stream;
+    std::vector<InputRecordingIndexEntry> m_index;
+    bool m_isFinished = false;
+};
 
-  int x = info[0].As<Napi::Number>().Int32Value();
-  int y = info[1].As<Napi::Number>().Int32Value();
+// Records input events into an input recording file. The input listener thread
+// appends fixed-size records to the current block, without any allocation nor
+// I/O, and hands full blocks to a writer thread which compresses and appends
+// them to the file. Block buffers are recycled, so memory stays the same
+// whatever the recording length. Blocks are dropped rather than delaying the
+// input listener when the writer falls behind.
+class InputRecorder {
+  public:
+    InputRecorder(
+      const std::filesystem::path& filepath,
+      std::vector<InputRecorderAction> actions,
+      bool isInjectedIgnored,
+      int compressionLevel,
+      uint32_t blockSize
+    ) : m_actions(std::move(actions)),
+        m_isInjectedIgnored(isInjectedIgnored),
+        m_compressionLevel(compressionLevel),
+        m_blockSize(std::max(1u, blockSize)),
+        m_writer(filepath, m_blockSize) {
+      m_block.reserve(m_blockSize);
+      m_writeThread = std::thread(&InputRecorder::writeLoop, this);
+    }
+
+    ~InputRecorder() {
+      try {
+        stop();
+      } catch (...) {
+        // Nobody is left to report the failure to
+      }
+    }
 
-  try {
-    SetCursorPos(x, y);
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
 
-// Function to simulate left mouse button down
-void LeftClickDown() {
-  Display* inputDisplay = GetInputDisplay();
+  public:
+    // Only called from the input listener thread
+    void record(const RawInputEvent& event) {
+      if (m_isPaused.load(std::memory_order_relaxed) || !accepts(event)) {
+        return;
+      }
+      if (m_block.empty()) {
+        m_blockTimestamp = event.timestamp;
+        m_previousTimestamp = event.timestamp;
+        m_previousPosition = { 0, 0 };
+      }
+      if (!m_firstTimestamp) {
+        m_firstTimestamp = event.timestamp;
+      }
+      m_lastTimestamp = event.timestamp;
+
+      EncodedInputEvent encoded = EncodeInputEvent(event);
+      InputRecord record{};
+      // The wall clock may go back: keep decoded timestamps ordered
+      if (event.timestamp > m_previousTimestamp) {
+        record.timestampDelta = static_cast<uint32_t>(std::min<uint64_t>(event.timestamp - m_previousTimestamp, UINT32_MAX));
+        m_previousTimestamp += record.timestampDelta;
+      }
+      record.input = encoded.input;
+      if (event.type == InputEventType::Mouse) {
+        record.xDelta = event.x - m_previousPosition.x;
+        record.yDelta = event.y - m_previousPosition.y;
+        m_previousPosition = { event.x, event.y };
+      }
+      record.type = static_cast<uint8_t>(encoded.type);
+      record.state = static_cast<uint8_t>(encoded.state);
+      record.flags = static_cast<uint8_t>(encoded.flags);
+      m_block.push_back(record);
 
-  // Send the left mouse button (= button 1) down event
-  XTestFakeButtonEvent(inputDisplay, 1, True, CurrentTime);
+      if (m_block.size() >= m_blockSize) {
+        submitBlock(false);
+      }
+    }
 
-  XFlush(inputDisplay);
-}
+    void setPaused(bool isPaused) {
+      m_isPaused = isPaused;
+    }
 
-// Function to simulate left mouse button down
-Napi::Value LeftClickDownWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+    // Must only be called once the input listener no longer records events
+    InputRecordingStats stop() {
+      std::lock_guard<std::mutex> stopLock(m_stopMutex);
+      if (!m_isStopped) {
+        m_isStopped = true;
+        if (!m_block.empty()) {
+          submitBlock(true);
+        }
+        {
+          std::lock_guard<std::mutex> lock(m_blocksMutex);
+          m_isStopping = true;
+        }
+        m_blocksCondition.notify_all();
+        m_writeThread.join();
+        m_writer.finish();
+      }
+      return {
+        m_recordedEventCount.load(),
+        m_droppedEventCount.load(),
+        static_cast<uint64_t>(m_writer.blockCount()),
+        m_firstTimestamp ? m_lastTimestamp - m_firstTimestamp : 0
+      };
+    }
 
-  try {
-    LeftClickDown();
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+  private:
+    // Blocks waiting for the writer thread at most
+    static constexpr size_t MAX_PENDING_BLOCKS = 8;
 
-// Function to simulate left mouse button up
-void LeftClickUp() {
-  Display* inputDisplay = GetInputDisplay();
+    struct Block {
+      uint64_t timestamp;
+      std::vector<InputRecord> records;
+    };
 
-  // Send the left mouse button (= button 1) up event
-  XTestFakeButtonEvent(inputDisplay, 1, False, CurrentTime);
+    bool accepts(const RawInputEvent& event) const {
+      if (m_isInjectedIgnored && event.isInjected) {
+        return false;
+      }
+      if (m_actions.empty()) {
+        return true;
+      }
+      for (const InputRecorderAction& action : m_actions) {
+        if (
+          action.type == static_cast<int32_t>(event.type)
+          && action.input == event.input
+          && (action.state < 0 || action.state == static_cast<int32_t>(event.state))
+        ) {
+          return true;
+        }
+      }
+      return false;
+    }
 
-  XFlush(inputDisplay);
-}
+    // Hand the current block to the writer thread and start a new one
+    void submitBlock(bool isForced) {
+      {
+        std::lock_guard<std::mutex> lock(m_blocksMutex);
+        if (isForced || m_pendingBlocks.size() < MAX_PENDING_BLOCKS) {
+          m_pendingBlocks.push({ m_blockTimestamp, std::move(m_block) });
+          m_block = std::vector<InputRecord>();
+        }
+        else {
+          m_droppedEventCount += m_block.size();
+          m_block.clear();
+        }
+        if (m_block.capacity() == 0 && !m_freeBlocks.empty()) {
+          m_block = std::move(m_freeBlocks.back());
+          m_freeBlocks.pop_back();
+        }
+      }
+      m_blocksCondition.notify_one();
+      m_block.reserve(m_blockSize);
+    }
 
-// Function to simulate left mouse button up
-Napi::Value LeftClickUpWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+    void writeLoop() {
+      ZSTD_CCtx* zstdContext = ZSTD_createCCtx();
+      std::vector<uint8_t> payload;
 
-  try {
-    LeftClickUp();
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+      while (true) {
+        Block block;
+        {
+          std::unique_lock<std::mutex> lock(m_blocksMutex);
+          m_blocksCondition.wait(lock, [this] { return !m_pendingBlocks.empty() || m_isStopping; });
+          if (m_pendingBlocks.empty()) break;
+          block = std::move(m_pendingBlocks.front());
+          m_pendingBlocks.pop();
+        }
 
-// Function to simulate right mouse button down
-void RightClickDown() {
-  Display* inputDisplay = GetInputDisplay();
+        size_t eventCount = block.records.size();
+        size_t size = eventCount * sizeof(InputRecord);
+        payload.resize(ZSTD_compressBound(size));
+        size_t compressedSize = zstdContext
+          ? ZSTD_compressCCtx(zstdContext, payload.data(), payload.size(), block.records.data(), size, m_compressionLevel)
+          : ZSTD_compress(payload.data(), payload.size(), block.records.data(), size, m_compressionLevel);
+        if (ZSTD_isError(compressedSize)) {
+          m_droppedEventCount += eventCount;
+        }
+        else {
+          m_writer.append(block.timestamp, static_cast<uint32_t>(eventCount), payload.data(), static_cast<uint32_t>(compressedSize));
+          m_recordedEventCount += eventCount;
+        }
 
-  // Send the right mouse button (= button 3) down event
-  XTestFakeButtonEvent(inputDisplay, 3, True, CurrentTime);
+        // Give the block buffer back to the input listener
+        block.records.clear();
+        std::lock_guard<std::mutex> lock(m_blocksMutex);
+        m_freeBlocks.push_back(std::move(block.records));
+      }
 
-  XFlush(inputDisplay);
-}
+      if (zstdContext) {
+        ZSTD_freeCCtx(zstdContext);
+      }
+    }
 
-// Function to simulate right mouse button down
-Napi::Value RightClickDownWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+  private:
+    std::vector<InputRecorderAction> m_actions;
+    bool m_isInjectedIgnored;
+    int m_compressionLevel;
+    uint32_t m_blockSize;
+    InputRecordingWriter m_writer;
+    std::atomic<bool> m_isPaused{false};
+
+    // Input listener thread state
+    std::vector<InputRecord> m_block;
+    uint64_t m_blockTimestamp = 0;
+    uint64_t m_previousTimestamp = 0;
+    Position m_previousPosition{ 0, 0 };
+    uint64_t m_firstTimestamp = 0;
+    uint64_t m_lastTimestamp = 0;
+
+    std::mutex m_stopMutex;
+    bool m_isStopped = false;
+    std::thread m_writeThread;
+
+    std::mutex m_blocksMutex;
+    std::condition_variable m_blocksCondition;
+    std::queue<Block> m_pendingBlocks;
+    std::vector<std::vector<InputRecord>> m_freeBlocks;
+    bool m_isStopping = false;
+
+    std::atomic<uint64_t> m_recordedEventCount{0};
+    std::atomic<uint64_t> m_droppedEventCount{0};
+};
 
-  try {
-    RightClickDown();
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+// Reads the blocks of an input recording file, thanks to its index or, for a
+// recording that was not stopped properly, by walking the blocks one by one
+class InputRecordingReader {
+  public:
+    explicit InputRecordingReader(const std::filesystem::path& filepath)
+      : m_stream(filepath, std::ios::binary) {
+      if (!m_stream) {
+        throw std::runtime_error("Failed to open input recording file.");
+      }
+      char magic[8];
+      m_stream.read(magic, 8);
+      if (!m_stream || std::memcmp(magic, INPUT_RECORDING_MAGIC, 8) != 0) {
+        throw std::runtime_error("Invalid input recording file.");
+      }
+      m_blockSize = read<uint32_t>();
+      if (m_blockSize == 0 || m_blockSize > INPUT_RECORDING_MAX_BLOCK_SIZE) {
+        throw std::runtime_error("Invalid input recording file.");
+      }
+      uint64_t blocksOffset = static_cast<uint64_t>(m_stream.tellg());
+      m_stream.seekg(0, std::ios::end);
+      uint64_t fileSize = static_cast<uint64_t>(m_stream.tellg());
+
+      // Trailer: block count | index offset | magic
+      if (fileSize >= blocksOffset + INPUT_RECORDING_TRAILER_SIZE) {
+        m_stream.seekg(-static_cast<std::streamoff>(INPUT_RECORDING_TRAILER_SIZE), std::ios::end);
+        uint64_t blockCount = read<uint64_t>();
+        uint64_t indexOffset = read<uint64_t>();
+        m_stream.read(magic, 8);
+        if (m_stream && std::memcmp(magic, INPUT_RECORDING_INDEX_MAGIC, 8) == 0) {
+          // The index must exactly fill the space between the blocks and the trailer
+          uint64_t indexEnd = fileSize - INPUT_RECORDING_TRAILER_SIZE;
+          if (
+            indexOffset < blocksOffset || indexOffset > indexEnd ||
+            (indexEnd - indexOffset) % INPUT_RECORDING_INDEX_ENTRY_SIZE != 0 ||
+            (indexEnd - indexOffset) / INPUT_RECORDING_INDEX_ENTRY_SIZE != blockCount
+          ) {
+            throw std::runtime_error("Invalid input recording file.");
+          }
+          m_blocksEnd = indexOffset;
+          m_index.resize(blockCount);
+          m_stream.seekg(indexOffset);
+          for (InputRecordingIndexEntry& entry : m_index) {
+            entry.offset = read<uint64_t>();
+            entry.timestamp = read<uint64_t>();
+            entry.eventCount = read<uint32_t>();
+          }
+          // Check the event counts against the blocks before anyone allocates for them
+          for (const InputRecordingIndexEntry& entry : m_index) {
+            if (entry.offset < blocksOffset || entry.offset + INPUT_RECORDING_BLOCK_HEADER_SIZE > m_blocksEnd) {
+              throw std::runtime_error("Invalid input recording file.");
+            }
+            m_stream.seekg(entry.offset);
+            read<uint64_t>(); // first timestamp
+            uint32_t eventCount = read<uint32_t>();
+            uint32_t size = read<uint32_t>();
+            if (eventCount != entry.eventCount || !isValidBlock(entry.offset, eventCount, size)) {
+              throw std::runtime_error("Invalid input recording file.");
+            }
+          }
+          return;
+        }
+        m_stream.clear();
+      }
 
-// Function to simulate right mouse button up
-void RightClickUp() {
-  Display* inputDisplay = GetInputDisplay();
+      // No index: keep the complete blocks
+      m_blocksEnd = fileSize;
+      uint64_t offset = blocksOffset;
+      while (offset + INPUT_RECORDING_BLOCK_HEADER_SIZE <= fileSize) {
+        m_stream.seekg(offset);
+        uint64_t timestamp = read<uint64_t>();
+        uint32_t eventCount = read<uint32_t>();
+        uint32_t size = read<uint32_t>();
+        if (!isValidBlock(offset, eventCount, size)) {
+          break;
+        }
+        m_index.push_back({ offset, timestamp, eventCount });
+        offset += INPUT_RECORDING_BLOCK_HEADER_SIZE + size;
+      }
+    }
 
-  // Send the right mouse button (= button 3) up event
-  XTestFakeButtonEvent(inputDisplay, 3, False, CurrentTime);
+  public:
+    const std::vector<InputRecordingIndexEntry>& index() const {
+      return m_index;
+    }
+
+    // Decode a block into `events`, replacing their content
+    void readBlock(size_t blockIndex, std::vector<RawInputEvent>& events) {
+      const InputRecordingIndexEntry& entry = m_index.at(blockIndex);
+      m_stream.clear();
+      m_stream.seekg(entry.offset);
+      uint64_t timestamp = read<uint64_t>();
+      uint32_t eventCount = read<uint32_t>();
+      uint32_t size = read<uint32_t>();
+      if (eventCount != entry.eventCount || !isValidBlock(entry.offset, eventCount, size)) {
+        throw std::runtime_error("Corrupted input recording block.");
+      }
+      m_stream.seekg(entry.offset + INPUT_RECORDING_BLOCK_HEADER_SIZE);
+      m_payload.resize(size);
+      m_stream.read(reinterpret_cast<char*>(m_payload.data()), size);
+      if (!m_stream) {
+        throw std::runtime_error("Unexpected end of input recording file.");
+      }
+      m_records.resize(eventCount);
+      size_t expectedSize = eventCount * sizeof(InputRecord);
+      size_t decompressedSize = ZSTD_decompress(m_records.data(), expectedSize, m_payload.data(), size);
+      if (ZSTD_isError(decompressedSize) || decompressedSize != expectedSize) {
+        throw std::runtime_error("Corrupted input recording block.");
+      }
 
-  XFlush(inputDisplay);
-}
+      events.clear();
+      events.reserve(eventCount);
+      Position position{ 0, 0 };
+      for (const InputRecord& record : m_records) {
+        timestamp += record.timestampDelta;
+        RawInputEvent event{
+          static_cast<InputEventType>(record.type),
+          record.input,
+          static_cast<InputEventState>(record.state),
+          0,
+          0,
+          timestamp,
+          (record.flags & 1) != 0,
+          (record.flags & 2) != 0
+        };
+        if (event.type == InputEventType::Mouse) {
+          position.x += record.xDelta;
+          position.y += record.yDelta;
+          event.x = position.x;
+          event.y = position.y;
+        }
+        events.push_back(event);
+      }
+    }
 
-// Function to simulate right mouse button up
-Napi::Value RightClickUpWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+  private:
+    // ZSTD_FRAMEHEADERSIZE_MAX, only exposed by the static Zstandard API
+    static constexpr size_t ZSTD_FRAME_HEADER_MAX_SIZE = 18;
+
+    template <typename T>
+    T read() {
+      T value{};
+      m_stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+      if (!m_stream) {
+        throw std::runtime_error("Unexpected end of input recording file.");
+      }
+      return value;
+    }
 
-  try {
-    RightClickUp();
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+    // A block must fit in the file and hold no more events than a block can.
+    // Its payload must also be a Zstandard frame declaring the exact size of
+    // its records, which bounds what decoding it allocates.
+    bool isValidBlock(uint64_t offset, uint32_t eventCount, uint32_t size) {
+      if (
+        eventCount > m_blockSize ||
+        offset + INPUT_RECORDING_BLOCK_HEADER_SIZE + size > m_blocksEnd
+      ) {
+        return false;
+      }
+      char frameHeader[ZSTD_FRAME_HEADER_MAX_SIZE];
+      size_t frameHeaderSize = std::min<size_t>(size, sizeof(frameHeader));
+      m_stream.seekg(offset + INPUT_RECORDING_BLOCK_HEADER_SIZE);
+      m_stream.read(frameHeader, frameHeaderSize);
+      if (!m_stream) {
+        m_stream.clear();
+        return false;
+      }
+      return ZSTD_getFrameContentSize(frameHeader, frameHeaderSize) == static_cast<unsigned long long>(eventCount) * sizeof(InputRecord);
+    }
 
-// Function to simulate middle mouse button down
-void MouseWheelPressDown() {
-  Display* inputDisplay = GetInputDisplay();
+  private:
+    std::ifstream m_stream;
+    uint32_t m_blockSize = 0;
+    uint64_t m_blocksEnd = 0;
+    std::vector<InputRecordingIndexEntry> m_index;
+    std::vector<uint8_t> m_payload;
+    std::vector<InputRecord> m_records;
+};
 
-  // Send the mouse middle button (= button 2) down event
-  XTestFakeButtonEvent(inputDisplay, 2, True, CurrentTime);
+// Replay lateness histogram: 10 us buckets up to 100 ms. Later events fall in
+// the last bucket, the exact maximum being kept apart.
+const size_t INPUT_REPLAY_LATENESS_BUCKET_COUNT = 10000;
+const std::chrono::microseconds INPUT_REPLAY_LATENESS_BUCKET_WIDTH(10);
+
+struct InputReplayStats {
+  uint64_t eventCount = 0;
+  uint64_t durationMs = 0;
+  double meanLatenessMs = 0;
+  double p50LatenessMs = 0;
+  double p95LatenessMs = 0;
+  double p99LatenessMs = 0;
+  double maxLatenessMs = 0;
+};
 
-  XFlush(inputDisplay);
-}
+// Replays recorded input events on a dedicated thread and its own X
+// connection. Each event is sent on an absolute deadline computed from its
+// recorded timestamp and the replay speed, so delays never drift however late
+// an event was sent, and events sharing a deadline are flushed together.
+// Recording files are decoded block by block: memory does not grow with the
+// recording length. Keys and buttons still held are released when the replay
+// is paused, seeks, ends or is stopped.
+class InputReplayer {
+  public:
+    // Called on the replay thread once the replay finished or was stopped,
+    // with the error that interrupted it if any
+    using Callback = std::function<void(const InputReplayStats&, std::exception_ptr)>;
+
+    // Replay the given events, in timestamp order
+    InputReplayer(std::vector<RawInputEvent> events, double speed, Callback onEnd)
+      : m_events(std::move(events)), m_speed(speed), m_onEnd(std::move(onEnd)) {
+      std::stable_sort(m_events.begin(), m_events.end(), [](const RawInputEvent& a, const RawInputEvent& b) {
+        return a.timestamp < b.timestamp;
+      });
+      m_startTimestamp = m_events.empty() ? 0 : m_events.front().timestamp;
+      start();
+    }
 
-// Function to simulate middle mouse button down
-Napi::Value MouseWheelPressDownWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+    // Replay an input recording file (see InputRecorder)
+    InputReplayer(const std::filesystem::path& filepath, double speed, Callback onEnd)
+      : m_reader(std::make_unique<InputRecordingReader>(filepath)), m_speed(speed), m_onEnd(std::move(onEnd)) {
+      m_startTimestamp = m_reader->index().empty() ? 0 : m_reader->index().front().timestamp;
+      start();
+    }
 
-  try {
-    MouseWheelPressDown();
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+    ~InputReplayer() {
+      stop();
+    }
 
-// Function to simulate middle mouse button up
-void MouseWheelPressUp() {
-  Display* inputDisplay = GetInputDisplay();
+    InputReplayer(const InputReplayer&) = delete;
+    InputReplayer& operator=(const InputReplayer&) = delete;
 
-  // Send the mouse middle button (= button 2) up event
-  XTestFakeButtonEvent(inputDisplay, 2, False, CurrentTime);
+  public:
+    void setPaused(bool isPaused) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (isPaused == m_isPaused) {
+        return;
+      }
+      const auto now = std::chrono::steady_clock::now();
+      if (isPaused) {
+        m_pausedPosition = std::chrono::duration<double, std::micro>(now - m_origin) * m_speed;
+      }
+      else {
+        m_origin = now - scale(m_pausedPosition);
+      }
+      m_isPaused = isPaused;
+      m_generation++;
+      m_condition.notify_all();
+    }
 
-  XFlush(inputDisplay);
-}
+    // Continue from the given time since the first recorded event
+    void seek(uint64_t positionMs) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_seekPosition = positionMs;
+      m_pausedPosition = std::chrono::milliseconds(positionMs);
+      m_origin = std::chrono::steady_clock::now() - scale(m_pausedPosition);
+      m_generation++;
+      m_condition.notify_all();
+    }
 
-// Function to simulate middle mouse button up
-Napi::Value MouseWheelPressUpWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+    // Interrupt the replay and wait for its thread to end
+    void stop() {
+      std::thread thread;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+        m_generation++;
+        thread = std::move(m_thread);
+      }
+      m_condition.notify_all();
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
 
-  try {
-    MouseWheelPressUp();
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+  private:
+    void start() {
+      m_origin = std::chrono::steady_clock::now();
+      m_thread = std::thread(&InputReplayer::run, this);
+    }
 
-// Function to simulate mouse wheel scroll down
-void MouseWheelScrollDown(int scrollAmount) {
-  Display* inputDisplay = GetInputDisplay();
+    // Real time duration of a recorded duration at the replay speed
+    std::chrono::steady_clock::duration scale(std::chrono::duration<double, std::micro> recordedDuration) const {
+      return std::chrono::duration_cast<std::chrono::steady_clock::duration>(recordedDuration / m_speed);
+    }
 
-  for (int i = 0; i < scrollAmount; i++) {
-    XTestFakeButtonEvent(inputDisplay, 5, True, CurrentTime);
-    XTestFakeButtonEvent(inputDisplay, 5, False, CurrentTime);
-  }
+    void run() {
+      // Best effort: real-time scheduling requires CAP_SYS_NICE or an rtprio limit
+      sched_param parameters{};
+      parameters.sched_priority = sched_get_priority_min(SCHED_FIFO);
+      pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters);
 
-  XFlush(inputDisplay);
-}
+      const auto startedAt = std::chrono::steady_clock::now();
+      std::exception_ptr error;
+      m_display = XOpenDisplay(nullptr);
+      try {
+        if (!m_display) {
+          throw std::runtime_error("Failed to open X display.");
+        }
+        RawInputEvent event;
+        bool hasEvent = nextEvent(event);
+        while (true) {
+          std::chrono::steady_clock::time_point deadline;
+          uint64_t generation;
+          {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_isPaused && !m_isStopping && !m_seekPosition) {
+              lock.unlock();
+              releaseHeldInputs();
+              lock.lock();
+              m_condition.wait(lock, [this] { return !m_isPaused || m_isStopping || m_seekPosition.has_value(); });
+            }
+            if (m_isStopping) {
+              break;
+            }
+            if (m_seekPosition) {
+              uint64_t positionMs = *m_seekPosition;
+              m_seekPosition.reset();
+              lock.unlock();
+              releaseHeldInputs();
+              hasEvent = seekEvent(positionMs, event);
+              continue;
+            }
+            if (!hasEvent) {
+              break;
+            }
+            const uint64_t recordedDelay = event.timestamp > m_startTimestamp ? event.timestamp - m_startTimestamp : 0;
+            deadline = m_origin + scale(std::chrono::milliseconds(recordedDelay));
+            generation = m_generation;
+          }
+          if (std::chrono::steady_clock::now() < deadline) {
+            // Send the events due at the previous deadline before sleeping
+            XFlush(m_display);
+            if (!waitUntil(deadline, generation)) {
+              continue;
+            }
+          }
+          send(event);
+          recordLateness(std::chrono::steady_clock::now() - deadline);
+          hasEvent = nextEvent(event);
+        }
+        releaseHeldInputs();
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+      if (m_display) {
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+      }
+      m_onEnd(stats(std::chrono::steady_clock::now() - startedAt), error);
+    }
 
-// Function to simulate mouse wheel scroll down
-Napi::Value MouseWheelScrollDownWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+    // Interruptible coarse wait, then a precise sleep for the last milliseconds.
+    // Returns false when the replay was paused, moved or stopped meanwhile.
+    bool waitUntil(std::chrono::steady_clock::time_point deadline, uint64_t generation) {
+      const auto coarseDeadline = deadline - TIMER_SLEEP_MARGIN;
+      if (std::chrono::steady_clock::now() < coarseDeadline) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_condition.wait_until(lock, coarseDeadline, [this, generation] { return m_generation != generation; })) {
+          return false;
+        }
+      }
+      SleepUntil(deadline, PRECISE_SLEEP_SPIN_WINDOW);
+      return m_generation.load() == generation;
+    }
 
-  int scrollAmount = 1; // Default value
-  if (info.Length() > 0 && info[0].IsNumber()) {
-    scrollAmount = info[0].As<Napi::Number>().Int32Value();
-  }
+    bool nextEvent(RawInputEvent& event) {
+      while (m_eventIndex >= m_events.size()) {
+        if (!m_reader || m_blockIndex >= m_reader->index().size()) {
+          return false;
+        }
+        m_reader->readBlock(m_blockIndex++, m_events);
+        m_eventIndex = 0;
+      }
+      event = m_events[m_eventIndex++];
+      return true;
+    }
 
-  try {
-    MouseWheelScrollDown(scrollAmount);
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+    // Move to the first event recorded at or after the given position
+    bool seekEvent(uint64_t positionMs, RawInputEvent& event) {
+      const uint64_t timestamp = m_startTimestamp + positionMs;
+      if (m_reader) {
+        const std::vector<InputRecordingIndexEntry>& index = m_reader->index();
+        auto block = std::upper_bound(index.begin(), index.end(), timestamp, [](uint64_t value, const InputRecordingIndexEntry& entry) {
+          return value < entry.timestamp;
+        });
+        m_blockIndex = block == index.begin() ? 0 : static_cast<size_t>(block - index.begin()) - 1;
+        m_events.clear();
+        if (m_blockIndex < index.size()) {
+          m_reader->readBlock(m_blockIndex++, m_events);
+        }
+      }
+      auto first = std::lower_bound(m_events.begin(), m_events.end(), timestamp, [](const RawInputEvent& candidate, uint64_t value) {
+        return candidate.timestamp < value;
+      });
+      m_eventIndex = static_cast<size_t>(first - m_events.begin());
+      // The cursor may have moved meanwhile
+      m_cursor.reset();
+      return nextEvent(event);
+    }
 
-// Function to simulate mouse wheel scroll up
-void MouseWheelScrollUp(int scrollAmount) {
-  Display* inputDisplay = GetInputDisplay();
+    void send(const RawInputEvent& event) {
+      if (event.state == InputEventState::Neutral && !(event.type == InputEventType::Mouse && event.input == static_cast<int>(MouseInputCode::Move))) {
+        return;
+      }
+      const bool isDown = event.state == InputEventState::Down;
+      if (event.type == InputEventType::Keyboard) {
+        auto keyCode = m_keyCodes.find(event.input);
+        if (keyCode == m_keyCodes.end()) {
+          keyCode = m_keyCodes.emplace(event.input, XKeysymToKeycode(m_display, static_cast<KeySym>(event.input))).first;
+        }
+        // Keys missing from the current layout are skipped
+        if (keyCode->second == 0) {
+          return;
+        }
+        XTestFakeKeyEvent(m_display, keyCode->second, isDown, CurrentTime);
+        if (isDown) {
+          m_heldKeys.insert(keyCode->second);
+        }
+        else {
+          m_heldKeys.erase(keyCode->second);
+        }
+        m_eventCount++;
+        return;
+      }
 
-  for (int i = 0; i < scrollAmount; i++) {
-    XTestFakeButtonEvent(inputDisplay, 4, True, CurrentTime);
-    XTestFakeButtonEvent(inputDisplay, 4, False, CurrentTime);
-  }
+      if (!m_cursor || m_cursor->x != event.x || m_cursor->y != event.y) {
+        XTestFakeMotionEvent(m_display, 0, event.x, event.y, CurrentTime);
+        m_cursor = Position{ event.x, event.y };
+      }
+      unsigned int button = 0;
+      switch (static_cast<MouseInputCode>(event.input)) {
+        case MouseInputCode::Left: button = 1; break;
+        case MouseInputCode::Middle: button = 2; break;
+        case MouseInputCode::Right: button = 3; break;
+        case MouseInputCode::ExtraButton1: button = 8; break;
+        case MouseInputCode::ExtraButton2: button = 9; break;
+        case MouseInputCode::Wheel: {
+          unsigned int wheelButton = isDown ? 5 : 4;
+          XTestFakeButtonEvent(m_display, wheelButton, True, CurrentTime);
+          XTestFakeButtonEvent(m_display, wheelButton, False, CurrentTime);
+          break;
+        }
+        default: break;
+      }
+      if (button != 0) {
+        XTestFakeButtonEvent(m_display, button, isDown, CurrentTime);
+        if (isDown) {
+          m_heldButtons.insert(button);
+        }
+        else {
+          m_heldButtons.erase(button);
+        }
+      }
+      m_eventCount++;
+    }
 
-  XFlush(inputDisplay);
-}
+    void releaseHeldInputs() {
+      for (KeyCode keyCode : m_heldKeys) {
+        XTestFakeKeyEvent(m_display, keyCode, False, CurrentTime);
+      }
+      for (unsigned int button : m_heldButtons) {
+        XTestFakeButtonEvent(m_display, button, False, CurrentTime);
+      }
+      m_heldKeys.clear();
+      m_heldButtons.clear();
+      XFlush(m_display);
+    }
+
+    void recordLateness(std::chrono::steady_clock::duration lateness) {
+      const auto latenessUs = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(lateness).count());
+      const size_t bucket = static_cast<size_t>(latenessUs / INPUT_REPLAY_LATENESS_BUCKET_WIDTH.count());
+      m_latenessBuckets[std::min(bucket, INPUT_REPLAY_LATENESS_BUCKET_COUNT - 1)]++;
+      m_latenessCount++;
+      m_totalLatenessUs += static_cast<uint64_t>(latenessUs);
+      m_maxLatenessUs = std::max<uint64_t>(m_maxLatenessUs, static_cast<uint64_t>(latenessUs));
+    }
+
+    // Percentiles are the upper bounds of their histogram buckets
+    InputReplayStats stats(std::chrono::steady_clock::duration duration) const {
+      InputReplayStats stats;
+      stats.eventCount = m_eventCount;
+      stats.durationMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+      if (m_latenessCount == 0) {
+        return stats;
+      }
+      const double maxLatenessMs = m_maxLatenessUs / 1000.0;
+      auto percentile = [&](double ratio) {
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(ratio * m_latenessCount)));
+        uint64_t count = 0;
+        for (size_t bucket = 0; bucket < m_latenessBuckets.size(); bucket++) {
+          count += m_latenessBuckets[bucket];
+          if (count >= rank) {
+            return std::min(maxLatenessMs, (bucket + 1) * INPUT_REPLAY_LATENESS_BUCKET_WIDTH.count() / 1000.0);
+          }
+        }
+        return maxLatenessMs;
+      };
+      stats.meanLatenessMs = static_cast<double>(m_totalLatenessUs) / m_latenessCount / 1000.0;
+      stats.p50LatenessMs = percentile(0.5);
+      stats.p95LatenessMs = percentile(0.95);
+      stats.p99LatenessMs = percentile(0.99);
+      stats.maxLatenessMs = maxLatenessMs;
+      return stats;
+    }
 
-// Function to simulate mouse wheel scroll up
-Napi::Value MouseWheelScrollUpWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+  private:
+    // Events to replay, or the decoded block of the recording file
+    std::vector<RawInputEvent> m_events;
+    size_t m_eventIndex = 0;
+    std::unique_ptr<InputRecordingReader> m_reader;
+    size_t m_blockIndex = 0;
+    uint64_t m_startTimestamp = 0;
+    const double m_speed;
+    Callback m_onEnd;
+
+    // Replay thread state
+    Display* m_display = nullptr;
+    std::unordered_map<int32_t, KeyCode> m_keyCodes;
+    std::set<KeyCode> m_heldKeys;
+    std::set<unsigned int> m_heldButtons;
+    std::optional<Position> m_cursor;
+    uint64_t m_eventCount = 0;
+    std::vector<uint32_t> m_latenessBuckets = std::vector<uint32_t>(INPUT_REPLAY_LATENESS_BUCKET_COUNT, 0);
+    uint64_t m_latenessCount = 0;
+    uint64_t m_totalLatenessUs = 0;
+    uint64_t m_maxLatenessUs = 0;
+
+    // Controls, the replay being at `(now - m_origin) * m_speed` of the recording
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::chrono::steady_clock::time_point m_origin;
+    std::chrono::duration<double, std::micro> m_pausedPosition{0};
+    std::optional<uint64_t> m_seekPosition;
+    bool m_isPaused = false;
+    bool m_isStopping = false;
+    std::atomic<uint64_t> m_generation{0};
+    std::thread m_thread;
+};
 
-  int scrollAmount = 1; // Default value
-  if (info.Length() > 0 && info[0].IsNumber()) {
-    scrollAmount = info[0].As<Napi::Number>().Int32Value();
-  }
+// Builds the input event objects sent to JavaScript. Property keys and string
+// values are created once and kept referenced, and the properties of each
+// object are defined with a single napi_define_properties call.
+class InputEventObjectBuilder {
+  public:
+    InputEventObjectBuilder(const Napi::Env& env) {
+      for (const char* string : STRINGS) {
+        m_strings.push_back(Napi::Persistent(Napi::String::New(env, string)));
+      }
+    }
 
-  try {
-    MouseWheelScrollUp(scrollAmount);
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+    Napi::Object build(const Napi::Env& env, const RawInputEvent& event) const {
+      constexpr napi_property_attributes attributes = napi_default_jsproperty;
+      Napi::Object eventObj = Napi::Object::New(env);
+      Napi::Number timestamp = Napi::Number::New(env, static_cast<double>(event.timestamp));
+      Napi::String state = string(STATE_VALUE + static_cast<int>(event.state));
+      Napi::Boolean isInjected = Napi::Boolean::New(env, event.isInjected);
+      Napi::Boolean isSuppressed = Napi::Boolean::New(env, event.isSuppressed);
+      if (event.type == InputEventType::Mouse) {
+        Napi::Object position = Napi::Object::New(env);
+        position.DefineProperties({
+          Napi::PropertyDescriptor::Value(string(X), Napi::Number::New(env, event.x), attributes),
+          Napi::PropertyDescriptor::Value(string(Y), Napi::Number::New(env, event.y), attributes),
+        });
+        bool isKnownInput = event.input >= 0 && event.input <= static_cast<int>(MouseInputCode::ExtraButton2);
+        eventObj.DefineProperties({
+          Napi::PropertyDescriptor::Value(string(TYPE), string(MOUSE), attributes),
+          Napi::PropertyDescriptor::Value(string(TIMESTAMP), timestamp, attributes),
+          Napi::PropertyDescriptor::Value(string(INPUT), string(isKnownInput ? MOUSE_INPUT_VALUE + event.input : EMPTY), attributes),
+          Napi::PropertyDescriptor::Value(string(STATE), state, attributes),
+          Napi::PropertyDescriptor::Value(string(POSITION), position, attributes),
+          Napi::PropertyDescriptor::Value(string(IS_INJECTED), isInjected, attributes),
+          Napi::PropertyDescriptor::Value(string(IS_SUPPRESSED), isSuppressed, attributes),
+        });
+      }
+      else {
+        eventObj.DefineProperties({
+          Napi::PropertyDescriptor::Value(string(TYPE), string(KEYBOARD), attributes),
+          Napi::PropertyDescriptor::Value(string(TIMESTAMP), timestamp, attributes),
+          Napi::PropertyDescriptor::Value(string(INPUT), Napi::Number::New(env, event.input), attributes),
+          Napi::PropertyDescriptor::Value(string(STATE), state, attributes),
+          Napi::PropertyDescriptor::Value(string(IS_INJECTED), isInjected, attributes),
+          Napi::PropertyDescriptor::Value(string(IS_SUPPRESSED), isSuppressed, attributes),
+        });
+      }
+      return eventObj;
+    }
 
-// Function to simulate extra mouse button down
-void MouseExtraButtonDown(int extraButtonIndex) {
-  Display* inputDisplay = GetInputDisplay();
+  private:
+    // Indexes in STRINGS. STATE_VALUE and MOUSE_INPUT_VALUE start the values
+    // ordered as InputEventState and MouseInputCode.
+    enum {
+      TYPE = 0,
+      TIMESTAMP = 1,
+      INPUT = 2,
+      STATE = 3,
+      STATE_VALUE = 4,
+      POSITION = 7,
+      X = 8,
+      Y = 9,
+      IS_INJECTED = 10,
+      IS_SUPPRESSED = 11,
+      MOUSE = 12,
+      KEYBOARD = 13,
+      MOUSE_INPUT_VALUE = 14,
+      EMPTY = 21,
+    };
+    static constexpr const char* STRINGS[] = {
+      "type", "timestamp", "input",
+      "state", "down", "up", "neutral",
+      "position", "x", "y",
+      "isInjected", "isSuppressed",
+      "mouse", "keyboard",
+      "move", "left", "right", "middle", "wheel", "extraButton1", "extraButton2",
+      "",
+    };
+
+    Napi::String string(int index) const {
+      return m_strings[index].Value();
+    }
+
+    std::vector<Napi::Reference<Napi::String>> m_strings;
+};
 
-  // extraButtonIndex is 1 | 2
-  int linuxExtraButtonIndex = 8 + (extraButtonIndex - 1);
-  XTestFakeButtonEvent(inputDisplay, linuxExtraButtonIndex, True, CurrentTime);
+// Hotkeys, matched against keyboard events on the input listener thread. Each
+// hotkey is compiled into a linear state machine over its sequence of chords:
+// a chord is reached when its last key goes down while exactly its keys are
+// held, and the next chord must be reached within the hotkey timeout.
+class HotkeyMatcher {
+  public:
+    // Keys of a chord, each with its alternative key codes (e.g. left and right ctrl)
+    using Chord = std::vector<std::vector<int>>;
 
-  XFlush(inputDisplay);
-}
+    // Whether the system still sees a key as held
+    using KeyStateQuery = std::function<bool(int keyCode)>;
 
-// Function to simulate extra mouse button down
-Napi::Value MouseExtraButtonDownWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+    struct Hotkey {
+      std::vector<Chord> sequence;
+      uint64_t timeout; // ms between two chords
+      bool isInjectedIgnored;
+      std::function<void(uint64_t timestamp)> onMatch;
+    };
 
-  // Validate argument
-  if (info.Length() < 1 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Expected extra button index (strictly positive integer)").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+    HotkeyMatcher() { }
 
-  int extraButtonIndex = info[0].As<Napi::Number>().Int32Value();
+    void add(int id, Hotkey hotkey) {
+      if (m_states.empty()) {
+        // Keys released while nothing was matched may still look held
+        m_heldKeys.clear();
+      }
+      m_states[id] = State{ std::move(hotkey), 0, 0 };
+    }
 
-  try {
-    MouseExtraButtonDown(extraButtonIndex);
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+    void remove(int id) {
+      m_states.erase(id);
+    }
 
-// Function to simulate extra mouse button up
-void MouseExtraButtonUp(int extraButtonIndex) {
-  Display* inputDisplay = GetInputDisplay();
+    void clear() {
+      m_states.clear();
+      m_heldKeys.clear();
+    }
 
-  // extraButtonIndex is 1 | 2
-  int linuxExtraButtonIndex = 8 + (extraButtonIndex - 1);
-  XTestFakeButtonEvent(inputDisplay, linuxExtraButtonIndex, False, CurrentTime);
+    bool empty() const {
+      return m_states.empty();
+    }
 
-  XFlush(inputDisplay);
-}
+    // Advance every hotkey with the given keyboard event, calling back the
+    // hotkeys it completes
+    void process(const RawInputEvent& event, const KeyStateQuery& isKeyHeld) {
+      if (event.state == InputEventState::Up) {
+        m_heldKeys.erase(event.input);
+        return;
+      }
+      if (!m_heldKeys.emplace(event.input, HeldKey{ event.timestamp, event.isSuppressed }).second) {
+        // Key repeat
+        return;
+      }
+      dropReleasedKeys(event, isKeyHeld);
+      for (auto& [id, state] : m_states) {
+        const Hotkey& hotkey = state.hotkey;
+        if (hotkey.isInjectedIgnored && event.isInjected) {
+          continue;
+        }
+        if (state.step > 0 && event.timestamp - state.lastStepAt > hotkey.timeout) {
+          state.step = 0;
+        }
+        const Chord& chord = hotkey.sequence[state.step];
+        if (!isChordHeld(chord)) {
+          if (state.step > 0 && !isInChord(chord, event.input)) {
+            // Wrong key: the sequence may start over from this one
+            state.step = 0;
+            if (isChordHeld(hotkey.sequence[0])) {
+              state.step = 1;
+              state.lastStepAt = event.timestamp;
+            }
+          }
+          continue;
+        }
+        state.step++;
+        state.lastStepAt = event.timestamp;
+        if (state.step == hotkey.sequence.size()) {
+          state.step = 0;
+          hotkey.onMatch(event.timestamp);
+        }
+      }
+    }
 
-// Function to simulate extra mouse button up
-Napi::Value MouseExtraButtonUpWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+  private:
+    struct State {
+      Hotkey hotkey;
+      size_t step; // index of the next chord
+      uint64_t lastStepAt;
+    };
+
+    struct HeldKey {
+      uint64_t pressedAt;
+      // Suppressed keys never reach the system key state
+      bool isSuppressed;
+    };
+
+    // Age (in ms) after which a held key is checked against the system key
+    // state, so that the events not processed yet never make it look released
+    static constexpr uint64_t STALE_KEY_AGE = 250;
+
+    // Forget the held keys whose release was never seen (e.g. locked session,
+    // secure desktop or focus grabs), which would otherwise break every hotkey
+    // including them
+    void dropReleasedKeys(const RawInputEvent& event, const KeyStateQuery& isKeyHeld) {
+      for (auto heldKey = m_heldKeys.begin(); heldKey != m_heldKeys.end();) {
+        bool isStale = (
+          heldKey->first != event.input
+          && !heldKey->second.isSuppressed
+          && event.timestamp > heldKey->second.pressedAt + STALE_KEY_AGE
+          && !isKeyHeld(heldKey->first)
+        );
+        heldKey = isStale ? m_heldKeys.erase(heldKey) : std::next(heldKey);
+      }
+    }
 
-  // Validate argument
-  if (info.Length() < 1 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Expected extra button index (strictly positive integer)").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+    static bool isInChord(const Chord& chord, int keyCode) {
+      for (const std::vector<int>& key : chord) {
+        if (std::find(key.begin(), key.end(), keyCode) != key.end()) {
+          return true;
+        }
+      }
+      return false;
+    }
 
-  int extraButtonIndex = info[0].As<Napi::Number>().Int32Value();
+    // Whether every key of the chord is held, and no other key
+    bool isChordHeld(const Chord& chord) const {
+      for (const std::vector<int>& key : chord) {
+        bool isKeyHeld = std::any_of(key.begin(), key.end(), [this](int keyCode) {
+          return m_heldKeys.count(keyCode) > 0;
+        });
+        if (!isKeyHeld) {
+          return false;
+        }
+      }
+      for (const auto& [heldKey, held] : m_heldKeys) {
+        if (!isInChord(chord, heldKey)) {
+          return false;
+        }
+      }
+      return true;
+    }
 
-  try {
-    MouseExtraButtonUp(extraButtonIndex);
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+    std::map<int, State> m_states;
+    std::map<int, HeldKey> m_heldKeys;
+};
 
+// Immutable snapshot of the suppressed inputs, read by the input listener
+// without locking. A new table is built and swapped in with std::atomic_store
+// whenever suppression changes (see PublishInputSuppressionTable). Each input
+// has one flag telling it is suppressed at all, then one flag per state.
+class InputSuppressionTable {
+  public:
+    InputSuppressionTable() : m_keyboardFlags(KEYBOARD_TABLE_SIZE, 0), m_mouseFlags{} { }
 
-// =============================================================================
-// ============================ KEYBOARD FUNCTIONS =============================
-// =============================================================================
+    InputSuppressionTable(const std::map<int, std::set<int>>& mouseInputStates, const std::map<int, std::set<int>>& keyboardInputStates) : InputSuppressionTable() {
+      for (const auto& [input, states] : mouseInputStates) {
+        if (input >= 0 && input < MOUSE_TABLE_SIZE) {
+          m_mouseFlags[input] = toFlags(states);
+        }
+      }
+      for (const auto& [input, states] : keyboardInputStates) {
+        if (input >= 0 && input < KEYBOARD_TABLE_SIZE) {
+          m_keyboardFlags[input] = toFlags(states);
+        }
+        else {
+          // Sorted, as std::map is
+          m_extendedKeyboardFlags.emplace_back(input, toFlags(states));
+        }
+      }
+    }
 
-void KeyPressDown(int rawKeySym) {
-  Display* inputDisplay = GetInputDisplay();
+    bool isKeyboardSuppressed(int input) const {
+      return (keyboardFlags(input) & SUPPRESSED) != 0;
+    }
 
-  KeyCode keyCode = XKeysymToKeycode(inputDisplay, static_cast<KeySym>(rawKeySym));
-  if (keyCode == 0) {
-    throw std::runtime_error("Invalid key symbol.");
-  }
+    // 0 = down, 1 = up, 2 = neutral
+    bool isKeyboardSuppressed(int input, int state) const {
+      return (keyboardFlags(input) & stateFlag(state)) != 0;
+    }
 
-  XTestFakeKeyEvent(inputDisplay, keyCode, True, CurrentTime);
-  XFlush(inputDisplay);
-}
+    bool isMouseSuppressed(int input) const {
+      return (mouseFlags(input) & SUPPRESSED) != 0;
+    }
 
-Napi::Value KeyPressDownWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+    bool isMouseSuppressed(int input, int state) const {
+      return (mouseFlags(input) & stateFlag(state)) != 0;
+    }
 
-  // Validate argument
-  if (info.Length() < 1 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Expected key symbol (integer)").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+  private:
+    // Inputs below these sizes are looked up directly, the others are searched
+    static constexpr int KEYBOARD_TABLE_SIZE = 0x10000;
+    static constexpr int MOUSE_TABLE_SIZE = 256;
+    static constexpr uint8_t SUPPRESSED = 1;
 
-  int rawKeySym = info[0].As<Napi::Number>().Int32Value();
+    static uint8_t stateFlag(int state) {
+      return state >= 0 && state < 7 ? static_cast<uint8_t>(2 << state) : 0;
+    }
 
-  try {
-    KeyPressDown(rawKeySym);
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+    static uint8_t toFlags(const std::set<int>& states) {
+      uint8_t flags = SUPPRESSED;
+      for (int state : states) {
+        flags |= stateFlag(state);
+      }
+      return flags;
+    }
 
-void KeyPressUp(int rawKeySym) {
-  Display* inputDisplay = GetInputDisplay();
+    uint8_t keyboardFlags(int input) const {
+      if (input >= 0 && input < KEYBOARD_TABLE_SIZE) {
+        return m_keyboardFlags[input];
+      }
+      auto it = std::lower_bound(m_extendedKeyboardFlags.begin(), m_extendedKeyboardFlags.end(), std::make_pair(input, static_cast<uint8_t>(0)));
+      return it != m_extendedKeyboardFlags.end() && it->first == input ? it->second : 0;
+    }
 
-  KeyCode keyCode = XKeysymToKeycode(inputDisplay, static_cast<KeySym>(rawKeySym));
-  if (keyCode == 0) {
-    throw std::runtime_error("Invalid key symbol.");
-  }
+    uint8_t mouseFlags(int input) const {
+      return input >= 0 && input < MOUSE_TABLE_SIZE ? m_mouseFlags[input] : 0;
+    }
 
-  XTestFakeKeyEvent(inputDisplay, keyCode, False, CurrentTime);
-  XFlush(inputDisplay);
-}
+    std::vector<uint8_t> m_keyboardFlags;
+    std::vector<std::pair<int, uint8_t>> m_extendedKeyboardFlags;
+    std::array<uint8_t, MOUSE_TABLE_SIZE> m_mouseFlags;
+};
 
-Napi::Value KeyPressUpWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+// Raw input events already delivered at the current X server time. XInput2
+// reports a single input once per device (slave and master), only the first
+// one is delivered. Keys are plain integers kept in a fixed table, so nothing
+// is allocated per event.
+class InputEventDeduplicator {
+  public:
+    struct Key {
+      int sourceId;
+      int type;
+      int detail;
+      Position position;
+      Position scrollAmount;
+
+      bool operator==(const Key& other) const {
+        return sourceId == other.sourceId
+          && type == other.type
+          && detail == other.detail
+          && position.x == other.position.x
+          && position.y == other.position.y
+          && scrollAmount.x == other.scrollAmount.x
+          && scrollAmount.y == other.scrollAmount.y;
+      }
+    };
 
-  // Validate argument
-  if (info.Length() < 1 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Expected key symbol (integer)").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+    InputEventDeduplicator() { }
 
-  int rawKeySym = info[0].As<Napi::Number>().Int32Value();
+    // Whether an event with the same key was already delivered at this time
+    bool isDuplicate(const Key& key, unsigned long time) {
+      if (time > m_time) {
+        // Events of older times can't be duplicated anymore
+        m_size = 0;
+        m_time = time;
+        return false;
+      }
+      for (size_t index = 0; index < m_size; index++) {
+        if (m_keys[index] == key) {
+          return true;
+        }
+      }
+      return false;
+    }
 
-  try {
-    KeyPressUp(rawKeySym);
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+    void remember(const Key& key) {
+      if (m_size < m_keys.size()) {
+        m_keys[m_size++] = key;
+        return;
+      }
+      // Full: replace the oldest keys first
+      m_keys[m_next] = key;
+      m_next = (m_next + 1) % m_keys.size();
+    }
 
-void SendUnicodeCharacterWithModifiers(const std::string& grapheme) {
-  std::string utf8Character = grapheme;
+  private:
+    std::array<Key, 32> m_keys;
+    size_t m_size = 0;
+    size_t m_next = 0;
+    unsigned long m_time = 0;
+};
 
-  xdo_t* xdo = GetXdo();
-  // xdotool default delay is 12ms. Never set it to 0, otherwise non-ASCII
-  // characters will not be sent correctly.
-  unsigned int delay_microseconds = 12000;
-  int result = xdo_enter_text_window(xdo, CURRENTWINDOW, utf8Character.c_str(), delay_microseconds);
-  if (result != 0) {
-    throw std::runtime_error("Failed to send the following Unicode character with modifiers:" + utf8Character);
-  }
-}
+// Keyboard, mouse button and cursor state tracked from the input listener
+// events (see setInputStateTracking), so that queries read memory instead of
+// waiting for the X server. Tracking starts from XQueryKeymap and
+// XQueryPointer. Raw motion events carry no screen position: the listener
+// thread queries it once the pending motion events are processed, so a burst
+// of motion costs a single round trip, on the listener thread.
+class InputStateTracker {
+  public:
+    void setEnabled(bool isEnabled) {
+      m_isEnabled = isEnabled;
+    }
 
-Napi::Value TypeUnicodeCharacter(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+    bool isEnabled() const {
+      return m_isEnabled.load();
+    }
 
-  // Validate arguments
-  if (info.Length() < 1 || !info[0].IsString()) {
-    Napi::TypeError::New(env, "Expected a character as a string argument").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+    // Bit set of the key codes currently pressed, queried from the server
+    static std::array<uint64_t, 4> queryKeys(Display* display) {
+      char keymap[32];
+      XQueryKeymap(display, keymap);
+      std::array<uint64_t, 4> keys{};
+      for (size_t word = 0; word < keys.size(); word++) {
+        // Bit N of the keymap is key code N
+        for (size_t byte = 0; byte < 8; byte++) {
+          keys[word] |= static_cast<uint64_t>(static_cast<uint8_t>(keymap[word * 8 + byte])) << (byte * 8);
+        }
+      }
+      return keys;
+    }
 
-  std::string utf8string = info[0].As<Napi::String>().Utf8Value();
-  std::string character = utf8string;
+    // Whether the server sees a key symbol as held, on its first level in the
+    // current keyboard group
+    static bool isKeyPressed(Display* display, KeySym keySym) {
+      return isKeyPressed(display, keySym, queryKeys(display), queryKeyboardGroup(display));
+    }
 
-  if (character.size() < 1) {
-    Napi::TypeError::New(env, character + " is not a valid unicode character").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+    static bool isKeyPressed(Display* display, KeySym keySym, const std::array<uint64_t, 4>& keys, int group) {
+      for (size_t word = 0; word < keys.size(); word++) {
+        for (uint64_t bits = keys[word]; bits != 0; bits &= bits - 1) {
+          KeyCode keyCode = static_cast<KeyCode>(word * 64 + __builtin_ctzll(bits));
+          if (XkbKeycodeToKeysym(display, keyCode, group, 0) == keySym) {
+            return true;
+          }
+        }
+      }
+      return false;
+    }
 
-  try {
-    SendUnicodeCharacterWithModifiers(character);
-    return env.Undefined();
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-}
+    static int queryKeyboardGroup(Display* display) {
+      XkbStateRec xkbState;
+      return XkbGetState(display, XkbUseCoreKbd, &xkbState) == Success ? xkbState.group : 0;
+    }
 
+    // Overwrite the tracked state with the server state
+    void seed(Display* display) {
+      std::array<uint64_t, 4> keys = queryKeys(display);
+      for (size_t word = 0; word < m_keys.size(); word++) {
+        m_keys[word] = keys[word];
+      }
+      Window root, child;
+      int x, y, windowX, windowY;
+      unsigned int mask;
+      if (XQueryPointer(display, DefaultRootWindow(display), &root, &child, &x, &y, &windowX, &windowY, &mask)) {
+        setCursor({ x, y });
+        // The pointer mask only knows buttons 1 to 5
+        uint32_t buttons = m_buttons.load() & ~0x3Eu;
+        for (unsigned int button = 1; button <= 5; button++) {
+          if (mask & (Button1Mask << (button - 1))) {
+            buttons |= 1u << button;
+          }
+        }
+        m_buttons = buttons;
+      }
+      XkbStateRec xkbState;
+      if (XkbGetState(display, XkbUseCoreKbd, &xkbState) == Success) {
+        m_keyboardGroup = xkbState.group;
+      }
+    }
 
-// =============================================================================
-// ============================= HOOK PROCEDURES ===============================
-// =============================================================================
+    void setKeyPressed(unsigned int keyCode, bool isPressed) {
+      const uint64_t bit = uint64_t(1) << (keyCode % 64);
+      if (isPressed) {
+        m_keys[(keyCode / 64) % m_keys.size()] |= bit;
+      }
+      else {
+        m_keys[(keyCode / 64) % m_keys.size()] &= ~bit;
+      }
+    }
 
-Napi::Object BuildInputEventObject(const Napi::Env& env, const RawInputEvent& event) {
-  Napi::Object eventObj = Napi::Object::New(env);
-  eventObj.Set(Napi::String::New(env, "type"), Napi::String::New(env, event.type));
-  eventObj.Set(Napi::String::New(env, "timestamp"), Napi::Number::New(env, event.timestamp));
-  if (event.type == "mouse") {
-    eventObj.Set(Napi::String::New(env, "input"), Napi::String::New(env, event.input));
-    eventObj.Set(Napi::String::New(env, "state"), Napi::String::New(env, event.state));
-    Napi::Object position = Napi::Object::New(env);
-    position.Set(Napi::String::New(env, "x"), Napi::Number::New(env, event.x));
-    position.Set(Napi::String::New(env, "y"), Napi::Number::New(env, event.y));
-    eventObj.Set(Napi::String::New(env, "position"), position);
-  } else if (event.type == "keyboard") {
-    eventObj.Set(Napi::String::New(env, "input"), Napi::Number::New(env, event.keyCode));
-    eventObj.Set(Napi::String::New(env, "state"), Napi::String::New(env, event.state));
-  }
-  eventObj.Set(Napi::String::New(env, "isInjected"), Napi::Boolean::New(env, event.isInjected));
-  eventObj.Set(Napi::String::New(env, "isSuppressed"), Napi::Boolean::New(env, event.isSuppressed));
-  return eventObj;
-}
+    void setButtonPressed(unsigned int button, bool isPressed) {
+      if (button >= 32) {
+        return;
+      }
+      if (isPressed) {
+        m_buttons |= 1u << button;
+      }
+      else {
+        m_buttons &= ~(1u << button);
+      }
+    }
 
-void InputEventProcessingThread() {
-  // Initialize XInput2 listener
-  Display* inputDisplay = GetInputDisplay();
-  Window rootWindow = DefaultRootWindow(inputDisplay);
-  int opcode, event, error;
-  {
-    std::lock_guard<std::mutex> lock(inputEventHookMutex);
-    if (!XQueryExtension(inputDisplay, "XInputExtension", &opcode, &event, &error)) {
-      throw std::runtime_error("XInputExtension is not available.");
+    void setCursor(Position position) {
+      m_cursor = (static_cast<uint64_t>(static_cast<uint32_t>(position.x)) << 32) | static_cast<uint32_t>(position.y);
     }
 
-    int majorVersion = 2, minorVersion = 0;
-    int status = XIQueryVersion(inputDisplay, &majorVersion, &minorVersion);
-    if (status != Success) {
-      throw std::runtime_error("XInputExtension 2.0 is not available. Server supports version " + std::to_string(majorVersion) + "." + std::to_string(minorVersion));
+    void setKeyboardGroup(int group) {
+      m_keyboardGroup = group;
     }
 
-    XIEventMask eventMask;
-    unsigned char eventMaskData[(XI_LASTEVENT + 7) / 8];
+    // Both coordinates are read at once
+    Position cursor() const {
+      const uint64_t cursor = m_cursor.load();
+      return { static_cast<int32_t>(cursor >> 32), static_cast<int32_t>(cursor & 0xFFFFFFFF) };
+    }
 
-    std::memset(eventMaskData, 0, sizeof(eventMaskData));
+    // Bit set of the pressed key codes
+    std::array<uint64_t, 4> keys() const {
+      return { m_keys[0].load(), m_keys[1].load(), m_keys[2].load(), m_keys[3].load() };
+    }
 
-    eventMask.deviceid = XIAllDevices;
-    eventMask.mask_len = sizeof(eventMaskData);
-    eventMask.mask = eventMaskData;
+    bool isButtonPressed(unsigned int button) const {
+      return button < 32 && (m_buttons.load() & (1u << button)) != 0;
+    }
 
-    // Keyboard
-    XISetMask(eventMask.mask, XI_RawKeyPress);
-    XISetMask(eventMask.mask, XI_RawKeyRelease);
+    int keyboardGroup() const {
+      return m_keyboardGroup.load();
+    }
 
-    // Mouse
-    XISetMask(eventMask.mask, XI_RawButtonPress);
-    XISetMask(eventMask.mask, XI_RawButtonRelease);
+  private:
+    std::atomic<bool> m_isEnabled{false};
+    std::atomic<uint64_t> m_cursor{0};
+    std::array<std::atomic<uint64_t>, 4> m_keys{};
+    // Bit per X11 button number
+    std::atomic<uint32_t> m_buttons{0};
+    std::atomic<int> m_keyboardGroup{0};
+};
+
+template <typename T>
+class PromiseWorker : public Napi::AsyncWorker {
+  public:
+
+    PromiseWorker(
+      Napi::Env env,
+      Napi::Promise::Deferred deferred,
+      std::function<T()> executeCallback,
+      std::function<Napi::Value(Napi::Env, const T&)> resolveConverter
+    ) : Napi::AsyncWorker(env), deferred(deferred), executeCallback(executeCallback), resolveConverter(resolveConverter) { }
+
+    ~PromiseWorker() override { }
+
+    void Execute() override {
+      try {
+        promiseResolveResult = executeCallback();
+      } catch (const std::exception& e) {
+        SetError(e.what());
+      } catch (...) {
+        SetError("Unknown error occurred");
+      }
+    }
+
+    void OnOK() override {
+      deferred.Resolve(resolveConverter(Env(), promiseResolveResult));
+    }
+
+    void OnError(const Napi::Error& error) override {
+      deferred.Reject(error.Value());
+    }
+
+  private:
+    Napi::Promise::Deferred deferred;
+    std::function<T()> executeCallback;
+    std::function<Napi::Value(Napi::Env, const T&)> resolveConverter;
+    T promiseResolveResult;
+};
+
+
+// =============================================================================
+// ============================== GLOBAL VARIABLES =============================
+// =============================================================================
+
+// X11 input display
+Display* globalInputDisplay = nullptr;
+// X11 window display
+Display* globalWindowDisplay = nullptr;
+// X11 clipboard display
+Display* globalClipboardDisplay = nullptr;
+// X11 tray icon display
+Display* globalTrayIconDisplay = nullptr;
+
+// Input events variables
+std::mutex inputEventHookMutex;
+std::atomic<bool> inputEventRunning(false);
+std::condition_variable inputEventHookCondition;
+Napi::ThreadSafeFunction inputEventThreadSafeJsFunction;
+// Created on the main thread on the first input event (see BuildInputEventObject)
+std::unique_ptr<InputEventObjectBuilder> inputEventObjectBuilder;
+std::thread inputEventThread;
+// Input event batching (see setInputEventBatching). Events are sent one by
+// one while both the interval (ms) and the size are 0.
+std::atomic<uint32_t> inputEventBatchInterval(0);
+std::atomic<uint32_t> inputEventBatchSize(0);
+std::atomic<bool> inputEventMotionCoalescing(false);
+// Input event subscription, replaced as a whole with std::atomic_store so the
+// listener thread never waits for it. XInput2 events are selected accordingly
+// while inputEventSelected is set (guarded by inputEventHookMutex).
+std::shared_ptr<const InputEventFilter> inputEventFilter = std::make_shared<const InputEventFilter>();
+bool inputEventSelected = false;
+// Whether raw motion events are currently selected, so the listener thread can
+// track the cursor position from them (see SelectInputEvents)
+std::atomic<bool> inputEventMotionSelected(false);
+std::atomic<bool> inputEventSelectionChanged(false);
+// Input state answering queries without round trips while the listener runs
+InputStateTracker inputStateTracker;
+
+// Window events variables
+std::mutex windowEventHookMutex;
+std::atomic<bool> windowEventRunning(false);
+std::condition_variable windowEventHookCondition;
+Napi::ThreadSafeFunction windowEventThreadSafeJsFunction;
+std::thread windowEventThread;
+
+// Clipboard events variables
+std::mutex clipboardEventHookMutex;
+std::atomic<bool> clipboardEventRunning(false);
+std::condition_variable clipboardEventHookCondition;
+std::thread clipboardEventThread;
+Window clipboardWindow = None;
+std::string clipboardTextContent;
+Time clipboardOwnershipTakenAt;
+
+// Tray icon events variables
+std::mutex trayIconEventHookMutex;
+std::atomic<bool> trayIconEventRunning(false);
+std::condition_variable trayIconEventHookCondition;
+std::thread trayIconEventThread;
+Window trayIconWindow = None;
+GC trayIconGraphicsContext = None;
+XImage* trayIconImage = nullptr;
+std::vector<unsigned long> trayIconPixels;
+const unsigned int TRAY_ICON_SIZE = 32;
+
+// Cache Atom values to reduce XInternAtom calls
+std::unordered_map<std::string, Atom> atomCacheMap = {};
+
+// Maps to store mouse and keyboard suppressed keys
+std::map<int, std::set<int>> suppressedMouseKeys;
+std::map<int, std::set<int>> suppressedKeyboardKeys;
+std::mutex suppressedKeysMutex;
+// Snapshot of the maps above for the input listener (see InputSuppressionTable)
+std::shared_ptr<const InputSuppressionTable> inputSuppressionTable = std::make_shared<const InputSuppressionTable>();
+
+// Audio manager
+AudioManager* audioManager = nullptr;
+
+// Active screen recorders by ID
+std::map<int, std::shared_ptr<ScreenRecorder>> screenRecorders;
+std::mutex screenRecordersMutex;
+int nextScreenRecorderId = 1;
+
+// Active flight recorders by ID
+std::map<int, std::shared_ptr<FlightRecorder>> flightRecorders;
+std::mutex flightRecordersMutex;
+int nextFlightRecorderId = 1;
+
+// Active screen frame feeds by ID, with the JS objects they depend on
+struct ScreenFrameFeedHandle {
+  std::shared_ptr<ScreenFrameFeed> feed;
+  Napi::ThreadSafeFunction onFrame;
+  Napi::Reference<Napi::Uint8Array> memory;
+};
+std::map<int, ScreenFrameFeedHandle> screenFrameFeeds;
+std::mutex screenFrameFeedsMutex;
+int nextScreenFrameFeedId = 1;
+
+// Active input event rings by ID, with the JS objects they depend on. The
+// input listener thread writes every event to each of them.
+struct InputEventRingHandle {
+  std::shared_ptr<InputEventRing> ring;
+  Napi::ThreadSafeFunction onWaiting;
+  Napi::Reference<Napi::Uint8Array> memory;
+};
+std::map<int, InputEventRingHandle> inputEventRings;
+std::mutex inputEventRingsMutex;
+int nextInputEventRingId = 1;
+
+// Active native input recorders by ID. The input listener thread records every
+// event into each of them.
+std::map<int, std::shared_ptr<InputRecorder>> inputRecorders;
+std::mutex inputRecordersMutex;
+int nextInputRecorderId = 1;
+
+// Running native input replayers by ID. A replayer is removed once its end was
+// settled on the JS thread.
+std::map<int, std::shared_ptr<InputReplayer>> inputReplayers;
+std::mutex inputReplayersMutex;
+int nextInputReplayerId = 1;
+
+// Registered hotkeys and their JS callbacks by ID (see registerHotkey)
+HotkeyMatcher hotkeyMatcher;
+std::map<int, Napi::ThreadSafeFunction> hotkeyThreadSafeJsFunctions;
+std::mutex hotkeysMutex;
+int nextHotkeyId = 1;
+
+// Recently recognized OCR results
+OcrResultCache ocrResultCache(64);
+
+// Runs input sequences sent with sendInputSequence
+InputSequencer inputSequencer;
+
+// Fires the asynchronous sleeps of sleepAsync
+TimerService timerService;
+
+// FLTK thread variables
+std::mutex fltkEventHookMutex;
+std::atomic<bool> fltkEventRunning(false);
+std::condition_variable fltkEventHookCondition;
+std::thread fltkEventThread;
+Fl_Window* globalFltkWindow = nullptr;
+std::function<void()> globalFltkCallback;
+std::atomic<bool> isFltkTrayIconContextMenuOpen(false);
+std::map<int, std::function<void()>> trayIconMenuItemsCallbacks;
+std::map<int, Napi::ThreadSafeFunction> trayIconMenuItemsJsCallbacks;
+std::map<int, std::string> trayIconMenuItemsLabels;
+std::vector<unsigned int> trayIconMenuItemsPositionsToItemsIds;
+
+
+// =============================================================================
+// ============================= UTILITY FUNCTIONS =============================
+// =============================================================================
+
+Display* GetInputDisplay() {
+  if (globalInputDisplay != nullptr) {
+    return globalInputDisplay;
+  }
+
+  globalInputDisplay = XOpenDisplay(nullptr);
+  if (!globalInputDisplay) {
+    globalInputDisplay = nullptr;
+    throw std::runtime_error("Failed to open X display.");
+  }
+  return globalInputDisplay;
+}
+
+void CloseInputDisplay() {
+  if (globalInputDisplay != nullptr) {
+    XCloseDisplay(globalInputDisplay);
+  }
+  globalInputDisplay = nullptr;
+}
+
+Display* GetWindowDisplay() {
+  if (globalWindowDisplay != nullptr) {
+    return globalWindowDisplay;
+  }
+
+  globalWindowDisplay = XOpenDisplay(nullptr);
+  if (!globalWindowDisplay) {
+    globalWindowDisplay = nullptr;
+    throw std::runtime_error("Failed to open X display.");
+  }
+  return globalWindowDisplay;
+}
+
+void CloseWindowDisplay() {
+  if (globalWindowDisplay != nullptr) {
+    XCloseDisplay(globalWindowDisplay);
+  }
+  globalWindowDisplay = nullptr;
+}
+
+Atom GetAtom(const std::string& name, Display* display = nullptr) {
+  if (atomCacheMap.find(name) != atomCacheMap.end()) return atomCacheMap[name];
+  Display* xDisplay = (display == nullptr) ? GetWindowDisplay() : display;
+  Atom atom = XInternAtom(xDisplay, name.c_str(), False);
+  atomCacheMap[name] = atom;
+  return atom;
+}
+
+Display* GetClipboardDisplay() {
+  if (globalClipboardDisplay != nullptr) {
+    return globalClipboardDisplay;
+  }
+
+  globalClipboardDisplay = XOpenDisplay(nullptr);
+  if (!globalClipboardDisplay) {
+    globalClipboardDisplay = nullptr;
+    throw std::runtime_error("Failed to open X display.");
+  }
+  return globalClipboardDisplay;
+}
+
+void CloseClipboardDisplay() {
+  if (globalClipboardDisplay != nullptr) {
+    XCloseDisplay(globalClipboardDisplay);
+  }
+  globalClipboardDisplay = nullptr;
+}
+
+Display* GetTrayIconDisplay() {
+  if (globalTrayIconDisplay != nullptr) {
+    return globalTrayIconDisplay;
+  }
+
+  globalTrayIconDisplay = XOpenDisplay(nullptr);
+  if (!globalTrayIconDisplay) {
+    globalTrayIconDisplay = nullptr;
+    throw std::runtime_error("Failed to open X display.");
+  }
+  return globalTrayIconDisplay;
+}
+
+void CloseTrayIconDisplay() {
+  if (globalTrayIconDisplay != nullptr) {
+    XCloseDisplay(globalTrayIconDisplay);
+  }
+  globalTrayIconDisplay = nullptr;
+}
+
+AudioManager* GetAudioManager() {
+  if (audioManager == nullptr) {
+    audioManager = new AudioManager();
+  }
+  return audioManager;
+}
+
+void CloseAudioManager() {
+  if (audioManager != nullptr) {
+    delete audioManager;
+    audioManager = nullptr;
+  }
+}
+
+// X11 Global error handler.
+// Some errors are thrown by X11 asynchronously and often kills the process
+// To avoid that, we use this handler to catch the errors and avoid process termination
+int X11GlobalErrorHandler(Display* anyDisplay, XErrorEvent* error_event) {
+  char error_text[256];
+  XGetErrorText(anyDisplay, error_event->error_code, error_text, sizeof(error_text));
+
+  char opcode_str[32];
+  snprintf(opcode_str, sizeof(opcode_str), "%d", error_event->request_code);
+  char request_name[256] = {0};
+  XGetErrorDatabaseText(
+    anyDisplay,
+    "XRequest",
+    opcode_str,
+    "",
+    request_name,
+    sizeof(request_name)
+  );
+  if (request_name[0] == '\0') {
+    std::strncpy(request_name, "Unknown", sizeof(request_name));
+  }
+
+  std::cerr << "X11 Error:" << std::endl
+    << "  Error: " << error_text << std::endl
+    << "  Major opcode of failed request: " << static_cast<int>(error_event->request_code)
+                                            << " (" << request_name << ")"
+                                            << std::endl
+    << "  Serial number of failed request: " << error_event->serial << std::endl
+    << "  Current serial number in output stream: " << NextRequest(anyDisplay) - 1 << std::endl
+    << "This X11 error has been intercepted by Actionify and will not kill the process." << std::endl
+  ;
+
+  // Returning 0 prevents Xlib from calling exit().
+  // This avoids process termination.
+  return 0;
+}
+
+// Function to get the absolute mouse position if the event is a mouse move event
+std::optional<Position> GetMouseEventPosition(const XIRawEvent& xiRawEvent) {
+  constexpr int MouseXAxis = 0;
+  constexpr int MouseYAxis = 1;
+
+  int valueIndex = 0;
+  Position result = {0, 0};
+  bool foundXAxis = false;
+  bool foundYAxis = false;
+  for (int axis = 0; axis < xiRawEvent.valuators.mask_len * 8; ++axis) {
+    if (XIMaskIsSet(xiRawEvent.valuators.mask, axis)) {
+      double delta = xiRawEvent.raw_values[valueIndex++];
+      if (axis == MouseXAxis) {
+        result.x = delta;
+        foundXAxis = true;
+      }
+      else if (axis == MouseYAxis) {
+        result.y = delta;
+        foundYAxis = true;
+      }
+    }
+  }
+
+  if (foundXAxis || foundYAxis) {
+    return result;
+  }
+
+  return std::nullopt;
+}
+
+// Function to get the scroll amount if the event is a mouse wheel event
+std::optional<Position> GetMouseWheelEventScrollAmount(const XIRawEvent& xiRawEvent) {
+  constexpr int WheelXAxis = 2;
+  constexpr int WheelYAxis = 3;
+
+  int valueIndex = 0;
+  Position result = {0, 0};
+  bool foundXAxis = false;
+  bool foundYAxis = false;
+  for (int axis = 0; axis < xiRawEvent.valuators.mask_len * 8; ++axis) {
+    if (XIMaskIsSet(xiRawEvent.valuators.mask, axis)) {
+      double delta = xiRawEvent.raw_values[valueIndex++];
+      if (axis == WheelXAxis) {
+        result.x = delta;
+        foundXAxis = true;
+      }
+      else if (axis == WheelYAxis) {
+        result.y = delta;
+        foundYAxis = true;
+      }
+    }
+  }
+
+  if (foundXAxis || foundYAxis) {
+    return result;
+  }
+
+  return std::nullopt;
+}
+
+// Function to find the XTEST devices, used to tell injected input events apart
+XTestDeviceIds GetXTestDeviceIds() {
+  Display* inputDisplay = GetInputDisplay();
+  XTestDeviceIds result;
+
+  int ndevices = 0;
+  XIDeviceInfo* devices = XIQueryDevice(inputDisplay, XIAllDevices, &ndevices);
+
+  if (!devices) {
+    return result;
+  }
+
+  for (int i = 0; i < ndevices; ++i) {
+    const char* name = devices[i].name;
+
+    if (!name) {
+      continue;
+    }
+    if (!result.mouse && std::strstr(name, "XTEST pointer") != nullptr) {
+      result.mouse = devices[i].deviceid;
+    }
+    else if (!result.keyboard && std::strstr(name, "XTEST keyboard") != nullptr) {
+      result.keyboard = devices[i].deviceid;
+    }
+  }
+
+  XIFreeDeviceInfo(devices);
+  return result;
+}
+
+// Return this dynamic library's absolute directory path (/path/to/build/Release/actionify.node)
+std::filesystem::path GetModuleAbsoluteDirectoryPath() {
+  Dl_info dlInfo;
+
+  dladdr(reinterpret_cast<void*>(GetModuleAbsoluteDirectoryPath), &dlInfo);
+
+  return std::filesystem::path(dlInfo.dli_fname).parent_path().string();
+}
+
+std::filesystem::path GetUserDataAbsoluteDirectoryPath() {
+  std::filesystem::path userDataAbsoluteDirectoryPath = (GetModuleAbsoluteDirectoryPath() / "../../data").lexically_normal();
+  std::filesystem::create_directories(userDataAbsoluteDirectoryPath);
+  return userDataAbsoluteDirectoryPath;
+}
+
+std::filesystem::path GetUserDataTtsAbsoluteDirectoryPath() {
+  std::filesystem::path userDataTtsAbsoluteDirectoryPath = (GetUserDataAbsoluteDirectoryPath() / "tts").lexically_normal();
+  std::filesystem::create_directories(userDataTtsAbsoluteDirectoryPath);
+  return userDataTtsAbsoluteDirectoryPath;
+}
+
+std::filesystem::path GetUserDataTmpAbsoluteDirectoryPath() {
+  std::filesystem::path userDataTmpAbsoluteDirectoryPath = (GetUserDataAbsoluteDirectoryPath() / "tmp").lexically_normal();
+  std::filesystem::create_directories(userDataTmpAbsoluteDirectoryPath);
+  return userDataTmpAbsoluteDirectoryPath;
+}
+
+std::optional<std::filesystem::path> FindFile(
+  const std::filesystem::path& directoryPath,
+  const std::function<bool(const std::filesystem::directory_entry&)>& predicate
+) {
+  for (const auto& entry : std::filesystem::directory_iterator(directoryPath)) {
+    if (predicate(entry)) {
+      return entry.path();
+    }
+  }
+  return std::nullopt;
+}
+
+template<typename T>
+T ExpectOrThrow(std::optional<T> value, std::string_view errorMessage) {
+  if (!value) {
+    throw std::runtime_error(std::string(errorMessage));
+  }
+
+  return std::move(*value);
+}
+
+std::string ToLower(const std::string& text) {
+  std::string result = text;
+  std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::tolower(c); });
+  return result;
+}
+
+uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Milliseconds on the monotonic clock since an unspecified point (usually the
+// boot), with sub-millisecond precision. Unlike Now(), it never jumps.
+double MonotonicNow() {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Refresh rate in Hz of the monitor showing (x, y), 60 if unknown
+double GetRefreshRate(int x, int y) {
+  Display* inputDisplay = GetInputDisplay();
+  XRRScreenResources* resources = XRRGetScreenResourcesCurrent(inputDisplay, DefaultRootWindow(inputDisplay));
+  if (!resources) {
+    return 60.0;
+  }
+  double refreshRate = 0;
+  for (int crtcIndex = 0; crtcIndex < resources->ncrtc && refreshRate == 0; crtcIndex++) {
+    XRRCrtcInfo* crtc = XRRGetCrtcInfo(inputDisplay, resources, resources->crtcs[crtcIndex]);
+    if (!crtc) {
+      continue;
+    }
+    bool isShowingPoint = (
+      crtc->mode != None
+      && x >= crtc->x && x < crtc->x + static_cast<int>(crtc->width)
+      && y >= crtc->y && y < crtc->y + static_cast<int>(crtc->height)
+    );
+    for (int modeIndex = 0; isShowingPoint && modeIndex < resources->nmode; modeIndex++) {
+      const XRRModeInfo& mode = resources->modes[modeIndex];
+      if (mode.id == crtc->mode && mode.hTotal > 0 && mode.vTotal > 0) {
+        refreshRate = static_cast<double>(mode.dotClock) / (static_cast<double>(mode.hTotal) * static_cast<double>(mode.vTotal));
+        break;
+      }
+    }
+    XRRFreeCrtcInfo(crtc);
+  }
+  XRRFreeScreenResources(resources);
+  return refreshRate >= 1 ? refreshRate : 60.0;
+}
+
+// Sequencer callback settling the deferred promise on the JS thread
+InputSequencer::Callback SettleInputSequence(Napi::Env env, Napi::Promise::Deferred deferred) {
+  Napi::ThreadSafeFunction settle = Napi::ThreadSafeFunction::New(
+    env,
+    Napi::Function::New(env, [](const Napi::CallbackInfo&) { }),
+    "sendInputSequence",
+    0,
+    1
+  );
+  return [settle, deferred](std::exception_ptr error) {
+    settle.BlockingCall([deferred, error](const Napi::Env& env, const Napi::Function&) {
+      if (!error) {
+        deferred.Resolve(env.Undefined());
+        return;
+      }
+      try {
+        std::rethrow_exception(error);
+      }
+      catch (const std::exception& e) {
+        deferred.Reject(Napi::Error::New(env, e.what()).Value());
+      }
+    });
+    settle.Release();
+  };
+}
+
+// Queue an input sequence program on the sequencer thread. The returned
+// promise settles on the JS thread once the program ran.
+Napi::Promise SubmitInputSequence(Napi::Env env, std::vector<int32_t> program) {
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  inputSequencer.submit(std::move(program), SettleInputSequence(env, deferred));
+  return deferred.Promise();
+}
+
+PIX* loadIcoToPix(const std::string& path) {
+  // Initialize FreeImage (safe to call multiple times in modern builds)
+  static bool initialized = false;
+  if (!initialized) {
+    FreeImage_Initialise();
+    initialized = true;
+  }
+
+  FREE_IMAGE_FORMAT fif = FreeImage_GetFileType(path.c_str(), 0);
+  if (fif == FIF_UNKNOWN) {
+    fif = FreeImage_GetFIFFromFilename(path.c_str());
+  }
+
+  if (fif != FIF_ICO) {
+    return nullptr;
+  }
+
+  FIMULTIBITMAP* ico = FreeImage_OpenMultiBitmap(FIF_ICO, path.c_str(), FALSE, TRUE, TRUE, 0);
+
+  if (!ico) return nullptr;
+
+  int count = FreeImage_GetPageCount(ico);
+  if (count <= 0) {
+    FreeImage_CloseMultiBitmap(ico, 0);
+    return nullptr;
+  }
+
+  FIBITMAP* best = nullptr;
+  int best_w = 0, best_h = 0;
+
+  // pick largest icon frame
+  for (int i = 0; i < count; i++) {
+    FIBITMAP* frame = FreeImage_LockPage(ico, i);
+    if (!frame) continue;
+
+    int w = FreeImage_GetWidth(frame);
+    int h = FreeImage_GetHeight(frame);
+
+    if (w * h > best_w * best_h) {
+      best_w = w;
+      best_h = h;
+
+      if (best) FreeImage_UnlockPage(ico, best, FALSE);
+      best = FreeImage_Clone(frame);
+    }
+
+    FreeImage_UnlockPage(ico, frame, FALSE);
+  }
+
+  FreeImage_CloseMultiBitmap(ico, 0);
+
+  if (!best) return nullptr;
+
+  // Convert to 32-bit RGBA
+  FIBITMAP* rgba = FreeImage_ConvertTo32Bits(best);
+  FreeImage_Unload(best);
+
+  if (!rgba) return nullptr;
+
+  int width  = FreeImage_GetWidth(rgba);
+  int height = FreeImage_GetHeight(rgba);
+
+  unsigned char* src = FreeImage_GetBits(rgba);
+  int src_pitch = FreeImage_GetPitch(rgba);
+
+  // Leptonica expects packed RGBA or RGB; we will build RGBA PIX
+  PIX* pix = pixCreate(width, height, 32);
+  if (!pix) {
+    FreeImage_Unload(rgba);
+    return nullptr;
+  }
+
+  for (int y = 0; y < height; y++) {
+    unsigned char* src_row = src + y * src_pitch;
+
+    for (int x = 0; x < width; x++) {
+      unsigned char b = src_row[4 * x + 0];
+      unsigned char g = src_row[4 * x + 1];
+      unsigned char r = src_row[4 * x + 2];
+      // unsigned char a = src_row[4 * x + 3];
+
+      pixSetRGBPixel(pix, x, y, r, g, b);
+    }
+  }
+
+  FreeImage_Unload(rgba);
+  return pix;
+}
+
+// Convert an XImage into an opaque 32bpp PIX. 32-bit TrueColor images in host
+// byte order (the common case) are read row by row without XGetPixel.
+PIX* XImageToPix(XImage* image) {
+  PIX* pix = pixCreate(image->width, image->height, 32);
+  if (!pix) return nullptr;
+
+  l_uint32* data = pixGetData(pix);
+  int wpl = pixGetWpl(pix);
+
+  const int endiannessProbe = 1;
+  const int hostByteOrder = *reinterpret_cast<const char*>(&endiannessProbe) == 1 ? LSBFirst : MSBFirst;
+  const bool isPackedTrueColor =
+    image->bits_per_pixel == 32
+    && image->byte_order == hostByteOrder
+    && image->red_mask == 0xff0000
+    && image->green_mask == 0xff00
+    && image->blue_mask == 0xff;
+
+  for (int imageY = 0; imageY < image->height; imageY++) {
+    l_uint32* line = data + imageY * wpl;
+    if (isPackedTrueColor) {
+      const uint32_t* row = reinterpret_cast<const uint32_t*>(image->data + imageY * image->bytes_per_line);
+      for (int imageX = 0; imageX < image->width; imageX++) {
+        // 0x00RRGGBB to Leptonica's 0xRRGGBBAA
+        line[imageX] = (row[imageX] << 8) | 0xff;
+      }
+    }
+    else {
+      for (int imageX = 0; imageX < image->width; imageX++) {
+        unsigned long pixel = XGetPixel(image, imageX, imageY);
+        l_uint8 red = (pixel & image->red_mask) >> 16;
+        l_uint8 green = (pixel & image->green_mask) >> 8;
+        l_uint8 blue = (pixel & image->blue_mask);
+        l_uint32 pixelColor;
+        composeRGBAPixel(red, green, blue, 255, &pixelColor);
+        line[imageX] = pixelColor;
+      }
+    }
+  }
+
+  return pix;
+}
+
+// Map an image format name to its Leptonica file format
+int ParseImageFormat(const std::string& format) {
+  std::string lowerFormat = ToLower(format);
+  if (lowerFormat == "png") return IFF_PNG;
+  if (lowerFormat == "jpeg" || lowerFormat == "jpg") return IFF_JFIF_JPEG;
+  if (lowerFormat == "bmp") return IFF_BMP;
+  throw std::runtime_error("Unsupported image format: " + format);
+}
+
+void globalFltkCallbackWrapper(void* data) {
+  globalFltkCallback();
+}
+
+
+// =============================================================================
+// ============================= RESOURCE CLEANUP ==============================
+// =============================================================================
+
+void CleanInputEventListener() {
+  if (inputEventRunning.load()) {
+    inputEventRunning = false;
+    {
+      std::unique_lock<std::mutex> lock(inputEventHookMutex);
+      Display* inputDisplay = GetInputDisplay();
+      Window rootWindow = DefaultRootWindow(inputDisplay);
+
+      XClientMessageEvent dummyEvent;
+      dummyEvent.type = ClientMessage;
+      dummyEvent.serial = CurrentTime;
+      dummyEvent.send_event = True;
+      dummyEvent.display = inputDisplay;
+      dummyEvent.window = rootWindow;
+      dummyEvent.format = 32;
+
+      XSendEvent(inputDisplay, rootWindow, False, PropertyChangeMask, reinterpret_cast<XEvent*>(&dummyEvent));
+
+      XSync(inputDisplay, False);
+    }
+
+    if (inputEventThread.joinable()) {
+      inputEventThread.join();
+    }
+
+    // Release rather than abort, so that the pending calls (such as the last batch) are made
+    inputEventThreadSafeJsFunction.Release();
+  }
+}
+
+void CleanWindowEventListener() {
+  if (windowEventRunning.load()) {
+    windowEventRunning = false;
+    {
+      std::unique_lock<std::mutex> lock(windowEventHookMutex);
+      Display* windowDisplay = GetWindowDisplay();
+      Window rootWindow = DefaultRootWindow(windowDisplay);
+
+      XClientMessageEvent dummyEvent;
+      dummyEvent.type = ClientMessage;
+      dummyEvent.serial = CurrentTime;
+      dummyEvent.send_event = True;
+      dummyEvent.display = windowDisplay;
+      dummyEvent.window = rootWindow;
+      dummyEvent.format = 32;
+
+      XSendEvent(windowDisplay, rootWindow, False, PropertyChangeMask, reinterpret_cast<XEvent*>(&dummyEvent));
+
+      XSync(windowDisplay, False);
+    }
+
+    if (windowEventThread.joinable()) {
+      windowEventThread.join();
+    }
+
+    windowEventThreadSafeJsFunction.Abort();
+  }
+}
+
+void CleanClipboardEventListener() {
+  if (clipboardEventRunning.load()) {
+    clipboardEventRunning = false;
+    Display* clipboardDisplay = GetClipboardDisplay();
+    Window rootWindow = DefaultRootWindow(clipboardDisplay);
+    {
+      std::unique_lock<std::mutex> lock(clipboardEventHookMutex);
+
+      XClientMessageEvent dummyEvent;
+      dummyEvent.type = ClientMessage;
+      dummyEvent.serial = CurrentTime;
+      dummyEvent.send_event = True;
+      dummyEvent.display = clipboardDisplay;
+      dummyEvent.window = rootWindow;
+      dummyEvent.format = 32;
+
+      XSendEvent(clipboardDisplay, rootWindow, False, PropertyChangeMask, reinterpret_cast<XEvent*>(&dummyEvent));
+
+      XSync(clipboardDisplay, False);
+    }
+
+    if (clipboardEventThread.joinable()) {
+      clipboardEventThread.join();
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(clipboardEventHookMutex);
+      // Reset clipboard window
+      if (clipboardWindow != None) {
+        // Unset our clipboard ownership
+        if (XGetSelectionOwner(clipboardDisplay, GetAtom("CLIPBOARD", clipboardDisplay)) == clipboardWindow) {
+          XSetSelectionOwner(clipboardDisplay, GetAtom("CLIPBOARD", clipboardDisplay), None, CurrentTime);
+        }
+        // Destroy our clipboard window
+        XDestroyWindow(clipboardDisplay, clipboardWindow);
+        XSync(clipboardDisplay, False);
+        // Reset our clipboard window variable
+        clipboardWindow = None;
+      }
+      // Reset clipboard text
+      clipboardTextContent.clear();
+      // Reset clipboard timestamp
+      clipboardOwnershipTakenAt = 0;
+    }
+  }
+}
+
+void CloseTrayIconContextMenu() {
+  if (isFltkTrayIconContextMenuOpen.load()) {
+    // Close tray icon context menu with [Escape] key.
+    KeyCode keyCode = XKeysymToKeycode(fl_display, XK_Escape);
+    if (keyCode > 0) {
+      XTestFakeKeyEvent(fl_display, keyCode, True, CurrentTime);
+      XTestFakeKeyEvent(fl_display, keyCode, False, CurrentTime);
+      XSync(fl_display, False);
+      // wait for FLTK to process the event
+      Fl::wait(0);
+      // Note: FLTK has a bug and will hang if [Escape] is pressed
+      //       physically or programatically when another window
+      //       achieves to take focus when FLTK's context menu
+      //       should have it FLTK and considers so. In such (rare)
+      //       cases, nothing can be done except force killing the process.
+    }
+  }
+}
+
+void CleanFltkEventListener() {
+  if (fltkEventRunning.load()) {
+
+    {
+      std::unique_lock<std::mutex> lock(fltkEventHookMutex);
+      // Ensure tray icon context menu is closed. Otherwise, the fltkEventThread
+      // will hang until the user closes it manually.
+      CloseTrayIconContextMenu();
+    }
+
+    fltkEventRunning = false;
+
+    if (fltkEventThread.joinable()) {
+      fltkEventThread.join();
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(fltkEventHookMutex);
+      globalFltkWindow = nullptr;
+      globalFltkCallback = [](){};
+    }
+
+  }
+}
+
+void CleanTrayIconEventListener() {
+  if (trayIconEventRunning.load()) {
+    trayIconEventRunning = false;
+    Display* trayIconDisplay = GetTrayIconDisplay();
+    Window rootWindow = DefaultRootWindow(trayIconDisplay);
+    {
+      std::unique_lock<std::mutex> lock(trayIconEventHookMutex);
+
+      XClientMessageEvent dummyEvent;
+      dummyEvent.type = ClientMessage;
+      dummyEvent.serial = CurrentTime;
+      dummyEvent.send_event = True;
+      dummyEvent.display = trayIconDisplay;
+      dummyEvent.window = rootWindow;
+      dummyEvent.format = 32;
+
+      XSendEvent(trayIconDisplay, rootWindow, False, NoEventMask, reinterpret_cast<XEvent*>(&dummyEvent));
+
+      XSync(trayIconDisplay, False);
+    }
+
+    if (trayIconEventThread.joinable()) {
+      trayIconEventThread.join();
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(trayIconEventHookMutex);
+      // Reset tray icon window
+      if (trayIconWindow != None) {
+        XDestroyWindow(trayIconDisplay, trayIconWindow);
+        // Reset our tray icon window variable
+        trayIconWindow = None;
+      }
+      // Reset tray icon graphics context
+      if (trayIconGraphicsContext != None) {
+        // Free our tray icon graphics context
+        XFreeGC(trayIconDisplay, trayIconGraphicsContext);
+        // Reset our tray icon graphics context variable
+        trayIconGraphicsContext = None;
+      }
+      if (trayIconImage != nullptr) {
+        // Free our tray icon image
+        XDestroyImage(trayIconImage);
+        // Reset our tray icon image variable
+        trayIconImage = nullptr;
+      }
+    }
+  }
+}
+
+void CleanScreenRecorders() {
+  std::map<int, std::shared_ptr<ScreenRecorder>> recorders;
+  {
+    std::lock_guard<std::mutex> lock(screenRecordersMutex);
+    recorders.swap(screenRecorders);
+  }
+  for (auto& [id, recorder] : recorders) {
+    try {
+      recorder->stop();
+    } catch (...) {
+      // The recording file is incomplete, but the cleanup must go on
+    }
+  }
+}
+
+void CleanInputEventRings() {
+  std::map<int, InputEventRingHandle> rings;
+  {
+    std::lock_guard<std::mutex> lock(inputEventRingsMutex);
+    rings.swap(inputEventRings);
+  }
+  for (auto& [id, handle] : rings) {
+    handle.ring->stop();
+    handle.onWaiting.Release();
+    handle.memory.Reset();
+  }
+}
+
+void CleanInputRecorders() {
+  std::map<int, std::shared_ptr<InputRecorder>> recorders;
+  {
+    std::lock_guard<std::mutex> lock(inputRecordersMutex);
+    recorders.swap(inputRecorders);
+  }
+  for (auto& [id, recorder] : recorders) {
+    try {
+      recorder->stop();
+    } catch (...) {
+      // The recording file is incomplete, but the cleanup must go on
+    }
+  }
+}
+
+void CleanInputReplayers() {
+  std::map<int, std::shared_ptr<InputReplayer>> replayers;
+  {
+    std::lock_guard<std::mutex> lock(inputReplayersMutex);
+    replayers.swap(inputReplayers);
+  }
+  for (auto& [id, replayer] : replayers) {
+    replayer->stop();
+  }
+}
+
+void CleanHotkeys() {
+  std::map<int, Napi::ThreadSafeFunction> threadSafeJsFunctions;
+  {
+    std::lock_guard<std::mutex> lock(hotkeysMutex);
+    hotkeyMatcher.clear();
+    threadSafeJsFunctions.swap(hotkeyThreadSafeJsFunctions);
+  }
+  for (auto& [id, threadSafeJsFunction] : threadSafeJsFunctions) {
+    threadSafeJsFunction.Release();
+  }
+}
+
+void CleanScreenFrameFeeds() {
+  std::map<int, ScreenFrameFeedHandle> feeds;
+  {
+    std::lock_guard<std::mutex> lock(screenFrameFeedsMutex);
+    feeds.swap(screenFrameFeeds);
+  }
+  for (auto& [id, handle] : feeds) {
+    handle.feed->stop();
+    handle.onFrame.Release();
+    handle.memory.Reset();
+  }
+}
+
+void CleanFlightRecorders() {
+  std::map<int, std::shared_ptr<FlightRecorder>> recorders;
+  {
+    std::lock_guard<std::mutex> lock(flightRecordersMutex);
+    recorders.swap(flightRecorders);
+  }
+  for (auto& [id, recorder] : recorders) {
+    recorder->stop();
+  }
+}
+
+void CleanInputSequencer() {
+  inputSequencer.stop();
+}
+
+void CleanTimerService() {
+  timerService.stop();
+}
+
+void CleanAll() {
+  CleanInputSequencer();
+  CleanTimerService();
+  CleanScreenRecorders();
+  CleanFlightRecorders();
+  CleanScreenFrameFeeds();
+  CleanInputEventRings();
+  CleanInputRecorders();
+  CleanInputReplayers();
+  CleanHotkeys();
+  inputStateTracker.setEnabled(false);
+  XSetErrorHandler(nullptr);
+  CleanInputEventListener();
+  inputEventObjectBuilder.reset();
+  CleanWindowEventListener();
+  CleanClipboardEventListener();
+  CleanTrayIconEventListener();
+  CleanFltkEventListener();
+  CloseInputDisplay();
+  CloseWindowDisplay();
+  CloseClipboardDisplay();
+  CloseTrayIconDisplay();
+  CloseAudioManager();
+}
+
+Napi::Value CleanupResources(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  CleanAll();
+  return env.Undefined();
+}
+
+
+// =============================================================================
+// ============================== MOUSE FUNCTIONS ==============================
+// =============================================================================
+
+// Whether the input state tracker is fed by a running input listener
+bool IsInputStateTracked() {
+  return inputStateTracker.isEnabled() && inputEventRunning.load();
+}
+
+// Function to query the current mouse cursor position from the X server
+Position QueryCursorPos() {
+  Display* inputDisplay = GetInputDisplay();
+
+  Window root = DefaultRootWindow(inputDisplay);
+  Window ret_root, ret_child;
+  int root_x, root_y;
+  int x, y;
+  unsigned int mask;
+
+  if (!XQueryPointer(inputDisplay, root, &ret_root, &ret_child, &root_x, &root_y, &x, &y, &mask)) {
+    throw std::runtime_error("Failed to query pointer position.");
+  }
+
+  Position cursorPosition;
+  cursorPosition.x = root_x;
+  cursorPosition.y = root_y;
+  return cursorPosition;
+}
+
+// Function to get the current mouse cursor position, without round trip
+// while the input state is tracked
+Position GetCursorPos() {
+  if (IsInputStateTracked()) {
+    return inputStateTracker.cursor();
+  }
+  return QueryCursorPos();
+}
+
+// Function to get the current mouse cursor horizontal position
+Napi::Value GetCursorPosX(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  try {
+    Position cursorPosition = GetCursorPos();
+    return Napi::Number::New(env, cursorPosition.x);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to get the current mouse cursor vertical position
+Napi::Value GetCursorPosY(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  try {
+    Position cursorPosition = GetCursorPos();
+    return Napi::Number::New(env, cursorPosition.y);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to get the current mouse cursor position
+Napi::Object GetCursorPosWrapper(const Napi::Env& env) {
+  // Create a JavaScript object to return the cursor position
+  Napi::Object mousePositionJS = Napi::Object::New(env);
+
+  // Define getter for 'x' coordinate
+  mousePositionJS.DefineProperty(
+    Napi::PropertyDescriptor::Accessor<GetCursorPosX>(Napi::String::New(env, "x"))
+  );
+
+  // Define getter for 'y' coordinate
+  mousePositionJS.DefineProperty(
+    Napi::PropertyDescriptor::Accessor<GetCursorPosY>(Napi::String::New(env, "y"))
+  );
+
+  return mousePositionJS;
+}
+
+// Function to set the mouse cursor position
+void SetCursorPos(int x, int y) {
+  Display* inputDisplay = GetInputDisplay();
+
+  // Move the pointer to absolute (x, y) coordinates
+  XTestFakeMotionEvent(inputDisplay, 0, x, y, CurrentTime);
+
+  // Flush to ensure the command is sent immediately
+  XFlush(inputDisplay);
+
+  // Track the new position before the listener sees the motion, confined to
+  // the screen as the server does
+  if (IsInputStateTracked()) {
+    int screen = DefaultScreen(inputDisplay);
+    inputStateTracker.setCursor({
+      std::clamp(x, 0, DisplayWidth(inputDisplay, screen) - 1),
+      std::clamp(y, 0, DisplayHeight(inputDisplay, screen) - 1)
+    });
+  }
+}
+
+// Function to set the mouse cursor position
+Napi::Value SetCursorPosWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "Expected two number arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int x = info[0].As<Napi::Number>().Int32Value();
+  int y = info[1].As<Napi::Number>().Int32Value();
+
+  try {
+    SetCursorPos(x, y);
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to simulate left mouse button down
+void LeftClickDown() {
+  Display* inputDisplay = GetInputDisplay();
+
+  // Send the left mouse button (= button 1) down event
+  XTestFakeButtonEvent(inputDisplay, 1, True, CurrentTime);
+
+  XFlush(inputDisplay);
+}
+
+// Function to simulate left mouse button down
+Napi::Value LeftClickDownWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  try {
+    LeftClickDown();
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to simulate left mouse button up
+void LeftClickUp() {
+  Display* inputDisplay = GetInputDisplay();
+
+  // Send the left mouse button (= button 1) up event
+  XTestFakeButtonEvent(inputDisplay, 1, False, CurrentTime);
+
+  XFlush(inputDisplay);
+}
+
+// Function to simulate left mouse button up
+Napi::Value LeftClickUpWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  try {
+    LeftClickUp();
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to simulate right mouse button down
+void RightClickDown() {
+  Display* inputDisplay = GetInputDisplay();
+
+  // Send the right mouse button (= button 3) down event
+  XTestFakeButtonEvent(inputDisplay, 3, True, CurrentTime);
+
+  XFlush(inputDisplay);
+}
+
+// Function to simulate right mouse button down
+Napi::Value RightClickDownWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  try {
+    RightClickDown();
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to simulate right mouse button up
+void RightClickUp() {
+  Display* inputDisplay = GetInputDisplay();
+
+  // Send the right mouse button (= button 3) up event
+  XTestFakeButtonEvent(inputDisplay, 3, False, CurrentTime);
+
+  XFlush(inputDisplay);
+}
+
+// Function to simulate right mouse button up
+Napi::Value RightClickUpWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  try {
+    RightClickUp();
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to simulate middle mouse button down
+void MouseWheelPressDown() {
+  Display* inputDisplay = GetInputDisplay();
+
+  // Send the mouse middle button (= button 2) down event
+  XTestFakeButtonEvent(inputDisplay, 2, True, CurrentTime);
+
+  XFlush(inputDisplay);
+}
+
+// Function to simulate middle mouse button down
+Napi::Value MouseWheelPressDownWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  try {
+    MouseWheelPressDown();
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to simulate middle mouse button up
+void MouseWheelPressUp() {
+  Display* inputDisplay = GetInputDisplay();
+
+  // Send the mouse middle button (= button 2) up event
+  XTestFakeButtonEvent(inputDisplay, 2, False, CurrentTime);
+
+  XFlush(inputDisplay);
+}
+
+// Function to simulate middle mouse button up
+Napi::Value MouseWheelPressUpWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  try {
+    MouseWheelPressUp();
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to simulate mouse wheel scroll down
+void MouseWheelScrollDown(int scrollAmount) {
+  Display* inputDisplay = GetInputDisplay();
+
+  for (int i = 0; i < scrollAmount; i++) {
+    XTestFakeButtonEvent(inputDisplay, 5, True, CurrentTime);
+    XTestFakeButtonEvent(inputDisplay, 5, False, CurrentTime);
+  }
+
+  XFlush(inputDisplay);
+}
+
+// Function to simulate mouse wheel scroll down
+Napi::Value MouseWheelScrollDownWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  int scrollAmount = 1; // Default value
+  if (info.Length() > 0 && info[0].IsNumber()) {
+    scrollAmount = info[0].As<Napi::Number>().Int32Value();
+  }
+
+  try {
+    MouseWheelScrollDown(scrollAmount);
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to simulate mouse wheel scroll up
+void MouseWheelScrollUp(int scrollAmount) {
+  Display* inputDisplay = GetInputDisplay();
+
+  for (int i = 0; i < scrollAmount; i++) {
+    XTestFakeButtonEvent(inputDisplay, 4, True, CurrentTime);
+    XTestFakeButtonEvent(inputDisplay, 4, False, CurrentTime);
+  }
+
+  XFlush(inputDisplay);
+}
+
+// Function to simulate mouse wheel scroll up
+Napi::Value MouseWheelScrollUpWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  int scrollAmount = 1; // Default value
+  if (info.Length() > 0 && info[0].IsNumber()) {
+    scrollAmount = info[0].As<Napi::Number>().Int32Value();
+  }
+
+  try {
+    MouseWheelScrollUp(scrollAmount);
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to simulate extra mouse button down
+void MouseExtraButtonDown(int extraButtonIndex) {
+  Display* inputDisplay = GetInputDisplay();
+
+  // extraButtonIndex is 1 | 2
+  int linuxExtraButtonIndex = 8 + (extraButtonIndex - 1);
+  XTestFakeButtonEvent(inputDisplay, linuxExtraButtonIndex, True, CurrentTime);
+
+  XFlush(inputDisplay);
+}
+
+// Function to simulate extra mouse button down
+Napi::Value MouseExtraButtonDownWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate argument
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected extra button index (strictly positive integer)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int extraButtonIndex = info[0].As<Napi::Number>().Int32Value();
+
+  try {
+    MouseExtraButtonDown(extraButtonIndex);
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to simulate extra mouse button up
+void MouseExtraButtonUp(int extraButtonIndex) {
+  Display* inputDisplay = GetInputDisplay();
+
+  // extraButtonIndex is 1 | 2
+  int linuxExtraButtonIndex = 8 + (extraButtonIndex - 1);
+  XTestFakeButtonEvent(inputDisplay, linuxExtraButtonIndex, False, CurrentTime);
+
+  XFlush(inputDisplay);
+}
+
+// Function to simulate extra mouse button up
+Napi::Value MouseExtraButtonUpWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate argument
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected extra button index (strictly positive integer)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int extraButtonIndex = info[0].As<Napi::Number>().Int32Value();
+
+  try {
+    MouseExtraButtonUp(extraButtonIndex);
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+
+// Build the input sequence program of a smooth cursor motion: one move per
+// monitor refresh (or per requested step), on evenly spaced deadlines.
+// Positions repeating the previous one are merged into the next move.
+std::vector<int32_t> BuildCursorMotionProgram(const CursorMotion& motion, double refreshRate) {
+  const double dx = motion.to.x - motion.from.x;
+  const double dy = motion.to.y - motion.from.y;
+  const double distance = std::hypot(dx, dy);
+  const int64_t durationUs = std::llround(std::max(0.0, motion.durationMs) * 1000.0);
+  const size_t pointCount = motion.steps > 0
+    ? static_cast<size_t>(motion.steps) + 1
+    : std::max<size_t>(1, static_cast<size_t>(std::llround(motion.durationMs * refreshRate / 1000.0)));
+
+  // Unit vector perpendicular to the motion, on the mirrored side if requested
+  const double side = motion.isMirrored ? -1.0 : 1.0;
+  const double normalX = distance > 0 ? -dy / distance * side : 0;
+  const double normalY = distance > 0 ? dx / distance * side : 0;
+  const double amplitude = motion.curviness * distance;
+
+  std::mt19937 random(std::random_device{}());
+  std::uniform_real_distribution<double> unit(-1.0, 1.0);
+
+  // Wave half periods: by default an even count, at most one per 60 positions.
+  // A requested frequency is only capped so that every half period keeps at
+  // least two positions.
+  const long maxHalfWaves = static_cast<long>(pointCount / 60) - static_cast<long>(pointCount / 60) % 2;
+  const long maxRequestedHalfWaves = std::max(2L, static_cast<long>(pointCount / 2));
+  const long halfWaves = motion.frequency > 0
+    ? std::max(2L, std::min(maxRequestedHalfWaves, std::lround(motion.frequency * 2)))
+    : std::max(2L, maxHalfWaves);
+
+  // Human-like control points, a third and two thirds along the motion
+  const double humanOffset1 = amplitude * (0.5 + 0.5 * std::abs(unit(random)));
+  const double humanOffset2 = amplitude * unit(random) * 0.5;
+
+  std::vector<int32_t> program;
+  program.reserve(pointCount * INPUT_SEQUENCE_RECORD_SIZE);
+  int32_t previousX = motion.from.x;
+  int32_t previousY = motion.from.y;
+  int64_t previousTimeUs = 0;
+  for (size_t point = 1; point <= pointCount; point++) {
+    const bool isLast = point == pointCount;
+    const double t = static_cast<double>(point) / static_cast<double>(pointCount);
+    double x = motion.from.x + t * dx;
+    double y = motion.from.y + t * dy;
+    switch (motion.curve) {
+      case CursorMotionCurve::Linear:
+        break;
+      case CursorMotionCurve::Arc: {
+        // Control point above the middle of the motion: the curve peaks at half its height
+        const double offset = 2.0 * t * (1.0 - t) * amplitude;
+        x += normalX * offset;
+        y += normalY * offset;
+        break;
+      }
+      case CursorMotionCurve::Wave: {
+        const double offset = std::sin(t * std::acos(-1.0) * halfWaves) * amplitude / 2.0;
+        x -= normalX * offset;
+        y -= normalY * offset;
+        break;
+      }
+      case CursorMotionCurve::Human: {
+        // Minimum-jerk timing: slow start, fast middle, slow end
+        const double s = t * t * t * (10.0 - 15.0 * t + 6.0 * t * t);
+        const double u = 1.0 - s;
+        const double offset = 3.0 * u * u * s * humanOffset1 + 3.0 * u * s * s * humanOffset2;
+        x = motion.from.x + s * dx + normalX * offset;
+        y = motion.from.y + s * dy + normalY * offset;
+        break;
+      }
+    }
+    if (!isLast && motion.jitter > 0) {
+      x += unit(random) * motion.jitter;
+      y += unit(random) * motion.jitter;
+    }
+
+    const int32_t roundedX = isLast ? motion.to.x : static_cast<int32_t>(std::lround(x));
+    const int32_t roundedY = isLast ? motion.to.y : static_cast<int32_t>(std::lround(y));
+    if (!isLast && roundedX == previousX && roundedY == previousY) {
+      continue;
+    }
+    const int64_t timeUs = durationUs * static_cast<int64_t>(point) / static_cast<int64_t>(pointCount);
+    program.insert(program.end(), {
+      static_cast<int32_t>(InputSequenceOpcode::Move),
+      roundedX,
+      roundedY,
+      static_cast<int32_t>(std::min<int64_t>(timeUs - previousTimeUs, INT32_MAX))
+    });
+    previousX = roundedX;
+    previousY = roundedY;
+    previousTimeUs = timeUs;
+  }
+  return program;
+}
+
+// Read the smooth cursor motion options given to moveCursorSmoothly
+bool ParseCursorMotion(Napi::Env env, Napi::Object options, CursorMotion& motion) {
+  auto readNumber = [&options](const char* name, double& value) {
+    Napi::Value jsValue = options.Get(name);
+    if (jsValue.IsUndefined()) {
+      return true;
+    }
+    if (!jsValue.IsNumber() || !std::isfinite(jsValue.As<Napi::Number>().DoubleValue())) {
+      return false;
+    }
+    value = jsValue.As<Napi::Number>().DoubleValue();
+    return true;
+  };
+
+  double fromX = 0, fromY = 0, toX = 0, toY = 0, steps = 0;
+  motion.durationMs = -1;
+  if (
+    !readNumber("fromX", fromX) || !readNumber("fromY", fromY)
+    || !readNumber("toX", toX) || !readNumber("toY", toY)
+    || !readNumber("duration", motion.durationMs) || motion.durationMs < 0
+  ) {
+    Napi::TypeError::New(env, "Cursor motion \"fromX\", \"fromY\", \"toX\", \"toY\" and \"duration\" must be finite numbers, duration being positive").ThrowAsJavaScriptException();
+    return false;
+  }
+  motion.from = { static_cast<int>(std::lround(fromX)), static_cast<int>(std::lround(fromY)) };
+  motion.to = { static_cast<int>(std::lround(toX)), static_cast<int>(std::lround(toY)) };
+
+  Napi::Value curve = options.Get("motion");
+  std::string curveName = curve.IsString() ? curve.As<Napi::String>().Utf8Value() : "linear";
+  if (curveName == "linear") motion.curve = CursorMotionCurve::Linear;
+  else if (curveName == "arc") motion.curve = CursorMotionCurve::Arc;
+  else if (curveName == "wave") motion.curve = CursorMotionCurve::Wave;
+  else if (curveName == "human") motion.curve = CursorMotionCurve::Human;
+  else {
+    Napi::TypeError::New(env, "Cursor motion must be one of: linear, arc, wave, human").ThrowAsJavaScriptException();
+    return false;
+  }
+
+  if (
+    !readNumber("curviness", motion.curviness) || motion.curviness < 0 || motion.curviness > 1
+    || !readNumber("frequency", motion.frequency) || motion.frequency < 0
+    || !readNumber("jitter", motion.jitter) || motion.jitter < 0
+    || !readNumber("steps", steps) || steps < 0 || steps > 1000000
+  ) {
+    Napi::TypeError::New(env, "Invalid cursor motion options").ThrowAsJavaScriptException();
+    return false;
+  }
+  motion.steps = static_cast<unsigned int>(steps);
+  motion.isMirrored = options.Get("mirror").ToBoolean().Value();
+  return true;
+}
+
+// Move the cursor along a smooth path, one position per monitor refresh by
+// default. Positions are sent by the input sequencer on precise deadlines.
+Napi::Value MoveCursorSmoothlyWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected cursor motion options").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  CursorMotion motion;
+  if (!ParseCursorMotion(env, info[0].As<Napi::Object>(), motion)) {
+    return env.Null();
+  }
+
+  try {
+    double refreshRate = motion.steps > 0 ? 0 : GetRefreshRate(motion.from.x, motion.from.y);
+    return SubmitInputSequence(env, BuildCursorMotionProgram(motion, refreshRate));
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+
+// =============================================================================
+// ============================ KEYBOARD FUNCTIONS =============================
+// =============================================================================
+
+void KeyPressDown(int rawKeySym) {
+  Display* inputDisplay = GetInputDisplay();
+
+  KeyCode keyCode = XKeysymToKeycode(inputDisplay, static_cast<KeySym>(rawKeySym));
+  if (keyCode == 0) {
+    throw std::runtime_error("Invalid key symbol.");
+  }
+
+  XTestFakeKeyEvent(inputDisplay, keyCode, True, CurrentTime);
+  XFlush(inputDisplay);
+}
+
+Napi::Value KeyPressDownWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate argument
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected key symbol (integer)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int rawKeySym = info[0].As<Napi::Number>().Int32Value();
+
+  try {
+    KeyPressDown(rawKeySym);
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+void KeyPressUp(int rawKeySym) {
+  Display* inputDisplay = GetInputDisplay();
+
+  KeyCode keyCode = XKeysymToKeycode(inputDisplay, static_cast<KeySym>(rawKeySym));
+  if (keyCode == 0) {
+    throw std::runtime_error("Invalid key symbol.");
+  }
+
+  XTestFakeKeyEvent(inputDisplay, keyCode, False, CurrentTime);
+  XFlush(inputDisplay);
+}
+
+Napi::Value KeyPressUpWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate argument
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected key symbol (integer)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int rawKeySym = info[0].As<Napi::Number>().Int32Value();
+
+  try {
+    KeyPressUp(rawKeySym);
+    return env.Undefined();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Type a text on the sequencer thread (see InputSequencer::type), waiting the
+// interval before each character. The returned promise resolves once the text
+// has been typed.
+Napi::Value TypeTextWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a text as a string argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "Expected an interval in microseconds (number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int64_t interval = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().Int64Value() : 0;
+  if (interval < 0) {
+    Napi::RangeError::New(env, "Interval must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Decode the code points, lone surrogates become replacement characters
+  std::u16string utf16Text = info[0].As<Napi::String>().Utf16Value();
+  std::u32string text;
+  text.reserve(utf16Text.size());
+  for (size_t i = 0; i < utf16Text.size(); i++) {
+    char32_t character = utf16Text[i];
+    if (character >= 0xD800 && character <= 0xDBFF && i + 1 < utf16Text.size() && utf16Text[i + 1] >= 0xDC00 && utf16Text[i + 1] <= 0xDFFF) {
+      character = 0x10000 + ((character - 0xD800) << 10) + (utf16Text[++i] - 0xDC00);
+    }
+    else if (character >= 0xD800 && character <= 0xDFFF) {
+      character = 0xFFFD;
+    }
+    text.push_back(character);
+  }
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  if (text.empty()) {
+    deferred.Resolve(env.Undefined());
+    return deferred.Promise();
+  }
+  inputSequencer.submitText(std::move(text), std::chrono::microseconds(interval), SettleInputSequence(env, deferred));
+  return deferred.Promise();
+}
+
+// =============================================================================
+// ========================= INPUT SEQUENCE FUNCTIONS ==========================
+// =============================================================================
+
+// Copy an input sequence program (see InputSequenceOpcode) after validating it
+bool ParseInputSequence(Napi::Env env, Napi::Value value, std::vector<int32_t>& program) {
+  if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_int32_array) {
+    Napi::TypeError::New(env, "Expected an Int32Array input sequence").ThrowAsJavaScriptException();
+    return false;
+  }
+  Napi::Int32Array records = value.As<Napi::Int32Array>();
+  if (records.ElementLength() % INPUT_SEQUENCE_RECORD_SIZE != 0) {
+    Napi::TypeError::New(env, "Input sequence length must be a multiple of " + std::to_string(INPUT_SEQUENCE_RECORD_SIZE)).ThrowAsJavaScriptException();
+    return false;
+  }
+  program.assign(records.Data(), records.Data() + records.ElementLength());
+  for (size_t i = 0; i < program.size(); i += INPUT_SEQUENCE_RECORD_SIZE) {
+    int32_t opcode = program[i];
+    int32_t argument = program[i + 1];
+    bool isButton = opcode == static_cast<int32_t>(InputSequenceOpcode::ButtonDown) || opcode == static_cast<int32_t>(InputSequenceOpcode::ButtonUp);
+    bool isValid = (
+      opcode >= static_cast<int32_t>(InputSequenceOpcode::Move)
+      && opcode <= static_cast<int32_t>(InputSequenceOpcode::KeyUp)
+      && (!isButton || (argument >= 1 && argument <= 5))
+      && program[i + 3] >= 0
+    );
+    if (!isValid) {
+      Napi::TypeError::New(env, "Invalid input sequence event at index " + std::to_string(i / INPUT_SEQUENCE_RECORD_SIZE)).ThrowAsJavaScriptException();
+      return false;
+    }
+  }
+  return true;
+}
+
+// Send an input sequence program on the sequencer thread. The returned promise
+// resolves once every event has been sent.
+Napi::Value SendInputSequenceWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1) {
+    Napi::TypeError::New(env, "Expected an Int32Array input sequence").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::vector<int32_t> program;
+  if (!ParseInputSequence(env, info[0], program)) {
+    return env.Null();
+  }
+
+  return SubmitInputSequence(env, std::move(program));
+}
+
+
+// =============================================================================
+// ============================= HOOK PROCEDURES ===============================
+// =============================================================================
+
+Napi::Object BuildInputEventObject(const Napi::Env& env, const RawInputEvent& event) {
+  if (!inputEventObjectBuilder) {
+    inputEventObjectBuilder = std::make_unique<InputEventObjectBuilder>(env);
+  }
+  return inputEventObjectBuilder->build(env, event);
+}
+
+// Whether input events are currently batched (see setInputEventBatching)
+bool IsInputEventBatchingEnabled() {
+  return inputEventBatchInterval.load() > 0 || inputEventBatchSize.load() > 0;
+}
+
+// Send the batched input events to JavaScript as one Float64Array
+void DeliverInputEventBatch(InputEventBatch& batch) {
+  inputEventThreadSafeJsFunction.BlockingCall([records = batch.take()](const Napi::Env& env, const Napi::Function& jsCallback) {
+    if (!jsCallback.IsEmpty()) {
+      Napi::Float64Array array = Napi::Float64Array::New(env, records.size());
+      std::copy(records.begin(), records.end(), array.Data());
+      jsCallback.Call({ array });
+    }
+  });
+}
+
+// Send an input event to JavaScript, either right away or with the next batch
+void DispatchInputEvent(const RawInputEvent& rawInputEvent, InputEventBatch& batch) {
+  // Rings get every event, whatever the batching
+  {
+    std::lock_guard<std::mutex> lock(inputEventRingsMutex);
+    for (auto& [id, handle] : inputEventRings) {
+      handle.ring->push(rawInputEvent);
+    }
+  }
+
+  // Native recorders too, each keeping the events it was asked for
+  {
+    std::lock_guard<std::mutex> lock(inputRecordersMutex);
+    for (auto& [id, recorder] : inputRecorders) {
+      recorder->record(rawInputEvent);
+    }
+  }
+
+  // Hotkeys see every keyboard event, whatever the filter
+  if (rawInputEvent.type == InputEventType::Keyboard) {
+    // Held keys are only looked up for stale ones, once per event at most: from
+    // the input state tracker when active, else from the server. The keyboard
+    // group is the one this listener keeps track of.
+    std::optional<std::array<uint64_t, 4>> heldKeys;
+    std::lock_guard<std::mutex> lock(hotkeysMutex);
+    hotkeyMatcher.process(rawInputEvent, [&heldKeys](int keySym) {
+      if (!heldKeys) {
+        heldKeys = IsInputStateTracked() ? inputStateTracker.keys() : InputStateTracker::queryKeys(GetInputDisplay());
+      }
+      return InputStateTracker::isKeyPressed(GetInputDisplay(), static_cast<KeySym>(keySym), heldKeys.value(), inputStateTracker.keyboardGroup());
+    });
+  }
+
+  // Nobody subscribed to this event
+  if (!std::atomic_load(&inputEventFilter)->accepts(EncodeInputEvent(rawInputEvent))) {
+    return;
+  }
+
+  if (!IsInputEventBatchingEnabled()) {
+    // Batching was just disabled: deliver the remaining events first
+    if (!batch.empty()) {
+      DeliverInputEventBatch(batch);
+    }
+    inputEventThreadSafeJsFunction.BlockingCall([rawInputEvent](const Napi::Env& env, const Napi::Function& jsCallback) {
+      if (!jsCallback.IsEmpty()) {
+        jsCallback.Call({ BuildInputEventObject(env, rawInputEvent) });
+      }
+    });
+    return;
+  }
+  batch.add(rawInputEvent, inputEventMotionCoalescing.load());
+  uint32_t batchSize = inputEventBatchSize.load();
+  if (batchSize > 0 && batch.size() >= batchSize) {
+    DeliverInputEventBatch(batch);
+  }
+}
+
+// When the given batch is due, batches without interval being delivered as
+// soon as no more events are pending
+std::chrono::steady_clock::time_point GetInputEventBatchDeadline(const InputEventBatch& batch) {
+  return batch.startedAt() + std::chrono::milliseconds(inputEventBatchInterval.load());
+}
+
+// Select the XInput2 events needed by the input event filter, so the X server
+// doesn't send the others at all. Rings, native recorders and the input state
+// tracker get every event, hotkeys every keyboard event. Must be called with inputEventHookMutex locked.
+void SelectInputEvents(Display* inputDisplay, Window rootWindow) {
+  std::shared_ptr<const InputEventFilter> filter = std::atomic_load(&inputEventFilter);
+  bool isEverythingSelected;
+  {
+    std::lock_guard<std::mutex> lock(inputEventRingsMutex);
+    isEverythingSelected = !inputEventRings.empty();
+  }
+  {
+    std::lock_guard<std::mutex> lock(inputRecordersMutex);
+    isEverythingSelected = isEverythingSelected || !inputRecorders.empty();
+  }
+  isEverythingSelected = isEverythingSelected || inputStateTracker.isEnabled();
+  bool hasHotkeys;
+  {
+    std::lock_guard<std::mutex> lock(hotkeysMutex);
+    hasHotkeys = !hotkeyMatcher.empty();
+  }
+
+  XIEventMask eventMask;
+  unsigned char eventMaskData[(XI_LASTEVENT + 7) / 8];
+
+  std::memset(eventMaskData, 0, sizeof(eventMaskData));
+
+  eventMask.deviceid = XIAllDevices;
+  eventMask.mask_len = sizeof(eventMaskData);
+  eventMask.mask = eventMaskData;
+
+  // Keyboard
+  if (isEverythingSelected || hasHotkeys || filter->isKeyboardEnabled) {
+    XISetMask(eventMask.mask, XI_RawKeyPress);
+    XISetMask(eventMask.mask, XI_RawKeyRelease);
+  }
+
+  // Mouse
+  if (isEverythingSelected || filter->isMouseEnabled) {
+    XISetMask(eventMask.mask, XI_RawButtonPress);
+    XISetMask(eventMask.mask, XI_RawButtonRelease);
+  }
+  bool isMotionSelected = isEverythingSelected || filter->isMotionEnabled;
+  if (isMotionSelected) {
     XISetMask(eventMask.mask, XI_RawMotion);
+  }
+
+  // Devices added or removed, to keep XTEST device IDs up to date
+  XISetMask(eventMask.mask, XI_HierarchyChanged);
+
+  XISelectEvents(inputDisplay, rootWindow, &eventMask, 1);
+  inputEventMotionSelected = isMotionSelected;
+  inputEventSelectionChanged = true;
+}
+
+// Update the XInput2 event selection of a running input event listener
+void UpdateInputEventSelection() {
+  std::lock_guard<std::mutex> lock(inputEventHookMutex);
+  if (!inputEventSelected) {
+    return;
+  }
+  Display* inputDisplay = GetInputDisplay();
+  SelectInputEvents(inputDisplay, DefaultRootWindow(inputDisplay));
+  XFlush(inputDisplay);
+}
+
+void InputEventProcessingThread() {
+  // Initialize XInput2 listener
+  Display* inputDisplay = GetInputDisplay();
+  Window rootWindow = DefaultRootWindow(inputDisplay);
+  int opcode, event, error;
+  int xkbOpcode, xkbEventBase, xkbError;
+  // State tracked from events rather than queried per event
+  int keyboardGroup = 0;
+  XTestDeviceIds xTestDeviceIds;
+  std::optional<Position> cursorPosition = std::nullopt;
+  // Whether the tracked cursor position predates the last motion events
+  bool isTrackedCursorStale = false;
+  auto trackedCursorQueriedAt = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(inputEventHookMutex);
+    if (!XQueryExtension(inputDisplay, "XInputExtension", &opcode, &event, &error)) {
+      throw std::runtime_error("XInputExtension is not available.");
+    }
+
+    int majorVersion = 2, minorVersion = 0;
+    int status = XIQueryVersion(inputDisplay, &majorVersion, &minorVersion);
+    if (status != Success) {
+      throw std::runtime_error("XInputExtension 2.0 is not available. Server supports version " + std::to_string(majorVersion) + "." + std::to_string(minorVersion));
+    }
+
+    // Listen to input events
+    SelectInputEvents(inputDisplay, rootWindow);
+    inputEventSelected = true;
+    // Listen to keyboard group changes, instead of querying the group per key
+    int xkbMajorVersion = XkbMajorVersion, xkbMinorVersion = XkbMinorVersion;
+    if (XkbQueryExtension(inputDisplay, &xkbOpcode, &xkbEventBase, &xkbError, &xkbMajorVersion, &xkbMinorVersion)) {
+      XkbSelectEventDetails(inputDisplay, XkbUseCoreKbd, XkbStateNotify, XkbGroupStateMask, XkbGroupStateMask);
+    }
+    else {
+      xkbEventBase = -1;
+    }
+    XkbStateRec xkbState;
+    if (XkbGetState(inputDisplay, XkbUseCoreKbd, &xkbState) == Success) {
+      keyboardGroup = xkbState.group;
+    }
+    xTestDeviceIds = GetXTestDeviceIds();
+    if (inputStateTracker.isEnabled()) {
+      inputStateTracker.seed(inputDisplay);
+    }
+    // Listen to window property changes (only used to receive our dummyEvent, see CleanInputEventListener)
+    XSelectInput(inputDisplay, rootWindow, PropertyChangeMask);
+    XFlush(inputDisplay);
+  }
+
+  // Declare useful variables
+
+  // Mouse buttons map from X11 button number to Actionify button
+  auto getMouseButtonInput = [](int button) {
+    switch (button) {
+      case 1: return MouseInputCode::Left;
+      case 2: return MouseInputCode::Middle;
+      case 3: return MouseInputCode::Right;
+      case 4: return MouseInputCode::Wheel; // wheel up
+      case 5: return MouseInputCode::Wheel; // wheel down
+      case 8: return MouseInputCode::ExtraButton1;
+      case 9: return MouseInputCode::ExtraButton2;
+      default: return MouseInputCode::Unknown;
+    }
+  };
+
+  // Events already delivered, used to avoid duplicate events
+  InputEventDeduplicator inputEventDeduplicator;
+
+  // Events waiting to be delivered, when batching
+  InputEventBatch inputEventBatch;
+
+  // Run input event processing loop
+  inputEventRunning = true;
+  inputEventHookCondition.notify_all();
+  while (inputEventRunning) {
+    if (!inputEventBatch.empty()) {
+      const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(GetInputEventBatchDeadline(inputEventBatch) - std::chrono::steady_clock::now());
+      if (XPending(inputDisplay) == 0) {
+        // Wait for the next event until the batch is due
+        pollfd connection = { ConnectionNumber(inputDisplay), POLLIN, 0 };
+        if (remaining.count() <= 0 || poll(&connection, 1, static_cast<int>(remaining.count())) == 0) {
+          DeliverInputEventBatch(inputEventBatch);
+        }
+        continue;
+      }
+      if (remaining.count() <= 0 && inputEventBatchInterval.load() > 0) {
+        // Deliver on time even when events keep coming
+        DeliverInputEventBatch(inputEventBatch);
+      }
+    }
+
+    XEvent event;
+    XNextEvent(inputDisplay, &event);
+
+    if (!inputEventRunning) {
+      // Event processing thread has been stopped while waiting for an event
+      // see CleanInputEventListener()
+      break;
+    }
+
+    if (event.type == xkbEventBase) {
+      // Keyboard group changed
+      XkbEvent* xkbEvent = reinterpret_cast<XkbEvent*>(&event);
+      if (xkbEvent->any.xkb_type == XkbStateNotify) {
+        keyboardGroup = xkbEvent->state.group;
+        inputStateTracker.setKeyboardGroup(keyboardGroup);
+      }
+      continue;
+    }
+    if (
+      event.xcookie.type != GenericEvent ||
+      event.xcookie.extension != opcode
+    ) {
+      // Ignore non-XInput events
+      continue;
+    }
+    if (!XGetEventData(inputDisplay, &event.xcookie)) {
+      // Ignore XInput events without data
+      continue;
+    }
+    if (event.xcookie.evtype == XI_HierarchyChanged) {
+      // XTEST devices may have been added or removed
+      xTestDeviceIds = GetXTestDeviceIds();
+      XFreeEventData(inputDisplay, &event.xcookie);
+      continue;
+    }
+
+    // The cursor position is only tracked while raw motion events tell when it moves
+    if (inputEventSelectionChanged.exchange(false) || !inputEventMotionSelected.load()) {
+      cursorPosition = std::nullopt;
+    }
+
+    XIRawEvent* inputEvent = static_cast<XIRawEvent*>(event.xcookie.data);
+    std::optional<Position> maybeMousePosition = GetMouseEventPosition(*inputEvent);
+    std::optional<Position> maybeMouseWheelScrollAmount = GetMouseWheelEventScrollAmount(*inputEvent);
+    InputEventDeduplicator::Key eventKey = {
+      inputEvent->sourceid,
+      event.xcookie.evtype,
+      inputEvent->detail,
+      maybeMousePosition.value_or(Position{0, 0}),
+      maybeMouseWheelScrollAmount.value_or(Position{0, 0}),
+    };
+
+    if (inputEventDeduplicator.isDuplicate(eventKey, inputEvent->time)) {
+      // Ignore duplicate events
+      XFreeEventData(inputDisplay, &event.xcookie);
+      continue;
+    }
+
+    // Determine if the input event was injected via XSendEvent or XTestFakeKey/XTestFakeButton/XTestFakeMotion
+    bool isInputEventInjected = (
+      event.xany.send_event
+      || (xTestDeviceIds.keyboard.has_value() && inputEvent->deviceid == xTestDeviceIds.keyboard.value())
+      || (xTestDeviceIds.mouse.has_value() && inputEvent->deviceid == xTestDeviceIds.mouse.value())
+    );
+
+    // Lock-free view of the suppressed inputs, replaced as a whole on change
+    std::shared_ptr<const InputSuppressionTable> suppressionTable = std::atomic_load(&inputSuppressionTable);
+    std::optional<RawInputEvent> maybeRawInputEvent = std::nullopt;
+    switch (event.xcookie.evtype) {
+      case XI_RawKeyPress: {
+        inputStateTracker.setKeyPressed(inputEvent->detail, true);
+        KeySym inputEventKeySym = XkbKeycodeToKeysym(inputDisplay, inputEvent->detail, keyboardGroup, 0);
+        bool isInputGrabbed = suppressionTable->isKeyboardSuppressed(inputEventKeySym);
+        // 0 = down, 1 = up, 2 = neutral
+        bool isInputEventSuppressed = isInputGrabbed && suppressionTable->isKeyboardSuppressed(inputEventKeySym, 0);
+        if (isInputGrabbed && !isInputEventSuppressed) {
+          // We grabbed the key but the user didn't suppress it for this state
+          // X11 doesn't allow to suppress specific states reliably
+          // Thus, we leave it suppressed and consider it suppressed by user
+          isInputEventSuppressed = true;
+        }
+        maybeRawInputEvent = {
+          InputEventType::Keyboard,
+          static_cast<int>(inputEventKeySym),
+          InputEventState::Down,
+          0,
+          0,
+          Now(),
+          isInputEventSuppressed,
+          isInputEventInjected
+        };
+        break;
+      }
+      case XI_RawKeyRelease: {
+        inputStateTracker.setKeyPressed(inputEvent->detail, false);
+        KeySym inputEventKeySym = XkbKeycodeToKeysym(inputDisplay, inputEvent->detail, keyboardGroup, 0);
+        bool isInputGrabbed = suppressionTable->isKeyboardSuppressed(inputEventKeySym);
+        // 0 = down, 1 = up, 2 = neutral
+        bool isInputEventSuppressed = isInputGrabbed && suppressionTable->isKeyboardSuppressed(inputEventKeySym, 1);
+        if (isInputGrabbed && !isInputEventSuppressed) {
+          // We grabbed the key but the user didn't suppress it for this state
+          // X11 doesn't allow to suppress specific states reliably
+          // Thus, we leave it suppressed and consider it suppressed by user
+          isInputEventSuppressed = true;
+        }
+        maybeRawInputEvent = {
+          InputEventType::Keyboard,
+          static_cast<int>(inputEventKeySym),
+          InputEventState::Up,
+          0,
+          0,
+          Now(),
+          isInputEventSuppressed,
+          isInputEventInjected
+        };
+        break;
+      }
+      case XI_RawButtonPress: {
+        if (inputEvent->detail != 4 && inputEvent->detail != 5) {
+          inputStateTracker.setButtonPressed(inputEvent->detail, true);
+        }
+        if (!cursorPosition) {
+          try {
+            cursorPosition = QueryCursorPos();
+          }
+          catch (const std::exception& e) {
+            std::cerr << "Failed to get cursor position: " << e.what() << std::endl;
+          }
+        }
+        Position currentMousePosition = cursorPosition.value_or(Position{0, 0});
+        bool isInputGrabbed = suppressionTable->isMouseSuppressed(inputEvent->detail);
+        // 0 = down, 1 = up, 2 = neutral
+        bool isInputEventSuppressed = isInputGrabbed && suppressionTable->isMouseSuppressed(inputEvent->detail, 0);
+        if (isInputGrabbed && !isInputEventSuppressed) {
+          // We grabbed the mouse button but the user didn't suppress it for this state
+          // X11 doesn't allow to suppress specific states reliably
+          // Thus, we leave it suppressed and consider it suppressed by user
+          isInputEventSuppressed = true;
+        }
+        maybeRawInputEvent = {
+          InputEventType::Mouse,
+          static_cast<int>(getMouseButtonInput(inputEvent->detail)),
+          inputEvent->detail != 4 ? InputEventState::Down : InputEventState::Up,
+          currentMousePosition.x,
+          currentMousePosition.y,
+          Now(),
+          isInputEventSuppressed,
+          isInputEventInjected
+        };
+        break;
+      }
+      case XI_RawButtonRelease: {
+        if (inputEvent->detail == 4 || inputEvent->detail == 5) {
+          // Ignore scroll wheel release events to match Windows behavior
+          break;
+        }
+        inputStateTracker.setButtonPressed(inputEvent->detail, false);
+        if (!cursorPosition) {
+          try {
+            cursorPosition = QueryCursorPos();
+          }
+          catch (const std::exception& e) {
+            std::cerr << "Failed to get cursor position: " << e.what() << std::endl;
+          }
+        }
+        Position currentMousePosition = cursorPosition.value_or(Position{0, 0});
+        bool isInputGrabbed = suppressionTable->isMouseSuppressed(inputEvent->detail);
+        // 0 = down, 1 = up, 2 = neutral
+        bool isInputEventSuppressed = isInputGrabbed && suppressionTable->isMouseSuppressed(inputEvent->detail, 1);
+        if (isInputGrabbed && !isInputEventSuppressed) {
+          // We grabbed the mouse button but the user didn't suppress it for this state
+          // X11 doesn't allow to suppress specific states reliably
+          // Thus, we leave it suppressed and consider it suppressed by user
+          isInputEventSuppressed = true;
+        }
+        maybeRawInputEvent = {
+          InputEventType::Mouse,
+          static_cast<int>(getMouseButtonInput(inputEvent->detail)),
+          inputEvent->detail != 5 ? InputEventState::Up : InputEventState::Down,
+          currentMousePosition.x,
+          currentMousePosition.y,
+          Now(),
+          isInputEventSuppressed,
+          isInputEventInjected
+        };
+        break;
+      }
+      case XI_RawMotion: {
+        if (maybeMousePosition) {
+          // The cursor moved: query its position again on the next button event
+          cursorPosition = std::nullopt;
+          isTrackedCursorStale = inputStateTracker.isEnabled();
+          bool isInputEventGrabbedAndSuppressed = suppressionTable->isMouseSuppressed(inputEvent->detail);
+          maybeRawInputEvent = {
+            InputEventType::Mouse,
+            static_cast<int>(MouseInputCode::Move),
+            InputEventState::Neutral,
+            maybeMousePosition->x,
+            maybeMousePosition->y,
+            Now(),
+            isInputEventGrabbedAndSuppressed,
+            isInputEventInjected
+          };
+        }
+        if (maybeMouseWheelScrollAmount) {
+          // X11 send XI_RawMotion for each mouse wheel event
+          // if Scroll Y == -1, then it's scroll up and XI_RawButtonPress & XI_RawButtonRelease will be fired
+          // if Scroll Y == 1, then it's scroll down and XI_RawButtonPress & XI_RawButtonRelease will be fired
+          // if Scroll Y == 0, then scroll direction has changed (scroll up to scroll down or scroll down to scroll up).
+          //                   No XI_RawButtonPress & XI_RawButtonRelease will be fired
+          //                   We can ignore this event to comply with X11 behavior
+        }
+        break;
+      }
+      default:
+        // Ignore other events. It shouldn't happen as we only listen to the
+        // specific events above (see XISetMask).
+        break;
+    }
 
-    // Listen to input events
+    // Send input event to JavaScript
+    if (maybeRawInputEvent) {
+      DispatchInputEvent(maybeRawInputEvent.value(), inputEventBatch);
+      inputEventDeduplicator.remember(eventKey);
+    }
+
+    // Query the cursor position once the pending motion events are processed,
+    // or every 10 ms while they keep coming
+    const auto now = std::chrono::steady_clock::now();
+    if (isTrackedCursorStale && (XPending(inputDisplay) == 0 || now - trackedCursorQueriedAt >= std::chrono::milliseconds(10))) {
+      try {
+        cursorPosition = QueryCursorPos();
+        inputStateTracker.setCursor(cursorPosition.value());
+      }
+      catch (const std::exception& e) {
+        std::cerr << "Failed to get cursor position: " << e.what() << std::endl;
+      }
+      isTrackedCursorStale = false;
+      trackedCursorQueriedAt = now;
+    }
+
+    // Free X11 event
+    XFreeEventData(inputDisplay, &event.xcookie);
+  }
+
+  // Deliver the last, partially filled batch before the callback goes away
+  if (!inputEventBatch.empty()) {
+    DeliverInputEventBatch(inputEventBatch);
+  }
+
+  // Unregister all previously selected XInput2 events.
+  // Passing an empty mask removes our raw input event subscription
+  // from the root window
+  {
+    std::lock_guard<std::mutex> lock(inputEventHookMutex);
+    inputEventSelected = false;
+
+    XIEventMask eventMask;
+    unsigned char eventMaskData[(XI_LASTEVENT + 7) / 8];
+    std::memset(eventMaskData, 0, sizeof(eventMaskData));
+
+    eventMask.deviceid = XIAllDevices;
+    eventMask.mask_len = sizeof(eventMaskData);
+    eventMask.mask = eventMaskData;
+
+    // Unregister all previously selected XInput2 events
     XISelectEvents(inputDisplay, rootWindow, &eventMask, 1);
-    // Listen to window property changes (only used to receive our dummyEvent, see CleanInputEventListener)
-    XSelectInput(inputDisplay, rootWindow, PropertyChangeMask);
+    // Unregister all previously selected X11 events
+    XSelectInput(inputDisplay, rootWindow, NoEventMask);
+    if (xkbEventBase != -1) {
+      XkbSelectEventDetails(inputDisplay, XkbUseCoreKbd, XkbStateNotify, XkbGroupStateMask, 0);
+    }
+
     XFlush(inputDisplay);
   }
+}
+
+Napi::Value StartInputEventListener(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Skip if already listening
+  if (inputEventRunning) {
+    return Napi::Boolean::New(env, true);
+  }
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsFunction()) {
+    Napi::TypeError::New(env, "Expected a callback function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Convert JS callback to a NAPI ThreadSafeFunction
+  inputEventThreadSafeJsFunction = Napi::ThreadSafeFunction::New(
+    env, // the main NAPI environment
+    info[0].As<Napi::Function>(), // callback function that needs to be called in thread(s)
+    "callback", // JS string used to provide diagnostic information
+    0, // maximum queue size (0 for unlimited)
+    1, // initial number of threads which will be making use of this function
+    [](const Napi::Env& env) { // finalizer callback, can be used to clean threads up
+    }
+  );
+
+  // Start event processing thread
+  inputEventThread = std::thread(InputEventProcessingThread);
+  {
+    std::unique_lock<std::mutex> lock(inputEventHookMutex);
+    inputEventHookCondition.wait(lock, [] { return inputEventRunning.load(); });
+  }
+  return Napi::Boolean::New(env, true);
+}
+
+Napi::Value StopInputEventListener(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  try {
+    CleanInputEventListener();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Boolean::New(env, true);
+}
+
+// Function to batch the input events sent to the input event listener
+Napi::Value SetInputEventBatching(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected an options object").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  Napi::Value interval = options.Get("interval");
+  Napi::Value size = options.Get("size");
+  Napi::Value coalesceMotion = options.Get("coalesceMotion");
+  if (
+    (!interval.IsUndefined() && (!interval.IsNumber() || !(interval.As<Napi::Number>().DoubleValue() >= 0) || interval.As<Napi::Number>().DoubleValue() > 60000))
+    || (!size.IsUndefined() && (!size.IsNumber() || !(size.As<Napi::Number>().DoubleValue() >= 0) || size.As<Napi::Number>().DoubleValue() > 1000000))
+  ) {
+    Napi::RangeError::New(env, "Expected an interval between 0 and 60000 ms and a size between 0 and 1000000 events").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  inputEventBatchInterval = interval.IsUndefined() ? 0 : interval.As<Napi::Number>().Uint32Value();
+  inputEventBatchSize = size.IsUndefined() ? 0 : size.As<Napi::Number>().Uint32Value();
+  inputEventMotionCoalescing = coalesceMotion.IsBoolean() && coalesceMotion.As<Napi::Boolean>().Value();
+
+  return env.Undefined();
+}
+
+// Function to restrict the input events sent to the input event listener
+Napi::Value SetInputEventFilter(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected a filter object").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  auto filter = std::make_shared<InputEventFilter>();
+  auto readFlag = [&options](const char* name, bool& flag) {
+    Napi::Value value = options.Get(name);
+    if (value.IsBoolean()) {
+      flag = value.As<Napi::Boolean>().Value();
+    }
+  };
+  readFlag("keyboard", filter->isKeyboardEnabled);
+  readFlag("mouse", filter->isMouseEnabled);
+  readFlag("motion", filter->isMotionEnabled);
+  readFlag("injected", filter->isInjectedEnabled);
+  readFlag("physical", filter->isPhysicalEnabled);
+  auto readInputs = [&options, &env](const char* name, std::set<int32_t>& inputs) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) {
+      return true;
+    }
+    if (!value.IsArray()) {
+      Napi::TypeError::New(env, std::string("Expected ") + name + " to be an array of numbers").ThrowAsJavaScriptException();
+      return false;
+    }
+    Napi::Array array = value.As<Napi::Array>();
+    for (uint32_t i = 0; i < array.Length(); i++) {
+      Napi::Value input = array.Get(i);
+      if (!input.IsNumber()) {
+        Napi::TypeError::New(env, std::string("Expected ") + name + " to be an array of numbers").ThrowAsJavaScriptException();
+        return false;
+      }
+      inputs.insert(input.As<Napi::Number>().Int32Value());
+    }
+    return true;
+  };
+  if (!readInputs("keys", filter->keys) || !readInputs("mouseInputs", filter->mouseInputs)) {
+    return env.Null();
+  }
+  // An empty set would accept everything: subscribing to no input at all
+  // disables the type instead
+  if (options.Get("keys").IsArray() && filter->keys.empty()) {
+    filter->isKeyboardEnabled = false;
+  }
+  if (options.Get("mouseInputs").IsArray() && filter->mouseInputs.empty()) {
+    filter->isMouseEnabled = false;
+  }
+
+  std::atomic_store(&inputEventFilter, std::shared_ptr<const InputEventFilter>(filter));
+  UpdateInputEventSelection();
+
+  return env.Undefined();
+}
+
+// Function to register a hotkey, matched natively on the input listener thread
+Napi::Value RegisterHotkeyWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 3 || !info[0].IsArray() || !info[1].IsObject() || !info[2].IsFunction()) {
+    Napi::TypeError::New(env, "Arguments must be: (sequence, options, callback)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Sequence of chords, chords of keys, keys of alternative key codes
+  HotkeyMatcher::Hotkey hotkey;
+  Napi::Array sequence = info[0].As<Napi::Array>();
+  for (uint32_t chordIndex = 0; chordIndex < sequence.Length(); chordIndex++) {
+    Napi::Value chordValue = sequence.Get(chordIndex);
+    if (!chordValue.IsArray() || chordValue.As<Napi::Array>().Length() == 0) {
+      Napi::TypeError::New(env, "Expected each chord to be a non-empty array of keys").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    Napi::Array chordArray = chordValue.As<Napi::Array>();
+    HotkeyMatcher::Chord chord;
+    for (uint32_t keyIndex = 0; keyIndex < chordArray.Length(); keyIndex++) {
+      Napi::Value keyValue = chordArray.Get(keyIndex);
+      if (!keyValue.IsArray() || keyValue.As<Napi::Array>().Length() == 0) {
+        Napi::TypeError::New(env, "Expected each key to be a non-empty array of key codes").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      Napi::Array keyArray = keyValue.As<Napi::Array>();
+      std::vector<int> keyCodes;
+      for (uint32_t codeIndex = 0; codeIndex < keyArray.Length(); codeIndex++) {
+        Napi::Value keyCode = keyArray.Get(codeIndex);
+        if (!keyCode.IsNumber()) {
+          Napi::TypeError::New(env, "Expected each key to be a non-empty array of key codes").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        keyCodes.push_back(keyCode.As<Napi::Number>().Int32Value());
+      }
+      chord.push_back(std::move(keyCodes));
+    }
+    hotkey.sequence.push_back(std::move(chord));
+  }
+  if (hotkey.sequence.empty()) {
+    Napi::TypeError::New(env, "Expected a non-empty sequence of chords").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object options = info[1].As<Napi::Object>();
+  double timeout = options.Get("timeout").IsNumber() ? options.Get("timeout").As<Napi::Number>().DoubleValue() : 300;
+  if (!(timeout >= 0 && timeout <= 60000)) {
+    Napi::RangeError::New(env, "Timeout must be between 0 and 60000 ms").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  hotkey.timeout = static_cast<uint64_t>(timeout);
+  hotkey.isInjectedIgnored = options.Get("ignoreInjected").IsBoolean() && options.Get("ignoreInjected").As<Napi::Boolean>().Value();
+
+  Napi::ThreadSafeFunction onMatch = Napi::ThreadSafeFunction::New(
+    env,
+    info[2].As<Napi::Function>(),
+    "hotkey",
+    0,
+    1
+  );
+  hotkey.onMatch = [onMatch](uint64_t timestamp) {
+    onMatch.NonBlockingCall([timestamp](const Napi::Env& env, const Napi::Function& jsCallback) {
+      if (!jsCallback.IsEmpty()) {
+        jsCallback.Call({ Napi::Number::New(env, static_cast<double>(timestamp)) });
+      }
+    });
+  };
+
+  int hotkeyId;
+  {
+    std::lock_guard<std::mutex> lock(hotkeysMutex);
+    hotkeyId = nextHotkeyId++;
+    hotkeyMatcher.add(hotkeyId, std::move(hotkey));
+    hotkeyThreadSafeJsFunctions.emplace(hotkeyId, onMatch);
+  }
+  UpdateInputEventSelection();
+  return Napi::Number::New(env, hotkeyId);
+}
+
+// Function to unregister a hotkey
+Napi::Value UnregisterHotkeyWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a hotkey ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int hotkeyId = info[0].As<Napi::Number>().Int32Value();
+
+  Napi::ThreadSafeFunction onMatch;
+  {
+    // Once removed, the input listener thread no longer calls it back
+    std::lock_guard<std::mutex> lock(hotkeysMutex);
+    auto it = hotkeyThreadSafeJsFunctions.find(hotkeyId);
+    if (it == hotkeyThreadSafeJsFunctions.end()) {
+      return env.Undefined();
+    }
+    onMatch = it->second;
+    hotkeyThreadSafeJsFunctions.erase(it);
+    hotkeyMatcher.remove(hotkeyId);
+  }
+  onMatch.Release();
+  UpdateInputEventSelection();
+  return env.Undefined();
+}
+
+// Function to start writing input events into a ring in shared memory
+Napi::Value StartInputEventRingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+    Napi::TypeError::New(env, "Arguments must be: (options, waiting callback)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  double requestedCapacity = options.Get("capacity").IsNumber() ? options.Get("capacity").As<Napi::Number>().DoubleValue() : 4096;
+  if (!(requestedCapacity >= 2 && requestedCapacity <= (1 << 24))) {
+    Napi::RangeError::New(env, "Capacity must be between 2 and 16777216 events").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  // Round the capacity up to a power of 2
+  uint32_t capacity = 2;
+  while (capacity < requestedCapacity) {
+    capacity <<= 1;
+  }
+
+  // Events are written straight into a SharedArrayBuffer, kept alive by a reference
+  size_t memorySize = InputEventRing::requiredMemorySize(capacity);
+  Napi::Object sharedBuffer = env.Global().Get("SharedArrayBuffer").As<Napi::Function>().New({ Napi::Number::New(env, static_cast<double>(memorySize)) });
+  Napi::Uint8Array memory = env.Global().Get("Uint8Array").As<Napi::Function>().New({ sharedBuffer }).As<Napi::Uint8Array>();
+
+  // Called when the consumer waits for events, so JS can wake it up with Atomics.notify
+  Napi::ThreadSafeFunction onWaiting = Napi::ThreadSafeFunction::New(
+    env,
+    info[1].As<Napi::Function>(),
+    "inputEventRing",
+    1, // pending notifications are coalesced
+    1
+  );
+  auto ring = std::make_shared<InputEventRing>(
+    memory.Data(),
+    capacity,
+    [onWaiting]() {
+      onWaiting.NonBlockingCall();
+    }
+  );
+
+  int ringId;
+  {
+    std::lock_guard<std::mutex> lock(inputEventRingsMutex);
+    ringId = nextInputEventRingId++;
+    inputEventRings.emplace(ringId, InputEventRingHandle{ ring, onWaiting, Napi::Persistent(memory) });
+  }
+  UpdateInputEventSelection();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("id", Napi::Number::New(env, ringId));
+  result.Set("buffer", sharedBuffer);
+  return result;
+}
+
+// Function to stop writing input events into a ring
+Napi::Value StopInputEventRingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a ring ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int ringId = info[0].As<Napi::Number>().Int32Value();
+
+  InputEventRingHandle handle;
+  {
+    // Once removed, the input listener thread no longer writes to the ring
+    std::lock_guard<std::mutex> lock(inputEventRingsMutex);
+    auto it = inputEventRings.find(ringId);
+    if (it == inputEventRings.end()) {
+      return env.Undefined();
+    }
+    handle = std::move(it->second);
+    inputEventRings.erase(it);
+  }
+  handle.ring->stop();
+  handle.onWaiting.Release();
+  handle.memory.Reset();
+  UpdateInputEventSelection();
+  return env.Undefined();
+}
+
+// Function to start recording input events natively into an input recording file
+Napi::Value StartInputRecordingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected an options object as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  if (!options.Get("filepath").IsString()) {
+    Napi::TypeError::New(env, "Options must contain: filepath").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input to C++ input
+  std::string filepath = options.Get("filepath").As<Napi::String>().Utf8Value();
+  bool isInjectedIgnored = options.Get("ignoreInjected").IsBoolean() && options.Get("ignoreInjected").As<Napi::Boolean>().Value();
+  int compressionLevel = options.Get("compressionLevel").IsNumber() ? options.Get("compressionLevel").As<Napi::Number>().Int32Value() : 3;
+  double blockSize = options.Get("blockSize").IsNumber() ? options.Get("blockSize").As<Napi::Number>().DoubleValue() : 4096;
+  if (!(blockSize >= 1 && blockSize <= INPUT_RECORDING_MAX_BLOCK_SIZE)) {
+    Napi::RangeError::New(env, "Block size must be between 1 and 1048576 events").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  // Actions as [type, input, state] triplets, state being -1 for any state
+  std::vector<InputRecorderAction> actions;
+  if (options.Get("actions").IsArray()) {
+    Napi::Array jsActions = options.Get("actions").As<Napi::Array>();
+    for (unsigned int i = 0; i < jsActions.Length(); i++) {
+      Napi::Value jsRawAction = jsActions[i];
+      if (!jsRawAction.IsArray()) {
+        continue;
+      }
+      Napi::Array jsAction = jsRawAction.As<Napi::Array>();
+      Napi::Value jsType = jsAction[static_cast<unsigned int>(0)];
+      Napi::Value jsInput = jsAction[1];
+      Napi::Value jsState = jsAction[2];
+      if (!jsType.IsNumber() || !jsInput.IsNumber()) {
+        continue;
+      }
+      actions.push_back({
+        jsType.As<Napi::Number>().Int32Value(),
+        jsInput.As<Napi::Number>().Int32Value(),
+        jsState.IsNumber() ? jsState.As<Napi::Number>().Int32Value() : -1
+      });
+    }
+  }
+
+  try {
+    auto recorder = std::make_shared<InputRecorder>(filepath, std::move(actions), isInjectedIgnored, compressionLevel, static_cast<uint32_t>(blockSize));
+    int recorderId;
+    {
+      std::lock_guard<std::mutex> lock(inputRecordersMutex);
+      recorderId = nextInputRecorderId++;
+      inputRecorders.emplace(recorderId, recorder);
+    }
+    UpdateInputEventSelection();
+    return Napi::Number::New(env, recorderId);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
 
-  // Declare useful variables
+// Function to pause or resume a native input recording
+Napi::Value SetInputRecordingPausedWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-  // Mouse buttons map from X11 button number to Actionify button name
-  std::unordered_map<int, std::string> mouseButtonMap = {
-    {1, "left"},
-    {2, "middle"},
-    {3, "right"},
-    {4, "wheel"}, // wheel up
-    {5, "wheel"}, // wheel down
-    {8, "extraButton1"},
-    {9, "extraButton2"},
-  };
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsBoolean()) {
+    Napi::TypeError::New(env, "Arguments must be: (recorder ID, paused)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int recorderId = info[0].As<Napi::Number>().Int32Value();
+  bool isPaused = info[1].As<Napi::Boolean>().Value();
 
-  // Previous events map used to avoid duplicate events
-  std::unordered_map<std::string, unsigned long> previousEventsMap = {
-    // the key will have the following format: "sourceid:evtype:detail:mousex:mousey:scrollx:scrolly"
-    // the value will be the event time
-  };
-  unsigned long lastEventTime = 0;
+  std::lock_guard<std::mutex> lock(inputRecordersMutex);
+  auto it = inputRecorders.find(recorderId);
+  if (it != inputRecorders.end()) {
+    it->second->setPaused(isPaused);
+  }
+  return env.Undefined();
+}
 
-  // Run input event processing loop
-  inputEventRunning = true;
-  inputEventHookCondition.notify_all();
-  while (inputEventRunning) {
-    XEvent event;
-    XNextEvent(inputDisplay, &event);
+// Function to stop a native input recording, resolving with its statistics
+Napi::Value StopInputRecordingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-    if (!inputEventRunning) {
-      // Event processing thread has been stopped while waiting for an event
-      // see CleanInputEventListener()
-      break;
-    }
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a recorder ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int recorderId = info[0].As<Napi::Number>().Int32Value();
 
-    if (
-      event.xcookie.type != GenericEvent ||
-      event.xcookie.extension != opcode
-    ) {
-      // Ignore non-XInput events
-      continue;
-    }
-    if (!XGetEventData(inputDisplay, &event.xcookie)) {
-      // Ignore XInput events without data
-      continue;
+  std::shared_ptr<InputRecorder> recorder;
+  {
+    // Once removed, the input listener thread no longer records into it
+    std::lock_guard<std::mutex> lock(inputRecordersMutex);
+    auto it = inputRecorders.find(recorderId);
+    if (it == inputRecorders.end()) {
+      Napi::Error::New(env, "Input recorder not found: " + std::to_string(recorderId)).ThrowAsJavaScriptException();
+      return env.Null();
     }
+    recorder = it->second;
+    inputRecorders.erase(it);
+  }
+  UpdateInputEventSelection();
 
-    XIRawEvent* inputEvent = static_cast<XIRawEvent*>(event.xcookie.data);
-    std::optional<Position> maybeMousePosition = GetMouseEventPosition(*inputEvent);
-    std::optional<Position> maybeMouseWheelScrollAmount = GetMouseWheelEventScrollAmount(*inputEvent);
-    std::string eventKey = std::to_string(inputEvent->sourceid)
-      + ":"
-      + std::to_string(event.xcookie.evtype)
-      + ":"
-      + std::to_string(inputEvent->detail)
-      + ":"
-      + std::to_string(maybeMousePosition.value_or(Position{0, 0}).x)
-      + ":"
-      + std::to_string(maybeMousePosition.value_or(Position{0, 0}).y)
-      + ":"
-      + std::to_string(maybeMouseWheelScrollAmount.value_or(Position{0, 0}).x)
-      + ":"
-      + std::to_string(maybeMouseWheelScrollAmount.value_or(Position{0, 0}).y);
-
-    // Clear outdated previous events
-    if (inputEvent->time > lastEventTime) {
-      previousEventsMap.clear();
-      lastEventTime = inputEvent->time;
-    }
-    else if (previousEventsMap.find(eventKey) != previousEventsMap.end()) {
-      // Ignore duplicate events
-      XFreeEventData(inputDisplay, &event.xcookie);
-      continue;
+  // Writing the last blocks may take a while: do it off the main thread
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<InputRecordingStats>(
+    env,
+    deferred,
+    [recorder]() -> InputRecordingStats {
+      return recorder->stop();
+    },
+    [](Napi::Env env, const InputRecordingStats& stats) -> Napi::Value {
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("events", Napi::Number::New(env, static_cast<double>(stats.eventCount)));
+      result.Set("droppedEvents", Napi::Number::New(env, static_cast<double>(stats.droppedEventCount)));
+      result.Set("blocks", Napi::Number::New(env, static_cast<double>(stats.blockCount)));
+      result.Set("duration", Napi::Number::New(env, static_cast<double>(stats.durationMs)));
+      return result;
     }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
+}
 
-    // Determine if the input event was injected via XSendEvent or XTestFakeKey/XTestFakeButton/XTestFakeMotion
-    std::optional<int> xTestKeyboardDeviceId = GetXTestKeyboardDeviceId();
-    std::optional<int> xTestMouseDeviceId = GetXTestMouseDeviceId();
-    bool isInputEventInjected = (
-      event.xany.send_event
-      || (xTestKeyboardDeviceId.has_value() && inputEvent->deviceid == xTestKeyboardDeviceId.value())
-      || (xTestMouseDeviceId.has_value() && inputEvent->deviceid == xTestMouseDeviceId.value())
-    );
+// Function to decode an input recording file into batched input event records
+// (see InputEventBatch)
+Napi::Value ReadInputRecordingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-    std::optional<RawInputEvent> maybeRawInputEvent = std::nullopt;
-    switch (event.xcookie.evtype) {
-      case XI_RawKeyPress: {
-        XkbStateRec xkbState;
-        XkbGetState(inputDisplay, XkbUseCoreKbd, &xkbState);
-        KeySym inputEventKeySym = XkbKeycodeToKeysym(inputDisplay, inputEvent->detail, xkbState.group, 0);
-        bool isInputGrabbed = false;
-        bool isInputEventSuppressed = false;
-        {
-          std::lock_guard<std::mutex> lock(suppressedKeysMutex);
-          isInputGrabbed = suppressedKeyboardKeys.find(inputEventKeySym) != suppressedKeyboardKeys.end();
-          // 0 = down, 1 = up, 2 = neutral
-          isInputEventSuppressed = isInputGrabbed && suppressedKeyboardKeys[inputEventKeySym].find(0) != suppressedKeyboardKeys[inputEventKeySym].end();
-          if (isInputGrabbed && !isInputEventSuppressed) {
-            // We grabbed the key but the user didn't suppress it for this state
-            // X11 doesn't allow to suppress specific states reliably
-            // Thus, we leave it suppressed and consider it suppressed by user
-            isInputEventSuppressed = true;
-          }
-        }
-        maybeRawInputEvent = {
-          "keyboard",
-          "",
-          "down",
-          0,
-          0,
-          static_cast<int>(inputEventKeySym),
-          Now(),
-          isInputEventSuppressed,
-          isInputEventInjected
-        };
-        break;
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a filepath as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<std::vector<double>>(
+    env,
+    deferred,
+    [filepath]() -> std::vector<double> {
+      InputRecordingReader reader(filepath);
+      uint64_t eventCount = 0;
+      for (const InputRecordingIndexEntry& entry : reader.index()) {
+        eventCount += entry.eventCount;
       }
-      case XI_RawKeyRelease: {
-        XkbStateRec xkbState;
-        XkbGetState(inputDisplay, XkbUseCoreKbd, &xkbState);
-        KeySym inputEventKeySym = XkbKeycodeToKeysym(inputDisplay, inputEvent->detail, xkbState.group, 0);
-        bool isInputGrabbed = false;
-        bool isInputEventSuppressed = false;
-        {
-          std::lock_guard<std::mutex> lock(suppressedKeysMutex);
-          isInputGrabbed = suppressedKeyboardKeys.find(inputEventKeySym) != suppressedKeyboardKeys.end();
-          // 0 = down, 1 = up, 2 = neutral
-          isInputEventSuppressed = isInputGrabbed && suppressedKeyboardKeys[inputEventKeySym].find(1) != suppressedKeyboardKeys[inputEventKeySym].end();
-          if (isInputGrabbed && !isInputEventSuppressed) {
-            // We grabbed the key but the user didn't suppress it for this state
-            // X11 doesn't allow to suppress specific states reliably
-            // Thus, we leave it suppressed and consider it suppressed by user
-            isInputEventSuppressed = true;
-          }
+      std::vector<double> records;
+      records.reserve(eventCount * INPUT_EVENT_RECORD_SIZE);
+      std::vector<RawInputEvent> events;
+      for (size_t blockIndex = 0; blockIndex < reader.index().size(); blockIndex++) {
+        reader.readBlock(blockIndex, events);
+        for (const RawInputEvent& event : events) {
+          EncodedInputEvent encoded = EncodeInputEvent(event);
+          records.insert(records.end(), {
+            static_cast<double>(encoded.type),
+            static_cast<double>(encoded.input),
+            static_cast<double>(encoded.state),
+            static_cast<double>(event.x),
+            static_cast<double>(event.y),
+            static_cast<double>(event.timestamp),
+            static_cast<double>(encoded.flags)
+          });
         }
-        maybeRawInputEvent = {
-          "keyboard",
-          "",
-          "up",
-          0,
-          0,
-          static_cast<int>(inputEventKeySym),
-          Now(),
-          isInputEventSuppressed,
-          isInputEventInjected
-        };
-        break;
       }
-      case XI_RawButtonPress: {
-        Position currentMousePosition = Position{0, 0};
-        try {
-          currentMousePosition = GetCursorPos();
-        }
-        catch (const std::exception& e) {
-          std::cerr << "Failed to get cursor position: " << e.what() << std::endl;
-        }
-        bool isInputGrabbed = false;
-        bool isInputEventSuppressed = false;
-        {
-          std::lock_guard<std::mutex> lock(suppressedKeysMutex);
-          isInputGrabbed = suppressedMouseKeys.find(inputEvent->detail) != suppressedMouseKeys.end();
-          // 0 = down, 1 = up, 2 = neutral
-          isInputEventSuppressed = isInputGrabbed && suppressedMouseKeys[inputEvent->detail].find(0) != suppressedMouseKeys[inputEvent->detail].end();
-          if (isInputGrabbed && !isInputEventSuppressed) {
-            // We grabbed the mouse button but the user didn't suppress it for this state
-            // X11 doesn't allow to suppress specific states reliably
-            // Thus, we leave it suppressed and consider it suppressed by user
-            isInputEventSuppressed = true;
-          }
-        }
-        maybeRawInputEvent = {
-          "mouse",
-          mouseButtonMap[inputEvent->detail],
-          inputEvent->detail != 4 ? "down" : "up",
-          currentMousePosition.x,
-          currentMousePosition.y,
-          inputEvent->detail,
-          Now(),
-          isInputEventSuppressed,
-          isInputEventInjected
-        };
-        break;
+      return records;
+    },
+    [](Napi::Env env, const std::vector<double>& records) -> Napi::Value {
+      Napi::Float64Array array = Napi::Float64Array::New(env, records.size());
+      std::copy(records.begin(), records.end(), array.Data());
+      return array;
+    }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
+}
+
+// Function to replay recorded input events natively, from an input recording
+// file or from batched input event records (see InputEventBatch). Returns the
+// replayer ID and a promise resolving with the replay statistics once it ends.
+Napi::Value StartInputReplayWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  bool isRecordArray = info.Length() > 0 && info[0].IsTypedArray() && info[0].As<Napi::TypedArray>().TypedArrayType() == napi_float64_array;
+  if (info.Length() < 1 || !(info[0].IsString() || isRecordArray)) {
+    Napi::TypeError::New(env, "Expected a filepath or a Float64Array of input event records as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  double speed = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().DoubleValue() : 1;
+  if (!(speed > 0 && std::isfinite(speed))) {
+    Napi::RangeError::New(env, "Speed must be a positive number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Records of type | input | state | x | y | timestamp | flags
+  std::vector<RawInputEvent> events;
+  if (isRecordArray) {
+    Napi::Float64Array records = info[0].As<Napi::Float64Array>();
+    if (records.ElementLength() % INPUT_EVENT_RECORD_SIZE != 0) {
+      Napi::TypeError::New(env, "Input event records length must be a multiple of " + std::to_string(INPUT_EVENT_RECORD_SIZE)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    events.reserve(records.ElementLength() / INPUT_EVENT_RECORD_SIZE);
+    for (size_t offset = 0; offset < records.ElementLength(); offset += INPUT_EVENT_RECORD_SIZE) {
+      const double* record = records.Data() + offset;
+      bool isValid = (record[0] == 0 || record[0] == 1) && record[2] >= 0 && record[2] <= 2 && record[5] >= 0;
+      if (!isValid) {
+        continue;
       }
-      case XI_RawButtonRelease: {
-        if (inputEvent->detail == 4 || inputEvent->detail == 5) {
-          // Ignore scroll wheel release events to match Windows behavior
-          break;
+      const int32_t flags = static_cast<int32_t>(record[6]);
+      events.push_back({
+        static_cast<InputEventType>(static_cast<int32_t>(record[0])),
+        static_cast<int>(record[1]),
+        static_cast<InputEventState>(static_cast<int32_t>(record[2])),
+        static_cast<int>(record[3]),
+        static_cast<int>(record[4]),
+        static_cast<uint64_t>(record[5]),
+        (flags & 1) != 0,
+        (flags & 2) != 0
+      });
+    }
+  }
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  Napi::ThreadSafeFunction settle = Napi::ThreadSafeFunction::New(
+    env,
+    Napi::Function::New(env, [](const Napi::CallbackInfo&) { }),
+    "inputReplay",
+    0,
+    1
+  );
+  int replayerId;
+  {
+    std::lock_guard<std::mutex> lock(inputReplayersMutex);
+    replayerId = nextInputReplayerId++;
+  }
+  // Settles on the JS thread, which is busy in this function until the
+  // replayer is registered
+  InputReplayer::Callback onEnd = [settle, deferred, replayerId](const InputReplayStats& stats, std::exception_ptr error) {
+    settle.BlockingCall([deferred, replayerId, stats, error](const Napi::Env& env, const Napi::Function&) {
+      std::shared_ptr<InputReplayer> replayer;
+      {
+        std::lock_guard<std::mutex> lock(inputReplayersMutex);
+        auto it = inputReplayers.find(replayerId);
+        if (it != inputReplayers.end()) {
+          replayer = std::move(it->second);
+          inputReplayers.erase(it);
         }
-        Position currentMousePosition = Position{0, 0};
+      }
+      // Join the ended replay thread
+      replayer.reset();
+      if (error) {
         try {
-          currentMousePosition = GetCursorPos();
+          std::rethrow_exception(error);
         }
         catch (const std::exception& e) {
-          std::cerr << "Failed to get cursor position: " << e.what() << std::endl;
-        }
-        bool isInputGrabbed = false;
-        bool isInputEventSuppressed = false;
-        {
-          std::lock_guard<std::mutex> lock(suppressedKeysMutex);
-          isInputGrabbed = suppressedMouseKeys.find(inputEvent->detail) != suppressedMouseKeys.end();
-          // 0 = down, 1 = up, 2 = neutral
-          isInputEventSuppressed = isInputGrabbed && suppressedMouseKeys[inputEvent->detail].find(1) != suppressedMouseKeys[inputEvent->detail].end();
-          if (isInputGrabbed && !isInputEventSuppressed) {
-            // We grabbed the mouse button but the user didn't suppress it for this state
-            // X11 doesn't allow to suppress specific states reliably
-            // Thus, we leave it suppressed and consider it suppressed by user
-            isInputEventSuppressed = true;
-          }
-        }
-        maybeRawInputEvent = {
-          "mouse",
-          mouseButtonMap[inputEvent->detail],
-          inputEvent->detail != 5 ? "up" : "down",
-          currentMousePosition.x,
-          currentMousePosition.y,
-          inputEvent->detail,
-          Now(),
-          isInputEventSuppressed,
-          isInputEventInjected
-        };
-        break;
-      }
-      case XI_RawMotion: {
-        if (maybeMousePosition) {
-          bool isInputEventGrabbedAndSuppressed = false;
-          {
-            std::lock_guard<std::mutex> lock(suppressedKeysMutex);
-            isInputEventGrabbedAndSuppressed = (
-              suppressedMouseKeys.find(inputEvent->detail) != suppressedMouseKeys.end()
-            );
-          }
-          maybeRawInputEvent = {
-            "mouse",
-            "move",
-            "neutral",
-            maybeMousePosition->x,
-            maybeMousePosition->y,
-            inputEvent->detail,
-            Now(),
-            isInputEventGrabbedAndSuppressed,
-            isInputEventInjected
-          };
-        }
-        if (maybeMouseWheelScrollAmount) {
-          // X11 send XI_RawMotion for each mouse wheel event
-          // if Scroll Y == -1, then it's scroll up and XI_RawButtonPress & XI_RawButtonRelease will be fired
-          // if Scroll Y == 1, then it's scroll down and XI_RawButtonPress & XI_RawButtonRelease will be fired
-          // if Scroll Y == 0, then scroll direction has changed (scroll up to scroll down or scroll down to scroll up).
-          //                   No XI_RawButtonPress & XI_RawButtonRelease will be fired
-          //                   We can ignore this event to comply with X11 behavior
+          deferred.Reject(Napi::Error::New(env, e.what()).Value());
         }
-        break;
+        return;
       }
-      default:
-        // Ignore other events. It shouldn't happen as we only listen to the
-        // specific events above (see XISetMask).
-        break;
-    }
+      Napi::Object lateness = Napi::Object::New(env);
+      lateness.Set("mean", Napi::Number::New(env, stats.meanLatenessMs));
+      lateness.Set("p50", Napi::Number::New(env, stats.p50LatenessMs));
+      lateness.Set("p95", Napi::Number::New(env, stats.p95LatenessMs));
+      lateness.Set("p99", Napi::Number::New(env, stats.p99LatenessMs));
+      lateness.Set("max", Napi::Number::New(env, stats.maxLatenessMs));
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("events", Napi::Number::New(env, static_cast<double>(stats.eventCount)));
+      result.Set("duration", Napi::Number::New(env, static_cast<double>(stats.durationMs)));
+      result.Set("lateness", lateness);
+      deferred.Resolve(result);
+    });
+    settle.Release();
+  };
 
-    // Send input event to JavaScript
-    if (maybeRawInputEvent) {
-      RawInputEvent rawInputEvent = maybeRawInputEvent.value();
-      inputEventThreadSafeJsFunction.BlockingCall([rawInputEvent](const Napi::Env& env, const Napi::Function& jsCallback) {
-        if (!jsCallback.IsEmpty()) {
-          jsCallback.Call({ BuildInputEventObject(env, rawInputEvent) });
-        }
-      });
-      previousEventsMap[eventKey] = inputEvent->time;
-    }
+  try {
+    std::shared_ptr<InputReplayer> replayer = isRecordArray
+      ? std::make_shared<InputReplayer>(std::move(events), speed, onEnd)
+      : std::make_shared<InputReplayer>(std::filesystem::path(info[0].As<Napi::String>().Utf8Value()), speed, onEnd);
+    std::lock_guard<std::mutex> lock(inputReplayersMutex);
+    inputReplayers.emplace(replayerId, replayer);
+  }
+  catch (const std::exception& e) {
+    settle.Release();
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("id", Napi::Number::New(env, replayerId));
+  result.Set("done", deferred.Promise());
+  return result;
+}
 
-    // Free X11 event
-    XFreeEventData(inputDisplay, &event.xcookie);
+// Find a running input replayer. Ended replayers are no longer found.
+std::shared_ptr<InputReplayer> FindInputReplayer(int replayerId) {
+  std::lock_guard<std::mutex> lock(inputReplayersMutex);
+  auto it = inputReplayers.find(replayerId);
+  return it != inputReplayers.end() ? it->second : nullptr;
+}
+
+// Function to pause or resume a native input replay
+Napi::Value SetInputReplayPausedWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsBoolean()) {
+    Napi::TypeError::New(env, "Arguments must be: (replayer ID, paused)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::shared_ptr<InputReplayer> replayer = FindInputReplayer(info[0].As<Napi::Number>().Int32Value());
+  if (replayer) {
+    replayer->setPaused(info[1].As<Napi::Boolean>().Value());
   }
+  return env.Undefined();
+}
 
-  // Unregister all previously selected XInput2 events.
-  // Passing an empty mask removes our raw input event subscription
-  // from the root window
-  {
-    std::lock_guard<std::mutex> lock(inputEventHookMutex);
+// Function to move a native input replay to the given time since its first
+// event, in milliseconds
+Napi::Value SeekInputReplayWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-    XIEventMask eventMask;
-    unsigned char eventMaskData[(XI_LASTEVENT + 7) / 8];
-    std::memset(eventMaskData, 0, sizeof(eventMaskData));
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "Arguments must be: (replayer ID, position)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  double position = info[1].As<Napi::Number>().DoubleValue();
+  if (!(position >= 0 && std::isfinite(position))) {
+    Napi::RangeError::New(env, "Position must be a positive number of milliseconds").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::shared_ptr<InputReplayer> replayer = FindInputReplayer(info[0].As<Napi::Number>().Int32Value());
+  if (replayer) {
+    replayer->seek(static_cast<uint64_t>(position));
+  }
+  return env.Undefined();
+}
 
-    eventMask.deviceid = XIAllDevices;
-    eventMask.mask_len = sizeof(eventMaskData);
-    eventMask.mask = eventMaskData;
+// Function to stop a native input replay. Its promise resolves with the
+// statistics of the events sent so far.
+Napi::Value StopInputReplayWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-    // Unregister all previously selected XInput2 events
-    XISelectEvents(inputDisplay, rootWindow, &eventMask, 1);
-    // Unregister all previously selected X11 events
-    XSelectInput(inputDisplay, rootWindow, NoEventMask);
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a replayer ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::shared_ptr<InputReplayer> replayer = FindInputReplayer(info[0].As<Napi::Number>().Int32Value());
+  if (replayer) {
+    replayer->stop();
+  }
+  return env.Undefined();
+}
+
+// Function to start or stop tracking the input state from the input listener
+// events. Returns whether the input listener must run to track it.
+Napi::Value SetInputStateTrackingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsBoolean()) {
+    Napi::TypeError::New(env, "Expected a boolean as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  bool isEnabled = info[0].As<Napi::Boolean>().Value();
+
+  std::lock_guard<std::mutex> lock(inputEventHookMutex);
+  inputStateTracker.setEnabled(isEnabled);
+  if (inputEventSelected) {
+    // Seed once the listener receives every event
+    Display* inputDisplay = GetInputDisplay();
+    SelectInputEvents(inputDisplay, DefaultRootWindow(inputDisplay));
+    if (isEnabled) {
+      inputStateTracker.seed(inputDisplay);
+    }
+    XFlush(inputDisplay);
+  }
+  return Napi::Boolean::New(env, true);
+}
 
-    XFlush(inputDisplay);
+// Function to know whether the key producing the given key symbol (at the
+// first level of the current keyboard group, as in input events) is held
+bool IsKeyPressed(KeySym keySym) {
+  Display* inputDisplay = GetInputDisplay();
+  if (IsInputStateTracked()) {
+    return InputStateTracker::isKeyPressed(inputDisplay, keySym, inputStateTracker.keys(), inputStateTracker.keyboardGroup());
   }
+  return InputStateTracker::isKeyPressed(inputDisplay, keySym);
 }
 
-Napi::Value StartInputEventListener(const Napi::CallbackInfo& info) {
+Napi::Value IsKeyPressedWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  // Skip if already listening
-  if (inputEventRunning) {
-    return Napi::Boolean::New(env, true);
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a key code as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
   }
+  return Napi::Boolean::New(env, IsKeyPressed(static_cast<KeySym>(info[0].As<Napi::Number>().Int64Value())));
+}
 
-  // Validate arguments
-  if (info.Length() < 1 || !info[0].IsFunction()) {
-    Napi::TypeError::New(env, "Expected a callback function").ThrowAsJavaScriptException();
-    return env.Null();
+// Function to know whether a mouse button is held. Without tracking, the X
+// server only reports the state of the left, middle and right buttons.
+bool IsMouseButtonPressed(MouseInputCode input) {
+  unsigned int button = 0;
+  switch (input) {
+    case MouseInputCode::Left: button = 1; break;
+    case MouseInputCode::Middle: button = 2; break;
+    case MouseInputCode::Right: button = 3; break;
+    case MouseInputCode::ExtraButton1: button = 8; break;
+    case MouseInputCode::ExtraButton2: button = 9; break;
+    default: return false;
+  }
+  if (IsInputStateTracked()) {
+    return inputStateTracker.isButtonPressed(button);
+  }
+  Display* inputDisplay = GetInputDisplay();
+  Window root, child;
+  int x, y, windowX, windowY;
+  unsigned int mask;
+  if (button > 3 || !XQueryPointer(inputDisplay, DefaultRootWindow(inputDisplay), &root, &child, &x, &y, &windowX, &windowY, &mask)) {
+    return false;
   }
+  return (mask & (Button1Mask << (button - 1))) != 0;
+}
 
-  // Convert JS callback to a NAPI ThreadSafeFunction
-  inputEventThreadSafeJsFunction = Napi::ThreadSafeFunction::New(
-    env, // the main NAPI environment
-    info[0].As<Napi::Function>(), // callback function that needs to be called in thread(s)
-    "callback", // JS string used to provide diagnostic information
-    0, // maximum queue size (0 for unlimited)
-    1, // initial number of threads which will be making use of this function
-    [](const Napi::Env& env) { // finalizer callback, can be used to clean threads up
-    }
-  );
+Napi::Value IsMouseButtonPressedWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-  // Start event processing thread
-  inputEventThread = std::thread(InputEventProcessingThread);
-  {
-    std::unique_lock<std::mutex> lock(inputEventHookMutex);
-    inputEventHookCondition.wait(lock, [] { return inputEventRunning.load(); });
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a mouse button as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
   }
-  return Napi::Boolean::New(env, true);
+  return Napi::Boolean::New(env, IsMouseButtonPressed(static_cast<MouseInputCode>(info[0].As<Napi::Number>().Int32Value())));
 }
 
-Napi::Value StopInputEventListener(const Napi::CallbackInfo& info) {
+// Function to get both cursor coordinates at once
+Napi::Value GetCursorPositionWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   try {
-    CleanInputEventListener();
+    Position cursorPosition = GetCursorPos();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("x", Napi::Number::New(env, cursorPosition.x));
+    result.Set("y", Napi::Number::New(env, cursorPosition.y));
+    return result;
   }
   catch (const std::exception& e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
     return env.Null();
   }
+}
 
-  return Napi::Boolean::New(env, true);
+// Publish the suppressed inputs to the input listener. Must be called with
+// suppressedKeysMutex locked.
+void PublishInputSuppressionTable() {
+  std::atomic_store(&inputSuppressionTable, std::shared_ptr<const InputSuppressionTable>(std::make_shared<InputSuppressionTable>(suppressedMouseKeys, suppressedKeyboardKeys)));
 }
 
 void SuppressInputEvents(int type, std::map<int, std::set<int>> inputStateMap) {
@@ -2096,14 +6812,16 @@ void SuppressInputEvents(int type, std::map<int, std::set<int>> inputStateMap) {
         KeyCode keyCode = XKeysymToKeycode(inputDisplay, static_cast<KeySym>(input));
         if (keyCode != 0) {
           XGrabKey(inputDisplay, keyCode, AnyModifier, rootWindow, False, GrabModeAsync, GrabModeAsync);
-          XSync(inputDisplay, False);
         }
       }
       for (int state : states) {
         suppressedKeyboardKeys[input].insert(state);
       }
     }
+    // Send all grabs in a single round trip
+    XSync(inputDisplay, False);
   }
+  PublishInputSuppressionTable();
 }
 
 // Function to suppress input events of given type, input and states
@@ -2198,6 +6916,7 @@ void UnsuppressInputEvents(int type, std::map<int, std::set<int>> inputStateMap)
     }
     XSync(inputDisplay, False);
   }
+  PublishInputSuppressionTable();
 }
 
 // Function to unsuppress input events of given type, input and states
@@ -2624,6 +7343,502 @@ Napi::Value GetAvailableScreens(const Napi::CallbackInfo& info) {
   return result;
 }
 
+// Capture a single monitor on its own X connection, then scale and encode it
+void CaptureMonitor(MonitorCapture& capture) {
+  capture.isCaptured = false;
+
+  Display* display = XOpenDisplay(nullptr);
+  if (!display) return;
+
+  XImage* image = XGetImage(
+    display,
+    DefaultRootWindow(display),
+    capture.x,
+    capture.y,
+    capture.width,
+    capture.height,
+    AllPlanes,
+    ZPixmap
+  );
+  PIX* pix = image ? XImageToPix(image) : nullptr;
+  if (image) {
+    XDestroyImage(image);
+  }
+  XCloseDisplay(display);
+
+  if (!pix) return;
+
+  PIX* scaledPix = capture.scale != 1.0f ? pixScale(pix, capture.scale, capture.scale) : pixClone(pix);
+  pixDestroy(&pix);
+
+  if (!scaledPix) return;
+
+  if (capture.filepath.empty()) {
+    l_uint8* bytes = nullptr;
+    size_t size = 0;
+    if (pixWriteMem(&bytes, &size, scaledPix, capture.format) == 0) {
+      capture.data.assign(bytes, bytes + size);
+      capture.isCaptured = true;
+    }
+    if (bytes) {
+      lept_free(bytes);
+    }
+  }
+  else {
+    capture.isCaptured = pixWrite(capture.filepath.c_str(), scaledPix, capture.format) == 0;
+  }
+
+  pixDestroy(&scaledPix);
+}
+
+// Capture all requested monitors in parallel (one worker per monitor)
+std::vector<MonitorCapture> CaptureMonitors(std::vector<MonitorCapture> captures) {
+  std::vector<std::thread> threads;
+  threads.reserve(captures.size());
+
+  for (MonitorCapture& capture : captures) {
+    threads.emplace_back(CaptureMonitor, std::ref(capture));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  return captures;
+}
+
+Napi::Value CaptureMonitorsWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of monitor capture options as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  try {
+    std::vector<MonitorInfo> monitors = GetX11Monitors();
+    std::vector<MonitorCapture> captures;
+
+    auto addCapture = [&](int id, float scale, int format, const std::string& filepath) {
+      auto monitor = std::find_if(monitors.begin(), monitors.end(), [id](const MonitorInfo& monitor) { return monitor.id == id; });
+      if (monitor == monitors.end()) {
+        throw std::runtime_error("Monitor not found: " + std::to_string(id));
+      }
+      captures.push_back({
+        id,
+        monitor->originX,
+        monitor->originY,
+        static_cast<int>(monitor->width),
+        static_cast<int>(monitor->height),
+        scale > 0 ? scale : 1.0f,
+        format,
+        filepath,
+        {},
+        false
+      });
+    };
+
+    // Translate JS input to C++ input (all monitors when unset)
+    if (info.Length() > 0 && info[0].IsArray()) {
+      Napi::Array jsCaptures = info[0].As<Napi::Array>();
+      for (uint32_t i = 0; i < jsCaptures.Length(); i++) {
+        Napi::Value jsCaptureValue = jsCaptures.Get(i);
+        if (!jsCaptureValue.IsObject()) {
+          Napi::TypeError::New(env, "Each monitor capture option must be an object").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        Napi::Object jsCapture = jsCaptureValue.As<Napi::Object>();
+        if (!jsCapture.Get("id").IsNumber()) {
+          Napi::TypeError::New(env, "Each monitor capture option must have a numeric id").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        int id = jsCapture.Get("id").As<Napi::Number>().Int32Value();
+        float scale = jsCapture.Get("scale").IsNumber() ? jsCapture.Get("scale").As<Napi::Number>().FloatValue() : 1.0f;
+        int format = jsCapture.Get("format").IsString() ? ParseImageFormat(jsCapture.Get("format").As<Napi::String>().Utf8Value()) : IFF_PNG;
+        std::string filepath = jsCapture.Get("filepath").IsString() ? jsCapture.Get("filepath").As<Napi::String>().Utf8Value() : "";
+        addCapture(id, scale, format, filepath);
+      }
+    }
+    else {
+      for (const MonitorInfo& monitor : monitors) {
+        addCapture(monitor.id, 1.0f, IFF_PNG, "");
+      }
+    }
+
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    auto asyncWorker = new PromiseWorker<std::vector<MonitorCapture>>(
+      env,
+      deferred,
+      [captures]() -> std::vector<MonitorCapture> {
+        return CaptureMonitors(captures);
+      },
+      [](Napi::Env env, const std::vector<MonitorCapture>& captures) -> Napi::Value {
+        Napi::Array result = Napi::Array::New(env, captures.size());
+        for (size_t i = 0; i < captures.size(); i++) {
+          const MonitorCapture& capture = captures[i];
+          Napi::Object jsCapture = Napi::Object::New(env);
+          jsCapture.Set("id", Napi::Number::New(env, capture.id));
+          jsCapture.Set("captured", Napi::Boolean::New(env, capture.isCaptured));
+          if (capture.filepath.empty()) {
+            jsCapture.Set("data", Napi::Buffer<uint8_t>::Copy(env, capture.data.data(), capture.data.size()));
+          }
+          result.Set(i, jsCapture);
+        }
+        return result;
+      }
+    );
+    asyncWorker->Queue();
+    return deferred.Promise();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value StartScreenRecordingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected an options object as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  if (!options.Get("filepath").IsString() || !options.Get("x").IsNumber() || !options.Get("y").IsNumber() || !options.Get("width").IsNumber() || !options.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "Options must contain: filepath, x, y, width, height").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input to C++ input
+  std::string filepath = options.Get("filepath").As<Napi::String>().Utf8Value();
+  unsigned long windowId = options.Get("windowId").IsNumber() ? static_cast<unsigned long>(options.Get("windowId").As<Napi::Number>().Int64Value()) : 0;
+  int x = options.Get("x").As<Napi::Number>().Int32Value();
+  int y = options.Get("y").As<Napi::Number>().Int32Value();
+  int width = options.Get("width").As<Napi::Number>().Int32Value();
+  int height = options.Get("height").As<Napi::Number>().Int32Value();
+  double fps = options.Get("fps").IsNumber() ? options.Get("fps").As<Napi::Number>().DoubleValue() : 30.0;
+  std::string codecName = options.Get("codec").IsString() ? options.Get("codec").As<Napi::String>().Utf8Value() : "lz4";
+  int compressionLevel = options.Get("compressionLevel").IsNumber() ? options.Get("compressionLevel").As<Napi::Number>().Int32Value() : 1;
+  uint32_t keyframeInterval = options.Get("keyframeInterval").IsNumber()
+    ? options.Get("keyframeInterval").As<Napi::Number>().Uint32Value()
+    : static_cast<uint32_t>(std::max(1.0, std::round(fps * 2)));
+
+  if (fps <= 0) {
+    Napi::TypeError::New(env, "FPS must be a positive number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (codecName != "lz4" && codecName != "zstd") {
+    Napi::TypeError::New(env, "Codec must be \"lz4\" or \"zstd\"").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  FrameCodec codec = codecName == "zstd" ? FrameCodec::Zstd : FrameCodec::Lz4;
+
+  try {
+    auto source = std::make_unique<ScreenFrameSource>(windowId, x, y, width, height);
+    auto recorder = std::make_shared<ScreenRecorder>(std::move(source), filepath, fps, codec, compressionLevel, keyframeInterval);
+
+    std::lock_guard<std::mutex> lock(screenRecordersMutex);
+    int recorderId = nextScreenRecorderId++;
+    screenRecorders.emplace(recorderId, recorder);
+    return Napi::Number::New(env, recorderId);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value StopScreenRecordingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a recorder ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int recorderId = info[0].As<Napi::Number>().Int32Value();
+
+  std::shared_ptr<ScreenRecorder> recorder;
+  {
+    std::lock_guard<std::mutex> lock(screenRecordersMutex);
+    auto it = screenRecorders.find(recorderId);
+    if (it == screenRecorders.end()) {
+      Napi::Error::New(env, "Screen recorder not found: " + std::to_string(recorderId)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    recorder = it->second;
+    screenRecorders.erase(it);
+  }
+
+  // Flushing pending frames may take a while: do it off the main thread
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<ScreenRecordingStats>(
+    env,
+    deferred,
+    [recorder]() -> ScreenRecordingStats {
+      return recorder->stop();
+    },
+    [](Napi::Env env, const ScreenRecordingStats& stats) -> Napi::Value {
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("frames", Napi::Number::New(env, static_cast<double>(stats.frameCount)));
+      result.Set("droppedFrames", Napi::Number::New(env, static_cast<double>(stats.droppedFrameCount)));
+      result.Set("duration", Napi::Number::New(env, static_cast<double>(stats.durationMs)));
+      return result;
+    }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
+}
+
+Napi::Value ReadScreenRecordingFrameWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "Arguments must be: (filepath, frame index)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string filepath = info[0].As<Napi::String>().Utf8Value();
+  int64_t frameIndex = info[1].As<Napi::Number>().Int64Value();
+  if (frameIndex < 0) {
+    Napi::RangeError::New(env, "Frame index must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  try {
+    ScreenRecordingFrame frame = ReadScreenRecordingFrame(filepath, static_cast<uint64_t>(frameIndex));
+
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, frame.pixels.size());
+    std::memcpy(buffer.Data(), frame.pixels.data(), frame.pixels.size());
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("width", Napi::Number::New(env, frame.header.width));
+    result.Set("height", Napi::Number::New(env, frame.header.height));
+    result.Set("stride", Napi::Number::New(env, frame.header.stride));
+    result.Set("format", Napi::String::New(env, "bgra"));
+    result.Set("data", Napi::Uint8Array::New(env, frame.pixels.size(), buffer, 0));
+    result.Set("timestamp", Napi::Number::New(env, frame.timestampUs / 1000.0));
+    result.Set("frameCount", Napi::Number::New(env, static_cast<double>(frame.frameCount)));
+    result.Set("fps", Napi::Number::New(env, frame.header.fps));
+    return result;
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value StartFlightRecorderWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected an options object as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  if (!options.Get("x").IsNumber() || !options.Get("y").IsNumber() || !options.Get("width").IsNumber() || !options.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "Options must contain: x, y, width, height").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input to C++ input
+  unsigned long windowId = options.Get("windowId").IsNumber() ? static_cast<unsigned long>(options.Get("windowId").As<Napi::Number>().Int64Value()) : 0;
+  int x = options.Get("x").As<Napi::Number>().Int32Value();
+  int y = options.Get("y").As<Napi::Number>().Int32Value();
+  int width = options.Get("width").As<Napi::Number>().Int32Value();
+  int height = options.Get("height").As<Napi::Number>().Int32Value();
+  double fps = options.Get("fps").IsNumber() ? options.Get("fps").As<Napi::Number>().DoubleValue() : 10.0;
+  int64_t durationMs = options.Get("duration").IsNumber() ? options.Get("duration").As<Napi::Number>().Int64Value() : 10000;
+  int64_t memoryLimit = options.Get("memoryLimit").IsNumber() ? options.Get("memoryLimit").As<Napi::Number>().Int64Value() : 128 * 1024 * 1024;
+  uint32_t keyframeInterval = options.Get("keyframeInterval").IsNumber()
+    ? options.Get("keyframeInterval").As<Napi::Number>().Uint32Value()
+    : static_cast<uint32_t>(std::max(1.0, std::round(fps)));
+
+  if (fps <= 0 || durationMs <= 0 || memoryLimit <= 0) {
+    Napi::TypeError::New(env, "FPS, duration and memory limit must be positive numbers").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  try {
+    auto source = std::make_unique<ScreenFrameSource>(windowId, x, y, width, height);
+    auto recorder = std::make_shared<FlightRecorder>(std::move(source), fps, static_cast<uint64_t>(durationMs), static_cast<size_t>(memoryLimit), keyframeInterval);
+
+    std::lock_guard<std::mutex> lock(flightRecordersMutex);
+    int recorderId = nextFlightRecorderId++;
+    flightRecorders.emplace(recorderId, recorder);
+    return Napi::Number::New(env, recorderId);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value DumpFlightRecorderWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsString()) {
+    Napi::TypeError::New(env, "Arguments must be: (recorder ID, filepath)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int recorderId = info[0].As<Napi::Number>().Int32Value();
+  std::string filepath = info[1].As<Napi::String>().Utf8Value();
+
+  std::shared_ptr<FlightRecorder> recorder;
+  {
+    std::lock_guard<std::mutex> lock(flightRecordersMutex);
+    auto it = flightRecorders.find(recorderId);
+    if (it == flightRecorders.end()) {
+      Napi::Error::New(env, "Flight recorder not found: " + std::to_string(recorderId)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    recorder = it->second;
+  }
+
+  // Writing the buffered frames to disk may take a while: do it off the main thread
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<ScreenRecordingStats>(
+    env,
+    deferred,
+    [recorder, filepath]() -> ScreenRecordingStats {
+      return recorder->dump(filepath);
+    },
+    [](Napi::Env env, const ScreenRecordingStats& stats) -> Napi::Value {
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("frames", Napi::Number::New(env, static_cast<double>(stats.frameCount)));
+      result.Set("droppedFrames", Napi::Number::New(env, static_cast<double>(stats.droppedFrameCount)));
+      result.Set("duration", Napi::Number::New(env, static_cast<double>(stats.durationMs)));
+      return result;
+    }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
+}
+
+Napi::Value StopFlightRecorderWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a recorder ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int recorderId = info[0].As<Napi::Number>().Int32Value();
+
+  std::shared_ptr<FlightRecorder> recorder;
+  {
+    std::lock_guard<std::mutex> lock(flightRecordersMutex);
+    auto it = flightRecorders.find(recorderId);
+    if (it == flightRecorders.end()) {
+      return env.Undefined();
+    }
+    recorder = it->second;
+    flightRecorders.erase(it);
+  }
+  // Only waits for the frame being captured, if any
+  recorder->stop();
+  return env.Undefined();
+}
+
+Napi::Value StartScreenFrameFeedWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+    Napi::TypeError::New(env, "Arguments must be: (options, frame callback)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  if (!options.Get("x").IsNumber() || !options.Get("y").IsNumber() || !options.Get("width").IsNumber() || !options.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "Options must contain: x, y, width, height").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input to C++ input
+  unsigned long windowId = options.Get("windowId").IsNumber() ? static_cast<unsigned long>(options.Get("windowId").As<Napi::Number>().Int64Value()) : 0;
+  int x = options.Get("x").As<Napi::Number>().Int32Value();
+  int y = options.Get("y").As<Napi::Number>().Int32Value();
+  int width = options.Get("width").As<Napi::Number>().Int32Value();
+  int height = options.Get("height").As<Napi::Number>().Int32Value();
+  double fps = options.Get("fps").IsNumber() ? options.Get("fps").As<Napi::Number>().DoubleValue() : 30.0;
+  int32_t slotCount = options.Get("slots").IsNumber() ? options.Get("slots").As<Napi::Number>().Int32Value() : 3;
+
+  if (fps <= 0) {
+    Napi::TypeError::New(env, "FPS must be a positive number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (slotCount < 2) {
+    Napi::TypeError::New(env, "Slots must be a number greater than or equal to 2").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  try {
+    auto source = std::make_unique<ScreenFrameSource>(windowId, x, y, width, height);
+
+    // Frames are written straight into a SharedArrayBuffer, kept alive by a reference
+    size_t memorySize = ScreenFrameFeed::requiredMemorySize(*source, static_cast<uint32_t>(slotCount));
+    Napi::Object sharedBuffer = env.Global().Get("SharedArrayBuffer").As<Napi::Function>().New({ Napi::Number::New(env, static_cast<double>(memorySize)) });
+    Napi::Uint8Array memory = env.Global().Get("Uint8Array").As<Napi::Function>().New({ sharedBuffer }).As<Napi::Uint8Array>();
+
+    // Called after each frame, so JS can wake up readers with Atomics.notify
+    Napi::ThreadSafeFunction onFrame = Napi::ThreadSafeFunction::New(
+      env,
+      info[1].As<Napi::Function>(),
+      "screenFrameFeed",
+      1, // pending notifications are coalesced
+      1
+    );
+    auto feed = std::make_shared<ScreenFrameFeed>(
+      std::move(source),
+      memory.Data(),
+      fps,
+      static_cast<uint32_t>(slotCount),
+      [onFrame]() {
+        onFrame.NonBlockingCall();
+      }
+    );
+
+    int feedId;
+    {
+      std::lock_guard<std::mutex> lock(screenFrameFeedsMutex);
+      feedId = nextScreenFrameFeedId++;
+      screenFrameFeeds.emplace(feedId, ScreenFrameFeedHandle{ feed, onFrame, Napi::Persistent(memory) });
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("id", Napi::Number::New(env, feedId));
+    result.Set("buffer", sharedBuffer);
+    return result;
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value StopScreenFrameFeedWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a feed ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int feedId = info[0].As<Napi::Number>().Int32Value();
+
+  ScreenFrameFeedHandle handle;
+  {
+    std::lock_guard<std::mutex> lock(screenFrameFeedsMutex);
+    auto it = screenFrameFeeds.find(feedId);
+    if (it == screenFrameFeeds.end()) {
+      return env.Undefined();
+    }
+    handle = std::move(it->second);
+    screenFrameFeeds.erase(it);
+  }
+  // Only waits for the frame being captured, if any
+  handle.feed->stop();
+  handle.onFrame.Release();
+  handle.memory.Reset();
+  return env.Undefined();
+}
+
 
 // =============================================================================
 // ============================= WINDOW FUNCTIONS ==============================
@@ -3131,31 +8346,285 @@ void RestoreWindow(Window window) {
   // remove state
   event.xclient.data.l[0] = 0;
 
-  // states to remove (up to 2 at a time)
-  event.xclient.data.l[1] = GetAtom("_NET_WM_STATE_MAXIMIZED_HORZ");
-  event.xclient.data.l[2] = GetAtom("_NET_WM_STATE_MAXIMIZED_VERT");
-  event.xclient.data.l[3] = 0; // unused
-  event.xclient.data.l[4] = 0; // unused
+  // states to remove (up to 2 at a time)
+  event.xclient.data.l[1] = GetAtom("_NET_WM_STATE_MAXIMIZED_HORZ");
+  event.xclient.data.l[2] = GetAtom("_NET_WM_STATE_MAXIMIZED_VERT");
+  event.xclient.data.l[3] = 0; // unused
+  event.xclient.data.l[4] = 0; // unused
+
+  // send the event
+  XSendEvent(windowDisplay, rootWindow, False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+
+  // Unminimize the window
+  XMapRaised(windowDisplay, window);
+
+  // Ensure changes are sent immediately to the X server
+  XFlush(windowDisplay);
+
+  if (windowInfo.isMinimized) {
+    // If we restored a minimized window, we must focus it.
+    // Otherwise, the window manager may block it
+    // or ask confirmation to the user
+    FocusWindow(window);
+  }
+}
+
+// N-API wrapper function to restore a window
+Napi::Value RestoreWindowWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Ensure the argument is a number (window ID)
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Argument must be a number (window ID)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // On X11, Window == window ID
+  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
+
+  try {
+    RestoreWindow(windowId);
+
+    return Napi::Boolean::New(env, true);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+}
+
+void MinimizeWindow(Window window) {
+  Display* windowDisplay = GetWindowDisplay();
+  int screen = DefaultScreen(windowDisplay);
+
+  // Request window minimization
+  XIconifyWindow(windowDisplay, window, screen);
+
+  // Ensure changes are sent immediately to the X server
+  XFlush(windowDisplay);
+}
+
+Napi::Value MinimizeWindowWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Ensure the argument is a number (window ID)
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Argument must be a number (window ID)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // On X11, Window == window ID
+  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
+
+  try {
+    MinimizeWindow(windowId);
+
+    return Napi::Boolean::New(env, true);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+}
+
+void MaximizeWindow(Window window) {
+  Display* windowDisplay = GetWindowDisplay();
+  Window rootWindow = DefaultRootWindow(windowDisplay);
+
+  XEvent event;
+  std::memset(&event, 0, sizeof(event));
+
+  event.xclient.type = ClientMessage;
+  event.xclient.window = window;
+  event.xclient.message_type = GetAtom("_NET_WM_STATE");
+  event.xclient.format = 32;
+
+  // add state
+  event.xclient.data.l[0] = 1;
+
+  // states to add (up to 2 at a time)
+  event.xclient.data.l[1] = GetAtom("_NET_WM_STATE_MAXIMIZED_HORZ");
+  event.xclient.data.l[2] = GetAtom("_NET_WM_STATE_MAXIMIZED_VERT");
+  event.xclient.data.l[3] = 0; // unused
+  event.xclient.data.l[4] = 0; // unused
+
+  // send the event
+  XSendEvent(windowDisplay, rootWindow, False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+
+  // Ensure changes are sent immediately to the X server
+  XFlush(windowDisplay);
+}
+
+Napi::Value MaximizeWindowWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Ensure the argument is a number (window ID)
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Argument must be a number (window ID)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // On X11, Window == window ID
+  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
+
+  try {
+    MaximizeWindow(windowId);
+
+    return Napi::Boolean::New(env, true);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+}
+
+void CloseWindow(Window window) {
+  Display* windowDisplay = GetWindowDisplay();
+  Window rootWindow = DefaultRootWindow(windowDisplay);
+
+  XEvent event;
+  std::memset(&event, 0, sizeof(event));
+
+  event.xclient.type = ClientMessage;
+  event.xclient.window = window;
+  event.xclient.message_type = GetAtom("_NET_CLOSE_WINDOW");
+  event.xclient.format = 32;
+
+  event.xclient.data.l[0] = CurrentTime;
+  event.xclient.data.l[1] = 1; // source indication (1 = application, 2 = pager)
+  event.xclient.data.l[2] = window;
+  event.xclient.data.l[3] = 0; // unused
+  event.xclient.data.l[4] = 0; // unused
+
+  // send the event
+  XSendEvent(windowDisplay, rootWindow, False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+
+  // Ensure changes are sent immediately to the X server
+  XFlush(windowDisplay);
+}
+
+Napi::Value CloseWindowWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Ensure the argument is a number (window ID)
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Argument must be a number (window ID)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // On X11, Window == window ID
+  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
+
+  try {
+    CloseWindow(windowId);
+
+    return Napi::Boolean::New(env, true);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+}
+
+void SetWindowPosition(Window window, int x, int y)
+{
+  Display* windowDisplay = GetWindowDisplay();
+
+  // Move the window
+  XMoveWindow(windowDisplay, window, x, y);
+
+  // Flush requests to the X server immediately
+  XFlush(windowDisplay);
+}
+
+// N-API wrapper function to change the position of a window
+Napi::Value SetWindowPositionWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Ensure the arguments are valid
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber()) {
+    Napi::TypeError::New(env, "Arguments must be: (windowId, x, y)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Get the arguments
+  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
+  int x = info[1].As<Napi::Number>().Int32Value();
+  int y = info[2].As<Napi::Number>().Int32Value();
+
+  try {
+    SetWindowPosition(windowId, x, y);
+    return Napi::Boolean::New(env, true);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+}
+
+void SetWindowDimensions(Window window, unsigned int width, unsigned int height)
+{
+  Display* windowDisplay = GetWindowDisplay();
+
+  std::vector<long> windowFrames = GetWindowProperty<long>(window, GetAtom("_NET_FRAME_EXTENTS"), XA_CARDINAL);
+  if (windowFrames.size() >= 4) {
+    long leftFrame = std::abs(windowFrames[0]);
+    long rightFrame = std::abs(windowFrames[1]);
+    long topFrame = std::abs(windowFrames[2]);
+    long bottomFrame = std::abs(windowFrames[3]);
+    width -= (leftFrame + rightFrame);
+    height -= (topFrame + bottomFrame);
+  }
+
+  // Resize the window
+  XResizeWindow(windowDisplay, window, width, height);
+
+  // Send requests immediately to the X server
+  XFlush(windowDisplay);
+}
+
+// N-API wrapper function to change the dimensions of a window
+Napi::Value SetWindowDimensionsWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Ensure the arguments are valid
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber()) {
+    Napi::TypeError::New(env, "Arguments must be: (windowId, width, height)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Get the arguments
+  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
+  int width = info[1].As<Napi::Number>().Int32Value();
+  int height = info[2].As<Napi::Number>().Int32Value();
+
+  try {
+    SetWindowDimensions(windowId, width, height);
+    return Napi::Boolean::New(env, true);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
 
-  // send the event
-  XSendEvent(windowDisplay, rootWindow, False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+void SetWindowToBottom(Window window)
+{
+  Display* windowDisplay = GetWindowDisplay();
 
-  // Unminimize the window
-  XMapRaised(windowDisplay, window);
+  // Lower the window below all sibling windows
+  XLowerWindow(windowDisplay, window);
 
-  // Ensure changes are sent immediately to the X server
+  // Flush requests to the X server
   XFlush(windowDisplay);
-
-  if (windowInfo.isMinimized) {
-    // If we restored a minimized window, we must focus it.
-    // Otherwise, the window manager may block it
-    // or ask confirmation to the user
-    FocusWindow(window);
-  }
 }
 
-// N-API wrapper function to restore a window
-Napi::Value RestoreWindowWrapper(const Napi::CallbackInfo& info) {
+Napi::Value SetWindowToBottomWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   // Ensure the argument is a number (window ID)
@@ -3168,29 +8637,32 @@ Napi::Value RestoreWindowWrapper(const Napi::CallbackInfo& info) {
   Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
 
   try {
-    RestoreWindow(windowId);
-
+    SetWindowToBottom(windowId);
     return Napi::Boolean::New(env, true);
   }
   catch (const std::exception& e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
     return env.Null();
   }
-
 }
 
-void MinimizeWindow(Window window) {
+void SetWindowToTop(Window window) {
   Display* windowDisplay = GetWindowDisplay();
-  int screen = DefaultScreen(windowDisplay);
 
-  // Request window minimization
-  XIconifyWindow(windowDisplay, window, screen);
+  // Raise the window above sibling windows
+  XRaiseWindow(windowDisplay, window);
 
-  // Ensure changes are sent immediately to the X server
+  // Flush requests to the X server
   XFlush(windowDisplay);
+
+  // We have to focus the window we raise at the top.
+  // Otherwise, the window manager may block it
+  // or ask confirmation to the user
+  FocusWindow(window);
 }
 
-Napi::Value MinimizeWindowWrapper(const Napi::CallbackInfo& info) {
+// N-API wrapper function to bring a window to the top of the Z-order
+Napi::Value SetWindowToTopWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   // Ensure the argument is a number (window ID)
@@ -3203,18 +8675,16 @@ Napi::Value MinimizeWindowWrapper(const Napi::CallbackInfo& info) {
   Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
 
   try {
-    MinimizeWindow(windowId);
-
+    SetWindowToTop(windowId);
     return Napi::Boolean::New(env, true);
   }
   catch (const std::exception& e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
     return env.Null();
   }
-
 }
 
-void MaximizeWindow(Window window) {
+void SetWindowToAlwaysOnTop(Window window) {
   Display* windowDisplay = GetWindowDisplay();
   Window rootWindow = DefaultRootWindow(windowDisplay);
 
@@ -3230,8 +8700,8 @@ void MaximizeWindow(Window window) {
   event.xclient.data.l[0] = 1;
 
   // states to add (up to 2 at a time)
-  event.xclient.data.l[1] = GetAtom("_NET_WM_STATE_MAXIMIZED_HORZ");
-  event.xclient.data.l[2] = GetAtom("_NET_WM_STATE_MAXIMIZED_VERT");
+  event.xclient.data.l[1] = GetAtom("_NET_WM_STATE_ABOVE");
+  event.xclient.data.l[2] = None;
   event.xclient.data.l[3] = 0; // unused
   event.xclient.data.l[4] = 0; // unused
 
@@ -3242,31 +8712,7 @@ void MaximizeWindow(Window window) {
   XFlush(windowDisplay);
 }
 
-Napi::Value MaximizeWindowWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-
-  // Ensure the argument is a number (window ID)
-  if (info.Length() < 1 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Argument must be a number (window ID)").ThrowAsJavaScriptException();
-    return env.Null();
-  }
-
-  // On X11, Window == window ID
-  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
-
-  try {
-    MaximizeWindow(windowId);
-
-    return Napi::Boolean::New(env, true);
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
-
-}
-
-void CloseWindow(Window window) {
+void UnsetWindowFromAlwaysOnTop(Window window) {
   Display* windowDisplay = GetWindowDisplay();
   Window rootWindow = DefaultRootWindow(windowDisplay);
 
@@ -3275,12 +8721,15 @@ void CloseWindow(Window window) {
 
   event.xclient.type = ClientMessage;
   event.xclient.window = window;
-  event.xclient.message_type = GetAtom("_NET_CLOSE_WINDOW");
+  event.xclient.message_type = GetAtom("_NET_WM_STATE");
   event.xclient.format = 32;
 
-  event.xclient.data.l[0] = CurrentTime;
-  event.xclient.data.l[1] = 1; // source indication (1 = application, 2 = pager)
-  event.xclient.data.l[2] = window;
+  // remove state
+  event.xclient.data.l[0] = 0;
+
+  // states to add (up to 2 at a time)
+  event.xclient.data.l[1] = GetAtom("_NET_WM_STATE_ABOVE");
+  event.xclient.data.l[2] = None;
   event.xclient.data.l[3] = 0; // unused
   event.xclient.data.l[4] = 0; // unused
 
@@ -3291,139 +8740,218 @@ void CloseWindow(Window window) {
   XFlush(windowDisplay);
 }
 
-Napi::Value CloseWindowWrapper(const Napi::CallbackInfo& info) {
+Napi::Value SetWindowToAlwaysOnTopWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  // Ensure the argument is a number (window ID)
-  if (info.Length() < 1 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Argument must be a number (window ID)").ThrowAsJavaScriptException();
+  // Ensure the first argument is a number (window ID) and the second is a boolean
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsBoolean()) {
+    Napi::TypeError::New(env, "Arguments must be: (window ID, boolean)").ThrowAsJavaScriptException();
     return env.Null();
   }
 
   // On X11, Window == window ID
   Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
 
-  try {
-    CloseWindow(windowId);
+  // Get the boolean value from the second argument
+  bool shouldBeAlwaysOnTop = info[1].As<Napi::Boolean>().Value();
 
+  try {
+    if (shouldBeAlwaysOnTop) {
+      SetWindowToAlwaysOnTop(windowId);
+    }
+    else {
+      UnsetWindowFromAlwaysOnTop(windowId);
+    }
     return Napi::Boolean::New(env, true);
   }
   catch (const std::exception& e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
     return env.Null();
   }
-
 }
 
-void SetWindowPosition(Window window, int x, int y)
+// Get pixel color from screen at (x, y)
+Color GetPixelColor(int x, int y)
 {
+  Color color = {0, 0, 0, 0};
+
   Display* windowDisplay = GetWindowDisplay();
+  Window rootWindow = DefaultRootWindow(windowDisplay);
 
-  // Move the window
-  XMoveWindow(windowDisplay, window, x, y);
+  // Capture 1x1 image from screen
+  XImage* image = XGetImage(
+    windowDisplay,
+    rootWindow,
+    x,
+    y,
+    1,
+    1,
+    AllPlanes,
+    ZPixmap
+  );
 
-  // Flush requests to the X server immediately
-  XFlush(windowDisplay);
+  if (!image) return color;
+
+  unsigned long pixel = XGetPixel(image, 0, 0);
+
+  // Extract RGB using masks
+  color.red = (pixel & image->red_mask) >> 16;
+  color.green = (pixel & image->green_mask) >> 8;
+  color.blue = (pixel & image->blue_mask);
+
+  // X11 usually has no real alpha channel for screen pixels
+  color.alpha = 255;
+
+  XDestroyImage(image);
+
+  return color;
 }
 
-// N-API wrapper function to change the position of a window
-Napi::Value SetWindowPositionWrapper(const Napi::CallbackInfo& info) {
+Napi::Value GetPixelColorWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  // Ensure the arguments are valid
-  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber()) {
-    Napi::TypeError::New(env, "Arguments must be: (windowId, x, y)").ThrowAsJavaScriptException();
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "Arguments must be: (x, y)").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  // Get the arguments
-  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
-  int x = info[1].As<Napi::Number>().Int32Value();
-  int y = info[2].As<Napi::Number>().Int32Value();
-
-  try {
-    SetWindowPosition(windowId, x, y);
-    return Napi::Boolean::New(env, true);
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
+  int x = info[0].As<Napi::Number>().Int32Value();
+  int y = info[1].As<Napi::Number>().Int32Value();
 
+  Color color = GetPixelColor(x, y);
+  Napi::Object result = Napi::Object::New(env);
+  result.Set(Napi::String::New(env, "red"), Napi::Number::New(env, color.red));
+  result.Set(Napi::String::New(env, "green"), Napi::Number::New(env, color.green));
+  result.Set(Napi::String::New(env, "blue"), Napi::Number::New(env, color.blue));
+  result.Set(Napi::String::New(env, "alpha"), Napi::Number::New(env, color.alpha));
+  return result;
 }
 
-void SetWindowDimensions(Window window, unsigned int width, unsigned int height)
-{
+bool TakeWindowScreenshotToFile(
+  Window window,
+  int x,
+  int y,
+  int width,
+  int height,
+  const std::string& filepath,
+  const float& scale = 1.0f
+) {
   Display* windowDisplay = GetWindowDisplay();
+  WindowInfo windowInfo = GetWindowInfo(window, false);
 
-  std::vector<long> windowFrames = GetWindowProperty<long>(window, GetAtom("_NET_FRAME_EXTENTS"), XA_CARDINAL);
-  if (windowFrames.size() >= 4) {
-    long leftFrame = std::abs(windowFrames[0]);
-    long rightFrame = std::abs(windowFrames[1]);
-    long topFrame = std::abs(windowFrames[2]);
-    long bottomFrame = std::abs(windowFrames[3]);
-    width -= (leftFrame + rightFrame);
-    height -= (topFrame + bottomFrame);
+  int safeX = std::clamp(x, 0, static_cast<int>(windowInfo.width) - 1);
+  int safeY = std::clamp(y, 0, static_cast<int>(windowInfo.height) - 1);
+  int safeWidth = std::clamp(width, 1, static_cast<int>(windowInfo.width) - safeX);
+  int safeHeight = std::clamp(height, 1, static_cast<int>(windowInfo.height) - safeY);
+
+  XImage* image = XGetImage(
+    windowDisplay,
+    window,
+    safeX,
+    safeY,
+    safeWidth,
+    safeHeight,
+    AllPlanes,
+    ZPixmap
+  );
+
+  bool isX11Image = image != nullptr;
+  PIX* pix = isX11Image ? XImageToPix(image) : pixCreate(safeWidth, safeHeight, 32);
+
+  if (image) {
+    XDestroyImage(image);
   }
 
-  // Resize the window
-  XResizeWindow(windowDisplay, window, width, height);
+  if (!pix) return false;
 
-  // Send requests immediately to the X server
-  XFlush(windowDisplay);
+  if (!isX11Image) {
+    // black image
+    l_uint32* data = pixGetData(pix);
+    int wpl = pixGetWpl(pix);
+    for (int imageY = 0; imageY < safeHeight; imageY++) {
+      l_uint32* line = data + imageY * wpl;
+      for (int imageX = 0; imageX < safeWidth; imageX++) {
+        l_uint32 pixelColor;
+        composeRGBAPixel(0, 0, 0, 255, &pixelColor);
+        line[imageX] = pixelColor;
+      }
+    }
+  }
+
+  // Scale
+  PIX* scaledPix = pixScale(pix, scale, scale);
+  pixDestroy(&pix);
+
+  if (!scaledPix) return false;
+
+  // Save as PNG
+  bool isImageSaved = pixWrite(filepath.c_str(), scaledPix, IFF_PNG) == 0;
+  pixDestroy(&scaledPix);
+
+  return isX11Image && isImageSaved;
 }
 
-// N-API wrapper function to change the dimensions of a window
-Napi::Value SetWindowDimensionsWrapper(const Napi::CallbackInfo& info) {
+Napi::Value TakeWindowScreenshotToFileWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  // Ensure the arguments are valid
-  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber()) {
-    Napi::TypeError::New(env, "Arguments must be: (windowId, width, height)").ThrowAsJavaScriptException();
+  if (info.Length() < 7 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber() || !info[4].IsNumber() || !info[5].IsString() || !info[6].IsNumber()) {
+    Napi::TypeError::New(env, "Arguments must be: (window ID, x, y, width, height, filepath, scale)").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  // Get the arguments
   Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
-  int width = info[1].As<Napi::Number>().Int32Value();
-  int height = info[2].As<Napi::Number>().Int32Value();
+  int x = info[1].As<Napi::Number>().Int32Value();
+  int y = info[2].As<Napi::Number>().Int32Value();
+  int width = info[3].As<Napi::Number>().Int32Value();
+  int height = info[4].As<Napi::Number>().Int32Value();
+  std::string utf8Filepath = info[5].As<Napi::String>().Utf8Value();
+  std::string filepath = utf8Filepath;
+  float scale = info[6].As<Napi::Number>().FloatValue();
 
   try {
-    SetWindowDimensions(windowId, width, height);
-    return Napi::Boolean::New(env, true);
+    bool hasSavedX11Image = TakeWindowScreenshotToFile(windowId, x, y, width, height, filepath, scale);
+    return Napi::Boolean::New(env, hasSavedX11Image);
   }
   catch (const std::exception& e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
     return env.Null();
   }
+
 }
 
-void SetWindowToBottom(Window window)
-{
+bool TakeScreenshotToFile(
+  int x,
+  int y,
+  int width,
+  int height,
+  const std::string& filepath,
+  const float& scale = 1.0f
+) {
   Display* windowDisplay = GetWindowDisplay();
+  Window rootWindow = DefaultRootWindow(windowDisplay);
 
-  // Lower the window below all sibling windows
-  XLowerWindow(windowDisplay, window);
-
-  // Flush requests to the X server
-  XFlush(windowDisplay);
+  return TakeWindowScreenshotToFile(rootWindow, x, y, width, height, filepath, scale);
 }
 
-Napi::Value SetWindowToBottomWrapper(const Napi::CallbackInfo& info) {
+Napi::Value TakeScreenshotToFileWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  // Ensure the argument is a number (window ID)
-  if (info.Length() < 1 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Argument must be a number (window ID)").ThrowAsJavaScriptException();
+  if (info.Length() < 6 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber() || !info[4].IsString() || !info[5].IsNumber()) {
+    Napi::TypeError::New(env, "Arguments must be: (x, y, width, height, filepath)").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  // On X11, Window == window ID
-  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
+  int x = info[0].As<Napi::Number>().Int32Value();
+  int y = info[1].As<Napi::Number>().Int32Value();
+  int width = info[2].As<Napi::Number>().Int32Value();
+  int height = info[3].As<Napi::Number>().Int32Value();
+  std::string utf8Filepath = info[4].As<Napi::String>().Utf8Value();
+  std::string filepath = utf8Filepath;
+  float scale = info[5].As<Napi::Number>().FloatValue();
 
-  try {
-    SetWindowToBottom(windowId);
-    return Napi::Boolean::New(env, true);
+  try{
+    bool hasSavedX11Image = TakeScreenshotToFile(x, y, width, height, filepath, scale);
+    return Napi::Boolean::New(env, hasSavedX11Image);
   }
   catch (const std::exception& e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
@@ -3431,695 +8959,1636 @@ Napi::Value SetWindowToBottomWrapper(const Napi::CallbackInfo& info) {
   }
 }
 
-void SetWindowToTop(Window window) {
-  Display* windowDisplay = GetWindowDisplay();
-
-  // Raise the window above sibling windows
-  XRaiseWindow(windowDisplay, window);
 
-  // Flush requests to the X server
-  XFlush(windowDisplay);
+// =============================================================================
+// ======================= WINDOW EVENTS HOOK PROCEDURES =======================
+// =============================================================================
 
-  // We have to focus the window we raise at the top.
-  // Otherwise, the window manager may block it
-  // or ask confirmation to the user
-  FocusWindow(window);
+Napi::Object BuildWindowEventObject(const Napi::Env& env, const RawWindowEvent& rawWindowEvent) {
+  Napi::Object windowEventObj = Napi::Object::New(env);
+  windowEventObj.Set(Napi::String::New(env, "id"), Napi::Number::New(env, reinterpret_cast<uintptr_t>(rawWindowEvent.id)));
+  windowEventObj.Set(Napi::String::New(env, "type"), Napi::String::New(env, rawWindowEvent.type));
+  return windowEventObj;
 }
 
-// N-API wrapper function to bring a window to the top of the Z-order
-Napi::Value SetWindowToTopWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+void WindowEventProcessingThread() {
+  // Initialize XInput2 listener
+  Display* windowDisplay = GetWindowDisplay();
+  Window rootWindow = DefaultRootWindow(windowDisplay);
+  {
+    std::lock_guard<std::mutex> lock(windowEventHookMutex);
 
-  // Ensure the argument is a number (window ID)
-  if (info.Length() < 1 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Argument must be a number (window ID)").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+    XSelectInput(
+      windowDisplay,
+      rootWindow,
+      SubstructureNotifyMask | PropertyChangeMask
+    );
 
-  // On X11, Window == window ID
-  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
+    std::vector<WindowInfo> windows = ListWindows();
+    for (const WindowInfo& window : windows) {
+      // Minimization events are only available at specific window level
+      XSelectInput(
+        windowDisplay,
+        window.id,
+        PropertyChangeMask
+      );
+    }
 
-  try {
-    SetWindowToTop(windowId);
-    return Napi::Boolean::New(env, true);
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
+    XFlush(windowDisplay);
   }
-}
 
-void SetWindowToAlwaysOnTop(Window window) {
-  Display* windowDisplay = GetWindowDisplay();
-  Window rootWindow = DefaultRootWindow(windowDisplay);
+  // Previous events map used to avoid duplicate events
+  std::unordered_map<std::string, unsigned long> previousWindowEventsMap = {
+    // the key will have the following format: "eventType:isInjected:windowId"
+    // the value will be the event time
+  };
 
-  XEvent event;
-  std::memset(&event, 0, sizeof(event));
+  unsigned long lastWindowEventTime = 0;
+  std::unordered_map<Window, Window> eventWindowToRealWindowMap = {};
+  Window previouslyFocusedWindow = None;
 
-  event.xclient.type = ClientMessage;
-  event.xclient.window = window;
-  event.xclient.message_type = GetAtom("_NET_WM_STATE");
-  event.xclient.format = 32;
+  // Run window event processing loop
+  windowEventRunning = true;
+  windowEventHookCondition.notify_all();
+  while (windowEventRunning) {
+    XEvent event;
+    XNextEvent(windowDisplay, &event);
+    uint64_t eventTime = Now();
 
-  // add state
-  event.xclient.data.l[0] = 1;
+    if (!windowEventRunning) {
+      // Event processing thread has been stopped while waiting for an event
+      // see CleanWindowEventListener()
+      break;
+    }
 
-  // states to add (up to 2 at a time)
-  event.xclient.data.l[1] = GetAtom("_NET_WM_STATE_ABOVE");
-  event.xclient.data.l[2] = None;
-  event.xclient.data.l[3] = 0; // unused
-  event.xclient.data.l[4] = 0; // unused
+    std::string eventKey = std::to_string(event.type)
+      + ":"
+      + std::to_string(event.xany.send_event)
+      + ":" // windowId will be set in switch case below
+    ;
+    std::optional<RawWindowEvent> maybeRawWindowEvent = std::nullopt;
+    switch (event.type) {
+      case CreateNotify: {
+        // Event intercepted by rootWindow with SubstructureNotifyMask
+        Window eventWindow = event.xcreatewindow.window;
+        Window realWindow = GetTopLevelWindow(eventWindow).value_or(eventWindow);
+        eventKey += std::to_string(realWindow);
+        eventWindowToRealWindowMap[eventWindow] = realWindow;
+        maybeRawWindowEvent = {
+          realWindow,
+          "create"
+        };
+        XSelectInput(windowDisplay, eventWindow, PropertyChangeMask);
+        break;
+      }
 
-  // send the event
-  XSendEvent(windowDisplay, rootWindow, False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+      case DestroyNotify: {
+        // event intercepted by rootWindow with SubstructureNotifyMask
+        Window eventWindow = event.xdestroywindow.window;
+        Window realWindow = eventWindowToRealWindowMap.find(eventWindow) == eventWindowToRealWindowMap.end() ? eventWindow : eventWindowToRealWindowMap[eventWindow];
+        eventKey += std::to_string(realWindow);
+        eventWindowToRealWindowMap.erase(eventWindow);
+        maybeRawWindowEvent = {
+          realWindow,
+          "destroy"
+        };
+        break;
+      }
 
-  // Ensure changes are sent immediately to the X server
-  XFlush(windowDisplay);
-}
+      case PropertyNotify: {
+        if (event.xproperty.atom == GetAtom("_NET_ACTIVE_WINDOW")) {
+          // focus event intercepted by rootWindow with PropertyChangeMask
+          Window eventWindow = GetWindowProperty<Window>(rootWindow, GetAtom("_NET_ACTIVE_WINDOW"), XA_WINDOW)[0];
+          if (eventWindow == None) {
+            // No window is focused. Usually happens on Wayland or WSLg when
+            // a non-X11 window is focused
+            break;
+          }
+          Window realWindow = eventWindowToRealWindowMap.find(eventWindow) == eventWindowToRealWindowMap.end() ? GetTopLevelWindow(eventWindow).value_or(eventWindow) : eventWindowToRealWindowMap[eventWindow];
+          if (realWindow == previouslyFocusedWindow) {
+            // Prevent duplicate focus events
+            break;
+          }
+          previouslyFocusedWindow = realWindow;
+          eventKey += std::to_string(realWindow);
+          eventWindowToRealWindowMap[eventWindow] = realWindow;
+          maybeRawWindowEvent = {
+            realWindow,
+            "focus"
+          };
+        }
+        else if (event.xproperty.atom == GetAtom("_NET_WM_STATE")) {
+          // minimization, restoration or maximization event intercepted
+          // by target top-level window with PropertyChangeMask
+          Window eventWindow = event.xproperty.window;
+          Window realWindow = eventWindowToRealWindowMap.find(eventWindow) == eventWindowToRealWindowMap.end() ? GetTopLevelWindow(eventWindow).value_or(eventWindow) : eventWindowToRealWindowMap[eventWindow];
+          eventKey += std::to_string(realWindow);
+          eventWindowToRealWindowMap[eventWindow] = realWindow;
+          maybeRawWindowEvent = {
+            realWindow,
+            "locationchange"
+          };
+        }
+        break;
+      }
 
-void UnsetWindowFromAlwaysOnTop(Window window) {
-  Display* windowDisplay = GetWindowDisplay();
-  Window rootWindow = DefaultRootWindow(windowDisplay);
+      case ConfigureNotify: {
+        // event intercepted by rootWindow with SubstructureNotifyMask
+        Window eventWindow = event.xconfigure.window;
+        Window realWindow = eventWindowToRealWindowMap.find(eventWindow) == eventWindowToRealWindowMap.end() ? GetTopLevelWindow(eventWindow).value_or(eventWindow) : eventWindowToRealWindowMap[eventWindow];
+        eventKey += std::to_string(realWindow);
+        eventWindowToRealWindowMap[eventWindow] = realWindow;
+        maybeRawWindowEvent = {
+          realWindow,
+          "locationchange"
+        };
+        break;
+      }
 
-  XEvent event;
-  std::memset(&event, 0, sizeof(event));
+      default:
+        // Ignore other events. It shouldn't happen as we only listen to the
+        // specific events above (see XSelectInput).
+        break;
+    }
+
+    // Clear outdated previous events
+    if (eventTime > lastWindowEventTime) {
+      previousWindowEventsMap.clear();
+      lastWindowEventTime = eventTime;
+    }
+    else if (previousWindowEventsMap.find(eventKey) != previousWindowEventsMap.end()) {
+      // Ignore duplicate events
+      continue;
+    }
 
-  event.xclient.type = ClientMessage;
-  event.xclient.window = window;
-  event.xclient.message_type = GetAtom("_NET_WM_STATE");
-  event.xclient.format = 32;
+    // Send window event to JavaScript
+    if (maybeRawWindowEvent) {
+      RawWindowEvent rawWindowEvent = maybeRawWindowEvent.value();
+      windowEventThreadSafeJsFunction.BlockingCall([rawWindowEvent](const Napi::Env& env, const Napi::Function& jsCallback) {
+        if (!jsCallback.IsEmpty()) {
+          jsCallback.Call({ BuildWindowEventObject(env, rawWindowEvent) });
+        }
+      });
+      previousWindowEventsMap[eventKey] = eventTime;
+    }
+  }
 
-  // remove state
-  event.xclient.data.l[0] = 0;
+  // Unregister all previously selected window events
+  // Passing an empty mask removes our raw window event subscription
+  // from the root window
+  {
+    std::lock_guard<std::mutex> lock(windowEventHookMutex);
 
-  // states to add (up to 2 at a time)
-  event.xclient.data.l[1] = GetAtom("_NET_WM_STATE_ABOVE");
-  event.xclient.data.l[2] = None;
-  event.xclient.data.l[3] = 0; // unused
-  event.xclient.data.l[4] = 0; // unused
+    // Unregister all previously selected window events
+    XSelectInput(
+      windowDisplay,
+      rootWindow,
+      NoEventMask
+    );
 
-  // send the event
-  XSendEvent(windowDisplay, rootWindow, False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+    std::vector<WindowInfo> windows = ListWindows();
+    for (const WindowInfo& window : windows) {
+      XSelectInput(
+        windowDisplay,
+        window.id,
+        NoEventMask
+      );
+    }
 
-  // Ensure changes are sent immediately to the X server
-  XFlush(windowDisplay);
+    XFlush(windowDisplay);
+  }
 }
 
-Napi::Value SetWindowToAlwaysOnTopWrapper(const Napi::CallbackInfo& info) {
+Napi::Value StartWindowEventListener(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  // Ensure the first argument is a number (window ID) and the second is a boolean
-  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsBoolean()) {
-    Napi::TypeError::New(env, "Arguments must be: (window ID, boolean)").ThrowAsJavaScriptException();
+  // Skip if already listening
+  if (windowEventRunning) {
+    return Napi::Boolean::New(env, true);
+  }
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsFunction()) {
+    Napi::TypeError::New(env, "Expected a callback function").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  // On X11, Window == window ID
-  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
+  // Convert JS callback to a NAPI ThreadSafeFunction
+  windowEventThreadSafeJsFunction = Napi::ThreadSafeFunction::New(
+    env, // the main NAPI environment
+    info[0].As<Napi::Function>(), // callback function that needs to be called in thread(s)
+    "callback", // JS string used to provide diagnostic information
+    0, // maximum queue size (0 for unlimited)
+    1, // initial number of threads which will be making use of this function
+    [](const Napi::Env& env) { // finalizer callback, can be used to clean threads up
+    }
+  );
 
-  // Get the boolean value from the second argument
-  bool shouldBeAlwaysOnTop = info[1].As<Napi::Boolean>().Value();
+  // Start event processing thread
+  windowEventThread = std::thread(WindowEventProcessingThread);
+  {
+    std::unique_lock<std::mutex> lock(windowEventHookMutex);
+    windowEventHookCondition.wait(lock, [] { return windowEventRunning.load(); });
+  }
+  return Napi::Boolean::New(env, true);
+}
+
+Napi::Value StopWindowEventListener(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
   try {
-    if (shouldBeAlwaysOnTop) {
-      SetWindowToAlwaysOnTop(windowId);
-    }
-    else {
-      UnsetWindowFromAlwaysOnTop(windowId);
-    }
-    return Napi::Boolean::New(env, true);
+    CleanWindowEventListener();
   }
   catch (const std::exception& e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
     return env.Null();
   }
+
+  return Napi::Boolean::New(env, true);
 }
 
-// Get pixel color from screen at (x, y)
-Color GetPixelColor(int x, int y)
-{
-  Color color = {0, 0, 0, 0};
 
-  Display* windowDisplay = GetWindowDisplay();
-  Window rootWindow = DefaultRootWindow(windowDisplay);
+// =============================================================================
+// =============================== TIME FUNCTIONS ==============================
+// =============================================================================
 
-  // Capture 1x1 image from screen
-  XImage* image = XGetImage(
-    windowDisplay,
-    rootWindow,
-    x,
-    y,
-    1,
-    1,
-    AllPlanes,
-    ZPixmap
-  );
+// Parse the (milliseconds, precise?) arguments of sleeps into an absolute
+// monotonic deadline, throwing a JavaScript exception on invalid arguments
+bool ParseSleepArguments(const Napi::CallbackInfo& info, std::chrono::steady_clock::time_point& deadline, bool& isPrecise) {
+  Napi::Env env = info.Env();
+  const auto start = std::chrono::steady_clock::now();
 
-  if (!image) return color;
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a number argument").ThrowAsJavaScriptException();
+    return false;
+  }
+  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsBoolean()) {
+    Napi::TypeError::New(env, "Expected precise to be a boolean").ThrowAsJavaScriptException();
+    return false;
+  }
 
-  unsigned long pixel = XGetPixel(image, 0, 0);
+  double milliseconds = info[0].As<Napi::Number>().DoubleValue();
+  if (std::isnan(milliseconds) || milliseconds > 2147483647.0) {
+    Napi::RangeError::New(env, "Expected a duration of at most 2147483647 milliseconds").ThrowAsJavaScriptException();
+    return false;
+  }
 
-  // Extract RGB using masks
-  color.red = (pixel & image->red_mask) >> 16;
-  color.green = (pixel & image->green_mask) >> 8;
-  color.blue = (pixel & image->blue_mask);
+  // Negative durations do not sleep, as with setTimeout
+  deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(std::max(0.0, milliseconds)));
+  isPrecise = info.Length() > 1 && info[1].IsBoolean() && info[1].As<Napi::Boolean>().Value();
+  return true;
+}
 
-  // X11 usually has no real alpha channel for screen pixels
-  color.alpha = 255;
+// Function to synchronously sleep for a given number of milliseconds.
+// The deadline is absolute on the monotonic clock, and precise sleeps spin
+// the end of it for sub-millisecond accuracy.
+Napi::Value SleepWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-  XDestroyImage(image);
+  std::chrono::steady_clock::time_point deadline;
+  bool isPrecise;
+  if (!ParseSleepArguments(info, deadline, isPrecise)) {
+    return env.Null();
+  }
 
-  return color;
+  SleepUntil(deadline, isPrecise ? PRECISE_SLEEP_SPIN_WINDOW : std::chrono::microseconds(0));
+
+  return env.Undefined();
 }
 
-Napi::Value GetPixelColorWrapper(const Napi::CallbackInfo& info) {
+// Function to sleep for a given number of milliseconds without blocking the
+// event loop. The returned promise resolves with the monotonic time at which
+// the timer fired.
+Napi::Value SleepAsyncWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
-    Napi::TypeError::New(env, "Arguments must be: (x, y)").ThrowAsJavaScriptException();
+  std::chrono::steady_clock::time_point deadline;
+  bool isPrecise;
+  if (!ParseSleepArguments(info, deadline, isPrecise)) {
     return env.Null();
   }
 
-  int x = info[0].As<Napi::Number>().Int32Value();
-  int y = info[1].As<Napi::Number>().Int32Value();
-
-  Color color = GetPixelColor(x, y);
-  Napi::Object result = Napi::Object::New(env);
-  result.Set(Napi::String::New(env, "red"), Napi::Number::New(env, color.red));
-  result.Set(Napi::String::New(env, "green"), Napi::Number::New(env, color.green));
-  result.Set(Napi::String::New(env, "blue"), Napi::Number::New(env, color.blue));
-  result.Set(Napi::String::New(env, "alpha"), Napi::Number::New(env, color.alpha));
-  return result;
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  Napi::ThreadSafeFunction settle = Napi::ThreadSafeFunction::New(
+    env,
+    Napi::Function::New(env, [](const Napi::CallbackInfo&) { }),
+    "sleepAsync",
+    0,
+    1
+  );
+  timerService.schedule(deadline, isPrecise, [settle, deferred](bool isCancelled) {
+    const double firedAt = MonotonicNow();
+    settle.BlockingCall([deferred, isCancelled, firedAt](const Napi::Env& env, const Napi::Function&) {
+      if (isCancelled) {
+        deferred.Reject(Napi::Error::New(env, "Sleep was cancelled.").Value());
+      }
+      else {
+        deferred.Resolve(Napi::Number::New(env, firedAt));
+      }
+    });
+    settle.Release();
+  });
+  return deferred.Promise();
 }
 
-bool TakeWindowScreenshotToFile(
-  Window window,
-  int x,
-  int y,
-  int width,
-  int height,
-  const std::string& filepath,
-  const float& scale = 1.0f
-) {
-  Display* windowDisplay = GetWindowDisplay();
-  WindowInfo windowInfo = GetWindowInfo(window, false);
+// Function to get the milliseconds elapsed on the monotonic clock
+Napi::Value GetMonotonicTimeWrapper(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(), MonotonicNow());
+}
 
-  int safeX = std::clamp(x, 0, static_cast<int>(windowInfo.width) - 1);
-  int safeY = std::clamp(y, 0, static_cast<int>(windowInfo.height) - 1);
-  int safeWidth = std::clamp(width, 1, static_cast<int>(windowInfo.width) - safeX);
-  int safeHeight = std::clamp(height, 1, static_cast<int>(windowInfo.height) - safeY);
 
-  XImage* image = XGetImage(
-    windowDisplay,
-    window,
-    safeX,
-    safeY,
-    safeWidth,
-    safeHeight,
-    AllPlanes,
-    ZPixmap
-  );
+// =============================================================================
+// =============================== OCR FUNCTIONS ===============================
+// =============================================================================
 
-  PIX* pix = pixCreate(safeWidth, safeHeight, 32);
-  if (!pix) {
-    if (image) {
-      XDestroyImage(image);
-    }
-    return false;
+// Tesseract settings of an OCR call. A plain language keeps Tesseract defaults.
+struct OcrProfile {
+  std::string language;
+  std::optional<tesseract::PageSegMode> pageSegmentationMode;
+  tesseract::OcrEngineMode engineMode = tesseract::OEM_DEFAULT;
+  std::string whitelist;
+  std::string blacklist;
+  int dpi = 0; // 0 to let Tesseract estimate it
+  std::map<std::string, std::string> variables;
+
+  // Identity of the settings, to pool engines and cache results
+  std::string key() const {
+    std::ostringstream stream;
+    stream << language
+      << '\x1f' << (pageSegmentationMode ? static_cast<int>(*pageSegmentationMode) : -1)
+      << '\x1f' << static_cast<int>(engineMode)
+      << '\x1f' << whitelist
+      << '\x1f' << blacklist
+      << '\x1f' << dpi;
+    for (const auto& [name, value] : variables) {
+      stream << '\x1f' << name << '=' << value;
+    }
+    return stream.str();
   }
+};
 
-  l_uint32* data = pixGetData(pix);
-  int wpl = pixGetWpl(pix);
+// Initialize Tesseract with the trained data of the profile language (English by
+// default), then apply the profile settings
+void InitializeTesseract(tesseract::TessBaseAPI& tesseract, const OcrProfile& profile) {
+  // Get trained data assets folder
+  std::string trainedDataAbsolutePath = (GetUserDataAbsoluteDirectoryPath() / "ocr")
+    .lexically_normal()
+    .string();
+  std::string language = !profile.language.empty() ? profile.language : "eng";
+
+  // Variables are given to Init so that init-only ones (e.g. load_system_dawg) apply too
+  std::vector<std::string> variableNames;
+  std::vector<std::string> variableValues;
+  auto addVariable = [&variableNames, &variableValues](const std::string& name, const std::string& value) {
+    variableNames.push_back(name);
+    variableValues.push_back(value);
+  };
+  if (!profile.whitelist.empty()) {
+    addVariable("tessedit_char_whitelist", profile.whitelist);
+  }
+  if (!profile.blacklist.empty()) {
+    addVariable("tessedit_char_blacklist", profile.blacklist);
+  }
+  if (profile.dpi > 0) {
+    addVariable("user_defined_dpi", std::to_string(profile.dpi));
+  }
+  for (const auto& [name, value] : profile.variables) {
+    addVariable(name, value);
+  }
 
-  bool isX11Image;
-  if (image) {
-    isX11Image = true;
-    for (int imageY = 0; imageY < safeHeight; imageY++) {
-      l_uint32* line = data + imageY * wpl;
-      for (int imageX = 0; imageX < safeWidth; imageX++) {
-        unsigned long pixel = XGetPixel(image, imageX, imageY);
-        l_uint8 red = (pixel & image->red_mask) >> 16;
-        l_uint8 green = (pixel & image->green_mask) >> 8;
-        l_uint8 blue = (pixel & image->blue_mask);
-        l_uint32 pixelColor;
-        composeRGBAPixel(red, green, blue, 255, &pixelColor);
-        line[imageX] = pixelColor;
-      }
-    }
+  if (tesseract.Init(trainedDataAbsolutePath.c_str(), language.c_str(), profile.engineMode, nullptr, 0, &variableNames, &variableValues, false) != 0) {
+    throw std::runtime_error("Failed to initialize Tesseract with language: " + language);
   }
-  else {
-    // black image
-    isX11Image = false;
-    for (int imageY = 0; imageY < safeHeight; imageY++) {
-      l_uint32* line = data + imageY * wpl;
-      for (int imageX = 0; imageX < safeWidth; imageX++) {
-        l_uint32 pixelColor;
-        composeRGBAPixel(0, 0, 0, 255, &pixelColor);
-        line[imageX] = pixelColor;
-      }
+  // Unknown variables are silently ignored by Init
+  for (const auto& [name, value] : profile.variables) {
+    std::string currentValue;
+    if (!tesseract.GetVariableAsString(name.c_str(), &currentValue)) {
+      throw std::runtime_error("Unknown Tesseract variable: " + name);
     }
   }
-
-  if (image) {
-    XDestroyImage(image);
+  if (profile.pageSegmentationMode) {
+    tesseract.SetPageSegMode(*profile.pageSegmentationMode);
   }
+}
 
-  // Scale
-  PIX* scaledPix = pixScale(pix, scale, scale);
-  pixDestroy(&pix);
+// Initialized Tesseract engines by profile, reused across OCR calls since
+// loading language data takes a while. Each engine serves one thread at a time.
+// Idle engines are capped as a whole, whatever their profile: the least
+// recently used ones are freed first, except those kept by preload().
+class OcrEnginePool {
+  public:
+    // An engine borrowed from the pool, given back on destruction
+    class Lease {
+      public:
+        Lease(OcrEnginePool* pool, std::string key, std::unique_ptr<tesseract::TessBaseAPI> engine)
+          : m_pool(pool), m_key(std::move(key)), m_engine(std::move(engine)) {}
+
+        Lease(Lease&&) = default;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        ~Lease() {
+          if (m_engine) {
+            m_pool->release(m_key, std::move(m_engine));
+          }
+        }
+
+        tesseract::TessBaseAPI& operator*() {
+          return *m_engine;
+        }
+
+      private:
+        OcrEnginePool* m_pool;
+        std::string m_key;
+        std::unique_ptr<tesseract::TessBaseAPI> m_engine;
+    };
+
+    OcrEnginePool() : m_maxIdleEngineCount(std::max(1u, std::thread::hardware_concurrency())) {}
+
+    OcrEnginePool(const OcrEnginePool&) = delete;
+    OcrEnginePool& operator=(const OcrEnginePool&) = delete;
+
+    // Borrow an idle engine of the profile, or initialize a new one
+    Lease acquire(const OcrProfile& profile) {
+      std::string key = profile.key();
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Most recently used first
+        for (auto it = m_idleEngines.begin(); it != m_idleEngines.end(); ++it) {
+          if (it->key == key) {
+            std::unique_ptr<tesseract::TessBaseAPI> engine = std::move(it->engine);
+            m_idleEngines.erase(it);
+            return Lease(this, std::move(key), std::move(engine));
+          }
+        }
+      }
+      auto engine = std::make_unique<tesseract::TessBaseAPI>();
+      InitializeTesseract(*engine, profile);
+      return Lease(this, std::move(key), std::move(engine));
+    }
+
+    // Make sure `count` engines of the profile are initialized and kept idle
+    void preload(const OcrProfile& profile, size_t count) {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t& preloadedCount = m_preloadedCounts[profile.key()];
+        preloadedCount = std::max(preloadedCount, count);
+      }
+      std::vector<Lease> leases;
+      for (size_t i = 0; i < count; i++) {
+        leases.push_back(acquire(profile));
+      }
+    }
 
-  if (!scaledPix) return false;
+    // Free the idle engines of a profile
+    void clear(const OcrProfile& profile) {
+      std::string key = profile.key();
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_idleEngines.remove_if([&key](const IdleEngine& idleEngine) { return idleEngine.key == key; });
+      m_preloadedCounts.erase(key);
+    }
 
-  // Save as PNG
-  bool isImageSaved = pixWrite(filepath.c_str(), scaledPix, IFF_PNG) == 0;
-  pixDestroy(&scaledPix);
+    // Free all idle engines
+    void clear() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_idleEngines.clear();
+      m_preloadedCounts.clear();
+    }
 
-  return isX11Image && isImageSaved;
-}
+  private:
+    struct IdleEngine {
+      std::string key;
+      std::unique_ptr<tesseract::TessBaseAPI> engine;
+    };
+
+    void release(const std::string& key, std::unique_ptr<tesseract::TessBaseAPI> engine) {
+      // Drop the last image and results, keep the loaded language
+      engine->Clear();
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_idleEngines.push_front({ key, std::move(engine) });
+
+      // Count idle engines by profile, from the most recently used, so that
+      // engines past the preloaded count of their profile can be freed
+      std::map<std::string, size_t> idleCounts;
+      size_t unreservedCount = 0;
+      for (const IdleEngine& idleEngine : m_idleEngines) {
+        auto preloadedCount = m_preloadedCounts.find(idleEngine.key);
+        if (++idleCounts[idleEngine.key] > (preloadedCount != m_preloadedCounts.end() ? preloadedCount->second : 0)) {
+          unreservedCount++;
+        }
+      }
 
-Napi::Value TakeWindowScreenshotToFileWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+      // Free the least recently used engines beyond the cap
+      for (auto it = m_idleEngines.end(); unreservedCount > m_maxIdleEngineCount && it != m_idleEngines.begin();) {
+        --it;
+        auto preloadedCount = m_preloadedCounts.find(it->key);
+        size_t& idleCount = idleCounts[it->key];
+        if (idleCount > (preloadedCount != m_preloadedCounts.end() ? preloadedCount->second : 0)) {
+          idleCount--;
+          unreservedCount--;
+          it = m_idleEngines.erase(it);
+        }
+      }
+    }
 
-  if (info.Length() < 7 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber() || !info[4].IsNumber() || !info[5].IsString() || !info[6].IsNumber()) {
-    Napi::TypeError::New(env, "Arguments must be: (window ID, x, y, width, height, filepath, scale)").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+    std::mutex m_mutex;
+    std::list<IdleEngine> m_idleEngines; // most recently used first
+    std::map<std::string, size_t> m_preloadedCounts; // idle engines kept by preload, by profile
+    size_t m_maxIdleEngineCount; // idle engines kept besides the preloaded ones
+};
 
-  Window windowId = static_cast<Window>(info[0].As<Napi::Number>().Int32Value());
-  int x = info[1].As<Napi::Number>().Int32Value();
-  int y = info[2].As<Napi::Number>().Int32Value();
-  int width = info[3].As<Napi::Number>().Int32Value();
-  int height = info[4].As<Napi::Number>().Int32Value();
-  std::string utf8Filepath = info[5].As<Napi::String>().Utf8Value();
-  std::string filepath = utf8Filepath;
-  float scale = info[6].As<Napi::Number>().FloatValue();
+// Pooled OCR engines
+OcrEnginePool ocrEnginePool;
 
-  try {
-    bool hasSavedX11Image = TakeWindowScreenshotToFile(windowId, x, y, width, height, filepath, scale);
-    return Napi::Boolean::New(env, hasSavedX11Image);
-  }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
-  }
+// Named OCR profiles
+std::map<std::string, OcrProfile> ocrProfiles;
+std::mutex ocrProfilesMutex;
 
+// Resolve the language argument of an OCR call: the name of a registered
+// profile, else a plain language
+OcrProfile ResolveOcrProfile(const std::string& languageOrProfileName) {
+  {
+    std::lock_guard<std::mutex> lock(ocrProfilesMutex);
+    auto profile = ocrProfiles.find(languageOrProfileName);
+    if (profile != ocrProfiles.end()) {
+      return profile->second;
+    }
+  }
+  OcrProfile profile;
+  profile.language = languageOrProfileName;
+  return profile;
 }
 
-bool TakeScreenshotToFile(
-  int x,
-  int y,
-  int width,
-  int height,
-  const std::string& filepath,
-  const float& scale = 1.0f
-) {
-  Display* windowDisplay = GetWindowDisplay();
-  Window rootWindow = DefaultRootWindow(windowDisplay);
-
-  return TakeWindowScreenshotToFile(rootWindow, x, y, width, height, filepath, scale);
-}
+enum class OcrBinarization {
+  None,
+  Otsu,
+  Sauvola,
+};
 
-Napi::Value TakeScreenshotToFileWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+enum class OcrInversion {
+  None,
+  Always,
+  Auto, // only light text on a dark background
+};
 
-  if (info.Length() < 6 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber() || !info[4].IsString() || !info[5].IsNumber()) {
-    Napi::TypeError::New(env, "Arguments must be: (x, y, width, height, filepath)").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+// Image transformations applied before OCR, in this order
+struct OcrPreprocessing {
+  bool isGrayscale = false;
+  OcrInversion inversion = OcrInversion::None;
+  int scale = 1;
+  OcrBinarization binarization = OcrBinarization::None;
+};
 
-  int x = info[0].As<Napi::Number>().Int32Value();
-  int y = info[1].As<Napi::Number>().Int32Value();
-  int width = info[2].As<Napi::Number>().Int32Value();
-  int height = info[3].As<Napi::Number>().Int32Value();
-  std::string utf8Filepath = info[4].As<Napi::String>().Utf8Value();
-  std::string filepath = utf8Filepath;
-  float scale = info[5].As<Napi::Number>().FloatValue();
+// Apply the preprocessing stages to a copy of `image`, in memory, with one
+// Leptonica call per stage (no round trip through files nor extra buffers).
+PIX* PreprocessOcrImage(PIX* image, const OcrPreprocessing& preprocessing) {
+  PIX* result = pixClone(image);
+  auto replace = [&result](PIX* next) {
+    if (!next) {
+      pixDestroy(&result);
+      throw std::runtime_error("Failed to preprocess image for OCR.");
+    }
+    pixDestroy(&result);
+    result = next;
+  };
 
-  try{
-    bool hasSavedX11Image = TakeScreenshotToFile(x, y, width, height, filepath, scale);
-    return Napi::Boolean::New(env, hasSavedX11Image);
+  // Inversion and binarization work on grayscale images, not on the palette
+  // indices of colormapped ones
+  bool isGrayscale = preprocessing.isGrayscale
+    || preprocessing.inversion != OcrInversion::None
+    || preprocessing.binarization != OcrBinarization::None;
+  if (isGrayscale && (pixGetDepth(result) != 8 || pixGetColormap(result))) {
+    replace(pixConvertTo8(result, 0));
   }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-    return env.Null();
+
+  if (preprocessing.inversion != OcrInversion::None) {
+    bool isInverted = preprocessing.inversion == OcrInversion::Always;
+    if (preprocessing.inversion == OcrInversion::Auto) {
+      // Mostly dark images are dark themes: light text on a dark background
+      l_float32 mean = 255;
+      pixGetAverageMasked(result, nullptr, 0, 0, 4, L_MEAN_ABSVAL, &mean);
+      isInverted = mean < 128;
+    }
+    if (isInverted) {
+      replace(pixInvert(nullptr, result));
+    }
   }
-}
 
+  if (preprocessing.scale > 1) {
+    // Linear interpolation keeps glyph edges smooth for binarization
+    float factor = static_cast<float>(preprocessing.scale);
+    replace(pixGetDepth(result) == 8 && !pixGetColormap(result) ? pixScaleGrayLI(result, factor, factor) : pixScale(result, factor, factor));
+  }
 
-// =============================================================================
-// ======================= WINDOW EVENTS HOOK PROCEDURES =======================
-// =============================================================================
+  if (preprocessing.binarization == OcrBinarization::Otsu) {
+    // A single tile covering the whole image gives a global Otsu threshold
+    PIX* binarized = nullptr;
+    pixOtsuAdaptiveThreshold(result, std::max(16, pixGetWidth(result)), std::max(16, pixGetHeight(result)), 0, 0, 0.1f, nullptr, &binarized);
+    replace(binarized);
+  }
+  else if (preprocessing.binarization == OcrBinarization::Sauvola) {
+    // Local thresholds cope with uneven backgrounds (gradients, highlights)
+    // (the window must fit in the image, tiny images are left as is)
+    int windowHalfSize = std::min(8 * preprocessing.scale, (std::min(pixGetWidth(result), pixGetHeight(result)) - 3) / 2);
+    if (windowHalfSize >= 2) {
+      PIX* binarized = nullptr;
+      pixSauvolaBinarizeTiled(result, windowHalfSize, 0.35f, 1, 1, nullptr, &binarized);
+      replace(binarized);
+    }
+  }
 
-Napi::Object BuildWindowEventObject(const Napi::Env& env, const RawWindowEvent& rawWindowEvent) {
-  Napi::Object windowEventObj = Napi::Object::New(env);
-  windowEventObj.Set(Napi::String::New(env, "id"), Napi::Number::New(env, reinterpret_cast<uintptr_t>(rawWindowEvent.id)));
-  windowEventObj.Set(Napi::String::New(env, "type"), Napi::String::New(env, rawWindowEvent.type));
-  return windowEventObj;
+  return result;
 }
 
-void WindowEventProcessingThread() {
-  // Initialize XInput2 listener
-  Display* windowDisplay = GetWindowDisplay();
-  Window rootWindow = DefaultRootWindow(windowDisplay);
-  {
-    std::lock_guard<std::mutex> lock(windowEventHookMutex);
-
-    XSelectInput(
-      windowDisplay,
-      rootWindow,
-      SubstructureNotifyMask | PropertyChangeMask
-    );
+struct OcrTextMatch {
+  std::string text;
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+  float confidence;
+};
 
-    std::vector<WindowInfo> windows = ListWindows();
-    for (const WindowInfo& window : windows) {
-      // Minimization events are only available at specific window level
-      XSelectInput(
-        windowDisplay,
-        window.id,
-        PropertyChangeMask
-      );
-    }
+// Recognize an image once and walk the results, from blocks down to words.
+// Boxes are divided by the preprocessing `scale` then offset by
+// (offsetX, offsetY), e.g. to get screen coordinates.
+OcrResult RecognizeStructuredText(tesseract::TessBaseAPI& tesseract, PIX* image, int offsetX = 0, int offsetY = 0, int scale = 1) {
+  tesseract.SetImage(image);
+  if (tesseract.Recognize(nullptr) != 0) {
+    throw std::runtime_error("Failed to perform OCR on image.");
+  }
 
-    XFlush(windowDisplay);
+  OcrResult result;
+  char* text = tesseract.GetUTF8Text();
+  if (text) {
+    result.text = text;
+    delete[] text;
   }
 
-  // Previous events map used to avoid duplicate events
-  std::unordered_map<std::string, unsigned long> previousWindowEventsMap = {
-    // the key will have the following format: "eventType:isInjected:windowId"
-    // the value will be the event time
+  auto addBox = [offsetX, offsetY, scale](std::vector<int32_t>& boxes, int left, int top, int right, int bottom) {
+    boxes.insert(boxes.end(), { left / scale + offsetX, top / scale + offsetY, (right - left) / scale, (bottom - top) / scale });
+  };
+  auto trimmedText = [](char* text) {
+    std::string result = text ? text : "";
+    delete[] text;
+    while (!result.empty() && std::isspace(static_cast<unsigned char>(result.back()))) {
+      result.pop_back();
+    }
+    return result;
   };
 
-  unsigned long lastWindowEventTime = 0;
-  std::unordered_map<Window, Window> eventWindowToRealWindowMap = {};
-  Window previouslyFocusedWindow = None;
+  std::unique_ptr<tesseract::ResultIterator> iterator(tesseract.GetIterator());
+  if (!iterator || iterator->Empty(tesseract::RIL_WORD)) {
+    return result;
+  }
+  int left, top, right, bottom;
+  do {
+    if (iterator->IsAtBeginningOf(tesseract::RIL_BLOCK)) {
+      iterator->BoundingBox(tesseract::RIL_BLOCK, &left, &top, &right, &bottom);
+      addBox(result.blockBoxes, left, top, right, bottom);
+      result.blockConfidences.push_back(iterator->Confidence(tesseract::RIL_BLOCK));
+    }
+    if (iterator->IsAtBeginningOf(tesseract::RIL_TEXTLINE)) {
+      iterator->BoundingBox(tesseract::RIL_TEXTLINE, &left, &top, &right, &bottom);
+      addBox(result.lineBoxes, left, top, right, bottom);
+      result.lineConfidences.push_back(iterator->Confidence(tesseract::RIL_TEXTLINE));
+      result.lineTexts.push_back(trimmedText(iterator->GetUTF8Text(tesseract::RIL_TEXTLINE)));
+      result.lineBlocks.push_back(static_cast<int32_t>(result.blockConfidences.size()) - 1);
+    }
+    iterator->BoundingBox(tesseract::RIL_WORD, &left, &top, &right, &bottom);
+    addBox(result.wordBoxes, left, top, right, bottom);
+    result.wordConfidences.push_back(iterator->Confidence(tesseract::RIL_WORD));
+    result.wordTexts.push_back(trimmedText(iterator->GetUTF8Text(tesseract::RIL_WORD)));
+    result.wordLines.push_back(static_cast<int32_t>(result.lineConfidences.size()) - 1);
+  } while (iterator->Next(tesseract::RIL_WORD));
 
-  // Run window event processing loop
-  windowEventRunning = true;
-  windowEventHookCondition.notify_all();
-  while (windowEventRunning) {
-    XEvent event;
-    XNextEvent(windowDisplay, &event);
-    uint64_t eventTime = Now();
+  return result;
+}
 
-    if (!windowEventRunning) {
-      // Event processing thread has been stopped while waiting for an event
-      // see CleanWindowEventListener()
-      break;
-    }
+struct OcrTile {
+  int x;
+  int y;
+  int width;
+  int height;
+};
 
-    std::string eventKey = std::to_string(event.type)
-      + ":"
-      + std::to_string(event.xany.send_event)
-      + ":" // windowId will be set in switch case below
-    ;
-    std::optional<RawWindowEvent> maybeRawWindowEvent = std::nullopt;
-    switch (event.type) {
-      case CreateNotify: {
-        // Event intercepted by rootWindow with SubstructureNotifyMask
-        Window eventWindow = event.xcreatewindow.window;
-        Window realWindow = GetTopLevelWindow(eventWindow).value_or(eventWindow);
-        eventKey += std::to_string(realWindow);
-        eventWindowToRealWindowMap[eventWindow] = realWindow;
-        maybeRawWindowEvent = {
-          realWindow,
-          "create"
-        };
-        XSelectInput(windowDisplay, eventWindow, PropertyChangeMask);
-        break;
-      }
+// Cheap page segmentation: local contrast (morphological gradient) marks
+// glyph edges whatever the text and background colors, then a closing merges
+// glyphs into words, lines and paragraphs, whose bounding boxes are the tiles.
+// `scale` is the preprocessing upscale factor, to size the structuring elements.
+std::vector<OcrTile> FindOcrTextTiles(PIX* image, int scale) {
+  std::vector<OcrTile> tiles;
+  int width = pixGetWidth(image);
+  int height = pixGetHeight(image);
+
+  PIX* gray = pixConvertTo8(image, 0);
+  PIX* gradient = gray ? pixMorphGradient(gray, 3, 3, 0) : nullptr;
+  PIX* edges = gradient ? pixThresholdToBinary(gradient, 48) : nullptr;
+  if (edges) {
+    pixInvert(edges, edges); // strong edges as foreground
+  }
+  PIX* blocks = edges ? pixCloseSafeBrick(nullptr, edges, 24 * scale + 1, 8 * scale + 1) : nullptr;
+  BOXA* boxes = blocks ? pixConnCompBB(blocks, 8) : nullptr;
+  BOXA* mergedBoxes = boxes ? boxaCombineOverlaps(boxes, nullptr) : nullptr;
+  pixDestroy(&gray);
+  pixDestroy(&gradient);
+  pixDestroy(&edges);
+  pixDestroy(&blocks);
+  boxaDestroy(&boxes);
+  if (!mergedBoxes) {
+    throw std::runtime_error("Failed to segment image for OCR.");
+  }
+
+  int margin = 4 * scale;
+  for (int i = 0; i < boxaGetCount(mergedBoxes); i++) {
+    l_int32 x, y, boxWidth, boxHeight;
+    boxaGetBoxGeometry(mergedBoxes, i, &x, &y, &boxWidth, &boxHeight);
+    // Too small to hold readable text
+    if (boxWidth < 6 * scale || boxHeight < 6 * scale) continue;
+    // Aligned on the scale so that tile offsets map back to whole pixels
+    int left = std::max(0, x - margin) / scale * scale;
+    int top = std::max(0, y - margin) / scale * scale;
+    int right = std::min(width, x + boxWidth + margin);
+    int bottom = std::min(height, y + boxHeight + margin);
+    tiles.push_back({ left, top, right - left, bottom - top });
+  }
+  boxaDestroy(&mergedBoxes);
+
+  // Reading order: top to bottom, then left to right
+  std::sort(tiles.begin(), tiles.end(), [](const OcrTile& a, const OcrTile& b) {
+    return a.y != b.y ? a.y < b.y : a.x < b.x;
+  });
+  return tiles;
+}
 
-      case DestroyNotify: {
-        // event intercepted by rootWindow with SubstructureNotifyMask
-        Window eventWindow = event.xdestroywindow.window;
-        Window realWindow = eventWindowToRealWindowMap.find(eventWindow) == eventWindowToRealWindowMap.end() ? eventWindow : eventWindowToRealWindowMap[eventWindow];
-        eventKey += std::to_string(realWindow);
-        eventWindowToRealWindowMap.erase(eventWindow);
-        maybeRawWindowEvent = {
-          realWindow,
-          "destroy"
-        };
-        break;
-      }
+// Append `other` to `result`, shifting its line and block indices
+void AppendOcrResult(OcrResult& result, OcrResult&& other) {
+  if (!other.text.empty()) {
+    result.text += other.text;
+    if (result.text.back() != '\n') result.text += '\n';
+  }
+  int32_t lineOffset = static_cast<int32_t>(result.lineTexts.size());
+  int32_t blockOffset = static_cast<int32_t>(result.blockConfidences.size());
+  auto append = [](auto& destination, auto& source) {
+    destination.insert(destination.end(), std::make_move_iterator(source.begin()), std::make_move_iterator(source.end()));
+  };
+  for (int32_t& line : other.wordLines) line += lineOffset;
+  for (int32_t& block : other.lineBlocks) block += blockOffset;
+  append(result.wordTexts, other.wordTexts);
+  append(result.wordBoxes, other.wordBoxes);
+  append(result.wordConfidences, other.wordConfidences);
+  append(result.wordLines, other.wordLines);
+  append(result.lineTexts, other.lineTexts);
+  append(result.lineBoxes, other.lineBoxes);
+  append(result.lineConfidences, other.lineConfidences);
+  append(result.lineBlocks, other.lineBlocks);
+  append(result.blockBoxes, other.blockBoxes);
+  append(result.blockConfidences, other.blockConfidences);
+}
+
+// Split the image into text tiles and recognize them in parallel, each thread
+// owning its Tesseract instance. Results are merged in reading order.
+// A thread count of 0 uses all cores.
+OcrResult RecognizeStructuredTextInParallel(
+  PIX* image,
+  const OcrProfile& profile,
+  unsigned int threadCount,
+  int offsetX = 0,
+  int offsetY = 0,
+  int scale = 1
+) {
+  std::vector<OcrTile> tiles = FindOcrTextTiles(image, scale);
+  std::vector<OcrResult> tileResults(tiles.size());
+  if (threadCount == 0) {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threadCount = std::min<unsigned int>(threadCount, static_cast<unsigned int>(tiles.size()));
 
-      case PropertyNotify: {
-        if (event.xproperty.atom == GetAtom("_NET_ACTIVE_WINDOW")) {
-          // focus event intercepted by rootWindow with PropertyChangeMask
-          Window eventWindow = GetWindowProperty<Window>(rootWindow, GetAtom("_NET_ACTIVE_WINDOW"), XA_WINDOW)[0];
-          if (eventWindow == None) {
-            // No window is focused. Usually happens on Wayland or WSLg when
-            // a non-X11 window is focused
-            break;
+  std::atomic<size_t> nextTile{0};
+  std::exception_ptr error;
+  std::mutex errorMutex;
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < threadCount; i++) {
+    threads.emplace_back([&]() {
+      try {
+        OcrEnginePool::Lease tesseract = ocrEnginePool.acquire(profile);
+        for (size_t tileIndex = nextTile++; tileIndex < tiles.size(); tileIndex = nextTile++) {
+          const OcrTile& tile = tiles[tileIndex];
+          BOX* box = boxCreate(tile.x, tile.y, tile.width, tile.height);
+          PIX* tileImage = pixClipRectangle(image, box, nullptr);
+          boxDestroy(&box);
+          if (!tileImage) continue;
+          try {
+            tileResults[tileIndex] = RecognizeStructuredText(*tesseract, tileImage, offsetX + tile.x / scale, offsetY + tile.y / scale, scale);
           }
-          Window realWindow = eventWindowToRealWindowMap.find(eventWindow) == eventWindowToRealWindowMap.end() ? GetTopLevelWindow(eventWindow).value_or(eventWindow) : eventWindowToRealWindowMap[eventWindow];
-          if (realWindow == previouslyFocusedWindow) {
-            // Prevent duplicate focus events
-            break;
+          catch (...) {
+            pixDestroy(&tileImage);
+            throw;
           }
-          previouslyFocusedWindow = realWindow;
-          eventKey += std::to_string(realWindow);
-          eventWindowToRealWindowMap[eventWindow] = realWindow;
-          maybeRawWindowEvent = {
-            realWindow,
-            "focus"
-          };
-        }
-        else if (event.xproperty.atom == GetAtom("_NET_WM_STATE")) {
-          // minimization, restoration or maximization event intercepted
-          // by target top-level window with PropertyChangeMask
-          Window eventWindow = event.xproperty.window;
-          Window realWindow = eventWindowToRealWindowMap.find(eventWindow) == eventWindowToRealWindowMap.end() ? GetTopLevelWindow(eventWindow).value_or(eventWindow) : eventWindowToRealWindowMap[eventWindow];
-          eventKey += std::to_string(realWindow);
-          eventWindowToRealWindowMap[eventWindow] = realWindow;
-          maybeRawWindowEvent = {
-            realWindow,
-            "locationchange"
-          };
+          pixDestroy(&tileImage);
         }
-        break;
       }
+      catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = std::current_exception();
+        // Let the other threads stop early
+        nextTile = tiles.size();
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
 
-      case ConfigureNotify: {
-        // event intercepted by rootWindow with SubstructureNotifyMask
-        Window eventWindow = event.xconfigure.window;
-        Window realWindow = eventWindowToRealWindowMap.find(eventWindow) == eventWindowToRealWindowMap.end() ? GetTopLevelWindow(eventWindow).value_or(eventWindow) : eventWindowToRealWindowMap[eventWindow];
-        eventKey += std::to_string(realWindow);
-        eventWindowToRealWindowMap[eventWindow] = realWindow;
-        maybeRawWindowEvent = {
-          realWindow,
-          "locationchange"
-        };
-        break;
+  OcrResult result;
+  for (OcrResult& tileResult : tileResults) {
+    AppendOcrResult(result, std::move(tileResult));
+  }
+  return result;
+}
+
+// Recognize a preprocessed image on a single Tesseract instance, or tile it
+// over `threadCount` instances when it is not 1
+OcrResult RecognizeOcrImage(
+  PIX* image,
+  const OcrProfile& profile,
+  unsigned int threadCount,
+  int offsetX = 0,
+  int offsetY = 0,
+  int scale = 1
+) {
+  if (threadCount != 1) {
+    return RecognizeStructuredTextInParallel(image, profile, threadCount, offsetX, offsetY, scale);
+  }
+  OcrEnginePool::Lease tesseract = ocrEnginePool.acquire(profile);
+  return RecognizeStructuredText(*tesseract, image, offsetX, offsetY, scale);
+}
+
+std::string ToLowerAscii(std::string text) {
+  for (char& character : text) {
+    if (character >= 'A' && character <= 'Z') {
+      character = static_cast<char>(character - 'A' + 'a');
+    }
+  }
+  return text;
+}
+
+// Letters, digits and any byte of a multi-byte UTF-8 character
+bool IsOcrWordCharacter(char character) {
+  unsigned char byte = static_cast<unsigned char>(character);
+  return byte >= 0x80 || std::isalnum(byte);
+}
+
+// Find the word spans of each line containing `query` (whitespace insensitive).
+// With `isWholeWords`, the query must not start nor end inside a word, so that
+// "cat" does not match "concatenate".
+std::vector<OcrTextMatch> FindTextInOcrResult(const OcrResult& ocrResult, const std::string& query, bool isCaseSensitive, bool isWholeWords) {
+  // Normalize the query to single-space separated words
+  std::string normalizedQuery;
+  std::istringstream queryStream(isCaseSensitive ? query : ToLowerAscii(query));
+  for (std::string queryWord; queryStream >> queryWord; ) {
+    normalizedQuery += (normalizedQuery.empty() ? "" : " ") + queryWord;
+  }
+  std::vector<OcrTextMatch> matches;
+  if (normalizedQuery.empty()) {
+    return matches;
+  }
+
+  size_t wordCount = ocrResult.wordTexts.size();
+  for (size_t lineStart = 0; lineStart < wordCount; ) {
+    size_t lineEnd = lineStart;
+    while (lineEnd < wordCount && ocrResult.wordLines[lineEnd] == ocrResult.wordLines[lineStart]) {
+      lineEnd++;
+    }
+
+    // Join the line words, remembering where each one starts
+    std::string lineText;
+    std::vector<size_t> wordOffsets;
+    for (size_t word = lineStart; word < lineEnd; word++) {
+      if (!lineText.empty()) lineText += ' ';
+      wordOffsets.push_back(lineText.size());
+      lineText += isCaseSensitive ? ocrResult.wordTexts[word] : ToLowerAscii(ocrResult.wordTexts[word]);
+    }
+
+    for (size_t position = lineText.find(normalizedQuery); position != std::string::npos; position = lineText.find(normalizedQuery, position + 1)) {
+      size_t end = position + normalizedQuery.size();
+      if (
+        isWholeWords && (
+          (position > 0 && IsOcrWordCharacter(lineText[position - 1]) && IsOcrWordCharacter(normalizedQuery.front()))
+          || (end < lineText.size() && IsOcrWordCharacter(lineText[end]) && IsOcrWordCharacter(normalizedQuery.back()))
+        )
+      ) {
+        continue;
+      }
+      size_t firstWord = std::upper_bound(wordOffsets.begin(), wordOffsets.end(), position) - wordOffsets.begin() - 1;
+      size_t lastWord = std::upper_bound(wordOffsets.begin(), wordOffsets.end(), position + normalizedQuery.size() - 1) - wordOffsets.begin() - 1;
+
+      int32_t left = INT32_MAX, top = INT32_MAX, right = INT32_MIN, bottom = INT32_MIN;
+      float confidence = 100.0f;
+      std::string text;
+      for (size_t word = lineStart + firstWord; word <= lineStart + lastWord; word++) {
+        const int32_t* box = &ocrResult.wordBoxes[word * 4];
+        left = std::min(left, box[0]);
+        top = std::min(top, box[1]);
+        right = std::max(right, box[0] + box[2]);
+        bottom = std::max(bottom, box[1] + box[3]);
+        confidence = std::min(confidence, ocrResult.wordConfidences[word]);
+        text += (text.empty() ? "" : " ") + ocrResult.wordTexts[word];
       }
+      matches.push_back({ text, left, top, right - left, bottom - top, confidence });
+    }
+    lineStart = lineEnd;
+  }
 
-      default:
-        // Ignore other events. It shouldn't happen as we only listen to the
-        // specific events above (see XSelectInput).
-        break;
+  std::stable_sort(matches.begin(), matches.end(), [](const OcrTextMatch& a, const OcrTextMatch& b) {
+    return a.confidence > b.confidence;
+  });
+  return matches;
+}
+
+// Convert packed BGRA pixels to a 32bpp PIX
+PIX* BgraToPix(const uint8_t* pixels, int width, int height, size_t stride) {
+  PIX* pix = pixCreate(width, height, 32);
+  if (!pix) {
+    throw std::runtime_error("Failed to allocate image.");
+  }
+  l_uint32* data = pixGetData(pix);
+  int wordsPerLine = pixGetWpl(pix);
+  for (int y = 0; y < height; y++) {
+    const uint8_t* row = pixels + y * stride;
+    l_uint32* line = data + y * wordsPerLine;
+    for (int x = 0; x < width; x++) {
+      line[x] = (static_cast<l_uint32>(row[x * 4 + 2]) << 24)
+        | (static_cast<l_uint32>(row[x * 4 + 1]) << 16)
+        | (static_cast<l_uint32>(row[x * 4 + 0]) << 8)
+        | 0xff;
     }
+  }
+  return pix;
+}
 
-    // Clear outdated previous events
-    if (eventTime > lastWindowEventTime) {
-      previousWindowEventsMap.clear();
-      lastWindowEventTime = eventTime;
+// Recognize the text only, without walking the layout
+std::string RecognizeText(tesseract::TessBaseAPI& tesseract, PIX* image) {
+  tesseract.SetImage(image);
+  char* text = tesseract.GetUTF8Text();
+  if (!text) {
+    throw std::runtime_error("Failed to perform OCR on image.");
+  }
+  std::string result(text);
+  delete[] text;
+  return result;
+}
+
+// Fast non-cryptographic hash of the pixels (and colormap) of an image, row
+// padding excluded
+uint64_t HashPixels(PIX* image) {
+  pixSetPadBits(image, 0);
+  l_int32 width, height, depth;
+  pixGetDimensions(image, &width, &height, &depth);
+  const l_uint32* data = pixGetData(image);
+  int wordsPerLine = pixGetWpl(image);
+  size_t rowWords = (static_cast<size_t>(width) * depth + 31) / 32;
+
+  const uint64_t prime = 0x9e3779b97f4a7c15ULL;
+  uint64_t hash = ((static_cast<uint64_t>(width) << 32) | static_cast<uint32_t>(height)) * prime ^ static_cast<uint64_t>(depth);
+  auto mix = [&hash, prime](uint64_t value) {
+    hash = (hash ^ value) * prime;
+    hash ^= hash >> 32;
+  };
+  for (int y = 0; y < height; y++) {
+    const l_uint32* row = data + static_cast<size_t>(y) * wordsPerLine;
+    size_t i = 0;
+    for (; i + 2 <= rowWords; i += 2) {
+      uint64_t value;
+      std::memcpy(&value, row + i, sizeof(value));
+      mix(value);
     }
-    else if (previousWindowEventsMap.find(eventKey) != previousWindowEventsMap.end()) {
-      // Ignore duplicate events
-      continue;
+    if (i < rowWords) {
+      mix(row[i]);
     }
+  }
+  // Colormapped pixels are palette indices: identical indices with another
+  // palette are another image
+  if (PIXCMAP* colormap = pixGetColormap(image)) {
+    int colorCount = pixcmapGetCount(colormap);
+    mix(static_cast<uint64_t>(colorCount) << 32);
+    for (int index = 0; index < colorCount; index++) {
+      l_int32 red, green, blue, alpha;
+      pixcmapGetRGBA(colormap, index, &red, &green, &blue, &alpha);
+      mix((static_cast<uint64_t>(red) << 24) | (green << 16) | (blue << 8) | alpha);
+    }
+  }
+  return hash;
+}
 
-    // Send window event to JavaScript
-    if (maybeRawWindowEvent) {
-      RawWindowEvent rawWindowEvent = maybeRawWindowEvent.value();
-      windowEventThreadSafeJsFunction.BlockingCall([rawWindowEvent](const Napi::Env& env, const Napi::Function& jsCallback) {
-        if (!jsCallback.IsEmpty()) {
-          jsCallback.Call({ BuildWindowEventObject(env, rawWindowEvent) });
-        }
-      });
-      previousWindowEventsMap[eventKey] = eventTime;
+// Shift every box of an OCR result
+void OffsetOcrResult(OcrResult& result, int offsetX, int offsetY) {
+  if (offsetX == 0 && offsetY == 0) {
+    return;
+  }
+  for (std::vector<int32_t>* boxes : { &result.wordBoxes, &result.lineBoxes, &result.blockBoxes }) {
+    for (size_t i = 0; i + 1 < boxes->size(); i += 4) {
+      (*boxes)[i] += offsetX;
+      (*boxes)[i + 1] += offsetY;
     }
   }
+}
 
-  // Unregister all previously selected window events
-  // Passing an empty mask removes our raw window event subscription
-  // from the root window
-  {
-    std::lock_guard<std::mutex> lock(windowEventHookMutex);
+// Preprocess and recognize `source`, unless identical pixels were recently
+// recognized with the same settings. Results are cached without offset, so
+// that a moved area still hits, then shifted by (offsetX, offsetY).
+// With `isTextOnly`, single threaded recognition skips the layout walk and
+// only fills the result text.
+OcrResult RecognizeOcrImageCached(
+  PIX* source,
+  const OcrProfile& profile,
+  const OcrPreprocessing& preprocessing,
+  unsigned int threadCount,
+  bool isTextOnly,
+  int offsetX = 0,
+  int offsetY = 0
+) {
+  // Tiling does not depend on the thread count, only on whether it is used
+  bool isTiled = threadCount != 1;
+  std::ostringstream keyStream;
+  keyStream << std::hex << HashPixels(source) << std::dec
+    << ':' << pixGetWidth(source) << 'x' << pixGetHeight(source) << 'x' << pixGetDepth(source)
+    << ':' << profile.key()
+    << ':' << preprocessing.isGrayscale << static_cast<int>(preprocessing.inversion) << preprocessing.scale << static_cast<int>(preprocessing.binarization)
+    << ':' << (isTiled ? "tiled" : "whole") << (isTextOnly && !isTiled ? ":text" : "");
+  std::string key = keyStream.str();
+
+  std::optional<OcrResult> cachedResult = ocrResultCache.get(key);
+  OcrResult result;
+  if (cachedResult) {
+    result = std::move(*cachedResult);
+  }
+  else {
+    PIX* image = PreprocessOcrImage(source, preprocessing);
+    try {
+      if (isTextOnly && !isTiled) {
+        OcrEnginePool::Lease tesseract = ocrEnginePool.acquire(profile);
+        result.text = RecognizeText(*tesseract, image);
+      }
+      else {
+        result = RecognizeOcrImage(image, profile, threadCount, 0, 0, preprocessing.scale);
+      }
+    }
+    catch (...) {
+      pixDestroy(&image);
+      throw;
+    }
+    pixDestroy(&image);
+    ocrResultCache.put(key, result);
+  }
+  OffsetOcrResult(result, offsetX, offsetY);
+  return result;
+}
 
-    // Unregister all previously selected window events
-    XSelectInput(
-      windowDisplay,
-      rootWindow,
-      NoEventMask
-    );
+// Recognize an image file, through the OCR result cache
+OcrResult PerformCachedOcrOnImage(
+  const std::string& imagePath,
+  const OcrProfile& profile,
+  const OcrPreprocessing& preprocessing,
+  unsigned int threadCount,
+  bool isTextOnly
+) {
+  PIX* image = pixRead(imagePath.c_str());
+  if (!image) {
+    throw std::runtime_error("Failed to load image " + imagePath);
+  }
+  try {
+    OcrResult result = RecognizeOcrImageCached(image, profile, preprocessing, threadCount, isTextOnly);
+    pixDestroy(&image);
+    return result;
+  }
+  catch (...) {
+    pixDestroy(&image);
+    throw;
+  }
+}
 
-    std::vector<WindowInfo> windows = ListWindows();
-    for (const WindowInfo& window : windows) {
-      XSelectInput(
-        windowDisplay,
-        window.id,
-        NoEventMask
-      );
+std::string PerformOcrOnImage(
+  const std::string& imagePath,
+  const OcrProfile& profile = {},
+  const OcrPreprocessing& preprocessing = {},
+  unsigned int threadCount = 1
+) {
+  return PerformCachedOcrOnImage(imagePath, profile, preprocessing, threadCount, true).text;
+}
+
+OcrResult PerformStructuredOcrOnImage(
+  const std::string& imagePath,
+  const OcrProfile& profile = {},
+  const OcrPreprocessing& preprocessing = {},
+  unsigned int threadCount = 1
+) {
+  return PerformCachedOcrOnImage(imagePath, profile, preprocessing, threadCount, false);
+}
+
+// OCR a screen area in memory and find the occurrences of `query`, in screen coordinates
+std::vector<OcrTextMatch> FindTextOnScreen(
+  const std::string& query,
+  int x,
+  int y,
+  int width,
+  int height,
+  const OcrProfile& profile,
+  bool isCaseSensitive,
+  bool isWholeWords,
+  const OcrPreprocessing& preprocessing,
+  unsigned int threadCount
+) {
+  ScreenFrameSource source(0, x, y, width, height);
+  source.attachToCurrentThread();
+  std::vector<uint8_t> pixels(source.stride() * source.height());
+  if (!source.grab(pixels.data())) {
+    throw std::runtime_error("Failed to capture the screen.");
+  }
+  PIX* capture = BgraToPix(pixels.data(), source.width(), source.height(), source.stride());
+  pixels = {};
+  try {
+    OcrResult ocrResult = RecognizeOcrImageCached(capture, profile, preprocessing, threadCount, false, source.x(), source.y());
+    pixDestroy(&capture);
+    return FindTextInOcrResult(ocrResult, query, isCaseSensitive, isWholeWords);
+  }
+  catch (...) {
+    pixDestroy(&capture);
+    throw;
+  }
+}
+
+// Read the optional `preprocessing` options of an OCR call. Throws a JS
+// TypeError and returns false when they are invalid.
+bool ParseOcrPreprocessing(Napi::Env env, Napi::Value value, OcrPreprocessing& preprocessing) {
+  if (value.IsUndefined() || value.IsNull()) {
+    return true;
+  }
+  if (!value.IsObject()) {
+    Napi::TypeError::New(env, "OCR preprocessing options must be an object").ThrowAsJavaScriptException();
+    return false;
+  }
+  Napi::Object options = value.As<Napi::Object>();
+
+  preprocessing.isGrayscale = options.Get("grayscale").IsBoolean() && options.Get("grayscale").As<Napi::Boolean>().Value();
+
+  Napi::Value invert = options.Get("invert");
+  if (invert.IsBoolean()) {
+    preprocessing.inversion = invert.As<Napi::Boolean>().Value() ? OcrInversion::Always : OcrInversion::None;
+  }
+  else if (invert.IsString() && invert.As<Napi::String>().Utf8Value() == "auto") {
+    preprocessing.inversion = OcrInversion::Auto;
+  }
+  else if (!invert.IsUndefined()) {
+    Napi::TypeError::New(env, "OCR preprocessing \"invert\" must be a boolean or \"auto\"").ThrowAsJavaScriptException();
+    return false;
+  }
+
+  Napi::Value scale = options.Get("scale");
+  if (!scale.IsUndefined()) {
+    double scaleValue = scale.IsNumber() ? scale.As<Napi::Number>().DoubleValue() : 0;
+    if (scaleValue < 1 || scaleValue > 8 || scaleValue != std::floor(scaleValue)) {
+      Napi::TypeError::New(env, "OCR preprocessing \"scale\" must be an integer between 1 and 8").ThrowAsJavaScriptException();
+      return false;
     }
+    preprocessing.scale = static_cast<int>(scaleValue);
+  }
 
-    XFlush(windowDisplay);
+  Napi::Value binarize = options.Get("binarize");
+  std::string binarization = binarize.IsString() ? binarize.As<Napi::String>().Utf8Value() : "";
+  if (binarization == "otsu") {
+    preprocessing.binarization = OcrBinarization::Otsu;
+  }
+  else if (binarization == "sauvola") {
+    preprocessing.binarization = OcrBinarization::Sauvola;
   }
+  else if (!binarize.IsUndefined()) {
+    Napi::TypeError::New(env, "OCR preprocessing \"binarize\" must be \"otsu\" or \"sauvola\"").ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
 }
 
-Napi::Value StartWindowEventListener(const Napi::CallbackInfo& info) {
+// Read the optional OCR thread count: 1 by default, 0 for all cores. Throws a
+// JS TypeError and returns false when it is invalid.
+bool ParseOcrThreadCount(Napi::Env env, Napi::Value value, unsigned int& threadCount) {
+  if (value.IsUndefined() || value.IsNull()) {
+    return true;
+  }
+  double threads = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+  if (threads < 0 || threads > 256 || threads != std::floor(threads)) {
+    Napi::TypeError::New(env, "OCR \"threads\" must be an integer between 0 and 256").ThrowAsJavaScriptException();
+    return false;
+  }
+  threadCount = static_cast<unsigned int>(threads);
+  return true;
+}
+
+Napi::Value PerformOcrOnImageWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  // Skip if already listening
-  if (windowEventRunning) {
-    return Napi::Boolean::New(env, true);
+  // Validate arguments
+  if (info.Length() < 1) {
+    Napi::TypeError::New(env, "Expected a string argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the second argument").ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  // Validate arguments
-  if (info.Length() < 1 || !info[0].IsFunction()) {
-    Napi::TypeError::New(env, "Expected a callback function").ThrowAsJavaScriptException();
+  // Translata JS input to C++ input
+  std::string utf8ImagePath = info[0].As<Napi::String>().Utf8Value();
+  std::string imagePath = utf8ImagePath;
+  std::string utf8Language = info.Length() > 1 && !info[1].IsUndefined() ? info[1].As<Napi::String>().Utf8Value() : std::string();
+  std::string language = utf8Language;
+  OcrPreprocessing preprocessing;
+  if (info.Length() > 2 && !ParseOcrPreprocessing(env, info[2], preprocessing)) {
+    return env.Null();
+  }
+  unsigned int threadCount = 1;
+  if (info.Length() > 3 && !ParseOcrThreadCount(env, info[3], threadCount)) {
     return env.Null();
   }
+  // Perform OCR on the image
+  try {
+    std::string extractedText = PerformOcrOnImage(imagePath, ResolveOcrProfile(language), preprocessing, threadCount);
+    std::string utf8ExtractedText = extractedText;
 
-  // Convert JS callback to a NAPI ThreadSafeFunction
-  windowEventThreadSafeJsFunction = Napi::ThreadSafeFunction::New(
-    env, // the main NAPI environment
-    info[0].As<Napi::Function>(), // callback function that needs to be called in thread(s)
-    "callback", // JS string used to provide diagnostic information
-    0, // maximum queue size (0 for unlimited)
-    1, // initial number of threads which will be making use of this function
-    [](const Napi::Env& env) { // finalizer callback, can be used to clean threads up
+    // Return the extracted text
+    return Napi::String::New(env, utf8ExtractedText);
+  }
+  catch (const std::exception& ex) {
+    Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Object OcrResultToJs(Napi::Env env, const OcrResult& ocrResult) {
+  auto toStrings = [&env](const std::vector<std::string>& values) {
+    Napi::Array result = Napi::Array::New(env, values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      result.Set(i, Napi::String::New(env, values[i]));
     }
-  );
+    return result;
+  };
+  auto toInt32Array = [&env](const std::vector<int32_t>& values) {
+    Napi::Int32Array result = Napi::Int32Array::New(env, values.size());
+    std::copy(values.begin(), values.end(), result.Data());
+    return result;
+  };
+  auto toFloat32Array = [&env](const std::vector<float>& values) {
+    Napi::Float32Array result = Napi::Float32Array::New(env, values.size());
+    std::copy(values.begin(), values.end(), result.Data());
+    return result;
+  };
 
-  // Start event processing thread
-  windowEventThread = std::thread(WindowEventProcessingThread);
-  {
-    std::unique_lock<std::mutex> lock(windowEventHookMutex);
-    windowEventHookCondition.wait(lock, [] { return windowEventRunning.load(); });
-  }
-  return Napi::Boolean::New(env, true);
+  Napi::Object words = Napi::Object::New(env);
+  words.Set("text", toStrings(ocrResult.wordTexts));
+  words.Set("boxes", toInt32Array(ocrResult.wordBoxes));
+  words.Set("confidences", toFloat32Array(ocrResult.wordConfidences));
+  words.Set("lines", toInt32Array(ocrResult.wordLines));
+
+  Napi::Object lines = Napi::Object::New(env);
+  lines.Set("text", toStrings(ocrResult.lineTexts));
+  lines.Set("boxes", toInt32Array(ocrResult.lineBoxes));
+  lines.Set("confidences", toFloat32Array(ocrResult.lineConfidences));
+  lines.Set("blocks", toInt32Array(ocrResult.lineBlocks));
+
+  Napi::Object blocks = Napi::Object::New(env);
+  blocks.Set("boxes", toInt32Array(ocrResult.blockBoxes));
+  blocks.Set("confidences", toFloat32Array(ocrResult.blockConfidences));
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("text", Napi::String::New(env, ocrResult.text));
+  result.Set("words", words);
+  result.Set("lines", lines);
+  result.Set("blocks", blocks);
+  return result;
 }
 
-Napi::Value StopWindowEventListener(const Napi::CallbackInfo& info) {
+Napi::Value PerformStructuredOcrOnImageWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  try {
-    CleanWindowEventListener();
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
   }
-  catch (const std::exception& e) {
-    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the second argument").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  return Napi::Boolean::New(env, true);
+  // Translate JS input to C++ input
+  std::string imagePath = info[0].As<Napi::String>().Utf8Value();
+  std::string language = info.Length() > 1 && !info[1].IsUndefined() ? info[1].As<Napi::String>().Utf8Value() : std::string();
+
+  OcrPreprocessing preprocessing;
+  if (info.Length() > 2 && !ParseOcrPreprocessing(env, info[2], preprocessing)) {
+    return env.Null();
+  }
+  unsigned int threadCount = 1;
+  if (info.Length() > 3 && !ParseOcrThreadCount(env, info[3], threadCount)) {
+    return env.Null();
+  }
+
+  try {
+    return OcrResultToJs(env, PerformStructuredOcrOnImage(imagePath, ResolveOcrProfile(language), preprocessing, threadCount));
+  }
+  catch (const std::exception& ex) {
+    Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
 }
 
+Napi::Value FindTextOnScreenWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Arguments must be: (query, options)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[1].As<Napi::Object>();
+  if (!options.Get("x").IsNumber() || !options.Get("y").IsNumber() || !options.Get("width").IsNumber() || !options.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "Options must contain: x, y, width, height").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input to C++ input
+  std::string query = info[0].As<Napi::String>().Utf8Value();
+  int x = options.Get("x").As<Napi::Number>().Int32Value();
+  int y = options.Get("y").As<Napi::Number>().Int32Value();
+  int width = options.Get("width").As<Napi::Number>().Int32Value();
+  int height = options.Get("height").As<Napi::Number>().Int32Value();
+  OcrProfile profile = ResolveOcrProfile(options.Get("language").IsString() ? options.Get("language").As<Napi::String>().Utf8Value() : std::string());
+  bool isCaseSensitive = options.Get("caseSensitive").IsBoolean() && options.Get("caseSensitive").As<Napi::Boolean>().Value();
+  bool isWholeWords = !options.Get("wholeWords").IsBoolean() || options.Get("wholeWords").As<Napi::Boolean>().Value();
+  OcrPreprocessing preprocessing;
+  if (!ParseOcrPreprocessing(env, options.Get("preprocessing"), preprocessing)) {
+    return env.Null();
+  }
+  unsigned int threadCount = 1;
+  if (!ParseOcrThreadCount(env, options.Get("threads"), threadCount)) {
+    return env.Null();
+  }
+
+  // Capture and OCR off the main thread
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<std::vector<OcrTextMatch>>(
+    env,
+    deferred,
+    [query, x, y, width, height, profile, isCaseSensitive, isWholeWords, preprocessing, threadCount]() -> std::vector<OcrTextMatch> {
+      return FindTextOnScreen(query, x, y, width, height, profile, isCaseSensitive, isWholeWords, preprocessing, threadCount);
+    },
+    [](Napi::Env env, const std::vector<OcrTextMatch>& matches) -> Napi::Value {
+      Napi::Array result = Napi::Array::New(env, matches.size());
+      for (size_t i = 0; i < matches.size(); i++) {
+        Napi::Object jsMatch = Napi::Object::New(env);
+        jsMatch.Set("text", Napi::String::New(env, matches[i].text));
+        jsMatch.Set("x", Napi::Number::New(env, matches[i].x));
+        jsMatch.Set("y", Napi::Number::New(env, matches[i].y));
+        jsMatch.Set("width", Napi::Number::New(env, matches[i].width));
+        jsMatch.Set("height", Napi::Number::New(env, matches[i].height));
+        jsMatch.Set("confidence", Napi::Number::New(env, matches[i].confidence));
+        result.Set(i, jsMatch);
+      }
+      return result;
+    }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
+}
 
-// =============================================================================
-// =============================== TIME FUNCTIONS ==============================
-// =============================================================================
+Napi::Value GetOcrCacheStatsWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  OcrResultCache::Stats stats = ocrResultCache.stats();
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+  result.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+  result.Set("size", Napi::Number::New(env, static_cast<double>(stats.size)));
+  result.Set("capacity", Napi::Number::New(env, static_cast<double>(stats.capacity)));
+  return result;
+}
 
-// Function to synchronously sleep for a given number of milliseconds
-Napi::Value SleepWrapper(const Napi::CallbackInfo& info) {
+Napi::Value SetOcrCacheCapacityWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   // Validate arguments
   if (info.Length() < 1 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Expected a number argument").ThrowAsJavaScriptException();
+    Napi::TypeError::New(env, "Expected a number as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  double capacity = info[0].As<Napi::Number>().DoubleValue();
+  if (capacity < 0 || capacity != std::floor(capacity)) {
+    Napi::TypeError::New(env, "OCR cache capacity must be a positive integer or 0").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  int milliseconds = info[0].As<Napi::Number>().Int32Value();
-
-  // Sleep for the specified number of milliseconds
-  std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
-
+  ocrResultCache.resize(static_cast<size_t>(capacity));
   return env.Undefined();
 }
 
+Napi::Value ClearOcrCacheWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ocrResultCache.clear();
+  return env.Undefined();
+}
 
-// =============================================================================
-// =============================== OCR FUNCTIONS ===============================
-// =============================================================================
-
-std::string PerformOcrOnImage(const std::string& imagePath, const std::string& language = "") {
-  // Load image
-  PIX* image = pixRead(imagePath.c_str());
-
-  if (!image) {
-    throw std::runtime_error("Failed to load image " + imagePath);
+// Read the options of an OCR profile. Throws a JS TypeError and returns false
+// when they are invalid.
+bool ParseOcrProfile(Napi::Env env, Napi::Object options, OcrProfile& profile) {
+  Napi::Value language = options.Get("language");
+  if (language.IsString()) {
+    profile.language = language.As<Napi::String>().Utf8Value();
   }
-
-  // Create Tesseract API instance
-  tesseract::TessBaseAPI tesseract;
-
-  // Get trained data assets folder
-  std::string trainedDataAbsolutePath = (GetUserDataAbsoluteDirectoryPath() / "ocr")
-    .lexically_normal()
-    .string();
-
-  // Initialize Tesseract
-  if (tesseract.Init(trainedDataAbsolutePath.c_str(), !language.empty() ? language.c_str() : "eng") != 0) {
-    pixDestroy(&image);
-    throw std::runtime_error("Failed to initialize Tesseract with language: " + (!language.empty() ? language : "eng"));
+  else if (!language.IsUndefined()) {
+    Napi::TypeError::New(env, "OCR profile \"language\" must be a string").ThrowAsJavaScriptException();
+    return false;
   }
 
-  // Set image
-  tesseract.SetImage(image);
-
-  // Perform OCR
-  char* text = tesseract.GetUTF8Text();
+  static const std::map<std::string, tesseract::PageSegMode> pageSegmentationModes = {
+    { "auto", tesseract::PSM_AUTO },
+    { "auto-osd", tesseract::PSM_AUTO_OSD },
+    { "auto-only", tesseract::PSM_AUTO_ONLY },
+    { "single-column", tesseract::PSM_SINGLE_COLUMN },
+    { "single-block-vertical", tesseract::PSM_SINGLE_BLOCK_VERT_TEXT },
+    { "single-block", tesseract::PSM_SINGLE_BLOCK },
+    { "single-line", tesseract::PSM_SINGLE_LINE },
+    { "single-word", tesseract::PSM_SINGLE_WORD },
+    { "circle-word", tesseract::PSM_CIRCLE_WORD },
+    { "single-char", tesseract::PSM_SINGLE_CHAR },
+    { "sparse-text", tesseract::PSM_SPARSE_TEXT },
+    { "sparse-text-osd", tesseract::PSM_SPARSE_TEXT_OSD },
+    { "raw-line", tesseract::PSM_RAW_LINE },
+  };
+  Napi::Value pageSegmentationMode = options.Get("pageSegmentationMode");
+  if (!pageSegmentationMode.IsUndefined()) {
+    auto mode = pageSegmentationMode.IsString() ? pageSegmentationModes.find(pageSegmentationMode.As<Napi::String>().Utf8Value()) : pageSegmentationModes.end();
+    if (mode == pageSegmentationModes.end()) {
+      Napi::TypeError::New(env, "Unknown OCR profile \"pageSegmentationMode\"").ThrowAsJavaScriptException();
+      return false;
+    }
+    profile.pageSegmentationMode = mode->second;
+  }
 
-  if (!text) {
-    tesseract.End();
-    pixDestroy(&image);
-    throw std::runtime_error("Failed to perform OCR on image " + imagePath);
+  static const std::map<std::string, tesseract::OcrEngineMode> engineModes = {
+    { "default", tesseract::OEM_DEFAULT },
+    { "lstm", tesseract::OEM_LSTM_ONLY },
+    { "legacy", tesseract::OEM_TESSERACT_ONLY },
+    { "combined", tesseract::OEM_TESSERACT_LSTM_COMBINED },
+  };
+  Napi::Value engineMode = options.Get("engineMode");
+  if (!engineMode.IsUndefined()) {
+    auto mode = engineMode.IsString() ? engineModes.find(engineMode.As<Napi::String>().Utf8Value()) : engineModes.end();
+    if (mode == engineModes.end()) {
+      Napi::TypeError::New(env, "OCR profile \"engineMode\" must be \"default\", \"lstm\", \"legacy\" or \"combined\"").ThrowAsJavaScriptException();
+      return false;
+    }
+    profile.engineMode = mode->second;
   }
 
-  // Copy result
-  std::string result(text);
+  for (const char* name : { "whitelist", "blacklist" }) {
+    Napi::Value characters = options.Get(name);
+    if (!characters.IsUndefined() && !characters.IsString()) {
+      Napi::TypeError::New(env, std::string("OCR profile \"") + name + "\" must be a string").ThrowAsJavaScriptException();
+      return false;
+    }
+  }
+  profile.whitelist = options.Get("whitelist").IsString() ? options.Get("whitelist").As<Napi::String>().Utf8Value() : std::string();
+  profile.blacklist = options.Get("blacklist").IsString() ? options.Get("blacklist").As<Napi::String>().Utf8Value() : std::string();
 
-  // Cleanup
-  delete[] text;
-  tesseract.End();
-  pixDestroy(&image);
+  Napi::Value dpi = options.Get("dpi");
+  if (!dpi.IsUndefined()) {
+    double dpiValue = dpi.IsNumber() ? dpi.As<Napi::Number>().DoubleValue() : 0;
+    if (dpiValue < 70 || dpiValue > 2400 || dpiValue != std::floor(dpiValue)) {
+      Napi::TypeError::New(env, "OCR profile \"dpi\" must be an integer between 70 and 2400").ThrowAsJavaScriptException();
+      return false;
+    }
+    profile.dpi = static_cast<int>(dpiValue);
+  }
 
-  return result;
+  Napi::Value variables = options.Get("variables");
+  if (variables.IsObject()) {
+    Napi::Object variablesObject = variables.As<Napi::Object>();
+    Napi::Array names = variablesObject.GetPropertyNames();
+    for (uint32_t i = 0; i < names.Length(); i++) {
+      std::string name = names.Get(i).As<Napi::String>().Utf8Value();
+      Napi::Value value = variablesObject.Get(name);
+      if (value.IsBoolean()) {
+        profile.variables[name] = value.As<Napi::Boolean>().Value() ? "1" : "0";
+      }
+      else if (value.IsNumber() || value.IsString()) {
+        profile.variables[name] = value.ToString().Utf8Value();
+      }
+      else {
+        Napi::TypeError::New(env, "OCR profile variable \"" + name + "\" must be a string, a number or a boolean").ThrowAsJavaScriptException();
+        return false;
+      }
+    }
+  }
+  else if (!variables.IsUndefined()) {
+    Napi::TypeError::New(env, "OCR profile \"variables\" must be an object").ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
 }
 
-Napi::Value PerformOcrOnImageWrapper(const Napi::CallbackInfo& info) {
+Napi::Value RegisterOcrProfileWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   // Validate arguments
-  if (info.Length() < 1) {
-    Napi::TypeError::New(env, "Expected a string argument").ThrowAsJavaScriptException();
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Arguments must be: (name, options)").ThrowAsJavaScriptException();
     return env.Null();
   }
-  if (!info[0].IsString()) {
-    Napi::TypeError::New(env, "Expected a string as the first argument").ThrowAsJavaScriptException();
+  std::string name = info[0].As<Napi::String>().Utf8Value();
+  if (name.empty()) {
+    Napi::TypeError::New(env, "OCR profile name must not be empty").ThrowAsJavaScriptException();
     return env.Null();
   }
-  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsString()) {
-    Napi::TypeError::New(env, "Expected a string as the second argument").ThrowAsJavaScriptException();
+  Napi::Object options = info[1].As<Napi::Object>();
+  OcrProfile profile;
+  if (!ParseOcrProfile(env, options, profile)) {
     return env.Null();
   }
+  double preload = 1;
+  if (!options.Get("preload").IsUndefined()) {
+    preload = options.Get("preload").IsNumber() ? options.Get("preload").As<Napi::Number>().DoubleValue() : -1;
+    if (preload < 0 || preload > 256 || preload != std::floor(preload)) {
+      Napi::TypeError::New(env, "OCR profile \"preload\" must be an integer between 0 and 256").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+  size_t preloadCount = static_cast<size_t>(preload);
 
-  // Translata JS input to C++ input
-  std::string utf8ImagePath = info[0].As<Napi::String>().Utf8Value();
-  std::string imagePath = utf8ImagePath;
-  std::string utf8Language = info.Length() > 1 && !info[1].IsUndefined() ? info[1].As<Napi::String>().Utf8Value() : std::string();
-  std::string language = utf8Language;
-  // Perform OCR on the image
-  try {
-    std::string extractedText = PerformOcrOnImage(imagePath, language);
-    std::string utf8ExtractedText = extractedText;
+  // Initialize engines off the main thread, then register the profile
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<bool>(
+    env,
+    deferred,
+    [name, profile, preloadCount]() -> bool {
+      ocrEnginePool.preload(profile, preloadCount);
+      std::optional<OcrProfile> replacedProfile;
+      {
+        std::lock_guard<std::mutex> lock(ocrProfilesMutex);
+        auto existingProfile = ocrProfiles.find(name);
+        if (existingProfile != ocrProfiles.end() && existingProfile->second.key() != profile.key()) {
+          replacedProfile = existingProfile->second;
+        }
+        ocrProfiles[name] = profile;
+      }
+      if (replacedProfile) {
+        ocrEnginePool.clear(*replacedProfile);
+      }
+      return true;
+    },
+    [](Napi::Env env, const bool&) -> Napi::Value {
+      return env.Undefined();
+    }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
+}
 
-    // Return the extracted text
-    return Napi::String::New(env, utf8ExtractedText);
-  }
-  catch (const std::exception& ex) {
-    Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+Napi::Value UnregisterOcrProfileWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the first argument").ThrowAsJavaScriptException();
     return env.Null();
   }
+  std::string name = info[0].As<Napi::String>().Utf8Value();
+
+  std::optional<OcrProfile> profile;
+  {
+    std::lock_guard<std::mutex> lock(ocrProfilesMutex);
+    auto existingProfile = ocrProfiles.find(name);
+    if (existingProfile != ocrProfiles.end()) {
+      profile = existingProfile->second;
+      ocrProfiles.erase(existingProfile);
+    }
+  }
+  if (profile) {
+    ocrEnginePool.clear(*profile);
+  }
+  return Napi::Boolean::New(env, profile.has_value());
+}
+
+Napi::Value ReleaseOcrEnginesWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ocrEnginePool.clear();
+  return env.Undefined();
 }
 
 
@@ -4127,32 +10596,19 @@ Napi::Value PerformOcrOnImageWrapper(const Napi::CallbackInfo& info) {
 // ============================== IMAGE PROCESSING =============================
 // =============================================================================
 
-std::vector<std::vector<Color>> GetPixelColorsFromPng(const std::string& filePath) {
-  PIX* pix = pixRead(filePath.c_str());
-
-  if (!pix) {
-    throw std::runtime_error("Failed to load PNG file.");
-  }
-
-  PIX* pix32 = pixConvertTo32(pix);
-  pixDestroy(&pix);
-
-  if (!pix32) {
-    throw std::runtime_error("Failed to convert PNG to 32bpp.");
-  }
-
+// Extract the colors of rows [startY, endY) of a 32bpp PIX
+std::vector<std::vector<Color>> GetPixelColorsFromPix(PIX* pix32, int startY, int endY) {
   int width = pixGetWidth(pix32);
-  int height = pixGetHeight(pix32);
 
   std::vector<std::vector<Color>> pixels(
-    height,
+    endY - startY,
     std::vector<Color>(width)
   );
 
   l_uint32* data = pixGetData(pix32);
   l_int32 wpl = pixGetWpl(pix32);
 
-  for (l_int32 y = 0; y < height; y++) {
+  for (l_int32 y = startY; y < endY; y++) {
     l_uint32* line = data + y * wpl;
 
     for (l_int32 x = 0; x < width; x++) {
@@ -4168,10 +10624,29 @@ std::vector<std::vector<Color>> GetPixelColorsFromPng(const std::string& filePat
         &color.alpha
       );
 
-      pixels[y][x] = color;
+      pixels[y - startY][x] = color;
     }
   }
 
+  return pixels;
+}
+
+std::vector<std::vector<Color>> GetPixelColorsFromPng(const std::string& filePath) {
+  PIX* pix = pixRead(filePath.c_str());
+
+  if (!pix) {
+    throw std::runtime_error("Failed to load PNG file.");
+  }
+
+  PIX* pix32 = pixConvertTo32(pix);
+  pixDestroy(&pix);
+
+  if (!pix32) {
+    throw std::runtime_error("Failed to convert PNG to 32bpp.");
+  }
+
+  std::vector<std::vector<Color>> pixels = GetPixelColorsFromPix(pix32, 0, pixGetHeight(pix32));
+
   pixDestroy(&pix32);
 
   return pixels;
@@ -4225,6 +10700,115 @@ Napi::Value GetPixelColorsFromPngWrapper(const Napi::CallbackInfo& info) {
   }
 }
 
+// Decode an image into a 32bpp PIX whose pixels are rewritten in place as
+// packed RGBA (or BGRA) bytes, so that its buffer can be handed to JS as-is
+PIX* GetRawPixelsFromImage(const std::string& filePath, bool isBgra) {
+  PIX* pix = pixRead(filePath.c_str());
+
+  if (!pix) {
+    throw std::runtime_error("Failed to load image file.");
+  }
+
+  PIX* pix32 = pixConvertTo32(pix);
+  pixDestroy(&pix);
+
+  if (!pix32) {
+    throw std::runtime_error("Failed to convert image to 32bpp.");
+  }
+
+  int width = pixGetWidth(pix32);
+  int height = pixGetHeight(pix32);
+  bool hasAlpha = pixGetSpp(pix32) == 4;
+
+  l_uint32* data = pixGetData(pix32);
+  l_int32 wpl = pixGetWpl(pix32);
+
+  // Leptonica stores each pixel as a native 0xRRGGBBAA word, so the byte order
+  // in memory depends on endianness: rewrite each word as explicit bytes
+  for (l_int32 y = 0; y < height; y++) {
+    l_uint32* line = data + y * wpl;
+
+    for (l_int32 x = 0; x < width; x++) {
+      l_int32 red, green, blue, alpha;
+      extractRGBAValues(line[x], &red, &green, &blue, &alpha);
+
+      uint8_t* bytes = reinterpret_cast<uint8_t*>(&line[x]);
+      bytes[0] = static_cast<uint8_t>(isBgra ? blue : red);
+      bytes[1] = static_cast<uint8_t>(green);
+      bytes[2] = static_cast<uint8_t>(isBgra ? red : blue);
+      bytes[3] = static_cast<uint8_t>(hasAlpha ? alpha : 255);
+    }
+  }
+
+  return pix32;
+}
+
+// JS wrapper returning the packed pixels of an image along with its layout
+Napi::Value GetRawPixelsFromImageWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1) {
+    Napi::TypeError::New(env, "Expected at least one string argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the second argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input to C++ input
+  std::string filePath = info[0].As<Napi::String>().Utf8Value();
+  std::string format = info.Length() > 1 && info[1].IsString() ? info[1].As<Napi::String>().Utf8Value() : "rgba";
+  if (format != "rgba" && format != "bgra") {
+    Napi::TypeError::New(env, "Expected \"rgba\" or \"bgra\" as the second argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  try {
+    PIX* pix = GetRawPixelsFromImage(filePath, format == "bgra");
+    size_t width = pixGetWidth(pix);
+    size_t height = pixGetHeight(pix);
+    size_t stride = pixGetWpl(pix) * sizeof(l_uint32);
+    size_t byteLength = stride * height;
+
+#ifdef NODE_API_NO_EXTERNAL_BUFFERS_ALLOWED
+    // Runtimes forbidding external buffers get a single copy instead
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, byteLength);
+    std::memcpy(buffer.Data(), pixGetData(pix), byteLength);
+    pixDestroy(&pix);
+#else
+    // Hand the decoded PIX memory over to JS, released once garbage collected
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(
+      env,
+      pixGetData(pix),
+      byteLength,
+      [](Napi::Env env, void* data, PIX* pix) {
+        pixDestroy(&pix);
+      },
+      pix
+    );
+#endif
+
+    // Construct JS output
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("width", Napi::Number::New(env, width));
+    result.Set("height", Napi::Number::New(env, height));
+    result.Set("stride", Napi::Number::New(env, stride));
+    result.Set("format", Napi::String::New(env, format));
+    result.Set("data", Napi::Uint8Array::New(env, byteLength, buffer, 0));
+    return result;
+  }
+  catch (const std::exception& ex) {
+    Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
 // Computes similarity score (between 0 and 1) via image template matching
 void computeSimilarityChunk(
   const std::vector<std::vector<Color>>& image,
@@ -4320,6 +10904,92 @@ std::vector<MatchRegion> findMatchingRegions(
   return matchingRegions;
 }
 
+// Memory-bounded image template matching: the image is processed in
+// overlapping horizontal bands (each one extended by the template height) so
+// that only the bands being processed are expanded and only regions reaching
+// the similarity threshold are kept
+std::vector<MatchRegion> findMatchingRegionsTiled(
+  const std::string& imagePath,
+  const std::vector<std::vector<Color>>& subImage,
+  const double& minSimilarityThresholdFactor,
+  int bandHeight
+) {
+  PIX* pix = pixRead(imagePath.c_str());
+
+  if (!pix) {
+    throw std::runtime_error("Failed to load PNG file.");
+  }
+
+  PIX* pix32 = pixConvertTo32(pix);
+  pixDestroy(&pix);
+
+  if (!pix32) {
+    throw std::runtime_error("Failed to convert PNG to 32bpp.");
+  }
+
+  int imageWidth = pixGetWidth(pix32);
+  int imageHeight = pixGetHeight(pix32);
+  int subImageWidth = subImage[0].size();
+  int subImageHeight = subImage.size();
+
+  if (imageHeight < subImageHeight || imageWidth < subImageWidth) {
+    pixDestroy(&pix32);
+    return {};
+  }
+
+  int commonWidth = imageWidth - subImageWidth + 1;
+  int commonHeight = imageHeight - subImageHeight + 1;
+  int matchablePixels = subImageWidth * subImageHeight;
+  int perfectSimilarity = (3 * 255) * matchablePixels;
+  int bandCount = (commonHeight + bandHeight - 1) / bandHeight;
+
+  std::vector<MatchRegion> matchingRegions;
+  std::mutex matchingRegionsMutex;
+  int numThreads = std::min<int>(std::max(1u, std::thread::hardware_concurrency()), bandCount);
+  std::vector<std::thread> threads;
+  std::atomic<int> nextBand(0);
+
+  for (int i = 0; i < numThreads; ++i) {
+    threads.emplace_back([&] {
+      int band;
+      while ((band = nextBand.fetch_add(1)) < bandCount) {
+        int startY = band * bandHeight;
+        int endY = std::min(startY + bandHeight, commonHeight);
+        int bandRows = endY - startY;
+
+        // Expand the band rows plus the template height overlap
+        std::vector<std::vector<Color>> bandImage = GetPixelColorsFromPix(pix32, startY, endY + subImageHeight - 1);
+        std::vector<MatchRegion> bandRegions(commonWidth * bandRows);
+        computeSimilarityChunk(bandImage, subImage, bandRegions, 0, bandRows, commonWidth, bandRows, subImageWidth, subImageHeight, perfectSimilarity, minSimilarityThresholdFactor);
+
+        // Keep only relevant regions, translated back to image coordinates
+        std::vector<MatchRegion> keptRegions;
+        for (MatchRegion& region : bandRegions) {
+          if (region.similarity >= minSimilarityThresholdFactor) {
+            region.position.y += startY;
+            keptRegions.push_back(region);
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(matchingRegionsMutex);
+        matchingRegions.insert(matchingRegions.end(), keptRegions.begin(), keptRegions.end());
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  pixDestroy(&pix32);
+
+  std::sort(std::execution::par_unseq, matchingRegions.begin(), matchingRegions.end(), [](const MatchRegion& a, const MatchRegion& b) {
+    return a.similarity > b.similarity;
+  });
+
+  return matchingRegions;
+}
+
 // JS wrapper for image template matching
 Napi::Value findImageTemplateMatches(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
@@ -4341,6 +11011,10 @@ Napi::Value findImageTemplateMatches(const Napi::CallbackInfo& info) {
     Napi::TypeError::New(env, "Expected a number as the third argument").ThrowAsJavaScriptException();
     return env.Null();
   }
+  if (info.Length() > 3 && !info[3].IsUndefined() && !info[3].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a number as the fourth argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
   // Translate JS input to C++ input
   std::string utf8imagePath = info[0].As<Napi::String>().Utf8Value();
@@ -4348,14 +11022,21 @@ Napi::Value findImageTemplateMatches(const Napi::CallbackInfo& info) {
   std::string utf8subImagePath = info[1].As<Napi::String>().Utf8Value();
   std::string subImagePath = utf8subImagePath;
   float minSimilarityThresholdFactor = info[2].As<Napi::Number>().FloatValue();
+  int bandHeight = info.Length() > 3 && info[3].IsNumber() ? info[3].As<Napi::Number>().Int32Value() : 0;
 
   try {
     // Get pixel colors
-    std::vector<std::vector<Color>> image = GetPixelColorsFromPng(imagePath);
     std::vector<std::vector<Color>> subImage = GetPixelColorsFromPng(subImagePath);
 
     // Find matching regions
-    std::vector<MatchRegion> matchingRegions = findMatchingRegions(image, subImage, minSimilarityThresholdFactor);
+    std::vector<MatchRegion> matchingRegions;
+    if (bandHeight > 0) {
+      matchingRegions = findMatchingRegionsTiled(imagePath, subImage, minSimilarityThresholdFactor, bandHeight);
+    }
+    else {
+      std::vector<std::vector<Color>> image = GetPixelColorsFromPng(imagePath);
+      matchingRegions = findMatchingRegions(image, subImage, minSimilarityThresholdFactor);
+    }
 
     // Construct JS output (using ArrayBuffer for best performance)
     size_t numRegions = matchingRegions.size();
@@ -5662,10 +12343,28 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set(Napi::String::New(env, "mouseExtraButtonUp"), Napi::Function::New(env, MouseExtraButtonUpWrapper));
   exports.Set(Napi::String::New(env, "keyPressDown"), Napi::Function::New(env, KeyPressDownWrapper));
   exports.Set(Napi::String::New(env, "keyPressUp"), Napi::Function::New(env, KeyPressUpWrapper));
-  exports.Set(Napi::String::New(env, "typeUnicodeCharacter"), Napi::Function::New(env, TypeUnicodeCharacter));
+  exports.Set(Napi::String::New(env, "typeText"), Napi::Function::New(env, TypeTextWrapper));
   exports.Set(Napi::String::New(env, "getAvailableScreens"), Napi::Function::New(env, GetAvailableScreens));
   exports.Set(Napi::String::New(env, "startInputEventListener"), Napi::Function::New(env, StartInputEventListener));
   exports.Set(Napi::String::New(env, "stopInputEventListener"), Napi::Function::New(env, StopInputEventListener));
+  exports.Set(Napi::String::New(env, "setInputEventBatching"), Napi::Function::New(env, SetInputEventBatching));
+  exports.Set(Napi::String::New(env, "setInputEventFilter"), Napi::Function::New(env, SetInputEventFilter));
+  exports.Set(Napi::String::New(env, "startInputEventRing"), Napi::Function::New(env, StartInputEventRingWrapper));
+  exports.Set(Napi::String::New(env, "stopInputEventRing"), Napi::Function::New(env, StopInputEventRingWrapper));
+  exports.Set(Napi::String::New(env, "startInputRecording"), Napi::Function::New(env, StartInputRecordingWrapper));
+  exports.Set(Napi::String::New(env, "setInputRecordingPaused"), Napi::Function::New(env, SetInputRecordingPausedWrapper));
+  exports.Set(Napi::String::New(env, "stopInputRecording"), Napi::Function::New(env, StopInputRecordingWrapper));
+  exports.Set(Napi::String::New(env, "readInputRecording"), Napi::Function::New(env, ReadInputRecordingWrapper));
+  exports.Set(Napi::String::New(env, "startInputReplay"), Napi::Function::New(env, StartInputReplayWrapper));
+  exports.Set(Napi::String::New(env, "setInputReplayPaused"), Napi::Function::New(env, SetInputReplayPausedWrapper));
+  exports.Set(Napi::String::New(env, "seekInputReplay"), Napi::Function::New(env, SeekInputReplayWrapper));
+  exports.Set(Napi::String::New(env, "stopInputReplay"), Napi::Function::New(env, StopInputReplayWrapper));
+  exports.Set(Napi::String::New(env, "setInputStateTracking"), Napi::Function::New(env, SetInputStateTrackingWrapper));
+  exports.Set(Napi::String::New(env, "isKeyPressed"), Napi::Function::New(env, IsKeyPressedWrapper));
+  exports.Set(Napi::String::New(env, "isMouseButtonPressed"), Napi::Function::New(env, IsMouseButtonPressedWrapper));
+  exports.Set(Napi::String::New(env, "getCursorPosition"), Napi::Function::New(env, GetCursorPositionWrapper));
+  exports.Set(Napi::String::New(env, "registerHotkey"), Napi::Function::New(env, RegisterHotkeyWrapper));
+  exports.Set(Napi::String::New(env, "unregisterHotkey"), Napi::Function::New(env, UnregisterHotkeyWrapper));
   exports.Set(Napi::String::New(env, "startWindowEventListener"), Napi::Function::New(env, StartWindowEventListener));
   exports.Set(Napi::String::New(env, "stopWindowEventListener"), Napi::Function::New(env, StopWindowEventListener));
   exports.Set(Napi::String::New(env, "cleanResources"), Napi::Function::New(env, CleanupResources));
@@ -5684,13 +12383,35 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set(Napi::String::New(env, "getPixelColor"), Napi::Function::New(env, GetPixelColorWrapper));
   exports.Set(Napi::String::New(env, "takeScreenshotToFile"), Napi::Function::New(env, TakeScreenshotToFileWrapper));
   exports.Set(Napi::String::New(env, "takeWindowScreenshotToFile"), Napi::Function::New(env, TakeWindowScreenshotToFileWrapper));
+  exports.Set(Napi::String::New(env, "captureMonitors"), Napi::Function::New(env, CaptureMonitorsWrapper));
+  exports.Set(Napi::String::New(env, "startScreenRecording"), Napi::Function::New(env, StartScreenRecordingWrapper));
+  exports.Set(Napi::String::New(env, "stopScreenRecording"), Napi::Function::New(env, StopScreenRecordingWrapper));
+  exports.Set(Napi::String::New(env, "readScreenRecordingFrame"), Napi::Function::New(env, ReadScreenRecordingFrameWrapper));
+  exports.Set(Napi::String::New(env, "startFlightRecorder"), Napi::Function::New(env, StartFlightRecorderWrapper));
+  exports.Set(Napi::String::New(env, "dumpFlightRecorder"), Napi::Function::New(env, DumpFlightRecorderWrapper));
+  exports.Set(Napi::String::New(env, "stopFlightRecorder"), Napi::Function::New(env, StopFlightRecorderWrapper));
+  exports.Set(Napi::String::New(env, "startScreenFrameFeed"), Napi::Function::New(env, StartScreenFrameFeedWrapper));
+  exports.Set(Napi::String::New(env, "stopScreenFrameFeed"), Napi::Function::New(env, StopScreenFrameFeedWrapper));
   exports.Set(Napi::String::New(env, "copyTextToClipboard"), Napi::Function::New(env, CopyTextToClipboardWrapper));
   exports.Set(Napi::String::New(env, "copyFileToClipboard"), Napi::Function::New(env, CopyFileToClipboardWrapper));
   exports.Set(Napi::String::New(env, "sleep"), Napi::Function::New(env, SleepWrapper));
+  exports.Set(Napi::String::New(env, "sleepAsync"), Napi::Function::New(env, SleepAsyncWrapper));
+  exports.Set(Napi::String::New(env, "getMonotonicTime"), Napi::Function::New(env, GetMonotonicTimeWrapper));
+  exports.Set(Napi::String::New(env, "sendInputSequence"), Napi::Function::New(env, SendInputSequenceWrapper));
+  exports.Set(Napi::String::New(env, "moveCursorSmoothly"), Napi::Function::New(env, MoveCursorSmoothlyWrapper));
   exports.Set(Napi::String::New(env, "suppressInputEvents"), Napi::Function::New(env, SuppressInputEventsWrapper));
   exports.Set(Napi::String::New(env, "unsuppressInputEvents"), Napi::Function::New(env, UnsuppressInputEventsWrapper));
   exports.Set(Napi::String::New(env, "performOcrOnImage"), Napi::Function::New(env, PerformOcrOnImageWrapper));
+  exports.Set(Napi::String::New(env, "performStructuredOcrOnImage"), Napi::Function::New(env, PerformStructuredOcrOnImageWrapper));
+  exports.Set(Napi::String::New(env, "findTextOnScreen"), Napi::Function::New(env, FindTextOnScreenWrapper));
+  exports.Set(Napi::String::New(env, "getOcrCacheStats"), Napi::Function::New(env, GetOcrCacheStatsWrapper));
+  exports.Set(Napi::String::New(env, "setOcrCacheCapacity"), Napi::Function::New(env, SetOcrCacheCapacityWrapper));
+  exports.Set(Napi::String::New(env, "clearOcrCache"), Napi::Function::New(env, ClearOcrCacheWrapper));
+  exports.Set(Napi::String::New(env, "registerOcrProfile"), Napi::Function::New(env, RegisterOcrProfileWrapper));
+  exports.Set(Napi::String::New(env, "unregisterOcrProfile"), Napi::Function::New(env, UnregisterOcrProfileWrapper));
+  exports.Set(Napi::String::New(env, "releaseOcrEngines"), Napi::Function::New(env, ReleaseOcrEnginesWrapper));
   exports.Set(Napi::String::New(env, "getPixelColorsFromImage"), Napi::Function::New(env, GetPixelColorsFromPngWrapper));
+  exports.Set(Napi::String::New(env, "getRawPixelsFromImage"), Napi::Function::New(env, GetRawPixelsFromImageWrapper));
   exports.Set(Napi::String::New(env, "findImageTemplateMatches"), Napi::Function::New(env, findImageTemplateMatches));
   exports.Set(Napi::String::New(env, "playSound"), Napi::Function::New(env, PlaySoundWrapper));
   exports.Set(Napi::String::New(env, "pauseSound"), Napi::Function::New(env, PauseSoundWrapper));
@@ -9,12 +9,21 @@
 #include <queue>
 #include <filesystem>
 #include <functional>
+#include <random>
 #include <cmath>
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
+#include <array>
 #include <map>
 #include <set>
+#include <list>
+#include <unordered_map>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
 #include <shlobj.h> // For clipboard formats and shell operations
 #include <gdiplus.h>
 #include <winrt/Windows.Foundation.h>
@@ -29,6 +38,9 @@
 #include <shellscalingapi.h>
 #include <leptonica/allheaders.h>
 #include <tesseract/baseapi.h>
+#include <tesseract/resultiterator.h>
+#include <zstd.h>
+#include <lz4.h>
 #include <miniaudio.h>
 #pragma warning(push)                  // ignore "warning C4305: 'initializer' :
 #pragma warning(disable:4305)          // truncation from 'double' to 'float'"
@@ -98,6 +110,27 @@ struct Scale {
   float y;
 };
 
+// Path followed by a smooth cursor motion
+enum class CursorMotionCurve {
+  Linear,
+  Arc, // quadratic Bézier curve
+  Wave,
+  Human, // cubic Bézier curve with random control points and minimum-jerk speed
+};
+
+// Structure to hold a smooth cursor motion (see BuildCursorMotionProgram)
+struct CursorMotion {
+  Position from;
+  Position to;
+  double durationMs;
+  CursorMotionCurve curve = CursorMotionCurve::Linear;
+  double curviness = 0.1618;
+  double frequency = 1; // wave count, 0 to fit the motion length
+  bool isMirrored = false;
+  double jitter = 0; // maximum random offset in pixels of intermediate positions
+  unsigned int steps = 0; // intermediate positions, 0 for one per monitor refresh
+};
+
 // Structure to hold a matched region
 struct MatchRegion {
   Position position;
@@ -105,14 +138,36 @@ struct MatchRegion {
   double similarity;
 };
 
-// Event structure to hold raw event data
+// Input event types, states and mouse inputs, numbered as in input recordings
+enum class InputEventType : int32_t {
+  Mouse = 0,
+  Keyboard = 1,
+};
+
+enum class InputEventState : int32_t {
+  Down = 0,
+  Up = 1,
+  Neutral = 2,
+};
+
+enum class MouseInputCode : int32_t {
+  Unknown = -1,
+  Move = 0,
+  Left = 1,
+  Right = 2,
+  Middle = 3,
+  Wheel = 4,
+  ExtraButton1 = 5,
+  ExtraButton2 = 6,
+};
+
+// Event structure to hold raw event data, without any allocation
 struct RawInputEvent {
-  std::string type; // "mouse" or "keyboard"
-  std::string input;
-  std::string state;
+  InputEventType type;
+  int input; // MouseInputCode for mouse events, key code for keyboard events
+  InputEventState state;
   int x;
   int y;
-  int keyCode;
   uint64_t timestamp;
   bool isSuppressed;
   bool isInjected;
@@ -123,6 +178,37 @@ struct SoundInfo {
   unsigned int duration;
 };
 
+// Words, lines and blocks recognized in an image, as flat arrays: boxes are
+// (x, y, width, height) quadruplets, words refer to their line and lines to
+// their block by index
+struct OcrResult {
+  std::string text;
+  std::vector<std::string> wordTexts;
+  std::vector<int32_t> wordBoxes;
+  std::vector<float> wordConfidences;
+  std::vector<int32_t> wordLines;
+  std::vector<std::string> lineTexts;
+  std::vector<int32_t> lineBoxes;
+  std::vector<float> lineConfidences;
+  std::vector<int32_t> lineBlocks;
+  std::vector<int32_t> blockBoxes;
+  std::vector<float> blockConfidences;
+};
+
+// Structure to hold a single monitor capture request and its result
+struct MonitorCapture {
+  int id;
+  int x;
+  int y;
+  int width;
+  int height;
+  float scale;
+  std::wstring mimeType; // GDI+ encoder MIME type
+  std::wstring filepath; // Encoded in memory when empty
+  std::vector<uint8_t> data;
+  bool isCaptured;
+};
+
 
 // =============================================================================
 // ============================== UTILITY CLASSES ==============================
@@ -411,1186 +497,6423 @@ class AudioManager {
     size_t m_nextSoundId = 0;
 };
 
-template <typename T>
-class PromiseWorker : public Napi::AsyncWorker {
+// Grabs frames of a screen (or window client) area as packed BGRA pixels,
+// reusing the same DIB section for every frame
+class ScreenFrameSource {
   public:
+    ScreenFrameSource(HWND window, int x, int y, int width, int height)
+      : m_window(window), m_x(x), m_y(y), m_width(std::max(1, width)), m_height(std::max(1, height)) {
+      m_sourceDC = GetDC(m_window);
+      if (!m_sourceDC) {
+        throw std::runtime_error("Failed to get device context.");
+      }
+      m_memoryDC = CreateCompatibleDC(m_sourceDC);
+
+      BITMAPINFO bitmapInfo = {};
+      bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+      bitmapInfo.bmiHeader.biWidth = m_width;
+      bitmapInfo.bmiHeader.biHeight = -m_height; // top-down rows
+      bitmapInfo.bmiHeader.biPlanes = 1;
+      bitmapInfo.bmiHeader.biBitCount = 32;
+      bitmapInfo.bmiHeader.biCompression = BI_RGB;
+      m_bitmap = m_memoryDC ? CreateDIBSection(m_memoryDC, &bitmapInfo, DIB_RGB_COLORS, &m_bits, nullptr, 0) : nullptr;
+      if (!m_bitmap) {
+        if (m_memoryDC) {
+          DeleteDC(m_memoryDC);
+        }
+        ReleaseDC(m_window, m_sourceDC);
+        throw std::runtime_error("Failed to create frame bitmap.");
+      }
+      m_previousBitmap = (HBITMAP)SelectObject(m_memoryDC, m_bitmap);
+    }
 
-    PromiseWorker(
-      Napi::Env env,
-      Napi::Promise::Deferred deferred,
-      std::function<T()> executeCallback,
-      std::function<Napi::Value(Napi::Env, const T&)> resolveConverter
-    ) : Napi::AsyncWorker(env), deferred(deferred), executeCallback(executeCallback), resolveConverter(resolveConverter) { }
+    ~ScreenFrameSource() {
+      SelectObject(m_memoryDC, m_previousBitmap);
+      DeleteObject(m_bitmap);
+      DeleteDC(m_memoryDC);
+      ReleaseDC(m_window, m_sourceDC);
+    }
 
-    ~PromiseWorker() override { }
+    ScreenFrameSource(const ScreenFrameSource&) = delete;
+    ScreenFrameSource& operator=(const ScreenFrameSource&) = delete;
 
-    void Execute() override {
-      try {
-        promiseResolveResult = executeCallback();
-      } catch (const std::exception& e) {
-        SetError(e.what());
-      } catch (...) {
-        SetError("Unknown error occurred");
-      }
+  public:
+    // Origin of the grabbed area
+    int x() const {
+      return m_x;
     }
 
-    void OnOK() override {
-      deferred.Resolve(resolveConverter(Env(), promiseResolveResult));
+    int y() const {
+      return m_y;
     }
 
-    void OnError(const Napi::Error& error) override {
-      deferred.Reject(error.Value());
+    int width() const {
+      return m_width;
     }
 
-  private:
-    Napi::Promise::Deferred deferred;
-    std::function<T()> executeCallback;
-    std::function<Napi::Value(Napi::Env, const T&)> resolveConverter;
-    T promiseResolveResult;
-};
-
+    int height() const {
+      return m_height;
+    }
 
-// =============================================================================
-// ============================== GLOBAL VARIABLES =============================
-// =============================================================================
+    size_t stride() const {
+      return static_cast<size_t>(m_width) * 4;
+    }
 
-// Input events variables
-HHOOK mouseHook = nullptr;
-HHOOK keyboardHook = nullptr;
-std::mutex inputEventHookMutex;
-std::atomic<bool> inputEventRunning(false);
-std::condition_variable inputEventHookCondition;
-Napi::ThreadSafeFunction inputEventThreadSafeJsFunction;
-std::queue<RawInputEvent> inputEventQueue;
-std::mutex inputEventQueueMutex;
-std::condition_variable inputEventQueueCondition;
+    // Prepare the calling thread to grab frames (DPI awareness is per thread)
+    void attachToCurrentThread() {
+      SetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE);
+    }
 
-// Maps to store mouse and keyboard suppressed keys
-std::map<int, std::set<int>> suppressedMouseKeys;
-std::map<int, std::set<int>> suppressedKeyboardKeys;
-std::mutex suppressedKeysMutex;
+    // Grab the current frame into `destination` (stride() * height() bytes)
+    bool grab(uint8_t* destination) {
+      if (!BitBlt(m_memoryDC, 0, 0, m_width, m_height, m_sourceDC, m_x, m_y, SRCCOPY)) {
+        return false;
+      }
+      GdiFlush();
+
+      // BitBlt leaves the alpha channel undefined
+      const uint8_t* bits = static_cast<const uint8_t*>(m_bits);
+      size_t frameSize = stride() * m_height;
+      for (size_t index = 0; index < frameSize; index += 4) {
+        destination[index + 0] = bits[index + 0];
+        destination[index + 1] = bits[index + 1];
+        destination[index + 2] = bits[index + 2];
+        destination[index + 3] = 255;
+      }
+      return true;
+    }
 
-// Window events variables
-std::vector<HWINEVENTHOOK> windowEventHooks;
-std::mutex windowEventHookMutex;
-std::atomic<bool> windowEventRunning(false);
-std::condition_variable windowEventHookCondition;
-Napi::ThreadSafeFunction windowEventThreadSafeJsFunction;
-std::queue<RawWindowEvent> windowEventQueue;
-std::mutex windowEventQueueMutex;
-std::condition_variable windowEventQueueCondition;
+  private:
+    HWND m_window = nullptr;
+    HDC m_sourceDC = nullptr;
+    HDC m_memoryDC = nullptr;
+    HBITMAP m_bitmap = nullptr;
+    HBITMAP m_previousBitmap = nullptr;
+    void* m_bits = nullptr;
+    int m_x = 0;
+    int m_y = 0;
+    int m_width = 0;
+    int m_height = 0;
+};
 
-// Tray icon variables
-std::mutex trayIconMutex;
-std::condition_variable trayIconCondition;
-std::atomic<bool> trayIconRunning(false);
-HWND trayIconWindowHwnd;
-NOTIFYICONDATAW nid = { 0 };
-HMENU hMenu;
-std::map<int, std::function<void()>> trayIconMenuItemsCallbacks;
-std::map<int, Napi::ThreadSafeFunction> trayIconMenuItemsJsCallbacks;
+// Screen recording container (all integers little-endian):
+//   header  "ACTFRM01" | width | height | stride | codec | keyframe interval | fps
+//   frames  (timestamp in us | flags | payload size | payload)*
+//   index   (frame offset | timestamp in us | flags)*
+//   trailer frame count | index offset | "ACTIDX01"
+// Frames hold packed BGRA pixels. Keyframes are stored as-is, other frames as
+// the XOR of the frame with the previous one (mostly zeros, thus compressing
+// very well), then compressed with LZ4 or Zstandard.
+const char SCREEN_RECORDING_MAGIC[] = "ACTFRM01";
+const char SCREEN_RECORDING_INDEX_MAGIC[] = "ACTIDX01";
+const uint8_t SCREEN_RECORDING_KEYFRAME_FLAG = 1 << 0;
+const uint8_t SCREEN_RECORDING_STORED_FLAG = 1 << 1; // uncompressed payload
+
+enum class FrameCodec : uint32_t {
+  Lz4 = 1,
+  Zstd = 2,
+};
 
-// Audio manager
-AudioManager* audioManager = nullptr;
+struct ScreenRecordingHeader {
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;
+  FrameCodec codec;
+  uint32_t keyframeInterval;
+  double fps;
+};
 
+struct ScreenRecordingIndexEntry {
+  uint64_t offset;
+  uint64_t timestampUs;
+  uint8_t flags;
+};
 
-// =============================================================================
-// ============================= UTILITY FUNCTIONS =============================
-// =============================================================================
+struct ScreenRecordingStats {
+  uint64_t frameCount;
+  uint64_t droppedFrameCount;
+  uint64_t durationMs;
+};
 
-std::string ConvertToUTF8(const std::wstring& wideStr) {
-  int bufferSize = WideCharToMultiByte(CP_UTF8, 0, wideStr.c_str(), wideStr.size(), NULL, 0, NULL, NULL);
-  std::string utf8Str(bufferSize, 0);
-  WideCharToMultiByte(CP_UTF8, 0, wideStr.c_str(), wideStr.size(), &utf8Str[0], bufferSize, NULL, NULL);
-  return utf8Str;
+template <typename T>
+void WriteBinary(std::ostream& stream, const T& value) {
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
 }
 
-uint64_t Now() {
-  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+template <typename T>
+T ReadBinary(std::istream& stream) {
+  T value{};
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+  if (!stream) {
+    throw std::runtime_error("Unexpected end of screen recording file.");
+  }
+  return value;
+}
+
+// XOR two equally sized frames into `destination`
+void XorFrames(const uint8_t* frame, const uint8_t* otherFrame, uint8_t* destination, size_t size) {
+  size_t wordCount = size / sizeof(uint64_t);
+  for (size_t i = 0; i < wordCount; i++) {
+    uint64_t word, otherWord;
+    std::memcpy(&word, frame + i * sizeof(uint64_t), sizeof(uint64_t));
+    std::memcpy(&otherWord, otherFrame + i * sizeof(uint64_t), sizeof(uint64_t));
+    word ^= otherWord;
+    std::memcpy(destination + i * sizeof(uint64_t), &word, sizeof(uint64_t));
+  }
+  for (size_t i = wordCount * sizeof(uint64_t); i < size; i++) {
+    destination[i] = frame[i] ^ otherFrame[i];
+  }
+}
+
+// Compress a frame into `destination`. Returns false when the codec failed,
+// in which case the caller should store the frame uncompressed.
+bool CompressFrame(
+  FrameCodec codec,
+  int compressionLevel,
+  const uint8_t* source,
+  size_t size,
+  std::vector<uint8_t>& destination,
+  ZSTD_CCtx* zstdContext
+) {
+  if (codec == FrameCodec::Zstd) {
+    destination.resize(ZSTD_compressBound(size));
+    size_t compressedSize = zstdContext
+      ? ZSTD_compressCCtx(zstdContext, destination.data(), destination.size(), source, size, compressionLevel)
+      : ZSTD_compress(destination.data(), destination.size(), source, size, compressionLevel);
+    if (ZSTD_isError(compressedSize)) {
+      return false;
+    }
+    destination.resize(compressedSize);
+    return true;
+  }
+  destination.resize(LZ4_compressBound(static_cast<int>(size)));
+  int compressedSize = LZ4_compress_default(
+    reinterpret_cast<const char*>(source),
+    reinterpret_cast<char*>(destination.data()),
+    static_cast<int>(size),
+    static_cast<int>(destination.size())
+  );
+  if (compressedSize <= 0) {
+    return false;
+  }
+  destination.resize(compressedSize);
+  return true;
 }
 
-// Return this dynamic library's absolute directory path (/path/to/build/Release/actionify.node)
-std::filesystem::path GetModuleAbsoluteDirectoryPath() {
-  HMODULE hModule = nullptr;
-
-  // Get handle of the DLL that contains this function
-  if (
-    !GetModuleHandleExW(
-      GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
-      reinterpret_cast<LPCWSTR>(&GetModuleAbsoluteDirectoryPath),
-      &hModule
-    )
-  ) {
-    return {};
+void DecompressFrame(FrameCodec codec, const std::vector<uint8_t>& source, uint8_t* destination, size_t size) {
+  if (codec == FrameCodec::Zstd) {
+    size_t decompressedSize = ZSTD_decompress(destination, size, source.data(), source.size());
+    if (ZSTD_isError(decompressedSize) || decompressedSize != size) {
+      throw std::runtime_error("Corrupted screen recording frame.");
+    }
+    return;
   }
-
-  wchar_t path[MAX_PATH];
-  if (!GetModuleFileNameW(hModule, path, MAX_PATH)) {
-    return {};
+  int decompressedSize = LZ4_decompress_safe(
+    reinterpret_cast<const char*>(source.data()),
+    reinterpret_cast<char*>(destination),
+    static_cast<int>(source.size()),
+    static_cast<int>(size)
+  );
+  if (decompressedSize < 0 || static_cast<size_t>(decompressedSize) != size) {
+    throw std::runtime_error("Corrupted screen recording frame.");
   }
-
-  return std::filesystem::path(path).parent_path();
 }
 
-std::filesystem::path GetUserDataAbsoluteDirectoryPath() {
-  std::filesystem::path userDataAbsoluteDirectoryPath = (GetModuleAbsoluteDirectoryPath() / "../../data").lexically_normal();
-  std::filesystem::create_directories(userDataAbsoluteDirectoryPath);
-  return userDataAbsoluteDirectoryPath;
-}
+// Appends encoded frames to a screen recording file and writes its index on finish
+class ScreenRecordingWriter {
+  public:
+    ScreenRecordingWriter(const std::filesystem::path& filepath, const ScreenRecordingHeader& header)
+      : m_stream(filepath, std::ios::binary | std::ios::trunc) {
+      if (!m_stream) {
+        throw std::runtime_error("Failed to open screen recording file.");
+      }
+      m_stream.write(SCREEN_RECORDING_MAGIC, 8);
+      WriteBinary(m_stream, header.width);
+      WriteBinary(m_stream, header.height);
+      WriteBinary(m_stream, header.stride);
+      WriteBinary(m_stream, static_cast<uint32_t>(header.codec));
+      WriteBinary(m_stream, header.keyframeInterval);
+      WriteBinary(m_stream, header.fps);
+    }
 
-std::filesystem::path GetUserDataTtsAbsoluteDirectoryPath() {
-  std::filesystem::path userDataTtsAbsoluteDirectoryPath = (GetUserDataAbsoluteDirectoryPath() / "tts").lexically_normal();
-  std::filesystem::create_directories(userDataTtsAbsoluteDirectoryPath);
-  return userDataTtsAbsoluteDirectoryPath;
-}
+    ~ScreenRecordingWriter() {
+      try {
+        finish();
+      } catch (...) {
+        // Nobody is left to report the failure to
+      }
+    }
 
-std::filesystem::path GetUserDataTmpAbsoluteDirectoryPath() {
-  std::filesystem::path userDataTmpAbsoluteDirectoryPath = (GetUserDataAbsoluteDirectoryPath() / "tmp").lexically_normal();
-  std::filesystem::create_directories(userDataTmpAbsoluteDirectoryPath);
-  return userDataTmpAbsoluteDirectoryPath;
-}
+    ScreenRecordingWriter(const ScreenRecordingWriter&) = delete;
+    ScreenRecordingWriter& operator=(const ScreenRecordingWriter&) = delete;
 
-std::optional<std::filesystem::path> FindFile(
-  const std::filesystem::path& directoryPath,
-  const std::function<bool(const std::filesystem::directory_entry&)>& predicate
-) {
-  for (const auto& entry : std::filesystem::directory_iterator(directoryPath)) {
-    if (predicate(entry)) {
-      return entry.path();
+  public:
+    void append(uint64_t timestampUs, uint8_t flags, const uint8_t* payload, uint32_t size) {
+      m_index.push_back({ static_cast<uint64_t>(m_stream.tellp()), timestampUs, flags });
+      WriteBinary(m_stream, timestampUs);
+      WriteBinary(m_stream, flags);
+      WriteBinary(m_stream, size);
+      m_stream.write(reinterpret_cast<const char*>(payload), size);
     }
-  }
-  return std::nullopt;
-}
 
-template<typename T>
-T ExpectOrThrow(std::optional<T> value, std::string_view errorMessage) {
-  if (!value) {
-    throw std::runtime_error(std::string(errorMessage));
-  }
+    void finish() {
+      if (m_isFinished) return;
+      m_isFinished = true;
+      uint64_t indexOffset = static_cast<uint64_t>(m_stream.tellp());
+      for (const ScreenRecordingIndexEntry& entry : m_index) {
+        WriteBinary(m_stream, entry.offset);
+        WriteBinary(m_stream, entry.timestampUs);
+        WriteBinary(m_stream, entry.flags);
+      }
+      WriteBinary(m_stream, static_cast<uint64_t>(m_index.size()));
+      WriteBinary(m_stream, indexOffset);
+      m_stream.write(SCREEN_RECORDING_INDEX_MAGIC, 8);
+      m_stream.flush();
+      // The stream state is sticky: this also catches failed appends
+      bool hasFailed = !m_stream;
+      m_stream.close();
+      if (hasFailed || !m_stream) {
+        throw std::runtime_error("Failed to write screen recording file.");
+      }
+    }
 
-  return std::move(*value);
-}
+    size_t frameCount() const {
+      return m_index.size();
+    }
 
-std::string ToLower(const std::string& text) {
-  std::string result = text;
-  std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::tolower(c); });
-  return result;
-}
+  private:
+    std::ofstream m_stream;
+    std::vector<ScreenRecordingIndexEntry> m_index;
+    bool m_isFinished = false;
+};
 
-AudioManager* GetAudioManager() {
-  if (audioManager == nullptr) {
-    audioManager = new AudioManager();
-  }
-  return audioManager;
-}
+struct ScreenRecordingFrame {
+  ScreenRecordingHeader header;
+  uint64_t frameCount;
+  uint64_t timestampUs;
+  std::vector<uint8_t> pixels;
+};
 
-void CloseAudioManager() {
-  if (audioManager != nullptr) {
-    delete audioManager;
-    audioManager = nullptr;
+// Decode a single frame of a screen recording, starting from its closest
+// preceding keyframe thanks to the recording index
+ScreenRecordingFrame ReadScreenRecordingFrame(const std::filesystem::path& filepath, uint64_t frameIndex) {
+  std::ifstream stream(filepath, std::ios::binary);
+  if (!stream) {
+    throw std::runtime_error("Failed to open screen recording file.");
+  }
+
+  char magic[8];
+  stream.read(magic, 8);
+  if (!stream || std::memcmp(magic, SCREEN_RECORDING_MAGIC, 8) != 0) {
+    throw std::runtime_error("Invalid screen recording file.");
+  }
+
+  ScreenRecordingFrame result{};
+  result.header.width = ReadBinary<uint32_t>(stream);
+  result.header.height = ReadBinary<uint32_t>(stream);
+  result.header.stride = ReadBinary<uint32_t>(stream);
+  result.header.codec = static_cast<FrameCodec>(ReadBinary<uint32_t>(stream));
+  result.header.keyframeInterval = ReadBinary<uint32_t>(stream);
+  result.header.fps = ReadBinary<double>(stream);
+
+  // Trailer: frame count | index offset | magic
+  stream.seekg(-24, std::ios::end);
+  result.frameCount = ReadBinary<uint64_t>(stream);
+  uint64_t indexOffset = ReadBinary<uint64_t>(stream);
+  stream.read(magic, 8);
+  if (!stream || std::memcmp(magic, SCREEN_RECORDING_INDEX_MAGIC, 8) != 0) {
+    throw std::runtime_error("Screen recording file has no index (recording not stopped properly).");
+  }
+  if (frameIndex >= result.frameCount) {
+    throw std::runtime_error("Frame index out of range: " + std::to_string(frameIndex));
+  }
+
+  // Only read the index up to the requested frame
+  std::vector<ScreenRecordingIndexEntry> index(frameIndex + 1);
+  stream.seekg(indexOffset);
+  for (ScreenRecordingIndexEntry& entry : index) {
+    entry.offset = ReadBinary<uint64_t>(stream);
+    entry.timestampUs = ReadBinary<uint64_t>(stream);
+    entry.flags = ReadBinary<uint8_t>(stream);
+  }
+  uint64_t keyframeIndex = frameIndex;
+  while (keyframeIndex > 0 && !(index[keyframeIndex].flags & SCREEN_RECORDING_KEYFRAME_FLAG)) {
+    keyframeIndex--;
+  }
+
+  size_t frameSize = static_cast<size_t>(result.header.stride) * result.header.height;
+  result.pixels.resize(frameSize);
+  std::vector<uint8_t> payload;
+  std::vector<uint8_t> delta(frameSize);
+  for (uint64_t i = keyframeIndex; i <= frameIndex; i++) {
+    stream.seekg(index[i].offset);
+    uint64_t timestampUs = ReadBinary<uint64_t>(stream);
+    uint8_t flags = ReadBinary<uint8_t>(stream);
+    uint32_t size = ReadBinary<uint32_t>(stream);
+    payload.resize(size);
+    stream.read(reinterpret_cast<char*>(payload.data()), size);
+    if (!stream) {
+      throw std::runtime_error("Unexpected end of screen recording file.");
+    }
+
+    uint8_t* destination = (flags & SCREEN_RECORDING_KEYFRAME_FLAG) ? result.pixels.data() : delta.data();
+    if (flags & SCREEN_RECORDING_STORED_FLAG) {
+      if (size != frameSize) {
+        throw std::runtime_error("Corrupted screen recording frame.");
+      }
+      std::memcpy(destination, payload.data(), frameSize);
+    }
+    else {
+      DecompressFrame(result.header.codec, payload, destination, frameSize);
+    }
+    if (!(flags & SCREEN_RECORDING_KEYFRAME_FLAG)) {
+      XorFrames(result.pixels.data(), delta.data(), result.pixels.data(), frameSize);
+    }
+    result.timestampUs = timestampUs;
   }
+
+  return result;
 }
 
+// Records a screen area at a fixed rate. A capture thread grabs frames on
+// absolute deadlines and hands them to encoder threads (delta + compression),
+// which append them in order to the recording file. Frames are dropped rather
+// than delaying the capture when encoders fall behind.
+class ScreenRecorder {
+  public:
+    ScreenRecorder(
+      std::unique_ptr<ScreenFrameSource> source,
+      const std::filesystem::path& filepath,
+      double fps,
+      FrameCodec codec,
+      int compressionLevel,
+      uint32_t keyframeInterval
+    ) : m_source(std::move(source)),
+        m_fps(fps),
+        m_codec(codec),
+        m_compressionLevel(compressionLevel),
+        m_keyframeInterval(std::max(1u, keyframeInterval)),
+        m_frameSize(m_source->stride() * m_source->height()),
+        m_writer(filepath, {
+          static_cast<uint32_t>(m_source->width()),
+          static_cast<uint32_t>(m_source->height()),
+          static_cast<uint32_t>(m_source->stride()),
+          codec,
+          m_keyframeInterval,
+          fps
+        }) {
+      unsigned int encoderCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+      m_maxPendingFrames = encoderCount * 2;
+      m_isRunning = true;
+      for (unsigned int i = 0; i < encoderCount; i++) {
+        m_encoderThreads.emplace_back(&ScreenRecorder::encodeLoop, this);
+      }
+      m_captureThread = std::thread(&ScreenRecorder::captureLoop, this);
+    }
 
-// =============================================================================
-// ============================= RESOURCE CLEANUP ==============================
-// =============================================================================
+    ~ScreenRecorder() {
+      try {
+        stop();
+      } catch (...) {
+        // Nobody is left to report the failure to
+      }
+    }
 
-// Function to clean up tray icon resources, ONLY CALLABLE BY TRAY ICON THREAD
-void CleanupTrayIcon() {
-  std::lock_guard<std::mutex> lock(trayIconMutex);
-  // Remove the tray icon before closing the window
-  Shell_NotifyIconW(NIM_DELETE, &nid);
+    ScreenRecorder(const ScreenRecorder&) = delete;
+    ScreenRecorder& operator=(const ScreenRecorder&) = delete;
 
-  // Destroy the window associated with the tray icon
-  if (trayIconWindowHwnd) {
-    DestroyWindow(trayIconWindowHwnd);
-  }
+  public:
+    ScreenRecordingStats stop() {
+      std::lock_guard<std::mutex> stopLock(m_stopMutex);
+      if (m_isRunning.exchange(false)) {
+        m_captureThread.join();
+        {
+          std::lock_guard<std::mutex> lock(m_jobsMutex);
+          m_isCaptureDone = true;
+        }
+        m_jobsCondition.notify_all();
+        for (auto& thread : m_encoderThreads) {
+          thread.join();
+        }
+        m_writer.finish();
+      }
+      return { m_writer.frameCount(), m_droppedFrameCount.load(), m_durationMs };
+    }
 
-  // Unregister the window class (only if not reusing the class name elsewhere)
-  UnregisterClassW(L"TrayIconClass", GetModuleHandle(NULL));
+  private:
+    struct FrameJob {
+      uint64_t sequence;
+      uint64_t timestampUs;
+      bool isKeyframe;
+      std::shared_ptr<std::vector<uint8_t>> frame;
+      std::shared_ptr<std::vector<uint8_t>> previousFrame;
+    };
+
+    struct EncodedFrame {
+      uint64_t timestampUs;
+      uint8_t flags;
+      std::vector<uint8_t> payload;
+    };
+
+    // Reuse a pooled frame buffer no longer referenced by any job
+    std::shared_ptr<std::vector<uint8_t>> acquireFrameBuffer() {
+      for (const auto& buffer : m_framePool) {
+        if (buffer.use_count() == 1) {
+          return buffer;
+        }
+      }
+      if (m_framePool.size() < m_maxPendingFrames + 2) {
+        m_framePool.push_back(std::make_shared<std::vector<uint8_t>>(m_frameSize));
+        return m_framePool.back();
+      }
+      return nullptr;
+    }
 
-  // Clear tray icon menu items callbacks
-  for (const auto& [id, trayIconMenuItemJsCallback] : trayIconMenuItemsJsCallbacks) {
-    trayIconMenuItemJsCallback.Abort();
-  }
-  trayIconMenuItemsJsCallbacks.clear();
-  trayIconMenuItemsCallbacks.clear();
+    void captureLoop() {
+      m_source->attachToCurrentThread();
+      const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_fps));
+      const auto startTime = std::chrono::steady_clock::now();
+      auto deadline = startTime;
+      std::shared_ptr<std::vector<uint8_t>> previousFrame;
+      uint64_t sequence = 0;
+      uint32_t framesSinceKeyframe = 0;
+
+      while (m_isRunning.load()) {
+        std::this_thread::sleep_until(deadline);
+        if (!m_isRunning.load()) break;
+
+        uint64_t timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+        bool hasRoom;
+        {
+          std::lock_guard<std::mutex> lock(m_jobsMutex);
+          hasRoom = m_jobs.size() < m_maxPendingFrames;
+        }
+        std::shared_ptr<std::vector<uint8_t>> frame = hasRoom ? acquireFrameBuffer() : nullptr;
 
-  // Reset tray icon state
-  trayIconRunning = false;
-  trayIconCondition.notify_all();
-}
+        if (frame && m_source->grab(frame->data())) {
+          bool isKeyframe = !previousFrame || framesSinceKeyframe >= m_keyframeInterval;
+          {
+            std::lock_guard<std::mutex> lock(m_jobsMutex);
+            m_jobs.push({ sequence++, timestampUs, isKeyframe, frame, isKeyframe ? nullptr : previousFrame });
+          }
+          m_jobsCondition.notify_one();
+          previousFrame = frame;
+          framesSinceKeyframe = isKeyframe ? 1 : framesSinceKeyframe + 1;
+        }
+        else {
+          m_droppedFrameCount++;
+        }
 
-void CleanAll() {
-  if (inputEventRunning.load()) {
-    inputEventRunning = false;
-    inputEventQueueCondition.notify_all();
-    {
-      std::unique_lock<std::mutex> lock(inputEventHookMutex);
-      inputEventHookCondition.wait(lock, [] { return mouseHook == nullptr && keyboardHook == nullptr; });
-    }
-  }
-  if (windowEventRunning.load()) {
-    windowEventRunning = false;
-    windowEventQueueCondition.notify_all();
-    {
-      std::unique_lock<std::mutex> lock(windowEventHookMutex);
-      windowEventHookCondition.wait(lock, [] { return windowEventHooks.empty(); });
-    }
-  }
-  if (trayIconRunning.load()) {
-    // Notify the tray icon thread to close
-    PostMessage(trayIconWindowHwnd, WM_CLOSE, 0, 0);
-    {
-      // Wait for the tray icon thread to close
-      std::unique_lock<std::mutex> lock(trayIconMutex);
-      trayIconCondition.wait(lock, [] { return !trayIconRunning.load(); });
-    }
-  }
-  CloseAudioManager();
-}
+        // Skip missed deadlines instead of bursting to catch up
+        deadline += period;
+        const auto now = std::chrono::steady_clock::now();
+        while (deadline + period <= now) {
+          deadline += period;
+          m_droppedFrameCount++;
+        }
+      }
 
-Napi::Value CleanupResources(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-  CleanAll();
-  return env.Undefined();
-}
+      m_durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    }
 
-// =============================================================================
-// ============================= HOOK PROCEDURES ===============================
-// =============================================================================
+    void encodeLoop() {
+      ZSTD_CCtx* zstdContext = m_codec == FrameCodec::Zstd ? ZSTD_createCCtx() : nullptr;
+      std::vector<uint8_t> delta;
 
-// Mouse hook procedure
-LRESULT CALLBACK MouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
-  if (nCode >= 0) {
-    MSLLHOOKSTRUCT* mouseStruct = reinterpret_cast<MSLLHOOKSTRUCT*>(lParam);
-    if (mouseStruct) {
-      std::string input;
-      int mappedInput;
-      std::string state;
-      int mappedState;
-      switch (wParam) {
-        case WM_LBUTTONDOWN: {
-          input = "left";
-          mappedInput = 1;
-          state = "down";
-          mappedState = 0;
-          break;
+      while (true) {
+        FrameJob job;
+        {
+          std::unique_lock<std::mutex> lock(m_jobsMutex);
+          m_jobsCondition.wait(lock, [this] { return !m_jobs.empty() || m_isCaptureDone; });
+          if (m_jobs.empty()) break;
+          job = std::move(m_jobs.front());
+          m_jobs.pop();
         }
-        case WM_LBUTTONUP: {
-          input = "left";
-          mappedInput = 1;
-          state = "up";
-          mappedState = 1;
-          break;
+
+        const uint8_t* source = job.frame->data();
+        if (!job.isKeyframe) {
+          delta.resize(m_frameSize);
+          XorFrames(job.frame->data(), job.previousFrame->data(), delta.data(), m_frameSize);
+          source = delta.data();
         }
-        case WM_RBUTTONDOWN: {
-          input = "right";
-          mappedInput = 2;
-          state = "down";
-          mappedState = 0;
-          break;
+
+        EncodedFrame encodedFrame{ job.timestampUs, static_cast<uint8_t>(job.isKeyframe ? SCREEN_RECORDING_KEYFRAME_FLAG : 0), {} };
+        if (!CompressFrame(m_codec, m_compressionLevel, source, m_frameSize, encodedFrame.payload, zstdContext)) {
+          encodedFrame.payload.assign(source, source + m_frameSize);
+          encodedFrame.flags |= SCREEN_RECORDING_STORED_FLAG;
         }
-        case WM_RBUTTONUP: {
-          input = "right";
-          mappedInput = 2;
-          state = "up";
-          mappedState = 1;
-          break;
+
+        // Give the frame buffers back to the pool
+        job.frame.reset();
+        job.previousFrame.reset();
+
+        writeInOrder(job.sequence, std::move(encodedFrame));
+      }
+
+      if (zstdContext) {
+        ZSTD_freeCCtx(zstdContext);
+      }
+    }
+
+    void writeInOrder(uint64_t sequence, EncodedFrame encodedFrame) {
+      std::lock_guard<std::mutex> lock(m_writeMutex);
+      m_encodedFrames.emplace(sequence, std::move(encodedFrame));
+      for (
+        auto it = m_encodedFrames.find(m_nextWriteSequence);
+        it != m_encodedFrames.end();
+        it = m_encodedFrames.find(m_nextWriteSequence)
+      ) {
+        const EncodedFrame& nextFrame = it->second;
+        m_writer.append(nextFrame.timestampUs, nextFrame.flags, nextFrame.payload.data(), static_cast<uint32_t>(nextFrame.payload.size()));
+        m_encodedFrames.erase(it);
+        m_nextWriteSequence++;
+      }
+    }
+
+  private:
+    std::unique_ptr<ScreenFrameSource> m_source;
+    double m_fps;
+    FrameCodec m_codec;
+    int m_compressionLevel;
+    uint32_t m_keyframeInterval;
+    size_t m_frameSize;
+    size_t m_maxPendingFrames = 0;
+    ScreenRecordingWriter m_writer;
+
+    std::atomic<bool> m_isRunning{false};
+    std::mutex m_stopMutex;
+    std::thread m_captureThread;
+    std::vector<std::thread> m_encoderThreads;
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> m_framePool;
+
+    std::mutex m_jobsMutex;
+    std::condition_variable m_jobsCondition;
+    std::queue<FrameJob> m_jobs;
+    bool m_isCaptureDone = false;
+
+    std::mutex m_writeMutex;
+    std::map<uint64_t, EncodedFrame> m_encodedFrames;
+    uint64_t m_nextWriteSequence = 0;
+
+    std::atomic<uint64_t> m_droppedFrameCount{0};
+    uint64_t m_durationMs = 0;
+};
+
+// Keeps the last seconds of a screen area in memory, ready to be dumped to a
+// screen recording file on demand. Frames are LZ4-compressed (keyframes or
+// XOR deltas) by the capture thread itself and stored in a fixed-size arena
+// used as a ring buffer: memory never grows past the budget, the oldest frames
+// are evicted as new ones come in.
+class FlightRecorder {
+  public:
+    FlightRecorder(
+      std::unique_ptr<ScreenFrameSource> source,
+      double fps,
+      uint64_t durationMs,
+      size_t memoryLimit,
+      uint32_t keyframeInterval
+    ) : m_source(std::move(source)),
+        m_fps(fps),
+        m_durationUs(durationMs * 1000),
+        m_keyframeInterval(std::max(1u, keyframeInterval)),
+        m_frameSize(m_source->stride() * m_source->height()),
+        m_arena(memoryLimit),
+        m_slots(static_cast<size_t>(std::ceil(fps * durationMs / 1000.0)) + 1),
+        m_frame(m_frameSize),
+        m_previousFrame(m_frameSize),
+        m_delta(m_frameSize),
+        m_compressedFrame(LZ4_compressBound(static_cast<int>(m_frameSize))) {
+      m_isRunning = true;
+      m_captureThread = std::thread(&FlightRecorder::captureLoop, this);
+    }
+
+    ~FlightRecorder() {
+      stop();
+    }
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+  public:
+    void stop() {
+      std::lock_guard<std::mutex> stopLock(m_stopMutex);
+      if (m_isRunning.exchange(false)) {
+        m_captureThread.join();
+      }
+    }
+
+    // Write the buffered frames to a screen recording file, starting at the
+    // oldest buffered keyframe
+    ScreenRecordingStats dump(const std::filesystem::path& filepath) {
+      // Copy the frames out of the arena so the capture thread is only
+      // blocked for a memcpy, not for disk writes
+      std::vector<FrameSlot> slots;
+      std::vector<uint8_t> payloads;
+      {
+        std::lock_guard<std::mutex> lock(m_ringMutex);
+        size_t first = 0;
+        while (first < m_slotCount && !(slotAt(first).flags & SCREEN_RECORDING_KEYFRAME_FLAG)) {
+          first++;
         }
-        case WM_MBUTTONDOWN: {
-          input = "middle";
-          mappedInput = 3;
-          state = "down";
-          mappedState = 0;
-          break;
+        size_t payloadsSize = 0;
+        for (size_t i = first; i < m_slotCount; i++) {
+          payloadsSize += slotAt(i).size;
         }
-        case WM_MBUTTONUP: {
-          input = "middle";
-          mappedInput = 3;
-          state = "up";
-          mappedState = 1;
-          break;
+        payloads.resize(payloadsSize);
+        size_t payloadsOffset = 0;
+        for (size_t i = first; i < m_slotCount; i++) {
+          FrameSlot slot = slotAt(i);
+          std::memcpy(payloads.data() + payloadsOffset, m_arena.data() + slot.offset, slot.size);
+          slot.offset = payloadsOffset;
+          payloadsOffset += slot.size;
+          slots.push_back(slot);
         }
-        case WM_MOUSEMOVE: {
-          input = "move";
-          mappedInput = 0;
-          state = "neutral";
-          mappedState = 2;
-          break;
+      }
+
+      ScreenRecordingWriter writer(filepath, {
+        static_cast<uint32_t>(m_source->width()),
+        static_cast<uint32_t>(m_source->height()),
+        static_cast<uint32_t>(m_source->stride()),
+        FrameCodec::Lz4,
+        m_keyframeInterval,
+        m_fps
+      });
+      uint64_t firstTimestampUs = slots.empty() ? 0 : slots.front().timestampUs;
+      for (const FrameSlot& slot : slots) {
+        writer.append(slot.timestampUs - firstTimestampUs, slot.flags, payloads.data() + slot.offset, slot.size);
+      }
+      writer.finish();
+
+      uint64_t durationMs = slots.empty() ? 0 : (slots.back().timestampUs - firstTimestampUs) / 1000;
+      return { slots.size(), m_droppedFrameCount.load(), durationMs };
+    }
+
+  private:
+    struct FrameSlot {
+      size_t offset;
+      uint32_t size;
+      uint64_t timestampUs;
+      uint8_t flags;
+    };
+
+    // i-th buffered frame, from the oldest one
+    FrameSlot& slotAt(size_t i) {
+      return m_slots[(m_firstSlot + i) % m_slots.size()];
+    }
+
+    void evictOldestFrame() {
+      m_firstSlot = (m_firstSlot + 1) % m_slots.size();
+      m_slotCount--;
+    }
+
+    // Store a compressed frame, evicting the oldest frames to make room.
+    // Frames are laid out back to back in the arena, wrapping to its start
+    // when the end is reached, so the frames to evict are always the oldest.
+    bool storeFrame(const uint8_t* payload, uint32_t size, uint64_t timestampUs, uint8_t flags) {
+      if (size > m_arena.size()) {
+        return false;
+      }
+      std::lock_guard<std::mutex> lock(m_ringMutex);
+
+      size_t offset = m_writeOffset;
+      if (offset + size > m_arena.size()) {
+        // Frames left past the write offset belong to the previous lap
+        while (m_slotCount > 0 && slotAt(0).offset >= m_writeOffset) {
+          evictOldestFrame();
         }
-        case WM_MOUSEWHEEL: {
-          short wheelDelta = GET_WHEEL_DELTA_WPARAM(mouseStruct->mouseData);
-          if (wheelDelta > 0) {
-            input = "wheel";
-            mappedInput = 4;
-            state = "up";
-            mappedState = 1;
+        offset = 0;
+      }
+      while (m_slotCount > 0 && slotAt(0).offset >= offset && slotAt(0).offset < offset + size) {
+        evictOldestFrame();
+      }
+      while (m_slotCount > 0 && (m_slotCount == m_slots.size() || timestampUs - slotAt(0).timestampUs > m_durationUs)) {
+        evictOldestFrame();
+      }
+
+      std::memcpy(m_arena.data() + offset, payload, size);
+      m_slotCount++;
+      slotAt(m_slotCount - 1) = { offset, size, timestampUs, flags };
+      m_writeOffset = offset + size;
+      return true;
+    }
+
+    void captureLoop() {
+      m_source->attachToCurrentThread();
+      const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_fps));
+      const auto startTime = std::chrono::steady_clock::now();
+      auto deadline = startTime;
+      bool hasPreviousFrame = false;
+      uint32_t framesSinceKeyframe = 0;
+
+      while (m_isRunning.load()) {
+        std::this_thread::sleep_until(deadline);
+        if (!m_isRunning.load()) break;
+
+        uint64_t timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+        bool isStored = false;
+        if (m_source->grab(m_frame.data())) {
+          bool isKeyframe = !hasPreviousFrame || framesSinceKeyframe >= m_keyframeInterval;
+          const uint8_t* source = m_frame.data();
+          if (!isKeyframe) {
+            XorFrames(m_frame.data(), m_previousFrame.data(), m_delta.data(), m_frameSize);
+            source = m_delta.data();
           }
-          else if (wheelDelta < 0) {
-            input = "wheel";
-            mappedInput = 4;
-            state = "down";
-            mappedState = 0;
+          int compressedSize = LZ4_compress_default(
+            reinterpret_cast<const char*>(source),
+            reinterpret_cast<char*>(m_compressedFrame.data()),
+            static_cast<int>(m_frameSize),
+            static_cast<int>(m_compressedFrame.size())
+          );
+          uint8_t flags = isKeyframe ? SCREEN_RECORDING_KEYFRAME_FLAG : 0;
+          isStored = compressedSize > 0 && storeFrame(m_compressedFrame.data(), static_cast<uint32_t>(compressedSize), timestampUs, flags);
+          if (isStored) {
+            std::swap(m_frame, m_previousFrame);
+            hasPreviousFrame = true;
+            framesSinceKeyframe = isKeyframe ? 1 : framesSinceKeyframe + 1;
           }
           else {
-            input = "wheel";
-            mappedInput = 4;
-            state = "neutral";
-            mappedState = 2;
+            // The next frame has no stored frame to be a delta of
+            hasPreviousFrame = false;
           }
-          break;
-        }
-        case WM_XBUTTONDOWN: {
-          WORD xButton = HIWORD(mouseStruct->mouseData);
-          input = "extraButton" + std::to_string(xButton);
-          mappedInput = 4 + xButton;
-          state = "down";
-          mappedState = 0;
-          break;
         }
-        case WM_XBUTTONUP: {
-          WORD xButton = HIWORD(mouseStruct->mouseData);
-          input = "extraButton" + std::to_string(xButton);
-          mappedInput = 4 + xButton;
-          state = "up";
-          mappedState = 1;
-          break;
+        if (!isStored) {
+          m_droppedFrameCount++;
         }
-      }
 
-      if (!input.empty()) {
-        bool isInputInjected = (mouseStruct->flags & LLMHF_INJECTED) != 0;
-        bool isInputSuppressed = false;
-        {
-          std::lock_guard<std::mutex> lock(suppressedKeysMutex);
-          isInputSuppressed = suppressedMouseKeys.find(mappedInput) != suppressedMouseKeys.end() && suppressedMouseKeys[mappedInput].find(mappedState) != suppressedMouseKeys[mappedInput].end();
-        }
-        {
-          RawInputEvent event = { "mouse", input, state, mouseStruct->pt.x, mouseStruct->pt.y, 0, Now(), isInputSuppressed, isInputInjected };
-          std::lock_guard<std::mutex> lock(inputEventQueueMutex);
-          inputEventQueue.push(event);
-          inputEventQueueCondition.notify_all();
-        }
-        if (isInputSuppressed) {
-          return 1;
+        // Skip missed deadlines instead of bursting to catch up
+        deadline += period;
+        const auto now = std::chrono::steady_clock::now();
+        while (deadline + period <= now) {
+          deadline += period;
+          m_droppedFrameCount++;
         }
       }
     }
-  }
-  return CallNextHookEx(nullptr, nCode, wParam, lParam);
-}
 
-// Keyboard hook procedure
-LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
-  if (nCode >= 0) {
-    KBDLLHOOKSTRUCT* kbStruct = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-    if (kbStruct) {
-      std::string state;
-      int mappedState;
-      switch (wParam) {
-        case WM_KEYDOWN: {
-          state = "down";
-          mappedState = 0;
-          break;
-        }
-        case WM_KEYUP: {
-          state = "up";
-          mappedState = 1;
-          break;
-        }
-      }
+  private:
+    std::unique_ptr<ScreenFrameSource> m_source;
+    double m_fps;
+    uint64_t m_durationUs;
+    uint32_t m_keyframeInterval;
+    size_t m_frameSize;
+
+    std::atomic<bool> m_isRunning{false};
+    std::mutex m_stopMutex;
+    std::thread m_captureThread;
+
+    // Ring buffer, guarded by m_ringMutex
+    std::mutex m_ringMutex;
+    std::vector<uint8_t> m_arena;
+    std::vector<FrameSlot> m_slots;
+    size_t m_firstSlot = 0;
+    size_t m_slotCount = 0;
+    size_t m_writeOffset = 0;
+
+    std::atomic<uint64_t> m_droppedFrameCount{0};
+
+    // Capture thread buffers, allocated once
+    std::vector<uint8_t> m_frame;
+    std::vector<uint8_t> m_previousFrame;
+    std::vector<uint8_t> m_delta;
+    std::vector<uint8_t> m_compressedFrame;
+};
 
-      if (!state.empty()) {
-        bool isInputInjected = (kbStruct->flags & LLKHF_INJECTED) != 0;
-        int vkCode = static_cast<int>(kbStruct->vkCode);
-        bool isInputSuppressed = false;
-        {
-          std::lock_guard<std::mutex> lock(suppressedKeysMutex);
-          isInputSuppressed = suppressedKeyboardKeys.find(vkCode) != suppressedKeyboardKeys.end() && suppressedKeyboardKeys[vkCode].find(mappedState) != suppressedKeyboardKeys[vkCode].end();
-        }
-        {
-          RawInputEvent event = { "keyboard", "", state, 0, 0, vkCode, Now(), isInputSuppressed, isInputInjected };
-          std::lock_guard<std::mutex> lock(inputEventQueueMutex);
-          inputEventQueue.push(event);
-          inputEventQueueCondition.notify_all();
-        }
-        if (isInputSuppressed) {
-          return 1;
-        }
-      }
+// Shared memory layout of a screen frame feed (see ScreenFrameFeedReader):
+//   header   16 x int32: sequence | slot | width | height | stride | slot count | slots offset | slot size | state
+//   metadata slot count x (int32 sequence | int32 reserved | float64 timestamp in ms)
+//   slots    slot count x packed BGRA pixels, 64-byte aligned
+// A slot sequence is 0 while its pixels are being written, so readers can
+// detect a frame overwritten while they were reading it (seqlock).
+const size_t SCREEN_FRAME_FEED_HEADER_SIZE = 64;
+const size_t SCREEN_FRAME_FEED_SLOT_METADATA_SIZE = 16;
+enum ScreenFrameFeedHeaderField {
+  FEED_SEQUENCE = 0,
+  FEED_SLOT = 1,
+  FEED_WIDTH = 2,
+  FEED_HEIGHT = 3,
+  FEED_STRIDE = 4,
+  FEED_SLOT_COUNT = 5,
+  FEED_SLOTS_OFFSET = 6,
+  FEED_SLOT_SIZE = 7,
+  FEED_STATE = 8,
+};
+
+// Captures a screen area at a fixed rate straight into a ring of slots living
+// in memory shared with JS (a SharedArrayBuffer), publishing each frame with
+// atomic stores. No copy nor JS call is needed for readers to see new frames.
+class ScreenFrameFeed {
+  public:
+    static size_t requiredMemorySize(const ScreenFrameSource& source, uint32_t slotCount) {
+      return slotsOffset(slotCount) + slotCount * slotSize(source);
     }
-  }
-  return CallNextHookEx(nullptr, nCode, wParam, lParam);
-}
 
-// Function to convert event data to a JavaScript object
-Napi::Object BuildInputEventObject(const Napi::Env& env, const RawInputEvent& event) {
-  Napi::Object eventObj = Napi::Object::New(env);
-  eventObj.Set(Napi::String::New(env, "type"), Napi::String::New(env, event.type));
-  eventObj.Set(Napi::String::New(env, "timestamp"), Napi::Number::New(env, event.timestamp));
-  if (event.type == "mouse") {
-    eventObj.Set(Napi::String::New(env, "input"), Napi::String::New(env, event.input));
-    eventObj.Set(Napi::String::New(env, "state"), Napi::String::New(env, event.state));
-    Napi::Object position = Napi::Object::New(env);
-    position.Set(Napi::String::New(env, "x"), Napi::Number::New(env, event.x));
-    position.Set(Napi::String::New(env, "y"), Napi::Number::New(env, event.y));
-    eventObj.Set(Napi::String::New(env, "position"), position);
-  } else if (event.type == "keyboard") {
-    eventObj.Set(Napi::String::New(env, "input"), Napi::Number::New(env, event.keyCode));
-    eventObj.Set(Napi::String::New(env, "state"), Napi::String::New(env, event.state));
-  }
-  eventObj.Set(Napi::String::New(env, "isInjected"), Napi::Boolean::New(env, event.isInjected));
-  eventObj.Set(Napi::String::New(env, "isSuppressed"), Napi::Boolean::New(env, event.isSuppressed));
-  return eventObj;
-}
+    // `memory` must be zero-initialized and at least requiredMemorySize() bytes
+    ScreenFrameFeed(
+      std::unique_ptr<ScreenFrameSource> source,
+      uint8_t* memory,
+      double fps,
+      uint32_t slotCount,
+      std::function<void()> onFrame
+    ) : m_source(std::move(source)),
+        m_memory(memory),
+        m_fps(fps),
+        m_slotCount(std::max(1u, slotCount)),
+        m_onFrame(std::move(onFrame)) {
+      header(FEED_WIDTH).store(m_source->width());
+      header(FEED_HEIGHT).store(m_source->height());
+      header(FEED_STRIDE).store(static_cast<int32_t>(m_source->stride()));
+      header(FEED_SLOT_COUNT).store(static_cast<int32_t>(m_slotCount));
+      header(FEED_SLOTS_OFFSET).store(static_cast<int32_t>(slotsOffset(m_slotCount)));
+      header(FEED_SLOT_SIZE).store(static_cast<int32_t>(slotSize(*m_source)));
+      header(FEED_STATE).store(1);
+
+      m_isRunning = true;
+      m_captureThread = std::thread(&ScreenFrameFeed::captureLoop, this);
+    }
 
-void ClearHooks() {
-  // Unhook
-  {
-    std::lock_guard<std::mutex> lock(inputEventHookMutex);
-    if (mouseHook) {
-      UnhookWindowsHookEx(mouseHook);
-      mouseHook = nullptr;
+    ~ScreenFrameFeed() {
+      stop();
     }
 
-    if (keyboardHook) {
-      UnhookWindowsHookEx(keyboardHook);
-      keyboardHook = nullptr;
+    ScreenFrameFeed(const ScreenFrameFeed&) = delete;
+    ScreenFrameFeed& operator=(const ScreenFrameFeed&) = delete;
+
+  public:
+    void stop() {
+      std::lock_guard<std::mutex> stopLock(m_stopMutex);
+      if (m_isRunning.exchange(false)) {
+        m_captureThread.join();
+        header(FEED_STATE).store(0);
+      }
     }
-  }
 
-  // Clear callback
-  inputEventThreadSafeJsFunction.Abort();
+    uint64_t droppedFrameCount() const {
+      return m_droppedFrameCount.load();
+    }
 
-  inputEventHookCondition.notify_all();
-}
+  private:
+    static size_t slotSize(const ScreenFrameSource& source) {
+      return (source.stride() * source.height() + 63) & ~static_cast<size_t>(63);
+    }
 
-// Thread to process events and invoke the JavaScript callback
-void InputEventProcessingThread(const Napi::Env& env) {
-  {
-    std::lock_guard<std::mutex> lock(inputEventHookMutex);
-    mouseHook = SetWindowsHookEx(WH_MOUSE_LL, MouseProc, nullptr, 0);
-    if (!mouseHook) {
-      Napi::Error::New(env, "Failed to set mouse hook").ThrowAsJavaScriptException();
-      return;
+    static size_t slotsOffset(uint32_t slotCount) {
+      return (SCREEN_FRAME_FEED_HEADER_SIZE + slotCount * SCREEN_FRAME_FEED_SLOT_METADATA_SIZE + 63) & ~static_cast<size_t>(63);
     }
-    keyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, KeyboardProc, nullptr, 0);
-    if (!keyboardHook) {
-      Napi::Error::New(env, "Failed to set keyboard hook").ThrowAsJavaScriptException();
-      return;
+
+    // Shared int32 fields are accessed atomically, like Atomics does in JS
+    std::atomic<int32_t>& header(ScreenFrameFeedHeaderField field) {
+      return *reinterpret_cast<std::atomic<int32_t>*>(m_memory + field * sizeof(int32_t));
     }
-  }
 
-  inputEventRunning = true;
-  inputEventHookCondition.notify_all();
-  std::thread nestedThread([env]() {
-    while (inputEventRunning) {
-      std::unique_lock<std::mutex> lock(inputEventQueueMutex);
-      inputEventQueueCondition.wait(lock, [] { return !inputEventQueue.empty() || !inputEventRunning; });
+    std::atomic<int32_t>& slotSequence(uint32_t slot) {
+      return *reinterpret_cast<std::atomic<int32_t>*>(m_memory + SCREEN_FRAME_FEED_HEADER_SIZE + slot * SCREEN_FRAME_FEED_SLOT_METADATA_SIZE);
+    }
 
-      while (!inputEventQueue.empty()) {
-        RawInputEvent rawInputEvent = inputEventQueue.front();
-        inputEventQueue.pop();
+    void captureLoop() {
+      m_source->attachToCurrentThread();
+      const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_fps));
+      const auto startTime = std::chrono::steady_clock::now();
+      const size_t frameSlotSize = slotSize(*m_source);
+      const size_t frameSlotsOffset = slotsOffset(m_slotCount);
+      auto deadline = startTime;
+      int32_t sequence = 0;
+
+      while (m_isRunning.load()) {
+        std::this_thread::sleep_until(deadline);
+        if (!m_isRunning.load()) break;
+
+        // Write to the oldest slot, readers of the newest one are never disturbed
+        uint32_t slot = static_cast<uint32_t>(sequence) % m_slotCount;
+        slotSequence(slot).store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        double timestampMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        if (m_source->grab(m_memory + frameSlotsOffset + slot * frameSlotSize)) {
+          sequence = sequence == INT32_MAX ? 1 : sequence + 1;
+          std::memcpy(m_memory + SCREEN_FRAME_FEED_HEADER_SIZE + slot * SCREEN_FRAME_FEED_SLOT_METADATA_SIZE + 8, &timestampMs, sizeof(double));
+          slotSequence(slot).store(sequence, std::memory_order_release);
+          header(FEED_SLOT).store(static_cast<int32_t>(slot), std::memory_order_relaxed);
+          header(FEED_SEQUENCE).store(sequence, std::memory_order_release);
+          m_onFrame();
+        }
+        else {
+          m_droppedFrameCount++;
+        }
 
-        inputEventThreadSafeJsFunction.BlockingCall([rawInputEvent](const Napi::Env& env, const Napi::Function& jsCallback) {
-          if (!jsCallback.IsEmpty()) {
-            jsCallback.Call({ BuildInputEventObject(env, rawInputEvent) });
-          }
-        });
+        // Skip missed deadlines instead of bursting to catch up
+        deadline += period;
+        const auto now = std::chrono::steady_clock::now();
+        while (deadline + period <= now) {
+          deadline += period;
+          m_droppedFrameCount++;
+        }
       }
     }
-    ClearHooks();
-  });
 
-  MSG msg;
-  while (GetMessage(&msg, nullptr, 0, 0)) {
-    TranslateMessage(&msg);
-    DispatchMessage(&msg);
-  }
-  nestedThread.join();
-}
+  private:
+    std::unique_ptr<ScreenFrameSource> m_source;
+    uint8_t* m_memory;
+    double m_fps;
+    uint32_t m_slotCount;
+    std::function<void()> m_onFrame;
+
+    std::atomic<bool> m_isRunning{false};
+    std::mutex m_stopMutex;
+    std::thread m_captureThread;
+    std::atomic<uint64_t> m_droppedFrameCount{0};
+};
 
-// Function to start monitoring input events
-Napi::Value StartInputEventListener(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+// Bounded LRU cache of OCR results, keyed by image content hash and OCR
+// settings. Hit and miss counters help sizing it.
+class OcrResultCache {
+  public:
+    struct Stats {
+      uint64_t hits;
+      uint64_t misses;
+      size_t size;
+      size_t capacity;
+    };
+
+    explicit OcrResultCache(size_t capacity) : m_capacity(capacity) {}
+
+    OcrResultCache(const OcrResultCache&) = delete;
+    OcrResultCache& operator=(const OcrResultCache&) = delete;
+
+    std::optional<OcrResult> get(const std::string& key) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto entry = m_index.find(key);
+      if (entry == m_index.end()) {
+        m_misses++;
+        return std::nullopt;
+      }
+      m_hits++;
+      // Most recently used first
+      m_entries.splice(m_entries.begin(), m_entries, entry->second);
+      return entry->second->second;
+    }
 
-  // Skip if already listening
-  if (inputEventRunning) {
-    return Napi::Boolean::New(env, true);
-  }
+    void put(const std::string& key, const OcrResult& result) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_capacity == 0) {
+        return;
+      }
+      auto entry = m_index.find(key);
+      if (entry != m_index.end()) {
+        entry->second->second = result;
+        m_entries.splice(m_entries.begin(), m_entries, entry->second);
+        return;
+      }
+      m_entries.emplace_front(key, result);
+      m_index[key] = m_entries.begin();
+      evict();
+    }
 
-  // Validate arguments
-  if (info.Length() < 1 || !info[0].IsFunction()) {
-    Napi::TypeError::New(env, "Expected a callback function").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+    void resize(size_t capacity) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_capacity = capacity;
+      evict();
+    }
 
-  // Convert JS callback to a NAPI ThreadSafeFunction
-  inputEventThreadSafeJsFunction = Napi::ThreadSafeFunction::New(
-    env, // the main NAPI environment
-    info[0].As<Napi::Function>(), // callback function that needs to be called in thread(s)
-    "callback", // JS string used to provide diagnostic information
-    0, // maximum queue size (0 for unlimited)
-    1, // initial number of threads which will be making use of this function
-    [](const Napi::Env& env) { // finalizer callback, can be used to clean threads up
+    // Drop all entries and reset the counters
+    void clear() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_entries.clear();
+      m_index.clear();
+      m_hits = 0;
+      m_misses = 0;
     }
-  );
 
-  // Start event processing thread
-  std::thread(InputEventProcessingThread, env).detach();
-  {
-    std::unique_lock<std::mutex> lock(inputEventHookMutex);
-    inputEventHookCondition.wait(lock, [] { return inputEventRunning.load(); });
-  }
-  return Napi::Boolean::New(env, true);
-}
+    Stats stats() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return { m_hits, m_misses, m_entries.size(), m_capacity };
+    }
 
-// Function to stop monitoring input events
-Napi::Value StopInputEventListener(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+  private:
+    // Drop least recently used entries beyond capacity. Requires the lock.
+    void evict() {
+      while (m_entries.size() > m_capacity) {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+      }
+    }
 
-  CleanAll();
+    std::mutex m_mutex;
+    std::list<std::pair<std::string, OcrResult>> m_entries;
+    std::unordered_map<std::string, std::list<std::pair<std::string, OcrResult>>::iterator> m_index;
+    size_t m_capacity;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+};
 
-  return Napi::Boolean::New(env, true);
-}
+// Input sequence program: flat int32 records of
+//   opcode | first argument | second argument | delay in us since the previous event
+// Buttons are 1 (left), 2 (middle), 3 (right), 4 and 5 (extra buttons 1 and 2).
+// Scroll amounts are positive downwards, in wheel delta units.
+const size_t INPUT_SEQUENCE_RECORD_SIZE = 4;
+
+enum class InputSequenceOpcode : int32_t {
+  Move = 0, // x | y
+  ButtonDown = 1, // button
+  ButtonUp = 2, // button
+  Scroll = 3, // amount
+  KeyDown = 4, // virtual key code
+  KeyUp = 5, // virtual key code
+};
 
-void SuppressInputEvents(int type, std::map<int, std::set<int>> inputStateMap) {
-  std::lock_guard<std::mutex> lock(suppressedKeysMutex);
-  if (type == 0) {
-    // Mouse
-    for (auto& [input, states] : inputStateMap) {
-      if (suppressedMouseKeys.find(input) == suppressedMouseKeys.end()) {
-        suppressedMouseKeys[input] = std::set<int>();
-      }
-      for (int state : states) {
-        suppressedMouseKeys[input].insert(state);
-      }
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+// Sleep until an absolute steady clock deadline. The default timer resolution
+// being ~15.6 ms, a high resolution waitable timer is used when available
+// (Windows 10 1803+), then the last microseconds (at least 100) are spun.
+void SleepUntil(std::chrono::steady_clock::time_point deadline, std::chrono::microseconds spinWindow = std::chrono::microseconds(0)) {
+  thread_local HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+  spinWindow = std::max(spinWindow, std::chrono::microseconds(100));
+  const auto remaining = deadline - std::chrono::steady_clock::now();
+  if (timer && remaining > spinWindow) {
+    LARGE_INTEGER dueTime;
+    // Negative due times are relative, in 100 ns units
+    dueTime.QuadPart = -static_cast<LONGLONG>(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining - spinWindow).count() / 100);
+    if (SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+      WaitForSingleObject(timer, INFINITE);
     }
   }
-  else {
-    // Keyboard
-    for (auto& [input, states] : inputStateMap) {
-      if (suppressedKeyboardKeys.find(input) == suppressedKeyboardKeys.end()) {
-        suppressedKeyboardKeys[input] = std::set<int>();
-      }
-      for (int state : states) {
-        suppressedKeyboardKeys[input].insert(state);
-      }
-    }
+  while (std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
   }
 }
 
-// Function to suppress input events of given type, input and states
-Napi::Value SuppressInputEventsWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+// Spin window of precise sleeps, above the jitter of high resolution timers
+const std::chrono::microseconds PRECISE_SLEEP_SPIN_WINDOW(1000);
 
-  // Validate arguments
-  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsArray() || info[1].As<Napi::Array>().Length() < 1) {
-    Napi::TypeError::New(env, "Expected two arguments").ThrowAsJavaScriptException();
-    return env.Null();
+// Margin before a deadline below which interruptible waits stop waiting on a
+// condition variable (as coarse as the default timer resolution) and sleep on
+// a waitable timer instead
+const std::chrono::microseconds TIMER_SLEEP_MARGIN(20000);
+
+// Build an absolute mouse move to (x, y), relative to the main monitor
+INPUT BuildMouseMoveInput(int x, int y) {
+  // Virtual screen coordinates
+  int virtualScreenLeft = GetSystemMetrics(SM_XVIRTUALSCREEN);
+  int virtualScreenTop = GetSystemMetrics(SM_YVIRTUALSCREEN);
+  int virtualScreenWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
+  int virtualScreenHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
+
+  // User coordinates relative to the main monitor (with origin in top-left corner at 0,0)
+  int relativeToMainMonitorX = x;
+  int relativeToMainMonitorY = y;
+
+  // Convert user coordinates to virtual screen coordinates
+  int virtualX = relativeToMainMonitorX - virtualScreenLeft;
+  int virtualY = relativeToMainMonitorY - virtualScreenTop;
+
+  // Double to int conversion will result in precision loss.
+  // Putting the coordinate 0.5 above its value will result in less loss.
+  double roundingOffsetMitigator = 0.5;
+
+  // Normalize the coordinates between 0 and 1
+  double normalizedX = (static_cast<double>(virtualX) + roundingOffsetMitigator) / static_cast<double>(virtualScreenWidth);
+  double normalizedY = (static_cast<double>(virtualY) + roundingOffsetMitigator) / static_cast<double>(virtualScreenHeight);
+
+  // Convert normalized coordinates to absolute coordinates between 0 and 65535.
+  // Windows will then reconvert the absolute coordinate to screen coordinates.
+  // It will result in loss of precision. Some pixels will thefore never be
+  // reachable by SendInput.
+  // There is no way around this. Using `setCursorPos` API is more precise but
+  // triggers no input events.
+  int absoluteX = static_cast<int>(std::round((normalizedX) * 65536.0));
+  int absoluteY = static_cast<int>(std::round((normalizedY) * 65536.0));
+
+  // Prepare the INPUT structure
+  INPUT input = { 0 };
+  input.type = INPUT_MOUSE;
+  input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_VIRTUALDESK | MOUSEEVENTF_ABSOLUTE;
+  input.mi.dx = absoluteX;
+  input.mi.dy = absoluteY;
+  return input;
+}
+
+// Number of characters typed per SendInput call when text is typed without
+// delay, so that applications start processing a long text early
+const size_t TEXT_FLUSH_CHUNK_SIZE = 64;
+
+// Unicode notation of a code point (U+00E9)
+std::string FormatCodePoint(char32_t character) {
+  std::ostringstream stream;
+  stream << "U+" << std::uppercase << std::hex << std::setw(4) << std::setfill('0') << static_cast<uint32_t>(character);
+  return stream.str();
+}
+
+// Whether a character is a control character without key (all of them but
+// tabs and line breaks)
+bool IsUntypableControlCharacter(wchar_t character) {
+  if (character == L'\n' || character == L'\r' || character == L'\t') {
+    return false;
   }
+  return character < 0x20 || (character >= 0x7F && character < 0xA0);
+}
 
-  // Translate JS input state map to C++ input state map
-  std::map<int, std::set<int>> inputStateMap;
-  unsigned int type = info[0].As<Napi::Number>().Int32Value();
-  Napi::Array jsInputStateMap = info[1].As<Napi::Array>();
-  for (unsigned int i = 0; i < jsInputStateMap.Length(); i++) {
-    if (!jsInputStateMap.Has(i)) {
-      continue;
-    }
-    Napi::Value jsRawInputStates = jsInputStateMap[i];
-    if (!jsRawInputStates.IsArray()) {
-      continue;
-    }
-    Napi::Array jsInputStates = jsRawInputStates.As<Napi::Array>();
-    Napi::Value jsRawInput = jsInputStates[static_cast<unsigned int>(0)];
-    if (!jsRawInput.IsNumber()) {
-      continue;
-    }
-    Napi::Number jsInput = jsRawInput.As<Napi::Number>();
-    int input = jsInput.Int32Value();
-    if (inputStateMap.find(input) == inputStateMap.end()) {
-      inputStateMap[input] = std::set<int>();
+// Runs input sequence programs one after another on a dedicated thread, so
+// that sequences never interleave. Events are sent on absolute deadlines
+// (delays never drift), with a single SendInput call per deadline.
+class InputSequencer {
+  public:
+    // Called on the sequencer thread once a program ran, with the error that
+    // interrupted it if any
+    using Callback = std::function<void(std::exception_ptr)>;
+
+    InputSequencer() { }
+
+    ~InputSequencer() {
+      stop();
     }
-    Napi::Value jsRawStates = jsInputStates[1];
-    if (!jsRawStates.IsArray()) {
-      continue;
+
+    InputSequencer(const InputSequencer&) = delete;
+    InputSequencer& operator=(const InputSequencer&) = delete;
+
+  public:
+    void submit(std::vector<int32_t> program, Callback onDone) {
+      push({ std::move(program), std::move(onDone) });
     }
-    Napi::Array jsStates = jsRawStates.As<Napi::Array>();
-    for (unsigned int j = 0; j < jsStates.Length(); j++) {
-      Napi::Value jsRawState = jsStates[j];
-      if (!jsRawState.IsNumber()) {
-        continue;
-      }
-      Napi::Number jsState = jsRawState.As<Napi::Number>();
-      int state = jsState.Int32Value();
-      inputStateMap[input].insert(state);
+
+    // Type a text, waiting the interval before each character
+    void submitText(std::wstring text, std::chrono::microseconds interval, Callback onDone) {
+      push({ {}, std::move(onDone), std::move(text), interval });
     }
-  }
-  // Register inputs to be suppressed
-  SuppressInputEvents(type, inputStateMap);
-  // Return undefined
-  return env.Undefined();
-}
 
-void UnsuppressInputEvents(int type, std::map<int, std::set<int>> inputStateMap) {
-  std::lock_guard<std::mutex> lock(suppressedKeysMutex);
-  if (type == 0) {
-    // Mouse
-    for (auto& [input, states] : inputStateMap) {
-      if (suppressedMouseKeys.find(input) == suppressedMouseKeys.end()) {
-        continue;
+    // Interrupt the running program and cancel the queued ones
+    void stop() {
+      std::thread thread;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isRunning = false;
+        thread = std::move(m_thread);
       }
-      for (int state : states) {
-        suppressedMouseKeys[input].erase(state);
+      m_condition.notify_all();
+      if (thread.joinable()) {
+        thread.join();
       }
-      if (suppressedMouseKeys[input].empty()) {
-        suppressedMouseKeys.erase(input);
+    }
+
+  private:
+    struct Job {
+      std::vector<int32_t> program;
+      Callback onDone;
+      std::wstring text;
+      std::chrono::microseconds interval{0};
+    };
+
+    void push(Job job) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_thread.joinable()) {
+        m_isRunning = true;
+        m_thread = std::thread(&InputSequencer::run, this);
       }
+      m_jobs.push(std::move(job));
+      m_condition.notify_all();
     }
-  }
-  else {
-    // Keyboard
-    for (auto& [input, states] : inputStateMap) {
-      if (suppressedKeyboardKeys.find(input) == suppressedKeyboardKeys.end()) {
-        continue;
+
+    void run() {
+      while (true) {
+        Job job;
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          m_condition.wait(lock, [this] { return !m_jobs.empty() || !m_isRunning; });
+          if (!m_isRunning) break;
+          job = std::move(m_jobs.front());
+          m_jobs.pop();
+        }
+        std::exception_ptr error;
+        try {
+          if (!job.text.empty()) {
+            type(job.text, job.interval);
+          }
+          else {
+            execute(job.program);
+          }
+        }
+        catch (...) {
+          error = std::current_exception();
+        }
+        job.onDone(error);
       }
-      for (int state : states) {
-        suppressedKeyboardKeys[input].erase(state);
+
+      std::queue<Job> cancelledJobs;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(cancelledJobs, m_jobs);
       }
-      if (suppressedKeyboardKeys[input].empty()) {
-        suppressedKeyboardKeys.erase(input);
+      for (; !cancelledJobs.empty(); cancelledJobs.pop()) {
+        cancelledJobs.front().onDone(std::make_exception_ptr(std::runtime_error("Input sequence was cancelled.")));
       }
     }
-  }
-}
 
-// Function to unsuppress input events of given type, input and states
-Napi::Value UnsuppressInputEventsWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+    // Interruptible coarse wait, then a precise sleep for the last milliseconds.
+    // Returns false when the sequencer was stopped meanwhile.
+    bool waitUntil(std::chrono::steady_clock::time_point deadline) {
+      const auto coarseDeadline = deadline - std::chrono::milliseconds(20);
+      if (std::chrono::steady_clock::now() < coarseDeadline) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_condition.wait_until(lock, coarseDeadline, [this] { return !m_isRunning.load(); })) {
+          return false;
+        }
+      }
+      SleepUntil(deadline);
+      return m_isRunning.load();
+    }
 
-  // Validate arguments
-  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsArray() || info[1].As<Napi::Array>().Length() < 1) {
-    Napi::TypeError::New(env, "Expected two arguments").ThrowAsJavaScriptException();
-    return env.Null();
-  }
+    static void appendInputs(const int32_t* record, std::vector<INPUT>& inputs) {
+      static const DWORD buttonDownFlags[] = { 0, MOUSEEVENTF_LEFTDOWN, MOUSEEVENTF_MIDDLEDOWN, MOUSEEVENTF_RIGHTDOWN, MOUSEEVENTF_XDOWN, MOUSEEVENTF_XDOWN };
+      static const DWORD buttonUpFlags[] = { 0, MOUSEEVENTF_LEFTUP, MOUSEEVENTF_MIDDLEUP, MOUSEEVENTF_RIGHTUP, MOUSEEVENTF_XUP, MOUSEEVENTF_XUP };
+      INPUT input = { 0 };
+      switch (static_cast<InputSequenceOpcode>(record[0])) {
+        case InputSequenceOpcode::Move:
+          input = BuildMouseMoveInput(record[1], record[2]);
+          break;
+        case InputSequenceOpcode::ButtonDown:
+        case InputSequenceOpcode::ButtonUp:
+          input.type = INPUT_MOUSE;
+          input.mi.dwFlags = static_cast<InputSequenceOpcode>(record[0]) == InputSequenceOpcode::ButtonDown ? buttonDownFlags[record[1]] : buttonUpFlags[record[1]];
+          input.mi.mouseData = record[1] == 4 ? XBUTTON1 : (record[1] == 5 ? XBUTTON2 : 0);
+          break;
+        case InputSequenceOpcode::Scroll:
+          input.type = INPUT_MOUSE;
+          input.mi.dwFlags = MOUSEEVENTF_WHEEL;
+          input.mi.mouseData = static_cast<DWORD>(-record[1]);
+          break;
+        case InputSequenceOpcode::KeyDown:
+        case InputSequenceOpcode::KeyUp:
+          input.type = INPUT_KEYBOARD;
+          input.ki.dwFlags = KEYEVENTF_SCANCODE | (static_cast<InputSequenceOpcode>(record[0]) == InputSequenceOpcode::KeyUp ? KEYEVENTF_KEYUP : 0);
+          input.ki.wScan = MapVirtualKey(record[1], MAPVK_VK_TO_VSC);
+          break;
+      }
+      inputs.push_back(input);
+    }
 
-  // Translate JS input state map to C++ input state map
-  std::map<int, std::set<int>> inputStateMap;
-  unsigned int type = info[0].As<Napi::Number>().Int32Value();
-  Napi::Array jsInputStateMap = info[1].As<Napi::Array>();
-  for (unsigned int i = 0; i < jsInputStateMap.Length(); i++) {
-    if (!jsInputStateMap.Has(i)) {
-      continue;
+    static void sendInputs(std::vector<INPUT>& inputs) {
+      if (inputs.empty()) {
+        return;
+      }
+      UINT sentCount = SendInput(static_cast<UINT>(inputs.size()), inputs.data(), sizeof(INPUT));
+      inputs.clear();
+      if (sentCount == 0) {
+        throw std::runtime_error("Failed to send input sequence events");
+      }
     }
-    Napi::Value jsRawInputStates = jsInputStateMap[i];
-    if (!jsRawInputStates.IsArray()) {
-      continue;
+
+    void execute(const std::vector<int32_t>& program) {
+      const size_t eventCount = program.size() / INPUT_SEQUENCE_RECORD_SIZE;
+      std::vector<INPUT> inputs;
+      auto deadline = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < eventCount; i++) {
+        const int32_t* record = &program[i * INPUT_SEQUENCE_RECORD_SIZE];
+        if (record[3] > 0) {
+          // Send the events due at the previous deadline before sleeping
+          sendInputs(inputs);
+          deadline += std::chrono::microseconds(record[3]);
+          if (!waitUntil(deadline)) {
+            throw std::runtime_error("Input sequence was cancelled.");
+          }
+        }
+        else if (!m_isRunning.load()) {
+          throw std::runtime_error("Input sequence was cancelled.");
+        }
+        appendInputs(record, inputs);
+      }
+      sendInputs(inputs);
     }
-    Napi::Array jsInputStates = jsRawInputStates.As<Napi::Array>();
-    Napi::Value jsRawInput = jsInputStates[static_cast<unsigned int>(0)];
-    if (!jsRawInput.IsNumber()) {
-      continue;
+
+    static void appendKeyInputs(HKL layout, BYTE virtualKey, bool isDown, std::vector<INPUT>& inputs) {
+      WORD scanCode = static_cast<WORD>(MapVirtualKeyEx(virtualKey, MAPVK_VK_TO_VSC_EX, layout));
+      INPUT input = { 0 };
+      input.type = INPUT_KEYBOARD;
+      input.ki.wScan = scanCode & 0xFF;
+      input.ki.dwFlags = KEYEVENTF_SCANCODE | ((scanCode >> 8) == 0xE0 ? KEYEVENTF_EXTENDEDKEY : 0) | (isDown ? 0 : KEYEVENTF_KEYUP);
+      inputs.push_back(input);
     }
-    Napi::Number jsInput = jsRawInput.As<Napi::Number>();
-    int input = jsInput.Int32Value();
-    if (inputStateMap.find(input) == inputStateMap.end()) {
-      inputStateMap[input] = std::set<int>();
+
+    // Type a text with the keys of the foreground window layout. Characters
+    // the layout lacks, or only types with Ctrl or Alt, are typed as Unicode
+    // packets (KEYEVENTF_UNICODE), which are never translated by the layout.
+    void type(const std::wstring& text, std::chrono::microseconds interval) {
+      // Reject untypable characters up front, so that a text is never half typed
+      for (wchar_t character : text) {
+        if (IsUntypableControlCharacter(character)) {
+          throw std::runtime_error("Cannot type the control character " + FormatCodePoint(character) + ".");
+        }
+      }
+      HKL layout = GetKeyboardLayout(GetWindowThreadProcessId(GetForegroundWindow(), nullptr));
+      const bool isCapsLocked = (GetKeyState(VK_CAPITAL) & 0x0001) != 0;
+      // Keys of the printable ASCII characters, by code point
+      std::array<SHORT, 128> asciiKeys;
+      for (size_t character = 0; character < asciiKeys.size(); character++) {
+        asciiKeys[character] = character >= 0x20 ? VkKeyScanEx(static_cast<WCHAR>(character), layout) : -1;
+      }
+
+      std::vector<INPUT> inputs;
+      bool isShiftPressed = false;
+      auto setShiftPressed = [&](bool isPressed) {
+        if (isPressed != isShiftPressed) {
+          appendKeyInputs(layout, VK_SHIFT, isPressed, inputs);
+          isShiftPressed = isPressed;
+        }
+      };
+
+      try {
+        auto deadline = std::chrono::steady_clock::now();
+        size_t characterIndex = 0;
+        for (size_t i = 0; i < text.size(); i++, characterIndex++) {
+          // Surrogate pairs are typed as one character, line breaks once
+          const bool isSurrogatePair = IS_HIGH_SURROGATE(text[i]) && i + 1 < text.size() && IS_LOW_SURROGATE(text[i + 1]);
+          if (text[i] == L'\r' && i + 1 < text.size() && text[i + 1] == L'\n') {
+            continue;
+          }
+
+          if (interval.count() > 0) {
+            // Send the previous character before sleeping
+            sendInputs(inputs);
+            deadline += interval;
+            if (!waitUntil(deadline)) {
+              throw std::runtime_error("Input sequence was cancelled.");
+            }
+          }
+          else if (characterIndex % TEXT_FLUSH_CHUNK_SIZE == 0) {
+            sendInputs(inputs);
+            if (!m_isRunning.load()) {
+              throw std::runtime_error("Input sequence was cancelled.");
+            }
+          }
+
+          if (text[i] == L'\n' || text[i] == L'\r' || text[i] == L'\t') {
+            setShiftPressed(false);
+            appendKeyInputs(layout, text[i] == L'\t' ? VK_TAB : VK_RETURN, true, inputs);
+            appendKeyInputs(layout, text[i] == L'\t' ? VK_TAB : VK_RETURN, false, inputs);
+            continue;
+          }
+          SHORT key = -1;
+          if (!isSurrogatePair) {
+            key = text[i] < asciiKeys.size() ? asciiKeys[text[i]] : VkKeyScanEx(text[i], layout);
+          }
+          // Keys typed with Shift only (Ctrl and Alt would trigger shortcuts)
+          if (key != -1 && (HIBYTE(key) & ~0x01) == 0) {
+            bool isShifted = (HIBYTE(key) & 0x01) != 0;
+            // Caps Lock swaps the case of letters
+            if (isCapsLocked && IsCharAlphaW(text[i])) {
+              isShifted = !isShifted;
+            }
+            setShiftPressed(isShifted);
+            appendKeyInputs(layout, LOBYTE(key), true, inputs);
+            appendKeyInputs(layout, LOBYTE(key), false, inputs);
+            continue;
+          }
+          for (size_t unit = i; unit <= i + (isSurrogatePair ? 1 : 0); unit++) {
+            INPUT input = { 0 };
+            input.type = INPUT_KEYBOARD;
+            input.ki.wScan = text[unit];
+            input.ki.dwFlags = KEYEVENTF_UNICODE;
+            inputs.push_back(input);
+            input.ki.dwFlags = KEYEVENTF_UNICODE | KEYEVENTF_KEYUP;
+            inputs.push_back(input);
+          }
+          i += isSurrogatePair ? 1 : 0;
+        }
+      }
+      catch (...) {
+        inputs.clear();
+        setShiftPressed(false);
+        sendInputs(inputs);
+        throw;
+      }
+      setShiftPressed(false);
+      sendInputs(inputs);
     }
-    Napi::Value jsRawStates = jsInputStates[1];
-    if (!jsRawStates.IsArray()) {
-      continue;
+
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::queue<Job> m_jobs;
+    std::atomic<bool> m_isRunning{false};
+    std::thread m_thread;
+};
+
+// Fires asynchronous sleeps on a dedicated thread. Timers are kept in a
+// min-heap of absolute deadlines: the thread waits on its condition variable
+// until the earliest timer is near, then on a high resolution waitable timer
+// (woken up when an earlier timer is scheduled) until the spin window of the
+// timer opens, and spins its last microseconds.
+class TimerService {
+  public:
+    // Called on the timer thread when the timer is due, or with true when the
+    // service was stopped before
+    using Callback = std::function<void(bool isCancelled)>;
+
+    TimerService() {
+      m_sleepTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+      m_wakeUpEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
     }
-    Napi::Array jsStates = jsRawStates.As<Napi::Array>();
-    for (unsigned int j = 0; j < jsStates.Length(); j++) {
-      Napi::Value jsRawState = jsStates[j];
-      if (!jsRawState.IsNumber()) {
-        continue;
+
+    ~TimerService() {
+      stop();
+      if (m_sleepTimer) {
+        CloseHandle(m_sleepTimer);
       }
-      Napi::Number jsState = jsRawState.As<Napi::Number>();
-      int state = jsState.Int32Value();
-      inputStateMap[input].insert(state);
+      if (m_wakeUpEvent) {
+        CloseHandle(m_wakeUpEvent);
+      }
+    }
+
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+
+  public:
+    void schedule(std::chrono::steady_clock::time_point deadline, bool isPrecise, Callback onDue) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_thread.joinable()) {
+        m_isRunning = true;
+        m_thread = std::thread(&TimerService::run, this);
+      }
+      m_timers.push_back({ deadline, isPrecise, m_nextSequence++, std::move(onDue) });
+      std::push_heap(m_timers.begin(), m_timers.end(), IsLater());
+      m_condition.notify_all();
+      wakeUp();
+    }
+
+    // Cancel the pending timers
+    void stop() {
+      std::thread thread;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isRunning = false;
+        thread = std::move(m_thread);
+      }
+      m_condition.notify_all();
+      wakeUp();
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+
+  private:
+    void wakeUp() {
+      if (m_wakeUpEvent) {
+        SetEvent(m_wakeUpEvent);
+      }
+    }
+
+    // Sleep until the deadline, or until wakeUp() is called
+    void sleepUntil(std::chrono::steady_clock::time_point deadline) {
+      const auto remaining = deadline - std::chrono::steady_clock::now();
+      LARGE_INTEGER dueTime;
+      // Negative due times are relative, in 100 ns units
+      dueTime.QuadPart = -static_cast<LONGLONG>(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+      if (m_sleepTimer && m_wakeUpEvent && SetWaitableTimer(m_sleepTimer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+        HANDLE handles[] = { m_sleepTimer, m_wakeUpEvent };
+        WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+        return;
+      }
+      // Without high resolution timer, look again every millisecond
+      std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(remaining, std::chrono::milliseconds(1)));
+    }
+
+    struct Timer {
+      std::chrono::steady_clock::time_point deadline;
+      bool isPrecise;
+      // Keeps timers sharing a deadline in scheduling order
+      uint64_t sequence;
+      Callback onDue;
+    };
+
+    struct IsLater {
+      bool operator()(const Timer& a, const Timer& b) const {
+        return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
+      }
+    };
+
+    void run() {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (m_isRunning) {
+        if (m_timers.empty()) {
+          m_condition.wait(lock);
+          continue;
+        }
+        // Leave the earliest timer in the heap while waiting, and look again on
+        // wake-up since an earlier timer may have been scheduled meanwhile
+        const Timer& next = m_timers.front();
+        // SleepUntil spins at least the last 100 us
+        const auto spinWindow = std::max(next.isPrecise ? PRECISE_SLEEP_SPIN_WINDOW : std::chrono::microseconds(0), std::chrono::microseconds(100));
+        const auto now = std::chrono::steady_clock::now();
+        if (now < next.deadline - TIMER_SLEEP_MARGIN) {
+          m_condition.wait_until(lock, next.deadline - TIMER_SLEEP_MARGIN);
+          continue;
+        }
+        if (now < next.deadline - spinWindow) {
+          const auto spinStart = next.deadline - spinWindow;
+          lock.unlock();
+          sleepUntil(spinStart);
+          lock.lock();
+          continue;
+        }
+        std::pop_heap(m_timers.begin(), m_timers.end(), IsLater());
+        Timer timer = std::move(m_timers.back());
+        m_timers.pop_back();
+        lock.unlock();
+        SleepUntil(timer.deadline, spinWindow);
+        timer.onDue(false);
+        lock.lock();
+      }
+
+      std::vector<Timer> cancelledTimers;
+      std::swap(cancelledTimers, m_timers);
+      lock.unlock();
+      for (Timer& timer : cancelledTimers) {
+        timer.onDue(true);
+      }
+    }
+
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<Timer> m_timers;
+    uint64_t m_nextSequence = 0;
+    bool m_isRunning = false;
+    std::thread m_thread;
+    HANDLE m_sleepTimer = nullptr;
+    // Set when a timer is scheduled or the service stopped
+    HANDLE m_wakeUpEvent = nullptr;
+};
+
+// Numeric fields of an input event, as delivered in batches and rings.
+// Mouse inputs are numbered as in input recordings (0 move, 1 left, 2 right,
+// 3 middle, 4 wheel, 5 extraButton1, 6 extraButton2), keyboard inputs are key
+// codes. Flags are 1 for suppressed and 2 for injected events.
+struct EncodedInputEvent {
+  int32_t type; // 0 mouse, 1 keyboard
+  int32_t input;
+  int32_t state; // 0 down, 1 up, 2 neutral
+  int32_t flags;
+};
+
+EncodedInputEvent EncodeInputEvent(const RawInputEvent& event) {
+  EncodedInputEvent encoded;
+  encoded.type = static_cast<int32_t>(event.type);
+  encoded.input = event.input;
+  encoded.state = static_cast<int32_t>(event.state);
+  encoded.flags = (event.isSuppressed ? 1 : 0) | (event.isInjected ? 2 : 0);
+  return encoded;
+}
+
+// Input events JavaScript subscribed to (see setInputEventFilter). Empty key
+// and mouse input sets accept every key and button.
+struct InputEventFilter {
+  bool isKeyboardEnabled = true;
+  bool isMouseEnabled = true;
+  bool isMotionEnabled = true;
+  bool isInjectedEnabled = true;
+  bool isPhysicalEnabled = true;
+  std::set<int32_t> keys;
+  std::set<int32_t> mouseInputs;
+
+  bool accepts(const EncodedInputEvent& event) const {
+    if (!((event.flags & 2) ? isInjectedEnabled : isPhysicalEnabled)) {
+      return false;
     }
+    if (event.type == 1) {
+      return isKeyboardEnabled && (keys.empty() || keys.count(event.input) > 0);
+    }
+    if (event.input == 0) {
+      return isMotionEnabled;
+    }
+    return isMouseEnabled && (mouseInputs.empty() || mouseInputs.count(event.input) > 0);
   }
-  // Register inputs to be unsuppressed
-  UnsuppressInputEvents(type, inputStateMap);
-  // Return undefined
-  return env.Undefined();
-}
+};
 
-// =============================================================================
-// ============================ TRAY ICON FUNCTIONS ============================
-// =============================================================================
+// Input events batched for JavaScript, as flat records of
+//   type | input | state | x | y | timestamp | flags
+// (see EncodedInputEvent)
+const size_t INPUT_EVENT_RECORD_SIZE = 7;
 
-// This process' window's tray icon event callback
-LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
-  switch (uMsg) {
-    case WM_COMMAND: {
-      // Handle menu item clicks
-      int menuItemId = LOWORD(wParam);
+class InputEventBatch {
+  public:
+    InputEventBatch() { }
+
+  public:
+    bool empty() const {
+      return m_records.empty();
+    }
+
+    size_t size() const {
+      return m_records.size() / INPUT_EVENT_RECORD_SIZE;
+    }
+
+    // When the first event of the batch was added
+    std::chrono::steady_clock::time_point startedAt() const {
+      return m_startedAt;
+    }
+
+    // Add an event. With motion coalescing, a motion following another one
+    // replaces it, so that only the latest position between two other events
+    // is kept.
+    void add(const RawInputEvent& event, bool isMotionCoalesced) {
+      EncodedInputEvent encoded = EncodeInputEvent(event);
+      if (m_records.empty()) {
+        m_startedAt = std::chrono::steady_clock::now();
+      }
+      else if (isMotionCoalesced && encoded.type == 0 && encoded.input == 0) {
+        double* last = &m_records[m_records.size() - INPUT_EVENT_RECORD_SIZE];
+        if (last[0] == 0 && last[1] == 0 && last[6] == encoded.flags) {
+          last[3] = event.x;
+          last[4] = event.y;
+          last[5] = static_cast<double>(event.timestamp);
+          return;
+        }
+      }
+      m_records.insert(m_records.end(), {
+        static_cast<double>(encoded.type),
+        static_cast<double>(encoded.input),
+        static_cast<double>(encoded.state),
+        static_cast<double>(event.x),
+        static_cast<double>(event.y),
+        static_cast<double>(event.timestamp),
+        static_cast<double>(encoded.flags)
+      });
+    }
+
+    std::vector<double> take() {
+      std::vector<double> records;
+      std::swap(records, m_records);
+      return records;
+    }
+
+  private:
+    std::vector<double> m_records;
+    std::chrono::steady_clock::time_point m_startedAt;
+};
+
+// Shared memory layout of an input event ring (see InputEventRingReader):
+//   header  16 x int32: write index | read index | capacity | record size | records offset | dropped events | state | waiting
+//   records capacity x (float64 timestamp | int32 type | int32 input | int32 state | int32 x | int32 y | int32 flags)
+// Indexes count events since the ring started, wrapping around at 2^32: the
+// record of index i lives in slot i % capacity, capacity being a power of 2.
+const size_t INPUT_EVENT_RING_HEADER_SIZE = 64;
+const size_t INPUT_EVENT_RING_RECORD_SIZE = 32;
+enum InputEventRingHeaderField {
+  RING_WRITE_INDEX = 0,
+  RING_READ_INDEX = 1,
+  RING_CAPACITY = 2,
+  RING_RECORD_SIZE = 3,
+  RING_RECORDS_OFFSET = 4,
+  RING_DROPPED = 5,
+  RING_STATE = 6,
+  RING_WAITING = 7,
+};
+
+// Single-producer/single-consumer ring of input events living in memory
+// shared with JS (a SharedArrayBuffer). The input listener thread is the only
+// producer and never blocks: events are dropped while the ring is full. The
+// consumer is only notified when it asked for it, by setting the waiting
+// field, so that a busy consumer costs no wake-up at all.
+class InputEventRing {
+  public:
+    static size_t requiredMemorySize(uint32_t capacity) {
+      return INPUT_EVENT_RING_HEADER_SIZE + capacity * INPUT_EVENT_RING_RECORD_SIZE;
+    }
+
+    // `memory` must be zero-initialized and at least requiredMemorySize() bytes,
+    // `capacity` a power of 2
+    InputEventRing(uint8_t* memory, uint32_t capacity, std::function<void()> onWaiting)
+      : m_memory(memory),
+        m_capacity(capacity),
+        m_onWaiting(std::move(onWaiting)) {
+      header(RING_CAPACITY).store(static_cast<int32_t>(m_capacity));
+      header(RING_RECORD_SIZE).store(static_cast<int32_t>(INPUT_EVENT_RING_RECORD_SIZE));
+      header(RING_RECORDS_OFFSET).store(static_cast<int32_t>(INPUT_EVENT_RING_HEADER_SIZE));
+      header(RING_WAITING).store(1);
+      header(RING_STATE).store(1);
+    }
+
+    InputEventRing(const InputEventRing&) = delete;
+    InputEventRing& operator=(const InputEventRing&) = delete;
+
+  public:
+    // Producer side: only called from the input listener thread
+    void push(const RawInputEvent& event) {
+      uint32_t writeIndex = static_cast<uint32_t>(header(RING_WRITE_INDEX).load(std::memory_order_relaxed));
+      uint32_t readIndex = static_cast<uint32_t>(header(RING_READ_INDEX).load(std::memory_order_acquire));
+      if (writeIndex - readIndex >= m_capacity) {
+        header(RING_DROPPED).fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      EncodedInputEvent encoded = EncodeInputEvent(event);
+      double timestamp = static_cast<double>(event.timestamp);
+      int32_t fields[6] = { encoded.type, encoded.input, encoded.state, event.x, event.y, encoded.flags };
+      uint8_t* record = m_memory + INPUT_EVENT_RING_HEADER_SIZE + (writeIndex & (m_capacity - 1)) * INPUT_EVENT_RING_RECORD_SIZE;
+      std::memcpy(record, &timestamp, sizeof(double));
+      std::memcpy(record + sizeof(double), fields, sizeof(fields));
+
+      // Publish the record, then wake the consumer up if it waits for it
+      header(RING_WRITE_INDEX).store(static_cast<int32_t>(writeIndex + 1));
+      if (header(RING_WAITING).exchange(0) != 0) {
+        m_onWaiting();
+      }
+    }
+
+    // Wake the consumer up a last time, to let it see the ring stopped
+    void stop() {
+      header(RING_STATE).store(0);
+      m_onWaiting();
+    }
+
+  private:
+    // Shared int32 fields are accessed atomically, like Atomics does in JS
+    std::atomic<int32_t>& header(InputEventRingHeaderField field) {
+      return *reinterpret_cast<std::atomic<int32_t>*>(m_memory + field * sizeof(int32_t));
+    }
+
+  private:
+    uint8_t* m_memory;
+    uint32_t m_capacity;
+    std::function<void()> m_onWaiting;
+};
+
+// Input recording container (all integers little-endian):
+//   header  "ACTINP01" | block size
+//   blocks  (first timestamp in ms | event count | payload size | payload)*
+//   index   (block offset | first timestamp in ms | event count)*
+//   trailer block count | index offset | "ACTIDX01"
+// Payloads are Zstandard-compressed arrays of InputRecord. Timestamps are
+// relative to the previous event of the block and mouse positions to the
+// previous mouse event of the block, so that blocks decode on their own and
+// mostly hold small numbers. Blocks are appended as they fill up: a recording
+// that was not stopped properly has no index, but its blocks remain readable.
+const char INPUT_RECORDING_MAGIC[] = "ACTINP01";
+const char INPUT_RECORDING_INDEX_MAGIC[] = "ACTIDX01";
+const size_t INPUT_RECORDING_BLOCK_HEADER_SIZE = 16;
+const size_t INPUT_RECORDING_INDEX_ENTRY_SIZE = 20;
+const size_t INPUT_RECORDING_TRAILER_SIZE = 24;
+const uint32_t INPUT_RECORDING_MAX_BLOCK_SIZE = 1 << 20;
+
+struct InputRecord {
+  uint32_t timestampDelta;
+  int32_t input;
+  int32_t xDelta;
+  int32_t yDelta;
+  uint8_t type;
+  uint8_t state;
+  uint8_t flags; // as in EncodedInputEvent
+  uint8_t reserved;
+};
+static_assert(sizeof(InputRecord) == 20, "Input records are stored as-is");
+
+struct InputRecordingIndexEntry {
+  uint64_t offset;
+  uint64_t timestamp;
+  uint32_t eventCount;
+};
+
+struct InputRecordingStats {
+  uint64_t eventCount;
+  uint64_t droppedEventCount;
+  uint64_t blockCount;
+  uint64_t durationMs;
+};
+
+// Input events a recorder keeps. A negative state matches every state.
+struct InputRecorderAction {
+  int32_t type;
+  int32_t input;
+  int32_t state;
+};
+
+// Appends compressed blocks to an input recording file and writes its index on finish
+class InputRecordingWriter {
+  public:
+    InputRecordingWriter(const std::filesystem::path& filepath, uint32_t blockSize)
+      : m_stream(filepath, std::ios::binary | std::ios::trunc) {
+      if (!m_stream) {
+        throw std::runtime_error("Failed to open input recording file.");
+      }
+      m_stream.write(INPUT_RECORDING_MAGIC, 8);
+      WriteBinary(m_stream, blockSize);
+      m_stream.flush();
+    }
+
+    ~InputRecordingWriter() {
       try {
-        std::function<void()> trayIconMenuItemCallback = trayIconMenuItemsCallbacks.at(menuItemId);
-        trayIconMenuItemCallback();
-      } catch (const std::out_of_range& e) {
-        std::cerr << "OutOfRangeError: " << e.what() << std::endl;
-      } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
+        finish();
+      } catch (...) {
+        // Nobody is left to report the failure to
       }
-      break;
     }
-    case WM_USER + 1: {
-      if (lParam == WM_RBUTTONUP) {
-        POINT pt;
-        GetCursorPos(&pt);
-        SetForegroundWindow(hwnd);
-        TrackPopupMenu(hMenu, TPM_RIGHTBUTTON, pt.x, pt.y, 0, hwnd, NULL);
+
+    InputRecordingWriter(const InputRecordingWriter&) = delete;
+    InputRecordingWriter& operator=(const InputRecordingWriter&) = delete;
+
+  public:
+    void append(uint64_t timestamp, uint32_t eventCount, const uint8_t* payload, uint32_t size) {
+      m_index.push_back({ static_cast<uint64_t>(m_stream.tellp()), timestamp, eventCount });
+      WriteBinary(m_stream, timestamp);
+      WriteBinary(m_stream, eventCount);
+      WriteBinary(m_stream, size);
+      m_stream.write(reinterpret_cast<const char*>(payload), size);
+      // Keep the file readable up to the last block should the process die
+      m_stream.flush();
+    }
+
+    void finish() {
+      if (m_isFinished) return;
+      m_isFinished = true;
+      uint64_t indexOffset = static_cast<uint64_t>(m_stream.tellp());
+      for (const InputRecordingIndexEntry& entry : m_index) {
+        WriteBinary(m_stream, entry.offset);
+        WriteBinary(m_stream, entry.timestamp);
+        WriteBinary(m_stream, entry.eventCount);
+      }
+      WriteBinary(m_stream, static_cast<uint64_t>(m_index.size()));
+      WriteBinary(m_stream, indexOffset);
+      m_stream.write(INPUT_RECORDING_INDEX_MAGIC, 8);
+      m_stream.flush();
+      // The stream state is sticky: this also catches failed appends
+      bool hasFailed = !m_stream;
+      m_stream.close();
+      if (hasFailed || !m_stream) {
+        throw std::runtime_error("Failed to write input recording file.");
       }
-      break;
     }
-    case WM_USER + 2: {
-      // Change tray icon
-      nid.hIcon = reinterpret_cast<HICON>(wParam);
-      Shell_NotifyIconW(NIM_MODIFY, &nid);
-      break;
+
+    size_t blockCount() const {
+      return m_index.size();
     }
-    case WM_USER + 3: {
-      Shell_NotifyIconW(NIM_MODIFY, &nid);
-      break;
+
+  private:
+    std::ofstream m_stream;
+    std::vector<InputRecordingIndexEntry> m_index;
+    bool m_isFinished = false;
+};
+
+// Records input events into an input recording file. The input listener thread
+// appends fixed-size records to the current block, without any allocation nor
+// I/O, and hands full blocks to a writer thread which compresses and appends
+// them to the file. Block buffers are recycled, so memory stays the same
+// whatever the recording length. Blocks are dropped rather than delaying the
+// input listener when the writer falls behind.
+class InputRecorder {
+  public:
+    InputRecorder(
+      const std::filesystem::path& filepath,
+      std::vector<InputRecorderAction> actions,
+      bool isInjectedIgnored,
+      int compressionLevel,
+      uint32_t blockSize
+    ) : m_actions(std::move(actions)),
+        m_isInjectedIgnored(isInjectedIgnored),
+        m_compressionLevel(compressionLevel),
+        m_blockSize(std::max(1u, blockSize)),
+        m_writer(filepath, m_blockSize) {
+      m_block.reserve(m_blockSize);
+      m_writeThread = std::thread(&InputRecorder::writeLoop, this);
     }
-    case WM_DESTROY: {
-      PostQuitMessage(0);
-      break;
+
+    ~InputRecorder() {
+      try {
+        stop();
+      } catch (...) {
+        // Nobody is left to report the failure to
+      }
     }
-    default: {
-      return DefWindowProc(hwnd, uMsg, wParam, lParam);
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+  public:
+    // Only called from the input listener thread
+    void record(const RawInputEvent& event) {
+      if (m_isPaused.load(std::memory_order_relaxed) || !accepts(event)) {
+        return;
+      }
+      if (m_block.empty()) {
+        m_blockTimestamp = event.timestamp;
+        m_previousTimestamp = event.timestamp;
+        m_previousPosition = { 0, 0 };
+      }
+      if (!m_firstTimestamp) {
+        m_firstTimestamp = event.timestamp;
+      }
+      m_lastTimestamp = event.timestamp;
+
+      EncodedInputEvent encoded = EncodeInputEvent(event);
+      InputRecord record{};
+      // The wall clock may go back: keep decoded timestamps ordered
+      if (event.timestamp > m_previousTimestamp) {
+        record.timestampDelta = static_cast<uint32_t>(std::min<uint64_t>(event.timestamp - m_previousTimestamp, UINT32_MAX));
+        m_previousTimestamp += record.timestampDelta;
+      }
+      record.input = encoded.input;
+      if (event.type == InputEventType::Mouse) {
+        record.xDelta = event.x - m_previousPosition.x;
+        record.yDelta = event.y - m_previousPosition.y;
+        m_previousPosition = { event.x, event.y };
+      }
+      record.type = static_cast<uint8_t>(encoded.type);
+      record.state = static_cast<uint8_t>(encoded.state);
+      record.flags = static_cast<uint8_t>(encoded.flags);
+      m_block.push_back(record);
+
+      if (m_block.size() >= m_blockSize) {
+        submitBlock(false);
+      }
     }
-  }
-  return 0;
-}
 
-// Create tray icon
-HWND CreateTrayIcon(const std::wstring& name, const std::wstring& iconPath) {
-  if (trayIconRunning) {
-    return trayIconWindowHwnd;
-  }
-  std::thread nestedThread([name, iconPath]() {
-    {
-      std::lock_guard<std::mutex> lock(trayIconMutex);
+    void setPaused(bool isPaused) {
+      m_isPaused = isPaused;
+    }
 
-      HINSTANCE hInstance = GetModuleHandle(NULL);
-      WNDCLASSW wc = { 0 };
-      wc.lpfnWndProc = WindowProc;
-      wc.hInstance = hInstance;
-      wc.lpszClassName = L"TrayIconClass";
-      RegisterClassW(&wc);
+    // Must only be called once the input listener no longer records events
+    InputRecordingStats stop() {
+      std::lock_guard<std::mutex> stopLock(m_stopMutex);
+      if (!m_isStopped) {
+        m_isStopped = true;
+        if (!m_block.empty()) {
+          submitBlock(true);
+        }
+        {
+          std::lock_guard<std::mutex> lock(m_blocksMutex);
+          m_isStopping = true;
+        }
+        m_blocksCondition.notify_all();
+        m_writeThread.join();
+        m_writer.finish();
+      }
+      return {
+        m_recordedEventCount.load(),
+        m_droppedEventCount.load(),
+        static_cast<uint64_t>(m_writer.blockCount()),
+        m_firstTimestamp ? m_lastTimestamp - m_firstTimestamp : 0
+      };
+    }
 
-      HWND hwnd = CreateWindowW(L"TrayIconClass", name.c_str(), 0, 0, 0, 0, 0, NULL, NULL, hInstance, NULL);
-      trayIconWindowHwnd = hwnd;
+  private:
+    // Blocks waiting for the writer thread at most
+    static constexpr size_t MAX_PENDING_BLOCKS = 8;
 
-      hMenu = CreatePopupMenu();
+    struct Block {
+      uint64_t timestamp;
+      std::vector<InputRecord> records;
+    };
 
-      nid.cbSize = sizeof(NOTIFYICONDATAW);
-      nid.hWnd = hwnd;
-      nid.uID = 1;
-      nid.uFlags = NIF_MESSAGE | NIF_ICON | NIF_TIP;
-      nid.uCallbackMessage = WM_USER + 1;
-      wcscpy_s(nid.szTip, _countof(nid.szTip), name.c_str());
-      nid.hIcon = static_cast<HICON>(LoadImageW(NULL, iconPath.c_str(), IMAGE_ICON, 0, 0, LR_LOADFROMFILE | LR_DEFAULTSIZE));
+    bool accepts(const RawInputEvent& event) const {
+      if (m_isInjectedIgnored && event.isInjected) {
+        return false;
+      }
+      if (m_actions.empty()) {
+        return true;
+      }
+      for (const InputRecorderAction& action : m_actions) {
+        if (
+          action.type == static_cast<int32_t>(event.type)
+          && action.input == event.input
+          && (action.state < 0 || action.state == static_cast<int32_t>(event.state))
+        ) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Hand the current block to the writer thread and start a new one
+    void submitBlock(bool isForced) {
+      {
+        std::lock_guard<std::mutex> lock(m_blocksMutex);
+        if (isForced || m_pendingBlocks.size() < MAX_PENDING_BLOCKS) {
+          m_pendingBlocks.push({ m_blockTimestamp, std::move(m_block) });
+          m_block = std::vector<InputRecord>();
+        }
+        else {
+          m_droppedEventCount += m_block.size();
+          m_block.clear();
+        }
+        if (m_block.capacity() == 0 && !m_freeBlocks.empty()) {
+          m_block = std::move(m_freeBlocks.back());
+          m_freeBlocks.pop_back();
+        }
+      }
+      m_blocksCondition.notify_one();
+      m_block.reserve(m_blockSize);
+    }
+
+    void writeLoop() {
+      ZSTD_CCtx* zstdContext = ZSTD_createCCtx();
+      std::vector<uint8_t> payload;
+
+      while (true) {
+        Block block;
+        {
+          std::unique_lock<std::mutex> lock(m_blocksMutex);
+          m_blocksCondition.wait(lock, [this] { return !m_pendingBlocks.empty() || m_isStopping; });
+          if (m_pendingBlocks.empty()) break;
+          block = std::move(m_pendingBlocks.front());
+          m_pendingBlocks.pop();
+        }
+
+        size_t eventCount = block.records.size();
+        size_t size = eventCount * sizeof(InputRecord);
+        payload.resize(ZSTD_compressBound(size));
+        size_t compressedSize = zstdContext
+          ? ZSTD_compressCCtx(zstdContext, payload.data(), payload.size(), block.records.data(), size, m_compressionLevel)
+          : ZSTD_compress(payload.data(), payload.size(), block.records.data(), size, m_compressionLevel);
+        if (ZSTD_isError(compressedSize)) {
+          m_droppedEventCount += eventCount;
+        }
+        else {
+          m_writer.append(block.timestamp, static_cast<uint32_t>(eventCount), payload.data(), static_cast<uint32_t>(compressedSize));
+          m_recordedEventCount += eventCount;
+        }
+
+        // Give the block buffer back to the input listener
+        block.records.clear();
+        std::lock_guard<std::mutex> lock(m_blocksMutex);
+        m_freeBlocks.push_back(std::move(block.records));
+      }
+
+      if (zstdContext) {
+        ZSTD_freeCCtx(zstdContext);
+      }
+    }
+
+  private:
+    std::vector<InputRecorderAction> m_actions;
+    bool m_isInjectedIgnored;
+    int m_compressionLevel;
+    uint32_t m_blockSize;
+    InputRecordingWriter m_writer;
+    std::atomic<bool> m_isPaused{false};
+
+    // Input listener thread state
+    std::vector<InputRecord> m_block;
+    uint64_t m_blockTimestamp = 0;
+    uint64_t m_previousTimestamp = 0;
+    Position m_previousPosition{ 0, 0 };
+    uint64_t m_firstTimestamp = 0;
+    uint64_t m_lastTimestamp = 0;
+
+    std::mutex m_stopMutex;
+    bool m_isStopped = false;
+    std::thread m_writeThread;
+
+    std::mutex m_blocksMutex;
+    std::condition_variable m_blocksCondition;
+    std::queue<Block> m_pendingBlocks;
+    std::vector<std::vector<InputRecord>> m_freeBlocks;
+    bool m_isStopping = false;
+
+    std::atomic<uint64_t> m_recordedEventCount{0};
+    std::atomic<uint64_t> m_droppedEventCount{0};
+};
+
+// Reads the blocks of an input recording file, thanks to its index or, for a
+// recording that was not stopped properly, by walking the blocks one by one
+class InputRecordingReader {
+  public:
+    explicit InputRecordingReader(const std::filesystem::path& filepath)
+      : m_stream(filepath, std::ios::binary) {
+      if (!m_stream) {
+        throw std::runtime_error("Failed to open input recording file.");
+      }
+      char magic[8];
+      m_stream.read(magic, 8);
+      if (!m_stream || std::memcmp(magic, INPUT_RECORDING_MAGIC, 8) != 0) {
+        throw std::runtime_error("Invalid input recording file.");
+      }
+      m_blockSize = read<uint32_t>();
+      if (m_blockSize == 0 || m_blockSize > INPUT_RECORDING_MAX_BLOCK_SIZE) {
+        throw std::runtime_error("Invalid input recording file.");
+      }
+      uint64_t blocksOffset = static_cast<uint64_t>(m_stream.tellg());
+      m_stream.seekg(0, std::ios::end);
+      uint64_t fileSize = static_cast<uint64_t>(m_stream.tellg());
+
+      // Trailer: block count | index offset | magic
+      if (fileSize >= blocksOffset + INPUT_RECORDING_TRAILER_SIZE) {
+        m_stream.seekg(-static_cast<std::streamoff>(INPUT_RECORDING_TRAILER_SIZE), std::ios::end);
+        uint64_t blockCount = read<uint64_t>();
+        uint64_t indexOffset = read<uint64_t>();
+        m_stream.read(magic, 8);
+        if (m_stream && std::memcmp(magic, INPUT_RECORDING_INDEX_MAGIC, 8) == 0) {
+          // The index must exactly fill the space between the blocks and the trailer
+          uint64_t indexEnd = fileSize - INPUT_RECORDING_TRAILER_SIZE;
+          if (
+            indexOffset < blocksOffset || indexOffset > indexEnd ||
+            (indexEnd - indexOffset) % INPUT_RECORDING_INDEX_ENTRY_SIZE != 0 ||
+            (indexEnd - indexOffset) / INPUT_RECORDING_INDEX_ENTRY_SIZE != blockCount
+          ) {
+            throw std::runtime_error("Invalid input recording file.");
+          }
+          m_blocksEnd = indexOffset;
+          m_index.resize(blockCount);
+          m_stream.seekg(indexOffset);
+          for (InputRecordingIndexEntry& entry : m_index) {
+            entry.offset = read<uint64_t>();
+            entry.timestamp = read<uint64_t>();
+            entry.eventCount = read<uint32_t>();
+          }
+          // Check the event counts against the blocks before anyone allocates for them
+          for (const InputRecordingIndexEntry& entry : m_index) {
+            if (entry.offset < blocksOffset || entry.offset + INPUT_RECORDING_BLOCK_HEADER_SIZE > m_blocksEnd) {
+              throw std::runtime_error("Invalid input recording file.");
+            }
+            m_stream.seekg(entry.offset);
+            read<uint64_t>(); // first timestamp
+            uint32_t eventCount = read<uint32_t>();
+            uint32_t size = read<uint32_t>();
+            if (eventCount != entry.eventCount || !isValidBlock(entry.offset, eventCount, size)) {
+              throw std::runtime_error("Invalid input recording file.");
+            }
+          }
+          return;
+        }
+        m_stream.clear();
+      }
+
+      // No index: keep the complete blocks
+      m_blocksEnd = fileSize;
+      uint64_t offset = blocksOffset;
+      while (offset + INPUT_RECORDING_BLOCK_HEADER_SIZE <= fileSize) {
+        m_stream.seekg(offset);
+        uint64_t timestamp = read<uint64_t>();
+        uint32_t eventCount = read<uint32_t>();
+        uint32_t size = read<uint32_t>();
+        if (!isValidBlock(offset, eventCount, size)) {
+          break;
+        }
+        m_index.push_back({ offset, timestamp, eventCount });
+        offset += INPUT_RECORDING_BLOCK_HEADER_SIZE + size;
+      }
+    }
+
+  public:
+    const std::vector<InputRecordingIndexEntry>& index() const {
+      return m_index;
+    }
+
+    // Decode a block into `events`, replacing their content
+    void readBlock(size_t blockIndex, std::vector<RawInputEvent>& events) {
+      const InputRecordingIndexEntry& entry = m_index.at(blockIndex);
+      m_stream.clear();
+      m_stream.seekg(entry.offset);
+      uint64_t timestamp = read<uint64_t>();
+      uint32_t eventCount = read<uint32_t>();
+      uint32_t size = read<uint32_t>();
+      if (eventCount != entry.eventCount || !isValidBlock(entry.offset, eventCount, size)) {
+        throw std::runtime_error("Corrupted input recording block.");
+      }
+      m_stream.seekg(entry.offset + INPUT_RECORDING_BLOCK_HEADER_SIZE);
+      m_payload.resize(size);
+      m_stream.read(reinterpret_cast<char*>(m_payload.data()), size);
+      if (!m_stream) {
+        throw std::runtime_error("Unexpected end of input recording file.");
+      }
+      m_records.resize(eventCount);
+      size_t expectedSize = eventCount * sizeof(InputRecord);
+      size_t decompressedSize = ZSTD_decompress(m_records.data(), expectedSize, m_payload.data(), size);
+      if (ZSTD_isError(decompressedSize) || decompressedSize != expectedSize) {
+        throw std::runtime_error("Corrupted input recording block.");
+      }
+
+      events.clear();
+      events.reserve(eventCount);
+      Position position{ 0, 0 };
+      for (const InputRecord& record : m_records) {
+        timestamp += record.timestampDelta;
+        RawInputEvent event{
+          static_cast<InputEventType>(record.type),
+          record.input,
+          static_cast<InputEventState>(record.state),
+          0,
+          0,
+          timestamp,
+          (record.flags & 1) != 0,
+          (record.flags & 2) != 0
+        };
+        if (event.type == InputEventType::Mouse) {
+          position.x += record.xDelta;
+          position.y += record.yDelta;
+          event.x = position.x;
+          event.y = position.y;
+        }
+        events.push_back(event);
+      }
+    }
+
+  private:
+    // ZSTD_FRAMEHEADERSIZE_MAX, only exposed by the static Zstandard API
+    static constexpr size_t ZSTD_FRAME_HEADER_MAX_SIZE = 18;
+
+    template <typename T>
+    T read() {
+      T value{};
+      m_stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+      if (!m_stream) {
+        throw std::runtime_error("Unexpected end of input recording file.");
+      }
+      return value;
+    }
+
+    // A block must fit in the file and hold no more events than a block can.
+    // Its payload must also be a Zstandard frame declaring the exact size of
+    // its records, which bounds what decoding it allocates.
+    bool isValidBlock(uint64_t offset, uint32_t eventCount, uint32_t size) {
+      if (
+        eventCount > m_blockSize ||
+        offset + INPUT_RECORDING_BLOCK_HEADER_SIZE + size > m_blocksEnd
+      ) {
+        return false;
+      }
+      char frameHeader[ZSTD_FRAME_HEADER_MAX_SIZE];
+      size_t frameHeaderSize = std::min<size_t>(size, sizeof(frameHeader));
+      m_stream.seekg(offset + INPUT_RECORDING_BLOCK_HEADER_SIZE);
+      m_stream.read(frameHeader, frameHeaderSize);
+      if (!m_stream) {
+        m_stream.clear();
+        return false;
+      }
+      return ZSTD_getFrameContentSize(frameHeader, frameHeaderSize) == static_cast<unsigned long long>(eventCount) * sizeof(InputRecord);
+    }
+
+  private:
+    std::ifstream m_stream;
+    uint32_t m_blockSize = 0;
+    uint64_t m_blocksEnd = 0;
+    std::vector<InputRecordingIndexEntry> m_index;
+    std::vector<uint8_t> m_payload;
+    std::vector<InputRecord> m_records;
+};
+
+// Replay lateness histogram: 10 us buckets up to 100 ms. Later events fall in
+// the last bucket, the exact maximum being kept apart.
+const size_t INPUT_REPLAY_LATENESS_BUCKET_COUNT = 10000;
+const std::chrono::microseconds INPUT_REPLAY_LATENESS_BUCKET_WIDTH(10);
+
+struct InputReplayStats {
+  uint64_t eventCount = 0;
+  uint64_t durationMs = 0;
+  double meanLatenessMs = 0;
+  double p50LatenessMs = 0;
+  double p95LatenessMs = 0;
+  double p99LatenessMs = 0;
+  double maxLatenessMs = 0;
+};
+
+// Replays recorded input events on a dedicated thread through SendInput. Each event is sent on an absolute deadline computed from its
+// recorded timestamp and the replay speed, so delays never drift however late
+// an event was sent, and events sharing a deadline are sent in one call.
+// Recording files are decoded block by block: memory does not grow with the
+// recording length. Keys and buttons still held are released when the replay
+// is paused, seeks, ends or is stopped.
+class InputReplayer {
+  public:
+    // Called on the replay thread once the replay finished or was stopped,
+    // with the error that interrupted it if any
+    using Callback = std::function<void(const InputReplayStats&, std::exception_ptr)>;
+
+    // Replay the given events, in timestamp order
+    InputReplayer(std::vector<RawInputEvent> events, double speed, Callback onEnd)
+      : m_events(std::move(events)), m_speed(speed), m_onEnd(std::move(onEnd)) {
+      std::stable_sort(m_events.begin(), m_events.end(), [](const RawInputEvent& a, const RawInputEvent& b) {
+        return a.timestamp < b.timestamp;
+      });
+      m_startTimestamp = m_events.empty() ? 0 : m_events.front().timestamp;
+      start();
+    }
+
+    // Replay an input recording file (see InputRecorder)
+    InputReplayer(const std::filesystem::path& filepath, double speed, Callback onEnd)
+      : m_reader(std::make_unique<InputRecordingReader>(filepath)), m_speed(speed), m_onEnd(std::move(onEnd)) {
+      m_startTimestamp = m_reader->index().empty() ? 0 : m_reader->index().front().timestamp;
+      start();
+    }
+
+    ~InputReplayer() {
+      stop();
+    }
+
+    InputReplayer(const InputReplayer&) = delete;
+    InputReplayer& operator=(const InputReplayer&) = delete;
+
+  public:
+    void setPaused(bool isPaused) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (isPaused == m_isPaused) {
+        return;
+      }
+      const auto now = std::chrono::steady_clock::now();
+      if (isPaused) {
+        m_pausedPosition = std::chrono::duration<double, std::micro>(now - m_origin) * m_speed;
+      }
+      else {
+        m_origin = now - scale(m_pausedPosition);
+      }
+      m_isPaused = isPaused;
+      m_generation++;
+      m_condition.notify_all();
+    }
+
+    // Continue from the given time since the first recorded event
+    void seek(uint64_t positionMs) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_seekPosition = positionMs;
+      m_pausedPosition = std::chrono::milliseconds(positionMs);
+      m_origin = std::chrono::steady_clock::now() - scale(m_pausedPosition);
+      m_generation++;
+      m_condition.notify_all();
+    }
+
+    // Interrupt the replay and wait for its thread to end
+    void stop() {
+      std::thread thread;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+        m_generation++;
+        thread = std::move(m_thread);
+      }
+      m_condition.notify_all();
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+
+  private:
+    void start() {
+      m_origin = std::chrono::steady_clock::now();
+      m_thread = std::thread(&InputReplayer::run, this);
+    }
+
+    // Real time duration of a recorded duration at the replay speed
+    std::chrono::steady_clock::duration scale(std::chrono::duration<double, std::micro> recordedDuration) const {
+      return std::chrono::duration_cast<std::chrono::steady_clock::duration>(recordedDuration / m_speed);
+    }
+
+    void run() {
+      // Best effort: the scheduler may still preempt the thread
+      SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+
+      const auto startedAt = std::chrono::steady_clock::now();
+      std::exception_ptr error;
+      try {
+        RawInputEvent event;
+        bool hasEvent = nextEvent(event);
+        while (true) {
+          std::chrono::steady_clock::time_point deadline;
+          uint64_t generation;
+          {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_isPaused && !m_isStopping && !m_seekPosition) {
+              lock.unlock();
+              releaseHeldInputs();
+              lock.lock();
+              m_condition.wait(lock, [this] { return !m_isPaused || m_isStopping || m_seekPosition.has_value(); });
+            }
+            if (m_isStopping) {
+              break;
+            }
+            if (m_seekPosition) {
+              uint64_t positionMs = *m_seekPosition;
+              m_seekPosition.reset();
+              lock.unlock();
+              releaseHeldInputs();
+              hasEvent = seekEvent(positionMs, event);
+              continue;
+            }
+            if (!hasEvent) {
+              break;
+            }
+            const uint64_t recordedDelay = event.timestamp > m_startTimestamp ? event.timestamp - m_startTimestamp : 0;
+            deadline = m_origin + scale(std::chrono::milliseconds(recordedDelay));
+            generation = m_generation;
+          }
+          if (std::chrono::steady_clock::now() < deadline) {
+            // Send the events due at the previous deadline before sleeping
+            sendInputs();
+            if (!waitUntil(deadline, generation)) {
+              continue;
+            }
+          }
+          send(event);
+          recordLateness(std::chrono::steady_clock::now() - deadline);
+          hasEvent = nextEvent(event);
+        }
+        releaseHeldInputs();
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+      m_onEnd(stats(std::chrono::steady_clock::now() - startedAt), error);
+    }
+
+    // Interruptible coarse wait, then a precise sleep for the last milliseconds.
+    // Returns false when the replay was paused, moved or stopped meanwhile.
+    bool waitUntil(std::chrono::steady_clock::time_point deadline, uint64_t generation) {
+      const auto coarseDeadline = deadline - TIMER_SLEEP_MARGIN;
+      if (std::chrono::steady_clock::now() < coarseDeadline) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_condition.wait_until(lock, coarseDeadline, [this, generation] { return m_generation != generation; })) {
+          return false;
+        }
+      }
+      SleepUntil(deadline, PRECISE_SLEEP_SPIN_WINDOW);
+      return m_generation.load() == generation;
+    }
+
+    bool nextEvent(RawInputEvent& event) {
+      while (m_eventIndex >= m_events.size()) {
+        if (!m_reader || m_blockIndex >= m_reader->index().size()) {
+          return false;
+        }
+        m_reader->readBlock(m_blockIndex++, m_events);
+        m_eventIndex = 0;
+      }
+      event = m_events[m_eventIndex++];
+      return true;
+    }
+
+    // Move to the first event recorded at or after the given position
+    bool seekEvent(uint64_t positionMs, RawInputEvent& event) {
+      const uint64_t timestamp = m_startTimestamp + positionMs;
+      if (m_reader) {
+        const std::vector<InputRecordingIndexEntry>& index = m_reader->index();
+        auto block = std::upper_bound(index.begin(), index.end(), timestamp, [](uint64_t value, const InputRecordingIndexEntry& entry) {
+          return value < entry.timestamp;
+        });
+        m_blockIndex = block == index.begin() ? 0 : static_cast<size_t>(block - index.begin()) - 1;
+        m_events.clear();
+        if (m_blockIndex < index.size()) {
+          m_reader->readBlock(m_blockIndex++, m_events);
+        }
+      }
+      auto first = std::lower_bound(m_events.begin(), m_events.end(), timestamp, [](const RawInputEvent& candidate, uint64_t value) {
+        return candidate.timestamp < value;
+      });
+      m_eventIndex = static_cast<size_t>(first - m_events.begin());
+      // The cursor may have moved meanwhile
+      m_cursor.reset();
+      return nextEvent(event);
+    }
+
+    void send(const RawInputEvent& event) {
+      if (event.state == InputEventState::Neutral && !(event.type == InputEventType::Mouse && event.input == static_cast<int>(MouseInputCode::Move))) {
+        return;
+      }
+      const bool isDown = event.state == InputEventState::Down;
+      if (event.type == InputEventType::Keyboard) {
+        auto scanCode = m_scanCodes.find(event.input);
+        if (scanCode == m_scanCodes.end()) {
+          scanCode = m_scanCodes.emplace(event.input, static_cast<WORD>(MapVirtualKey(event.input, MAPVK_VK_TO_VSC_EX))).first;
+        }
+        // Keys without a scan code in the current layout are skipped
+        if (scanCode->second == 0) {
+          return;
+        }
+        appendKeyInput(scanCode->second, isDown);
+        if (isDown) {
+          m_heldKeys.insert(scanCode->second);
+        }
+        else {
+          m_heldKeys.erase(scanCode->second);
+        }
+        m_eventCount++;
+        return;
+      }
+
+      if (!m_cursor || m_cursor->x != event.x || m_cursor->y != event.y) {
+        m_inputs.push_back(BuildMouseMoveInput(event.x, event.y));
+        m_cursor = Position{ event.x, event.y };
+      }
+      auto input = static_cast<MouseInputCode>(event.input);
+      switch (input) {
+        case MouseInputCode::Left:
+        case MouseInputCode::Middle:
+        case MouseInputCode::Right:
+        case MouseInputCode::ExtraButton1:
+        case MouseInputCode::ExtraButton2:
+          appendButtonInput(input, isDown);
+          if (isDown) {
+            m_heldButtons.insert(input);
+          }
+          else {
+            m_heldButtons.erase(input);
+          }
+          break;
+        case MouseInputCode::Wheel: {
+          INPUT wheelInput = { 0 };
+          wheelInput.type = INPUT_MOUSE;
+          wheelInput.mi.dwFlags = MOUSEEVENTF_WHEEL;
+          wheelInput.mi.mouseData = static_cast<DWORD>(isDown ? -WHEEL_DELTA : WHEEL_DELTA);
+          m_inputs.push_back(wheelInput);
+          break;
+        }
+        default: break;
+      }
+      m_eventCount++;
+    }
+
+    // Extended keys have a 0xE0 prefix in their scan code
+    void appendKeyInput(WORD scanCode, bool isDown) {
+      INPUT input = { 0 };
+      input.type = INPUT_KEYBOARD;
+      input.ki.wScan = scanCode & 0xFF;
+      input.ki.dwFlags = KEYEVENTF_SCANCODE | ((scanCode >> 8) == 0xE0 ? KEYEVENTF_EXTENDEDKEY : 0) | (isDown ? 0 : KEYEVENTF_KEYUP);
+      m_inputs.push_back(input);
+    }
+
+    void appendButtonInput(MouseInputCode button, bool isDown) {
+      INPUT input = { 0 };
+      input.type = INPUT_MOUSE;
+      switch (button) {
+        case MouseInputCode::Left: input.mi.dwFlags = isDown ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP; break;
+        case MouseInputCode::Middle: input.mi.dwFlags = isDown ? MOUSEEVENTF_MIDDLEDOWN : MOUSEEVENTF_MIDDLEUP; break;
+        case MouseInputCode::Right: input.mi.dwFlags = isDown ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_RIGHTUP; break;
+        default:
+          input.mi.dwFlags = isDown ? MOUSEEVENTF_XDOWN : MOUSEEVENTF_XUP;
+          input.mi.mouseData = button == MouseInputCode::ExtraButton1 ? XBUTTON1 : XBUTTON2;
+          break;
+      }
+      m_inputs.push_back(input);
+    }
+
+    void sendInputs() {
+      if (m_inputs.empty()) {
+        return;
+      }
+      UINT sentCount = SendInput(static_cast<UINT>(m_inputs.size()), m_inputs.data(), sizeof(INPUT));
+      m_inputs.clear();
+      if (sentCount == 0) {
+        throw std::runtime_error("Failed to send replayed input events");
+      }
+    }
+
+    void releaseHeldInputs() {
+      for (WORD scanCode : m_heldKeys) {
+        appendKeyInput(scanCode, false);
+      }
+      for (MouseInputCode button : m_heldButtons) {
+        appendButtonInput(button, false);
+      }
+      m_heldKeys.clear();
+      m_heldButtons.clear();
+      sendInputs();
+    }
+
+    void recordLateness(std::chrono::steady_clock::duration lateness) {
+      const auto latenessUs = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(lateness).count());
+      const size_t bucket = static_cast<size_t>(latenessUs / INPUT_REPLAY_LATENESS_BUCKET_WIDTH.count());
+      m_latenessBuckets[std::min(bucket, INPUT_REPLAY_LATENESS_BUCKET_COUNT - 1)]++;
+      m_latenessCount++;
+      m_totalLatenessUs += static_cast<uint64_t>(latenessUs);
+      m_maxLatenessUs = std::max<uint64_t>(m_maxLatenessUs, static_cast<uint64_t>(latenessUs));
+    }
+
+    // Percentiles are the upper bounds of their histogram buckets
+    InputReplayStats stats(std::chrono::steady_clock::duration duration) const {
+      InputReplayStats stats;
+      stats.eventCount = m_eventCount;
+      stats.durationMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+      if (m_latenessCount == 0) {
+        return stats;
+      }
+      const double maxLatenessMs = m_maxLatenessUs / 1000.0;
+      auto percentile = [&](double ratio) {
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(ratio * m_latenessCount)));
+        uint64_t count = 0;
+        for (size_t bucket = 0; bucket < m_latenessBuckets.size(); bucket++) {
+          count += m_latenessBuckets[bucket];
+          if (count >= rank) {
+            return std::min(maxLatenessMs, (bucket + 1) * INPUT_REPLAY_LATENESS_BUCKET_WIDTH.count() / 1000.0);
+          }
+        }
+        return maxLatenessMs;
+      };
+      stats.meanLatenessMs = static_cast<double>(m_totalLatenessUs) / m_latenessCount / 1000.0;
+      stats.p50LatenessMs = percentile(0.5);
+      stats.p95LatenessMs = percentile(0.95);
+      stats.p99LatenessMs = percentile(0.99);
+      stats.maxLatenessMs = maxLatenessMs;
+      return stats;
+    }
+
+  private:
+    // Events to replay, or the decoded block of the recording file
+    std::vector<RawInputEvent> m_events;
+    size_t m_eventIndex = 0;
+    std::unique_ptr<InputRecordingReader> m_reader;
+    size_t m_blockIndex = 0;
+    uint64_t m_startTimestamp = 0;
+    const double m_speed;
+    Callback m_onEnd;
+
+    // Replay thread state
+    std::vector<INPUT> m_inputs;
+    std::unordered_map<int32_t, WORD> m_scanCodes;
+    std::set<WORD> m_heldKeys;
+    std::set<MouseInputCode> m_heldButtons;
+    std::optional<Position> m_cursor;
+    uint64_t m_eventCount = 0;
+    std::vector<uint32_t> m_latenessBuckets = std::vector<uint32_t>(INPUT_REPLAY_LATENESS_BUCKET_COUNT, 0);
+    uint64_t m_latenessCount = 0;
+    uint64_t m_totalLatenessUs = 0;
+    uint64_t m_maxLatenessUs = 0;
+
+    // Controls, the replay being at `(now - m_origin) * m_speed` of the recording
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::chrono::steady_clock::time_point m_origin;
+    std::chrono::duration<double, std::micro> m_pausedPosition{0};
+    std::optional<uint64_t> m_seekPosition;
+    bool m_isPaused = false;
+    bool m_isStopping = false;
+    std::atomic<uint64_t> m_generation{0};
+    std::thread m_thread;
+};
+
+// Builds the input event objects sent to JavaScript. Property keys and string
+// values are created once and kept referenced, and the properties of each
+// object are defined with a single napi_define_properties call.
+class InputEventObjectBuilder {
+  public:
+    InputEventObjectBuilder(const Napi::Env& env) {
+      for (const char* string : STRINGS) {
+        m_strings.push_back(Napi::Persistent(Napi::String::New(env, string)));
+      }
+    }
+
+    Napi::Object build(const Napi::Env& env, const RawInputEvent& event) const {
+      constexpr napi_property_attributes attributes = napi_default_jsproperty;
+      Napi::Object eventObj = Napi::Object::New(env);
+      Napi::Number timestamp = Napi::Number::New(env, static_cast<double>(event.timestamp));
+      Napi::String state = string(STATE_VALUE + static_cast<int>(event.state));
+      Napi::Boolean isInjected = Napi::Boolean::New(env, event.isInjected);
+      Napi::Boolean isSuppressed = Napi::Boolean::New(env, event.isSuppressed);
+      if (event.type == InputEventType::Mouse) {
+        Napi::Object position = Napi::Object::New(env);
+        position.DefineProperties({
+          Napi::PropertyDescriptor::Value(string(X), Napi::Number::New(env, event.x), attributes),
+          Napi::PropertyDescriptor::Value(string(Y), Napi::Number::New(env, event.y), attributes),
+        });
+        bool isKnownInput = event.input >= 0 && event.input <= static_cast<int>(MouseInputCode::ExtraButton2);
+        eventObj.DefineProperties({
+          Napi::PropertyDescriptor::Value(string(TYPE), string(MOUSE), attributes),
+          Napi::PropertyDescriptor::Value(string(TIMESTAMP), timestamp, attributes),
+          Napi::PropertyDescriptor::Value(string(INPUT), string(isKnownInput ? MOUSE_INPUT_VALUE + event.input : EMPTY), attributes),
+          Napi::PropertyDescriptor::Value(string(STATE), state, attributes),
+          Napi::PropertyDescriptor::Value(string(POSITION), position, attributes),
+          Napi::PropertyDescriptor::Value(string(IS_INJECTED), isInjected, attributes),
+          Napi::PropertyDescriptor::Value(string(IS_SUPPRESSED), isSuppressed, attributes),
+        });
+      }
+      else {
+        eventObj.DefineProperties({
+          Napi::PropertyDescriptor::Value(string(TYPE), string(KEYBOARD), attributes),
+          Napi::PropertyDescriptor::Value(string(TIMESTAMP), timestamp, attributes),
+          Napi::PropertyDescriptor::Value(string(INPUT), Napi::Number::New(env, event.input), attributes),
+          Napi::PropertyDescriptor::Value(string(STATE), state, attributes),
+          Napi::PropertyDescriptor::Value(string(IS_INJECTED), isInjected, attributes),
+          Napi::PropertyDescriptor::Value(string(IS_SUPPRESSED), isSuppressed, attributes),
+        });
+      }
+      return eventObj;
+    }
+
+  private:
+    // Indexes in STRINGS. STATE_VALUE and MOUSE_INPUT_VALUE start the values
+    // ordered as InputEventState and MouseInputCode.
+    enum {
+      TYPE = 0,
+      TIMESTAMP = 1,
+      INPUT = 2,
+      STATE = 3,
+      STATE_VALUE = 4,
+      POSITION = 7,
+      X = 8,
+      Y = 9,
+      IS_INJECTED = 10,
+      IS_SUPPRESSED = 11,
+      MOUSE = 12,
+      KEYBOARD = 13,
+      MOUSE_INPUT_VALUE = 14,
+      EMPTY = 21,
+    };
+    static constexpr const char* STRINGS[] = {
+      "type", "timestamp", "input",
+      "state", "down", "up", "neutral",
+      "position", "x", "y",
+      "isInjected", "isSuppressed",
+      "mouse", "keyboard",
+      "move", "left", "right", "middle", "wheel", "extraButton1", "extraButton2",
+      "",
+    };
+
+    Napi::String string(int index) const {
+      return m_strings[index].Value();
+    }
+
+    std::vector<Napi::Reference<Napi::String>> m_strings;
+};
+
+// Hotkeys, matched against keyboard events on the input listener thread. Each
+// hotkey is compiled into a linear state machine over its sequence of chords:
+// a chord is reached when its last key goes down while exactly its keys are
+// held, and the next chord must be reached within the hotkey timeout.
+class HotkeyMatcher {
+  public:
+    // Keys of a chord, each with its alternative key codes (e.g. left and right ctrl)
+    using Chord = std::vector<std::vector<int>>;
+
+    // Whether the system still sees a key as held
+    using KeyStateQuery = std::function<bool(int keyCode)>;
+
+    struct Hotkey {
+      std::vector<Chord> sequence;
+      uint64_t timeout; // ms between two chords
+      bool isInjectedIgnored;
+      std::function<void(uint64_t timestamp)> onMatch;
+    };
+
+    HotkeyMatcher() { }
+
+    void add(int id, Hotkey hotkey) {
+      if (m_states.empty()) {
+        // Keys released while nothing was matched may still look held
+        m_heldKeys.clear();
+      }
+      m_states[id] = State{ std::move(hotkey), 0, 0 };
+    }
+
+    void remove(int id) {
+      m_states.erase(id);
+    }
+
+    void clear() {
+      m_states.clear();
+      m_heldKeys.clear();
+    }
+
+    bool empty() const {
+      return m_states.empty();
+    }
+
+    // Advance every hotkey with the given keyboard event, calling back the
+    // hotkeys it completes
+    void process(const RawInputEvent& event, const KeyStateQuery& isKeyHeld) {
+      if (event.state == InputEventState::Up) {
+        m_heldKeys.erase(event.input);
+        return;
+      }
+      if (!m_heldKeys.emplace(event.input, HeldKey{ event.timestamp, event.isSuppressed }).second) {
+        // Key repeat
+        return;
+      }
+      dropReleasedKeys(event, isKeyHeld);
+      for (auto& [id, state] : m_states) {
+        const Hotkey& hotkey = state.hotkey;
+        if (hotkey.isInjectedIgnored && event.isInjected) {
+          continue;
+        }
+        if (state.step > 0 && event.timestamp - state.lastStepAt > hotkey.timeout) {
+          state.step = 0;
+        }
+        const Chord& chord = hotkey.sequence[state.step];
+        if (!isChordHeld(chord)) {
+          if (state.step > 0 && !isInChord(chord, event.input)) {
+            // Wrong key: the sequence may start over from this one
+            state.step = 0;
+            if (isChordHeld(hotkey.sequence[0])) {
+              state.step = 1;
+              state.lastStepAt = event.timestamp;
+            }
+          }
+          continue;
+        }
+        state.step++;
+        state.lastStepAt = event.timestamp;
+        if (state.step == hotkey.sequence.size()) {
+          state.step = 0;
+          hotkey.onMatch(event.timestamp);
+        }
+      }
+    }
+
+  private:
+    struct State {
+      Hotkey hotkey;
+      size_t step; // index of the next chord
+      uint64_t lastStepAt;
+    };
+
+    struct HeldKey {
+      uint64_t pressedAt;
+      // Suppressed keys never reach the system key state
+      bool isSuppressed;
+    };
+
+    // Age (in ms) after which a held key is checked against the system key
+    // state, so that the events not processed yet never make it look released
+    static constexpr uint64_t STALE_KEY_AGE = 250;
+
+    // Forget the held keys whose release was never seen (e.g. locked session,
+    // secure desktop or focus grabs), which would otherwise break every hotkey
+    // including them
+    void dropReleasedKeys(const RawInputEvent& event, const KeyStateQuery& isKeyHeld) {
+      for (auto heldKey = m_heldKeys.begin(); heldKey != m_heldKeys.end();) {
+        bool isStale = (
+          heldKey->first != event.input
+          && !heldKey->second.isSuppressed
+          && event.timestamp > heldKey->second.pressedAt + STALE_KEY_AGE
+          && !isKeyHeld(heldKey->first)
+        );
+        heldKey = isStale ? m_heldKeys.erase(heldKey) : std::next(heldKey);
+      }
+    }
+
+    static bool isInChord(const Chord& chord, int keyCode) {
+      for (const std::vector<int>& key : chord) {
+        if (std::find(key.begin(), key.end(), keyCode) != key.end()) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Whether every key of the chord is held, and no other key
+    bool isChordHeld(const Chord& chord) const {
+      for (const std::vector<int>& key : chord) {
+        bool isKeyHeld = std::any_of(key.begin(), key.end(), [this](int keyCode) {
+          return m_heldKeys.count(keyCode) > 0;
+        });
+        if (!isKeyHeld) {
+          return false;
+        }
+      }
+      for (const auto& [heldKey, held] : m_heldKeys) {
+        if (!isInChord(chord, heldKey)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    std::map<int, State> m_states;
+    std::map<int, HeldKey> m_heldKeys;
+};
+
+// Immutable snapshot of the suppressed inputs, read by the input listener
+// without locking. A new table is built and swapped in with std::atomic_store
+// whenever suppression changes (see PublishInputSuppressionTable). Each input
+// has one flag telling it is suppressed at all, then one flag per state.
+class InputSuppressionTable {
+  public:
+    InputSuppressionTable() : m_keyboardFlags(KEYBOARD_TABLE_SIZE, 0), m_mouseFlags{} { }
+
+    InputSuppressionTable(const std::map<int, std::set<int>>& mouseInputStates, const std::map<int, std::set<int>>& keyboardInputStates) : InputSuppressionTable() {
+      for (const auto& [input, states] : mouseInputStates) {
+        if (input >= 0 && input < MOUSE_TABLE_SIZE) {
+          m_mouseFlags[input] = toFlags(states);
+        }
+      }
+      for (const auto& [input, states] : keyboardInputStates) {
+        if (input >= 0 && input < KEYBOARD_TABLE_SIZE) {
+          m_keyboardFlags[input] = toFlags(states);
+        }
+        else {
+          // Sorted, as std::map is
+          m_extendedKeyboardFlags.emplace_back(input, toFlags(states));
+        }
+      }
+    }
+
+    bool isKeyboardSuppressed(int input) const {
+      return (keyboardFlags(input) & SUPPRESSED) != 0;
+    }
+
+    // 0 = down, 1 = up, 2 = neutral
+    bool isKeyboardSuppressed(int input, int state) const {
+      return (keyboardFlags(input) & stateFlag(state)) != 0;
+    }
+
+    bool isMouseSuppressed(int input) const {
+      return (mouseFlags(input) & SUPPRESSED) != 0;
+    }
+
+    bool isMouseSuppressed(int input, int state) const {
+      return (mouseFlags(input) & stateFlag(state)) != 0;
+    }
+
+  private:
+    // Inputs below these sizes are looked up directly, the others are searched
+    static constexpr int KEYBOARD_TABLE_SIZE = 0x10000;
+    static constexpr int MOUSE_TABLE_SIZE = 256;
+    static constexpr uint8_t SUPPRESSED = 1;
+
+    static uint8_t stateFlag(int state) {
+      return state >= 0 && state < 7 ? static_cast<uint8_t>(2 << state) : 0;
+    }
+
+    static uint8_t toFlags(const std::set<int>& states) {
+      uint8_t flags = SUPPRESSED;
+      for (int state : states) {
+        flags |= stateFlag(state);
+      }
+      return flags;
+    }
+
+    uint8_t keyboardFlags(int input) const {
+      if (input >= 0 && input < KEYBOARD_TABLE_SIZE) {
+        return m_keyboardFlags[input];
+      }
+      auto it = std::lower_bound(m_extendedKeyboardFlags.begin(), m_extendedKeyboardFlags.end(), std::make_pair(input, static_cast<uint8_t>(0)));
+      return it != m_extendedKeyboardFlags.end() && it->first == input ? it->second : 0;
+    }
+
+    uint8_t mouseFlags(int input) const {
+      return input >= 0 && input < MOUSE_TABLE_SIZE ? m_mouseFlags[input] : 0;
+    }
+
+    std::vector<uint8_t> m_keyboardFlags;
+    std::vector<std::pair<int, uint8_t>> m_extendedKeyboardFlags;
+    std::array<uint8_t, MOUSE_TABLE_SIZE> m_mouseFlags;
+};
+
+template <typename T>
+class PromiseWorker : public Napi::AsyncWorker {
+  public:
+
+    PromiseWorker(
+      Napi::Env env,
+      Napi::Promise::Deferred deferred,
+      std::function<T()> executeCallback,
+      std::function<Napi::Value(Napi::Env, const T&)> resolveConverter
+    ) : Napi::AsyncWorker(env), deferred(deferred), executeCallback(executeCallback), resolveConverter(resolveConverter) { }
+
+    ~PromiseWorker() override { }
+
+    void Execute() override {
+      try {
+        promiseResolveResult = executeCallback();
+      } catch (const std::exception& e) {
+        SetError(e.what());
+      } catch (...) {
+        SetError("Unknown error occurred");
+      }
+    }
+
+    void OnOK() override {
+      deferred.Resolve(resolveConverter(Env(), promiseResolveResult));
+    }
+
+    void OnError(const Napi::Error& error) override {
+      deferred.Reject(error.Value());
+    }
+
+  private:
+    Napi::Promise::Deferred deferred;
+    std::function<T()> executeCallback;
+    std::function<Napi::Value(Napi::Env, const T&)> resolveConverter;
+    T promiseResolveResult;
+};
+
+
+// =============================================================================
+// ============================== GLOBAL VARIABLES =============================
+// =============================================================================
+
+// Input events variables
+HHOOK mouseHook = nullptr;
+HHOOK keyboardHook = nullptr;
+std::mutex inputEventHookMutex;
+std::atomic<bool> inputEventRunning(false);
+std::condition_variable inputEventHookCondition;
+Napi::ThreadSafeFunction inputEventThreadSafeJsFunction;
+// Created on the main thread on the first input event (see BuildInputEventObject)
+std::unique_ptr<InputEventObjectBuilder> inputEventObjectBuilder;
+std::queue<RawInputEvent> inputEventQueue;
+std::mutex inputEventQueueMutex;
+std::condition_variable inputEventQueueCondition;
+// Input event batching (see setInputEventBatching). Events are sent one by
+// one while both the interval (ms) and the size are 0.
+std::atomic<uint32_t> inputEventBatchInterval(0);
+std::atomic<uint32_t> inputEventBatchSize(0);
+std::atomic<bool> inputEventMotionCoalescing(false);
+// Input event subscription, replaced as a whole with std::atomic_store so the
+// dispatch thread never waits for it. Hooks still see every event, as they
+// decide which ones are suppressed.
+std::shared_ptr<const InputEventFilter> inputEventFilter = std::make_shared<const InputEventFilter>();
+
+// Maps to store mouse and keyboard suppressed keys
+std::map<int, std::set<int>> suppressedMouseKeys;
+std::map<int, std::set<int>> suppressedKeyboardKeys;
+std::mutex suppressedKeysMutex;
+// Snapshot of the maps above for the input listener (see InputSuppressionTable)
+std::shared_ptr<const InputSuppressionTable> inputSuppressionTable = std::make_shared<const InputSuppressionTable>();
+
+// Window events variables
+std::vector<HWINEVENTHOOK> windowEventHooks;
+std::mutex windowEventHookMutex;
+std::atomic<bool> windowEventRunning(false);
+std::condition_variable windowEventHookCondition;
+Napi::ThreadSafeFunction windowEventThreadSafeJsFunction;
+std::queue<RawWindowEvent> windowEventQueue;
+std::mutex windowEventQueueMutex;
+std::condition_variable windowEventQueueCondition;
+
+// Tray icon variables
+std::mutex trayIconMutex;
+std::condition_variable trayIconCondition;
+std::atomic<bool> trayIconRunning(false);
+HWND trayIconWindowHwnd;
+NOTIFYICONDATAW nid = { 0 };
+HMENU hMenu;
+std::map<int, std::function<void()>> trayIconMenuItemsCallbacks;
+std::map<int, Napi::ThreadSafeFunction> trayIconMenuItemsJsCallbacks;
+
+// Audio manager
+AudioManager* audioManager = nullptr;
+
+// Active screen recorders by ID
+std::map<int, std::shared_ptr<ScreenRecorder>> screenRecorders;
+std::mutex screenRecordersMutex;
+int nextScreenRecorderId = 1;
+
+// Active flight recorders by ID
+std::map<int, std::shared_ptr<FlightRecorder>> flightRecorders;
+std::mutex flightRecordersMutex;
+int nextFlightRecorderId = 1;
+
+// Active screen frame feeds by ID, with the JS objects they depend on
+struct ScreenFrameFeedHandle {
+  std::shared_ptr<ScreenFrameFeed> feed;
+  Napi::ThreadSafeFunction onFrame;
+  Napi::Reference<Napi::Uint8Array> memory;
+};
+std::map<int, ScreenFrameFeedHandle> screenFrameFeeds;
+std::mutex screenFrameFeedsMutex;
+int nextScreenFrameFeedId = 1;
+
+// Active input event rings by ID, with the JS objects they depend on. The
+// input listener thread writes every event to each of them.
+struct InputEventRingHandle {
+  std::shared_ptr<InputEventRing> ring;
+  Napi::ThreadSafeFunction onWaiting;
+  Napi::Reference<Napi::Uint8Array> memory;
+};
+std::map<int, InputEventRingHandle> inputEventRings;
+std::mutex inputEventRingsMutex;
+int nextInputEventRingId = 1;
+
+// Active native input recorders by ID. The input listener thread records every
+// event into each of them.
+std::map<int, std::shared_ptr<InputRecorder>> inputRecorders;
+std::mutex inputRecordersMutex;
+int nextInputRecorderId = 1;
+
+// Running native input replayers by ID. A replayer is removed once its end was
+// settled on the JS thread.
+std::map<int, std::shared_ptr<InputReplayer>> inputReplayers;
+std::mutex inputReplayersMutex;
+int nextInputReplayerId = 1;
+
+// Registered hotkeys and their JS callbacks by ID (see registerHotkey)
+HotkeyMatcher hotkeyMatcher;
+std::map<int, Napi::ThreadSafeFunction> hotkeyThreadSafeJsFunctions;
+std::mutex hotkeysMutex;
+int nextHotkeyId = 1;
+
+// Recently recognized OCR results
+OcrResultCache ocrResultCache(64);
+
+// Runs input sequences sent with sendInputSequence
+InputSequencer inputSequencer;
+
+// Fires the asynchronous sleeps of sleepAsync
+TimerService timerService;
+
+
+// =============================================================================
+// ============================= UTILITY FUNCTIONS =============================
+// =============================================================================
+
+std::string ConvertToUTF8(const std::wstring& wideStr) {
+  int bufferSize = WideCharToMultiByte(CP_UTF8, 0, wideStr.c_str(), wideStr.size(), NULL, 0, NULL, NULL);
+  std::string utf8Str(bufferSize, 0);
+  WideCharToMultiByte(CP_UTF8, 0, wideStr.c_str(), wideStr.size(), &utf8Str[0], bufferSize, NULL, NULL);
+  return utf8Str;
+}
+
+uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Milliseconds on the monotonic clock since an unspecified point (usually the
+// boot), with sub-millisecond precision. Unlike Now(), it never jumps.
+double MonotonicNow() {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Refresh rate in Hz of the monitor showing (x, y), 60 if unknown
+double GetRefreshRate(int x, int y) {
+  MONITORINFOEXW monitorInfo;
+  monitorInfo.cbSize = sizeof(MONITORINFOEXW);
+  HMONITOR monitor = MonitorFromPoint(POINT{ x, y }, MONITOR_DEFAULTTONEAREST);
+  DEVMODEW devMode = { 0 };
+  devMode.dmSize = sizeof(DEVMODEW);
+  if (
+    !GetMonitorInfoW(monitor, &monitorInfo)
+    || !EnumDisplaySettingsW(monitorInfo.szDevice, ENUM_CURRENT_SETTINGS, &devMode)
+    || devMode.dmDisplayFrequency <= 1 // 0 and 1 stand for the hardware default
+  ) {
+    return 60.0;
+  }
+  return static_cast<double>(devMode.dmDisplayFrequency);
+}
+
+// Sequencer callback settling the deferred promise on the JS thread
+InputSequencer::Callback SettleInputSequence(Napi::Env env, Napi::Promise::Deferred deferred) {
+  Napi::ThreadSafeFunction settle = Napi::ThreadSafeFunction::New(
+    env,
+    Napi::Function::New(env, [](const Napi::CallbackInfo&) { }),
+    "sendInputSequence",
+    0,
+    1
+  );
+  return [settle, deferred](std::exception_ptr error) {
+    settle.BlockingCall([deferred, error](const Napi::Env& env, const Napi::Function&) {
+      if (!error) {
+        deferred.Resolve(env.Undefined());
+        return;
+      }
+      try {
+        std::rethrow_exception(error);
+      }
+      catch (const std::exception& e) {
+        deferred.Reject(Napi::Error::New(env, e.what()).Value());
+      }
+    });
+    settle.Release();
+  };
+}
+
+// Queue an input sequence program on the sequencer thread. The returned
+// promise settles on the JS thread once the program ran.
+Napi::Promise SubmitInputSequence(Napi::Env env, std::vector<int32_t> program) {
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  inputSequencer.submit(std::move(program), SettleInputSequence(env, deferred));
+  return deferred.Promise();
+}
+
+// Return this dynamic library's absolute directory path (/path/to/build/Release/actionify.node)
+std::filesystem::path GetModuleAbsoluteDirectoryPath() {
+  HMODULE hModule = nullptr;
+
+  // Get handle of the DLL that contains this function
+  if (
+    !GetModuleHandleExW(
+      GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+      reinterpret_cast<LPCWSTR>(&GetModuleAbsoluteDirectoryPath),
+      &hModule
+    )
+  ) {
+    return {};
+  }
+
+  wchar_t path[MAX_PATH];
+  if (!GetModuleFileNameW(hModule, path, MAX_PATH)) {
+    return {};
+  }
+
+  return std::filesystem::path(path).parent_path();
+}
+
+std::filesystem::path GetUserDataAbsoluteDirectoryPath() {
+  std::filesystem::path userDataAbsoluteDirectoryPath = (GetModuleAbsoluteDirectoryPath() / "../../data").lexically_normal();
+  std::filesystem::create_directories(userDataAbsoluteDirectoryPath);
+  return userDataAbsoluteDirectoryPath;
+}
+
+std::filesystem::path GetUserDataTtsAbsoluteDirectoryPath() {
+  std::filesystem::path userDataTtsAbsoluteDirectoryPath = (GetUserDataAbsoluteDirectoryPath() / "tts").lexically_normal();
+  std::filesystem::create_directories(userDataTtsAbsoluteDirectoryPath);
+  return userDataTtsAbsoluteDirectoryPath;
+}
+
+std::filesystem::path GetUserDataTmpAbsoluteDirectoryPath() {
+  std::filesystem::path userDataTmpAbsoluteDirectoryPath = (GetUserDataAbsoluteDirectoryPath() / "tmp").lexically_normal();
+  std::filesystem::create_directories(userDataTmpAbsoluteDirectoryPath);
+  return userDataTmpAbsoluteDirectoryPath;
+}
+
+std::optional<std::filesystem::path> FindFile(
+  const std::filesystem::path& directoryPath,
+  const std::function<bool(const std::filesystem::directory_entry&)>& predicate
+) {
+  for (const auto& entry : std::filesystem::directory_iterator(directoryPath)) {
+    if (predicate(entry)) {
+      return entry.path();
+    }
+  }
+  return std::nullopt;
+}
+
+template<typename T>
+T ExpectOrThrow(std::optional<T> value, std::string_view errorMessage) {
+  if (!value) {
+    throw std::runtime_error(std::string(errorMessage));
+  }
+
+  return std::move(*value);
+}
+
+std::string ToLower(const std::string& text) {
+  std::string result = text;
+  std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::tolower(c); });
+  return result;
+}
+
+AudioManager* GetAudioManager() {
+  if (audioManager == nullptr) {
+    audioManager = new AudioManager();
+  }
+  return audioManager;
+}
+
+void CloseAudioManager() {
+  if (audioManager != nullptr) {
+    delete audioManager;
+    audioManager = nullptr;
+  }
+}
+
+
+// =============================================================================
+// ============================= RESOURCE CLEANUP ==============================
+// =============================================================================
+
+// Function to clean up tray icon resources, ONLY CALLABLE BY TRAY ICON THREAD
+void CleanupTrayIcon() {
+  std::lock_guard<std::mutex> lock(trayIconMutex);
+  // Remove the tray icon before closing the window
+  Shell_NotifyIconW(NIM_DELETE, &nid);
+
+  // Destroy the window associated with the tray icon
+  if (trayIconWindowHwnd) {
+    DestroyWindow(trayIconWindowHwnd);
+  }
+
+  // Unregister the window class (only if not reusing the class name elsewhere)
+  UnregisterClassW(L"TrayIconClass", GetModuleHandle(NULL));
+
+  // Clear tray icon menu items callbacks
+  for (const auto& [id, trayIconMenuItemJsCallback] : trayIconMenuItemsJsCallbacks) {
+    trayIconMenuItemJsCallback.Abort();
+  }
+  trayIconMenuItemsJsCallbacks.clear();
+  trayIconMenuItemsCallbacks.clear();
+
+  // Reset tray icon state
+  trayIconRunning = false;
+  trayIconCondition.notify_all();
+}
+
+void CleanScreenRecorders() {
+  std::map<int, std::shared_ptr<ScreenRecorder>> recorders;
+  {
+    std::lock_guard<std::mutex> lock(screenRecordersMutex);
+    recorders.swap(screenRecorders);
+  }
+  for (auto& [id, recorder] : recorders) {
+    try {
+      recorder->stop();
+    } catch (...) {
+      // The recording file is incomplete, but the cleanup must go on
+    }
+  }
+}
+
+void CleanInputEventRings() {
+  std::map<int, InputEventRingHandle> rings;
+  {
+    std::lock_guard<std::mutex> lock(inputEventRingsMutex);
+    rings.swap(inputEventRings);
+  }
+  for (auto& [id, handle] : rings) {
+    handle.ring->stop();
+    handle.onWaiting.Release();
+    handle.memory.Reset();
+  }
+}
+
+void CleanInputRecorders() {
+  std::map<int, std::shared_ptr<InputRecorder>> recorders;
+  {
+    std::lock_guard<std::mutex> lock(inputRecordersMutex);
+    recorders.swap(inputRecorders);
+  }
+  for (auto& [id, recorder] : recorders) {
+    try {
+      recorder->stop();
+    } catch (...) {
+      // The recording file is incomplete, but the cleanup must go on
+    }
+  }
+}
+
+void CleanInputReplayers() {
+  std::map<int, std::shared_ptr<InputReplayer>> replayers;
+  {
+    std::lock_guard<std::mutex> lock(inputReplayersMutex);
+    replayers.swap(inputReplayers);
+  }
+  for (auto& [id, replayer] : replayers) {
+    replayer->stop();
+  }
+}
+
+void CleanHotkeys() {
+  std::map<int, Napi::ThreadSafeFunction> threadSafeJsFunctions;
+  {
+    std::lock_guard<std::mutex> lock(hotkeysMutex);
+    hotkeyMatcher.clear();
+    threadSafeJsFunctions.swap(hotkeyThreadSafeJsFunctions);
+  }
+  for (auto& [id, threadSafeJsFunction] : threadSafeJsFunctions) {
+    threadSafeJsFunction.Release();
+  }
+}
+
+void CleanScreenFrameFeeds() {
+  std::map<int, ScreenFrameFeedHandle> feeds;
+  {
+    std::lock_guard<std::mutex> lock(screenFrameFeedsMutex);
+    feeds.swap(screenFrameFeeds);
+  }
+  for (auto& [id, handle] : feeds) {
+    handle.feed->stop();
+    handle.onFrame.Release();
+    handle.memory.Reset();
+  }
+}
+
+void CleanFlightRecorders() {
+  std::map<int, std::shared_ptr<FlightRecorder>> recorders;
+  {
+    std::lock_guard<std::mutex> lock(flightRecordersMutex);
+    recorders.swap(flightRecorders);
+  }
+  for (auto& [id, recorder] : recorders) {
+    recorder->stop();
+  }
+}
+
+void CleanInputSequencer() {
+  inputSequencer.stop();
+}
+
+void CleanTimerService() {
+  timerService.stop();
+}
+
+void CleanAll() {
+  CleanInputSequencer();
+  CleanTimerService();
+  CleanScreenRecorders();
+  CleanFlightRecorders();
+  CleanScreenFrameFeeds();
+  CleanInputEventRings();
+  CleanInputRecorders();
+  CleanInputReplayers();
+  CleanHotkeys();
+  if (inputEventRunning.load()) {
+    inputEventRunning = false;
+    inputEventQueueCondition.notify_all();
+    {
+      std::unique_lock<std::mutex> lock(inputEventHookMutex);
+      inputEventHookCondition.wait(lock, [] { return mouseHook == nullptr && keyboardHook == nullptr; });
+    }
+  }
+  inputEventObjectBuilder.reset();
+  if (windowEventRunning.load()) {
+    windowEventRunning = false;
+    windowEventQueueCondition.notify_all();
+    {
+      std::unique_lock<std::mutex> lock(windowEventHookMutex);
+      windowEventHookCondition.wait(lock, [] { return windowEventHooks.empty(); });
+    }
+  }
+  if (trayIconRunning.load()) {
+    // Notify the tray icon thread to close
+    PostMessage(trayIconWindowHwnd, WM_CLOSE, 0, 0);
+    {
+      // Wait for the tray icon thread to close
+      std::unique_lock<std::mutex> lock(trayIconMutex);
+      trayIconCondition.wait(lock, [] { return !trayIconRunning.load(); });
+    }
+  }
+  CloseAudioManager();
+}
+
+Napi::Value CleanupResources(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  CleanAll();
+  return env.Undefined();
+}
+
+// =============================================================================
+// ============================= HOOK PROCEDURES ===============================
+// =============================================================================
+
+// Mouse hook procedure
+LRESULT CALLBACK MouseProc(int nCode, WPARAM wParam, LPARAM lParam) {
+  if (nCode >= 0) {
+    MSLLHOOKSTRUCT* mouseStruct = reinterpret_cast<MSLLHOOKSTRUCT*>(lParam);
+    if (mouseStruct) {
+      int mappedInput = -1; // MouseInputCode
+      int mappedState = -1; // InputEventState
+      switch (wParam) {
+        case WM_LBUTTONDOWN: {
+          mappedInput = 1;
+          mappedState = 0;
+          break;
+        }
+        case WM_LBUTTONUP: {
+          mappedInput = 1;
+          mappedState = 1;
+          break;
+        }
+        case WM_RBUTTONDOWN: {
+          mappedInput = 2;
+          mappedState = 0;
+          break;
+        }
+        case WM_RBUTTONUP: {
+          mappedInput = 2;
+          mappedState = 1;
+          break;
+        }
+        case WM_MBUTTONDOWN: {
+          mappedInput = 3;
+          mappedState = 0;
+          break;
+        }
+        case WM_MBUTTONUP: {
+          mappedInput = 3;
+          mappedState = 1;
+          break;
+        }
+        case WM_MOUSEMOVE: {
+          mappedInput = 0;
+          mappedState = 2;
+          break;
+        }
+        case WM_MOUSEWHEEL: {
+          short wheelDelta = GET_WHEEL_DELTA_WPARAM(mouseStruct->mouseData);
+          if (wheelDelta > 0) {
+            mappedInput = 4;
+            mappedState = 1;
+          }
+          else if (wheelDelta < 0) {
+            mappedInput = 4;
+            mappedState = 0;
+          }
+          else {
+            mappedInput = 4;
+            mappedState = 2;
+          }
+          break;
+        }
+        case WM_XBUTTONDOWN: {
+          WORD xButton = HIWORD(mouseStruct->mouseData);
+          mappedInput = 4 + xButton;
+          mappedState = 0;
+          break;
+        }
+        case WM_XBUTTONUP: {
+          WORD xButton = HIWORD(mouseStruct->mouseData);
+          mappedInput = 4 + xButton;
+          mappedState = 1;
+          break;
+        }
+      }
+
+      if (mappedInput != -1) {
+        bool isInputInjected = (mouseStruct->flags & LLMHF_INJECTED) != 0;
+        // Lock-free: the hook must return quickly or Windows drops it
+        bool isInputSuppressed = std::atomic_load(&inputSuppressionTable)->isMouseSuppressed(mappedInput, mappedState);
+        {
+          RawInputEvent event = { InputEventType::Mouse, mappedInput, static_cast<InputEventState>(mappedState), mouseStruct->pt.x, mouseStruct->pt.y, Now(), isInputSuppressed, isInputInjected };
+          std::lock_guard<std::mutex> lock(inputEventQueueMutex);
+          inputEventQueue.push(event);
+          inputEventQueueCondition.notify_all();
+        }
+        if (isInputSuppressed) {
+          return 1;
+        }
+      }
+    }
+  }
+  return CallNextHookEx(nullptr, nCode, wParam, lParam);
+}
+
+// Keyboard hook procedure
+LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
+  if (nCode >= 0) {
+    KBDLLHOOKSTRUCT* kbStruct = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
+    if (kbStruct) {
+      int mappedState = -1; // InputEventState
+      switch (wParam) {
+        // Alt, keys pressed with Alt and F10 are system keys
+        case WM_KEYDOWN:
+        case WM_SYSKEYDOWN: {
+          mappedState = 0;
+          break;
+        }
+        case WM_KEYUP:
+        case WM_SYSKEYUP: {
+          mappedState = 1;
+          break;
+        }
+      }
+
+      if (mappedState != -1) {
+        bool isInputInjected = (kbStruct->flags & LLKHF_INJECTED) != 0;
+        int vkCode = static_cast<int>(kbStruct->vkCode);
+        // Lock-free: the hook must return quickly or Windows drops it
+        bool isInputSuppressed = std::atomic_load(&inputSuppressionTable)->isKeyboardSuppressed(vkCode, mappedState);
+        {
+          RawInputEvent event = { InputEventType::Keyboard, vkCode, static_cast<InputEventState>(mappedState), 0, 0, Now(), isInputSuppressed, isInputInjected };
+          std::lock_guard<std::mutex> lock(inputEventQueueMutex);
+          inputEventQueue.push(event);
+          inputEventQueueCondition.notify_all();
+        }
+        if (isInputSuppressed) {
+          return 1;
+        }
+      }
+    }
+  }
+  return CallNextHookEx(nullptr, nCode, wParam, lParam);
+}
+
+// Function to convert event data to a JavaScript object
+Napi::Object BuildInputEventObject(const Napi::Env& env, const RawInputEvent& event) {
+  if (!inputEventObjectBuilder) {
+    inputEventObjectBuilder = std::make_unique<InputEventObjectBuilder>(env);
+  }
+  return inputEventObjectBuilder->build(env, event);
+}
+
+// Whether input events are currently batched (see setInputEventBatching)
+bool IsInputEventBatchingEnabled() {
+  return inputEventBatchInterval.load() > 0 || inputEventBatchSize.load() > 0;
+}
+
+// Send the batched input events to JavaScript as one Float64Array
+void DeliverInputEventBatch(InputEventBatch& batch) {
+  inputEventThreadSafeJsFunction.BlockingCall([records = batch.take()](const Napi::Env& env, const Napi::Function& jsCallback) {
+    if (!jsCallback.IsEmpty()) {
+      Napi::Float64Array array = Napi::Float64Array::New(env, records.size());
+      std::copy(records.begin(), records.end(), array.Data());
+      jsCallback.Call({ array });
+    }
+  });
+}
+
+// Send an input event to JavaScript, either right away or with the next batch
+void DispatchInputEvent(const RawInputEvent& rawInputEvent, InputEventBatch& batch) {
+  // Rings get every event, whatever the batching
+  {
+    std::lock_guard<std::mutex> lock(inputEventRingsMutex);
+    for (auto& [id, handle] : inputEventRings) {
+      handle.ring->push(rawInputEvent);
+    }
+  }
+
+  // Native recorders too, each keeping the events it was asked for
+  {
+    std::lock_guard<std::mutex> lock(inputRecordersMutex);
+    for (auto& [id, recorder] : inputRecorders) {
+      recorder->record(rawInputEvent);
+    }
+  }
+
+  // Hotkeys see every keyboard event, whatever the filter
+  if (rawInputEvent.type == InputEventType::Keyboard) {
+    std::lock_guard<std::mutex> lock(hotkeysMutex);
+    hotkeyMatcher.process(rawInputEvent, [](int vkCode) {
+      return (GetAsyncKeyState(vkCode) & 0x8000) != 0;
+    });
+  }
+
+  // Nobody subscribed to this event
+  if (!std::atomic_load(&inputEventFilter)->accepts(EncodeInputEvent(rawInputEvent))) {
+    return;
+  }
+
+  if (!IsInputEventBatchingEnabled()) {
+    // Batching was just disabled: deliver the remaining events first
+    if (!batch.empty()) {
+      DeliverInputEventBatch(batch);
+    }
+    inputEventThreadSafeJsFunction.BlockingCall([rawInputEvent](const Napi::Env& env, const Napi::Function& jsCallback) {
+      if (!jsCallback.IsEmpty()) {
+        jsCallback.Call({ BuildInputEventObject(env, rawInputEvent) });
+      }
+    });
+    return;
+  }
+  batch.add(rawInputEvent, inputEventMotionCoalescing.load());
+  uint32_t batchSize = inputEventBatchSize.load();
+  if (batchSize > 0 && batch.size() >= batchSize) {
+    DeliverInputEventBatch(batch);
+  }
+}
+
+// When the given batch is due, batches without interval being delivered as
+// soon as no more events are pending
+std::chrono::steady_clock::time_point GetInputEventBatchDeadline(const InputEventBatch& batch) {
+  return batch.startedAt() + std::chrono::milliseconds(inputEventBatchInterval.load());
+}
+
+void ClearHooks() {
+  // Unhook
+  {
+    std::lock_guard<std::mutex> lock(inputEventHookMutex);
+    if (mouseHook) {
+      UnhookWindowsHookEx(mouseHook);
+      mouseHook = nullptr;
+    }
+
+    if (keyboardHook) {
+      UnhookWindowsHookEx(keyboardHook);
+      keyboardHook = nullptr;
+    }
+  }
+
+  // Clear callback, once the pending calls (such as the last batch) are made
+  inputEventThreadSafeJsFunction.Release();
+
+  inputEventHookCondition.notify_all();
+}
+
+// Thread to process events and invoke the JavaScript callback
+void InputEventProcessingThread(const Napi::Env& env) {
+  {
+    std::lock_guard<std::mutex> lock(inputEventHookMutex);
+    mouseHook = SetWindowsHookEx(WH_MOUSE_LL, MouseProc, nullptr, 0);
+    if (!mouseHook) {
+      Napi::Error::New(env, "Failed to set mouse hook").ThrowAsJavaScriptException();
+      return;
+    }
+    keyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, KeyboardProc, nullptr, 0);
+    if (!keyboardHook) {
+      Napi::Error::New(env, "Failed to set keyboard hook").ThrowAsJavaScriptException();
+      return;
+    }
+  }
+
+  inputEventRunning = true;
+  inputEventHookCondition.notify_all();
+  std::thread nestedThread([env]() {
+    // Events waiting to be delivered, when batching
+    InputEventBatch inputEventBatch;
+    while (inputEventRunning) {
+      std::unique_lock<std::mutex> lock(inputEventQueueMutex);
+      if (inputEventBatch.empty()) {
+        inputEventQueueCondition.wait(lock, [] { return !inputEventQueue.empty() || !inputEventRunning; });
+      }
+      else {
+        // Wait for the next event until the batch is due
+        inputEventQueueCondition.wait_until(lock, GetInputEventBatchDeadline(inputEventBatch), [] { return !inputEventQueue.empty() || !inputEventRunning; });
+      }
+
+      while (!inputEventQueue.empty()) {
+        RawInputEvent rawInputEvent = inputEventQueue.front();
+        inputEventQueue.pop();
+
+        DispatchInputEvent(rawInputEvent, inputEventBatch);
+      }
+
+      if (!inputEventBatch.empty() && std::chrono::steady_clock::now() >= GetInputEventBatchDeadline(inputEventBatch)) {
+        DeliverInputEventBatch(inputEventBatch);
+      }
+    }
+    // Deliver the last, partially filled batch before the callback goes away
+    if (!inputEventBatch.empty()) {
+      DeliverInputEventBatch(inputEventBatch);
+    }
+    ClearHooks();
+  });
+
+  MSG msg;
+  while (GetMessage(&msg, nullptr, 0, 0)) {
+    TranslateMessage(&msg);
+    DispatchMessage(&msg);
+  }
+  nestedThread.join();
+}
+
+// Function to start monitoring input events
+Napi::Value StartInputEventListener(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Skip if already listening
+  if (inputEventRunning) {
+    return Napi::Boolean::New(env, true);
+  }
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsFunction()) {
+    Napi::TypeError::New(env, "Expected a callback function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Convert JS callback to a NAPI ThreadSafeFunction
+  inputEventThreadSafeJsFunction = Napi::ThreadSafeFunction::New(
+    env, // the main NAPI environment
+    info[0].As<Napi::Function>(), // callback function that needs to be called in thread(s)
+    "callback", // JS string used to provide diagnostic information
+    0, // maximum queue size (0 for unlimited)
+    1, // initial number of threads which will be making use of this function
+    [](const Napi::Env& env) { // finalizer callback, can be used to clean threads up
+    }
+  );
+
+  // Start event processing thread
+  std::thread(InputEventProcessingThread, env).detach();
+  {
+    std::unique_lock<std::mutex> lock(inputEventHookMutex);
+    inputEventHookCondition.wait(lock, [] { return inputEventRunning.load(); });
+  }
+  return Napi::Boolean::New(env, true);
+}
+
+// Function to stop monitoring input events
+Napi::Value StopInputEventListener(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  CleanAll();
+
+  return Napi::Boolean::New(env, true);
+}
+
+// Function to batch the input events sent to the input event listener
+Napi::Value SetInputEventBatching(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected an options object").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  Napi::Value interval = options.Get("interval");
+  Napi::Value size = options.Get("size");
+  Napi::Value coalesceMotion = options.Get("coalesceMotion");
+  if (
+    (!interval.IsUndefined() && (!interval.IsNumber() || !(interval.As<Napi::Number>().DoubleValue() >= 0) || interval.As<Napi::Number>().DoubleValue() > 60000))
+    || (!size.IsUndefined() && (!size.IsNumber() || !(size.As<Napi::Number>().DoubleValue() >= 0) || size.As<Napi::Number>().DoubleValue() > 1000000))
+  ) {
+    Napi::RangeError::New(env, "Expected an interval between 0 and 60000 ms and a size between 0 and 1000000 events").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  inputEventBatchInterval = interval.IsUndefined() ? 0 : interval.As<Napi::Number>().Uint32Value();
+  inputEventBatchSize = size.IsUndefined() ? 0 : size.As<Napi::Number>().Uint32Value();
+  inputEventMotionCoalescing = coalesceMotion.IsBoolean() && coalesceMotion.As<Napi::Boolean>().Value();
+
+  return env.Undefined();
+}
+
+// Function to restrict the input events sent to the input event listener
+Napi::Value SetInputEventFilter(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected a filter object").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  auto filter = std::make_shared<InputEventFilter>();
+  auto readFlag = [&options](const char* name, bool& flag) {
+    Napi::Value value = options.Get(name);
+    if (value.IsBoolean()) {
+      flag = value.As<Napi::Boolean>().Value();
+    }
+  };
+  readFlag("keyboard", filter->isKeyboardEnabled);
+  readFlag("mouse", filter->isMouseEnabled);
+  readFlag("motion", filter->isMotionEnabled);
+  readFlag("injected", filter->isInjectedEnabled);
+  readFlag("physical", filter->isPhysicalEnabled);
+  auto readInputs = [&options, &env](const char* name, std::set<int32_t>& inputs) {
+    Napi::Value value = options.Get(name);
+    if (value.IsUndefined()) {
+      return true;
+    }
+    if (!value.IsArray()) {
+      Napi::TypeError::New(env, std::string("Expected ") + name + " to be an array of numbers").ThrowAsJavaScriptException();
+      return false;
+    }
+    Napi::Array array = value.As<Napi::Array>();
+    for (uint32_t i = 0; i < array.Length(); i++) {
+      Napi::Value input = array.Get(i);
+      if (!input.IsNumber()) {
+        Napi::TypeError::New(env, std::string("Expected ") + name + " to be an array of numbers").ThrowAsJavaScriptException();
+        return false;
+      }
+      inputs.insert(input.As<Napi::Number>().Int32Value());
+    }
+    return true;
+  };
+  if (!readInputs("keys", filter->keys) || !readInputs("mouseInputs", filter->mouseInputs)) {
+    return env.Null();
+  }
+  // An empty set would accept everything: subscribing to no input at all
+  // disables the type instead
+  if (options.Get("keys").IsArray() && filter->keys.empty()) {
+    filter->isKeyboardEnabled = false;
+  }
+  if (options.Get("mouseInputs").IsArray() && filter->mouseInputs.empty()) {
+    filter->isMouseEnabled = false;
+  }
+
+  std::atomic_store(&inputEventFilter, std::shared_ptr<const InputEventFilter>(filter));
+
+  return env.Undefined();
+}
+
+// Function to register a hotkey, matched natively on the input listener thread
+Napi::Value RegisterHotkeyWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 3 || !info[0].IsArray() || !info[1].IsObject() || !info[2].IsFunction()) {
+    Napi::TypeError::New(env, "Arguments must be: (sequence, options, callback)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Sequence of chords, chords of keys, keys of alternative key codes
+  HotkeyMatcher::Hotkey hotkey;
+  Napi::Array sequence = info[0].As<Napi::Array>();
+  for (uint32_t chordIndex = 0; chordIndex < sequence.Length(); chordIndex++) {
+    Napi::Value chordValue = sequence.Get(chordIndex);
+    if (!chordValue.IsArray() || chordValue.As<Napi::Array>().Length() == 0) {
+      Napi::TypeError::New(env, "Expected each chord to be a non-empty array of keys").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    Napi::Array chordArray = chordValue.As<Napi::Array>();
+    HotkeyMatcher::Chord chord;
+    for (uint32_t keyIndex = 0; keyIndex < chordArray.Length(); keyIndex++) {
+      Napi::Value keyValue = chordArray.Get(keyIndex);
+      if (!keyValue.IsArray() || keyValue.As<Napi::Array>().Length() == 0) {
+        Napi::TypeError::New(env, "Expected each key to be a non-empty array of key codes").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      Napi::Array keyArray = keyValue.As<Napi::Array>();
+      std::vector<int> keyCodes;
+      for (uint32_t codeIndex = 0; codeIndex < keyArray.Length(); codeIndex++) {
+        Napi::Value keyCode = keyArray.Get(codeIndex);
+        if (!keyCode.IsNumber()) {
+          Napi::TypeError::New(env, "Expected each key to be a non-empty array of key codes").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        keyCodes.push_back(keyCode.As<Napi::Number>().Int32Value());
+      }
+      chord.push_back(std::move(keyCodes));
+    }
+    hotkey.sequence.push_back(std::move(chord));
+  }
+  if (hotkey.sequence.empty()) {
+    Napi::TypeError::New(env, "Expected a non-empty sequence of chords").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object options = info[1].As<Napi::Object>();
+  double timeout = options.Get("timeout").IsNumber() ? options.Get("timeout").As<Napi::Number>().DoubleValue() : 300;
+  if (!(timeout >= 0 && timeout <= 60000)) {
+    Napi::RangeError::New(env, "Timeout must be between 0 and 60000 ms").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  hotkey.timeout = static_cast<uint64_t>(timeout);
+  hotkey.isInjectedIgnored = options.Get("ignoreInjected").IsBoolean() && options.Get("ignoreInjected").As<Napi::Boolean>().Value();
+
+  Napi::ThreadSafeFunction onMatch = Napi::ThreadSafeFunction::New(
+    env,
+    info[2].As<Napi::Function>(),
+    "hotkey",
+    0,
+    1
+  );
+  hotkey.onMatch = [onMatch](uint64_t timestamp) {
+    onMatch.NonBlockingCall([timestamp](const Napi::Env& env, const Napi::Function& jsCallback) {
+      if (!jsCallback.IsEmpty()) {
+        jsCallback.Call({ Napi::Number::New(env, static_cast<double>(timestamp)) });
+      }
+    });
+  };
+
+  int hotkeyId;
+  {
+    std::lock_guard<std::mutex> lock(hotkeysMutex);
+    hotkeyId = nextHotkeyId++;
+    hotkeyMatcher.add(hotkeyId, std::move(hotkey));
+    hotkeyThreadSafeJsFunctions.emplace(hotkeyId, onMatch);
+  }
+  return Napi::Number::New(env, hotkeyId);
+}
+
+// Function to unregister a hotkey
+Napi::Value UnregisterHotkeyWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a hotkey ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int hotkeyId = info[0].As<Napi::Number>().Int32Value();
+
+  Napi::ThreadSafeFunction onMatch;
+  {
+    // Once removed, the input listener thread no longer calls it back
+    std::lock_guard<std::mutex> lock(hotkeysMutex);
+    auto it = hotkeyThreadSafeJsFunctions.find(hotkeyId);
+    if (it == hotkeyThreadSafeJsFunctions.end()) {
+      return env.Undefined();
+    }
+    onMatch = it->second;
+    hotkeyThreadSafeJsFunctions.erase(it);
+    hotkeyMatcher.remove(hotkeyId);
+  }
+  onMatch.Release();
+  return env.Undefined();
+}
+
+// Function to start writing input events into a ring in shared memory
+Napi::Value StartInputEventRingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+    Napi::TypeError::New(env, "Arguments must be: (options, waiting callback)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  double requestedCapacity = options.Get("capacity").IsNumber() ? options.Get("capacity").As<Napi::Number>().DoubleValue() : 4096;
+  if (!(requestedCapacity >= 2 && requestedCapacity <= (1 << 24))) {
+    Napi::RangeError::New(env, "Capacity must be between 2 and 16777216 events").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  // Round the capacity up to a power of 2
+  uint32_t capacity = 2;
+  while (capacity < requestedCapacity) {
+    capacity <<= 1;
+  }
+
+  // Events are written straight into a SharedArrayBuffer, kept alive by a reference
+  size_t memorySize = InputEventRing::requiredMemorySize(capacity);
+  Napi::Object sharedBuffer = env.Global().Get("SharedArrayBuffer").As<Napi::Function>().New({ Napi::Number::New(env, static_cast<double>(memorySize)) });
+  Napi::Uint8Array memory = env.Global().Get("Uint8Array").As<Napi::Function>().New({ sharedBuffer }).As<Napi::Uint8Array>();
+
+  // Called when the consumer waits for events, so JS can wake it up with Atomics.notify
+  Napi::ThreadSafeFunction onWaiting = Napi::ThreadSafeFunction::New(
+    env,
+    info[1].As<Napi::Function>(),
+    "inputEventRing",
+    1, // pending notifications are coalesced
+    1
+  );
+  auto ring = std::make_shared<InputEventRing>(
+    memory.Data(),
+    capacity,
+    [onWaiting]() {
+      onWaiting.NonBlockingCall();
+    }
+  );
+
+  int ringId;
+  {
+    std::lock_guard<std::mutex> lock(inputEventRingsMutex);
+    ringId = nextInputEventRingId++;
+    inputEventRings.emplace(ringId, InputEventRingHandle{ ring, onWaiting, Napi::Persistent(memory) });
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("id", Napi::Number::New(env, ringId));
+  result.Set("buffer", sharedBuffer);
+  return result;
+}
+
+// Function to stop writing input events into a ring
+Napi::Value StopInputEventRingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a ring ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int ringId = info[0].As<Napi::Number>().Int32Value();
+
+  InputEventRingHandle handle;
+  {
+    // Once removed, the input listener thread no longer writes to the ring
+    std::lock_guard<std::mutex> lock(inputEventRingsMutex);
+    auto it = inputEventRings.find(ringId);
+    if (it == inputEventRings.end()) {
+      return env.Undefined();
+    }
+    handle = std::move(it->second);
+    inputEventRings.erase(it);
+  }
+  handle.ring->stop();
+  handle.onWaiting.Release();
+  handle.memory.Reset();
+  return env.Undefined();
+}
+
+// Function to start recording input events natively into an input recording file
+Napi::Value StartInputRecordingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected an options object as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  if (!options.Get("filepath").IsString()) {
+    Napi::TypeError::New(env, "Options must contain: filepath").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input to C++ input
+  std::u16string u16Filepath = options.Get("filepath").As<Napi::String>().Utf16Value();
+  std::wstring filepath = std::wstring(u16Filepath.begin(), u16Filepath.end());
+  bool isInjectedIgnored = options.Get("ignoreInjected").IsBoolean() && options.Get("ignoreInjected").As<Napi::Boolean>().Value();
+  int compressionLevel = options.Get("compressionLevel").IsNumber() ? options.Get("compressionLevel").As<Napi::Number>().Int32Value() : 3;
+  double blockSize = options.Get("blockSize").IsNumber() ? options.Get("blockSize").As<Napi::Number>().DoubleValue() : 4096;
+  if (!(blockSize >= 1 && blockSize <= INPUT_RECORDING_MAX_BLOCK_SIZE)) {
+    Napi::RangeError::New(env, "Block size must be between 1 and 1048576 events").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  // Actions as [type, input, state] triplets, state being -1 for any state
+  std::vector<InputRecorderAction> actions;
+  if (options.Get("actions").IsArray()) {
+    Napi::Array jsActions = options.Get("actions").As<Napi::Array>();
+    for (unsigned int i = 0; i < jsActions.Length(); i++) {
+      Napi::Value jsRawAction = jsActions[i];
+      if (!jsRawAction.IsArray()) {
+        continue;
+      }
+      Napi::Array jsAction = jsRawAction.As<Napi::Array>();
+      Napi::Value jsType = jsAction[static_cast<unsigned int>(0)];
+      Napi::Value jsInput = jsAction[1];
+      Napi::Value jsState = jsAction[2];
+      if (!jsType.IsNumber() || !jsInput.IsNumber()) {
+        continue;
+      }
+      actions.push_back({
+        jsType.As<Napi::Number>().Int32Value(),
+        jsInput.As<Napi::Number>().Int32Value(),
+        jsState.IsNumber() ? jsState.As<Napi::Number>().Int32Value() : -1
+      });
+    }
+  }
+
+  try {
+    auto recorder = std::make_shared<InputRecorder>(filepath, std::move(actions), isInjectedIgnored, compressionLevel, static_cast<uint32_t>(blockSize));
+    int recorderId;
+    {
+      std::lock_guard<std::mutex> lock(inputRecordersMutex);
+      recorderId = nextInputRecorderId++;
+      inputRecorders.emplace(recorderId, recorder);
+    }
+    return Napi::Number::New(env, recorderId);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Function to pause or resume a native input recording
+Napi::Value SetInputRecordingPausedWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsBoolean()) {
+    Napi::TypeError::New(env, "Arguments must be: (recorder ID, paused)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int recorderId = info[0].As<Napi::Number>().Int32Value();
+  bool isPaused = info[1].As<Napi::Boolean>().Value();
+
+  std::lock_guard<std::mutex> lock(inputRecordersMutex);
+  auto it = inputRecorders.find(recorderId);
+  if (it != inputRecorders.end()) {
+    it->second->setPaused(isPaused);
+  }
+  return env.Undefined();
+}
+
+// Function to stop a native input recording, resolving with its statistics
+Napi::Value StopInputRecordingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a recorder ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int recorderId = info[0].As<Napi::Number>().Int32Value();
+
+  std::shared_ptr<InputRecorder> recorder;
+  {
+    // Once removed, the input listener thread no longer records into it
+    std::lock_guard<std::mutex> lock(inputRecordersMutex);
+    auto it = inputRecorders.find(recorderId);
+    if (it == inputRecorders.end()) {
+      Napi::Error::New(env, "Input recorder not found: " + std::to_string(recorderId)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    recorder = it->second;
+    inputRecorders.erase(it);
+  }
+
+  // Writing the last blocks may take a while: do it off the main thread
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<InputRecordingStats>(
+    env,
+    deferred,
+    [recorder]() -> InputRecordingStats {
+      return recorder->stop();
+    },
+    [](Napi::Env env, const InputRecordingStats& stats) -> Napi::Value {
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("events", Napi::Number::New(env, static_cast<double>(stats.eventCount)));
+      result.Set("droppedEvents", Napi::Number::New(env, static_cast<double>(stats.droppedEventCount)));
+      result.Set("blocks", Napi::Number::New(env, static_cast<double>(stats.blockCount)));
+      result.Set("duration", Napi::Number::New(env, static_cast<double>(stats.durationMs)));
+      return result;
+    }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
+}
+
+// Function to decode an input recording file into batched input event records
+// (see InputEventBatch)
+Napi::Value ReadInputRecordingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a filepath as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::u16string u16Filepath = info[0].As<Napi::String>().Utf16Value();
+  std::wstring filepath = std::wstring(u16Filepath.begin(), u16Filepath.end());
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<std::vector<double>>(
+    env,
+    deferred,
+    [filepath]() -> std::vector<double> {
+      InputRecordingReader reader(filepath);
+      uint64_t eventCount = 0;
+      for (const InputRecordingIndexEntry& entry : reader.index()) {
+        eventCount += entry.eventCount;
+      }
+      std::vector<double> records;
+      records.reserve(eventCount * INPUT_EVENT_RECORD_SIZE);
+      std::vector<RawInputEvent> events;
+      for (size_t blockIndex = 0; blockIndex < reader.index().size(); blockIndex++) {
+        reader.readBlock(blockIndex, events);
+        for (const RawInputEvent& event : events) {
+          EncodedInputEvent encoded = EncodeInputEvent(event);
+          records.insert(records.end(), {
+            static_cast<double>(encoded.type),
+            static_cast<double>(encoded.input),
+            static_cast<double>(encoded.state),
+            static_cast<double>(event.x),
+            static_cast<double>(event.y),
+            static_cast<double>(event.timestamp),
+            static_cast<double>(encoded.flags)
+          });
+        }
+      }
+      return records;
+    },
+    [](Napi::Env env, const std::vector<double>& records) -> Napi::Value {
+      Napi::Float64Array array = Napi::Float64Array::New(env, records.size());
+      std::copy(records.begin(), records.end(), array.Data());
+      return array;
+    }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
+}
+
+// Function to replay recorded input events natively, from an input recording
+// file or from batched input event records (see InputEventBatch). Returns the
+// replayer ID and a promise resolving with the replay statistics once it ends.
+Napi::Value StartInputReplayWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  bool isRecordArray = info.Length() > 0 && info[0].IsTypedArray() && info[0].As<Napi::TypedArray>().TypedArrayType() == napi_float64_array;
+  if (info.Length() < 1 || !(info[0].IsString() || isRecordArray)) {
+    Napi::TypeError::New(env, "Expected a filepath or a Float64Array of input event records as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  double speed = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().DoubleValue() : 1;
+  if (!(speed > 0 && std::isfinite(speed))) {
+    Napi::RangeError::New(env, "Speed must be a positive number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Records of type | input | state | x | y | timestamp | flags
+  std::vector<RawInputEvent> events;
+  if (isRecordArray) {
+    Napi::Float64Array records = info[0].As<Napi::Float64Array>();
+    if (records.ElementLength() % INPUT_EVENT_RECORD_SIZE != 0) {
+      Napi::TypeError::New(env, "Input event records length must be a multiple of " + std::to_string(INPUT_EVENT_RECORD_SIZE)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    events.reserve(records.ElementLength() / INPUT_EVENT_RECORD_SIZE);
+    for (size_t offset = 0; offset < records.ElementLength(); offset += INPUT_EVENT_RECORD_SIZE) {
+      const double* record = records.Data() + offset;
+      bool isValid = (record[0] == 0 || record[0] == 1) && record[2] >= 0 && record[2] <= 2 && record[5] >= 0;
+      if (!isValid) {
+        continue;
+      }
+      const int32_t flags = static_cast<int32_t>(record[6]);
+      events.push_back({
+        static_cast<InputEventType>(static_cast<int32_t>(record[0])),
+        static_cast<int>(record[1]),
+        static_cast<InputEventState>(static_cast<int32_t>(record[2])),
+        static_cast<int>(record[3]),
+        static_cast<int>(record[4]),
+        static_cast<uint64_t>(record[5]),
+        (flags & 1) != 0,
+        (flags & 2) != 0
+      });
+    }
+  }
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  Napi::ThreadSafeFunction settle = Napi::ThreadSafeFunction::New(
+    env,
+    Napi::Function::New(env, [](const Napi::CallbackInfo&) { }),
+    "inputReplay",
+    0,
+    1
+  );
+  int replayerId;
+  {
+    std::lock_guard<std::mutex> lock(inputReplayersMutex);
+    replayerId = nextInputReplayerId++;
+  }
+  // Settles on the JS thread, which is busy in this function until the
+  // replayer is registered
+  InputReplayer::Callback onEnd = [settle, deferred, replayerId](const InputReplayStats& stats, std::exception_ptr error) {
+    settle.BlockingCall([deferred, replayerId, stats, error](const Napi::Env& env, const Napi::Function&) {
+      std::shared_ptr<InputReplayer> replayer;
+      {
+        std::lock_guard<std::mutex> lock(inputReplayersMutex);
+        auto it = inputReplayers.find(replayerId);
+        if (it != inputReplayers.end()) {
+          replayer = std::move(it->second);
+          inputReplayers.erase(it);
+        }
+      }
+      // Join the ended replay thread
+      replayer.reset();
+      if (error) {
+        try {
+          std::rethrow_exception(error);
+        }
+        catch (const std::exception& e) {
+          deferred.Reject(Napi::Error::New(env, e.what()).Value());
+        }
+        return;
+      }
+      Napi::Object lateness = Napi::Object::New(env);
+      lateness.Set("mean", Napi::Number::New(env, stats.meanLatenessMs));
+      lateness.Set("p50", Napi::Number::New(env, stats.p50LatenessMs));
+      lateness.Set("p95", Napi::Number::New(env, stats.p95LatenessMs));
+      lateness.Set("p99", Napi::Number::New(env, stats.p99LatenessMs));
+      lateness.Set("max", Napi::Number::New(env, stats.maxLatenessMs));
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("events", Napi::Number::New(env, static_cast<double>(stats.eventCount)));
+      result.Set("duration", Napi::Number::New(env, static_cast<double>(stats.durationMs)));
+      result.Set("lateness", lateness);
+      deferred.Resolve(result);
+    });
+    settle.Release();
+  };
+
+  std::u16string u16Filepath = info[0].IsString() ? info[0].As<Napi::String>().Utf16Value() : std::u16string();
+  try {
+    std::shared_ptr<InputReplayer> replayer = isRecordArray
+      ? std::make_shared<InputReplayer>(std::move(events), speed, onEnd)
+      : std::make_shared<InputReplayer>(std::filesystem::path(std::wstring(u16Filepath.begin(), u16Filepath.end())), speed, onEnd);
+    std::lock_guard<std::mutex> lock(inputReplayersMutex);
+    inputReplayers.emplace(replayerId, replayer);
+  }
+  catch (const std::exception& e) {
+    settle.Release();
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("id", Napi::Number::New(env, replayerId));
+  result.Set("done", deferred.Promise());
+  return result;
+}
+
+// Find a running input replayer. Ended replayers are no longer found.
+std::shared_ptr<InputReplayer> FindInputReplayer(int replayerId) {
+  std::lock_guard<std::mutex> lock(inputReplayersMutex);
+  auto it = inputReplayers.find(replayerId);
+  return it != inputReplayers.end() ? it->second : nullptr;
+}
+
+// Function to pause or resume a native input replay
+Napi::Value SetInputReplayPausedWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsBoolean()) {
+    Napi::TypeError::New(env, "Arguments must be: (replayer ID, paused)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::shared_ptr<InputReplayer> replayer = FindInputReplayer(info[0].As<Napi::Number>().Int32Value());
+  if (replayer) {
+    replayer->setPaused(info[1].As<Napi::Boolean>().Value());
+  }
+  return env.Undefined();
+}
+
+// Function to move a native input replay to the given time since its first
+// event, in milliseconds
+Napi::Value SeekInputReplayWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "Arguments must be: (replayer ID, position)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  double position = info[1].As<Napi::Number>().DoubleValue();
+  if (!(position >= 0 && std::isfinite(position))) {
+    Napi::RangeError::New(env, "Position must be a positive number of milliseconds").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::shared_ptr<InputReplayer> replayer = FindInputReplayer(info[0].As<Napi::Number>().Int32Value());
+  if (replayer) {
+    replayer->seek(static_cast<uint64_t>(position));
+  }
+  return env.Undefined();
+}
+
+// Function to stop a native input replay. Its promise resolves with the
+// statistics of the events sent so far.
+Napi::Value StopInputReplayWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a replayer ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::shared_ptr<InputReplayer> replayer = FindInputReplayer(info[0].As<Napi::Number>().Int32Value());
+  if (replayer) {
+    replayer->stop();
+  }
+  return env.Undefined();
+}
+
+// Function to start or stop tracking the input state. Windows already keeps
+// the key states and the cursor position in the process: nothing needs to be
+// tracked, thus the input listener does not need to run.
+Napi::Value SetInputStateTrackingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsBoolean()) {
+    Napi::TypeError::New(env, "Expected a boolean as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Boolean::New(env, false);
+}
+
+Napi::Value IsKeyPressedWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a key code as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Boolean::New(env, (GetAsyncKeyState(info[0].As<Napi::Number>().Int32Value()) & 0x8000) != 0);
+}
+
+// Function to know whether a mouse button is held. GetAsyncKeyState reports
+// physical buttons: left and right are swapped back for left-handed users.
+bool IsMouseButtonPressed(MouseInputCode input) {
+  const bool isSwapped = GetSystemMetrics(SM_SWAPBUTTON) != 0;
+  int virtualKey = 0;
+  switch (input) {
+    case MouseInputCode::Left: virtualKey = isSwapped ? VK_RBUTTON : VK_LBUTTON; break;
+    case MouseInputCode::Middle: virtualKey = VK_MBUTTON; break;
+    case MouseInputCode::Right: virtualKey = isSwapped ? VK_LBUTTON : VK_RBUTTON; break;
+    case MouseInputCode::ExtraButton1: virtualKey = VK_XBUTTON1; break;
+    case MouseInputCode::ExtraButton2: virtualKey = VK_XBUTTON2; break;
+    default: return false;
+  }
+  return (GetAsyncKeyState(virtualKey) & 0x8000) != 0;
+}
+
+Napi::Value IsMouseButtonPressedWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a mouse button as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::Boolean::New(env, IsMouseButtonPressed(static_cast<MouseInputCode>(info[0].As<Napi::Number>().Int32Value())));
+}
+
+// Function to get both cursor coordinates at once
+Napi::Value GetCursorPositionWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  POINT cursorPosition;
+  if (!GetCursorPos(&cursorPosition)) {
+    Napi::Error::New(env, "Failed to get cursor position").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("x", Napi::Number::New(env, cursorPosition.x));
+  result.Set("y", Napi::Number::New(env, cursorPosition.y));
+  return result;
+}
+
+// Publish the suppressed inputs to the input listener. Must be called with
+// suppressedKeysMutex locked.
+void PublishInputSuppressionTable() {
+  std::atomic_store(&inputSuppressionTable, std::shared_ptr<const InputSuppressionTable>(std::make_shared<InputSuppressionTable>(suppressedMouseKeys, suppressedKeyboardKeys)));
+}
+
+void SuppressInputEvents(int type, std::map<int, std::set<int>> inputStateMap) {
+  std::lock_guard<std::mutex> lock(suppressedKeysMutex);
+  if (type == 0) {
+    // Mouse
+    for (auto& [input, states] : inputStateMap) {
+      if (suppressedMouseKeys.find(input) == suppressedMouseKeys.end()) {
+        suppressedMouseKeys[input] = std::set<int>();
+      }
+      for (int state : states) {
+        suppressedMouseKeys[input].insert(state);
+      }
+    }
+  }
+  else {
+    // Keyboard
+    for (auto& [input, states] : inputStateMap) {
+      if (suppressedKeyboardKeys.find(input) == suppressedKeyboardKeys.end()) {
+        suppressedKeyboardKeys[input] = std::set<int>();
+      }
+      for (int state : states) {
+        suppressedKeyboardKeys[input].insert(state);
+      }
+    }
+  }
+  PublishInputSuppressionTable();
+}
+
+// Function to suppress input events of given type, input and states
+Napi::Value SuppressInputEventsWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsArray() || info[1].As<Napi::Array>().Length() < 1) {
+    Napi::TypeError::New(env, "Expected two arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input state map to C++ input state map
+  std::map<int, std::set<int>> inputStateMap;
+  unsigned int type = info[0].As<Napi::Number>().Int32Value();
+  Napi::Array jsInputStateMap = info[1].As<Napi::Array>();
+  for (unsigned int i = 0; i < jsInputStateMap.Length(); i++) {
+    if (!jsInputStateMap.Has(i)) {
+      continue;
+    }
+    Napi::Value jsRawInputStates = jsInputStateMap[i];
+    if (!jsRawInputStates.IsArray()) {
+      continue;
+    }
+    Napi::Array jsInputStates = jsRawInputStates.As<Napi::Array>();
+    Napi::Value jsRawInput = jsInputStates[static_cast<unsigned int>(0)];
+    if (!jsRawInput.IsNumber()) {
+      continue;
+    }
+    Napi::Number jsInput = jsRawInput.As<Napi::Number>();
+    int input = jsInput.Int32Value();
+    if (inputStateMap.find(input) == inputStateMap.end()) {
+      inputStateMap[input] = std::set<int>();
+    }
+    Napi::Value jsRawStates = jsInputStates[1];
+    if (!jsRawStates.IsArray()) {
+      continue;
+    }
+    Napi::Array jsStates = jsRawStates.As<Napi::Array>();
+    for (unsigned int j = 0; j < jsStates.Length(); j++) {
+      Napi::Value jsRawState = jsStates[j];
+      if (!jsRawState.IsNumber()) {
+        continue;
+      }
+      Napi::Number jsState = jsRawState.As<Napi::Number>();
+      int state = jsState.Int32Value();
+      inputStateMap[input].insert(state);
+    }
+  }
+  // Register inputs to be suppressed
+  SuppressInputEvents(type, inputStateMap);
+  // Return undefined
+  return env.Undefined();
+}
+
+void UnsuppressInputEvents(int type, std::map<int, std::set<int>> inputStateMap) {
+  std::lock_guard<std::mutex> lock(suppressedKeysMutex);
+  if (type == 0) {
+    // Mouse
+    for (auto& [input, states] : inputStateMap) {
+      if (suppressedMouseKeys.find(input) == suppressedMouseKeys.end()) {
+        continue;
+      }
+      for (int state : states) {
+        suppressedMouseKeys[input].erase(state);
+      }
+      if (suppressedMouseKeys[input].empty()) {
+        suppressedMouseKeys.erase(input);
+      }
+    }
+  }
+  else {
+    // Keyboard
+    for (auto& [input, states] : inputStateMap) {
+      if (suppressedKeyboardKeys.find(input) == suppressedKeyboardKeys.end()) {
+        continue;
+      }
+      for (int state : states) {
+        suppressedKeyboardKeys[input].erase(state);
+      }
+      if (suppressedKeyboardKeys[input].empty()) {
+        suppressedKeyboardKeys.erase(input);
+      }
+    }
+  }
+  PublishInputSuppressionTable();
+}
+
+// Function to unsuppress input events of given type, input and states
+Napi::Value UnsuppressInputEventsWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsArray() || info[1].As<Napi::Array>().Length() < 1) {
+    Napi::TypeError::New(env, "Expected two arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input state map to C++ input state map
+  std::map<int, std::set<int>> inputStateMap;
+  unsigned int type = info[0].As<Napi::Number>().Int32Value();
+  Napi::Array jsInputStateMap = info[1].As<Napi::Array>();
+  for (unsigned int i = 0; i < jsInputStateMap.Length(); i++) {
+    if (!jsInputStateMap.Has(i)) {
+      continue;
+    }
+    Napi::Value jsRawInputStates = jsInputStateMap[i];
+    if (!jsRawInputStates.IsArray()) {
+      continue;
+    }
+    Napi::Array jsInputStates = jsRawInputStates.As<Napi::Array>();
+    Napi::Value jsRawInput = jsInputStates[static_cast<unsigned int>(0)];
+    if (!jsRawInput.IsNumber()) {
+      continue;
+    }
+    Napi::Number jsInput = jsRawInput.As<Napi::Number>();
+    int input = jsInput.Int32Value();
+    if (inputStateMap.find(input) == inputStateMap.end()) {
+      inputStateMap[input] = std::set<int>();
+    }
+    Napi::Value jsRawStates = jsInputStates[1];
+    if (!jsRawStates.IsArray()) {
+      continue;
+    }
+    Napi::Array jsStates = jsRawStates.As<Napi::Array>();
+    for (unsigned int j = 0; j < jsStates.Length(); j++) {
+      Napi::Value jsRawState = jsStates[j];
+      if (!jsRawState.IsNumber()) {
+        continue;
+      }
+      Napi::Number jsState = jsRawState.As<Napi::Number>();
+      int state = jsState.Int32Value();
+      inputStateMap[input].insert(state);
+    }
+  }
+  // Register inputs to be unsuppressed
+  UnsuppressInputEvents(type, inputStateMap);
+  // Return undefined
+  return env.Undefined();
+}
+
+// =============================================================================
+// ============================ TRAY ICON FUNCTIONS ============================
+// =============================================================================
+
+// This process' window's tray icon event callback
+LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+  switch (uMsg) {
+    case WM_COMMAND: {
+      // Handle menu item clicks
+      int menuItemId = LOWORD(wParam);
+      try {
+        std::function<void()> trayIconMenuItemCallback = trayIconMenuItemsCallbacks.at(menuItemId);
+        trayIconMenuItemCallback();
+      } catch (const std::out_of_range& e) {
+        std::cerr << "OutOfRangeError: " << e.what() << std::endl;
+      } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+      }
+      break;
+    }
+    case WM_USER + 1: {
+      if (lParam == WM_RBUTTONUP) {
+        POINT pt;
+        GetCursorPos(&pt);
+        SetForegroundWindow(hwnd);
+        TrackPopupMenu(hMenu, TPM_RIGHTBUTTON, pt.x, pt.y, 0, hwnd, NULL);
+      }
+      break;
+    }
+    case WM_USER + 2: {
+      // Change tray icon
+      nid.hIcon = reinterpret_cast<HICON>(wParam);
+      Shell_NotifyIconW(NIM_MODIFY, &nid);
+      break;
+    }
+    case WM_USER + 3: {
+      Shell_NotifyIconW(NIM_MODIFY, &nid);
+      break;
+    }
+    case WM_DESTROY: {
+      PostQuitMessage(0);
+      break;
+    }
+    default: {
+      return DefWindowProc(hwnd, uMsg, wParam, lParam);
+    }
+  }
+  return 0;
+}
+
+// Create tray icon
+HWND CreateTrayIcon(const std::wstring& name, const std::wstring& iconPath) {
+  if (trayIconRunning) {
+    return trayIconWindowHwnd;
+  }
+  std::thread nestedThread([name, iconPath]() {
+    {
+      std::lock_guard<std::mutex> lock(trayIconMutex);
+
+      HINSTANCE hInstance = GetModuleHandle(NULL);
+      WNDCLASSW wc = { 0 };
+      wc.lpfnWndProc = WindowProc;
+      wc.hInstance = hInstance;
+      wc.lpszClassName = L"TrayIconClass";
+      RegisterClassW(&wc);
+
+      HWND hwnd = CreateWindowW(L"TrayIconClass", name.c_str(), 0, 0, 0, 0, 0, NULL, NULL, hInstance, NULL);
+      trayIconWindowHwnd = hwnd;
+
+      hMenu = CreatePopupMenu();
+
+      nid.cbSize = sizeof(NOTIFYICONDATAW);
+      nid.hWnd = hwnd;
+      nid.uID = 1;
+      nid.uFlags = NIF_MESSAGE | NIF_ICON | NIF_TIP;
+      nid.uCallbackMessage = WM_USER + 1;
+      wcscpy_s(nid.szTip, _countof(nid.szTip), name.c_str());
+      nid.hIcon = static_cast<HICON>(LoadImageW(NULL, iconPath.c_str(), IMAGE_ICON, 0, 0, LR_LOADFROMFILE | LR_DEFAULTSIZE));
+
+      Shell_NotifyIconW(NIM_ADD, &nid);
+    }
+    trayIconRunning = true;
+    trayIconCondition.notify_all();
+
+    MSG msg;
+    while (GetMessage(&msg, NULL, 0, 0)) {
+      TranslateMessage(&msg);
+      DispatchMessage(&msg);
+    }
+    CleanupTrayIcon();
+  });
+  nestedThread.detach();
+
+  {
+    std::unique_lock<std::mutex> lock(trayIconMutex);
+    trayIconCondition.wait(lock, [] { return trayIconRunning.load(); });
+  }
+  return trayIconWindowHwnd;
+}
+
+Napi::Value CreateTrayIconWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected two arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::u16string u16Name = info[0].As<Napi::String>().Utf16Value();
+  std::wstring name = std::wstring(u16Name.begin(), u16Name.end());
+  std::u16string u16IconPath = info[1].As<Napi::String>().Utf16Value();
+  std::wstring iconPath = std::wstring(u16IconPath.begin(), u16IconPath.end());
+
+  // Create the tray icon
+  HWND trayIconId = CreateTrayIcon(name, iconPath);
+
+  return Napi::Number::New(env, reinterpret_cast<uintptr_t>(trayIconId));
+}
+
+Napi::Value RemoveTrayIconWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a number argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!trayIconRunning) {
+    return env.Undefined();
+  }
+
+  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
+
+  PostMessage(trayIconWindowId, WM_CLOSE, 0, 0);
+  {
+    std::unique_lock<std::mutex> lock(trayIconMutex);
+    trayIconCondition.wait(lock, [] { return !trayIconRunning.load(); });
+  }
+
+  return env.Undefined();
+}
+
+void UpdateTrayIcon(HWND hwnd, const std::wstring& newIconPath) {
+  HICON hNewIcon = static_cast<HICON>(LoadImageW(NULL, newIconPath.c_str(), IMAGE_ICON, 0, 0, LR_LOADFROMFILE | LR_DEFAULTSIZE));
+
+  if (hNewIcon) {
+    // Send message to the window to update the tray icon
+    PostMessage(hwnd, WM_USER + 2, reinterpret_cast<WPARAM>(hNewIcon), 0);
+  }
+}
+
+Napi::Value UpdateTrayIconWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected a number and string arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
+  std::u16string u16NewIconPath = info[1].As<Napi::String>().Utf16Value();
+  std::wstring newIconPath = std::wstring(u16NewIconPath.begin(), u16NewIconPath.end());
+
+  UpdateTrayIcon(trayIconWindowId, newIconPath);
+
+  return env.Undefined();
+}
+
+void UpdateTrayIconTooltip(HWND hwnd, const std::wstring& newTooltip) {
+  // update the tooltip
+  wcscpy_s(nid.szTip, _countof(nid.szTip), newTooltip.c_str());
+  // Send message to the window to update the tray icon
+  PostMessage(hwnd, WM_USER + 3, 0, 0);
+}
+
+Napi::Value UpdateTrayIconTooltipWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected a number and string arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
+  std::u16string u16NewTooltip = info[1].As<Napi::String>().Utf16Value();
+  std::wstring newTooltip = std::wstring(u16NewTooltip.begin(), u16NewTooltip.end());
+
+  UpdateTrayIconTooltip(trayIconWindowId, newTooltip);
+
+  return env.Undefined();
+}
+
+bool AddTrayIconMenuItem(const std::wstring& itemText, UINT itemId, UINT position) {
+  std::lock_guard<std::mutex> lock(trayIconMutex);
+  if (!trayIconRunning || hMenu == nullptr) {
+    return false;
+  }
+  return InsertMenuW(hMenu, position, MF_BYPOSITION | MF_STRING, itemId, itemText.c_str()) != 0;
+}
+
+Napi::Value AddTrayIconMenuItemWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 5 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsString() || !info[4].IsFunction()) {
+    Napi::TypeError::New(env, "Expected number (hwnd), number (item id), number (position), string (label) and function (onClick callback) arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
+  UINT itemId = info[1].As<Napi::Number>().Uint32Value();
+  UINT position = info[2].As<Napi::Number>().Uint32Value();
+  std::u16string u16ItemText = info[3].As<Napi::String>().Utf16Value();
+  std::wstring itemText = std::wstring(u16ItemText.begin(), u16ItemText.end());
+  Napi::Function onClick = info[4].As<Napi::Function>();
+
+  // Create JS and C++ tray icon menu item callback
+  Napi::ThreadSafeFunction trayIconMenuItemJsCallback = Napi::ThreadSafeFunction::New(
+    env, // the main NAPI environment
+    onClick, // callback function that needs to be called in thread(s)
+    "Tray Icon Callback " + std::to_string(itemId), // JS string used to provide diagnostic information
+    0, // maximum queue size (0 for unlimited)
+    1, // initial number of threads which will be making use of this function
+    [](const Napi::Env& env) { // finalizer callback, can be used to clean threads up
+    }
+  );
+  trayIconMenuItemsJsCallbacks[itemId] = trayIconMenuItemJsCallback;
+  std::function<void()> trayIconMenuItemCallback = [itemId]() {
+    try {
+      Napi::ThreadSafeFunction trayIconMenuItemJsCallback = trayIconMenuItemsJsCallbacks.at(itemId);
+      trayIconMenuItemJsCallback.BlockingCall([](const Napi::Env& env, const Napi::Function& jsCallback) {
+        if (!jsCallback.IsEmpty()) {
+          jsCallback.Call({ });
+        }
+      });
+    } catch (const std::out_of_range& e) {
+      std::cerr << "OutOfRangeError: " << e.what() << std::endl;
+      return;
+    } catch (const std::exception& e) {
+      std::cerr << "Error: " << e.what() << std::endl;
+      return;
+    }
+  };
+  trayIconMenuItemsCallbacks[itemId] = trayIconMenuItemCallback;
+
+  // Add the menu item
+  bool result = AddTrayIconMenuItem(itemText, itemId, position);
+
+  return Napi::Boolean::New(env, result);
+}
+
+bool UpdateTrayIconMenuItemLabel(UINT itemId, const std::wstring& newLabel) {
+  std::lock_guard<std::mutex> lock(trayIconMutex);
+  if (!trayIconRunning || hMenu == nullptr) {
+    return false;
+  }
+
+  // Update the label by ID
+  return ModifyMenuW(hMenu, itemId, MF_BYCOMMAND | MF_STRING, itemId, newLabel.c_str()) != 0;
+}
+
+Napi::Value UpdateTrayIconMenuItemLabelWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsString()) {
+    Napi::TypeError::New(env, "Expected number (hwnd), number (item id) and string (label) arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
+  UINT itemId = info[1].As<Napi::Number>().Uint32Value();
+  std::u16string u16NewLabel = info[2].As<Napi::String>().Utf16Value();
+  std::wstring newLabel = std::wstring(u16NewLabel.begin(), u16NewLabel.end());
+
+  // Update the menu item label
+  bool result = UpdateTrayIconMenuItemLabel(itemId, newLabel);
+
+  return Napi::Boolean::New(env, result);
+}
+
+bool UpdateTrayIconMenuItemCallback(UINT itemId, const Napi::ThreadSafeFunction& newTrayIconMenuItemJsCallback) {
+  std::lock_guard<std::mutex> lock(trayIconMutex);
+  if (!trayIconRunning || hMenu == nullptr) {
+    return false;
+  }
+  if (trayIconMenuItemsJsCallbacks.count(itemId) == 0) {
+    return false;
+  }
+
+  // Update the callback by ID
+  trayIconMenuItemsJsCallbacks[itemId].Abort();
+  trayIconMenuItemsJsCallbacks[itemId] = newTrayIconMenuItemJsCallback;
+  return true;
+}
+
+Napi::Value UpdateTrayIconMenuItemCallbackWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsFunction()) {
+    Napi::TypeError::New(env, "Expected number (hwnd), number (item id) and function (callback) arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
+  UINT itemId = info[1].As<Napi::Number>().Uint32Value();
+  Napi::Function newJsCallback = info[2].As<Napi::Function>();
+  Napi::ThreadSafeFunction newTrayIconMenuItemJsCallback = Napi::ThreadSafeFunction::New(
+    env, // the main NAPI environment
+    newJsCallback, // callback function that needs to be called in thread(s)
+    "Tray Icon Callback " + std::to_string(itemId), // JS string used to provide diagnostic information
+    0, // maximum queue size (0 for unlimited)
+    1, // initial number of threads which will be making use of this function
+    [](const Napi::Env& env) { // finalizer callback, can be used to clean threads up
+    }
+  );
+
+  // Update the menu item callback
+  bool result = UpdateTrayIconMenuItemCallback(itemId, newTrayIconMenuItemJsCallback);
+
+  return Napi::Boolean::New(env, result);
+}
+
+bool RemoveTrayIconMenuItem(UINT itemId) {
+  std::lock_guard<std::mutex> lock(trayIconMutex);
+  if (!trayIconRunning || hMenu == nullptr) {
+    return false;
+  }
+  // Attempt to remove the menu item using the item ID
+  if (RemoveMenu(hMenu, itemId, MF_BYCOMMAND) != 0) {
+    // Clean up the C++ callback
+    trayIconMenuItemsCallbacks.erase(itemId);
+    // Clean up the JS callback
+    trayIconMenuItemsJsCallbacks[itemId].Abort();
+    trayIconMenuItemsJsCallbacks.erase(itemId);
+    return true;
+  }
+  return false;
+}
+
+Napi::Value RemoveTrayIconMenuItemWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 2 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected number (hwnd) and number (item id) arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
+  UINT itemId = info[1].As<Napi::Number>().Uint32Value();
+
+  // Remove the menu item
+  bool result = RemoveTrayIconMenuItem(itemId);
+
+  return Napi::Boolean::New(env, result);
+}
+
+
+// =============================================================================
+// =============================== TIME FUNCTIONS ==============================
+// =============================================================================
+
+// Parse the (milliseconds, precise?) arguments of sleeps into an absolute
+// monotonic deadline, throwing a JavaScript exception on invalid arguments
+bool ParseSleepArguments(const Napi::CallbackInfo& info, std::chrono::steady_clock::time_point& deadline, bool& isPrecise) {
+  Napi::Env env = info.Env();
+  const auto start = std::chrono::steady_clock::now();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a number argument").ThrowAsJavaScriptException();
+    return false;
+  }
+  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsBoolean()) {
+    Napi::TypeError::New(env, "Expected precise to be a boolean").ThrowAsJavaScriptException();
+    return false;
+  }
+
+  double milliseconds = info[0].As<Napi::Number>().DoubleValue();
+  if (std::isnan(milliseconds) || milliseconds > 2147483647.0) {
+    Napi::RangeError::New(env, "Expected a duration of at most 2147483647 milliseconds").ThrowAsJavaScriptException();
+    return false;
+  }
+
+  // Negative durations do not sleep, as with setTimeout
+  deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(std::max(0.0, milliseconds)));
+  isPrecise = info.Length() > 1 && info[1].IsBoolean() && info[1].As<Napi::Boolean>().Value();
+  return true;
+}
+
+// Function to synchronously sleep for a given number of milliseconds.
+// The deadline is absolute on the monotonic clock, and precise sleeps spin
+// the end of it for sub-millisecond accuracy.
+Napi::Value SleepWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::chrono::steady_clock::time_point deadline;
+  bool isPrecise;
+  if (!ParseSleepArguments(info, deadline, isPrecise)) {
+    return env.Null();
+  }
+
+  SleepUntil(deadline, isPrecise ? PRECISE_SLEEP_SPIN_WINDOW : std::chrono::microseconds(0));
+
+  return env.Undefined();
+}
+
+// Function to sleep for a given number of milliseconds without blocking the
+// event loop. The returned promise resolves with the monotonic time at which
+// the timer fired.
+Napi::Value SleepAsyncWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::chrono::steady_clock::time_point deadline;
+  bool isPrecise;
+  if (!ParseSleepArguments(info, deadline, isPrecise)) {
+    return env.Null();
+  }
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  Napi::ThreadSafeFunction settle = Napi::ThreadSafeFunction::New(
+    env,
+    Napi::Function::New(env, [](const Napi::CallbackInfo&) { }),
+    "sleepAsync",
+    0,
+    1
+  );
+  timerService.schedule(deadline, isPrecise, [settle, deferred](bool isCancelled) {
+    const double firedAt = MonotonicNow();
+    settle.BlockingCall([deferred, isCancelled, firedAt](const Napi::Env& env, const Napi::Function&) {
+      if (isCancelled) {
+        deferred.Reject(Napi::Error::New(env, "Sleep was cancelled.").Value());
+      }
+      else {
+        deferred.Resolve(Napi::Number::New(env, firedAt));
+      }
+    });
+    settle.Release();
+  });
+  return deferred.Promise();
+}
+
+// Function to get the milliseconds elapsed on the monotonic clock
+Napi::Value GetMonotonicTimeWrapper(const Napi::CallbackInfo& info) {
+  return Napi::Number::New(info.Env(), MonotonicNow());
+}
+
+
+// =============================================================================
+// =============================== OCR FUNCTIONS ===============================
+// =============================================================================
+
+// Tesseract settings of an OCR call. A plain language keeps Tesseract defaults.
+struct OcrProfile {
+  std::string language;
+  std::optional<tesseract::PageSegMode> pageSegmentationMode;
+  tesseract::OcrEngineMode engineMode = tesseract::OEM_DEFAULT;
+  std::string whitelist;
+  std::string blacklist;
+  int dpi = 0; // 0 to let Tesseract estimate it
+  std::map<std::string, std::string> variables;
+
+  // Identity of the settings, to pool engines and cache results
+  std::string key() const {
+    std::ostringstream stream;
+    stream << language
+      << '\x1f' << (pageSegmentationMode ? static_cast<int>(*pageSegmentationMode) : -1)
+      << '\x1f' << static_cast<int>(engineMode)
+      << '\x1f' << whitelist
+      << '\x1f' << blacklist
+      << '\x1f' << dpi;
+    for (const auto& [name, value] : variables) {
+      stream << '\x1f' << name << '=' << value;
+    }
+    return stream.str();
+  }
+};
+
+// Initialize Tesseract with the trained data of the profile language (English by
+// default), then apply the profile settings
+void InitializeTesseract(tesseract::TessBaseAPI& tesseract, const OcrProfile& profile) {
+  // Get trained data assets folder
+  std::string trainedDataAbsolutePath = (GetUserDataAbsoluteDirectoryPath() / "ocr")
+    .lexically_normal()
+    .generic_string();
+  std::string language = !profile.language.empty() ? profile.language : "eng";
+
+  // Variables are given to Init so that init-only ones (e.g. load_system_dawg) apply too
+  std::vector<std::string> variableNames;
+  std::vector<std::string> variableValues;
+  auto addVariable = [&variableNames, &variableValues](const std::string& name, const std::string& value) {
+    variableNames.push_back(name);
+    variableValues.push_back(value);
+  };
+  if (!profile.whitelist.empty()) {
+    addVariable("tessedit_char_whitelist", profile.whitelist);
+  }
+  if (!profile.blacklist.empty()) {
+    addVariable("tessedit_char_blacklist", profile.blacklist);
+  }
+  if (profile.dpi > 0) {
+    addVariable("user_defined_dpi", std::to_string(profile.dpi));
+  }
+  for (const auto& [name, value] : profile.variables) {
+    addVariable(name, value);
+  }
+
+  if (tesseract.Init(trainedDataAbsolutePath.c_str(), language.c_str(), profile.engineMode, nullptr, 0, &variableNames, &variableValues, false) != 0) {
+    throw std::runtime_error("Failed to initialize Tesseract with language: " + language);
+  }
+  // Unknown variables are silently ignored by Init
+  for (const auto& [name, value] : profile.variables) {
+    std::string currentValue;
+    if (!tesseract.GetVariableAsString(name.c_str(), &currentValue)) {
+      throw std::runtime_error("Unknown Tesseract variable: " + name);
+    }
+  }
+  if (profile.pageSegmentationMode) {
+    tesseract.SetPageSegMode(*profile.pageSegmentationMode);
+  }
+}
+
+// Initialized Tesseract engines by profile, reused across OCR calls since
+// loading language data takes a while. Each engine serves one thread at a time.
+// Idle engines are capped as a whole, whatever their profile: the least
+// recently used ones are freed first, except those kept by preload().
+class OcrEnginePool {
+  public:
+    // An engine borrowed from the pool, given back on destruction
+    class Lease {
+      public:
+        Lease(OcrEnginePool* pool, std::string key, std::unique_ptr<tesseract::TessBaseAPI> engine)
+          : m_pool(pool), m_key(std::move(key)), m_engine(std::move(engine)) {}
+
+        Lease(Lease&&) = default;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        ~Lease() {
+          if (m_engine) {
+            m_pool->release(m_key, std::move(m_engine));
+          }
+        }
+
+        tesseract::TessBaseAPI& operator*() {
+          return *m_engine;
+        }
+
+      private:
+        OcrEnginePool* m_pool;
+        std::string m_key;
+        std::unique_ptr<tesseract::TessBaseAPI> m_engine;
+    };
+
+    OcrEnginePool() : m_maxIdleEngineCount(std::max(1u, std::thread::hardware_concurrency())) {}
+
+    OcrEnginePool(const OcrEnginePool&) = delete;
+    OcrEnginePool& operator=(const OcrEnginePool&) = delete;
+
+    // Borrow an idle engine of the profile, or initialize a new one
+    Lease acquire(const OcrProfile& profile) {
+      std::string key = profile.key();
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Most recently used first
+        for (auto it = m_idleEngines.begin(); it != m_idleEngines.end(); ++it) {
+          if (it->key == key) {
+            std::unique_ptr<tesseract::TessBaseAPI> engine = std::move(it->engine);
+            m_idleEngines.erase(it);
+            return Lease(this, std::move(key), std::move(engine));
+          }
+        }
+      }
+      auto engine = std::make_unique<tesseract::TessBaseAPI>();
+      InitializeTesseract(*engine, profile);
+      return Lease(this, std::move(key), std::move(engine));
+    }
+
+    // Make sure `count` engines of the profile are initialized and kept idle
+    void preload(const OcrProfile& profile, size_t count) {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t& preloadedCount = m_preloadedCounts[profile.key()];
+        preloadedCount = std::max(preloadedCount, count);
+      }
+      std::vector<Lease> leases;
+      for (size_t i = 0; i < count; i++) {
+        leases.push_back(acquire(profile));
+      }
+    }
 
-      Shell_NotifyIconW(NIM_ADD, &nid);
+    // Free the idle engines of a profile
+    void clear(const OcrProfile& profile) {
+      std::string key = profile.key();
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_idleEngines.remove_if([&key](const IdleEngine& idleEngine) { return idleEngine.key == key; });
+      m_preloadedCounts.erase(key);
     }
-    trayIconRunning = true;
-    trayIconCondition.notify_all();
 
-    MSG msg;
-    while (GetMessage(&msg, NULL, 0, 0)) {
-      TranslateMessage(&msg);
-      DispatchMessage(&msg);
+    // Free all idle engines
+    void clear() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_idleEngines.clear();
+      m_preloadedCounts.clear();
     }
-    CleanupTrayIcon();
-  });
-  nestedThread.detach();
 
+  private:
+    struct IdleEngine {
+      std::string key;
+      std::unique_ptr<tesseract::TessBaseAPI> engine;
+    };
+
+    void release(const std::string& key, std::unique_ptr<tesseract::TessBaseAPI> engine) {
+      // Drop the last image and results, keep the loaded language
+      engine->Clear();
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_idleEngines.push_front({ key, std::move(engine) });
+
+      // Count idle engines by profile, from the most recently used, so that
+      // engines past the preloaded count of their profile can be freed
+      std::map<std::string, size_t> idleCounts;
+      size_t unreservedCount = 0;
+      for (const IdleEngine& idleEngine : m_idleEngines) {
+        auto preloadedCount = m_preloadedCounts.find(idleEngine.key);
+        if (++idleCounts[idleEngine.key] > (preloadedCount != m_preloadedCounts.end() ? preloadedCount->second : 0)) {
+          unreservedCount++;
+        }
+      }
+
+      // Free the least recently used engines beyond the cap
+      for (auto it = m_idleEngines.end(); unreservedCount > m_maxIdleEngineCount && it != m_idleEngines.begin();) {
+        --it;
+        auto preloadedCount = m_preloadedCounts.find(it->key);
+        size_t& idleCount = idleCounts[it->key];
+        if (idleCount > (preloadedCount != m_preloadedCounts.end() ? preloadedCount->second : 0)) {
+          idleCount--;
+          unreservedCount--;
+          it = m_idleEngines.erase(it);
+        }
+      }
+    }
+
+    std::mutex m_mutex;
+    std::list<IdleEngine> m_idleEngines; // most recently used first
+    std::map<std::string, size_t> m_preloadedCounts; // idle engines kept by preload, by profile
+    size_t m_maxIdleEngineCount; // idle engines kept besides the preloaded ones
+};
+
+// Pooled OCR engines
+OcrEnginePool ocrEnginePool;
+
+// Named OCR profiles
+std::map<std::string, OcrProfile> ocrProfiles;
+std::mutex ocrProfilesMutex;
+
+// Resolve the language argument of an OCR call: the name of a registered
+// profile, else a plain language
+OcrProfile ResolveOcrProfile(const std::string& languageOrProfileName) {
   {
-    std::unique_lock<std::mutex> lock(trayIconMutex);
-    trayIconCondition.wait(lock, [] { return trayIconRunning.load(); });
+    std::lock_guard<std::mutex> lock(ocrProfilesMutex);
+    auto profile = ocrProfiles.find(languageOrProfileName);
+    if (profile != ocrProfiles.end()) {
+      return profile->second;
+    }
   }
-  return trayIconWindowHwnd;
+  OcrProfile profile;
+  profile.language = languageOrProfileName;
+  return profile;
 }
 
-Napi::Value CreateTrayIconWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+enum class OcrBinarization {
+  None,
+  Otsu,
+  Sauvola,
+};
 
-  // Validate arguments
-  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
-    Napi::TypeError::New(env, "Expected two arguments").ThrowAsJavaScriptException();
-    return env.Null();
+enum class OcrInversion {
+  None,
+  Always,
+  Auto, // only light text on a dark background
+};
+
+// Image transformations applied before OCR, in this order
+struct OcrPreprocessing {
+  bool isGrayscale = false;
+  OcrInversion inversion = OcrInversion::None;
+  int scale = 1;
+  OcrBinarization binarization = OcrBinarization::None;
+};
+
+// Apply the preprocessing stages to a copy of `image`, in memory, with one
+// Leptonica call per stage (no round trip through files nor extra buffers).
+PIX* PreprocessOcrImage(PIX* image, const OcrPreprocessing& preprocessing) {
+  PIX* result = pixClone(image);
+  auto replace = [&result](PIX* next) {
+    if (!next) {
+      pixDestroy(&result);
+      throw std::runtime_error("Failed to preprocess image for OCR.");
+    }
+    pixDestroy(&result);
+    result = next;
+  };
+
+  // Inversion and binarization work on grayscale images, not on the palette
+  // indices of colormapped ones
+  bool isGrayscale = preprocessing.isGrayscale
+    || preprocessing.inversion != OcrInversion::None
+    || preprocessing.binarization != OcrBinarization::None;
+  if (isGrayscale && (pixGetDepth(result) != 8 || pixGetColormap(result))) {
+    replace(pixConvertTo8(result, 0));
+  }
+
+  if (preprocessing.inversion != OcrInversion::None) {
+    bool isInverted = preprocessing.inversion == OcrInversion::Always;
+    if (preprocessing.inversion == OcrInversion::Auto) {
+      // Mostly dark images are dark themes: light text on a dark background
+      l_float32 mean = 255;
+      pixGetAverageMasked(result, nullptr, 0, 0, 4, L_MEAN_ABSVAL, &mean);
+      isInverted = mean < 128;
+    }
+    if (isInverted) {
+      replace(pixInvert(nullptr, result));
+    }
   }
 
-  std::u16string u16Name = info[0].As<Napi::String>().Utf16Value();
-  std::wstring name = std::wstring(u16Name.begin(), u16Name.end());
-  std::u16string u16IconPath = info[1].As<Napi::String>().Utf16Value();
-  std::wstring iconPath = std::wstring(u16IconPath.begin(), u16IconPath.end());
+  if (preprocessing.scale > 1) {
+    // Linear interpolation keeps glyph edges smooth for binarization
+    float factor = static_cast<float>(preprocessing.scale);
+    replace(pixGetDepth(result) == 8 && !pixGetColormap(result) ? pixScaleGrayLI(result, factor, factor) : pixScale(result, factor, factor));
+  }
 
-  // Create the tray icon
-  HWND trayIconId = CreateTrayIcon(name, iconPath);
+  if (preprocessing.binarization == OcrBinarization::Otsu) {
+    // A single tile covering the whole image gives a global Otsu threshold
+    PIX* binarized = nullptr;
+    pixOtsuAdaptiveThreshold(result, std::max(16, pixGetWidth(result)), std::max(16, pixGetHeight(result)), 0, 0, 0.1f, nullptr, &binarized);
+    replace(binarized);
+  }
+  else if (preprocessing.binarization == OcrBinarization::Sauvola) {
+    // Local thresholds cope with uneven backgrounds (gradients, highlights)
+    // (the window must fit in the image, tiny images are left as is)
+    int windowHalfSize = std::min(8 * preprocessing.scale, (std::min(pixGetWidth(result), pixGetHeight(result)) - 3) / 2);
+    if (windowHalfSize >= 2) {
+      PIX* binarized = nullptr;
+      pixSauvolaBinarizeTiled(result, windowHalfSize, 0.35f, 1, 1, nullptr, &binarized);
+      replace(binarized);
+    }
+  }
 
-  return Napi::Number::New(env, reinterpret_cast<uintptr_t>(trayIconId));
+  return result;
 }
 
-Napi::Value RemoveTrayIconWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+struct OcrTextMatch {
+  std::string text;
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+  float confidence;
+};
 
-  // Validate arguments
-  if (info.Length() < 1 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Expected a number argument").ThrowAsJavaScriptException();
-    return env.Null();
+// Recognize an image once and walk the results, from blocks down to words.
+// Boxes are divided by the preprocessing `scale` then offset by
+// (offsetX, offsetY), e.g. to get screen coordinates.
+OcrResult RecognizeStructuredText(tesseract::TessBaseAPI& tesseract, PIX* image, int offsetX = 0, int offsetY = 0, int scale = 1) {
+  tesseract.SetImage(image);
+  if (tesseract.Recognize(nullptr) != 0) {
+    throw std::runtime_error("Failed to perform OCR on image.");
   }
 
-  if (!trayIconRunning) {
-    return env.Undefined();
+  OcrResult result;
+  char* text = tesseract.GetUTF8Text();
+  if (text) {
+    result.text = text;
+    delete[] text;
   }
 
-  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
+  auto addBox = [offsetX, offsetY, scale](std::vector<int32_t>& boxes, int left, int top, int right, int bottom) {
+    boxes.insert(boxes.end(), { left / scale + offsetX, top / scale + offsetY, (right - left) / scale, (bottom - top) / scale });
+  };
+  auto trimmedText = [](char* text) {
+    std::string result = text ? text : "";
+    delete[] text;
+    while (!result.empty() && std::isspace(static_cast<unsigned char>(result.back()))) {
+      result.pop_back();
+    }
+    return result;
+  };
 
-  PostMessage(trayIconWindowId, WM_CLOSE, 0, 0);
-  {
-    std::unique_lock<std::mutex> lock(trayIconMutex);
-    trayIconCondition.wait(lock, [] { return !trayIconRunning.load(); });
+  std::unique_ptr<tesseract::ResultIterator> iterator(tesseract.GetIterator());
+  if (!iterator || iterator->Empty(tesseract::RIL_WORD)) {
+    return result;
   }
+  int left, top, right, bottom;
+  do {
+    if (iterator->IsAtBeginningOf(tesseract::RIL_BLOCK)) {
+      iterator->BoundingBox(tesseract::RIL_BLOCK, &left, &top, &right, &bottom);
+      addBox(result.blockBoxes, left, top, right, bottom);
+      result.blockConfidences.push_back(iterator->Confidence(tesseract::RIL_BLOCK));
+    }
+    if (iterator->IsAtBeginningOf(tesseract::RIL_TEXTLINE)) {
+      iterator->BoundingBox(tesseract::RIL_TEXTLINE, &left, &top, &right, &bottom);
+      addBox(result.lineBoxes, left, top, right, bottom);
+      result.lineConfidences.push_back(iterator->Confidence(tesseract::RIL_TEXTLINE));
+      result.lineTexts.push_back(trimmedText(iterator->GetUTF8Text(tesseract::RIL_TEXTLINE)));
+      result.lineBlocks.push_back(static_cast<int32_t>(result.blockConfidences.size()) - 1);
+    }
+    iterator->BoundingBox(tesseract::RIL_WORD, &left, &top, &right, &bottom);
+    addBox(result.wordBoxes, left, top, right, bottom);
+    result.wordConfidences.push_back(iterator->Confidence(tesseract::RIL_WORD));
+    result.wordTexts.push_back(trimmedText(iterator->GetUTF8Text(tesseract::RIL_WORD)));
+    result.wordLines.push_back(static_cast<int32_t>(result.lineConfidences.size()) - 1);
+  } while (iterator->Next(tesseract::RIL_WORD));
 
-  return env.Undefined();
+  return result;
 }
 
-void UpdateTrayIcon(HWND hwnd, const std::wstring& newIconPath) {
-  HICON hNewIcon = static_cast<HICON>(LoadImageW(NULL, newIconPath.c_str(), IMAGE_ICON, 0, 0, LR_LOADFROMFILE | LR_DEFAULTSIZE));
+struct OcrTile {
+  int x;
+  int y;
+  int width;
+  int height;
+};
 
-  if (hNewIcon) {
-    // Send message to the window to update the tray icon
-    PostMessage(hwnd, WM_USER + 2, reinterpret_cast<WPARAM>(hNewIcon), 0);
-  }
+// Cheap page segmentation: local contrast (morphological gradient) marks
+// glyph edges whatever the text and background colors, then a closing merges
+// glyphs into words, lines and paragraphs, whose bounding boxes are the tiles.
+// `scale` is the preprocessing upscale factor, to size the structuring elements.
+std::vector<OcrTile> FindOcrTextTiles(PIX* image, int scale) {
+  std::vector<OcrTile> tiles;
+  int width = pixGetWidth(image);
+  int height = pixGetHeight(image);
+
+  PIX* gray = pixConvertTo8(image, 0);
+  PIX* gradient = gray ? pixMorphGradient(gray, 3, 3, 0) : nullptr;
+  PIX* edges = gradient ? pixThresholdToBinary(gradient, 48) : nullptr;
+  if (edges) {
+    pixInvert(edges, edges); // strong edges as foreground
+  }
+  PIX* blocks = edges ? pixCloseSafeBrick(nullptr, edges, 24 * scale + 1, 8 * scale + 1) : nullptr;
+  BOXA* boxes = blocks ? pixConnCompBB(blocks, 8) : nullptr;
+  BOXA* mergedBoxes = boxes ? boxaCombineOverlaps(boxes, nullptr) : nullptr;
+  pixDestroy(&gray);
+  pixDestroy(&gradient);
+  pixDestroy(&edges);
+  pixDestroy(&blocks);
+  boxaDestroy(&boxes);
+  if (!mergedBoxes) {
+    throw std::runtime_error("Failed to segment image for OCR.");
+  }
+
+  int margin = 4 * scale;
+  for (int i = 0; i < boxaGetCount(mergedBoxes); i++) {
+    l_int32 x, y, boxWidth, boxHeight;
+    boxaGetBoxGeometry(mergedBoxes, i, &x, &y, &boxWidth, &boxHeight);
+    // Too small to hold readable text
+    if (boxWidth < 6 * scale || boxHeight < 6 * scale) continue;
+    // Aligned on the scale so that tile offsets map back to whole pixels
+    int left = std::max(0, x - margin) / scale * scale;
+    int top = std::max(0, y - margin) / scale * scale;
+    int right = std::min(width, x + boxWidth + margin);
+    int bottom = std::min(height, y + boxHeight + margin);
+    tiles.push_back({ left, top, right - left, bottom - top });
+  }
+  boxaDestroy(&mergedBoxes);
+
+  // Reading order: top to bottom, then left to right
+  std::sort(tiles.begin(), tiles.end(), [](const OcrTile& a, const OcrTile& b) {
+    return a.y != b.y ? a.y < b.y : a.x < b.x;
+  });
+  return tiles;
 }
 
-Napi::Value UpdateTrayIconWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-
-  // Validate arguments
-  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsString()) {
-    Napi::TypeError::New(env, "Expected a number and string arguments").ThrowAsJavaScriptException();
-    return env.Null();
+// Append `other` to `result`, shifting its line and block indices
+void AppendOcrResult(OcrResult& result, OcrResult&& other) {
+  if (!other.text.empty()) {
+    result.text += other.text;
+    if (result.text.back() != '\n') result.text += '\n';
   }
+  int32_t lineOffset = static_cast<int32_t>(result.lineTexts.size());
+  int32_t blockOffset = static_cast<int32_t>(result.blockConfidences.size());
+  auto append = [](auto& destination, auto& source) {
+    destination.insert(destination.end(), std::make_move_iterator(source.begin()), std::make_move_iterator(source.end()));
+  };
+  for (int32_t& line : other.wordLines) line += lineOffset;
+  for (int32_t& block : other.lineBlocks) block += blockOffset;
+  append(result.wordTexts, other.wordTexts);
+  append(result.wordBoxes, other.wordBoxes);
+  append(result.wordConfidences, other.wordConfidences);
+  append(result.wordLines, other.wordLines);
+  append(result.lineTexts, other.lineTexts);
+  append(result.lineBoxes, other.lineBoxes);
+  append(result.lineConfidences, other.lineConfidences);
+  append(result.lineBlocks, other.lineBlocks);
+  append(result.blockBoxes, other.blockBoxes);
+  append(result.blockConfidences, other.blockConfidences);
+}
+
+// Split the image into text tiles and recognize them in parallel, each thread
+// owning its Tesseract instance. Results are merged in reading order.
+// A thread count of 0 uses all cores.
+OcrResult RecognizeStructuredTextInParallel(
+  PIX* image,
+  const OcrProfile& profile,
+  unsigned int threadCount,
+  int offsetX = 0,
+  int offsetY = 0,
+  int scale = 1
+) {
+  std::vector<OcrTile> tiles = FindOcrTextTiles(image, scale);
+  std::vector<OcrResult> tileResults(tiles.size());
+  if (threadCount == 0) {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threadCount = std::min<unsigned int>(threadCount, static_cast<unsigned int>(tiles.size()));
 
-  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
-  std::u16string u16NewIconPath = info[1].As<Napi::String>().Utf16Value();
-  std::wstring newIconPath = std::wstring(u16NewIconPath.begin(), u16NewIconPath.end());
+  std::atomic<size_t> nextTile{0};
+  std::exception_ptr error;
+  std::mutex errorMutex;
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < threadCount; i++) {
+    threads.emplace_back([&]() {
+      try {
+        OcrEnginePool::Lease tesseract = ocrEnginePool.acquire(profile);
+        for (size_t tileIndex = nextTile++; tileIndex < tiles.size(); tileIndex = nextTile++) {
+          const OcrTile& tile = tiles[tileIndex];
+          BOX* box = boxCreate(tile.x, tile.y, tile.width, tile.height);
+          PIX* tileImage = pixClipRectangle(image, box, nullptr);
+          boxDestroy(&box);
+          if (!tileImage) continue;
+          try {
+            tileResults[tileIndex] = RecognizeStructuredText(*tesseract, tileImage, offsetX + tile.x / scale, offsetY + tile.y / scale, scale);
+          }
+          catch (...) {
+            pixDestroy(&tileImage);
+            throw;
+          }
+          pixDestroy(&tileImage);
+        }
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = std::current_exception();
+        // Let the other threads stop early
+        nextTile = tiles.size();
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
 
-  UpdateTrayIcon(trayIconWindowId, newIconPath);
+  OcrResult result;
+  for (OcrResult& tileResult : tileResults) {
+    AppendOcrResult(result, std::move(tileResult));
+  }
+  return result;
+}
 
-  return env.Undefined();
+// Recognize a preprocessed image on a single Tesseract instance, or tile it
+// over `threadCount` instances when it is not 1
+OcrResult RecognizeOcrImage(
+  PIX* image,
+  const OcrProfile& profile,
+  unsigned int threadCount,
+  int offsetX = 0,
+  int offsetY = 0,
+  int scale = 1
+) {
+  if (threadCount != 1) {
+    return RecognizeStructuredTextInParallel(image, profile, threadCount, offsetX, offsetY, scale);
+  }
+  OcrEnginePool::Lease tesseract = ocrEnginePool.acquire(profile);
+  return RecognizeStructuredText(*tesseract, image, offsetX, offsetY, scale);
 }
 
-void UpdateTrayIconTooltip(HWND hwnd, const std::wstring& newTooltip) {
-  // update the tooltip
-  wcscpy_s(nid.szTip, _countof(nid.szTip), newTooltip.c_str());
-  // Send message to the window to update the tray icon
-  PostMessage(hwnd, WM_USER + 3, 0, 0);
+std::string ToLowerAscii(std::string text) {
+  for (char& character : text) {
+    if (character >= 'A' && character <= 'Z') {
+      character = static_cast<char>(character - 'A' + 'a');
+    }
+  }
+  return text;
 }
 
-Napi::Value UpdateTrayIconTooltipWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+// Letters, digits and any byte of a multi-byte UTF-8 character
+bool IsOcrWordCharacter(char character) {
+  unsigned char byte = static_cast<unsigned char>(character);
+  return byte >= 0x80 || std::isalnum(byte);
+}
 
-  // Validate arguments
-  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsString()) {
-    Napi::TypeError::New(env, "Expected a number and string arguments").ThrowAsJavaScriptException();
-    return env.Null();
+// Find the word spans of each line containing `query` (whitespace insensitive).
+// With `isWholeWords`, the query must not start nor end inside a word, so that
+// "cat" does not match "concatenate".
+std::vector<OcrTextMatch> FindTextInOcrResult(const OcrResult& ocrResult, const std::string& query, bool isCaseSensitive, bool isWholeWords) {
+  // Normalize the query to single-space separated words
+  std::string normalizedQuery;
+  std::istringstream queryStream(isCaseSensitive ? query : ToLowerAscii(query));
+  for (std::string queryWord; queryStream >> queryWord; ) {
+    normalizedQuery += (normalizedQuery.empty() ? "" : " ") + queryWord;
+  }
+  std::vector<OcrTextMatch> matches;
+  if (normalizedQuery.empty()) {
+    return matches;
   }
 
-  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
-  std::u16string u16NewTooltip = info[1].As<Napi::String>().Utf16Value();
-  std::wstring newTooltip = std::wstring(u16NewTooltip.begin(), u16NewTooltip.end());
+  size_t wordCount = ocrResult.wordTexts.size();
+  for (size_t lineStart = 0; lineStart < wordCount; ) {
+    size_t lineEnd = lineStart;
+    while (lineEnd < wordCount && ocrResult.wordLines[lineEnd] == ocrResult.wordLines[lineStart]) {
+      lineEnd++;
+    }
 
-  UpdateTrayIconTooltip(trayIconWindowId, newTooltip);
+    // Join the line words, remembering where each one starts
+    std::string lineText;
+    std::vector<size_t> wordOffsets;
+    for (size_t word = lineStart; word < lineEnd; word++) {
+      if (!lineText.empty()) lineText += ' ';
+      wordOffsets.push_back(lineText.size());
+      lineText += isCaseSensitive ? ocrResult.wordTexts[word] : ToLowerAscii(ocrResult.wordTexts[word]);
+    }
 
-  return env.Undefined();
-}
+    for (size_t position = lineText.find(normalizedQuery); position != std::string::npos; position = lineText.find(normalizedQuery, position + 1)) {
+      size_t end = position + normalizedQuery.size();
+      if (
+        isWholeWords && (
+          (position > 0 && IsOcrWordCharacter(lineText[position - 1]) && IsOcrWordCharacter(normalizedQuery.front()))
+          || (end < lineText.size() && IsOcrWordCharacter(lineText[end]) && IsOcrWordCharacter(normalizedQuery.back()))
+        )
+      ) {
+        continue;
+      }
+      size_t firstWord = std::upper_bound(wordOffsets.begin(), wordOffsets.end(), position) - wordOffsets.begin() - 1;
+      size_t lastWord = std::upper_bound(wordOffsets.begin(), wordOffsets.end(), position + normalizedQuery.size() - 1) - wordOffsets.begin() - 1;
+
+      int32_t left = INT32_MAX, top = INT32_MAX, right = INT32_MIN, bottom = INT32_MIN;
+      float confidence = 100.0f;
+      std::string text;
+      for (size_t word = lineStart + firstWord; word <= lineStart + lastWord; word++) {
+        const int32_t* box = &ocrResult.wordBoxes[word * 4];
+        left = std::min(left, box[0]);
+        top = std::min(top, box[1]);
+        right = std::max(right, box[0] + box[2]);
+        bottom = std::max(bottom, box[1] + box[3]);
+        confidence = std::min(confidence, ocrResult.wordConfidences[word]);
+        text += (text.empty() ? "" : " ") + ocrResult.wordTexts[word];
+      }
+      matches.push_back({ text, left, top, right - left, bottom - top, confidence });
+    }
+    lineStart = lineEnd;
+  }
 
-bool AddTrayIconMenuItem(const std::wstring& itemText, UINT itemId, UINT position) {
-  std::lock_guard<std::mutex> lock(trayIconMutex);
-  if (!trayIconRunning || hMenu == nullptr) {
-    return false;
+  std::stable_sort(matches.begin(), matches.end(), [](const OcrTextMatch& a, const OcrTextMatch& b) {
+    return a.confidence > b.confidence;
+  });
+  return matches;
+}
+
+// Convert packed BGRA pixels to a 32bpp PIX
+PIX* BgraToPix(const uint8_t* pixels, int width, int height, size_t stride) {
+  PIX* pix = pixCreate(width, height, 32);
+  if (!pix) {
+    throw std::runtime_error("Failed to allocate image.");
+  }
+  l_uint32* data = pixGetData(pix);
+  int wordsPerLine = pixGetWpl(pix);
+  for (int y = 0; y < height; y++) {
+    const uint8_t* row = pixels + y * stride;
+    l_uint32* line = data + y * wordsPerLine;
+    for (int x = 0; x < width; x++) {
+      line[x] = (static_cast<l_uint32>(row[x * 4 + 2]) << 24)
+        | (static_cast<l_uint32>(row[x * 4 + 1]) << 16)
+        | (static_cast<l_uint32>(row[x * 4 + 0]) << 8)
+        | 0xff;
+    }
   }
-  return InsertMenuW(hMenu, position, MF_BYPOSITION | MF_STRING, itemId, itemText.c_str()) != 0;
+  return pix;
 }
 
-Napi::Value AddTrayIconMenuItemWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-
-  // Validate arguments
-  if (info.Length() < 5 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsString() || !info[4].IsFunction()) {
-    Napi::TypeError::New(env, "Expected number (hwnd), number (item id), number (position), string (label) and function (onClick callback) arguments").ThrowAsJavaScriptException();
-    return env.Null();
+// Recognize the text only, without walking the layout
+std::string RecognizeText(tesseract::TessBaseAPI& tesseract, PIX* image) {
+  tesseract.SetImage(image);
+  char* text = tesseract.GetUTF8Text();
+  if (!text) {
+    throw std::runtime_error("Failed to perform OCR on image.");
   }
+  std::string result(text);
+  delete[] text;
+  return result;
+}
 
-  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
-  UINT itemId = info[1].As<Napi::Number>().Uint32Value();
-  UINT position = info[2].As<Napi::Number>().Uint32Value();
-  std::u16string u16ItemText = info[3].As<Napi::String>().Utf16Value();
-  std::wstring itemText = std::wstring(u16ItemText.begin(), u16ItemText.end());
-  Napi::Function onClick = info[4].As<Napi::Function>();
+// Fast non-cryptographic hash of the pixels (and colormap) of an image, row
+// padding excluded
+uint64_t HashPixels(PIX* image) {
+  pixSetPadBits(image, 0);
+  l_int32 width, height, depth;
+  pixGetDimensions(image, &width, &height, &depth);
+  const l_uint32* data = pixGetData(image);
+  int wordsPerLine = pixGetWpl(image);
+  size_t rowWords = (static_cast<size_t>(width) * depth + 31) / 32;
+
+  const uint64_t prime = 0x9e3779b97f4a7c15ULL;
+  uint64_t hash = ((static_cast<uint64_t>(width) << 32) | static_cast<uint32_t>(height)) * prime ^ static_cast<uint64_t>(depth);
+  auto mix = [&hash, prime](uint64_t value) {
+    hash = (hash ^ value) * prime;
+    hash ^= hash >> 32;
+  };
+  for (int y = 0; y < height; y++) {
+    const l_uint32* row = data + static_cast<size_t>(y) * wordsPerLine;
+    size_t i = 0;
+    for (; i + 2 <= rowWords; i += 2) {
+      uint64_t value;
+      std::memcpy(&value, row + i, sizeof(value));
+      mix(value);
+    }
+    if (i < rowWords) {
+      mix(row[i]);
+    }
+  }
+  // Colormapped pixels are palette indices: identical indices with another
+  // palette are another image
+  if (PIXCMAP* colormap = pixGetColormap(image)) {
+    int colorCount = pixcmapGetCount(colormap);
+    mix(static_cast<uint64_t>(colorCount) << 32);
+    for (int index = 0; index < colorCount; index++) {
+      l_int32 red, green, blue, alpha;
+      pixcmapGetRGBA(colormap, index, &red, &green, &blue, &alpha);
+      mix((static_cast<uint64_t>(red) << 24) | (green << 16) | (blue << 8) | alpha);
+    }
+  }
+  return hash;
+}
 
-  // Create JS and C++ tray icon menu item callback
-  Napi::ThreadSafeFunction trayIconMenuItemJsCallback = Napi::ThreadSafeFunction::New(
-    env, // the main NAPI environment
-    onClick, // callback function that needs to be called in thread(s)
-    "Tray Icon Callback " + std::to_string(itemId), // JS string used to provide diagnostic information
-    0, // maximum queue size (0 for unlimited)
-    1, // initial number of threads which will be making use of this function
-    [](const Napi::Env& env) { // finalizer callback, can be used to clean threads up
+// Shift every box of an OCR result
+void OffsetOcrResult(OcrResult& result, int offsetX, int offsetY) {
+  if (offsetX == 0 && offsetY == 0) {
+    return;
+  }
+  for (std::vector<int32_t>* boxes : { &result.wordBoxes, &result.lineBoxes, &result.blockBoxes }) {
+    for (size_t i = 0; i + 1 < boxes->size(); i += 4) {
+      (*boxes)[i] += offsetX;
+      (*boxes)[i + 1] += offsetY;
     }
-  );
-  trayIconMenuItemsJsCallbacks[itemId] = trayIconMenuItemJsCallback;
-  std::function<void()> trayIconMenuItemCallback = [itemId]() {
+  }
+}
+
+// Preprocess and recognize `source`, unless identical pixels were recently
+// recognized with the same settings. Results are cached without offset, so
+// that a moved area still hits, then shifted by (offsetX, offsetY).
+// With `isTextOnly`, single threaded recognition skips the layout walk and
+// only fills the result text.
+OcrResult RecognizeOcrImageCached(
+  PIX* source,
+  const OcrProfile& profile,
+  const OcrPreprocessing& preprocessing,
+  unsigned int threadCount,
+  bool isTextOnly,
+  int offsetX = 0,
+  int offsetY = 0
+) {
+  // Tiling does not depend on the thread count, only on whether it is used
+  bool isTiled = threadCount != 1;
+  std::ostringstream keyStream;
+  keyStream << std::hex << HashPixels(source) << std::dec
+    << ':' << pixGetWidth(source) << 'x' << pixGetHeight(source) << 'x' << pixGetDepth(source)
+    << ':' << profile.key()
+    << ':' << preprocessing.isGrayscale << static_cast<int>(preprocessing.inversion) << preprocessing.scale << static_cast<int>(preprocessing.binarization)
+    << ':' << (isTiled ? "tiled" : "whole") << (isTextOnly && !isTiled ? ":text" : "");
+  std::string key = keyStream.str();
+
+  std::optional<OcrResult> cachedResult = ocrResultCache.get(key);
+  OcrResult result;
+  if (cachedResult) {
+    result = std::move(*cachedResult);
+  }
+  else {
+    PIX* image = PreprocessOcrImage(source, preprocessing);
     try {
-      Napi::ThreadSafeFunction trayIconMenuItemJsCallback = trayIconMenuItemsJsCallbacks.at(itemId);
-      trayIconMenuItemJsCallback.BlockingCall([](const Napi::Env& env, const Napi::Function& jsCallback) {
-        if (!jsCallback.IsEmpty()) {
-          jsCallback.Call({ });
-        }
-      });
-    } catch (const std::out_of_range& e) {
-      std::cerr << "OutOfRangeError: " << e.what() << std::endl;
-      return;
-    } catch (const std::exception& e) {
-      std::cerr << "Error: " << e.what() << std::endl;
-      return;
+      if (isTextOnly && !isTiled) {
+        OcrEnginePool::Lease tesseract = ocrEnginePool.acquire(profile);
+        result.text = RecognizeText(*tesseract, image);
+      }
+      else {
+        result = RecognizeOcrImage(image, profile, threadCount, 0, 0, preprocessing.scale);
+      }
     }
-  };
-  trayIconMenuItemsCallbacks[itemId] = trayIconMenuItemCallback;
+    catch (...) {
+      pixDestroy(&image);
+      throw;
+    }
+    pixDestroy(&image);
+    ocrResultCache.put(key, result);
+  }
+  OffsetOcrResult(result, offsetX, offsetY);
+  return result;
+}
 
-  // Add the menu item
-  bool result = AddTrayIconMenuItem(itemText, itemId, position);
+// Recognize an image file, through the OCR result cache
+OcrResult PerformCachedOcrOnImage(
+  const std::string& imagePath,
+  const OcrProfile& profile,
+  const OcrPreprocessing& preprocessing,
+  unsigned int threadCount,
+  bool isTextOnly
+) {
+  PIX* image = pixRead(imagePath.c_str());
+  if (!image) {
+    throw std::runtime_error("Failed to load image " + imagePath);
+  }
+  try {
+    OcrResult result = RecognizeOcrImageCached(image, profile, preprocessing, threadCount, isTextOnly);
+    pixDestroy(&image);
+    return result;
+  }
+  catch (...) {
+    pixDestroy(&image);
+    throw;
+  }
+}
 
-  return Napi::Boolean::New(env, result);
+std::string PerformOcrOnImage(
+  const std::string& imagePath,
+  const OcrProfile& profile = {},
+  const OcrPreprocessing& preprocessing = {},
+  unsigned int threadCount = 1
+) {
+  return PerformCachedOcrOnImage(imagePath, profile, preprocessing, threadCount, true).text;
+}
+
+OcrResult PerformStructuredOcrOnImage(
+  const std::string& imagePath,
+  const OcrProfile& profile = {},
+  const OcrPreprocessing& preprocessing = {},
+  unsigned int threadCount = 1
+) {
+  return PerformCachedOcrOnImage(imagePath, profile, preprocessing, threadCount, false);
+}
+
+// OCR a screen area in memory and find the occurrences of `query`, in screen coordinates
+std::vector<OcrTextMatch> FindTextOnScreen(
+  const std::string& query,
+  int x,
+  int y,
+  int width,
+  int height,
+  const OcrProfile& profile,
+  bool isCaseSensitive,
+  bool isWholeWords,
+  const OcrPreprocessing& preprocessing,
+  unsigned int threadCount
+) {
+  ScreenFrameSource source(0, x, y, width, height);
+  source.attachToCurrentThread();
+  std::vector<uint8_t> pixels(source.stride() * source.height());
+  if (!source.grab(pixels.data())) {
+    throw std::runtime_error("Failed to capture the screen.");
+  }
+  PIX* capture = BgraToPix(pixels.data(), source.width(), source.height(), source.stride());
+  pixels = {};
+  try {
+    OcrResult ocrResult = RecognizeOcrImageCached(capture, profile, preprocessing, threadCount, false, source.x(), source.y());
+    pixDestroy(&capture);
+    return FindTextInOcrResult(ocrResult, query, isCaseSensitive, isWholeWords);
+  }
+  catch (...) {
+    pixDestroy(&capture);
+    throw;
+  }
 }
 
-bool UpdateTrayIconMenuItemLabel(UINT itemId, const std::wstring& newLabel) {
-  std::lock_guard<std::mutex> lock(trayIconMutex);
-  if (!trayIconRunning || hMenu == nullptr) {
+//
+// Read the optional `preprocessing` options of an OCR call. Throws a JS
+// TypeError and returns false when they are invalid.
+bool ParseOcrPreprocessing(Napi::Env env, Napi::Value value, OcrPreprocessing& preprocessing) {
+  if (value.IsUndefined() || value.IsNull()) {
+    return true;
+  }
+  if (!value.IsObject()) {
+    Napi::TypeError::New(env, "OCR preprocessing options must be an object").ThrowAsJavaScriptException();
     return false;
   }
+  Napi::Object options = value.As<Napi::Object>();
 
-  // Update the label by ID
-  return ModifyMenuW(hMenu, itemId, MF_BYCOMMAND | MF_STRING, itemId, newLabel.c_str()) != 0;
-}
-
-Napi::Value UpdateTrayIconMenuItemLabelWrapper(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+  preprocessing.isGrayscale = options.Get("grayscale").IsBoolean() && options.Get("grayscale").As<Napi::Boolean>().Value();
 
-  // Validate arguments
-  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsString()) {
-    Napi::TypeError::New(env, "Expected number (hwnd), number (item id) and string (label) arguments").ThrowAsJavaScriptException();
-    return env.Null();
+  Napi::Value invert = options.Get("invert");
+  if (invert.IsBoolean()) {
+    preprocessing.inversion = invert.As<Napi::Boolean>().Value() ? OcrInversion::Always : OcrInversion::None;
+  }
+  else if (invert.IsString() && invert.As<Napi::String>().Utf8Value() == "auto") {
+    preprocessing.inversion = OcrInversion::Auto;
+  }
+  else if (!invert.IsUndefined()) {
+    Napi::TypeError::New(env, "OCR preprocessing \"invert\" must be a boolean or \"auto\"").ThrowAsJavaScriptException();
+    return false;
   }
 
-  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
-  UINT itemId = info[1].As<Napi::Number>().Uint32Value();
-  std::u16string u16NewLabel = info[2].As<Napi::String>().Utf16Value();
-  std::wstring newLabel = std::wstring(u16NewLabel.begin(), u16NewLabel.end());
-
-  // Update the menu item label
-  bool result = UpdateTrayIconMenuItemLabel(itemId, newLabel);
+  Napi::Value scale = options.Get("scale");
+  if (!scale.IsUndefined()) {
+    double scaleValue = scale.IsNumber() ? scale.As<Napi::Number>().DoubleValue() : 0;
+    if (scaleValue < 1 || scaleValue > 8 || scaleValue != std::floor(scaleValue)) {
+      Napi::TypeError::New(env, "OCR preprocessing \"scale\" must be an integer between 1 and 8").ThrowAsJavaScriptException();
+      return false;
+    }
+    preprocessing.scale = static_cast<int>(scaleValue);
+  }
 
-  return Napi::Boolean::New(env, result);
+  Napi::Value binarize = options.Get("binarize");
+  std::string binarization = binarize.IsString() ? binarize.As<Napi::String>().Utf8Value() : "";
+  if (binarization == "otsu") {
+    preprocessing.binarization = OcrBinarization::Otsu;
+  }
+  else if (binarization == "sauvola") {
+    preprocessing.binarization = OcrBinarization::Sauvola;
+  }
+  else if (!binarize.IsUndefined()) {
+    Napi::TypeError::New(env, "OCR preprocessing \"binarize\" must be \"otsu\" or \"sauvola\"").ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
 }
 
-bool UpdateTrayIconMenuItemCallback(UINT itemId, const Napi::ThreadSafeFunction& newTrayIconMenuItemJsCallback) {
-  std::lock_guard<std::mutex> lock(trayIconMutex);
-  if (!trayIconRunning || hMenu == nullptr) {
-    return false;
+// Read the optional OCR thread count: 1 by default, 0 for all cores. Throws a
+// JS TypeError and returns false when it is invalid.
+bool ParseOcrThreadCount(Napi::Env env, Napi::Value value, unsigned int& threadCount) {
+  if (value.IsUndefined() || value.IsNull()) {
+    return true;
   }
-  if (trayIconMenuItemsJsCallbacks.count(itemId) == 0) {
+  double threads = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+  if (threads < 0 || threads > 256 || threads != std::floor(threads)) {
+    Napi::TypeError::New(env, "OCR \"threads\" must be an integer between 0 and 256").ThrowAsJavaScriptException();
     return false;
   }
-
-  // Update the callback by ID
-  trayIconMenuItemsJsCallbacks[itemId].Abort();
-  trayIconMenuItemsJsCallbacks[itemId] = newTrayIconMenuItemJsCallback;
+  threadCount = static_cast<unsigned int>(threads);
   return true;
 }
 
-Napi::Value UpdateTrayIconMenuItemCallbackWrapper(const Napi::CallbackInfo& info) {
+Napi::Value PerformOcrOnImageWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   // Validate arguments
-  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsFunction()) {
-    Napi::TypeError::New(env, "Expected number (hwnd), number (item id) and function (callback) arguments").ThrowAsJavaScriptException();
+  if (info.Length() < 1) {
+    Napi::TypeError::New(env, "Expected a string argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the second argument").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
-  UINT itemId = info[1].As<Napi::Number>().Uint32Value();
-  Napi::Function newJsCallback = info[2].As<Napi::Function>();
-  Napi::ThreadSafeFunction newTrayIconMenuItemJsCallback = Napi::ThreadSafeFunction::New(
-    env, // the main NAPI environment
-    newJsCallback, // callback function that needs to be called in thread(s)
-    "Tray Icon Callback " + std::to_string(itemId), // JS string used to provide diagnostic information
-    0, // maximum queue size (0 for unlimited)
-    1, // initial number of threads which will be making use of this function
-    [](const Napi::Env& env) { // finalizer callback, can be used to clean threads up
+  // Translata JS input to C++ input
+  std::u16string u16ImagePath = info[0].As<Napi::String>().Utf16Value();
+  std::wstring imagePath = std::wstring(u16ImagePath.begin(), u16ImagePath.end());
+  std::u16string u16Language = info.Length() > 1 && !info[1].IsUndefined() ? info[1].As<Napi::String>().Utf16Value() : std::u16string();
+  std::wstring language = std::wstring(u16Language.begin(), u16Language.end());
+  OcrPreprocessing preprocessing;
+  if (info.Length() > 2 && !ParseOcrPreprocessing(env, info[2], preprocessing)) {
+    return env.Null();
+  }
+  unsigned int threadCount = 1;
+  if (info.Length() > 3 && !ParseOcrThreadCount(env, info[3], threadCount)) {
+    return env.Null();
+  }
+  // Perform OCR on the image
+  try {
+    std::string extractedText = PerformOcrOnImage(ConvertToUTF8(imagePath), ResolveOcrProfile(ConvertToUTF8(language)), preprocessing, threadCount);
+    std::u16string u16extractedText = std::u16string(extractedText.begin(), extractedText.end());
+
+    // Return the extracted text
+    return Napi::String::New(env, u16extractedText);
+  }
+  catch (const std::exception& ex) {
+    Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Object OcrResultToJs(Napi::Env env, const OcrResult& ocrResult) {
+  auto toStrings = [&env](const std::vector<std::string>& values) {
+    Napi::Array result = Napi::Array::New(env, values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      result.Set(i, Napi::String::New(env, values[i]));
     }
-  );
+    return result;
+  };
+  auto toInt32Array = [&env](const std::vector<int32_t>& values) {
+    Napi::Int32Array result = Napi::Int32Array::New(env, values.size());
+    std::copy(values.begin(), values.end(), result.Data());
+    return result;
+  };
+  auto toFloat32Array = [&env](const std::vector<float>& values) {
+    Napi::Float32Array result = Napi::Float32Array::New(env, values.size());
+    std::copy(values.begin(), values.end(), result.Data());
+    return result;
+  };
 
-  // Update the menu item callback
-  bool result = UpdateTrayIconMenuItemCallback(itemId, newTrayIconMenuItemJsCallback);
+  Napi::Object words = Napi::Object::New(env);
+  words.Set("text", toStrings(ocrResult.wordTexts));
+  words.Set("boxes", toInt32Array(ocrResult.wordBoxes));
+  words.Set("confidences", toFloat32Array(ocrResult.wordConfidences));
+  words.Set("lines", toInt32Array(ocrResult.wordLines));
 
-  return Napi::Boolean::New(env, result);
-}
+  Napi::Object lines = Napi::Object::New(env);
+  lines.Set("text", toStrings(ocrResult.lineTexts));
+  lines.Set("boxes", toInt32Array(ocrResult.lineBoxes));
+  lines.Set("confidences", toFloat32Array(ocrResult.lineConfidences));
+  lines.Set("blocks", toInt32Array(ocrResult.lineBlocks));
 
-bool RemoveTrayIconMenuItem(UINT itemId) {
-  std::lock_guard<std::mutex> lock(trayIconMutex);
-  if (!trayIconRunning || hMenu == nullptr) {
-    return false;
-  }
-  // Attempt to remove the menu item using the item ID
-  if (RemoveMenu(hMenu, itemId, MF_BYCOMMAND) != 0) {
-    // Clean up the C++ callback
-    trayIconMenuItemsCallbacks.erase(itemId);
-    // Clean up the JS callback
-    trayIconMenuItemsJsCallbacks[itemId].Abort();
-    trayIconMenuItemsJsCallbacks.erase(itemId);
-    return true;
-  }
-  return false;
+  Napi::Object blocks = Napi::Object::New(env);
+  blocks.Set("boxes", toInt32Array(ocrResult.blockBoxes));
+  blocks.Set("confidences", toFloat32Array(ocrResult.blockConfidences));
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("text", Napi::String::New(env, ocrResult.text));
+  result.Set("words", words);
+  result.Set("lines", lines);
+  result.Set("blocks", blocks);
+  return result;
 }
 
-Napi::Value RemoveTrayIconMenuItemWrapper(const Napi::CallbackInfo& info) {
+Napi::Value PerformStructuredOcrOnImageWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   // Validate arguments
-  if (info.Length() < 2 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Expected number (hwnd) and number (item id) arguments").ThrowAsJavaScriptException();
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the second argument").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  HWND trayIconWindowId = reinterpret_cast<HWND>(static_cast<intptr_t>(info[0].As<Napi::Number>().Int32Value()));
-  UINT itemId = info[1].As<Napi::Number>().Uint32Value();
+  // Translate JS input to C++ input
+  std::u16string u16ImagePath = info[0].As<Napi::String>().Utf16Value();
+  std::wstring imagePath = std::wstring(u16ImagePath.begin(), u16ImagePath.end());
+  std::string language = info.Length() > 1 && !info[1].IsUndefined() ? info[1].As<Napi::String>().Utf8Value() : std::string();
 
-  // Remove the menu item
-  bool result = RemoveTrayIconMenuItem(itemId);
+  OcrPreprocessing preprocessing;
+  if (info.Length() > 2 && !ParseOcrPreprocessing(env, info[2], preprocessing)) {
+    return env.Null();
+  }
+  unsigned int threadCount = 1;
+  if (info.Length() > 3 && !ParseOcrThreadCount(env, info[3], threadCount)) {
+    return env.Null();
+  }
 
-  return Napi::Boolean::New(env, result);
+  try {
+    return OcrResultToJs(env, PerformStructuredOcrOnImage(ConvertToUTF8(imagePath), ResolveOcrProfile(language), preprocessing, threadCount));
+  }
+  catch (const std::exception& ex) {
+    Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
 }
 
-
-// =============================================================================
-// =============================== TIME FUNCTIONS ==============================
-// =============================================================================
-
-// Function to synchronously sleep for a given number of milliseconds
-Napi::Value SleepWrapper(const Napi::CallbackInfo& info) {
+Napi::Value FindTextOnScreenWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   // Validate arguments
-  if (info.Length() < 1 || !info[0].IsNumber()) {
-    Napi::TypeError::New(env, "Expected a number argument").ThrowAsJavaScriptException();
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Arguments must be: (query, options)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[1].As<Napi::Object>();
+  if (!options.Get("x").IsNumber() || !options.Get("y").IsNumber() || !options.Get("width").IsNumber() || !options.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "Options must contain: x, y, width, height").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  int milliseconds = info[0].As<Napi::Number>().Int32Value();
-
-  // Sleep for the specified number of milliseconds
-  std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+  // Translate JS input to C++ input
+  std::string query = info[0].As<Napi::String>().Utf8Value();
+  int x = options.Get("x").As<Napi::Number>().Int32Value();
+  int y = options.Get("y").As<Napi::Number>().Int32Value();
+  int width = options.Get("width").As<Napi::Number>().Int32Value();
+  int height = options.Get("height").As<Napi::Number>().Int32Value();
+  OcrProfile profile = ResolveOcrProfile(options.Get("language").IsString() ? options.Get("language").As<Napi::String>().Utf8Value() : std::string());
+  bool isCaseSensitive = options.Get("caseSensitive").IsBoolean() && options.Get("caseSensitive").As<Napi::Boolean>().Value();
+  bool isWholeWords = !options.Get("wholeWords").IsBoolean() || options.Get("wholeWords").As<Napi::Boolean>().Value();
+  OcrPreprocessing preprocessing;
+  if (!ParseOcrPreprocessing(env, options.Get("preprocessing"), preprocessing)) {
+    return env.Null();
+  }
+  unsigned int threadCount = 1;
+  if (!ParseOcrThreadCount(env, options.Get("threads"), threadCount)) {
+    return env.Null();
+  }
 
-  return env.Undefined();
+  // Capture and OCR off the main thread
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<std::vector<OcrTextMatch>>(
+    env,
+    deferred,
+    [query, x, y, width, height, profile, isCaseSensitive, isWholeWords, preprocessing, threadCount]() -> std::vector<OcrTextMatch> {
+      return FindTextOnScreen(query, x, y, width, height, profile, isCaseSensitive, isWholeWords, preprocessing, threadCount);
+    },
+    [](Napi::Env env, const std::vector<OcrTextMatch>& matches) -> Napi::Value {
+      Napi::Array result = Napi::Array::New(env, matches.size());
+      for (size_t i = 0; i < matches.size(); i++) {
+        Napi::Object jsMatch = Napi::Object::New(env);
+        jsMatch.Set("text", Napi::String::New(env, matches[i].text));
+        jsMatch.Set("x", Napi::Number::New(env, matches[i].x));
+        jsMatch.Set("y", Napi::Number::New(env, matches[i].y));
+        jsMatch.Set("width", Napi::Number::New(env, matches[i].width));
+        jsMatch.Set("height", Napi::Number::New(env, matches[i].height));
+        jsMatch.Set("confidence", Napi::Number::New(env, matches[i].confidence));
+        result.Set(i, jsMatch);
+      }
+      return result;
+    }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
 }
 
+Napi::Value GetOcrCacheStatsWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  OcrResultCache::Stats stats = ocrResultCache.stats();
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+  result.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+  result.Set("size", Napi::Number::New(env, static_cast<double>(stats.size)));
+  result.Set("capacity", Napi::Number::New(env, static_cast<double>(stats.capacity)));
+  return result;
+}
 
-// =============================================================================
-// =============================== OCR FUNCTIONS ===============================
-// =============================================================================
-
-std::string PerformOcrOnImage(const std::string& imagePath, const std::string& language = "") {
-  // Load image
-  PIX* image = pixRead(imagePath.c_str());
+Napi::Value SetOcrCacheCapacityWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-  if (!image) {
-    throw std::runtime_error("Failed to load image " + imagePath);
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a number as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  double capacity = info[0].As<Napi::Number>().DoubleValue();
+  if (capacity < 0 || capacity != std::floor(capacity)) {
+    Napi::TypeError::New(env, "OCR cache capacity must be a positive integer or 0").ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  // Create Tesseract API instance
-  tesseract::TessBaseAPI tesseract;
+  ocrResultCache.resize(static_cast<size_t>(capacity));
+  return env.Undefined();
+}
 
-  // Get trained data assets folder
-  std::string trainedDataAbsolutePath = (GetUserDataAbsoluteDirectoryPath() / "ocr")
-    .lexically_normal()
-    .generic_string();
+Napi::Value ClearOcrCacheWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ocrResultCache.clear();
+  return env.Undefined();
+}
 
-  // Initialize Tesseract
-  if (tesseract.Init(trainedDataAbsolutePath.c_str(), !language.empty() ? language.c_str() : "eng") != 0) {
-    pixDestroy(&image);
-    throw std::runtime_error("Failed to initialize Tesseract with language: " + (!language.empty() ? language : "eng"));
+// Read the options of an OCR profile. Throws a JS TypeError and returns false
+// when they are invalid.
+bool ParseOcrProfile(Napi::Env env, Napi::Object options, OcrProfile& profile) {
+  Napi::Value language = options.Get("language");
+  if (language.IsString()) {
+    profile.language = language.As<Napi::String>().Utf8Value();
+  }
+  else if (!language.IsUndefined()) {
+    Napi::TypeError::New(env, "OCR profile \"language\" must be a string").ThrowAsJavaScriptException();
+    return false;
   }
 
-  // Set image
-  tesseract.SetImage(image);
-
-  // Perform OCR
-  char* text = tesseract.GetUTF8Text();
-
-  if (!text) {
-    tesseract.End();
-    pixDestroy(&image);
-    throw std::runtime_error("Failed to perform OCR on image " + imagePath);
+  static const std::map<std::string, tesseract::PageSegMode> pageSegmentationModes = {
+    { "auto", tesseract::PSM_AUTO },
+    { "auto-osd", tesseract::PSM_AUTO_OSD },
+    { "auto-only", tesseract::PSM_AUTO_ONLY },
+    { "single-column", tesseract::PSM_SINGLE_COLUMN },
+    { "single-block-vertical", tesseract::PSM_SINGLE_BLOCK_VERT_TEXT },
+    { "single-block", tesseract::PSM_SINGLE_BLOCK },
+    { "single-line", tesseract::PSM_SINGLE_LINE },
+    { "single-word", tesseract::PSM_SINGLE_WORD },
+    { "circle-word", tesseract::PSM_CIRCLE_WORD },
+    { "single-char", tesseract::PSM_SINGLE_CHAR },
+    { "sparse-text", tesseract::PSM_SPARSE_TEXT },
+    { "sparse-text-osd", tesseract::PSM_SPARSE_TEXT_OSD },
+    { "raw-line", tesseract::PSM_RAW_LINE },
+  };
+  Napi::Value pageSegmentationMode = options.Get("pageSegmentationMode");
+  if (!pageSegmentationMode.IsUndefined()) {
+    auto mode = pageSegmentationMode.IsString() ? pageSegmentationModes.find(pageSegmentationMode.As<Napi::String>().Utf8Value()) : pageSegmentationModes.end();
+    if (mode == pageSegmentationModes.end()) {
+      Napi::TypeError::New(env, "Unknown OCR profile \"pageSegmentationMode\"").ThrowAsJavaScriptException();
+      return false;
+    }
+    profile.pageSegmentationMode = mode->second;
   }
 
-  // Copy result
-  std::string result(text);
+  static const std::map<std::string, tesseract::OcrEngineMode> engineModes = {
+    { "default", tesseract::OEM_DEFAULT },
+    { "lstm", tesseract::OEM_LSTM_ONLY },
+    { "legacy", tesseract::OEM_TESSERACT_ONLY },
+    { "combined", tesseract::OEM_TESSERACT_LSTM_COMBINED },
+  };
+  Napi::Value engineMode = options.Get("engineMode");
+  if (!engineMode.IsUndefined()) {
+    auto mode = engineMode.IsString() ? engineModes.find(engineMode.As<Napi::String>().Utf8Value()) : engineModes.end();
+    if (mode == engineModes.end()) {
+      Napi::TypeError::New(env, "OCR profile \"engineMode\" must be \"default\", \"lstm\", \"legacy\" or \"combined\"").ThrowAsJavaScriptException();
+      return false;
+    }
+    profile.engineMode = mode->second;
+  }
 
-  // Cleanup
-  delete[] text;
-  tesseract.End();
-  pixDestroy(&image);
+  for (const char* name : { "whitelist", "blacklist" }) {
+    Napi::Value characters = options.Get(name);
+    if (!characters.IsUndefined() && !characters.IsString()) {
+      Napi::TypeError::New(env, std::string("OCR profile \"") + name + "\" must be a string").ThrowAsJavaScriptException();
+      return false;
+    }
+  }
+  profile.whitelist = options.Get("whitelist").IsString() ? options.Get("whitelist").As<Napi::String>().Utf8Value() : std::string();
+  profile.blacklist = options.Get("blacklist").IsString() ? options.Get("blacklist").As<Napi::String>().Utf8Value() : std::string();
 
-  return result;
+  Napi::Value dpi = options.Get("dpi");
+  if (!dpi.IsUndefined()) {
+    double dpiValue = dpi.IsNumber() ? dpi.As<Napi::Number>().DoubleValue() : 0;
+    if (dpiValue < 70 || dpiValue > 2400 || dpiValue != std::floor(dpiValue)) {
+      Napi::TypeError::New(env, "OCR profile \"dpi\" must be an integer between 70 and 2400").ThrowAsJavaScriptException();
+      return false;
+    }
+    profile.dpi = static_cast<int>(dpiValue);
+  }
+
+  Napi::Value variables = options.Get("variables");
+  if (variables.IsObject()) {
+    Napi::Object variablesObject = variables.As<Napi::Object>();
+    Napi::Array names = variablesObject.GetPropertyNames();
+    for (uint32_t i = 0; i < names.Length(); i++) {
+      std::string name = names.Get(i).As<Napi::String>().Utf8Value();
+      Napi::Value value = variablesObject.Get(name);
+      if (value.IsBoolean()) {
+        profile.variables[name] = value.As<Napi::Boolean>().Value() ? "1" : "0";
+      }
+      else if (value.IsNumber() || value.IsString()) {
+        profile.variables[name] = value.ToString().Utf8Value();
+      }
+      else {
+        Napi::TypeError::New(env, "OCR profile variable \"" + name + "\" must be a string, a number or a boolean").ThrowAsJavaScriptException();
+        return false;
+      }
+    }
+  }
+  else if (!variables.IsUndefined()) {
+    Napi::TypeError::New(env, "OCR profile \"variables\" must be an object").ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
 }
 
-//
-Napi::Value PerformOcrOnImageWrapper(const Napi::CallbackInfo& info) {
+Napi::Value RegisterOcrProfileWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   // Validate arguments
-  if (info.Length() < 1) {
-    Napi::TypeError::New(env, "Expected a string argument").ThrowAsJavaScriptException();
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Arguments must be: (name, options)").ThrowAsJavaScriptException();
     return env.Null();
   }
-  if (!info[0].IsString()) {
+  std::string name = info[0].As<Napi::String>().Utf8Value();
+  if (name.empty()) {
+    Napi::TypeError::New(env, "OCR profile name must not be empty").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[1].As<Napi::Object>();
+  OcrProfile profile;
+  if (!ParseOcrProfile(env, options, profile)) {
+    return env.Null();
+  }
+  double preload = 1;
+  if (!options.Get("preload").IsUndefined()) {
+    preload = options.Get("preload").IsNumber() ? options.Get("preload").As<Napi::Number>().DoubleValue() : -1;
+    if (preload < 0 || preload > 256 || preload != std::floor(preload)) {
+      Napi::TypeError::New(env, "OCR profile \"preload\" must be an integer between 0 and 256").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+  size_t preloadCount = static_cast<size_t>(preload);
+
+  // Initialize engines off the main thread, then register the profile
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<bool>(
+    env,
+    deferred,
+    [name, profile, preloadCount]() -> bool {
+      ocrEnginePool.preload(profile, preloadCount);
+      std::optional<OcrProfile> replacedProfile;
+      {
+        std::lock_guard<std::mutex> lock(ocrProfilesMutex);
+        auto existingProfile = ocrProfiles.find(name);
+        if (existingProfile != ocrProfiles.end() && existingProfile->second.key() != profile.key()) {
+          replacedProfile = existingProfile->second;
+        }
+        ocrProfiles[name] = profile;
+      }
+      if (replacedProfile) {
+        ocrEnginePool.clear(*replacedProfile);
+      }
+      return true;
+    },
+    [](Napi::Env env, const bool&) -> Napi::Value {
+      return env.Undefined();
+    }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
+}
+
+Napi::Value UnregisterOcrProfileWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsString()) {
     Napi::TypeError::New(env, "Expected a string as the first argument").ThrowAsJavaScriptException();
     return env.Null();
   }
-  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsString()) {
-    Napi::TypeError::New(env, "Expected a string as the second argument").ThrowAsJavaScriptException();
-    return env.Null();
-  }
-
-  // Translata JS input to C++ input
-  std::u16string u16ImagePath = info[0].As<Napi::String>().Utf16Value();
-  std::wstring imagePath = std::wstring(u16ImagePath.begin(), u16ImagePath.end());
-  std::u16string u16Language = info.Length() > 1 && !info[1].IsUndefined() ? info[1].As<Napi::String>().Utf16Value() : std::u16string();
-  std::wstring language = std::wstring(u16Language.begin(), u16Language.end());
-  // Perform OCR on the image
-  try {
-    std::string extractedText = PerformOcrOnImage(ConvertToUTF8(imagePath), ConvertToUTF8(language));
-    std::u16string u16extractedText = std::u16string(extractedText.begin(), extractedText.end());
+  std::string name = info[0].As<Napi::String>().Utf8Value();
 
-    // Return the extracted text
-    return Napi::String::New(env, u16extractedText);
+  std::optional<OcrProfile> profile;
+  {
+    std::lock_guard<std::mutex> lock(ocrProfilesMutex);
+    auto existingProfile = ocrProfiles.find(name);
+    if (existingProfile != ocrProfiles.end()) {
+      profile = existingProfile->second;
+      ocrProfiles.erase(existingProfile);
+    }
   }
-  catch (const std::exception& ex) {
-    Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
-    return env.Null();
+  if (profile) {
+    ocrEnginePool.clear(*profile);
   }
+  return Napi::Boolean::New(env, profile.has_value());
+}
+
+Napi::Value ReleaseOcrEnginesWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ocrEnginePool.clear();
+  return env.Undefined();
 }
 
 
@@ -1691,6 +7014,95 @@ Napi::Value GetPixelColorsFromPngWrapper(const Napi::CallbackInfo& info) {
   }
 }
 
+// JS wrapper returning the packed pixels of an image along with its layout
+Napi::Value GetRawPixelsFromImageWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1) {
+    Napi::TypeError::New(env, "Expected at least one string argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected a string as the second argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input to C++ input
+  std::u16string u16filePath = info[0].As<Napi::String>().Utf16Value();
+  std::wstring filePath = std::wstring(u16filePath.begin(), u16filePath.end());
+  std::string format = info.Length() > 1 && info[1].IsString() ? info[1].As<Napi::String>().Utf8Value() : "rgba";
+  if (format != "rgba" && format != "bgra") {
+    Napi::TypeError::New(env, "Expected \"rgba\" or \"bgra\" as the second argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Gdiplus::GdiplusStartupInput gdiplusStartupInput;
+  ULONG_PTR gdiplusToken;
+  Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, nullptr);
+
+  Gdiplus::Bitmap* bitmap = Gdiplus::Bitmap::FromFile(filePath.c_str());
+  if (!bitmap || bitmap->GetLastStatus() != Gdiplus::Ok) {
+    delete bitmap;
+    Gdiplus::GdiplusShutdown(gdiplusToken);
+    Napi::Error::New(env, "Failed to load image file.").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  UINT width = bitmap->GetWidth();
+  UINT height = bitmap->GetHeight();
+  size_t stride = static_cast<size_t>(width) * 4;
+  size_t byteLength = stride * height;
+  Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, byteLength);
+
+  // Let GDI+ decode straight into the JS buffer (32bppARGB is laid out as BGRA)
+  Gdiplus::BitmapData bitmapData;
+  bitmapData.Width = width;
+  bitmapData.Height = height;
+  bitmapData.Stride = static_cast<INT>(stride);
+  bitmapData.PixelFormat = PixelFormat32bppARGB;
+  bitmapData.Scan0 = buffer.Data();
+  bitmapData.Reserved = 0;
+  Gdiplus::Rect rect(0, 0, width, height);
+  Gdiplus::Status status = bitmap->LockBits(
+    &rect,
+    Gdiplus::ImageLockModeRead | Gdiplus::ImageLockModeUserInputBuf,
+    PixelFormat32bppARGB,
+    &bitmapData
+  );
+  if (status == Gdiplus::Ok) {
+    bitmap->UnlockBits(&bitmapData);
+  }
+
+  delete bitmap;
+  Gdiplus::GdiplusShutdown(gdiplusToken);
+
+  if (status != Gdiplus::Ok) {
+    Napi::Error::New(env, "Failed to read image pixels.").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (format == "rgba") {
+    uint8_t* data = static_cast<uint8_t*>(buffer.Data());
+    for (size_t index = 0; index < byteLength; index += 4) {
+      std::swap(data[index], data[index + 2]);
+    }
+  }
+
+  // Construct JS output
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("width", Napi::Number::New(env, width));
+  result.Set("height", Napi::Number::New(env, height));
+  result.Set("stride", Napi::Number::New(env, stride));
+  result.Set("format", Napi::String::New(env, format));
+  result.Set("data", Napi::Uint8Array::New(env, byteLength, buffer, 0));
+  return result;
+}
+
 // Computes similarity score (between 0 and 1) via image template matching
 void computeSimilarityChunk(
   const std::vector<std::vector<Color>>& image,
@@ -1786,6 +7198,123 @@ std::vector<MatchRegion> findMatchingRegions(
   return matchingRegions;
 }
 
+// Memory-bounded image template matching: the image is processed in
+// overlapping horizontal bands (each one extended by the template height) so
+// that only the bands being processed are expanded and only regions reaching
+// the similarity threshold are kept
+std::vector<MatchRegion> findMatchingRegionsTiled(
+  const std::wstring& imagePath,
+  const std::vector<std::vector<Color>>& subImage,
+  const double& minSimilarityThresholdFactor,
+  int bandHeight
+) {
+  Gdiplus::GdiplusStartupInput gdiplusStartupInput;
+  ULONG_PTR gdiplusToken;
+  Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, nullptr);
+
+  Gdiplus::Bitmap* bitmap = Gdiplus::Bitmap::FromFile(imagePath.c_str());
+  if (!bitmap || bitmap->GetLastStatus() != Gdiplus::Ok) {
+    delete bitmap;
+    Gdiplus::GdiplusShutdown(gdiplusToken);
+    throw std::runtime_error("Failed to load PNG file.");
+  }
+
+  int imageWidth = bitmap->GetWidth();
+  int imageHeight = bitmap->GetHeight();
+  int subImageWidth = subImage[0].size();
+  int subImageHeight = subImage.size();
+
+  if (imageHeight < subImageHeight || imageWidth < subImageWidth) {
+    delete bitmap;
+    Gdiplus::GdiplusShutdown(gdiplusToken);
+    return {};
+  }
+
+  int commonWidth = imageWidth - subImageWidth + 1;
+  int commonHeight = imageHeight - subImageHeight + 1;
+  int matchablePixels = subImageWidth * subImageHeight;
+  int perfectSimilarity = (3 * 255) * matchablePixels;
+  int bandCount = (commonHeight + bandHeight - 1) / bandHeight;
+
+  std::vector<MatchRegion> matchingRegions;
+  std::mutex matchingRegionsMutex;
+  std::mutex bitmapMutex;
+  int numThreads = std::min<int>(std::max(1u, std::thread::hardware_concurrency()), bandCount);
+  std::vector<std::thread> threads;
+  std::atomic<int> nextBand(0);
+  // Set when a band could not be read, which stops the other threads
+  std::atomic<bool> hasFailed(false);
+
+  for (int i = 0; i < numThreads; ++i) {
+    threads.emplace_back([&] {
+      int band;
+      while (!hasFailed.load() && (band = nextBand.fetch_add(1)) < bandCount) {
+        int startY = band * bandHeight;
+        int endY = std::min(startY + bandHeight, commonHeight);
+        int bandRows = endY - startY;
+        int bandImageHeight = bandRows + subImageHeight - 1;
+
+        // Expand the band rows plus the template height overlap
+        std::vector<std::vector<Color>> bandImage(bandImageHeight, std::vector<Color>(imageWidth));
+        {
+          std::lock_guard<std::mutex> lock(bitmapMutex);
+          Gdiplus::BitmapData bitmapData;
+          Gdiplus::Rect rect(0, startY, imageWidth, bandImageHeight);
+          if (bitmap->LockBits(&rect, Gdiplus::ImageLockModeRead, PixelFormat32bppARGB, &bitmapData) != Gdiplus::Ok) {
+            hasFailed = true;
+            return;
+          }
+          for (int y = 0; y < bandImageHeight; y++) {
+            const UINT32* row = reinterpret_cast<const UINT32*>(static_cast<const BYTE*>(bitmapData.Scan0) + y * bitmapData.Stride);
+            for (int x = 0; x < imageWidth; x++) {
+              UINT32 colorValue = row[x];
+              Color& pixelColor = bandImage[y][x];
+              pixelColor.red = (colorValue >> 16) & 0xFF;
+              pixelColor.green = (colorValue >> 8) & 0xFF;
+              pixelColor.blue = colorValue & 0xFF;
+              pixelColor.alpha = (colorValue >> 24) & 0xFF;
+            }
+          }
+          bitmap->UnlockBits(&bitmapData);
+        }
+
+        std::vector<MatchRegion> bandRegions(commonWidth * bandRows);
+        computeSimilarityChunk(bandImage, subImage, bandRegions, 0, bandRows, commonWidth, bandRows, subImageWidth, subImageHeight, perfectSimilarity, minSimilarityThresholdFactor);
+
+        // Keep only relevant regions, translated back to image coordinates
+        std::vector<MatchRegion> keptRegions;
+        for (MatchRegion& region : bandRegions) {
+          if (region.similarity >= minSimilarityThresholdFactor) {
+            region.position.y += startY;
+            keptRegions.push_back(region);
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(matchingRegionsMutex);
+        matchingRegions.insert(matchingRegions.end(), keptRegions.begin(), keptRegions.end());
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  delete bitmap;
+  Gdiplus::GdiplusShutdown(gdiplusToken);
+
+  // Skipped bands would be reported as having no match
+  if (hasFailed.load()) {
+    throw std::runtime_error("Failed to read PNG file pixels.");
+  }
+
+  std::sort(std::execution::par_unseq, matchingRegions.begin(), matchingRegions.end(), [](const MatchRegion& a, const MatchRegion& b) {
+    return a.similarity > b.similarity;
+  });
+
+  return matchingRegions;
+}
+
 // JS wrapper for image template matching
 Napi::Value findImageTemplateMatches(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
@@ -1807,6 +7336,10 @@ Napi::Value findImageTemplateMatches(const Napi::CallbackInfo& info) {
     Napi::TypeError::New(env, "Expected a number as the third argument").ThrowAsJavaScriptException();
     return env.Null();
   }
+  if (info.Length() > 3 && !info[3].IsUndefined() && !info[3].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a number as the fourth argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
   // Translate JS input to C++ input
   std::u16string u16imagePath = info[0].As<Napi::String>().Utf16Value();
@@ -1814,14 +7347,21 @@ Napi::Value findImageTemplateMatches(const Napi::CallbackInfo& info) {
   std::u16string u16subImagePath = info[1].As<Napi::String>().Utf16Value();
   std::wstring subImagePath = std::wstring(u16subImagePath.begin(), u16subImagePath.end());
   float minSimilarityThresholdFactor = info[2].As<Napi::Number>().FloatValue();
+  int bandHeight = info.Length() > 3 && info[3].IsNumber() ? info[3].As<Napi::Number>().Int32Value() : 0;
 
   try {
     // Get pixel colors
-    std::vector<std::vector<Color>> image = GetPixelColorsFromPng(imagePath);
     std::vector<std::vector<Color>> subImage = GetPixelColorsFromPng(subImagePath);
 
     // Find matching regions
-    std::vector<MatchRegion> matchingRegions = findMatchingRegions(image, subImage, minSimilarityThresholdFactor);
+    std::vector<MatchRegion> matchingRegions;
+    if (bandHeight > 0) {
+      matchingRegions = findMatchingRegionsTiled(imagePath, subImage, minSimilarityThresholdFactor, bandHeight);
+    }
+    else {
+      std::vector<std::vector<Color>> image = GetPixelColorsFromPng(imagePath);
+      matchingRegions = findMatchingRegions(image, subImage, minSimilarityThresholdFactor);
+    }
 
     // Construct JS output (using ArrayBuffer for best performance)
     size_t numRegions = matchingRegions.size();
@@ -1870,44 +7410,8 @@ Napi::Value SetCursorPosWrapper(const Napi::CallbackInfo& info) {
   int x = info[0].As<Napi::Number>().Int32Value();
   int y = info[1].As<Napi::Number>().Int32Value();
 
-  // Virtual screen coordinates
-  int virtualScreenLeft = GetSystemMetrics(SM_XVIRTUALSCREEN);
-  int virtualScreenTop = GetSystemMetrics(SM_YVIRTUALSCREEN);
-  int virtualScreenWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-  int virtualScreenHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
-
-  // User coordinates relative to the main monitor (with origin in top-left corner at 0,0)
-  int relativeToMainMonitorX = x;
-  int relativeToMainMonitorY = y;
-
-  // Convert user coordinates to virtual screen coordinates
-  int virtualX = relativeToMainMonitorX - virtualScreenLeft;
-  int virtualY = relativeToMainMonitorY - virtualScreenTop;
-
-  // Double to int conversion will result in precision loss.
-  // Putting the coordinate 0.5 above its value will result in less loss.
-  double roundingOffsetMitigator = 0.5;
-
-  // Normalize the coordinates between 0 and 1
-  double normalizedX = (static_cast<double>(virtualX) + roundingOffsetMitigator) / static_cast<double>(virtualScreenWidth);
-  double normalizedY = (static_cast<double>(virtualY) + roundingOffsetMitigator) / static_cast<double>(virtualScreenHeight);
-
-  // Convert normalized coordinates to absolute coordinates between 0 and 65535.
-  // Windows will then reconvert the absolute coordinate to screen coordinates.
-  // It will result in loss of precision. Some pixels will thefore never be
-  // reachable by SendInput.
-  // There is no way around this. Using `setCursorPos` API is more precise but
-  // triggers no input events.
-  int absoluteX = static_cast<int>(std::round((normalizedX) * 65536.0));
-  int absoluteY = static_cast<int>(std::round((normalizedY) * 65536.0));
-
-
   // Prepare the INPUT structure
-  INPUT input = { 0 };
-  input.type = INPUT_MOUSE;
-  input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_VIRTUALDESK | MOUSEEVENTF_ABSOLUTE;
-  input.mi.dx = absoluteX;
-  input.mi.dy = absoluteY;
+  INPUT input = BuildMouseMoveInput(x, y);
 
   // Send the mouse move
   if (SendInput(1, &input, sizeof(INPUT)) == 0) {
@@ -2171,6 +7675,178 @@ Napi::Value MouseExtraButtonUp(const Napi::CallbackInfo& info) {
 }
 
 
+// Build the input sequence program of a smooth cursor motion: one move per
+// monitor refresh (or per requested step), on evenly spaced deadlines.
+// Positions repeating the previous one are merged into the next move.
+std::vector<int32_t> BuildCursorMotionProgram(const CursorMotion& motion, double refreshRate) {
+  const double dx = motion.to.x - motion.from.x;
+  const double dy = motion.to.y - motion.from.y;
+  const double distance = std::hypot(dx, dy);
+  const int64_t durationUs = std::llround(std::max(0.0, motion.durationMs) * 1000.0);
+  const size_t pointCount = motion.steps > 0
+    ? static_cast<size_t>(motion.steps) + 1
+    : std::max<size_t>(1, static_cast<size_t>(std::llround(motion.durationMs * refreshRate / 1000.0)));
+
+  // Unit vector perpendicular to the motion, on the mirrored side if requested
+  const double side = motion.isMirrored ? -1.0 : 1.0;
+  const double normalX = distance > 0 ? -dy / distance * side : 0;
+  const double normalY = distance > 0 ? dx / distance * side : 0;
+  const double amplitude = motion.curviness * distance;
+
+  std::mt19937 random(std::random_device{}());
+  std::uniform_real_distribution<double> unit(-1.0, 1.0);
+
+  // Wave half periods: by default an even count, at most one per 60 positions.
+  // A requested frequency is only capped so that every half period keeps at
+  // least two positions.
+  const long maxHalfWaves = static_cast<long>(pointCount / 60) - static_cast<long>(pointCount / 60) % 2;
+  const long maxRequestedHalfWaves = std::max(2L, static_cast<long>(pointCount / 2));
+  const long halfWaves = motion.frequency > 0
+    ? std::max(2L, std::min(maxRequestedHalfWaves, std::lround(motion.frequency * 2)))
+    : std::max(2L, maxHalfWaves);
+
+  // Human-like control points, a third and two thirds along the motion
+  const double humanOffset1 = amplitude * (0.5 + 0.5 * std::abs(unit(random)));
+  const double humanOffset2 = amplitude * unit(random) * 0.5;
+
+  std::vector<int32_t> program;
+  program.reserve(pointCount * INPUT_SEQUENCE_RECORD_SIZE);
+  int32_t previousX = motion.from.x;
+  int32_t previousY = motion.from.y;
+  int64_t previousTimeUs = 0;
+  for (size_t point = 1; point <= pointCount; point++) {
+    const bool isLast = point == pointCount;
+    const double t = static_cast<double>(point) / static_cast<double>(pointCount);
+    double x = motion.from.x + t * dx;
+    double y = motion.from.y + t * dy;
+    switch (motion.curve) {
+      case CursorMotionCurve::Linear:
+        break;
+      case CursorMotionCurve::Arc: {
+        // Control point above the middle of the motion: the curve peaks at half its height
+        const double offset = 2.0 * t * (1.0 - t) * amplitude;
+        x += normalX * offset;
+        y += normalY * offset;
+        break;
+      }
+      case CursorMotionCurve::Wave: {
+        const double offset = std::sin(t * std::acos(-1.0) * halfWaves) * amplitude / 2.0;
+        x -= normalX * offset;
+        y -= normalY * offset;
+        break;
+      }
+      case CursorMotionCurve::Human: {
+        // Minimum-jerk timing: slow start, fast middle, slow end
+        const double s = t * t * t * (10.0 - 15.0 * t + 6.0 * t * t);
+        const double u = 1.0 - s;
+        const double offset = 3.0 * u * u * s * humanOffset1 + 3.0 * u * s * s * humanOffset2;
+        x = motion.from.x + s * dx + normalX * offset;
+        y = motion.from.y + s * dy + normalY * offset;
+        break;
+      }
+    }
+    if (!isLast && motion.jitter > 0) {
+      x += unit(random) * motion.jitter;
+      y += unit(random) * motion.jitter;
+    }
+
+    const int32_t roundedX = isLast ? motion.to.x : static_cast<int32_t>(std::lround(x));
+    const int32_t roundedY = isLast ? motion.to.y : static_cast<int32_t>(std::lround(y));
+    if (!isLast && roundedX == previousX && roundedY == previousY) {
+      continue;
+    }
+    const int64_t timeUs = durationUs * static_cast<int64_t>(point) / static_cast<int64_t>(pointCount);
+    program.insert(program.end(), {
+      static_cast<int32_t>(InputSequenceOpcode::Move),
+      roundedX,
+      roundedY,
+      static_cast<int32_t>(std::min<int64_t>(timeUs - previousTimeUs, INT32_MAX))
+    });
+    previousX = roundedX;
+    previousY = roundedY;
+    previousTimeUs = timeUs;
+  }
+  return program;
+}
+
+// Read the smooth cursor motion options given to moveCursorSmoothly
+bool ParseCursorMotion(Napi::Env env, Napi::Object options, CursorMotion& motion) {
+  auto readNumber = [&options](const char* name, double& value) {
+    Napi::Value jsValue = options.Get(name);
+    if (jsValue.IsUndefined()) {
+      return true;
+    }
+    if (!jsValue.IsNumber() || !std::isfinite(jsValue.As<Napi::Number>().DoubleValue())) {
+      return false;
+    }
+    value = jsValue.As<Napi::Number>().DoubleValue();
+    return true;
+  };
+
+  double fromX = 0, fromY = 0, toX = 0, toY = 0, steps = 0;
+  motion.durationMs = -1;
+  if (
+    !readNumber("fromX", fromX) || !readNumber("fromY", fromY)
+    || !readNumber("toX", toX) || !readNumber("toY", toY)
+    || !readNumber("duration", motion.durationMs) || motion.durationMs < 0
+  ) {
+    Napi::TypeError::New(env, "Cursor motion \"fromX\", \"fromY\", \"toX\", \"toY\" and \"duration\" must be finite numbers, duration being positive").ThrowAsJavaScriptException();
+    return false;
+  }
+  motion.from = { static_cast<int>(std::lround(fromX)), static_cast<int>(std::lround(fromY)) };
+  motion.to = { static_cast<int>(std::lround(toX)), static_cast<int>(std::lround(toY)) };
+
+  Napi::Value curve = options.Get("motion");
+  std::string curveName = curve.IsString() ? curve.As<Napi::String>().Utf8Value() : "linear";
+  if (curveName == "linear") motion.curve = CursorMotionCurve::Linear;
+  else if (curveName == "arc") motion.curve = CursorMotionCurve::Arc;
+  else if (curveName == "wave") motion.curve = CursorMotionCurve::Wave;
+  else if (curveName == "human") motion.curve = CursorMotionCurve::Human;
+  else {
+    Napi::TypeError::New(env, "Cursor motion must be one of: linear, arc, wave, human").ThrowAsJavaScriptException();
+    return false;
+  }
+
+  if (
+    !readNumber("curviness", motion.curviness) || motion.curviness < 0 || motion.curviness > 1
+    || !readNumber("frequency", motion.frequency) || motion.frequency < 0
+    || !readNumber("jitter", motion.jitter) || motion.jitter < 0
+    || !readNumber("steps", steps) || steps < 0 || steps > 1000000
+  ) {
+    Napi::TypeError::New(env, "Invalid cursor motion options").ThrowAsJavaScriptException();
+    return false;
+  }
+  motion.steps = static_cast<unsigned int>(steps);
+  motion.isMirrored = options.Get("mirror").ToBoolean().Value();
+  return true;
+}
+
+// Move the cursor along a smooth path, one position per monitor refresh by
+// default. Positions are sent by the input sequencer on precise deadlines.
+Napi::Value MoveCursorSmoothlyWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected cursor motion options").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  CursorMotion motion;
+  if (!ParseCursorMotion(env, info[0].As<Napi::Object>(), motion)) {
+    return env.Null();
+  }
+
+  try {
+    double refreshRate = motion.steps > 0 ? 0 : GetRefreshRate(motion.from.x, motion.from.y);
+    return SubmitInputSequence(env, BuildCursorMotionProgram(motion, refreshRate));
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+
 // =============================================================================
 // ============================ KEYBOARD FUNCTIONS =============================
 // =============================================================================
@@ -2228,168 +7904,95 @@ Napi::Value KeyPressUp(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
-  return env.Undefined();
+  return env.Undefined();
+}
+
+// Type a text on the sequencer thread (see InputSequencer::type), waiting the
+// interval before each character. The returned promise resolves once the text
+// has been typed.
+Napi::Value TypeTextWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  // Validate arguments
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a text as a string argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "Expected an interval in microseconds (number)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int64_t interval = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().Int64Value() : 0;
+  if (interval < 0) {
+    Napi::RangeError::New(env, "Interval must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::u16string u16string = info[0].As<Napi::String>().Utf16Value();
+  std::wstring text = std::wstring(u16string.begin(), u16string.end());
+
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  if (text.empty()) {
+    deferred.Resolve(env.Undefined());
+    return deferred.Promise();
+  }
+  inputSequencer.submitText(std::move(text), std::chrono::microseconds(interval), SettleInputSequence(env, deferred));
+  return deferred.Promise();
+}
+
+// =============================================================================
+// ========================= INPUT SEQUENCE FUNCTIONS ==========================
+// =============================================================================
+
+// Copy an input sequence program (see InputSequenceOpcode) after validating it
+bool ParseInputSequence(Napi::Env env, Napi::Value value, std::vector<int32_t>& program) {
+  if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_int32_array) {
+    Napi::TypeError::New(env, "Expected an Int32Array input sequence").ThrowAsJavaScriptException();
+    return false;
+  }
+  Napi::Int32Array records = value.As<Napi::Int32Array>();
+  if (records.ElementLength() % INPUT_SEQUENCE_RECORD_SIZE != 0) {
+    Napi::TypeError::New(env, "Input sequence length must be a multiple of " + std::to_string(INPUT_SEQUENCE_RECORD_SIZE)).ThrowAsJavaScriptException();
+    return false;
+  }
+  program.assign(records.Data(), records.Data() + records.ElementLength());
+  for (size_t i = 0; i < program.size(); i += INPUT_SEQUENCE_RECORD_SIZE) {
+    int32_t opcode = program[i];
+    int32_t argument = program[i + 1];
+    bool isButton = opcode == static_cast<int32_t>(InputSequenceOpcode::ButtonDown) || opcode == static_cast<int32_t>(InputSequenceOpcode::ButtonUp);
+    bool isValid = (
+      opcode >= static_cast<int32_t>(InputSequenceOpcode::Move)
+      && opcode <= static_cast<int32_t>(InputSequenceOpcode::KeyUp)
+      && (!isButton || (argument >= 1 && argument <= 5))
+      && program[i + 3] >= 0
+    );
+    if (!isValid) {
+      Napi::TypeError::New(env, "Invalid input sequence event at index " + std::to_string(i / INPUT_SEQUENCE_RECORD_SIZE)).ThrowAsJavaScriptException();
+      return false;
+    }
+  }
+  return true;
 }
 
-unsigned int SendUnicodeCharacterWithModifiers(const std::wstring& grapheme) {
-  // Handle surrogate pairs (unicode multi-parts grapheme characters)
-  if (grapheme.size() > 1) {
-
-    std::vector<INPUT> input(grapheme.size(), {0});
-    for (int i = 0; i < grapheme.size(); i++) {
-      wchar_t character = grapheme[i];
-      input[i].type = INPUT_KEYBOARD;
-      input[i].ki.wScan = character;
-      input[i].ki.dwFlags = KEYEVENTF_UNICODE;
-    }
-    // SendInput allow only 32 inputs at a time
-    for (int i = 0; i < grapheme.size(); i += 32) {
-      int sendAmount = grapheme.size() - i > 32 ? 32 : grapheme.size() - i;
-      if (SendInput(sendAmount, &input[i], sizeof(INPUT)) == 0) {
-        return 0;
-      }
-    }
-    for (int i = 0; i < grapheme.size(); i++) {
-      input[i].ki.dwFlags = KEYEVENTF_KEYUP;
-    }
-    // SendInput allow only 32 inputs at a time
-    for (int i = 0; i < grapheme.size(); i += 32) {
-      int sendAmount = grapheme.size() - i > 32 ? 32 : grapheme.size() - i;
-      if (SendInput(sendAmount, &input[i], sizeof(INPUT)) == 0) {
-        return 0;
-      }
-    }
-    return 1;
-    wchar_t highSurrogate = grapheme[0];
-    wchar_t lowSurrogate = grapheme[1];
-
-    // Send high surrogate
-    INPUT inputHigh = {0};
-    inputHigh.type = INPUT_KEYBOARD;
-    inputHigh.ki.wScan = highSurrogate;
-    inputHigh.ki.dwFlags = KEYEVENTF_UNICODE; // Unicode flag for the high surrogate
-    SendInput(1, &inputHigh, sizeof(INPUT));
-
-    // Send low surrogate
-    INPUT inputLow = {0};
-    inputLow.type = INPUT_KEYBOARD;
-    inputLow.ki.wScan = lowSurrogate;
-    inputLow.ki.dwFlags = KEYEVENTF_UNICODE; // Unicode flag for the low surrogate
-    SendInput(1, &inputLow, sizeof(INPUT));
-
-    // Release both surrogates
-    inputHigh.ki.dwFlags = KEYEVENTF_KEYUP;
-    inputLow.ki.dwFlags = KEYEVENTF_KEYUP;
-    SendInput(1, &inputHigh, sizeof(INPUT));
-    return SendInput(1, &inputLow, sizeof(INPUT));
-  }
-  // Handle simple unicode character
-
-  // Get the virtual key and modifiers
-  SHORT vk = VkKeyScanEx(grapheme[0], GetKeyboardLayout(0));
-  if (vk == -1) {
-    INPUT input = {0};
-    input.type = INPUT_KEYBOARD;
-
-    // Convert the character to a virtual key code and scan code
-    input.ki.wScan = grapheme[0];
-    input.ki.dwFlags = KEYEVENTF_UNICODE;
-
-    // Press the key
-    SendInput(1, &input, sizeof(INPUT));
-
-    // Release the key
-    input.ki.dwFlags = KEYEVENTF_KEYUP;
-    return SendInput(1, &input, sizeof(INPUT));
-  }
-  BYTE virtualKey = LOBYTE(vk);  // Extract the virtual key
-  BYTE modifiers = HIBYTE(vk);  // Extract the modifiers
-
-  INPUT input[6] = { 0 };
-  int inputIndex = 0;
-
-  // Handle modifiers
-  if (modifiers & 0x01) {  // Shift
-    input[inputIndex].type = INPUT_KEYBOARD;
-    input[inputIndex].ki.wScan = MapVirtualKey(VK_SHIFT, MAPVK_VK_TO_VSC); // Shift key
-    input[inputIndex].ki.dwFlags = KEYEVENTF_SCANCODE;  // Key down
-    inputIndex++;
-  }
-  if (modifiers & 0x02) {  // Ctrl
-    input[inputIndex].type = INPUT_KEYBOARD;
-    input[inputIndex].ki.wScan = MapVirtualKey(VK_CONTROL, MAPVK_VK_TO_VSC); // Ctrl key
-    input[inputIndex].ki.dwFlags = KEYEVENTF_SCANCODE;  // Key down
-    inputIndex++;
-  }
-  if (modifiers & 0x04) {  // Alt
-    input[inputIndex].type = INPUT_KEYBOARD;
-    input[inputIndex].ki.wScan = MapVirtualKey(VK_MENU, MAPVK_VK_TO_VSC); // Alt key
-    input[inputIndex].ki.dwFlags = KEYEVENTF_SCANCODE;  // Key down
-    inputIndex++;
-  }
-
-  // Main key press
-  input[inputIndex].type = INPUT_KEYBOARD;
-  input[inputIndex].ki.wScan = MapVirtualKey(virtualKey, MAPVK_VK_TO_VSC); // Main key
-  input[inputIndex].ki.dwFlags = KEYEVENTF_SCANCODE;  // Key down
-  inputIndex++;
-
-  // Key release
-  input[inputIndex].type = INPUT_KEYBOARD;
-  input[inputIndex].ki.wScan = MapVirtualKey(virtualKey, MAPVK_VK_TO_VSC);
-  input[inputIndex].ki.dwFlags = KEYEVENTF_SCANCODE | KEYEVENTF_KEYUP;
-  inputIndex++;
-
-  // Release modifiers
-  if (modifiers & 0x04) {  // Alt
-    input[inputIndex].type = INPUT_KEYBOARD;
-    input[inputIndex].ki.wScan = MapVirtualKey(VK_MENU, MAPVK_VK_TO_VSC);
-    input[inputIndex].ki.dwFlags =  KEYEVENTF_SCANCODE | KEYEVENTF_KEYUP;  // Key up
-    inputIndex++;
-  }
-  if (modifiers & 0x02) {  // Ctrl
-    input[inputIndex].type = INPUT_KEYBOARD;
-    input[inputIndex].ki.wScan = MapVirtualKey(VK_CONTROL, MAPVK_VK_TO_VSC);
-    input[inputIndex].ki.dwFlags =  KEYEVENTF_SCANCODE | KEYEVENTF_KEYUP;  // Key up
-    inputIndex++;
-  }
-  if (modifiers & 0x01) {  // Shift
-    input[inputIndex].type = INPUT_KEYBOARD;
-    input[inputIndex].ki.wScan = MapVirtualKey(VK_SHIFT, MAPVK_VK_TO_VSC);
-    input[inputIndex].ki.dwFlags =  KEYEVENTF_SCANCODE | KEYEVENTF_KEYUP;  // Key up
-    inputIndex++;
-  }
-
-  // Send the inputs
-  return SendInput(inputIndex, input, sizeof(INPUT));
-}
-
-Napi::Value TypeUnicodeCharacter(const Napi::CallbackInfo& info) {
+// Send an input sequence program on the sequencer thread. The returned promise
+// resolves once every event has been sent.
+Napi::Value SendInputSequenceWrapper(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
   // Validate arguments
-  if (info.Length() < 1 || !info[0].IsString()) {
-    Napi::TypeError::New(env, "Expected a character as a string argument").ThrowAsJavaScriptException();
-    return env.Null();
-  }
-
-  std::u16string u16string = info[0].As<Napi::String>().Utf16Value();
-  std::wstring character = std::wstring(u16string.begin(), u16string.end());
-
-  if (character.size() < 1) {
-    Napi::TypeError::New(env, ConvertToUTF8(character) + " is not a valid unicode character").ThrowAsJavaScriptException();
+  if (info.Length() < 1) {
+    Napi::TypeError::New(env, "Expected an Int32Array input sequence").ThrowAsJavaScriptException();
     return env.Null();
   }
-
-  unsigned int result = SendUnicodeCharacterWithModifiers(character);
-  if (result == 0) {
-    Napi::Error::New(env, "Failed to type character: " + ConvertToUTF8(character)).ThrowAsJavaScriptException();
+  std::vector<int32_t> program;
+  if (!ParseInputSequence(env, info[0], program)) {
     return env.Null();
   }
 
-  return env.Undefined();
+  return SubmitInputSequence(env, std::move(program));
 }
 
+
 // Function to copy a std::wstring to the clipboard
 bool CopyToClipboard(const std::wstring& text) {
   // Open the clipboard
@@ -2834,6 +8437,545 @@ Napi::Value TakeScreenshotToFileWrapper(const Napi::CallbackInfo& info) {
   return Napi::Boolean::New(env, success);
 }
 
+// Map an image format name to its GDI+ encoder MIME type
+std::wstring ParseImageFormat(const std::string& format) {
+  std::string lowerFormat = ToLower(format);
+  if (lowerFormat == "png") return L"image/png";
+  if (lowerFormat == "jpeg" || lowerFormat == "jpg") return L"image/jpeg";
+  if (lowerFormat == "bmp") return L"image/bmp";
+  throw std::runtime_error("Unsupported image format: " + format);
+}
+
+// Capture a single monitor on its own device context, then scale and encode it
+// (GDI+ must already be initialized by the caller)
+void CaptureMonitor(MonitorCapture& capture) {
+  capture.isCaptured = false;
+
+  // DPI awareness is per thread: match the coordinates of the main thread
+  ActivateDpiAwareness();
+
+  HDC hScreenDC = GetDC(nullptr);
+  if (!hScreenDC) return;
+
+  HDC hMemoryDC = CreateCompatibleDC(hScreenDC);
+  HBITMAP hBitmap = hMemoryDC ? CreateCompatibleBitmap(hScreenDC, capture.width, capture.height) : nullptr;
+  if (!hBitmap) {
+    if (hMemoryDC) {
+      DeleteDC(hMemoryDC);
+    }
+    ReleaseDC(nullptr, hScreenDC);
+    return;
+  }
+
+  HBITMAP hOldBitmap = (HBITMAP)SelectObject(hMemoryDC, hBitmap);
+  bool isCopied = BitBlt(hMemoryDC, 0, 0, capture.width, capture.height, hScreenDC, capture.x, capture.y, SRCCOPY);
+  SelectObject(hMemoryDC, hOldBitmap);
+
+  CLSID clsid;
+  if (isCopied && GetEncoderClsid(capture.mimeType.c_str(), &clsid)) {
+    Gdiplus::Bitmap bitmap(hBitmap, nullptr);
+
+    int scaledWidth = std::max(1, static_cast<int>(capture.width * capture.scale));
+    int scaledHeight = std::max(1, static_cast<int>(capture.height * capture.scale));
+    Gdiplus::Bitmap scaledBitmap(scaledWidth, scaledHeight, bitmap.GetPixelFormat());
+    Gdiplus::Graphics graphics(&scaledBitmap);
+    graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
+    graphics.DrawImage(&bitmap, 0, 0, scaledWidth, scaledHeight);
+
+    if (!capture.filepath.empty()) {
+      capture.isCaptured = scaledBitmap.Save(capture.filepath.c_str(), &clsid, nullptr) == Gdiplus::Status::Ok;
+    }
+    else {
+      IStream* stream = nullptr;
+      if (CreateStreamOnHGlobal(nullptr, TRUE, &stream) == S_OK) {
+        HGLOBAL hGlobal = nullptr;
+        if (
+          scaledBitmap.Save(stream, &clsid, nullptr) == Gdiplus::Status::Ok
+          && GetHGlobalFromStream(stream, &hGlobal) == S_OK
+        ) {
+          STATSTG streamStat;
+          stream->Stat(&streamStat, STATFLAG_NONAME);
+          const uint8_t* bytes = static_cast<const uint8_t*>(GlobalLock(hGlobal));
+          if (bytes) {
+            capture.data.assign(bytes, bytes + streamStat.cbSize.QuadPart);
+            GlobalUnlock(hGlobal);
+            capture.isCaptured = true;
+          }
+        }
+        stream->Release();
+      }
+    }
+  }
+
+  DeleteObject(hBitmap);
+  DeleteDC(hMemoryDC);
+  ReleaseDC(nullptr, hScreenDC);
+}
+
+// Capture all requested monitors in parallel (one worker per monitor)
+std::vector<MonitorCapture> CaptureMonitors(std::vector<MonitorCapture> captures) {
+  Gdiplus::GdiplusStartupInput gdiplusStartupInput;
+  ULONG_PTR gdiplusToken;
+  if (Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, nullptr) != Gdiplus::Ok) {
+    throw std::runtime_error("Failed to initialize GDI+.");
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve(captures.size());
+
+  for (MonitorCapture& capture : captures) {
+    threads.emplace_back(CaptureMonitor, std::ref(capture));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  Gdiplus::GdiplusShutdown(gdiplusToken);
+
+  return captures;
+}
+
+Napi::Value CaptureMonitorsWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of monitor capture options as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  try {
+    std::vector<MonitorInfo> monitors;
+    EnumDisplayMonitors(nullptr, nullptr, MonitorEnumProc, reinterpret_cast<LPARAM>(&monitors));
+    std::vector<MonitorCapture> captures;
+
+    auto addCapture = [&](int id, float scale, const std::wstring& mimeType, const std::wstring& filepath) {
+      auto monitor = std::find_if(monitors.begin(), monitors.end(), [id](const MonitorInfo& monitor) { return monitor.id == id; });
+      if (monitor == monitors.end()) {
+        throw std::runtime_error("Monitor not found: " + std::to_string(id));
+      }
+      captures.push_back({
+        id,
+        monitor->originX,
+        monitor->originY,
+        monitor->width,
+        monitor->height,
+        scale > 0 ? scale : 1.0f,
+        mimeType,
+        filepath,
+        {},
+        false
+      });
+    };
+
+    // Translate JS input to C++ input (all monitors when unset)
+    if (info.Length() > 0 && info[0].IsArray()) {
+      Napi::Array jsCaptures = info[0].As<Napi::Array>();
+      for (uint32_t i = 0; i < jsCaptures.Length(); i++) {
+        Napi::Value jsCaptureValue = jsCaptures.Get(i);
+        if (!jsCaptureValue.IsObject()) {
+          Napi::TypeError::New(env, "Each monitor capture option must be an object").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        Napi::Object jsCapture = jsCaptureValue.As<Napi::Object>();
+        if (!jsCapture.Get("id").IsNumber()) {
+          Napi::TypeError::New(env, "Each monitor capture option must have a numeric id").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        int id = jsCapture.Get("id").As<Napi::Number>().Int32Value();
+        float scale = jsCapture.Get("scale").IsNumber() ? jsCapture.Get("scale").As<Napi::Number>().FloatValue() : 1.0f;
+        std::wstring mimeType = jsCapture.Get("format").IsString() ? ParseImageFormat(jsCapture.Get("format").As<Napi::String>().Utf8Value()) : L"image/png";
+        std::wstring filepath;
+        if (jsCapture.Get("filepath").IsString()) {
+          std::u16string u16Filepath = jsCapture.Get("filepath").As<Napi::String>().Utf16Value();
+          filepath = std::wstring(u16Filepath.begin(), u16Filepath.end());
+        }
+        addCapture(id, scale, mimeType, filepath);
+      }
+    }
+    else {
+      for (const MonitorInfo& monitor : monitors) {
+        addCapture(monitor.id, 1.0f, L"image/png", L"");
+      }
+    }
+
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    auto asyncWorker = new PromiseWorker<std::vector<MonitorCapture>>(
+      env,
+      deferred,
+      [captures]() -> std::vector<MonitorCapture> {
+        return CaptureMonitors(captures);
+      },
+      [](Napi::Env env, const std::vector<MonitorCapture>& captures) -> Napi::Value {
+        Napi::Array result = Napi::Array::New(env, captures.size());
+        for (size_t i = 0; i < captures.size(); i++) {
+          const MonitorCapture& capture = captures[i];
+          Napi::Object jsCapture = Napi::Object::New(env);
+          jsCapture.Set("id", Napi::Number::New(env, capture.id));
+          jsCapture.Set("captured", Napi::Boolean::New(env, capture.isCaptured));
+          if (capture.filepath.empty()) {
+            jsCapture.Set("data", Napi::Buffer<uint8_t>::Copy(env, capture.data.data(), capture.data.size()));
+          }
+          result.Set(i, jsCapture);
+        }
+        return result;
+      }
+    );
+    asyncWorker->Queue();
+    return deferred.Promise();
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value StartScreenRecordingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected an options object as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  if (!options.Get("filepath").IsString() || !options.Get("x").IsNumber() || !options.Get("y").IsNumber() || !options.Get("width").IsNumber() || !options.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "Options must contain: filepath, x, y, width, height").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input to C++ input
+  std::u16string u16Filepath = options.Get("filepath").As<Napi::String>().Utf16Value();
+  std::wstring filepath = std::wstring(u16Filepath.begin(), u16Filepath.end());
+  HWND windowId = options.Get("windowId").IsNumber() ? reinterpret_cast<HWND>(static_cast<intptr_t>(options.Get("windowId").As<Napi::Number>().Int64Value())) : nullptr;
+  int x = options.Get("x").As<Napi::Number>().Int32Value();
+  int y = options.Get("y").As<Napi::Number>().Int32Value();
+  int width = options.Get("width").As<Napi::Number>().Int32Value();
+  int height = options.Get("height").As<Napi::Number>().Int32Value();
+  double fps = options.Get("fps").IsNumber() ? options.Get("fps").As<Napi::Number>().DoubleValue() : 30.0;
+  std::string codecName = options.Get("codec").IsString() ? options.Get("codec").As<Napi::String>().Utf8Value() : "lz4";
+  int compressionLevel = options.Get("compressionLevel").IsNumber() ? options.Get("compressionLevel").As<Napi::Number>().Int32Value() : 1;
+  uint32_t keyframeInterval = options.Get("keyframeInterval").IsNumber()
+    ? options.Get("keyframeInterval").As<Napi::Number>().Uint32Value()
+    : static_cast<uint32_t>(std::max(1.0, std::round(fps * 2)));
+
+  if (fps <= 0) {
+    Napi::TypeError::New(env, "FPS must be a positive number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (codecName != "lz4" && codecName != "zstd") {
+    Napi::TypeError::New(env, "Codec must be \"lz4\" or \"zstd\"").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  FrameCodec codec = codecName == "zstd" ? FrameCodec::Zstd : FrameCodec::Lz4;
+
+  try {
+    auto source = std::make_unique<ScreenFrameSource>(windowId, x, y, width, height);
+    auto recorder = std::make_shared<ScreenRecorder>(std::move(source), filepath, fps, codec, compressionLevel, keyframeInterval);
+
+    std::lock_guard<std::mutex> lock(screenRecordersMutex);
+    int recorderId = nextScreenRecorderId++;
+    screenRecorders.emplace(recorderId, recorder);
+    return Napi::Number::New(env, recorderId);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value StopScreenRecordingWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a recorder ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int recorderId = info[0].As<Napi::Number>().Int32Value();
+
+  std::shared_ptr<ScreenRecorder> recorder;
+  {
+    std::lock_guard<std::mutex> lock(screenRecordersMutex);
+    auto it = screenRecorders.find(recorderId);
+    if (it == screenRecorders.end()) {
+      Napi::Error::New(env, "Screen recorder not found: " + std::to_string(recorderId)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    recorder = it->second;
+    screenRecorders.erase(it);
+  }
+
+  // Flushing pending frames may take a while: do it off the main thread
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<ScreenRecordingStats>(
+    env,
+    deferred,
+    [recorder]() -> ScreenRecordingStats {
+      return recorder->stop();
+    },
+    [](Napi::Env env, const ScreenRecordingStats& stats) -> Napi::Value {
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("frames", Napi::Number::New(env, static_cast<double>(stats.frameCount)));
+      result.Set("droppedFrames", Napi::Number::New(env, static_cast<double>(stats.droppedFrameCount)));
+      result.Set("duration", Napi::Number::New(env, static_cast<double>(stats.durationMs)));
+      return result;
+    }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
+}
+
+Napi::Value ReadScreenRecordingFrameWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "Arguments must be: (filepath, frame index)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::u16string u16Filepath = info[0].As<Napi::String>().Utf16Value();
+  std::wstring filepath = std::wstring(u16Filepath.begin(), u16Filepath.end());
+  int64_t frameIndex = info[1].As<Napi::Number>().Int64Value();
+  if (frameIndex < 0) {
+    Napi::RangeError::New(env, "Frame index must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  try {
+    ScreenRecordingFrame frame = ReadScreenRecordingFrame(filepath, static_cast<uint64_t>(frameIndex));
+
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, frame.pixels.size());
+    std::memcpy(buffer.Data(), frame.pixels.data(), frame.pixels.size());
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("width", Napi::Number::New(env, frame.header.width));
+    result.Set("height", Napi::Number::New(env, frame.header.height));
+    result.Set("stride", Napi::Number::New(env, frame.header.stride));
+    result.Set("format", Napi::String::New(env, "bgra"));
+    result.Set("data", Napi::Uint8Array::New(env, frame.pixels.size(), buffer, 0));
+    result.Set("timestamp", Napi::Number::New(env, frame.timestampUs / 1000.0));
+    result.Set("frameCount", Napi::Number::New(env, static_cast<double>(frame.frameCount)));
+    result.Set("fps", Napi::Number::New(env, frame.header.fps));
+    return result;
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value StartFlightRecorderWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected an options object as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  if (!options.Get("x").IsNumber() || !options.Get("y").IsNumber() || !options.Get("width").IsNumber() || !options.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "Options must contain: x, y, width, height").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input to C++ input
+  HWND windowId = options.Get("windowId").IsNumber() ? reinterpret_cast<HWND>(static_cast<intptr_t>(options.Get("windowId").As<Napi::Number>().Int64Value())) : nullptr;
+  int x = options.Get("x").As<Napi::Number>().Int32Value();
+  int y = options.Get("y").As<Napi::Number>().Int32Value();
+  int width = options.Get("width").As<Napi::Number>().Int32Value();
+  int height = options.Get("height").As<Napi::Number>().Int32Value();
+  double fps = options.Get("fps").IsNumber() ? options.Get("fps").As<Napi::Number>().DoubleValue() : 10.0;
+  int64_t durationMs = options.Get("duration").IsNumber() ? options.Get("duration").As<Napi::Number>().Int64Value() : 10000;
+  int64_t memoryLimit = options.Get("memoryLimit").IsNumber() ? options.Get("memoryLimit").As<Napi::Number>().Int64Value() : 128 * 1024 * 1024;
+  uint32_t keyframeInterval = options.Get("keyframeInterval").IsNumber()
+    ? options.Get("keyframeInterval").As<Napi::Number>().Uint32Value()
+    : static_cast<uint32_t>(std::max(1.0, std::round(fps)));
+
+  if (fps <= 0 || durationMs <= 0 || memoryLimit <= 0) {
+    Napi::TypeError::New(env, "FPS, duration and memory limit must be positive numbers").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  try {
+    auto source = std::make_unique<ScreenFrameSource>(windowId, x, y, width, height);
+    auto recorder = std::make_shared<FlightRecorder>(std::move(source), fps, static_cast<uint64_t>(durationMs), static_cast<size_t>(memoryLimit), keyframeInterval);
+
+    std::lock_guard<std::mutex> lock(flightRecordersMutex);
+    int recorderId = nextFlightRecorderId++;
+    flightRecorders.emplace(recorderId, recorder);
+    return Napi::Number::New(env, recorderId);
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value DumpFlightRecorderWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsString()) {
+    Napi::TypeError::New(env, "Arguments must be: (recorder ID, filepath)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int recorderId = info[0].As<Napi::Number>().Int32Value();
+  std::u16string u16Filepath = info[1].As<Napi::String>().Utf16Value();
+  std::wstring filepath = std::wstring(u16Filepath.begin(), u16Filepath.end());
+
+  std::shared_ptr<FlightRecorder> recorder;
+  {
+    std::lock_guard<std::mutex> lock(flightRecordersMutex);
+    auto it = flightRecorders.find(recorderId);
+    if (it == flightRecorders.end()) {
+      Napi::Error::New(env, "Flight recorder not found: " + std::to_string(recorderId)).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    recorder = it->second;
+  }
+
+  // Writing the buffered frames to disk may take a while: do it off the main thread
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  auto asyncWorker = new PromiseWorker<ScreenRecordingStats>(
+    env,
+    deferred,
+    [recorder, filepath]() -> ScreenRecordingStats {
+      return recorder->dump(filepath);
+    },
+    [](Napi::Env env, const ScreenRecordingStats& stats) -> Napi::Value {
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("frames", Napi::Number::New(env, static_cast<double>(stats.frameCount)));
+      result.Set("droppedFrames", Napi::Number::New(env, static_cast<double>(stats.droppedFrameCount)));
+      result.Set("duration", Napi::Number::New(env, static_cast<double>(stats.durationMs)));
+      return result;
+    }
+  );
+  asyncWorker->Queue();
+  return deferred.Promise();
+}
+
+Napi::Value StopFlightRecorderWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a recorder ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int recorderId = info[0].As<Napi::Number>().Int32Value();
+
+  std::shared_ptr<FlightRecorder> recorder;
+  {
+    std::lock_guard<std::mutex> lock(flightRecordersMutex);
+    auto it = flightRecorders.find(recorderId);
+    if (it == flightRecorders.end()) {
+      return env.Undefined();
+    }
+    recorder = it->second;
+    flightRecorders.erase(it);
+  }
+  // Only waits for the frame being captured, if any
+  recorder->stop();
+  return env.Undefined();
+}
+
+Napi::Value StartScreenFrameFeedWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+    Napi::TypeError::New(env, "Arguments must be: (options, frame callback)").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object options = info[0].As<Napi::Object>();
+  if (!options.Get("x").IsNumber() || !options.Get("y").IsNumber() || !options.Get("width").IsNumber() || !options.Get("height").IsNumber()) {
+    Napi::TypeError::New(env, "Options must contain: x, y, width, height").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Translate JS input to C++ input
+  HWND windowId = options.Get("windowId").IsNumber() ? reinterpret_cast<HWND>(static_cast<intptr_t>(options.Get("windowId").As<Napi::Number>().Int64Value())) : nullptr;
+  int x = options.Get("x").As<Napi::Number>().Int32Value();
+  int y = options.Get("y").As<Napi::Number>().Int32Value();
+  int width = options.Get("width").As<Napi::Number>().Int32Value();
+  int height = options.Get("height").As<Napi::Number>().Int32Value();
+  double fps = options.Get("fps").IsNumber() ? options.Get("fps").As<Napi::Number>().DoubleValue() : 30.0;
+  int32_t slotCount = options.Get("slots").IsNumber() ? options.Get("slots").As<Napi::Number>().Int32Value() : 3;
+
+  if (fps <= 0) {
+    Napi::TypeError::New(env, "FPS must be a positive number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (slotCount < 2) {
+    Napi::TypeError::New(env, "Slots must be a number greater than or equal to 2").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  try {
+    auto source = std::make_unique<ScreenFrameSource>(windowId, x, y, width, height);
+
+    // Frames are written straight into a SharedArrayBuffer, kept alive by a reference
+    size_t memorySize = ScreenFrameFeed::requiredMemorySize(*source, static_cast<uint32_t>(slotCount));
+    Napi::Object sharedBuffer = env.Global().Get("SharedArrayBuffer").As<Napi::Function>().New({ Napi::Number::New(env, static_cast<double>(memorySize)) });
+    Napi::Uint8Array memory = env.Global().Get("Uint8Array").As<Napi::Function>().New({ sharedBuffer }).As<Napi::Uint8Array>();
+
+    // Called after each frame, so JS can wake up readers with Atomics.notify
+    Napi::ThreadSafeFunction onFrame = Napi::ThreadSafeFunction::New(
+      env,
+      info[1].As<Napi::Function>(),
+      "screenFrameFeed",
+      1, // pending notifications are coalesced
+      1
+    );
+    auto feed = std::make_shared<ScreenFrameFeed>(
+      std::move(source),
+      memory.Data(),
+      fps,
+      static_cast<uint32_t>(slotCount),
+      [onFrame]() {
+        onFrame.NonBlockingCall();
+      }
+    );
+
+    int feedId;
+    {
+      std::lock_guard<std::mutex> lock(screenFrameFeedsMutex);
+      feedId = nextScreenFrameFeedId++;
+      screenFrameFeeds.emplace(feedId, ScreenFrameFeedHandle{ feed, onFrame, Napi::Persistent(memory) });
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("id", Napi::Number::New(env, feedId));
+    result.Set("buffer", sharedBuffer);
+    return result;
+  }
+  catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+Napi::Value StopScreenFrameFeedWrapper(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a feed ID as the first argument").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  int feedId = info[0].As<Napi::Number>().Int32Value();
+
+  ScreenFrameFeedHandle handle;
+  {
+    std::lock_guard<std::mutex> lock(screenFrameFeedsMutex);
+    auto it = screenFrameFeeds.find(feedId);
+    if (it == screenFrameFeeds.end()) {
+      return env.Undefined();
+    }
+    handle = std::move(it->second);
+    screenFrameFeeds.erase(it);
+  }
+  // Only waits for the frame being captured, if any
+  handle.feed->stop();
+  handle.onFrame.Release();
+  handle.memory.Reset();
+  return env.Undefined();
+}
+
 // Function to take a screenshot of a specific window and save it to a file
 bool TakeWindowScreenshotToFile(
     HWND hwnd,
@@ -4435,10 +10577,28 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set(Napi::String::New(env, "mouseExtraButtonUp"), Napi::Function::New(env, MouseExtraButtonUp));
   exports.Set(Napi::String::New(env, "keyPressDown"), Napi::Function::New(env, KeyPressDown));
   exports.Set(Napi::String::New(env, "keyPressUp"), Napi::Function::New(env, KeyPressUp));
-  exports.Set(Napi::String::New(env, "typeUnicodeCharacter"), Napi::Function::New(env, TypeUnicodeCharacter));
+  exports.Set(Napi::String::New(env, "typeText"), Napi::Function::New(env, TypeTextWrapper));
   exports.Set(Napi::String::New(env, "getAvailableScreens"), Napi::Function::New(env, GetAvailableScreens));
   exports.Set(Napi::String::New(env, "startInputEventListener"), Napi::Function::New(env, StartInputEventListener));
   exports.Set(Napi::String::New(env, "stopInputEventListener"), Napi::Function::New(env, StopInputEventListener));
+  exports.Set(Napi::String::New(env, "setInputEventBatching"), Napi::Function::New(env, SetInputEventBatching));
+  exports.Set(Napi::String::New(env, "setInputEventFilter"), Napi::Function::New(env, SetInputEventFilter));
+  exports.Set(Napi::String::New(env, "startInputEventRing"), Napi::Function::New(env, StartInputEventRingWrapper));
+  exports.Set(Napi::String::New(env, "stopInputEventRing"), Napi::Function::New(env, StopInputEventRingWrapper));
+  exports.Set(Napi::String::New(env, "startInputRecording"), Napi::Function::New(env, StartInputRecordingWrapper));
+  exports.Set(Napi::String::New(env, "setInputRecordingPaused"), Napi::Function::New(env, SetInputRecordingPausedWrapper));
+  exports.Set(Napi::String::New(env, "stopInputRecording"), Napi::Function::New(env, StopInputRecordingWrapper));
+  exports.Set(Napi::String::New(env, "readInputRecording"), Napi::Function::New(env, ReadInputRecordingWrapper));
+  exports.Set(Napi::String::New(env, "startInputReplay"), Napi::Function::New(env, StartInputReplayWrapper));
+  exports.Set(Napi::String::New(env, "setInputReplayPaused"), Napi::Function::New(env, SetInputReplayPausedWrapper));
+  exports.Set(Napi::String::New(env, "seekInputReplay"), Napi::Function::New(env, SeekInputReplayWrapper));
+  exports.Set(Napi::String::New(env, "stopInputReplay"), Napi::Function::New(env, StopInputReplayWrapper));
+  exports.Set(Napi::String::New(env, "setInputStateTracking"), Napi::Function::New(env, SetInputStateTrackingWrapper));
+  exports.Set(Napi::String::New(env, "isKeyPressed"), Napi::Function::New(env, IsKeyPressedWrapper));
+  exports.Set(Napi::String::New(env, "isMouseButtonPressed"), Napi::Function::New(env, IsMouseButtonPressedWrapper));
+  exports.Set(Napi::String::New(env, "getCursorPosition"), Napi::Function::New(env, GetCursorPositionWrapper));
+  exports.Set(Napi::String::New(env, "registerHotkey"), Napi::Function::New(env, RegisterHotkeyWrapper));
+  exports.Set(Napi::String::New(env, "unregisterHotkey"), Napi::Function::New(env, UnregisterHotkeyWrapper));
   exports.Set(Napi::String::New(env, "startWindowEventListener"), Napi::Function::New(env, StartWindowEventListener));
   exports.Set(Napi::String::New(env, "stopWindowEventListener"), Napi::Function::New(env, StopWindowEventListener));
   exports.Set(Napi::String::New(env, "cleanResources"), Napi::Function::New(env, CleanupResources));
@@ -4457,13 +10617,35 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set(Napi::String::New(env, "getPixelColor"), Napi::Function::New(env, GetPixelColorWrapper));
   exports.Set(Napi::String::New(env, "takeScreenshotToFile"), Napi::Function::New(env, TakeScreenshotToFileWrapper));
   exports.Set(Napi::String::New(env, "takeWindowScreenshotToFile"), Napi::Function::New(env, TakeWindowScreenshotToFileWrapper));
+  exports.Set(Napi::String::New(env, "captureMonitors"), Napi::Function::New(env, CaptureMonitorsWrapper));
+  exports.Set(Napi::String::New(env, "startScreenRecording"), Napi::Function::New(env, StartScreenRecordingWrapper));
+  exports.Set(Napi::String::New(env, "stopScreenRecording"), Napi::Function::New(env, StopScreenRecordingWrapper));
+  exports.Set(Napi::String::New(env, "readScreenRecordingFrame"), Napi::Function::New(env, ReadScreenRecordingFrameWrapper));
+  exports.Set(Napi::String::New(env, "startFlightRecorder"), Napi::Function::New(env, StartFlightRecorderWrapper));
+  exports.Set(Napi::String::New(env, "dumpFlightRecorder"), Napi::Function::New(env, DumpFlightRecorderWrapper));
+  exports.Set(Napi::String::New(env, "stopFlightRecorder"), Napi::Function::New(env, StopFlightRecorderWrapper));
+  exports.Set(Napi::String::New(env, "startScreenFrameFeed"), Napi::Function::New(env, StartScreenFrameFeedWrapper));
+  exports.Set(Napi::String::New(env, "stopScreenFrameFeed"), Napi::Function::New(env, StopScreenFrameFeedWrapper));
   exports.Set(Napi::String::New(env, "copyTextToClipboard"), Napi::Function::New(env, CopyTextToClipboard));
   exports.Set(Napi::String::New(env, "copyFileToClipboard"), Napi::Function::New(env, CopyFileToClipboardWrapper));
   exports.Set(Napi::String::New(env, "sleep"), Napi::Function::New(env, SleepWrapper));
+  exports.Set(Napi::String::New(env, "sleepAsync"), Napi::Function::New(env, SleepAsyncWrapper));
+  exports.Set(Napi::String::New(env, "getMonotonicTime"), Napi::Function::New(env, GetMonotonicTimeWrapper));
+  exports.Set(Napi::String::New(env, "sendInputSequence"), Napi::Function::New(env, SendInputSequenceWrapper));
+  exports.Set(Napi::String::New(env, "moveCursorSmoothly"), Napi::Function::New(env, MoveCursorSmoothlyWrapper));
   exports.Set(Napi::String::New(env, "suppressInputEvents"), Napi::Function::New(env, SuppressInputEventsWrapper));
   exports.Set(Napi::String::New(env, "unsuppressInputEvents"), Napi::Function::New(env, UnsuppressInputEventsWrapper));
   exports.Set(Napi::String::New(env, "performOcrOnImage"), Napi::Function::New(env, PerformOcrOnImageWrapper));
+  exports.Set(Napi::String::New(env, "performStructuredOcrOnImage"), Napi::Function::New(env, PerformStructuredOcrOnImageWrapper));
+  exports.Set(Napi::String::New(env, "findTextOnScreen"), Napi::Function::New(env, FindTextOnScreenWrapper));
+  exports.Set(Napi::String::New(env, "getOcrCacheStats"), Napi::Function::New(env, GetOcrCacheStatsWrapper));
+  exports.Set(Napi::String::New(env, "setOcrCacheCapacity"), Napi::Function::New(env, SetOcrCacheCapacityWrapper));
+  exports.Set(Napi::String::New(env, "clearOcrCache"), Napi::Function::New(env, ClearOcrCacheWrapper));
+  exports.Set(Napi::String::New(env, "registerOcrProfile"), Napi::Function::New(env, RegisterOcrProfileWrapper));
+  exports.Set(Napi::String::New(env, "unregisterOcrProfile"), Napi::Function::New(env, UnregisterOcrProfileWrapper));
+  exports.Set(Napi::String::New(env, "releaseOcrEngines"), Napi::Function::New(env, ReleaseOcrEnginesWrapper));
   exports.Set(Napi::String::New(env, "getPixelColorsFromImage"), Napi::Function::New(env, GetPixelColorsFromPngWrapper));
+  exports.Set(Napi::String::New(env, "getRawPixelsFromImage"), Napi::Function::New(env, GetRawPixelsFromImageWrapper));
   exports.Set(Napi::String::New(env, "findImageTemplateMatches"), Napi::Function::New(env, findImageTemplateMatches));
   exports.Set(Napi::String::New(env, "playSound"), Napi::Function::New(env, PlaySoundWrapper));
   exports.Set(Napi::String::New(env, "pauseSound"), Napi::Function::New(env, PauseSoundWrapper));
@@ -32,10 +32,28 @@ const {
   mouseExtraButtonUp,
   keyPressDown,
   keyPressUp,
-  typeUnicodeCharacter,
+  typeText,
   getAvailableScreens,
   startInputEventListener,
   stopInputEventListener,
+  setInputEventBatching,
+  setInputEventFilter,
+  startInputEventRing,
+  stopInputEventRing,
+  startInputRecording,
+  setInputRecordingPaused,
+  stopInputRecording,
+  readInputRecording,
+  startInputReplay,
+  setInputReplayPaused,
+  seekInputReplay,
+  stopInputReplay,
+  setInputStateTracking,
+  isKeyPressed,
+  isMouseButtonPressed,
+  getCursorPosition,
+  registerHotkey,
+  unregisterHotkey,
   startWindowEventListener,
   stopWindowEventListener,
   cleanResources,
@@ -54,13 +72,35 @@ const {
   getPixelColor,
   takeScreenshotToFile,
   takeWindowScreenshotToFile,
+  captureMonitors,
+  startScreenRecording,
+  stopScreenRecording,
+  readScreenRecordingFrame,
+  startFlightRecorder,
+  dumpFlightRecorder,
+  stopFlightRecorder,
+  startScreenFrameFeed,
+  stopScreenFrameFeed,
   copyTextToClipboard,
   copyFileToClipboard,
   sleep,
+  sleepAsync,
+  getMonotonicTime,
+  sendInputSequence,
+  moveCursorSmoothly,
   suppressInputEvents,
   unsuppressInputEvents,
   performOcrOnImage,
+  performStructuredOcrOnImage,
+  findTextOnScreen,
+  getOcrCacheStats,
+  setOcrCacheCapacity,
+  clearOcrCache,
+  registerOcrProfile,
+  unregisterOcrProfile,
+  releaseOcrEngines,
   getPixelColorsFromImage,
+  getRawPixelsFromImage,
   findImageTemplateMatches,
   playSound,
   pauseSound,
@@ -99,10 +139,28 @@ export {
   mouseExtraButtonUp,
   keyPressDown,
   keyPressUp,
-  typeUnicodeCharacter,
+  typeText,
   getAvailableScreens,
   startInputEventListener,
   stopInputEventListener,
+  setInputEventBatching,
+  setInputEventFilter,
+  startInputEventRing,
+  stopInputEventRing,
+  startInputRecording,
+  setInputRecordingPaused,
+  stopInputRecording,
+  readInputRecording,
+  startInputReplay,
+  setInputReplayPaused,
+  seekInputReplay,
+  stopInputReplay,
+  setInputStateTracking,
+  isKeyPressed,
+  isMouseButtonPressed,
+  getCursorPosition,
+  registerHotkey,
+  unregisterHotkey,
   startWindowEventListener,
   stopWindowEventListener,
   cleanResources,
@@ -121,13 +179,35 @@ export {
   getPixelColor,
   takeScreenshotToFile,
   takeWindowScreenshotToFile,
+  captureMonitors,
+  startScreenRecording,
+  stopScreenRecording,
+  readScreenRecordingFrame,
+  startFlightRecorder,
+  dumpFlightRecorder,
+  stopFlightRecorder,
+  startScreenFrameFeed,
+  stopScreenFrameFeed,
   copyTextToClipboard,
   copyFileToClipboard,
   sleep,
+  sleepAsync,
+  getMonotonicTime,
+  sendInputSequence,
+  moveCursorSmoothly,
   suppressInputEvents,
   unsuppressInputEvents,
   performOcrOnImage,
+  performStructuredOcrOnImage,
+  findTextOnScreen,
+  getOcrCacheStats,
+  setOcrCacheCapacity,
+  clearOcrCache,
+  registerOcrProfile,
+  unregisterOcrProfile,
+  releaseOcrEngines,
   getPixelColorsFromImage,
+  getRawPixelsFromImage,
   findImageTemplateMatches,
   playSound,
   pauseSound,
@@ -5,6 +5,11 @@ declare module "@napi/actionify" {
   import type { WindowInfo } from "../types/window-info/window-info.type";
   import type { Color } from "../types/color/color.type";
   import type { MatchRegion } from "../types/match-region/match-region.type";
+  import type { RawImage } from "../types/raw-image/raw-image.type";
+  import type { OcrCacheStats } from "../types/ocr-cache-stats/ocr-cache-stats.type";
+  import type { OcrPreprocessing } from "../types/ocr-preprocessing/ocr-preprocessing.type";
+  import type { OcrProfile } from "../types/ocr-profile/ocr-profile.type";
+  import type { OcrResult } from "../types/ocr-result/ocr-result.type";
   const value: {
     getCursorPos: Position;
     setCursorPos: (x: number, y: number) => void;
@@ -20,10 +25,28 @@ declare module "@napi/actionify" {
     mouseExtraButtonUp: (index: 1 | 2) => void;
     keyPressDown: (keyCode: number) => void;
     keyPressUp: (keyCode: number) => void;
-    typeUnicodeCharacter: (character: string) => void;
+    typeText: (text: string, interval?: number) => Promise<void>;
     getAvailableScreens: () => ScreenInfo[];
     startInputEventListener: (callback: Function) => void;
     stopInputEventListener: () => void;
+    setInputEventBatching: (options: { interval?: number, size?: number, coalesceMotion?: boolean }) => void;
+    setInputEventFilter: (filter: { keyboard: boolean, mouse: boolean, motion: boolean, injected: boolean, physical: boolean, keys?: number[], mouseInputs?: number[] }) => void;
+    startInputEventRing: (options: { capacity?: number }, onWaiting: () => void) => { id: number, buffer: SharedArrayBuffer };
+    stopInputEventRing: (ringId: number) => void;
+    startInputRecording: (options: { filepath: string, actions?: Array<[type: number, input: number, state?: number]>, ignoreInjected?: boolean, compressionLevel?: number, blockSize?: number }) => number;
+    setInputRecordingPaused: (recorderId: number, paused: boolean) => void;
+    stopInputRecording: (recorderId: number) => Promise<{ events: number, droppedEvents: number, blocks: number, duration: number }>;
+    readInputRecording: (filepath: string) => Promise<Float64Array>;
+    startInputReplay: (source: string | Float64Array, speed?: number) => { id: number, done: Promise<{ events: number, duration: number, lateness: { mean: number, p50: number, p95: number, p99: number, max: number } }> };
+    setInputReplayPaused: (replayerId: number, paused: boolean) => void;
+    seekInputReplay: (replayerId: number, position: number) => void;
+    stopInputReplay: (replayerId: number) => void;
+    setInputStateTracking: (enabled: boolean) => boolean;
+    isKeyPressed: (keyCode: number) => boolean;
+    isMouseButtonPressed: (button: number) => boolean;
+    getCursorPosition: () => Position;
+    registerHotkey: (sequence: number[][][], options: { timeout?: number, ignoreInjected?: boolean }, onMatch: (timestamp: number) => void) => number;
+    unregisterHotkey: (hotkeyId: number) => void;
     startWindowEventListener: (callback: Function) => void;
     stopWindowEventListener: () => void;
     cleanResources: () => void;
@@ -42,14 +65,36 @@ declare module "@napi/actionify" {
     getPixelColor: (x: number, y: number) => Color;
     takeScreenshotToFile: (x: number, y: number, width: number, height: number, filePath: string, scale: number) => string;
     takeWindowScreenshotToFile: (windowId: number, x: number, y: number, width: number, height: number, filePath: string, scale: number) => boolean;
+    captureMonitors: (captures?: Array<{ id: number, scale?: number, format?: "png" | "jpeg" | "bmp", filepath?: string }>) => Promise<Array<{ id: number, captured: boolean, data?: Uint8Array }>>;
+    startScreenRecording: (options: { filepath: string, x: number, y: number, width: number, height: number, windowId?: number, fps?: number, codec?: "lz4" | "zstd", compressionLevel?: number, keyframeInterval?: number }) => number;
+    stopScreenRecording: (recorderId: number) => Promise<{ frames: number, droppedFrames: number, duration: number }>;
+    readScreenRecordingFrame: (filepath: string, frameIndex: number) => RawImage & { timestamp: number, frameCount: number, fps: number };
+    startFlightRecorder: (options: { x: number, y: number, width: number, height: number, windowId?: number, fps?: number, duration?: number, memoryLimit?: number, keyframeInterval?: number }) => number;
+    dumpFlightRecorder: (recorderId: number, filepath: string) => Promise<{ frames: number, droppedFrames: number, duration: number }>;
+    stopFlightRecorder: (recorderId: number) => void;
+    startScreenFrameFeed: (options: { x: number, y: number, width: number, height: number, windowId?: number, fps?: number, slots?: number }, onFrame: () => void) => { id: number, buffer: SharedArrayBuffer };
+    stopScreenFrameFeed: (feedId: number) => void;
     copyTextToClipboard: (text: string) => boolean;
     copyFileToClipboard: (filePath: string) => boolean;
-    sleep: (milliseconds: number) => void;
+    sleep: (milliseconds: number, precise?: boolean) => void;
+    sleepAsync: (milliseconds: number, precise?: boolean) => Promise<number>;
+    getMonotonicTime: () => number;
+    sendInputSequence: (program: Int32Array) => Promise<void>;
+    moveCursorSmoothly: (motion: { fromX: number, fromY: number, toX: number, toY: number, duration: number, motion?: "linear" | "arc" | "wave" | "human", curviness?: number, frequency?: number, mirror?: boolean, jitter?: number, steps?: number }) => Promise<void>;
     suppressInputEvents: (type: number, inputStateMap: Array<[number, Array<number>]>) => void;
     unsuppressInputEvents: (type: number, inputStateMap: Array<[number, Array<number>]>) => void;
-    performOcrOnImage: (imagePath: string, language?: string) => string;
+    performOcrOnImage: (imagePath: string, language?: string, preprocessing?: OcrPreprocessing, threads?: number) => string;
+    performStructuredOcrOnImage: (imagePath: string, language?: string, preprocessing?: OcrPreprocessing, threads?: number) => OcrResult;
+    findTextOnScreen: (query: string, options: { x: number, y: number, width: number, height: number, language?: string, caseSensitive?: boolean, wholeWords?: boolean, preprocessing?: OcrPreprocessing, threads?: number }) => Promise<Array<{ text: string, x: number, y: number, width: number, height: number, confidence: number }>>;
+    getOcrCacheStats: () => OcrCacheStats;
+    setOcrCacheCapacity: (capacity: number) => void;
+    clearOcrCache: () => void;
+    registerOcrProfile: (name: string, options: OcrProfile & { preload?: number }) => Promise<void>;
+    unregisterOcrProfile: (name: string) => boolean;
+    releaseOcrEngines: () => void;
     getPixelColorsFromImage: (imagePath: string) => Uint8Array<number>; // each 6 values = x,y,r,g,b,a
-    findImageTemplateMatches: (imagePath: string, subImagePath: string, minSimilarity: number) => Array<MatchRegion>;
+    getRawPixelsFromImage: (imagePath: string, format?: "rgba" | "bgra") => RawImage;
+    findImageTemplateMatches: (imagePath: string, subImagePath: string, minSimilarity: number, bandHeight?: number) => Float64Array;
     playSound: (audioPath: string, volume?: number, speed?: number, startTime?: number, endTime?: number) => { id: string, duration: number };
     pauseSound: (soundId: string) => void;
     resumeSound: (soundId: string) => void;
@@ -1,2 +1,3 @@
 export * from './input-listener-scope';
 export * from './input-recorder-settings';
+export * from './input-sequence';
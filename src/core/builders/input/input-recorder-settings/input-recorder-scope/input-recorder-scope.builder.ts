@@ -1,4 +1,3 @@
-import { Actionify } from "../../../../../core";
 import { InputRecorderScopeController } from "../../../../../core/controllers";
 import type {
   InputAction,
@@ -47,11 +46,17 @@ export class InputRecorderScopeBuilder {
    *   .record("a", "left")
    *   .into("/path/to/input-record.act")
    *   .start({ ignoreInjected: true });
+   *
+   * // Record all keyboard and mouse events natively into a compact binary file
+   * const inputRecordController = Actionify.input.track
+   *   .record()
+   *   .into("/path/to/input-record.act")
+   *   .start({ format: "binary" });
    */
   public start(inputRecorderOptions?: InputRecorderOptions) {
     const inputRecorderScopeController = new InputRecorderScopeController(
       this.#inputActions,
-      Actionify.filesystem.writeStream(this.#filepath),
+      this.#filepath,
       inputRecorderOptions,
     );
     return inputRecorderScopeController.recorderController;
@@ -0,0 +1,175 @@
+import {
+  sendInputSequence,
+} from "../../../../addon";
+import { KeyMapper, OperatingSystemService } from "../../../../core/services";
+import type { CaseInsensitiveKey, MouseInput } from "../../../../core/types";
+import { Inspectable } from "../../../../core/utilities";
+
+/**
+ * @description Builds a sequence of mouse and keyboard events, sent natively
+ * one after another with microsecond timing once `send()` is called.
+ */
+export class InputSequenceBuilder {
+
+  static readonly #opcodes = {
+    move: 0,
+    buttonDown: 1,
+    buttonUp: 2,
+    scroll: 3,
+    keyDown: 4,
+    keyUp: 5,
+  };
+
+  static readonly #buttons: Record<string, number> = {
+    left: 1,
+    middle: 2,
+    right: 3,
+    extraButton1: 4,
+    extraButton2: 5,
+  };
+
+  static readonly #maxDelayMicroseconds = 0x7fffffff;
+
+  #records: number[] = [];
+  #pendingDelayMicroseconds = 0;
+
+  public constructor() { }
+
+  /**
+   * @description The number of events in the sequence.
+   */
+  public get length(): number {
+    return this.#records.length / 4;
+  }
+
+  /**
+   * @description Wait before sending the next event.
+   *
+   * @param milliseconds The delay in milliseconds (microsecond precision).
+   * @returns The input sequence, to chain other events.
+   *
+   * ---
+   * @example
+   * // Press "A" for 50 milliseconds
+   * await Actionify.input.sequence().down("a").wait(50).up("a").send();
+   */
+  public wait(milliseconds: number) {
+    this.#pendingDelayMicroseconds += Math.max(0, Math.round((milliseconds || 0) * 1000));
+    return this;
+  }
+
+  /**
+   * @description Move the mouse to a given position.
+   * The position is relative to the main monitor (with origin in top-left corner at 0,0).
+   *
+   * @param x The new mouse X position.
+   * @param y The new mouse Y position.
+   * @returns The input sequence, to chain other events.
+   */
+  public move(x: number, y: number) {
+    return this.#push(InputSequenceBuilder.#opcodes.move, Math.round(x), Math.round(y));
+  }
+
+  /**
+   * @description Press a mouse button or a keyboard key.
+   *
+   * @param input The mouse button name, or the keyboard key code or key name.
+   * @returns The input sequence, to chain other events.
+   */
+  public down<T extends string>(input: Exclude<MouseInput, "move" | "wheel"> | number | CaseInsensitiveKey<T>) {
+    const button = typeof input === "string" ? InputSequenceBuilder.#buttons[input] : undefined;
+    if (button !== undefined) {
+      return this.#push(InputSequenceBuilder.#opcodes.buttonDown, button);
+    }
+    return this.#push(InputSequenceBuilder.#opcodes.keyDown, this.#toKeyCode(input));
+  }
+
+  /**
+   * @description Release a mouse button or a keyboard key.
+   *
+   * @param input The mouse button name, or the keyboard key code or key name.
+   * @returns The input sequence, to chain other events.
+   */
+  public up<T extends string>(input: Exclude<MouseInput, "move" | "wheel"> | number | CaseInsensitiveKey<T>) {
+    const button = typeof input === "string" ? InputSequenceBuilder.#buttons[input] : undefined;
+    if (button !== undefined) {
+      return this.#push(InputSequenceBuilder.#opcodes.buttonUp, button);
+    }
+    return this.#push(InputSequenceBuilder.#opcodes.keyUp, this.#toKeyCode(input));
+  }
+
+  /**
+   * @description Press then release a mouse button or a keyboard key.
+   *
+   * @param input The mouse button name, or the keyboard key code or key name.
+   * @param holdMilliseconds How long the input is held down. If unset, it is released immediately.
+   * @returns The input sequence, to chain other events.
+   */
+  public press<T extends string>(input: Exclude<MouseInput, "move" | "wheel"> | number | CaseInsensitiveKey<T>, holdMilliseconds: number = 0) {
+    return this.down(input).wait(holdMilliseconds).up(input);
+  }
+
+  /**
+   * @description Scroll the mouse wheel.
+   *
+   * @param numberOfScrolls Amount of scrolls (float), positive to scroll down and negative to scroll up.
+   * @returns The input sequence, to chain other events.
+   */
+  public scroll(numberOfScrolls: number = 1.0) {
+    const windowsDefaultScrollDpi = 120;
+    const amount = Math.round(OperatingSystemService.platform === "win32" ? numberOfScrolls * windowsDefaultScrollDpi : numberOfScrolls);
+    return amount !== 0 ? this.#push(InputSequenceBuilder.#opcodes.scroll, amount) : this;
+  }
+
+  /**
+   * @description Send the sequence. Sequences are sent one after another, thus
+   * the events of two sequences never interleave.
+   *
+   * @returns A promise that resolves once every event of the sequence has been sent.
+   *
+   * ---
+   * @example
+   * // Drag and drop from (100, 100) to (500, 300)
+   * await Actionify.input.sequence()
+   *   .move(100, 100)
+   *   .down("left")
+   *   .wait(100).move(300, 200)
+   *   .wait(100).move(500, 300)
+   *   .wait(100).up("left")
+   *   .send();
+   *
+   * // Press Ctrl+Shift+K
+   * await Actionify.input.sequence()
+   *   .down("control").down("shift").press("k", 20).up("shift").up("control")
+   *   .send();
+   */
+  public send(): Promise<void> {
+    return sendInputSequence(Int32Array.from(this.#records));
+  }
+
+  #toKeyCode<T extends string>(input: number | CaseInsensitiveKey<T>): number {
+    const keyCode = typeof input === "number" ? input : KeyMapper.toKeyCode(input);
+    if (keyCode === undefined) {
+      throw new Error(`Unknown key: ${input}`);
+    }
+    return keyCode;
+  }
+
+  #push(opcode: number, firstArgument: number, secondArgument: number = 0) {
+    if (this.#pendingDelayMicroseconds > InputSequenceBuilder.#maxDelayMicroseconds) {
+      throw new RangeError(`Delays between two input sequence events must not exceed ${InputSequenceBuilder.#maxDelayMicroseconds / 1000} milliseconds`);
+    }
+    this.#records.push(opcode, firstArgument, secondArgument, this.#pendingDelayMicroseconds);
+    this.#pendingDelayMicroseconds = 0;
+    return this;
+  }
+
+  /**
+   * @description Customize the default inspect output (with `console.log`) of a
+   * class instance.
+   */
+  public [Symbol.for('nodejs.util.inspect.custom')](depth: number, inspectOptions: object, inspect: Function) {
+    return Inspectable.format(this, depth, inspectOptions, inspect);
+  }
+
+}
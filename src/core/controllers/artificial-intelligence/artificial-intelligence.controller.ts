@@ -1,6 +1,6 @@
 import path from "path";
 import { Actionify } from "../../../core";
-import { ImageProcessingController } from "../../../core/controllers";
+import { ImageProcessingController, OcrCacheController, OcrProfilesController } from "../../../core/controllers";
 import { Inspectable } from "../../../core/utilities";
 
 /**
@@ -8,7 +8,27 @@ import { Inspectable } from "../../../core/utilities";
  */
 export class ArtificialIntelligenceController {
 
-  public constructor() { }
+  #ocrCacheController: OcrCacheController;
+  #ocrProfilesController: OcrProfilesController;
+
+  public constructor() {
+    this.#ocrCacheController = new OcrCacheController();
+    this.#ocrProfilesController = new OcrProfilesController();
+  }
+
+  /**
+   * @description Cache of recent OCR results, keyed by image content, language and options.
+   */
+  public get ocrCache(): OcrCacheController {
+    return this.#ocrCacheController;
+  }
+
+  /**
+   * @description Named Tesseract settings, usable instead of a language in every OCR call.
+   */
+  public get ocrProfiles(): OcrProfilesController {
+    return this.#ocrProfilesController;
+  }
 
   /**
    * @description Artificial Intelligence algorithms for image processing.
@@ -1,12 +1,13 @@
-import fs from "fs/promises";
 import path from "path";
-import { RepositoryHelper } from "../../../../cli/actionify/helpers";
 import { Actionify } from "../../../../core";
 import {
   findImageTemplateMatches,
+  getRawPixelsFromImage,
   performOcrOnImage,
+  performStructuredOcrOnImage,
 } from "../../../../addon";
-import type { MatchRegion } from "../../../../core/types";
+import { OcrLanguageService } from "../../../../core/services";
+import type { MatchRegion, OcrPreprocessing, OcrResult, RawImage } from "../../../../core/types";
 import { Inspectable } from "../../../../core/utilities";
 
 /**
@@ -34,8 +35,13 @@ export class ImageProcessingController {
   /**
    * @description Perform OCR (Optical Character Recognition) on an image to extract text from it.
    *
-   * @param language The {@link https://tesseract-ocr.github.io/tessdoc/Data-Files-in-different-versions|language code} to use for OCR.
+   * @param language The {@link https://tesseract-ocr.github.io/tessdoc/Data-Files-in-different-versions|language code} to use for OCR,
+   * or the name of a profile registered with `Actionify.ai.ocrProfiles.register()`.
    * If unset, it will default to the first available language installed locally.
+   * @param preprocessing Image transformations applied in memory before OCR. If unset, the image is used as is.
+   * @param threads The number of threads recognizing text blocks in parallel, `0` for all cores. If unset, it defaults to `1`.
+   * With several threads, the image is first split into text blocks, each recognized by its own OCR engine: large images
+   * such as full-screen captures are recognized faster, at the cost of one engine (tens of MB) per thread.
    * @returns A promise that resolves to the text extracted from the image.
    *
    * ---
@@ -66,31 +72,47 @@ export class ImageProcessingController {
    * const text = await Actionify.ai.image("/path/to/image.png").text("kor");
    * // Extract text from an image using Arabic
    * const text = await Actionify.ai.image("/path/to/image.png").text("ara");
+   * // Extract small light text on a dark background from a screenshot
+   * const text = await Actionify.ai.image("/path/to/screenshot.png").text("eng", { invert: "auto", scale: 3, binarize: "sauvola" });
+   * // Extract text from a full-screen screenshot on all cores
+   * const text = await Actionify.ai.image("/path/to/screenshot.png").text("eng", undefined, 0);
    */
-  public async text(language?: string) {
-    try {
-      const ocrLanguageCode = language ?? (await this.#fetchDefaultLocalTtsModelIfExistsElseThrow());
-      return performOcrOnImage(this.#absoluteFilePath, ocrLanguageCode);
-    }
-    catch (error: any) {
-      if (error?.message?.includes("Failed to initialize Tesseract with language")) {
-        throw new Error([
-          ``,
-          `==========================================`,
-          `OCR language "${language ?? "eng"}" not found.`,
-          `Install it using the following command:`,
-          `    \x1b[96mnpx actionify ocr language add ${language ?? "eng"}\x1b[0m`,
-          `==========================================`,
-        ].join("\n"));
-      }
-      throw error;
-    }
+  public async text(language?: string, preprocessing?: OcrPreprocessing, threads?: number) {
+    return OcrLanguageService.run(language, (ocrLanguageCode) => performOcrOnImage(this.#absoluteFilePath, ocrLanguageCode, preprocessing, threads));
+  }
+
+  /**
+   * @description Perform OCR (Optical Character Recognition) on an image and get the recognized words, lines and blocks
+   * with their bounding boxes and confidences, in a single recognition pass.
+   *
+   * @param language The {@link https://tesseract-ocr.github.io/tessdoc/Data-Files-in-different-versions|language code} to use for OCR,
+   * or the name of a profile registered with `Actionify.ai.ocrProfiles.register()`.
+   * If unset, it will default to the first available language installed locally.
+   * @param preprocessing Image transformations applied in memory before OCR. If unset, the image is used as is.
+   * @param threads The number of threads recognizing text blocks in parallel, `0` for all cores. If unset, it defaults to `1`.
+   * See {@link ImageProcessingController.text}.
+   * @returns A promise that resolves to the structured OCR result.
+   *
+   * ---
+   * @example
+   * // Get the bounding box of every word
+   * const { words } = await Actionify.ai.image("/path/to/image.png").textLayout();
+   * for (let i = 0; i < words.text.length; i++) {
+   *   const [x, y, width, height] = words.boxes.subarray(i * 4, i * 4 + 4);
+   *   console.log(`"${words.text[i]}" at (${x}, ${y}), confidence: ${words.confidences[i]}`);
+   * }
+   */
+  public async textLayout(language?: string, preprocessing?: OcrPreprocessing, threads?: number): Promise<OcrResult> {
+    return OcrLanguageService.run(language, (ocrLanguageCode) => performStructuredOcrOnImage(this.#absoluteFilePath, ocrLanguageCode, preprocessing, threads));
   }
 
   /**
    * @description Finds all occurrences of the given sub-image in the given image.
    *
    * @param filepath The path to the sub-image file to find inside the previously given image.
+   * @param options.minSimilarity The minimum similarity threshold for each pixel comparison. If unset, `0.5` will be used.
+   * @param options.bandHeight If set, the image is processed in parallel horizontal bands of this many rows,
+   * keeping memory usage proportional to the band size instead of the whole image. Recommended for very large images.
    * @returns {MatchRegion[]} A sorted array of regions from most to less likely containing the given sub-image.
    *
    * ---
@@ -104,16 +126,20 @@ export class ImageProcessingController {
    *
    * // Find all regions in the image, ordered from most to least likely to contain the given sub-image
    * const allMatches = Actionify.ai.image("/path/to/image.png").find("/path/to/sub-image.png", { minSimilarity: 0 });
+   *
+   * // Find regions in a very large image using bounded memory
+   * const matches = Actionify.ai.image("/path/to/large-image.png").find("/path/to/sub-image.png", { bandHeight: 256 });
    */
-  public find(filepath: string, options?: { minSimilarity?: number }): MatchRegion[] {
+  public find(filepath: string, options?: { minSimilarity?: number, bandHeight?: number }): MatchRegion[] {
     if (!Actionify.filesystem.exists(filepath)) {
       throw new Error(`File does not exist: ${filepath}`);
     }
     // Initialize variables
     const minSimilarity = Math.max(0, Math.min(1, options?.minSimilarity ?? 0.5));
+    const bandHeight = Math.max(0, Math.floor(options?.bandHeight ?? 0));
     const absoluteSubFilePath = path.resolve(filepath);
     // Find matches
-    const rawResults = findImageTemplateMatches(this.#absoluteFilePath, absoluteSubFilePath, minSimilarity);
+    const rawResults = findImageTemplateMatches(this.#absoluteFilePath, absoluteSubFilePath, minSimilarity, bandHeight);
     // Map results
     const result = [];
     for (let rawIndex = 0; rawIndex < rawResults.length; rawIndex += 5) {
@@ -136,25 +162,24 @@ export class ImageProcessingController {
     return result;
   }
 
-  async #fetchDefaultLocalTtsModelIfExistsElseThrow() {
-    const ocrDataFolderPath = await RepositoryHelper.resolveDataDirectory(["ocr"]);
-    const localOcrTrainedDataFileNames = (await fs.readdir(ocrDataFolderPath, { withFileTypes: true }))
-      .filter((fileOrDirectory) => fileOrDirectory.isFile())
-      .map((directory) => directory.name.replace(".traineddata", ""));
-    ;
-    if (localOcrTrainedDataFileNames.length > 0) {
-      return localOcrTrainedDataFileNames[0];
-    }
-    throw new Error([
-      ``,
-      `==========================================`,
-      `No OCR languages installed locally.`,
-      `Browse the list of available languages using the following command:`,
-      `    \x1b[96mnpx actionify ocr language list\x1b[0m`,
-      `Then install one using the following command:`,
-      `    \x1b[96mnpx actionify ocr language add <language>\x1b[0m`,
-      `==========================================`,
-    ].join("\n"));
+  /**
+   * @description Decodes the image into packed pixels (4 bytes per pixel).
+   *
+   * @param format The byte order of each pixel. If unset, `rgba` will be used.
+   * @returns {RawImage} The image dimensions, row stride in bytes and packed pixels.
+   *
+   * ---
+   * @example
+   * // Read the color of the pixel at (x, y)
+   * const { data, stride } = Actionify.ai.image("/path/to/image.png").pixels();
+   * const offset = y * stride + x * 4;
+   * const [red, green, blue, alpha] = data.subarray(offset, offset + 4);
+   *
+   * // Get pixels in BGRA order
+   * const image = Actionify.ai.image("/path/to/image.png").pixels("bgra");
+   */
+  public pixels(format: "rgba" | "bgra" = "rgba"): RawImage {
+    return getRawPixelsFromImage(this.#absoluteFilePath, format);
   }
 
   /**
@@ -1,2 +1,4 @@
 export * from './artificial-intelligence.controller';
 export * from './image-processing';
+export * from './ocr-cache';
+export * from './ocr-profiles';
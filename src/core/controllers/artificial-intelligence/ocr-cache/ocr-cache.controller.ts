@@ -0,0 +1,67 @@
+import {
+  clearOcrCache,
+  getOcrCacheStats,
+  setOcrCacheCapacity,
+} from "../../../../addon";
+import type { OcrCacheStats } from "../../../../core/types";
+import { Inspectable } from "../../../../core/utilities";
+
+/**
+ * @description Cache of recent OCR results. OCR calls on identical pixels, with the same language and options,
+ * return the cached result instantly instead of recognizing the image again.
+ */
+export class OcrCacheController {
+
+  public constructor() { }
+
+  /**
+   * @description Get the cache usage counters, to tune its capacity.
+   *
+   * @returns The number of hits, misses, cached results and the cache capacity.
+   *
+   * ---
+   * @example
+   * const { hits, misses } = Actionify.ai.ocrCache.stats();
+   * console.log(`OCR cache hit rate: ${(100 * hits / Math.max(1, hits + misses)).toFixed(1)}%`);
+   */
+  public stats(): OcrCacheStats {
+    return getOcrCacheStats();
+  }
+
+  /**
+   * @description Set the maximum number of cached results. Least recently used results are dropped first.
+   *
+   * @param capacity The maximum number of cached results, `0` to disable the cache. Defaults to `64`.
+   *
+   * ---
+   * @example
+   * // Keep more results for bots watching many areas
+   * Actionify.ai.ocrCache.resize(256);
+   *
+   * // Disable the cache
+   * Actionify.ai.ocrCache.resize(0);
+   */
+  public resize(capacity: number) {
+    setOcrCacheCapacity(Math.max(0, Math.floor(capacity)));
+  }
+
+  /**
+   * @description Drop all cached results and reset the usage counters.
+   *
+   * ---
+   * @example
+   * Actionify.ai.ocrCache.clear();
+   */
+  public clear() {
+    clearOcrCache();
+  }
+
+  /**
+   * @description Customize the default inspect output (with `console.log`) of a
+   * class instance.
+   */
+  public [Symbol.for('nodejs.util.inspect.custom')](depth: number, inspectOptions: object, inspect: Function) {
+    return Inspectable.format(this, depth, inspectOptions, inspect);
+  }
+
+}
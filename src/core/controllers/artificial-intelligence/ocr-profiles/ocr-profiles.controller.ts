@@ -0,0 +1,77 @@
+import {
+  registerOcrProfile,
+  releaseOcrEngines,
+  unregisterOcrProfile,
+} from "../../../../addon";
+import { OcrLanguageService } from "../../../../core/services";
+import type { OcrProfile } from "../../../../core/types";
+import { Inspectable } from "../../../../core/utilities";
+
+/**
+ * @description Named Tesseract settings. A profile name can be given instead of a language to every OCR call,
+ * e.g. `Actionify.ai.image(filepath).text("digits")` or `Actionify.screen.findText(query, { language: "digits" })`.
+ * OCR engines are initialized once per profile and reused across calls.
+ */
+export class OcrProfilesController {
+
+  public constructor() { }
+
+  /**
+   * @description Register (or replace) an OCR profile and initialize its engines ahead of the first OCR calls.
+   * Restricting the page segmentation mode and the recognized characters makes small fields several times faster to read.
+   *
+   * @param name The profile name. It must differ from installed language codes, which it would shadow.
+   * @param options The Tesseract settings of the profile. See {@link OcrProfile}.
+   * @param options.preload The number of engines initialized right away, e.g. the number of threads of parallel OCR calls. If unset, it defaults to `1`.
+   * @returns A promise which resolves once the engines are initialized and the profile is registered.
+   *
+   * ---
+   * @example
+   * // Read a single-line numeric field
+   * await Actionify.ai.ocrProfiles.register("digits", { pageSegmentationMode: "single-line", whitelist: "0123456789" });
+   * const amount = await Actionify.ai.image("/path/to/field.png").text("digits");
+   *
+   * // Skip dictionaries when reading identifiers
+   * await Actionify.ai.ocrProfiles.register("ids", { language: "eng", variables: { load_system_dawg: false, load_freq_dawg: false } });
+   */
+  public async register(name: string, options?: OcrProfile & { preload?: number }) {
+    return OcrLanguageService.run(options?.language, (ocrLanguageCode) => registerOcrProfile(name, {
+      ...options,
+      language: ocrLanguageCode,
+    }));
+  }
+
+  /**
+   * @description Unregister an OCR profile and free its idle engines.
+   *
+   * @param name The profile name.
+   * @returns `true` if the profile was registered, `false` otherwise.
+   *
+   * ---
+   * @example
+   * Actionify.ai.ocrProfiles.unregister("digits");
+   */
+  public unregister(name: string) {
+    return unregisterOcrProfile(name);
+  }
+
+  /**
+   * @description Free all idle OCR engines, of profiles and plain languages alike. They will be initialized again on their next use.
+   *
+   * ---
+   * @example
+   * Actionify.ai.ocrProfiles.releaseEngines();
+   */
+  public releaseEngines() {
+    releaseOcrEngines();
+  }
+
+  /**
+   * @description Customize the default inspect output (with `console.log`) of a
+   * class instance.
+   */
+  public [Symbol.for('nodejs.util.inspect.custom')](depth: number, inspectOptions: object, inspect: Function) {
+    return Inspectable.format(this, depth, inspectOptions, inspect);
+  }
+
+}
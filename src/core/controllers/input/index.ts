@@ -1,3 +1,5 @@
 export * from './input.controller';
 export * from './input-events';
 export * from './input-tracks';
+export * from './input-event-ring';
+export * from './input-state';
@@ -0,0 +1 @@
+export * from './input-event-ring.controller';
@@ -0,0 +1,66 @@
+import {
+  stopInputEventListener,
+  stopInputEventRing,
+} from "../../../../addon";
+import { InputEventService } from "../../../../core/services";
+import { Inspectable, InputEventRingReader } from "../../../../core/utilities";
+
+/**
+ * @description A running input event ring, receiving every keyboard and mouse event in shared memory.
+ */
+export class InputEventRingController {
+
+  readonly #ringId: number;
+  readonly #buffer: SharedArrayBuffer;
+  readonly #reader: InputEventRingReader;
+
+  public constructor(ringId: number, buffer: SharedArrayBuffer) {
+    this.#ringId = ringId;
+    this.#buffer = buffer;
+    this.#reader = new InputEventRingReader(buffer);
+  }
+
+  /**
+   * @description The shared memory events are written into. Send it to a worker thread and read it with an `InputEventRingReader`.
+   */
+  public get buffer(): SharedArrayBuffer {
+    return this.#buffer;
+  }
+
+  /**
+   * @description A reader of the ring events for the current thread. Only one reader may consume a ring:
+   * do not use it once the buffer was sent to a worker thread.
+   */
+  public get reader(): InputEventRingReader {
+    return this.#reader;
+  }
+
+  /**
+   * @description Stop writing events to the ring. The unread events remain readable from the shared memory.
+   *
+   * ---
+   * @example
+   * const ring = Actionify.input.events.ring();
+   * ring.stop();
+   */
+  public stop(): void {
+    const ringIndex = InputEventService.inputEventRings.indexOf(this);
+    if (ringIndex === -1) {
+      return;
+    }
+    InputEventService.inputEventRings.splice(ringIndex, 1);
+    stopInputEventRing(this.#ringId);
+    if (InputEventService.shouldStopMainListener) {
+      stopInputEventListener();
+    }
+  }
+
+  /**
+   * @description Customize the default inspect output (with `console.log`) of a
+   * class instance.
+   */
+  public [Symbol.for('nodejs.util.inspect.custom')](depth: number, inspectOptions: object, inspect: Function) {
+    return Inspectable.format(this, depth, inspectOptions, inspect);
+  }
+
+}
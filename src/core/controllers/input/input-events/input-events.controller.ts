@@ -1,11 +1,13 @@
 import {
+  setInputEventBatching,
   startInputEventListener,
+  startInputEventRing,
   stopInputEventListener,
   suppressInputEvents,
   unsuppressInputEvents,
 } from "../../../../addon";
 import { InputListenerScopeBuilder } from "../../../../core/builders";
-import { LifecycleController } from "../../../../core/controllers";
+import { InputEventRingController, LifecycleController } from "../../../../core/controllers";
 import {
   InputEventService,
   KeyFormatter,
@@ -157,12 +159,90 @@ export class InputEventsController {
     const listenerIndex = InputEventService.inputListeners.findIndex((inputListener) => inputListener.listener === listener);
     if (listenerIndex !== -1) {
       InputEventService.inputListeners.splice(listenerIndex, 1);
+      InputEventService.updateInputEventFilter();
     }
     if (InputEventService.shouldStopMainListener) {
       stopInputEventListener();
     }
   }
 
+  /**
+   * @description Batch the input events delivered to all listeners and recorders (including keyboard and mouse ones).
+   * Instead of waking up the event loop for every event, events are accumulated natively and delivered together:
+   * listeners still receive them one by one, in order, but up to `interval` milliseconds late.
+   *
+   * @param options.interval The maximum number of milliseconds an event waits in a batch. If `0` or unset, a batch is
+   * delivered as soon as no more events are pending.
+   * @param options.size The maximum number of events in a batch. If `0` or unset, batches are only bounded by their interval.
+   * @param options.coalesceMotion If `true`, consecutive mouse moves within a batch are merged into the latest one.
+   * Listeners and recorders then receive fewer `move` events, which cuts the cost of fast mouse movements.
+   * Calling this method without options disables batching.
+   *
+   * ---
+   * @example
+   * // Deliver input events at most every 16 ms, with one mouse move per batch at most between other events
+   * Actionify.input.events.batch({ interval: 16, coalesceMotion: true });
+   *
+   * // Deliver input events one by one again
+   * Actionify.input.events.batch();
+   */
+  public batch(options?: { interval?: number, size?: number, coalesceMotion?: boolean }) {
+    setInputEventBatching({
+      interval: Math.max(0, Math.floor(options?.interval ?? 0)),
+      size: Math.max(0, Math.floor(options?.size ?? 0)),
+      coalesceMotion: options?.coalesceMotion ?? false,
+    });
+  }
+
+  /**
+   * @description Write every keyboard and mouse event into a ring in shared memory, to be consumed at its own pace by
+   * the current thread or a worker thread with an `InputEventRingReader`. Events are read without any allocation nor
+   * JavaScript call per event: the reader is only notified when it waits for events. Events are dropped while the ring is full.
+   *
+   * @param options.capacity The maximum number of unread events, rounded up to a power of 2. If unset, `4096` will be used.
+   * @param options.onEvents Called on the main thread when events were written while the reader waited for them
+   * (see `InputEventRingReader.arm()`).
+   * @returns The input event ring controller.
+   *
+   * ---
+   * @example
+   * // Consume events on the main thread
+   * const ring = Actionify.input.events.ring({
+   *   onEvents: () => {
+   *     do {
+   *       while (ring.reader.read()) {
+   *         console.log(ring.reader.type, ring.reader.input, ring.reader.state);
+   *       }
+   *     } while (!ring.reader.arm());
+   *   }
+   * });
+   *
+   * // Consume events in a worker thread
+   * const ring = Actionify.input.events.ring({ capacity: 16384 });
+   * const worker = new Worker("./worker.js", { workerData: ring.buffer });
+   */
+  public ring(options?: { capacity?: number, onEvents?: () => void }): InputEventRingController {
+    let header: Int32Array | undefined;
+    const { id, buffer } = startInputEventRing(
+      { capacity: options?.capacity },
+      // Wake up readers blocked in `InputEventRingReader.wait()`
+      () => {
+        if (header) {
+          Atomics.notify(header, 0);
+          options?.onEvents?.();
+        }
+      }
+    );
+    header = new Int32Array(buffer, 0, 16);
+    const ring = new InputEventRingController(id, buffer);
+    InputEventService.inputEventRings.push(ring);
+    if (InputEventService.shouldStartMainListener) {
+      LifecycleController.cleanBeforeExit();
+      startInputEventListener(InputEventService.mainListener);
+    }
+    return ring;
+  }
+
   /**
    * @description Suppress the given input events.
    * Input listeners will not be affected and will still receive the events.
@@ -31,6 +31,7 @@ export class InputListenerScopeController {
     this.#currentRunners = 0;
     this.#shouldIgnoreInjectedInputEvents = inputListenerOptions?.ignoreInjected ?? false;
     InputEventService.inputListeners.push(this);
+    InputEventService.updateInputEventFilter();
     if (InputEventService.shouldStartMainListener) {
       LifecycleController.cleanBeforeExit();
       startInputEventListener(InputEventService.mainListener);
@@ -43,6 +44,7 @@ export class InputListenerScopeController {
 
   public set ignoreInjected(ignoreInjected: boolean) {
     this.#shouldIgnoreInjectedInputEvents = ignoreInjected;
+    InputEventService.updateInputEventFilter();
   }
 
   public get isPaused() {
@@ -30,6 +30,7 @@ export class InputListenerController implements IInputListenerController {
     const listenerIndex = InputEventService.inputListeners.findIndex((inputListener) => inputListener.listener === this.#inputListenerScopeController.listener);
     if (listenerIndex !== -1) {
       InputEventService.inputListeners.splice(listenerIndex, 1);
+      InputEventService.updateInputEventFilter();
     }
     if (InputEventService.shouldStopMainListener) {
       stopInputEventListener();
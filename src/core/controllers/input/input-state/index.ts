@@ -0,0 +1,2 @@
+export * from './input-state.controller';
+export * from './input-state-tracker';
@@ -0,0 +1 @@
+export * from './input-state-tracker.controller';
@@ -0,0 +1,45 @@
+import {
+  setInputStateTracking,
+  stopInputEventListener,
+} from "../../../../../addon";
+import { InputEventService } from "../../../../../core/services";
+import { Inspectable } from "../../../../../core/utilities";
+
+/**
+ * @description A running input state tracker, keeping the keyboard, mouse buttons and cursor state natively up to date.
+ */
+export class InputStateTrackerController {
+
+  public constructor() { }
+
+  /**
+   * @description Stop tracking the input state. Once no tracker is left, input state queries ask the system again.
+   *
+   * ---
+   * @example
+   * const tracker = Actionify.input.state.track();
+   * tracker.stop();
+   */
+  public stop(): void {
+    const trackerIndex = InputEventService.inputStateTrackers.indexOf(this);
+    if (trackerIndex === -1) {
+      return;
+    }
+    InputEventService.inputStateTrackers.splice(trackerIndex, 1);
+    if (InputEventService.inputStateTrackers.length === 0) {
+      setInputStateTracking(false);
+    }
+    if (InputEventService.shouldStopMainListener) {
+      stopInputEventListener();
+    }
+  }
+
+  /**
+   * @description Customize the default inspect output (with `console.log`) of a
+   * class instance.
+   */
+  public [Symbol.for('nodejs.util.inspect.custom')](depth: number, inspectOptions: object, inspect: Function) {
+    return Inspectable.format(this, depth, inspectOptions, inspect);
+  }
+
+}
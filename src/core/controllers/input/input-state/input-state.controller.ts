@@ -0,0 +1,115 @@
+import {
+  getCursorPosition,
+  isKeyPressed,
+  isMouseButtonPressed,
+  setInputStateTracking,
+  startInputEventListener,
+} from "../../../../addon";
+import {
+  InputStateTrackerController,
+  LifecycleController,
+} from "../../../../core/controllers";
+import { InputEventService, KeyFormatter, KeyMapper } from "../../../../core/services";
+import type { CaseInsensitiveKey, MouseInput, Position } from "../../../../core/types";
+import { Inspectable } from "../../../../core/utilities";
+
+/**
+ * @description Current keyboard, mouse buttons and cursor state.
+ *
+ * Each query asks the system, which on Linux means a round trip to the X server.
+ * While the state is tracked (see {@link InputStateController.track}), queries read native memory instead.
+ */
+export class InputStateController {
+
+  // Mouse inputs indexed by their native code
+  static readonly #mouseInputs: Array<MouseInput> = ["move", "left", "right", "middle", "wheel", "extraButton1", "extraButton2"];
+
+  // Generic modifiers, held when either side is held
+  static readonly #sidedKeys: Record<string, Array<CaseInsensitiveKey<any>>> = {
+    "shift": ["left_shift", "right_shift"],
+    "ctrl": ["left_ctrl", "right_ctrl"],
+    "control": ["left_ctrl", "right_ctrl"],
+    "alt": ["left_alt", "right_alt"],
+    "win": ["left_win", "right_win"],
+    "windows": ["left_win", "right_win"],
+  };
+
+  public constructor() { }
+
+  /**
+   * @description Track the input state natively from the input events, so that queries no longer ask the system.
+   * On Linux, the input listener runs until every tracker is stopped.
+   *
+   * @returns The input state tracker.
+   *
+   * ---
+   * @example
+   * const tracker = Actionify.input.state.track();
+   * // Zero round trip queries
+   * if (Actionify.input.state.isPressed("shift")) {
+   *   const { x, y } = Actionify.input.state.cursor;
+   * }
+   * tracker.stop();
+   */
+  public track(): InputStateTrackerController {
+    const tracker = new InputStateTrackerController();
+    const isListenerRequired = setInputStateTracking(true);
+    if (isListenerRequired) {
+      InputEventService.inputStateTrackers.push(tracker);
+      if (InputEventService.shouldStartMainListener) {
+        LifecycleController.cleanBeforeExit();
+        startInputEventListener(InputEventService.mainListener);
+      }
+    }
+    return tracker;
+  }
+
+  /**
+   * @description Whether the given keyboard key or mouse button is held.
+   *
+   * @param input The mouse button, or the keyboard key name or key code. Generic modifiers (such as `"shift"`) are held
+   * when either their left or right key is held.
+   * @returns Whether the input is held.
+   *
+   * ---
+   * @example
+   * const isShiftHeld = Actionify.input.state.isPressed("shift");
+   * const isLeftButtonHeld = Actionify.input.state.isPressed("left");
+   */
+  public isPressed<T extends string>(input: `${MouseInput}` | CaseInsensitiveKey<T> | number): boolean {
+    if (typeof input === "number") {
+      return isKeyPressed(input);
+    }
+    const mouseButton = InputStateController.#mouseInputs.indexOf(input as MouseInput);
+    if (mouseButton !== -1) {
+      return isMouseButtonPressed(mouseButton);
+    }
+    const formattedKey = KeyFormatter.format(input);
+    const sides = InputStateController.#sidedKeys[formattedKey];
+    if (sides) {
+      return sides.some((side) => isKeyPressed(KeyMapper.toKeyCode(side)));
+    }
+    return isKeyPressed(KeyMapper.toKeyCode(formattedKey));
+  }
+
+  /**
+   * @description The cursor position, both coordinates being read at once.
+   * The position is relative to the main monitor (with origin in top-left corner at 0,0).
+   *
+   * ---
+   * @example
+   * const { x, y } = Actionify.input.state.cursor;
+   */
+  public get cursor(): Position {
+    return getCursorPosition();
+  }
+
+  /**
+   * @description Customize the default inspect output (with `console.log`) of a
+   * class instance.
+   */
+  public [Symbol.for('nodejs.util.inspect.custom')](depth: number, inspectOptions: object, inspect: Function) {
+    return Inspectable.format(this, depth, inspectOptions, inspect);
+  }
+
+}
@@ -1,2 +1,3 @@
 export * from './input-tracks.controller';
 export * from './input-recorder-scope';
+export * from './input-replayer';
@@ -1,7 +1,11 @@
 import { WriteStream } from "fs";
+import path from "path";
 import {
+  setInputRecordingPaused,
   startInputEventListener,
+  startInputRecording,
 } from "../../../../../addon";
+import { Actionify } from "../../../../../core";
 import { InputRecorderController, LifecycleController } from "../../../../../core/controllers";
 import { InputEventService } from "../../../../../core/services";
 import type { InputAction, InputRecorderOptions } from "../../../../../core/types";
@@ -9,23 +13,43 @@ import { Inspectable } from "../../../../../core/utilities";
 
 export class InputRecorderScopeController {
 
+  static readonly #mouseInputs: Array<string> = ["move", "left", "right", "middle", "wheel", "extraButton1", "extraButton2"];
+  static readonly #states: Array<string> = ["down", "up", "neutral"];
+
   #inputActions: InputAction[];
-  #writeStream: WriteStream;
+  #writeStream?: WriteStream;
+  #nativeRecorderId?: number;
   #isPaused: boolean;
   #inputRecorderController: InputRecorderController;
   #shouldIgnoreInjectedInputEvents: boolean;
 
   public constructor(
     inputActions: InputAction[],
-    writeStream: WriteStream,
+    filepath: string,
     inputRecorderOptions?: InputRecorderOptions,
   ) {
     this.#inputActions = inputActions;
-    this.#writeStream = writeStream;
     this.#isPaused = false;
     this.#inputRecorderController = new InputRecorderController(this);
     this.#shouldIgnoreInjectedInputEvents = inputRecorderOptions?.ignoreInjected ?? false;
-    InputEventService.inputRecorders.push(this);
+    if (inputRecorderOptions?.format === "binary") {
+      // Recorded natively: the main listener does not need these events
+      this.#nativeRecorderId = startInputRecording({
+        filepath: path.resolve(filepath),
+        actions: inputActions.map((action) => [
+          action.type === "mouse" ? 0 : 1,
+          action.type === "mouse" ? InputRecorderScopeController.#mouseInputs.indexOf(action.input) : action.input,
+          action.state === undefined ? -1 : InputRecorderScopeController.#states.indexOf(action.state),
+        ]),
+        ignoreInjected: this.#shouldIgnoreInjectedInputEvents,
+      });
+      InputEventService.nativeInputRecorders.push(this);
+    }
+    else {
+      this.#writeStream = Actionify.filesystem.writeStream(filepath);
+      InputEventService.inputRecorders.push(this);
+      InputEventService.updateInputEventFilter();
+    }
     if (InputEventService.shouldStartMainListener) {
       LifecycleController.cleanBeforeExit();
       startInputEventListener(InputEventService.mainListener);
@@ -38,6 +62,7 @@ export class InputRecorderScopeController {
 
   public set ignoreInjected(ignoreInjected: boolean) {
     this.#shouldIgnoreInjectedInputEvents = ignoreInjected;
+    InputEventService.updateInputEventFilter();
   }
 
   public get isPaused() {
@@ -46,6 +71,13 @@ export class InputRecorderScopeController {
 
   public set isPaused(isPaused: boolean) {
     this.#isPaused = isPaused;
+    if (this.#nativeRecorderId !== undefined) {
+      setInputRecordingPaused(this.#nativeRecorderId, isPaused);
+    }
+  }
+
+  public get nativeRecorderId() {
+    return this.#nativeRecorderId;
   }
 
   public get recorderController() {
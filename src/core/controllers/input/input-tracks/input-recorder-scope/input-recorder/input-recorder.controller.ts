@@ -1,8 +1,10 @@
 import {
   stopInputEventListener,
+  stopInputRecording,
 } from "../../../../../../addon";
 import { InputRecorderScopeController } from "../../../../../../core/controllers";
 import { InputEventService } from "../../../../../../core/services";
+import type { InputRecordingStats } from "../../../../../../core/types";
 import { Inspectable } from "../../../../../../core/utilities";
 
 export class InputRecorderController {
@@ -76,7 +78,10 @@ export class InputRecorderController {
   }
 
   /**
-   * @description Stop the input recorder.
+   * @description Stop the input recorder. Binary recordings write their last events and their index before the promise resolves.
+   *
+   * @returns A promise that resolves to the recording summary for binary recordings, `undefined` otherwise.
+   * It rejects when a binary recording file could not be written (disk full...).
    *
    * ---
    * @example
@@ -95,16 +100,36 @@ export class InputRecorderController {
    *   .start();
    * // Stop the input recorder
    * inputRecordController.stop();
+   *
+   * // Record all keyboard and mouse events into a binary file
+   * const inputRecordController = Actionify.input.track
+   *   .record()
+   *   .into("/path/to/input-record.act")
+   *   .start({ format: "binary" });
+   * // Stop the input recorder
+   * const { events, droppedEvents, duration } = await inputRecordController.stop();
    */
-  public stop() {
-    this.#inputRecorderScopeController.writeStream.end();
+  public async stop(): Promise<InputRecordingStats | undefined> {
+    const nativeRecorderId = this.#inputRecorderScopeController.nativeRecorderId;
+    const nativeInputRecorderIndex = InputEventService.nativeInputRecorders.indexOf(this.#inputRecorderScopeController);
+    if (nativeRecorderId !== undefined && nativeInputRecorderIndex !== -1) {
+      InputEventService.nativeInputRecorders.splice(nativeInputRecorderIndex, 1);
+      const stats = stopInputRecording(nativeRecorderId);
+      if (InputEventService.shouldStopMainListener) {
+        stopInputEventListener();
+      }
+      return stats;
+    }
+    this.#inputRecorderScopeController.writeStream?.end();
     const inputRecorderIndex = InputEventService.inputRecorders.indexOf(this.#inputRecorderScopeController);
     if (inputRecorderIndex !== -1) {
       InputEventService.inputRecorders.splice(inputRecorderIndex, 1);
+      InputEventService.updateInputEventFilter();
     }
     if (InputEventService.shouldStopMainListener) {
       stopInputEventListener();
     }
+    return undefined;
   }
 
   /**
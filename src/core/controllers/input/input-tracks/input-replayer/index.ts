@@ -0,0 +1 @@
+export * from './input-replayer.controller';
@@ -0,0 +1,163 @@
+import {
+  seekInputReplay,
+  setInputReplayPaused,
+  startInputReplay,
+  stopInputReplay,
+} from "../../../../../addon";
+import type { InputReplayStats } from "../../../../../core/types";
+import { Inspectable } from "../../../../../core/utilities";
+
+/**
+ * @description A running input replay. The input events are sent natively from a dedicated thread, each on an absolute deadline,
+ * so that delays never drift however busy the JavaScript event loop is.
+ *
+ * The controller is a promise of the end of the replay, which resolves to its {@link InputReplayStats}.
+ */
+export class InputReplayerController implements Promise<InputReplayStats> {
+
+  public readonly [Symbol.toStringTag] = "InputReplayerController";
+  readonly #done: Promise<InputReplayStats>;
+  #replayerId: number | undefined = undefined;
+  #isPaused = false;
+  #seekPosition: number | undefined = undefined;
+  #isStopped = false;
+
+  /**
+   * @param source A binary input recording file path, or input event records of type | input | state | x | y | timestamp | flags,
+   * resolved once the recording was read.
+   * @param speed The replay speed factor.
+   */
+  public constructor(source: Promise<string | Float64Array>, speed: number) {
+    this.#done = source.then((resolvedSource) => {
+      if (this.#isStopped) {
+        return { events: 0, duration: 0, lateness: { mean: 0, p50: 0, p95: 0, p99: 0, max: 0 } };
+      }
+      const { id, done } = startInputReplay(resolvedSource, speed);
+      this.#replayerId = id;
+      // Apply the commands received while the recording was read
+      if (this.#isPaused) {
+        setInputReplayPaused(id, true);
+      }
+      if (this.#seekPosition !== undefined) {
+        seekInputReplay(id, this.#seekPosition);
+      }
+      return done;
+    });
+  }
+
+  /**
+   * @description Pause the replay. Keys and mouse buttons held by the replay are released.
+   *
+   * @returns The input replay controller.
+   *
+   * ---
+   * @example
+   * const inputReplay = Actionify.input.track.replay("/path/to/input-record.act");
+   * // Pause the replay
+   * inputReplay.pause();
+   */
+  public pause() {
+    this.#isPaused = true;
+    if (this.#replayerId !== undefined) {
+      setInputReplayPaused(this.#replayerId, true);
+    }
+    return this;
+  }
+
+  /**
+   * @description Resume the paused replay where it was paused.
+   *
+   * @returns The input replay controller.
+   *
+   * ---
+   * @example
+   * const inputReplay = Actionify.input.track.replay("/path/to/input-record.act");
+   * // Pause the replay
+   * inputReplay.pause();
+   * // Resume the replay
+   * inputReplay.resume();
+   */
+  public resume() {
+    this.#isPaused = false;
+    if (this.#replayerId !== undefined) {
+      setInputReplayPaused(this.#replayerId, false);
+    }
+    return this;
+  }
+
+  /**
+   * @description Continue the replay from the given time of the recording. Keys and mouse buttons held by the replay are released.
+   *
+   * @param position The time since the first recorded input event in milliseconds.
+   * @returns The input replay controller.
+   *
+   * ---
+   * @example
+   * const inputReplay = Actionify.input.track.replay("/path/to/input-record.act");
+   * // Skip to the 10th second of the recording
+   * inputReplay.seek(10000);
+   * // Replay again from the start
+   * inputReplay.seek(0);
+   */
+  public seek(position: number) {
+    this.#seekPosition = Math.max(0, position);
+    if (this.#replayerId !== undefined) {
+      seekInputReplay(this.#replayerId, this.#seekPosition);
+    }
+    return this;
+  }
+
+  /**
+   * @description Stop the replay. Keys and mouse buttons held by the replay are released.
+   *
+   * @returns A promise that resolves to the statistics of the input events sent so far.
+   *
+   * ---
+   * @example
+   * const inputReplay = Actionify.input.track.replay("/path/to/input-record.act");
+   * // Stop the replay
+   * const { events, lateness } = await inputReplay.stop();
+   */
+  public stop(): Promise<InputReplayStats> {
+    this.#isStopped = true;
+    if (this.#replayerId !== undefined) {
+      stopInputReplay(this.#replayerId);
+    }
+    return this.#done;
+  }
+
+  /**
+   * @description Wait for the end of the replay.
+   */
+  public then<TResult1 = InputReplayStats, TResult2 = never>(
+    onfulfilled?: ((value: InputReplayStats) => TResult1 | PromiseLike<TResult1>) | null,
+    onrejected?: ((reason: any) => TResult2 | PromiseLike<TResult2>) | null,
+  ): Promise<TResult1 | TResult2> {
+    return this.#done.then(onfulfilled, onrejected);
+  }
+
+  /**
+   * @description Handle a failure of the replay.
+   */
+  public catch<TResult = never>(
+    onrejected?: ((reason: any) => TResult | PromiseLike<TResult>) | null,
+  ): Promise<InputReplayStats | TResult> {
+    return this.#done.catch(onrejected);
+  }
+
+  /**
+   * @description Run a callback once the replay ended, whether it succeeded or failed.
+   */
+  public finally(onfinally?: (() => void) | null): Promise<InputReplayStats> {
+    return this.#done.finally(onfinally);
+  }
+
+  /**
+   * @description Customize the default inspect output (with `console.log`) of a
+   * class instance.
+   */
+  public [Symbol.for('nodejs.util.inspect.custom')](depth: number, inspectOptions: object, inspect: Function) {
+    return Inspectable.format(this, depth, inspectOptions, inspect);
+  }
+
+}
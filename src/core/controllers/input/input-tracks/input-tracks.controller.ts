@@ -1,5 +1,8 @@
+import fs from "fs";
+import path from "path";
 import { Actionify } from "../../../../core";
 import { InputRecorderSettingsBuilder } from "../../../../core/builders";
+import { InputReplayerController } from "../../../../core/controllers";
 import { KeyFormatter, KeyMapper } from "../../../../core/services";
 import type {
   CaseInsensitiveKey,
@@ -67,10 +70,11 @@ export class InputTracksController {
   }
 
   /**
-   * @description Replay all input events from a previous `track.record` file.
+   * @description Replay all input events from a previous `track.record` file. The input events are sent natively from a
+   * dedicated thread, each on an absolute deadline: delays never drift, however busy the JavaScript event loop is.
    *
-   * @param filepath The file path of a previous `track.record` file.
-   * @returns A promise that resolves when all the input events have been replayed.
+   * @param filepath The file path of a previous `track.record` file, in text or binary format.
+   * @returns The input replay controller, which resolves to the replay statistics once all the input events have been replayed.
    *
    * ---
    * @example
@@ -82,17 +86,36 @@ export class InputTracksController {
    *
    * // Replay all keyboard and mouse events twice slower
    * await Actionify.input.track.replay("/path/to/input-record.act", { speed: 0.5 });
+   *
+   * // Replay from the 10th second, pause and resume
+   * const inputReplay = Actionify.input.track.replay("/path/to/input-record.act").seek(10000);
+   * inputReplay.pause();
+   * inputReplay.resume();
+   * // Get how late the input events were sent
+   * const { events, lateness } = await inputReplay;
    */
-  public async replay(filepath: string, options?: { speed?: number }) {
+  public replay(filepath: string, options?: { speed?: number }) {
+    const speed = Math.max(1e-32, options?.speed ?? 1);
+    let source: Promise<string | Float64Array>;
     if (!Actionify.filesystem.exists(filepath)) {
-      throw new Error(`File does not exist: ${filepath}`);
+      source = Promise.reject(new Error(`File does not exist: ${filepath}`));
+    }
+    else if (InputTracksController.#isBinaryRecording(filepath)) {
+      source = Promise.resolve(path.resolve(filepath));
+    }
+    else {
+      source = InputTracksController.#readTextRecording(filepath);
     }
+    return new InputReplayerController(source, speed);
+  }
+
+  /**
+   * @description Read a text recording into input event records of type | input | state | x | y | timestamp | flags.
+   */
+  static #readTextRecording(filepath: string): Promise<Float64Array> {
+    const records: number[] = [];
     const readStream = Actionify.filesystem.readStream(filepath);
     let previousIncompleteLine = "";
-    let previousTimestamp = Infinity;
-    let accumulatedDelay = 0;
-    const speed = Math.max(1e-32, options?.speed ?? 1);
-    const promises: Promise<void>[] = [];
     readStream.on("data", (chunk) => {
       const lines = `${previousIncompleteLine}${chunk.toString()}`.split("\n");
       previousIncompleteLine = "";
@@ -103,137 +126,35 @@ export class InputTracksController {
         const isLastLine = (lineIndex === (lines.length - 1));
         const isValidLine = [0, 1].includes(lineType) && (lineColumns.length === (lineType === 0 ? 6 : 4));
         if (isValidLine) {
-          const type = lineType === 0 ? "mouse" : "keyboard";
-          const timestamp = parseInt(lineColumns[1]);
-          const delay = previousTimestamp < timestamp ? (Math.round(timestamp / speed) - Math.round(previousTimestamp / speed)) : 0;
-          previousTimestamp = timestamp;
-          const promise = Actionify.time.waitAsync(delay + accumulatedDelay, () => {
-            if (type === "mouse") {
-              const rawInput = parseInt(lineColumns[2]);
-              switch (rawInput) {
-                case 0: {
-                  const input: MouseInput = "move";
-                  const x = parseInt(lineColumns[4]);
-                  const y = parseInt(lineColumns[5]);
-                  Actionify.mouse.move(x, y);
-                  break;
-                }
-                case 1: {
-                  const input: MouseInput = "left";
-                  const state: MouseState = parseInt(lineColumns[3]) === 0 ? "down" : "up";
-                  const x = parseInt(lineColumns[4]);
-                  const y = parseInt(lineColumns[5]);
-                  if (Actionify.mouse.x !== x || Actionify.mouse.y !== y) {
-                    Actionify.mouse.move(x, y);
-                  }
-                  if (state === "down") {
-                    Actionify.mouse.left.down();
-                  }
-                  else {
-                    Actionify.mouse.left.up();
-                  }
-                  break;
-                }
-                case 2: {
-                  const input: MouseInput = "right";
-                  const state: MouseState = parseInt(lineColumns[3]) === 0 ? "down" : "up";
-                  const x = parseInt(lineColumns[4]);
-                  const y = parseInt(lineColumns[5]);
-                  if (Actionify.mouse.x !== x || Actionify.mouse.y !== y) {
-                    Actionify.mouse.move(x, y);
-                  }
-                  if (state === "down") {
-                    Actionify.mouse.right.down();
-                  }
-                  else {
-                    Actionify.mouse.right.up();
-                  }
-                  break;
-                }
-                case 3: {
-                  const input: MouseInput = "middle";
-                  const state: MouseState = parseInt(lineColumns[3]) === 0 ? "down" : "up";
-                  const x = parseInt(lineColumns[4]);
-                  const y = parseInt(lineColumns[5]);
-                  if (Actionify.mouse.x !== x || Actionify.mouse.y !== y) {
-                    Actionify.mouse.move(x, y);
-                  }
-                  if (state === "down") {
-                    Actionify.mouse.middle.down();
-                  }
-                  else {
-                    Actionify.mouse.middle.up();
-                  }
-                  break;
-                }
-                case 4: {
-                  const input: MouseInput = "wheel";
-                  const rawState = parseInt(lineColumns[3]);
-                  const state: MouseState = rawState === 0 ? "down" : (rawState === 1 ? "up" : "neutral");
-                  const x = parseInt(lineColumns[4]);
-                  const y = parseInt(lineColumns[5]);
-                  if (Actionify.mouse.x !== x || Actionify.mouse.y !== y) {
-                    Actionify.mouse.move(x, y);
-                  }
-                  switch (state) {
-                    case "down":
-                      Actionify.mouse.scroll.down();
-                      break;
-                    case "up":
-                      Actionify.mouse.scroll.up();
-                      break;
-                    default:
-                      break;
-                  }
-                  break;
-                }
-                case 5:
-                case 6:
-                  const buttonNumber = rawInput === 5 ? 1 : 2;
-                  const input: MouseInput = `extraButton${buttonNumber}`;
-                  const state: MouseState = parseInt(lineColumns[3]) === 0 ? "down" : "up";
-                  const x = parseInt(lineColumns[4]);
-                  const y = parseInt(lineColumns[5]);
-                  if (Actionify.mouse.x !== x || Actionify.mouse.y !== y) {
-                    Actionify.mouse.move(x, y);
-                  }
-                  if (state === "down") {
-                    Actionify.mouse.extraButton(buttonNumber).down();
-                  }
-                  else {
-                    Actionify.mouse.extraButton(buttonNumber).up();
-                  }
-                default:
-                  break;
-              }
-            }
-            else {
-              const input = parseInt(lineColumns[2]);
-              const state = parseInt(lineColumns[3]) === 0 ? "down" : "up";
-              if (state === "down") {
-                Actionify.keyboard.down(input);
-              }
-              else {
-                Actionify.keyboard.up(input);
-              }
-            }
-          });
-          promises.push(promise);
-          accumulatedDelay += delay;
+          const x = lineType === 0 ? parseInt(lineColumns[4]) : 0;
+          const y = lineType === 0 ? parseInt(lineColumns[5]) : 0;
+          records.push(lineType, parseInt(lineColumns[2]), parseInt(lineColumns[3]), x, y, parseInt(lineColumns[1]), 0);
         }
         else if (isLastLine) {
           previousIncompleteLine = line;
         }
       }
     });
-    return new Promise<void>((resolve, reject) => {
-      readStream.on("end", async () => {
-        await Promise.all(promises);
-        resolve();
-      });
+    return new Promise<Float64Array>((resolve, reject) => {
+      readStream.on("error", reject);
+      readStream.on("end", () => resolve(Float64Array.from(records)));
     });
   }
 
+  /**
+   * @description Whether the given file is a binary input recording (see `InputRecorderOptions.format`).
+   */
+  static #isBinaryRecording(filepath: string): boolean {
+    const magic = Buffer.alloc(8);
+    const fileDescriptor = fs.openSync(filepath, "r");
+    try {
+      return fs.readSync(fileDescriptor, magic, 0, 8, 0) === 8 && magic.toString("latin1") === "ACTINP01";
+    }
+    finally {
+      fs.closeSync(fileDescriptor);
+    }
+  }
+
   /**
    * @description Customize the default inspect output (with `console.log`) of a
    * class instance.
@@ -1,5 +1,7 @@
+import { InputSequenceBuilder } from "../../../core/builders";
 import {
   InputEventsController,
+  InputStateController,
   InputTracksController,
 } from "../../../core/controllers";
 import { Inspectable } from "../../../core/utilities";
@@ -10,10 +12,12 @@ import { Inspectable } from "../../../core/utilities";
 export class InputController {
 
   #inputEventsController: InputEventsController;
+  #inputStateController: InputStateController;
   #inputTracksController: InputTracksController;
 
   public constructor() {
     this.#inputEventsController = new InputEventsController();
+    this.#inputStateController = new InputStateController();
     this.#inputTracksController = new InputTracksController();
   }
 
@@ -24,6 +28,13 @@ export class InputController {
     return this.#inputEventsController;
   }
 
+  /**
+   * @description Current keyboard, mouse buttons and cursor state.
+   */
+  public get state(): InputStateController {
+    return this.#inputStateController;
+  }
+
   /**
    * @description Input events recorder and replayer.
    */
@@ -31,6 +42,27 @@ export class InputController {
     return this.#inputTracksController;
   }
 
+  /**
+   * @description Build a sequence of mouse and keyboard events, sent natively
+   * with microsecond timing. Unlike separate calls, the events of a sequence
+   * never wait for the JavaScript event loop, thus keep their exact timing.
+   *
+   * @returns A new input sequence.
+   *
+   * ---
+   * @example
+   * // Drag and drop from (100, 100) to (500, 300)
+   * await Actionify.input.sequence()
+   *   .move(100, 100)
+   *   .down("left")
+   *   .wait(100).move(500, 300)
+   *   .wait(100).up("left")
+   *   .send();
+   */
+  public sequence() {
+    return new InputSequenceBuilder();
+  }
+
   /**
    * @description Customize the default inspect output (with `console.log`) of a
    * class instance.
@@ -1,2 +1,3 @@
 export * from './keyboard-events.controller';
+export * from './keyboard-hotkey';
 export * from './keyboard-listener-scope';
@@ -1,15 +1,18 @@
 import {
+  registerHotkey,
   startInputEventListener,
   stopInputEventListener,
   suppressInputEvents,
   unsuppressInputEvents,
 } from "../../../../addon";
 import { KeyboardListenerScopeBuilder } from "../../../../core/builders";
-import { LifecycleController } from "../../../../core/controllers";
+import { KeyboardHotkeyController, LifecycleController } from "../../../../core/controllers";
 import { InputEventService, KeyFormatter, KeyMapper } from "../../../../core/services";
 import type {
   CaseInsensitiveKey,
   KeyAction,
+  KeyboardHotkey,
+  KeyboardHotkeyOptions,
   KeyboardListener,
   KeyboardListenerOptions,
   KeyState,
@@ -21,6 +24,16 @@ import { Inspectable } from "../../../../core/utilities";
  */
 export class KeyboardEventsController {
 
+  // Keys matching both their left and right keys in hotkeys
+  static readonly #sidedKeys: Record<string, Array<CaseInsensitiveKey<any>>> = {
+    "shift": ["left_shift", "right_shift"],
+    "ctrl": ["left_ctrl", "right_ctrl"],
+    "control": ["left_ctrl", "right_ctrl"],
+    "alt": ["left_alt", "right_alt"],
+    "win": ["left_win", "right_win"],
+    "windows": ["left_win", "right_win"],
+  };
+
   public constructor() { }
 
   /**
@@ -69,6 +82,66 @@ export class KeyboardEventsController {
     return new KeyboardListenerScopeBuilder(keyboardActions);
   }
 
+  /**
+   * @description Register a hotkey: a key chord such as `"ctrl+shift+k"`, or a sequence of chords separated by spaces
+   * such as `"g g"` or `"ctrl+k ctrl+c"`. Hotkeys are matched natively as keyboard events occur, and JavaScript is only
+   * called back when one matches: unlike listeners, they cost nothing while other keys are pressed.
+   *
+   * A chord matches when its last key is pressed while exactly its keys are held. `ctrl`, `shift`, `alt` and `win`
+   * match both their left and right keys.
+   *
+   * @param hotkey The hotkey to match.
+   * @param keyboardHotkey Called on every match.
+   * @param keyboardHotkeyOptions The hotkey options. See {@link KeyboardHotkeyOptions}.
+   * @returns The hotkey controller.
+   *
+   * ---
+   * @example
+   * // Match [Control] + [Shift] + [K]
+   * Actionify.keyboard.events.hotkey("ctrl+shift+k", (hotkeyEvent, hotkeyController) => console.log(hotkeyEvent));
+   *
+   * // Match [G] pressed twice within 300 ms
+   * Actionify.keyboard.events.hotkey("g g", (hotkeyEvent, hotkeyController) => console.log(hotkeyEvent));
+   *
+   * // Match [Control] + [K] then [Control] + [C] within 1 second, from hardware/driver only keyboard events
+   * Actionify.keyboard.events.hotkey(
+   *   "ctrl+k ctrl+c",
+   *   (hotkeyEvent, hotkeyController) => console.log(hotkeyEvent),
+   *   { timeout: 1000, ignoreInjected: true }
+   * );
+   */
+  public hotkey(hotkey: string, keyboardHotkey: KeyboardHotkey, keyboardHotkeyOptions?: KeyboardHotkeyOptions) {
+    // Sequence of chords, chords of keys, keys of alternative key codes
+    const sequence = hotkey.trim().split(/\s+/).map((chord) => chord.split("+").map((key) => {
+      const formattedKey = KeyFormatter.format(key);
+      const sides = KeyboardEventsController.#sidedKeys[formattedKey];
+      if (sides) {
+        return sides.map((side) => KeyMapper.toKeyCode(side));
+      }
+      return [KeyMapper.toKeyCode(formattedKey)];
+    }));
+    let keyboardHotkeyController: KeyboardHotkeyController | undefined;
+    const hotkeyId = registerHotkey(
+      sequence,
+      {
+        timeout: Math.max(0, Math.floor(keyboardHotkeyOptions?.timeout ?? 300)),
+        ignoreInjected: keyboardHotkeyOptions?.ignoreInjected ?? false,
+      },
+      (timestamp) => {
+        if (keyboardHotkeyController) {
+          keyboardHotkey({ hotkey, timestamp }, keyboardHotkeyController);
+        }
+      }
+    );
+    keyboardHotkeyController = new KeyboardHotkeyController(hotkeyId, hotkey);
+    InputEventService.keyboardHotkeys.push(keyboardHotkeyController);
+    if (InputEventService.shouldStartMainListener) {
+      LifecycleController.cleanBeforeExit();
+      startInputEventListener(InputEventService.mainListener);
+    }
+    return keyboardHotkeyController;
+  }
+
   /**
    * @description Resume the given paused keyboard listener.
    *
@@ -134,6 +207,7 @@ export class KeyboardEventsController {
     const listenerIndex = InputEventService.keyboardListeners.findIndex((keyboardListener) => keyboardListener.listener === listener);
     if (listenerIndex !== -1) {
       InputEventService.keyboardListeners.splice(listenerIndex, 1);
+      InputEventService.updateInputEventFilter();
     }
     if (InputEventService.shouldStopMainListener) {
       stopInputEventListener();
@@ -0,0 +1,56 @@
+import {
+  stopInputEventListener,
+  unregisterHotkey,
+} from "../../../../../addon";
+import { InputEventService } from "../../../../../core/services";
+import { Inspectable } from "../../../../../core/utilities";
+
+/**
+ * @description A registered hotkey, matched natively on the input listener thread.
+ */
+export class KeyboardHotkeyController {
+
+  readonly #hotkeyId: number;
+  readonly #hotkey: string;
+
+  public constructor(hotkeyId: number, hotkey: string) {
+    this.#hotkeyId = hotkeyId;
+    this.#hotkey = hotkey;
+  }
+
+  /**
+   * @description The hotkey, as registered.
+   */
+  public get hotkey(): string {
+    return this.#hotkey;
+  }
+
+  /**
+   * @description Stop matching the hotkey.
+   *
+   * ---
+   * @example
+   * const hotkeyController = Actionify.keyboard.events.hotkey("ctrl+shift+k", () => console.log("Hotkey!"));
+   * hotkeyController.stop();
+   */
+  public stop(): void {
+    const hotkeyIndex = InputEventService.keyboardHotkeys.indexOf(this);
+    if (hotkeyIndex === -1) {
+      return;
+    }
+    InputEventService.keyboardHotkeys.splice(hotkeyIndex, 1);
+    unregisterHotkey(this.#hotkeyId);
+    if (InputEventService.shouldStopMainListener) {
+      stopInputEventListener();
+    }
+  }
+
+  /**
+   * @description Customize the default inspect output (with `console.log`) of a
+   * class instance.
+   */
+  public [Symbol.for('nodejs.util.inspect.custom')](depth: number, inspectOptions: object, inspect: Function) {
+    return Inspectable.format(this, depth, inspectOptions, inspect);
+  }
+
+}
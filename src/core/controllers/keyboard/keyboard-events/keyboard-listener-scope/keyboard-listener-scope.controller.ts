@@ -28,6 +28,7 @@ export class KeyboardListenerScopeController {
     this.#currentRunners = 0;
     this.#shouldIgnoreInjectedInputEvents = keyboardListenerOptions?.ignoreInjected ?? false;
     InputEventService.keyboardListeners.push(this);
+    InputEventService.updateInputEventFilter();
     if (InputEventService.shouldStartMainListener) {
       LifecycleController.cleanBeforeExit();
       startInputEventListener(InputEventService.mainListener);
@@ -40,6 +41,7 @@ export class KeyboardListenerScopeController {
 
   public set ignoreInjected(ignoreInjected: boolean) {
     this.#shouldIgnoreInjectedInputEvents = ignoreInjected;
+    InputEventService.updateInputEventFilter();
   }
 
   public get isPaused() {
@@ -30,6 +30,7 @@ export class KeyboardListenerController implements IKeyboardListenerController {
     const listenerIndex = InputEventService.keyboardListeners.findIndex((keyboardListener) => keyboardListener.listener === this.#keyboardListenerScopeController.listener);
     if (listenerIndex !== -1) {
       InputEventService.keyboardListeners.splice(listenerIndex, 1);
+      InputEventService.updateInputEventFilter();
     }
     if (InputEventService.shouldStopMainListener) {
       stopInputEventListener();
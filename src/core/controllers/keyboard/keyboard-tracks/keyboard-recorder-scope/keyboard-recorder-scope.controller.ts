@@ -26,6 +26,7 @@ export class KeyboardRecorderScopeController {
     this.#keyboardRecorderController = new KeyboardRecorderController(this);
     this.#shouldIgnoreInjectedInputEvents = keyboardRecorderOptions?.ignoreInjected ?? false;
     InputEventService.keyboardRecorders.push(this);
+    InputEventService.updateInputEventFilter();
     if(InputEventService.shouldStartMainListener) {
       LifecycleController.cleanBeforeExit();
       startInputEventListener(InputEventService.mainListener);
@@ -38,6 +39,7 @@ export class KeyboardRecorderScopeController {
 
   public set ignoreInjected(ignoreInjected: boolean) {
     this.#shouldIgnoreInjectedInputEvents = ignoreInjected;
+    InputEventService.updateInputEventFilter();
   }
 
   public get isPaused() {
@@ -101,6 +101,7 @@ export class KeyboardRecorderController {
     const keyboardRecorderIndex = InputEventService.keyboardRecorders.indexOf(this.#keyboardRecorderScopeController);
     if (keyboardRecorderIndex !== -1) {
       InputEventService.keyboardRecorders.splice(keyboardRecorderIndex, 1);
+      InputEventService.updateInputEventFilter();
     }
     if (InputEventService.shouldStopMainListener) {
       stopInputEventListener();
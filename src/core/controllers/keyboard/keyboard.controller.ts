@@ -2,7 +2,7 @@ import { Actionify } from "../../../core";
 import {
   keyPressDown,
   keyPressUp,
-  typeUnicodeCharacter,
+  typeText,
 } from "../../../addon";
 import { KeyboardEventsController, KeyboardTracksController } from "../../../core/controllers";
 import { KeyMapper } from "../../../core/services";
@@ -127,7 +127,14 @@ export class KeyboardController {
   /**
    * @description Type the given text.
    *
+   * Characters are typed natively, in order, without interleaving with input sequences.
+   * On Linux, characters missing from the keyboard layout are typed by temporarily remapping spare key codes.
+   * Control characters other than tabs and line breaks (such as `"\b"` or `"\x1b"`) cannot be typed: the promise rejects
+   * without typing anything.
+   *
    * @param text The text to type.
+   * @param options.delay The time to type the whole text over, in milliseconds. If unset, `0` will be used.
+   * @param options.interval The time to wait before each character, in milliseconds. If set, it overrides `options.delay`.
    * @returns A promise which resolves after the text has been typed.
    *
    * ---
@@ -151,20 +158,16 @@ export class KeyboardController {
    * world!
    * 👋
    * `, { delay: 1000 });
+   *
+   * // Type "Hello, world!" with 50 milliseconds between characters
+   * await Actionify.keyboard.type("Hello, world!", { interval: 50 });
    */
-  public async type(text: string, options?: { delay?: number }) {
-    const segmenter = new Intl.Segmenter("en", { granularity: "grapheme" }); // requires ES2022 support
-    const characters = Array.from(segmenter.segment(text)).map((segmentData) => segmentData.segment);
-    const delay = Math.max(0, Math.floor(options?.delay ?? 0)) / characters.length;
-    let accumulatedDelay = 0;
-    const promises = [];
-    for (const character of characters) {
-      accumulatedDelay += delay;
-      promises.push(
-        Actionify.time.waitAsync(accumulatedDelay, () => typeUnicodeCharacter(character))
-      );
-    }
-    await Promise.all(promises);
+  public async type(text: string, options?: { delay?: number, interval?: number }) {
+    const characterCount = Math.max(1, Array.from(text).length);
+    const interval = options?.interval !== undefined
+      ? Math.max(0, options.interval)
+      : Math.max(0, Math.floor(options?.delay ?? 0)) / characterCount;
+    return typeText(text, Math.floor(interval * 1000));
   }
 
   /**
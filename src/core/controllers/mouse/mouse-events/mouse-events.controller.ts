@@ -134,6 +134,7 @@ export class MouseEventsController {
     const listenerIndex = InputEventService.mouseListeners.findIndex((mouseListener) => mouseListener.listener === listener);
     if (listenerIndex !== -1) {
       InputEventService.mouseListeners.splice(listenerIndex, 1);
+      InputEventService.updateInputEventFilter();
     }
     if (InputEventService.shouldStopMainListener) {
       stopInputEventListener();
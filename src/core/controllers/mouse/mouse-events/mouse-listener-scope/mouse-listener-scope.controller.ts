@@ -31,6 +31,7 @@ export class MouseListenerScopeController {
     this.#currentRunners = 0;
     this.#shouldIgnoreInjectedInputEvents = mouseListenerOptions?.ignoreInjected ?? false;
     InputEventService.mouseListeners.push(this);
+    InputEventService.updateInputEventFilter();
     if (InputEventService.shouldStartMainListener) {
       LifecycleController.cleanBeforeExit();
       startInputEventListener(InputEventService.mainListener);
@@ -43,6 +44,7 @@ export class MouseListenerScopeController {
 
   public set ignoreInjected(ignoreInjected: boolean) {
     this.#shouldIgnoreInjectedInputEvents = ignoreInjected;
+    InputEventService.updateInputEventFilter();
   }
 
   public get isPaused() {
@@ -30,6 +30,7 @@ export class MouseListenerController implements IMouseListenerController {
     const listenerIndex = InputEventService.mouseListeners.findIndex((mouseListener) => mouseListener.listener === this.#mouseListenerScopeController.listener);
     if (listenerIndex !== -1) {
       InputEventService.mouseListeners.splice(listenerIndex, 1);
+      InputEventService.updateInputEventFilter();
     }
     if (InputEventService.shouldStopMainListener) {
       stopInputEventListener();
@@ -26,6 +26,7 @@ export class MouseRecorderScopeController {
     this.#mouseRecorderController = new MouseRecorderController(this);
     this.#shouldIgnoreInjectedInputEvents = mouseRecorderOptions?.ignoreInjected ?? false;
     InputEventService.mouseRecorders.push(this);
+    InputEventService.updateInputEventFilter();
     if (InputEventService.shouldStartMainListener) {
       LifecycleController.cleanBeforeExit();
       startInputEventListener(InputEventService.mainListener);
@@ -38,6 +39,7 @@ export class MouseRecorderScopeController {
 
   public set ignoreInjected(ignoreInjected: boolean) {
     this.#shouldIgnoreInjectedInputEvents = ignoreInjected;
+    InputEventService.updateInputEventFilter();
   }
 
   public get isPaused() {
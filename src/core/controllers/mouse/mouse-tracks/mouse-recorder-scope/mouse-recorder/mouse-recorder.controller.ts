@@ -93,6 +93,7 @@ export class MouseRecorderController {
     const mouseRecorderIndex = InputEventService.mouseRecorders.indexOf(this.#mouseRecorderScopeController);
     if (mouseRecorderIndex !== -1) {
       InputEventService.mouseRecorders.splice(mouseRecorderIndex, 1);
+      InputEventService.updateInputEventFilter();
     }
     if (InputEventService.shouldStopMainListener) {
       stopInputEventListener();
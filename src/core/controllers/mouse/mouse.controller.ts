@@ -1,6 +1,7 @@
 import { Actionify } from "../../../core";
 import {
   getCursorPos,
+  moveCursorSmoothly,
   setCursorPos,
 } from "../../../addon";
 import {
@@ -150,12 +151,15 @@ export class MouseController {
    * @param y The new mouse Y position. If unset, the current mouse Y position will be used.
    * @param options.delay Delay in milliseconds before the mouse movement is complete.
    * @param options.motion The type of motion to use. If unset, `linear` will be used.
+   * `human` follows a randomly curved path, slow at both ends and fast in the middle.
    * @param options.steps The number of intermediate mouse position between the current and the given new position.
    * If unset, there will be no intermediate mouse positions. Thus, the mouse movement will be instant.
-   * You can use `auto` to evenly distribute the intermediate mouse positions considering the `delay` specified and the distance between the start and end positions.
-   * @param options.curvinessFactor The curve amplitude for `arc` and `wave` motions. If unset, `0.1618` will be used.
-   * @param options.frequency The wave frequency for `wave` motion. If unset, the maximum value between `2` and the closest even number below `steps / 60` will be used.
-   * @param options.mirror If set to `true`, the mouse movement (for `arc` and `wave`) will be mirrored.
+   * You can use `auto` to send one intermediate mouse position per refresh of the monitor during the `delay` specified.
+   * @param options.curvinessFactor The curve amplitude for `arc`, `wave` and `human` motions. If unset, `0.1618` will be used.
+   * @param options.frequency The wave frequency for `wave` motion. If unset, `1` will be used.
+   * You can use `auto` to get the maximum value between `1` and the closest integer below `steps / 120`.
+   * @param options.mirror If set to `true`, the mouse movement (for `arc`, `wave` and `human`) will be mirrored.
+   * @param options.jitter The maximum random offset in pixels of intermediate mouse positions. If unset, `0` will be used.
    * @returns A promise that resolves when the mouse movement is complete.
    *
    * ---
@@ -174,13 +178,13 @@ export class MouseController {
    *
    * // Wave motion over time
    * await Actionify.mouse.move(100, 100, { motion: "wave", delay: 1000, steps: "auto", frequency: "auto" });
+   *
+   * // Human-like motion over time, slightly shaky
+   * await Actionify.mouse.move(100, 100, { motion: "human", delay: 400, steps: "auto", jitter: 1 });
    */
-  public move(x?: number, y?: number, options?: { steps?: number | "auto", delay?: number, motion?: "linear" | "arc" | "wave", curvinessFactor?: number, mirror?: boolean, frequency?: number | "auto" }) {
+  public move(x?: number, y?: number, options?: { steps?: number | "auto", delay?: number, motion?: "linear" | "arc" | "wave" | "human", curvinessFactor?: number, mirror?: boolean, frequency?: number | "auto", jitter?: number }) {
     const steps = options?.steps === "auto" ? Infinity : Math.max(0, Math.round(options?.steps ?? 0));
     const delay = Math.max(0, Math.floor(options?.delay ?? 0));
-    const curvinessFactor = options?.curvinessFactor !== undefined ? Math.max(0, Math.min(1, options.curvinessFactor)) : 0.1618;
-    const mirror = options?.mirror ?? false;
-    const motion = options?.motion ?? "linear";
     const initialX = this.x;
     const initialY = this.y;
     const newX = x ?? initialX;
@@ -188,114 +192,20 @@ export class MouseController {
     if (steps === 0 || delay === 0) {
       return Actionify.time.waitAsync(delay, () => setCursorPos(newX, newY));
     }
-    //Calculate the line from start to end (the shortest diagonal)
-    const dx = newX - initialX;
-    const dy = newY - initialY;
-    // Chebyshev distance
-    const intermediatePositions = Math.max(0, Math.max(Math.abs(dx), Math.abs(dy)) - 1);
-    const possibleSteps = Math.min(delay, steps, intermediatePositions);
-    const preciseDelayPerPosition = delay / (possibleSteps + 1);
-    const delayPerPosition = Math.floor(preciseDelayPerPosition);
-    let accumulatedDelay = 0;
-    const promises: Promise<void>[] = [];
-    if (possibleSteps > 0) {
-      const correctionDelayOccurrence = preciseDelayPerPosition !== delayPerPosition ? Math.ceil(1 / (preciseDelayPerPosition - delayPerPosition)) : Infinity;
-      const directionX = Math.sign(dx);
-      const directionY = Math.sign(dy);
-      const stepX = dx / (possibleSteps + 1);
-      const stepY = dy / (possibleSteps + 1);
-      switch (motion) {
-        case "linear": {
-          for (let offset = 1; offset < possibleSteps + 1; offset++) {
-            const intermediateX = directionX !== 0 ? Math.round(initialX + offset * stepX) : newX;
-            const intermediateY = directionY !== 0 ? Math.round(initialY + offset * stepY) : newY;
-            const correctedDelayPerPosition = delayPerPosition + (offset % correctionDelayOccurrence === 0 ? 1 : 0);
-            promises.push(Actionify.time.waitAsync(correctedDelayPerPosition + accumulatedDelay, () => setCursorPos(intermediateX, intermediateY)));
-            accumulatedDelay += correctedDelayPerPosition;
-          }
-          break;
-        }
-        case "arc": {
-          // Bézier curve
-          const midpointX = (initialX + newX) / 2;
-          const midpointY = (initialY + newY) / 2;
-          const distance = Math.sqrt(dx * dx + dy * dy);
-          const perpendicularX = -dy / distance;
-          const perpendicularY = dx / distance;
-          const direction = mirror ? -1 : 1;
-          const controlX = midpointX + curvinessFactor * distance * perpendicularX * direction;
-          const controlY = midpointY + curvinessFactor * distance * perpendicularY * direction;
-          for (let offset = 1; offset < possibleSteps + 1; offset++) {
-            const t = offset / (possibleSteps + 1);
-            const intermediateX = Math.round((1 - t) * (1 - t) * initialX + 2 * (1 - t) * t * controlX + t * t * newX);
-            const intermediateY = Math.round((1 - t) * (1 - t) * initialY + 2 * (1 - t) * t * controlY + t * t * newY);
-            const correctedDelayPerPosition = delayPerPosition + (offset % correctionDelayOccurrence === 0 ? 1 : 0);
-            promises.push(Actionify.time.waitAsync(correctedDelayPerPosition + accumulatedDelay, () => setCursorPos(intermediateX, intermediateY)));
-            accumulatedDelay += correctedDelayPerPosition;
-          }
-          break;
-        }
-        case "wave": {
-          const rawMaxFrequency = Math.floor((possibleSteps + 1) / 30 / 2);
-          const maxFrequency = rawMaxFrequency % 2 === 0 ? rawMaxFrequency : rawMaxFrequency - 1;
-          const frequency = options?.frequency !== undefined ? Math.max(2, Math.min(maxFrequency, options.frequency === "auto" ? maxFrequency : Math.round(options.frequency * 2))) : 2;
-          const distance = Math.sqrt(dx * dx + dy * dy);
-          const halfDistance = distance / 2;
-          const amplitude = curvinessFactor * halfDistance;
-          const mirrorDirection = mirror ? -1 : 1;
-          const directionX = dx / distance;
-          const directionY = dy / distance;
-          for (let offset = 1; offset < possibleSteps + 1; offset++) {
-            const t = offset / (possibleSteps + 1);
-            const sineWaveOffset = Math.sin(t * Math.PI * frequency) * amplitude * mirrorDirection;
-            const intermediateX = Math.round(initialX + t * dx + directionY * sineWaveOffset);
-            const intermediateY = Math.round(initialY + t * dy - directionX * sineWaveOffset);
-            const correctedDelayPerPosition = delayPerPosition + (offset % correctionDelayOccurrence === 0 ? 1 : 0);
-            promises.push(Actionify.time.waitAsync(correctedDelayPerPosition + accumulatedDelay, () => setCursorPos(intermediateX, intermediateY)));
-            accumulatedDelay += correctedDelayPerPosition;
-          }
-          break;
-        }
-        /* case "circle": {
-          // Determine radius using Euclidean distance
-          const diameter = Math.sqrt(dx * dx + dy * dy);
-          const radius = Math.round(diameter / 2);
-
-          // Determine midpoint
-          const midpointX = (initialX + newX) / 2;
-          const midpointY = (initialY + newY) / 2;
-
-          // Calculate the angle increment for each step
-          const startAngle = Math.atan2(initialY - midpointY, initialX - midpointX); // Angle of initial point
-          const endAngle = Math.atan2(newY - midpointY, newX - midpointX); // Angle of final point
-
-          const direction = mirror ? -1 : 1;
-
-          // Half-circle movement implies that the arc is in a 180-degree range
-          const angleDifference = (endAngle - startAngle) * direction;
-
-          // Ensure the angle difference is between -π and π (normalize angle range)
-          const angleStep = angleDifference / (possibleSteps + 1);
-
-          for (let offset = 1; offset < possibleSteps + 1; offset++) {
-            const angle = startAngle + offset * angleStep;
-            // Calculate intermediate point on the arc
-            const intermediateX = Math.round(midpointX + radius * Math.cos(angle));
-            const intermediateY = Math.round(midpointY + radius * Math.sin(angle));
-
-            // Set the cursor position at computed position and at given delay
-            const correctedDelayPerPosition = delayPerPosition + (offset % correctionDelayOccurrence === 0 ? 1 : 0);
-            promises.push(time.waitAsync(correctedDelayPerPosition + accumulatedDelay, () => setCursorPos(intermediateX, intermediateY)));
-            accumulatedDelay += correctedDelayPerPosition;
-          }
-          break;
-        } */
-        default:
-          break;
-      }
-    }
-    promises.push(Actionify.time.waitAsync(delay, () => setCursorPos(newX, newY)));
-    return Promise.all(promises);
+    // Intermediate positions are computed and sent natively on precise deadlines
+    return moveCursorSmoothly({
+      fromX: initialX,
+      fromY: initialY,
+      toX: newX,
+      toY: newY,
+      duration: delay,
+      motion: options?.motion ?? "linear",
+      curviness: options?.curvinessFactor !== undefined ? Math.max(0, Math.min(1, options.curvinessFactor)) : 0.1618,
+      frequency: options?.frequency === "auto" ? 0 : Math.max(0, options?.frequency ?? 1),
+      mirror: options?.mirror ?? false,
+      jitter: Math.max(0, options?.jitter ?? 0),
+      steps: steps === Infinity ? 0 : Math.min(steps, delay),
+    });
   }
 
   /**
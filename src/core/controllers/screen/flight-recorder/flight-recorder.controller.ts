@@ -0,0 +1,65 @@
+import path from "path";
+import {
+  dumpFlightRecorder,
+  stopFlightRecorder,
+} from "../../../../addon";
+import type { ScreenRecordingStats } from "../../../../core/types";
+import { Inspectable } from "../../../../core/utilities";
+
+/**
+ * @description A running flight recorder, keeping the last seconds of a screen area in memory.
+ */
+export class FlightRecorderController {
+
+  readonly #recorderId: number;
+
+  public constructor(recorderId: number) {
+    this.#recorderId = recorderId;
+  }
+
+  /**
+   * @description Write the frames currently held in memory to a screen recording file.
+   * The flight recorder keeps running: it can be dumped again later.
+   *
+   * @param filepath The file path to save the recording to. If unset, it will be saved in the current working directory as `flight-recorder_[year]-[month]-[day]_[hour]-[minute]-[second]-[millisecond].afr`.
+   * @returns A promise that resolves to the summary of the written recording.
+   *
+   * ---
+   * @example
+   * const flightRecorder = Actionify.screen.flightRecorder();
+   * try {
+   *   // Run the bot here...
+   * }
+   * catch (error) {
+   *   await flightRecorder.dump("/path/to/failure.afr");
+   * }
+   */
+  public async dump(filepath?: string): Promise<ScreenRecordingStats & { filepath: string }> {
+    const now = new Date();
+    const defaultFilepath = `flight-recorder_${now.getFullYear()}-${String(now.getMonth() + 1).padStart(2, "0")}-${String(now.getDate()).padStart(2, "0")}_${String(now.getHours()).padStart(2, "0")}-${String(now.getMinutes()).padStart(2, "0")}-${String(now.getSeconds()).padStart(2, "0")}-${String(now.getMilliseconds()).padStart(3, "0")}.afr`;
+    const absoluteFilePath = path.resolve(filepath ?? defaultFilepath);
+    const stats = await dumpFlightRecorder(this.#recorderId, absoluteFilePath);
+    return { ...stats, filepath: absoluteFilePath };
+  }
+
+  /**
+   * @description Stop the flight recorder and release its memory. Frames not dumped are lost.
+   *
+   * ---
+   * @example
+   * const flightRecorder = Actionify.screen.flightRecorder();
+   * flightRecorder.stop();
+   */
+  public stop(): void {
+    stopFlightRecorder(this.#recorderId);
+  }
+
+  /**
+   * @description Customize the default inspect output (with `console.log`) of a
+   * class instance.
+   */
+  public [Symbol.for('nodejs.util.inspect.custom')](depth: number, inspectOptions: object, inspect: Function) {
+    return Inspectable.format(this, depth, inspectOptions, inspect);
+  }
+
+}
@@ -0,0 +1 @@
+export * from './flight-recorder.controller';
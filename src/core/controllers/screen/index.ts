@@ -1,2 +1,5 @@
 export * from './screen.controller';
 export * from './screen-pixel';
+export * from './screen-recording';
+export * from './flight-recorder';
+export * from './screen-frame-feed';
@@ -0,0 +1 @@
+export * from './screen-frame-feed.controller';
@@ -0,0 +1,55 @@
+import {
+  stopScreenFrameFeed,
+} from "../../../../addon";
+import { Inspectable, ScreenFrameFeedReader } from "../../../../core/utilities";
+
+/**
+ * @description A running screen frame feed, capturing frames into shared memory.
+ */
+export class ScreenFrameFeedController {
+
+  readonly #feedId: number;
+  readonly #buffer: SharedArrayBuffer;
+  readonly #reader: ScreenFrameFeedReader;
+
+  public constructor(feedId: number, buffer: SharedArrayBuffer) {
+    this.#feedId = feedId;
+    this.#buffer = buffer;
+    this.#reader = new ScreenFrameFeedReader(buffer);
+  }
+
+  /**
+   * @description The shared memory frames are captured into. Send it to worker threads and read it with a `ScreenFrameFeedReader`.
+   */
+  public get buffer(): SharedArrayBuffer {
+    return this.#buffer;
+  }
+
+  /**
+   * @description A reader of the feed frames for the current thread.
+   */
+  public get reader(): ScreenFrameFeedReader {
+    return this.#reader;
+  }
+
+  /**
+   * @description Stop capturing frames. The last frames remain readable from the shared memory.
+   *
+   * ---
+   * @example
+   * const feed = Actionify.screen.feed();
+   * feed.stop();
+   */
+  public stop(): void {
+    stopScreenFrameFeed(this.#feedId);
+  }
+
+  /**
+   * @description Customize the default inspect output (with `console.log`) of a
+   * class instance.
+   */
+  public [Symbol.for('nodejs.util.inspect.custom')](depth: number, inspectOptions: object, inspect: Function) {
+    return Inspectable.format(this, depth, inspectOptions, inspect);
+  }
+
+}
@@ -0,0 +1 @@
+export * from './screen-recording.controller';
@@ -0,0 +1,52 @@
+import {
+  stopScreenRecording,
+} from "../../../../addon";
+import type { ScreenRecordingStats } from "../../../../core/types";
+import { Inspectable } from "../../../../core/utilities";
+
+/**
+ * @description An ongoing screen recording.
+ */
+export class ScreenRecordingController {
+
+  readonly #recorderId: number;
+  readonly #absoluteFilePath: string;
+  #stats?: Promise<ScreenRecordingStats>;
+
+  public constructor(recorderId: number, absoluteFilePath: string) {
+    this.#recorderId = recorderId;
+    this.#absoluteFilePath = absoluteFilePath;
+  }
+
+  /**
+   * @description The absolute filepath of the recording.
+   */
+  public get filepath(): string {
+    return this.#absoluteFilePath;
+  }
+
+  /**
+   * @description Stop the recording. Pending frames are encoded and the recording index is written before the promise resolves.
+   * Calling it several times returns the same result.
+   *
+   * @returns A promise that resolves to the recording summary, or rejects when the recording file could not be written (disk full...).
+   *
+   * ---
+   * @example
+   * const recording = Actionify.screen.record();
+   * await Actionify.time.waitAsync(10000);
+   * const { frames, droppedFrames, duration } = await recording.stop();
+   */
+  public stop(): Promise<ScreenRecordingStats> {
+    return this.#stats ??= stopScreenRecording(this.#recorderId);
+  }
+
+  /**
+   * @description Customize the default inspect output (with `console.log`) of a
+   * class instance.
+   */
+  public [Symbol.for('nodejs.util.inspect.custom')](depth: number, inspectOptions: object, inspect: Function) {
+    return Inspectable.format(this, depth, inspectOptions, inspect);
+  }
+
+}
@@ -1,10 +1,17 @@
 import path from "path";
 import {
+  captureMonitors,
+  findTextOnScreen,
   getAvailableScreens,
+  readScreenRecordingFrame,
+  startFlightRecorder,
+  startScreenFrameFeed,
+  startScreenRecording,
   takeScreenshotToFile,
 } from "../../../addon";
-import { ScreenPixelController } from "../../../core/controllers";
-import type { ScreenInfo } from "../../../core/types";
+import { FlightRecorderController, ScreenFrameFeedController, ScreenPixelController, ScreenRecordingController } from "../../../core/controllers";
+import { OcrLanguageService } from "../../../core/services";
+import type { MonitorCapture, OcrPreprocessing, OcrTextMatch, ScreenInfo, ScreenRecordingFrame } from "../../../core/types";
 import { Inspectable } from "../../../core/utilities";
 
 /**
@@ -70,6 +77,246 @@ export class ScreenController {
     return absoluteFilePath;
   }
 
+  /**
+   * @description Capture several monitors at once. Each monitor is captured in parallel
+   * on its own worker, with its own scale factor and image format.
+   *
+   * @param monitors The monitors to capture. If unset, all available monitors are captured in PNG format at scale 1.0.
+   * @param monitors[].id The monitor identifier (see {@link ScreenController.list}).
+   * @param monitors[].scale The scale factor to apply to the capture. If unset, it defaults to 1.0.
+   * @param monitors[].format The image format of the capture. If unset, `png` will be used.
+   * @param monitors[].filepath The file path to save the capture to. If unset, the encoded image is returned in memory as `data`.
+   * @returns A promise that resolves to the capture result of each requested monitor, in the same order.
+   *
+   * ---
+   * @example
+   * // Capture all monitors in memory (PNG)
+   * const captures = await Actionify.screen.captureMonitors();
+   *
+   * // Capture the main monitor at half scale in JPEG, and the second one to a file
+   * const captures = await Actionify.screen.captureMonitors([
+   *   { id: 0, scale: 0.5, format: "jpeg" },
+   *   { id: 1, filepath: "/path/to/monitor-1.png" },
+   * ]);
+   */
+  public async captureMonitors(monitors?: Array<{ id: number, scale?: number, format?: "png" | "jpeg" | "bmp", filepath?: string }>): Promise<MonitorCapture[]> {
+    const requests = monitors?.map((monitor) => ({
+      ...monitor,
+      filepath: monitor.filepath !== undefined ? path.resolve(monitor.filepath) : undefined,
+    }));
+    const captures = await captureMonitors(requests);
+    return captures.map((capture, index) => {
+      const filepath = requests?.[index]?.filepath;
+      return filepath !== undefined ? { ...capture, filepath } : capture;
+    });
+  }
+
+  /**
+   * @description Find a text on screen using OCR (Optical Character Recognition). The screen area is captured and recognized
+   * in memory once, then searched for the words of `query` on each recognized line.
+   *
+   * @param query The text to find. Whitespaces are ignored: multiple words match consecutive words of a same line.
+   * @param options.x The top-left corner X position of the searched area. If unset, the main monitor X origin will be used.
+   * @param options.y The top-left corner Y position of the searched area. If unset, the main monitor Y origin will be used.
+   * @param options.width The width of the searched area in pixels. If unset, the width of the main monitor will be used.
+   * @param options.height The height of the searched area in pixels. If unset, the height of the main monitor will be used.
+   * @param options.language The {@link https://tesseract-ocr.github.io/tessdoc/Data-Files-in-different-versions|language code} to use for OCR,
+   * or the name of a profile registered with `Actionify.ai.ocrProfiles.register()`.
+   * If unset, it will default to the first available language installed locally.
+   * @param options.caseSensitive Whether the search is case sensitive. If unset, it defaults to `false`.
+   * @param options.wholeWords Whether `query` must match whole words, so that "cat" does not match "concatenate".
+   * Set it to `false` to match inside words too. If unset, it defaults to `true`.
+   * @param options.preprocessing Image transformations applied in memory before OCR. If unset, the capture is used as is.
+   * @param options.threads The number of threads recognizing text blocks in parallel, `0` for all cores. If unset, it defaults to `1`.
+   * With several threads, the capture is first split into text blocks, each recognized by its own OCR engine.
+   * @returns A promise that resolves to the matches, from most to least confident.
+   *
+   * ---
+   * @example
+   * // Click on the "Save as" menu entry
+   * const [match] = await Actionify.screen.findText("Save as");
+   * if (match) {
+   *   Actionify.mouse.move(match.position.x + match.dimensions.width / 2, match.position.y + match.dimensions.height / 2);
+   *   Actionify.mouse.left.click();
+   * }
+   *
+   * // Search a specific area using French
+   * const matches = await Actionify.screen.findText("Enregistrer", { x: 0, y: 0, width: 800, height: 200, language: "fra" });
+   *
+   * // Search small text of a dark themed application
+   * const matches = await Actionify.screen.findText("Settings", { preprocessing: { invert: "auto", scale: 2, binarize: "otsu" } });
+   *
+   * // Search the whole screen on all cores
+   * const matches = await Actionify.screen.findText("Downloads", { threads: 0 });
+   */
+  public async findText(query: string, options?: { x?: number, y?: number, width?: number, height?: number, language?: string, caseSensitive?: boolean, wholeWords?: boolean, preprocessing?: OcrPreprocessing, threads?: number }): Promise<OcrTextMatch[]> {
+    const mainMonitor = this.list()[0];
+    const matches = await OcrLanguageService.run(options?.language, (ocrLanguageCode) => findTextOnScreen(query, {
+      x: options?.x ?? mainMonitor.origin.x,
+      y: options?.y ?? mainMonitor.origin.y,
+      width: options?.width ?? mainMonitor.dimensions.width,
+      height: options?.height ?? mainMonitor.dimensions.height,
+      language: ocrLanguageCode,
+      caseSensitive: options?.caseSensitive,
+      wholeWords: options?.wholeWords,
+      preprocessing: options?.preprocessing,
+      threads: options?.threads,
+    }));
+    return matches.map((match) => ({
+      text: match.text,
+      position: { x: match.x, y: match.y },
+      dimensions: { width: match.width, height: match.height },
+      confidence: match.confidence,
+    }));
+  }
+
+  /**
+   * @description Start recording an area of the screen to a compressed file.
+   * Frames are captured at a fixed rate on a dedicated thread, stored as differences
+   * with the previous frame and compressed on background threads.
+   *
+   * @param x The top-left corner X position of the recorded area. If unset, the main monitor X origin will be used.
+   * @param y The top-left corner Y position of the recorded area. If unset, the main monitor Y origin will be used.
+   * @param width The width of the recorded area in pixels. If unset, the width of the main monitor will be used.
+   * @param height The height of the recorded area in pixels. If unset, the height of the main monitor will be used.
+   * @param options.filepath The file path to save the recording to. If unset, it will be saved in the current working directory as `recording_[year]-[month]-[day]_[hour]-[minute]-[second]-[millisecond].afr`.
+   * @param options.fps The number of frames captured per second. If unset, it defaults to `30`.
+   * @param options.codec The compression codec: `lz4` (fastest) or `zstd` (smallest). If unset, `lz4` will be used.
+   * @param options.compressionLevel The `zstd` compression level. If unset, it defaults to `1`.
+   * @param options.keyframeInterval The number of frames between two full frames (seek points). If unset, it defaults to 2 seconds of frames.
+   * @returns The ongoing recording.
+   *
+   * ---
+   * @example
+   * // Record the main monitor
+   * const recording = Actionify.screen.record();
+   * await Actionify.time.waitAsync(10000);
+   * await recording.stop();
+   *
+   * // Record a specific area at 10 FPS using zstd
+   * const recording = Actionify.screen.record(100, 100, 800, 600, { fps: 10, codec: "zstd", filepath: "/path/to/recording.afr" });
+   */
+  public record(x?: number, y?: number, width?: number, height?: number, options?: { filepath?: string, fps?: number, codec?: "lz4" | "zstd", compressionLevel?: number, keyframeInterval?: number }): ScreenRecordingController {
+    const mainMonitor = this.list()[0];
+    const now = new Date();
+    const defaultFilepath = `recording_${now.getFullYear()}-${String(now.getMonth() + 1).padStart(2, "0")}-${String(now.getDate()).padStart(2, "0")}_${String(now.getHours()).padStart(2, "0")}-${String(now.getMinutes()).padStart(2, "0")}-${String(now.getSeconds()).padStart(2, "0")}-${String(now.getMilliseconds()).padStart(3, "0")}.afr`;
+    const absoluteFilePath = path.resolve(options?.filepath ?? defaultFilepath);
+    const recorderId = startScreenRecording({
+      filepath: absoluteFilePath,
+      x: x ?? mainMonitor.origin.x,
+      y: y ?? mainMonitor.origin.y,
+      width: width ?? mainMonitor.dimensions.width,
+      height: height ?? mainMonitor.dimensions.height,
+      fps: options?.fps,
+      codec: options?.codec,
+      compressionLevel: options?.compressionLevel,
+      keyframeInterval: options?.keyframeInterval,
+    });
+    return new ScreenRecordingController(recorderId, absoluteFilePath);
+  }
+
+  /**
+   * @description Start keeping the last seconds of a screen area in memory, to dump them to a file on demand (e.g. when a bot fails).
+   * Frames are compressed as they are captured and kept in a fixed amount of memory: the oldest frames are discarded as new ones come in.
+   *
+   * @param x The top-left corner X position of the recorded area. If unset, the main monitor X origin will be used.
+   * @param y The top-left corner Y position of the recorded area. If unset, the main monitor Y origin will be used.
+   * @param width The width of the recorded area in pixels. If unset, the width of the main monitor will be used.
+   * @param height The height of the recorded area in pixels. If unset, the height of the main monitor will be used.
+   * @param options.fps The number of frames captured per second. If unset, it defaults to `10`.
+   * @param options.duration The duration in milliseconds of the recording kept in memory. If unset, it defaults to `10000`.
+   * @param options.memoryLimit The maximum memory in bytes used by the compressed frames. If unset, it defaults to 128 MiB.
+   * @param options.keyframeInterval The number of frames between two full frames. If unset, it defaults to 1 second of frames.
+   * @returns The running flight recorder.
+   *
+   * ---
+   * @example
+   * // Keep the last 10 seconds of the main monitor in memory
+   * const flightRecorder = Actionify.screen.flightRecorder();
+   * // ...something went wrong
+   * await flightRecorder.dump("/path/to/failure.afr");
+   *
+   * // Keep the last 30 seconds of a specific area at 5 FPS, using at most 64 MiB
+   * const flightRecorder = Actionify.screen.flightRecorder(100, 100, 800, 600, { fps: 5, duration: 30000, memoryLimit: 64 * 1024 * 1024 });
+   */
+  public flightRecorder(x?: number, y?: number, width?: number, height?: number, options?: { fps?: number, duration?: number, memoryLimit?: number, keyframeInterval?: number }): FlightRecorderController {
+    const mainMonitor = this.list()[0];
+    const recorderId = startFlightRecorder({
+      x: x ?? mainMonitor.origin.x,
+      y: y ?? mainMonitor.origin.y,
+      width: width ?? mainMonitor.dimensions.width,
+      height: height ?? mainMonitor.dimensions.height,
+      fps: options?.fps,
+      duration: options?.duration,
+      memoryLimit: options?.memoryLimit,
+      keyframeInterval: options?.keyframeInterval,
+    });
+    return new FlightRecorderController(recorderId);
+  }
+
+  /**
+   * @description Start capturing an area of the screen at a fixed rate into shared memory, for JS code (including worker threads) to read the newest frame without copies.
+   * Frames are written to a ring of slots in a `SharedArrayBuffer` and published with atomics.
+   *
+   * @param x The top-left corner X position of the captured area. If unset, the main monitor X origin will be used.
+   * @param y The top-left corner Y position of the captured area. If unset, the main monitor Y origin will be used.
+   * @param width The width of the captured area in pixels. If unset, the width of the main monitor will be used.
+   * @param height The height of the captured area in pixels. If unset, the height of the main monitor will be used.
+   * @param options.fps The number of frames captured per second. If unset, it defaults to `30`.
+   * @param options.slots The number of frames kept in shared memory (at least `2`). More slots give readers more time before a frame is overwritten. If unset, it defaults to `3`.
+   * @returns The running feed.
+   *
+   * ---
+   * @example
+   * // Read the newest frame of the main monitor from the main thread
+   * const feed = Actionify.screen.feed();
+   * const frame = feed.reader.latest();
+   *
+   * // Process frames in a worker thread
+   * const feed = Actionify.screen.feed(0, 0, 800, 600, { fps: 60 });
+   * const worker = new Worker("./worker.js", { workerData: feed.buffer });
+   */
+  public feed(x?: number, y?: number, width?: number, height?: number, options?: { fps?: number, slots?: number }): ScreenFrameFeedController {
+    const mainMonitor = this.list()[0];
+    let header: Int32Array | undefined;
+    const { id, buffer } = startScreenFrameFeed(
+      {
+        x: x ?? mainMonitor.origin.x,
+        y: y ?? mainMonitor.origin.y,
+        width: width ?? mainMonitor.dimensions.width,
+        height: height ?? mainMonitor.dimensions.height,
+        fps: options?.fps,
+        slots: options?.slots,
+      },
+      // Wake up readers blocked in `ScreenFrameFeedReader.wait()`
+      () => {
+        if (header) {
+          Atomics.notify(header, 0);
+        }
+      }
+    );
+    header = new Int32Array(buffer, 0, 16);
+    return new ScreenFrameFeedController(id, buffer);
+  }
+
+  /**
+   * @description Decode a single frame of a screen recording.
+   *
+   * @param filepath The path to the recording file.
+   * @param index The frame index, starting at `0`.
+   * @returns The decoded frame.
+   *
+   * ---
+   * @example
+   * // Read the first frame of a recording
+   * const frame = Actionify.screen.frame("/path/to/recording.afr", 0);
+   * // Read the last frame of a recording
+   * const lastFrame = Actionify.screen.frame("/path/to/recording.afr", frame.frameCount - 1);
+   */
+  public frame(filepath: string, index: number): ScreenRecordingFrame {
+    return readScreenRecordingFrame(path.resolve(filepath), index);
+  }
+
   /**
    * @description Customize the default inspect output (with `console.log`) of a
    * class instance.
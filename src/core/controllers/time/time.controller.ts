@@ -1,5 +1,7 @@
 import {
+  getMonotonicTime,
   sleep,
+  sleepAsync,
 } from "../../../addon";
 import { Inspectable } from "../../../core/utilities";
 
@@ -23,19 +25,38 @@ export class TimeController {
     return (new Date()).getTime();
   }
 
+  /**
+   * @description Returns the milliseconds elapsed on the monotonic clock since an unspecified point in time, with sub-millisecond precision.
+   * Unlike {@link TimeController.now}, it never jumps when the system clock is adjusted, which makes it suitable to measure delays.
+   *
+   * @returns The milliseconds elapsed on the monotonic clock.
+   *
+   * ---
+   * @example
+   * const start = Actionify.time.monotonic();
+   * const elapsed = Actionify.time.monotonic() - start;
+   */
+  public monotonic(): number {
+    return getMonotonicTime();
+  }
+
   /**
    * @description Put the current thread to sleep for the specified number of milliseconds.
    *
    * @param milliseconds  The number of milliseconds to sleep.
+   * @param options.precise If `true`, the end of the sleep is spun for sub-millisecond accuracy, at the cost of CPU time.
    * @returns Synchronously after the specified number of milliseconds.
    *
    * ---
    * @example
    * Actionify.time.waitSync(1000);
+   *
+   * // Sleep for exactly 2.5 milliseconds
+   * Actionify.time.waitSync(2.5, { precise: true });
    */
-  public waitSync(milliseconds?: number) {
+  public waitSync(milliseconds?: number, options?: { precise?: boolean }) {
     if (milliseconds && milliseconds > 0) {
-      return sleep(milliseconds);
+      return sleep(milliseconds, options?.precise ?? false);
     }
   }
 
@@ -44,6 +65,8 @@ export class TimeController {
    *
    * @param milliseconds The number of milliseconds to sleep.
    * @param callback The callback function to execute after the specified number of milliseconds.
+   * @param options.precise If `true`, the sleep is timed by a native timer thread on the monotonic clock, spinning its end
+   * for sub-millisecond accuracy, instead of a `setTimeout`. The event loop is never blocked.
    * @returns A promise that resolves after the specified number of milliseconds and the callback execution.
    *
    * ---
@@ -53,9 +76,16 @@ export class TimeController {
    *
    * // Wait asynchronously for 1 second and execute a callback function
    * await Actionify.time.waitAsync(1000, () => console.log("At least 1 second has passed."));
+   *
+   * // Wait asynchronously for exactly 2.5 milliseconds
+   * await Actionify.time.waitAsync(2.5, undefined, { precise: true });
    */
-  public async waitAsync<T = void>(milliseconds?: number, callback: () => T | Promise<T> = () => undefined as T): Promise<T> {
+  public async waitAsync<T = void>(milliseconds?: number, callback: () => T | Promise<T> = () => undefined as T, options?: { precise?: boolean }): Promise<T> {
     if (milliseconds && milliseconds > 0) {
+      if (options?.precise) {
+        await sleepAsync(milliseconds, true);
+        return callback();
+      }
       return new Promise<T>((resolve, reject) => {
         setTimeout(async () => {
           try {
@@ -12,9 +12,10 @@ import {
   setWindowToAlwaysOnTop,
   setWindowToBottom,
   setWindowToTop,
+  startScreenRecording,
   takeWindowScreenshotToFile,
 } from "../../../../addon";
-import { WindowEventsController } from "../../../../core/controllers";
+import { ScreenRecordingController, WindowEventsController } from "../../../../core/controllers";
 import type { WindowInfo } from "../../../../core/types";
 import { Inspectable } from "../../../../core/utilities";
 
@@ -629,6 +630,46 @@ export class WindowInteractionController {
     return absoluteFilePath;
   }
 
+  /**
+   * @description Start recording an area of the window to a compressed file.
+   *
+   * @param x The top-left corner X position of the recorded area, relative to the window. If unset, `0` will be used.
+   * @param y The top-left corner Y position of the recorded area, relative to the window. If unset, `0` will be used.
+   * @param width The width of the recorded area in pixels. If unset, the width of the window will be used.
+   * @param height The height of the recorded area in pixels. If unset, the height of the window will be used.
+   * @param options.filepath The file path to save the recording to. If unset, it will be saved in the current working directory as `recording_[year]-[month]-[day]_[hour]-[minute]-[second]-[millisecond].afr`.
+   * @param options.fps The number of frames captured per second. If unset, it defaults to `30`.
+   * @param options.codec The compression codec: `lz4` (fastest) or `zstd` (smallest). If unset, `lz4` will be used.
+   * @param options.compressionLevel The `zstd` compression level. If unset, it defaults to `1`.
+   * @param options.keyframeInterval The number of frames between two full frames (seek points). If unset, it defaults to 2 seconds of frames.
+   * @returns The ongoing recording.
+   *
+   * ---
+   * @example
+   * const window = Actionify.window.list()[0];
+   * const recording = window.record(0, 0, undefined, undefined, { fps: 15 });
+   * await Actionify.time.waitAsync(10000);
+   * await recording.stop();
+   */
+  public record(x?: number, y?: number, width?: number, height?: number, options?: { filepath?: string, fps?: number, codec?: "lz4" | "zstd", compressionLevel?: number, keyframeInterval?: number }): ScreenRecordingController {
+    const now = new Date();
+    const defaultFilepath = `recording_${now.getFullYear()}-${String(now.getMonth() + 1).padStart(2, "0")}-${String(now.getDate()).padStart(2, "0")}_${String(now.getHours()).padStart(2, "0")}-${String(now.getMinutes()).padStart(2, "0")}-${String(now.getSeconds()).padStart(2, "0")}-${String(now.getMilliseconds()).padStart(3, "0")}.afr`;
+    const absoluteFilePath = path.resolve(options?.filepath ?? defaultFilepath);
+    const recorderId = startScreenRecording({
+      filepath: absoluteFilePath,
+      windowId: this.id,
+      x: x ?? 0,
+      y: y ?? 0,
+      width: width ?? this.dimensions.width,
+      height: height ?? this.dimensions.height,
+      fps: options?.fps,
+      codec: options?.codec,
+      compressionLevel: options?.compressionLevel,
+      keyframeInterval: options?.keyframeInterval,
+    });
+    return new ScreenRecordingController(recorderId, absoluteFilePath);
+  }
+
   /**
    * @description Set the window into the top (normal) or topmost (always on top) category.
    * If the window is initially minimized, it will be restored first.
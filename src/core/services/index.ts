@@ -2,5 +2,6 @@ export * from './data';
 export * from './input';
 export * from './key-formatter';
 export * from './key-mapper';
+export * from './ocr-language';
 export * from './operating-system';
 export * from './window';
@@ -1,13 +1,19 @@
 import {
+  setInputEventFilter,
+} from "../../../../addon";
+import {
+  InputEventRingController,
   InputListenerScopeController,
   InputRecorderScopeController,
+  InputStateTrackerController,
+  KeyboardHotkeyController,
   KeyboardListenerScopeController,
   KeyboardRecorderScopeController,
   MouseListenerScopeController,
   MouseRecorderScopeController,
 } from "../../../../core/controllers";
 import { InputStateService } from "../../../../core/services";
-import type { InputEvent, KeyboardEvent, MouseEvent } from "../../../../core/types";
+import type { InputAction, InputEvent, KeyboardEvent, MouseEvent } from "../../../../core/types";
 import { Inspectable } from "../../../../core/utilities";
 
 /**
@@ -15,14 +21,22 @@ import { Inspectable } from "../../../../core/utilities";
  */
 export class InputEventService {
 
+  static #inputEventRings: Array<InputEventRingController> = [];
   static #inputListeners: Array<InputListenerScopeController> = [];
   static #inputRecorders: Array<InputRecorderScopeController> = [];
+  static #inputStateTrackers: Array<InputStateTrackerController> = [];
+  static #keyboardHotkeys: Array<KeyboardHotkeyController> = [];
   static #keyboardListeners: Array<KeyboardListenerScopeController> = [];
   static #keyboardRecorders: Array<KeyboardRecorderScopeController> = [];
   static #keyboardSuppressedInputStates: Map<number, Set<number>> = new Map();
   static #mouseListeners: Array<MouseListenerScopeController> = [];
   static #mouseRecorders: Array<MouseRecorderScopeController> = [];
   static #mouseSuppressedInputStates: Map<number, Set<number>> = new Map();
+  static #nativeInputRecorders: Array<InputRecorderScopeController> = [];
+  // Layout of batched input event records, see the native input event listener
+  static readonly #batchRecordSize = 7;
+  static readonly #batchMouseInputs: Array<MouseEvent["input"]> = ["move", "left", "right", "middle", "wheel", "extraButton1", "extraButton2"];
+  static readonly #batchStates: Array<MouseEvent["state"]> = ["down", "up", "neutral"];
 
   protected constructor() { }
 
@@ -267,7 +281,7 @@ export class InputEventService {
           const y = currentMouseEvent.position.y;
           const timestamp = currentMouseEvent.timestamp;
           const csvLine = `${type},${timestamp},${input},${state},${x},${y}\n`;
-          inputRecorder.writeStream.write(csvLine);
+          inputRecorder.writeStream?.write(csvLine);
         }
         break;
       }
@@ -442,7 +456,7 @@ export class InputEventService {
               break;
           }
           const csvLine = `${type},${timestamp},${input},${state}\n`;
-          inputRecorder.writeStream.write(csvLine);
+          inputRecorder.writeStream?.write(csvLine);
         }
         break;
       }
@@ -451,6 +465,56 @@ export class InputEventService {
     }
   }
 
+  /**
+   * @description Run the main listener on an input event, or on each event of a batch
+   * (see `Actionify.input.events.batch()`).
+   *
+   * @param eventOrBatch An input event, or batched input events as flat records of
+   * `type | input | state | x | y | timestamp | flags`.
+   */
+  static #dispatch(eventOrBatch: InputEvent | Float64Array) {
+    if (!(eventOrBatch instanceof Float64Array)) {
+      InputEventService.#mainListener(eventOrBatch);
+      return;
+    }
+    for (let offset = 0; offset + InputEventService.#batchRecordSize <= eventOrBatch.length; offset += InputEventService.#batchRecordSize) {
+      const state = InputEventService.#batchStates[eventOrBatch[offset + 2]];
+      const timestamp = eventOrBatch[offset + 5];
+      const flags = eventOrBatch[offset + 6];
+      const isSuppressed = (flags & 1) !== 0;
+      const isInjected = (flags & 2) !== 0;
+      if (eventOrBatch[offset] === 0) {
+        const input = InputEventService.#batchMouseInputs[eventOrBatch[offset + 1]];
+        if (input === undefined) {
+          continue;
+        }
+        InputEventService.#mainListener({
+          type: "mouse",
+          timestamp,
+          input,
+          state: state as MouseEvent["state"],
+          position: { x: eventOrBatch[offset + 3], y: eventOrBatch[offset + 4] },
+          isSuppressed,
+          isInjected,
+        });
+      }
+      else {
+        InputEventService.#mainListener({
+          type: "keyboard",
+          timestamp,
+          input: eventOrBatch[offset + 1],
+          state: state as KeyboardEvent["state"],
+          isSuppressed,
+          isInjected,
+        });
+      }
+    }
+  }
+
+  public static get inputEventRings(): Array<InputEventRingController> {
+    return InputEventService.#inputEventRings;
+  }
+
   public static get inputListeners(): Array<InputListenerScopeController> {
     return InputEventService.#inputListeners;
   }
@@ -459,6 +523,14 @@ export class InputEventService {
     return InputEventService.#inputRecorders;
   }
 
+  public static get inputStateTrackers(): Array<InputStateTrackerController> {
+    return InputEventService.#inputStateTrackers;
+  }
+
+  public static get keyboardHotkeys(): Array<KeyboardHotkeyController> {
+    return InputEventService.#keyboardHotkeys;
+  }
+
   public static get keyboardListeners(): Array<KeyboardListenerScopeController> {
     return InputEventService.#keyboardListeners;
   }
@@ -483,6 +555,71 @@ export class InputEventService {
     return InputEventService.#mouseSuppressedInputStates;
   }
 
+  public static get nativeInputRecorders(): Array<InputRecorderScopeController> {
+    return InputEventService.#nativeInputRecorders;
+  }
+
+  /**
+   * @description Restrict the input events delivered natively to the main listener to the ones declared listeners and
+   * recorders may need: the inputs they listen to and the inputs their conditions depend on. Must be called whenever
+   * a listener or recorder is added, removed or changes its options.
+   */
+  public static updateInputEventFilter() {
+    const filter = {
+      keyboard: false,
+      mouse: false,
+      motion: false,
+      injected: false,
+      physical: false,
+      keys: new Set<number>() as Set<number> | undefined,
+      mouseInputs: new Set<number>() as Set<number> | undefined,
+    };
+    const subscribe = (actions: InputAction[], type: InputAction["type"] | undefined, ignoreInjected: boolean) => {
+      filter.injected ||= !ignoreInjected;
+      filter.physical = true;
+      if (actions.length === 0) {
+        // Listening to every input of the type
+        if (type !== "mouse") {
+          filter.keyboard = true;
+          filter.keys = undefined;
+        }
+        if (type !== "keyboard") {
+          filter.mouse = true;
+          filter.motion = true;
+          filter.mouseInputs = undefined;
+        }
+        return;
+      }
+      for (const action of actions) {
+        if (action.type === "keyboard") {
+          filter.keyboard = true;
+          filter.keys?.add(action.input);
+        }
+        else if (action.input === "move") {
+          filter.motion = true;
+        }
+        else {
+          filter.mouse = true;
+          filter.mouseInputs?.add(InputEventService.#batchMouseInputs.indexOf(action.input));
+        }
+      }
+    };
+    for (const scope of [...InputEventService.inputListeners, ...InputEventService.inputRecorders]) {
+      subscribe(scope.when, undefined, scope.ignoreInjected);
+    }
+    for (const scope of [...InputEventService.keyboardListeners, ...InputEventService.keyboardRecorders]) {
+      subscribe(scope.when.map((action) => ({ ...action, type: "keyboard" })), "keyboard", scope.ignoreInjected);
+    }
+    for (const scope of [...InputEventService.mouseListeners, ...InputEventService.mouseRecorders]) {
+      subscribe(scope.when.map((action) => ({ ...action, type: "mouse" })), "mouse", scope.ignoreInjected);
+    }
+    setInputEventFilter({
+      ...filter,
+      keys: filter.keys ? [...filter.keys] : undefined,
+      mouseInputs: filter.mouseInputs ? [...filter.mouseInputs] : undefined,
+    });
+  }
+
   /**
    * @description Determine whether the main listener should be started.
    *
@@ -490,12 +627,16 @@ export class InputEventService {
    */
   public static get shouldStartMainListener(): boolean {
     return (
+      InputEventService.inputEventRings.length +
       InputEventService.inputListeners.length +
       InputEventService.inputRecorders.length +
+      InputEventService.inputStateTrackers.length +
+      InputEventService.keyboardHotkeys.length +
       InputEventService.keyboardListeners.length +
       InputEventService.keyboardRecorders.length +
       InputEventService.mouseListeners.length +
       InputEventService.mouseRecorders.length +
+      InputEventService.nativeInputRecorders.length +
       [...InputEventService.#keyboardSuppressedInputStates.entries()].reduce((accumulator, currentValue) => accumulator + (currentValue[1]?.size || 0), 0) +
       [...InputEventService.#mouseSuppressedInputStates.entries()].reduce((accumulator, currentValue) => accumulator + (currentValue[1]?.size || 0), 0)
     ) > 0;
@@ -508,12 +649,16 @@ export class InputEventService {
    */
   public static get shouldStopMainListener(): boolean {
     return (
+      InputEventService.inputEventRings.length +
       InputEventService.inputListeners.length +
       InputEventService.inputRecorders.length +
+      InputEventService.inputStateTrackers.length +
+      InputEventService.keyboardHotkeys.length +
       InputEventService.keyboardListeners.length +
       InputEventService.keyboardRecorders.length +
       InputEventService.mouseListeners.length +
       InputEventService.mouseRecorders.length +
+      InputEventService.nativeInputRecorders.length +
       [...InputEventService.#keyboardSuppressedInputStates.entries()].reduce((accumulator, currentValue) => accumulator + (currentValue[1]?.size || 0), 0) +
       [...InputEventService.#mouseSuppressedInputStates.entries()].reduce((accumulator, currentValue) => accumulator + (currentValue[1]?.size || 0), 0)
     ) === 0;
@@ -525,8 +670,8 @@ export class InputEventService {
    *
    * @param currentEvent
    */
-  public static get mainListener(): (event: InputEvent) => void {
-    return InputEventService.#mainListener;
+  public static get mainListener(): (event: InputEvent | Float64Array) => void {
+    return InputEventService.#dispatch;
   }
 
   /**
@@ -0,0 +1,53 @@
+import fs from "fs/promises";
+import { RepositoryHelper } from "../../../cli/actionify/helpers";
+
+export class OcrLanguageService {
+
+  /**
+   * @description Run an OCR task with the given language, or the first language installed locally if unset.
+   * Errors caused by a missing language are replaced by installation instructions.
+   */
+  public static async run<T>(language: string | undefined, task: (languageCode: string) => T | Promise<T>): Promise<T> {
+    try {
+      const ocrLanguageCode = language ?? (await OcrLanguageService.#fetchDefaultLocalOcrLanguageIfExistsElseThrow());
+      return await task(ocrLanguageCode);
+    }
+    catch (error: any) {
+      if (error?.message?.includes("Failed to initialize Tesseract with language")) {
+        // The language of an OCR profile may differ from its name
+        const missingLanguage = error.message.match(/with language: (\S+)/)?.[1] ?? language ?? "eng";
+        throw new Error([
+          ``,
+          `==========================================`,
+          `OCR language "${missingLanguage}" not found.`,
+          `Install it using the following command:`,
+          `    \x1b[96mnpx actionify ocr language add ${missingLanguage}\x1b[0m`,
+          `==========================================`,
+        ].join("\n"));
+      }
+      throw error;
+    }
+  }
+
+  static async #fetchDefaultLocalOcrLanguageIfExistsElseThrow() {
+    const ocrDataFolderPath = await RepositoryHelper.resolveDataDirectory(["ocr"]);
+    const localOcrTrainedDataFileNames = (await fs.readdir(ocrDataFolderPath, { withFileTypes: true }))
+      .filter((fileOrDirectory) => fileOrDirectory.isFile())
+      .map((directory) => directory.name.replace(".traineddata", ""));
+    ;
+    if (localOcrTrainedDataFileNames.length > 0) {
+      return localOcrTrainedDataFileNames[0];
+    }
+    throw new Error([
+      ``,
+      `==========================================`,
+      `No OCR languages installed locally.`,
+      `Browse the list of available languages using the following command:`,
+      `    \x1b[96mnpx actionify ocr language list\x1b[0m`,
+      `Then install one using the following command:`,
+      `    \x1b[96mnpx actionify ocr language add <language>\x1b[0m`,
+      `==========================================`,
+    ].join("\n"));
+  }
+
+}
@@ -3,4 +3,5 @@ export * from './input-action';
 export * from './input-event';
 export * from './input-listener';
 export * from './input-recorder';
+export * from './input-replayer';
 export * from './input-state';
@@ -1 +1,2 @@
 export * from './input-recorder-options';
+export * from './input-recording-stats';
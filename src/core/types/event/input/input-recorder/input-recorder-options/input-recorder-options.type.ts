@@ -7,4 +7,13 @@ export type InputRecorderOptions = {
    */
   ignoreInjected?: boolean;
 
+  /**
+   * @description The format of the record file. Defaults to `"text"`.
+   * - `"text"`: one line of comma-separated values per event, written from JavaScript.
+   * - `"binary"`: compressed blocks of fixed-size records, written natively from the input listener thread.
+   * Memory stays flat whatever the recording length and JavaScript is not called per event.
+   * Events are kept when they match any of the recorded actions.
+   */
+  format?: "text" | "binary";
+
 };
@@ -0,0 +1 @@
+export * from './input-recording-stats.type';
@@ -0,0 +1,26 @@
+/**
+ * @description Summary of a stopped binary input recording.
+ */
+export type InputRecordingStats = {
+
+  /**
+   * @description The number of input events written to the recording file.
+   */
+  events: number;
+
+  /**
+   * @description The number of input events skipped because writing the recording file could not keep up.
+   */
+  droppedEvents: number;
+
+  /**
+   * @description The number of compressed blocks written to the recording file.
+   */
+  blocks: number;
+
+  /**
+   * @description The time between the first and the last recorded input events in milliseconds.
+   */
+  duration: number;
+
+};
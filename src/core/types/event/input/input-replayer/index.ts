@@ -0,0 +1 @@
+export * from './input-replay-stats';
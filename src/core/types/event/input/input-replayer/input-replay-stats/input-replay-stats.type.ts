@@ -0,0 +1,49 @@
+/**
+ * @description Summary of an ended input replay.
+ */
+export type InputReplayStats = {
+
+  /**
+   * @description The number of input events sent.
+   */
+  events: number;
+
+  /**
+   * @description The time between the start and the end of the replay in milliseconds, pauses included.
+   */
+  duration: number;
+
+  /**
+   * @description How late the input events were sent after their scheduled time, in milliseconds.
+   * Percentiles are accurate to 10 microseconds.
+   */
+  lateness: {
+
+    /**
+     * @description The mean lateness.
+     */
+    mean: number;
+
+    /**
+     * @description The median lateness.
+     */
+    p50: number;
+
+    /**
+     * @description The lateness under which 95% of the input events were sent.
+     */
+    p95: number;
+
+    /**
+     * @description The lateness under which 99% of the input events were sent.
+     */
+    p99: number;
+
+    /**
+     * @description The highest lateness.
+     */
+    max: number;
+
+  };
+
+};
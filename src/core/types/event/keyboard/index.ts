@@ -2,5 +2,6 @@ export * from './key-action';
 export * from './key-input';
 export * from './key-state';
 export * from './keyboard-event';
+export * from './keyboard-hotkey';
 export * from './keyboard-listener';
 export * from './keyboard-recorder';
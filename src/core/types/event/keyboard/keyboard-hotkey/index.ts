@@ -0,0 +1,3 @@
+export * from './keyboard-hotkey.type';
+export * from './keyboard-hotkey-event';
+export * from './keyboard-hotkey-options';
@@ -0,0 +1 @@
+export * from './keyboard-hotkey-event.type';
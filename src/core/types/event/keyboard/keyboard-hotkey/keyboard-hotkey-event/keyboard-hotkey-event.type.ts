@@ -0,0 +1,15 @@
+/**
+ * @description A hotkey match.
+ */
+export type KeyboardHotkeyEvent = {
+
+  /**
+   * @description The hotkey that matched, as registered.
+   */
+  hotkey: string;
+
+  /**
+   * @description The timestamp of the key press completing the hotkey (in milliseconds).
+   */
+  timestamp: number;
+};
@@ -0,0 +1,16 @@
+export type KeyboardHotkeyOptions = {
+
+  /**
+   * @description The maximum number of milliseconds between two chords of a sequence
+   * (e.g. between both presses of `"g g"`). Defaults to `300`.
+   */
+  timeout?: number;
+
+  /**
+   * @description Whether to ignore input events generated by software processes.
+   * If `true`, only hardware/driver input events will be treated. Otherwise,
+   * all input events will be treated. Defaults to `false`.
+   */
+  ignoreInjected?: boolean;
+
+};
@@ -0,0 +1,7 @@
+import { KeyboardHotkeyController } from "../../../../../core/controllers";
+import type { KeyboardHotkeyEvent } from "../../../../../core/types";
+
+export type KeyboardHotkey = (
+  keyboardHotkeyEvent: KeyboardHotkeyEvent,
+  keyboardHotkeyController: KeyboardHotkeyController
+) => void | Promise<void>;
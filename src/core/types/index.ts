@@ -4,8 +4,16 @@ export * from './ignore-whitespace';
 export * from './key';
 export * from './key-code';
 export * from './match-region';
+export * from './monitor-capture';
+export * from './ocr-cache-stats';
+export * from './ocr-preprocessing';
+export * from './ocr-profile';
+export * from './ocr-result';
 export * from './optional';
 export * from './position';
+export * from './raw-image';
+export * from './screen-frame-feed';
 export * from './screen-info';
+export * from './screen-recording';
 export * from './system-tray';
 export * from './window';
@@ -0,0 +1 @@
+export * from './monitor-capture.type';
@@ -0,0 +1,26 @@
+/**
+ * @description Result of a single monitor capture.
+ */
+export type MonitorCapture = {
+
+  /**
+   * @description The captured monitor numeric identifier (see `ScreenInfo.id`).
+   */
+  id: number;
+
+  /**
+   * @description Whether the monitor has been successfully captured and encoded.
+   */
+  captured: boolean;
+
+  /**
+   * @description The absolute filepath the capture has been saved to, if one was requested.
+   */
+  filepath?: string;
+
+  /**
+   * @description The encoded image bytes, when no filepath was requested.
+   */
+  data?: Uint8Array;
+
+};
@@ -0,0 +1 @@
+export * from './ocr-cache-stats.type';
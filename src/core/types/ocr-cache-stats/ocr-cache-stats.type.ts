@@ -0,0 +1,26 @@
+/**
+ * @description Usage counters of the OCR result cache.
+ */
+export type OcrCacheStats = {
+
+  /**
+   * @description Number of OCR calls answered from the cache since the last clear.
+   */
+  hits: number;
+
+  /**
+   * @description Number of OCR calls that had to recognize their image since the last clear.
+   */
+  misses: number;
+
+  /**
+   * @description Number of results currently cached.
+   */
+  size: number;
+
+  /**
+   * @description Maximum number of cached results.
+   */
+  capacity: number;
+
+};
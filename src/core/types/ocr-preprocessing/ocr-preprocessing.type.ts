@@ -0,0 +1,31 @@
+/**
+ * @description Image transformations applied in memory before OCR, in this order: grayscale, inversion, upscale, binarization.
+ * Small and anti-aliased screen text is usually recognized faster and better once upscaled and binarized.
+ */
+export type OcrPreprocessing = {
+
+  /**
+   * @description Convert the image to grayscale. Implied by `invert` and `binarize`.
+   */
+  grayscale?: boolean;
+
+  /**
+   * @description Invert the image colors, so that text is dark on a light background.
+   * - `true`: always invert.
+   * - `"auto"`: only invert mostly dark images (dark themes).
+   */
+  invert?: boolean | "auto";
+
+  /**
+   * @description Integer upscale factor, from `1` to `8`. Returned bounding boxes remain in original image coordinates.
+   */
+  scale?: number;
+
+  /**
+   * @description Convert the image to black and white.
+   * - `"otsu"`: a single threshold for the whole image, fastest.
+   * - `"sauvola"`: local thresholds, better with uneven backgrounds (gradients, highlights).
+   */
+  binarize?: "otsu" | "sauvola";
+
+};
@@ -0,0 +1 @@
+export * from './ocr-profile.type';
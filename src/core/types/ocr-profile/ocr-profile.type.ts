@@ -0,0 +1,56 @@
+/**
+ * @description Tesseract settings of a named OCR profile. Unset settings keep Tesseract defaults.
+ */
+export type OcrProfile = {
+
+  /**
+   * @description The {@link https://tesseract-ocr.github.io/tessdoc/Data-Files-in-different-versions|language code} to use for OCR.
+   * If unset, it will default to the first available language installed locally.
+   */
+  language?: string;
+
+  /**
+   * @description How the image is split into blocks, lines and words. Restricting it skips the layout analysis.
+   * - `"auto"`: fully automatic layout analysis.
+   * - `"single-column"`: a single column of text of variable sizes.
+   * - `"single-block"`: a single uniform block of text (Tesseract API default).
+   * - `"single-line"`: a single text line, e.g. an input field or a status bar.
+   * - `"single-word"`: a single word.
+   * - `"single-char"`: a single character.
+   * - `"sparse-text"`: as much text as possible, in no particular order.
+   * - `"raw-line"`: a single text line, bypassing Tesseract-specific hacks.
+   * - `"auto-osd"`, `"auto-only"`, `"single-block-vertical"`, `"circle-word"`, `"sparse-text-osd"`: see {@link https://tesseract-ocr.github.io/tessdoc/ImproveQuality.html#page-segmentation-method|Tesseract page segmentation modes}.
+   */
+  pageSegmentationMode?: "auto" | "auto-osd" | "auto-only" | "single-column" | "single-block-vertical" | "single-block" | "single-line" | "single-word" | "circle-word" | "single-char" | "sparse-text" | "sparse-text-osd" | "raw-line";
+
+  /**
+   * @description The recognition engine.
+   * - `"default"`: whatever the language data supports.
+   * - `"lstm"`: neural network only.
+   * - `"legacy"`: legacy engine only, requires language data including it.
+   * - `"combined"`: both engines, requires language data including the legacy one.
+   */
+  engineMode?: "default" | "lstm" | "legacy" | "combined";
+
+  /**
+   * @description Only recognize these characters, e.g. `"0123456789"` for a numeric field.
+   */
+  whitelist?: string;
+
+  /**
+   * @description Never recognize these characters.
+   */
+  blacklist?: string;
+
+  /**
+   * @description Resolution hint of the images, from `70` to `2400`. If unset, Tesseract estimates it.
+   */
+  dpi?: number;
+
+  /**
+   * @description Other {@link https://tesseract-ocr.github.io/tessdoc/tess3/ControlParams.html|Tesseract variables},
+   * including init-only ones, e.g. `{ load_system_dawg: false, load_freq_dawg: false }` to skip loading dictionaries.
+   */
+  variables?: Record<string, string | number | boolean>;
+
+};
@@ -0,0 +1,110 @@
+/**
+ * @description Structured OCR result. Elements are stored in flat typed arrays:
+ * the `i`-th element box is `boxes.subarray(i * 4, i * 4 + 4)` as `[x, y, width, height]` in pixels.
+ */
+export type OcrResult = {
+
+  /**
+   * @description The whole recognized text.
+   */
+  text: string;
+
+  /**
+   * @description Recognized words.
+   */
+  words: {
+    /**
+     * @description Text of each word.
+     */
+    text: string[];
+    /**
+     * @description Bounding box of each word, as `[x, y, width, height]` quadruplets.
+     */
+    boxes: Int32Array;
+    /**
+     * @description Recognition confidence of each word, from `0` to `100`.
+     */
+    confidences: Float32Array;
+    /**
+     * @description Index of the line (in `lines`) each word belongs to.
+     */
+    lines: Int32Array;
+  };
+
+  /**
+   * @description Recognized text lines.
+   */
+  lines: {
+    /**
+     * @description Text of each line.
+     */
+    text: string[];
+    /**
+     * @description Bounding box of each line, as `[x, y, width, height]` quadruplets.
+     */
+    boxes: Int32Array;
+    /**
+     * @description Recognition confidence of each line, from `0` to `100`.
+     */
+    confidences: Float32Array;
+    /**
+     * @description Index of the block (in `blocks`) each line belongs to.
+     */
+    blocks: Int32Array;
+  };
+
+  /**
+   * @description Recognized text blocks (paragraph groups, columns...).
+   */
+  blocks: {
+    /**
+     * @description Bounding box of each block, as `[x, y, width, height]` quadruplets.
+     */
+    boxes: Int32Array;
+    /**
+     * @description Recognition confidence of each block, from `0` to `100`.
+     */
+    confidences: Float32Array;
+  };
+
+};
+
+/**
+ * @description A text found on screen.
+ */
+export type OcrTextMatch = {
+  /**
+   * @description The recognized words containing the searched text.
+   */
+  text: string;
+  /**
+   * @description Top-left point of the matched words, in screen coordinates.
+   */
+  position: {
+    /**
+     * @description Horizontal position in pixels.
+     */
+    x: number;
+    /**
+     * @description Vertical position in pixels.
+     */
+    y: number;
+  };
+  /**
+   * @description Width and height of the matched words.
+   */
+  dimensions: {
+    /**
+     * @description Width in pixels.
+     */
+    width: number;
+    /**
+     * @description Height in pixels.
+     */
+    height: number;
+  };
+  /**
+   * @description Recognition confidence of the least confident matched word, from `0` to `100`.
+   */
+  confidence: number;
+};
@@ -0,0 +1 @@
+export * from './raw-image.type';
@@ -0,0 +1,24 @@
+export type RawImage = {
+  /**
+   * @description Image width in pixels.
+   */
+  width: number;
+  /**
+   * @description Image height in pixels.
+   */
+  height: number;
+  /**
+   * @description Number of bytes between the start of two consecutive rows.
+   * It may be larger than `width * 4` when rows are padded.
+   */
+  stride: number;
+  /**
+   * @description Byte order of each pixel in `data`.
+   */
+  format: "rgba" | "bgra";
+  /**
+   * @description Packed pixels, 4 bytes per pixel, rows of `stride` bytes each.
+   * The byte offset of pixel (x, y) is `y * stride + x * 4`.
+   */
+  data: Uint8Array;
+};
@@ -0,0 +1,18 @@
+import type { RawImage } from "../raw-image";
+
+/**
+ * @description A frame of a screen frame feed. Its pixels are not copied: `data` is a view on the shared memory slot the frame was captured into.
+ */
+export type ScreenFrameFeedFrame = RawImage & {
+
+  /**
+   * @description The frame sequence number, starting at `1` and incremented for each captured frame.
+   */
+  sequence: number;
+
+  /**
+   * @description The capture time in milliseconds since the feed started.
+   */
+  timestamp: number;
+
+};
@@ -0,0 +1,68 @@
+/**
+ * @description Summary of a stopped screen recording.
+ */
+export type ScreenRecordingStats = {
+
+  /**
+   * @description The number of frames written to the recording file.
+   */
+  frames: number;
+
+  /**
+   * @description The number of frames skipped because capture or encoding could not keep up with the requested FPS.
+   */
+  droppedFrames: number;
+
+  /**
+   * @description The recording duration in milliseconds.
+   */
+  duration: number;
+
+};
+
+/**
+ * @description A single decoded frame of a screen recording.
+ */
+export type ScreenRecordingFrame = {
+
+  /**
+   * @description Frame width in pixels.
+   */
+  width: number;
+
+  /**
+   * @description Frame height in pixels.
+   */
+  height: number;
+
+  /**
+   * @description Number of bytes between the start of two consecutive rows.
+   */
+  stride: number;
+
+  /**
+   * @description Byte order of each pixel in `data`.
+   */
+  format: "bgra";
+
+  /**
+   * @description Packed pixels, 4 bytes per pixel, rows of `stride` bytes each.
+   */
+  data: Uint8Array;
+
+  /**
+   * @description Time of the frame capture in milliseconds since the recording start.
+   */
+  timestamp: number;
+
+  /**
+   * @description The total number of frames in the recording.
+   */
+  frameCount: number;
+
+  /**
+   * @description The target FPS of the recording.
+   */
+  fps: number;
+
+};
@@ -1 +1,3 @@
 export * from './inspectable';
+export * from './screen-frame-feed-reader';
+export * from './input-event-ring-reader';
@@ -0,0 +1,185 @@
+import type { KeyState, MouseInput, MouseState } from "../../types/event";
+
+// Shared memory layout, written by the native input event listener:
+//   header  16 x int32: write index | read index | capacity | record size | records offset | dropped events | state | waiting
+//   records capacity x (float64 timestamp | int32 type | int32 input | int32 state | int32 x | int32 y | int32 flags)
+// Indexes count events since the ring started and wrap around at 2^32, the record of index i lives in slot i % capacity.
+const HEADER_SIZE = 64;
+const WRITE_INDEX = 0;
+const READ_INDEX = 1;
+const CAPACITY = 2;
+const RECORD_SIZE = 3;
+const RECORDS_OFFSET = 4;
+const DROPPED = 5;
+const STATE = 6;
+const WAITING = 7;
+const MOUSE_INPUTS: MouseInput[] = ["move", "left", "right", "middle", "wheel", "extraButton1", "extraButton2"];
+const STATES: MouseState[] = ["down", "up", "neutral"];
+
+/**
+ * @description Read the input events of an input event ring from its `SharedArrayBuffer`, without allocating anything per event.
+ * Reading moves a cursor over the ring: the fields of the current event are exposed as properties until the next `read()`.
+ * It has no dependency on the native addon and can be used from worker threads. Only one reader may consume a ring.
+ */
+export class InputEventRingReader {
+
+  readonly #header: Int32Array;
+  readonly #fields: Int32Array;
+  readonly #timestamps: Float64Array;
+  readonly #mask: number;
+  #nextIndex: number;
+  #fieldsOffset: number;
+
+  public constructor(buffer: SharedArrayBuffer) {
+    this.#header = new Int32Array(buffer, 0, HEADER_SIZE / 4);
+    const capacity = Atomics.load(this.#header, CAPACITY);
+    const recordSize = Atomics.load(this.#header, RECORD_SIZE);
+    const recordsOffset = Atomics.load(this.#header, RECORDS_OFFSET);
+    this.#fields = new Int32Array(buffer, recordsOffset, capacity * recordSize / 4);
+    this.#timestamps = new Float64Array(buffer, recordsOffset, capacity * recordSize / 8);
+    this.#mask = capacity - 1;
+    this.#nextIndex = Atomics.load(this.#header, READ_INDEX);
+    this.#fieldsOffset = -1;
+  }
+
+  /**
+   * @description The number of events written but not read yet.
+   */
+  public get available(): number {
+    return (Atomics.load(this.#header, WRITE_INDEX) - this.#nextIndex) >>> 0;
+  }
+
+  /**
+   * @description The number of events dropped because the ring was full.
+   */
+  public get dropped(): number {
+    return Atomics.load(this.#header, DROPPED);
+  }
+
+  /**
+   * @description Whether events are still written to the ring.
+   */
+  public get isRunning(): boolean {
+    return Atomics.load(this.#header, STATE) === 1;
+  }
+
+  /**
+   * @description The input type of the current event.
+   */
+  public get type(): "mouse" | "keyboard" {
+    return this.#fields[this.#fieldsOffset] === 0 ? "mouse" : "keyboard";
+  }
+
+  /**
+   * @description The input of the current event: the mouse input for mouse events, the key code for keyboard events.
+   */
+  public get input(): MouseInput | number {
+    const input = this.#fields[this.#fieldsOffset + 1];
+    return this.#fields[this.#fieldsOffset] === 0 ? MOUSE_INPUTS[input] : input;
+  }
+
+  /**
+   * @description The state of the current event.
+   */
+  public get state(): MouseState | KeyState {
+    return STATES[this.#fields[this.#fieldsOffset + 2]];
+  }
+
+  /**
+   * @description The horizontal cursor position of the current mouse event.
+   */
+  public get x(): number {
+    return this.#fields[this.#fieldsOffset + 3];
+  }
+
+  /**
+   * @description The vertical cursor position of the current mouse event.
+   */
+  public get y(): number {
+    return this.#fields[this.#fieldsOffset + 4];
+  }
+
+  /**
+   * @description The timestamp of the current event occurrence (in milliseconds).
+   */
+  public get timestamp(): number {
+    return this.#timestamps[this.#fieldsOffset / 2 - 1];
+  }
+
+  /**
+   * @description Whether the current event is suppressed.
+   */
+  public get isSuppressed(): boolean {
+    return (this.#fields[this.#fieldsOffset + 5] & 1) !== 0;
+  }
+
+  /**
+   * @description Whether the current event is injected.
+   */
+  public get isInjected(): boolean {
+    return (this.#fields[this.#fieldsOffset + 5] & 2) !== 0;
+  }
+
+  /**
+   * @description Move to the next event. The previous event is released, and may be overwritten from now on.
+   *
+   * @returns `false` if no event is available.
+   *
+   * ---
+   * @example
+   * while (reader.read()) {
+   *   console.log(reader.type, reader.input, reader.state);
+   * }
+   */
+  public read(): boolean {
+    if (Atomics.load(this.#header, WRITE_INDEX) === this.#nextIndex) {
+      // Release the current event
+      Atomics.store(this.#header, READ_INDEX, this.#nextIndex);
+      this.#fieldsOffset = -1;
+      return false;
+    }
+    // The read index keeps pointing at the current event, so it is not overwritten until the next read
+    Atomics.store(this.#header, READ_INDEX, this.#nextIndex);
+    // Fields follow the float64 timestamp, records being 8 int32 long
+    this.#fieldsOffset = ((this.#nextIndex & this.#mask) << 3) + 2;
+    this.#nextIndex = (this.#nextIndex + 1) | 0;
+    return true;
+  }
+
+  /**
+   * @description Ask to be notified of the next event written to the ring. Notifications wake up readers blocked in `wait()`,
+   * and call the `onEvents` callback of the ring on the main thread.
+   *
+   * @returns `false` if events are already available: read them instead of waiting.
+   */
+  public arm(): boolean {
+    Atomics.store(this.#header, WAITING, 1);
+    return this.available === 0;
+  }
+
+  /**
+   * @description Block until an event is available. Only available in worker threads, the main thread cannot block:
+   * use the `onEvents` callback of the ring instead.
+   *
+   * @param timeout The maximum time to wait in milliseconds. If unset, it waits indefinitely.
+   * @returns `false` if the timeout expired or the ring stopped without any event available.
+   *
+   * ---
+   * @example
+   * while (reader.isRunning) {
+   *   if (reader.wait(1000)) {
+   *     while (reader.read()) {
+   *       // Process event here...
+   *     }
+   *   }
+   * }
+   */
+  public wait(timeout?: number): boolean {
+    if (!this.arm() || !this.isRunning) {
+      return this.available > 0;
+    }
+    Atomics.wait(this.#header, WRITE_INDEX, this.#nextIndex, timeout);
+    return this.available > 0;
+  }
+
+}
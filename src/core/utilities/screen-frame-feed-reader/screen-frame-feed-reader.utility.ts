@@ -0,0 +1,155 @@
+import type { ScreenFrameFeedFrame } from "../../types/screen-frame-feed";
+
+// Shared memory layout, written by the native frame feed:
+//   header   16 x int32: sequence | slot | width | height | stride | slot count | slots offset | slot size | state
+//   metadata slot count x (int32 sequence | int32 reserved | float64 timestamp in ms)
+//   slots    slot count x packed BGRA pixels
+const HEADER_SIZE = 64;
+const SLOT_METADATA_SIZE = 16;
+const SEQUENCE = 0;
+const SLOT = 1;
+const WIDTH = 2;
+const HEIGHT = 3;
+const STRIDE = 4;
+const SLOT_COUNT = 5;
+const SLOTS_OFFSET = 6;
+const SLOT_SIZE = 7;
+const STATE = 8;
+
+/**
+ * @description Read the frames of a screen frame feed from its `SharedArrayBuffer`, without copies.
+ * It has no dependency on the native addon and can be used from worker threads.
+ */
+export class ScreenFrameFeedReader {
+
+  readonly #header: Int32Array;
+  readonly #metadata: Int32Array;
+  readonly #timestamps: Float64Array;
+  readonly #slots: Uint8Array[];
+
+  public constructor(buffer: SharedArrayBuffer) {
+    this.#header = new Int32Array(buffer, 0, HEADER_SIZE / 4);
+    const slotCount = Atomics.load(this.#header, SLOT_COUNT);
+    const slotsOffset = Atomics.load(this.#header, SLOTS_OFFSET);
+    const slotSize = Atomics.load(this.#header, SLOT_SIZE);
+    const frameSize = Atomics.load(this.#header, STRIDE) * Atomics.load(this.#header, HEIGHT);
+    this.#metadata = new Int32Array(buffer, HEADER_SIZE, slotCount * SLOT_METADATA_SIZE / 4);
+    this.#timestamps = new Float64Array(buffer, HEADER_SIZE, slotCount * SLOT_METADATA_SIZE / 8);
+    this.#slots = Array.from({ length: slotCount }, (_, slot) => new Uint8Array(buffer, slotsOffset + slot * slotSize, frameSize));
+  }
+
+  /**
+   * @description Frame width in pixels.
+   */
+  public get width(): number {
+    return this.#header[WIDTH];
+  }
+
+  /**
+   * @description Frame height in pixels.
+   */
+  public get height(): number {
+    return this.#header[HEIGHT];
+  }
+
+  /**
+   * @description Number of bytes between the start of two consecutive rows.
+   */
+  public get stride(): number {
+    return this.#header[STRIDE];
+  }
+
+  /**
+   * @description The sequence number of the newest frame, `0` if no frame was captured yet.
+   */
+  public get sequence(): number {
+    return Atomics.load(this.#header, SEQUENCE);
+  }
+
+  /**
+   * @description Whether the feed is still capturing frames.
+   */
+  public get isRunning(): boolean {
+    return Atomics.load(this.#header, STATE) === 1;
+  }
+
+  /**
+   * @description Get the newest frame. Its pixels are a view on shared memory: they are overwritten once the
+   * feed went around its slots, use `isValid()` after processing them to make sure it did not happen meanwhile.
+   *
+   * @returns The newest frame, or `null` if no frame was captured yet.
+   *
+   * ---
+   * @example
+   * const reader = new ScreenFrameFeedReader(buffer);
+   * const frame = reader.latest();
+   */
+  public latest(): ScreenFrameFeedFrame | null {
+    while (true) {
+      const sequence = Atomics.load(this.#header, SEQUENCE);
+      if (sequence === 0) {
+        return null;
+      }
+      const slot = Atomics.load(this.#header, SLOT);
+      // A newer frame may have been published in between
+      if (Atomics.load(this.#metadata, slot * SLOT_METADATA_SIZE / 4) !== sequence) {
+        continue;
+      }
+      return {
+        width: this.width,
+        height: this.height,
+        stride: this.stride,
+        format: "bgra",
+        data: this.#slots[slot],
+        sequence,
+        timestamp: this.#timestamps[slot * SLOT_METADATA_SIZE / 8 + 1],
+      };
+    }
+  }
+
+  /**
+   * @description Check whether the pixels of a frame are still the ones it was captured with.
+   *
+   * @param frame A frame returned by this reader.
+   * @returns `false` if the frame slot has been (or is being) overwritten by a newer frame.
+   *
+   * ---
+   * @example
+   * const frame = reader.latest();
+   * const result = analyze(frame.data);
+   * if (!reader.isValid(frame)) {
+   *   // The frame changed while being analyzed, discard the result
+   * }
+   */
+  public isValid(frame: ScreenFrameFeedFrame): boolean {
+    const slot = this.#slots.indexOf(frame.data);
+    return slot !== -1 && Atomics.load(this.#metadata, slot * SLOT_METADATA_SIZE / 4) === frame.sequence;
+  }
+
+  /**
+   * @description Block until a frame newer than `sequence` is captured. Only available in worker threads,
+   * the main thread cannot block: use `latest()` instead.
+   *
+   * @param sequence The sequence number of the last frame processed.
+   * @param timeout The maximum time to wait in milliseconds. If unset, it waits indefinitely.
+   * @returns The newest frame, or `null` if the timeout expired.
+   *
+   * ---
+   * @example
+   * let sequence = 0;
+   * while (reader.isRunning) {
+   *   const frame = reader.wait(sequence, 1000);
+   *   if (frame) {
+   *     sequence = frame.sequence;
+   *     // Process frame here...
+   *   }
+   * }
+   */
+  public wait(sequence: number, timeout?: number): ScreenFrameFeedFrame | null {
+    if (Atomics.wait(this.#header, SEQUENCE, sequence, timeout) === "timed-out") {
+      return null;
+    }
+    return this.latest();
+  }
+
+}